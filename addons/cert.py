@@ -235,10 +235,7 @@ def msc30(data):
         if simpleMatch(token, "rand ( )") and isStandardFunction(token):
             reportError(token, 'style', 'Do not use the rand() function for generating pseudorandom numbers', 'cert-MSC30-c')
 
-for arg in sys.argv[1:]:
-    if arg == '-verify':
-        VERIFY = True
-        continue
+for arg in cppcheckdata.dumpfilepaths(sys.argv[1:]):
     print('Checking ' + arg + '...')
     data = cppcheckdata.parsedump(arg)
 
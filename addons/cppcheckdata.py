@@ -6,6 +6,8 @@ This is a Python module that helps you access Cppcheck dump data.
 License: No restrictions, use this as you need.
 """
 
+import re
+import sys
 import xml.etree.ElementTree as ET
 import argparse
 from fnmatch import fnmatch
@@ -563,8 +565,16 @@ class Configuration:
                     self.directives.append(Directive(directive))
 
             if element.tag == 'tokenlist':
+                files = []
                 for token in element:
-                    self.tokenlist.append(Token(token))
+                    # file name table, the tokens reference it by index
+                    if token.tag == 'file':
+                        files.append(token.get('name'))
+                        continue
+                    tok = Token(token)
+                    if tok.file is None:
+                        tok.file = files[int(token.get('fileIndex'))]
+                    self.tokenlist.append(tok)
 
                 # set next/previous..
                 prev = None
@@ -692,7 +702,9 @@ class CppcheckData:
     suppressions = []
 
     def __init__(self, filename):
+        self.rawTokens = []
         self.configurations = []
+        self.suppressions = []
 
         data = ET.parse(filename)
 
@@ -735,6 +747,114 @@ def parsedump(filename):
     return CppcheckData(filename)
 
 
+def parsedumpindex(filename):
+    """
+    Parse the seek index appended to a dump file.
+
+    Dump files end with an index comment holding the byte offsets of each
+    <dump> element, of its tokenlist/symbols/valueflow sections, and of the
+    <token> region of each function, so a reader that only needs one
+    function can seek straight to it instead of parsing the whole document.
+
+    Returns a list with one entry per configuration:
+      {'cfg': name,
+       'offset': byte offset of the <dump> element,
+       'sections': {'tokenlist'/'symbols'/'valueflow': (begin, end)},
+       'functions': [{'name': name, 'begin': begin, 'end': end}]}
+    or None when the dump has no index (written by an older cppcheck).
+    """
+    with open(filename, 'rb') as f:
+        f.seek(0, 2)
+        filesize = f.tell()
+        f.seek(max(0, filesize - 100))
+        m = re.search(r'<!-- index at (\d+) -->', f.read().decode('utf-8', 'replace'))
+        if not m:
+            return None
+        f.seek(int(m.group(1)))
+        indextext = f.read().decode('utf-8', 'replace')
+
+    configurations = []
+    for line in indextext.splitlines():
+        fields = line.split(' ')
+        if fields[0] == 'dump':
+            configurations.append({'cfg': re.search(r'cfg="(.*)"', line).group(1),
+                                   'offset': int(fields[1]),
+                                   'sections': {},
+                                   'functions': []})
+        elif not configurations:
+            continue
+        elif fields[0] in ('tokenlist', 'symbols', 'valueflow'):
+            configurations[-1]['sections'][fields[0]] = (int(fields[1]), int(fields[2]))
+        elif fields[0] == 'function':
+            configurations[-1]['functions'].append({'name': re.search(r'name="(.*)"', line).group(1),
+                                                    'begin': int(fields[1]),
+                                                    'end': int(fields[2])})
+    return configurations
+
+
+def parsefunctiontokens(filename, configuration, function):
+    """
+    Read only the tokens of one function from an indexed dump file.
+
+    configuration and function are entries returned by parsedumpindex().
+    The tokens are linked with next/previous but their cross references
+    (scope, variable, astParent, ...) are left as raw ids, since the
+    referenced elements are not read. Good enough for textual checks on a
+    single changed function without parsing a whole multi-hundred-MB dump.
+    """
+    tokens = []
+    with open(filename, 'rb') as f:
+        # the file name table at the start of the tokenlist section, the
+        # tokens reference it by index. It comes before the first token, so
+        # a bounded read is enough
+        files = []
+        f.seek(configuration['sections']['tokenlist'][0])
+        tablesize = min(function['begin'] - f.tell(), 65536)
+        for line in f.read(tablesize).decode('utf-8', 'replace').splitlines():
+            m = re.match(r'\s*<file index="\d+" name="(.*)"/>', line)
+            if m:
+                files.append(m.group(1))
+            elif line.lstrip().startswith('<token '):
+                break
+        f.seek(function['begin'])
+        for line in f.read(function['end'] - function['begin']).decode('utf-8', 'replace').splitlines():
+            element = ET.fromstring(line)
+            if element.tag != 'token':
+                continue
+            tok = Token(element)
+            if tok.file is None:
+                tok.file = files[int(element.get('fileIndex'))]
+            tokens.append(tok)
+
+    prev = None
+    for token in tokens:
+        token.previous = prev
+        if prev:
+            prev.next = token
+        prev = token
+    return tokens
+
+
+def dumpfilepaths(args):
+    """
+    Yield the dump file paths in the given command line arguments.
+
+    A single '-' argument switches to streaming mode: paths are then read
+    from stdin, one per line, until EOF. A build driver can keep one
+    interpreter per addon alive for a whole analysis and feed it dump files
+    as cppcheck finishes them, instead of paying the Python startup cost
+    once for every file.
+    """
+    for arg in args:
+        if arg == '-':
+            for line in sys.stdin:
+                path = line.strip()
+                if path:
+                    yield path
+        elif not arg.startswith('-'):
+            yield arg
+
+
 def astIsFloat(token):
     """
     Check if type of ast node is float/double
@@ -8,7 +8,7 @@ import sys
 
 messages = set()
 
-for arg in sys.argv[1:]:
+for arg in cppcheckdata.dumpfilepaths(sys.argv[1:]):
     print('Checking ' + arg + '...')
     data = cppcheckdata.parsedump(arg)
 
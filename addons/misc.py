@@ -135,9 +135,7 @@ def ellipsisStructArg(data):
                     reportError(tok, 'style', 'Passing record to ellipsis function \'' + tok.astOperand1.function.name + '\'.', 'ellipsisStructArg')
                 break
 
-for arg in sys.argv[1:]:
-    if arg in ['-debug', '-verify']:
-        continue
+for arg in cppcheckdata.dumpfilepaths(sys.argv[1:]):
     print('Checking ' + arg + '...')
     data = cppcheckdata.parsedump(arg)
 
@@ -2187,7 +2187,7 @@ else:
         SHOW_SUMMARY = False
     if args.dumpfile:
         exitCode = 0
-        for item in args.dumpfile:
+        for item in cppcheckdata.dumpfilepaths(args.dumpfile):
             checker.parseDump(item)
 
             if VERIFY:
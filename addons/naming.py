@@ -31,9 +31,7 @@ def reportError(token, severity, msg):
     sys.stderr.write(
         '[' + token.file + ':' + str(token.linenr) + '] (' + severity + ') naming.py: ' + msg + '\n')
 
-for arg in sys.argv[1:]:
-    if not arg[-5:] == '.dump':
-        continue
+for arg in cppcheckdata.dumpfilepaths(sys.argv[1:]):
     print('Checking ' + arg + '...')
     data = cppcheckdata.parsedump(arg)
     for cfg in data.configurations:
@@ -81,7 +81,7 @@ def process(dumpfiles, configfile, debugprint=False):
 
     conf = loadConfig(configfile)
 
-    for afile in dumpfiles:
+    for afile in cppcheckdata.dumpfilepaths(dumpfiles):
         if not afile[-5:] == '.dump':
             continue
         print('Checking ' + afile + '...')
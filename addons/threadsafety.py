@@ -26,7 +26,7 @@ def checkstatic(data):
             else:
                 reportError(var.typeStartToken, 'warning', 'Local static ' + type + ': ' + var.nameToken.str, 'threadsafety')
 
-for arg in sys.argv[1:]:
+for arg in cppcheckdata.dumpfilepaths(sys.argv[1:]):
     print('Checking ' + arg + '...')
     data = cppcheckdata.parsedump(arg)
     for cfg in data.configurations:
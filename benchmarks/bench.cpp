@@ -0,0 +1,228 @@
+/*
+ * Cppcheck - A tool for static C/C++ code analysis
+ * Copyright (C) 2007-2019 Cppcheck team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Benchmark runner. Checks out the pinned codebases listed in
+ * benchmarks/corpus.txt and times cppcheck runs against them in a few
+ * defined scenarios (cold/warm analyzer cache, -j sweep, --enable=all).
+ * Medians over several iterations are reported, and when
+ * benchmarks/thresholds.txt lists a limit for a scenario the run fails
+ * if the median exceeds it. Build and run with "make run-bench".
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct CorpusEntry {
+    std::string name;
+    std::string url;
+    std::string revision;
+    std::string path;      // path to check, relative to the checkout
+    std::string extraArgs; // entry specific cppcheck arguments
+};
+
+struct Result {
+    std::string corpus;
+    std::string scenario;
+    double seconds;
+};
+
+static std::string corpusDir(const CorpusEntry &entry)
+{
+    return "benchmarks/corpus/" + entry.name;
+}
+
+static bool readCorpus(const std::string &filename, std::vector<CorpusEntry> &corpus)
+{
+    std::ifstream fin(filename);
+    if (!fin.is_open()) {
+        std::cerr << "Failed to open corpus file " << filename << std::endl;
+        return false;
+    }
+    std::string line;
+    while (std::getline(fin, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::istringstream istr(line);
+        CorpusEntry entry;
+        if (!(istr >> entry.name >> entry.url >> entry.revision >> entry.path)) {
+            std::cerr << "Malformed corpus line: " << line << std::endl;
+            return false;
+        }
+        std::string arg;
+        while (istr >> arg)
+            entry.extraArgs += " " + arg;
+        corpus.push_back(entry);
+    }
+    return true;
+}
+
+static bool ensureCheckout(const CorpusEntry &entry)
+{
+    const std::string dir = corpusDir(entry);
+    std::ifstream probe(dir + "/.git/HEAD");
+    if (!probe.is_open()) {
+        std::cout << "Cloning " << entry.url << ".." << std::endl;
+        if (std::system(("git clone -q " + entry.url + " " + dir).c_str()) != 0) {
+            std::cerr << "Failed to clone " << entry.url << std::endl;
+            return false;
+        }
+    }
+    // always pin to the recorded revision so results stay comparable
+    if (std::system(("git -C " + dir + " checkout -q " + entry.revision).c_str()) != 0) {
+        std::cerr << "Failed to checkout " << entry.revision << " in " << dir << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static double timeCommand(const std::string &command)
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (std::system(command.c_str()) != 0)
+        std::cerr << "warning: command failed: " << command << std::endl;
+    const std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(stop - start).count();
+}
+
+static double median(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    const std::size_t mid = values.size() / 2;
+    if (values.size() % 2 == 0)
+        return (values[mid - 1] + values[mid]) / 2.0;
+    return values[mid];
+}
+
+static double runScenario(const std::string &cppcheck,
+                          const CorpusEntry &entry,
+                          const std::string &scenario,
+                          const std::string &args,
+                          bool coldCache,
+                          int iterations)
+{
+    const std::string buildDir = corpusDir(entry) + "/.cppcheck-build-dir";
+    const std::string command = cppcheck + " -q --cppcheck-build-dir=" + buildDir +
+                                " " + args + entry.extraArgs +
+                                " " + corpusDir(entry) + "/" + entry.path +
+                                " > /dev/null 2>&1";
+    std::vector<double> times;
+    for (int i = 0; i < iterations; ++i) {
+        if (coldCache)
+            (void)std::system(("rm -rf " + buildDir).c_str());
+        (void)std::system(("mkdir -p " + buildDir).c_str());
+        times.push_back(timeCommand(command));
+    }
+    const double result = median(times);
+    std::cout << entry.name << " " << scenario << ": " << result << " s" << std::endl;
+    return result;
+}
+
+static bool checkThresholds(const std::string &filename, const std::vector<Result> &results)
+{
+    std::ifstream fin(filename);
+    if (!fin.is_open())
+        return true; // no thresholds defined
+    bool ok = true;
+    std::string corpus, scenario;
+    double maxSeconds;
+    while (fin >> corpus >> scenario >> maxSeconds) {
+        for (const Result &result : results) {
+            if (result.corpus != corpus || result.scenario != scenario)
+                continue;
+            if (result.seconds > maxSeconds) {
+                std::cerr << "REGRESSION: " << corpus << " " << scenario << " took "
+                          << result.seconds << " s, threshold is " << maxSeconds << " s" << std::endl;
+                ok = false;
+            }
+        }
+    }
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    std::string cppcheck = "./cppcheck";
+    std::string corpusFile = "benchmarks/corpus.txt";
+    std::string thresholdsFile = "benchmarks/thresholds.txt";
+    int iterations = 3;
+    bool quick = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg.compare(0, 11, "--cppcheck=") == 0)
+            cppcheck = arg.substr(11);
+        else if (arg.compare(0, 9, "--corpus=") == 0)
+            corpusFile = arg.substr(9);
+        else if (arg.compare(0, 13, "--thresholds=") == 0)
+            thresholdsFile = arg.substr(13);
+        else if (arg.compare(0, 13, "--iterations=") == 0)
+            iterations = std::atoi(arg.substr(13).c_str());
+        else if (arg == "--quick")
+            quick = true;
+        else {
+            std::cout << "Syntax: bench [--cppcheck=path] [--corpus=file] [--thresholds=file] [--iterations=n] [--quick]" << std::endl;
+            return arg == "--help" ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (iterations < 1)
+        iterations = 1;
+
+    std::vector<CorpusEntry> corpus;
+    if (!readCorpus(corpusFile, corpus))
+        return EXIT_FAILURE;
+
+    std::vector<Result> results;
+    for (const CorpusEntry &entry : corpus) {
+        if (!ensureCheckout(entry))
+            return EXIT_FAILURE;
+
+        Result result;
+        result.corpus = entry.name;
+
+        result.scenario = "cold";
+        result.seconds = runScenario(cppcheck, entry, result.scenario, "-j1", true, iterations);
+        results.push_back(result);
+
+        result.scenario = "warm";
+        result.seconds = runScenario(cppcheck, entry, result.scenario, "-j1", false, iterations);
+        results.push_back(result);
+
+        if (!quick) {
+            for (int j = 2; j <= 4; j *= 2) {
+                result.scenario = "cold-j" + std::to_string(j);
+                result.seconds = runScenario(cppcheck, entry, result.scenario, "-j" + std::to_string(j), true, iterations);
+                results.push_back(result);
+            }
+
+            result.scenario = "cold-enable-all";
+            result.seconds = runScenario(cppcheck, entry, result.scenario, "-j1 --enable=all", true, iterations);
+            results.push_back(result);
+        }
+    }
+
+    if (!checkThresholds(thresholdsFile, results))
+        return EXIT_FAILURE;
+    return EXIT_SUCCESS;
+}
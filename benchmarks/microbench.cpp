@@ -0,0 +1,225 @@
+/*
+ * Cppcheck - A tool for static C/C++ code analysis
+ * Copyright (C) 2007-2019 Cppcheck team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Micro benchmarks for the core primitives: Token::Match/findmatch,
+ * lexing and MathLib conversions. Each benchmark is calibrated until it
+ * runs long enough to time reliably and the cost per operation is
+ * reported. Build with "make microbench".
+ *
+ * For per-commit comparisons, save a baseline with --save=<file> on one
+ * commit and run with --compare=<file> on another; the relative change
+ * per benchmark is printed.
+ *
+ * A result is only comparable between runs on the same machine with the
+ * same compiler flags.
+ */
+
+#include "mathlib.h"
+#include "settings.h"
+#include "token.h"
+#include "tokenize.h"
+#include "tokenlist.h"
+
+#include <simplecpp.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static std::string syntheticCode()
+{
+    // executable code with declarations, conditions and calculations so
+    // the match patterns below hit and miss in a realistic mix
+    std::ostringstream ostr;
+    for (int i = 0; i < 500; ++i) {
+        ostr << "int a" << i << " = " << i << " ;\n"
+             << "if ( a" << i << " < 100 ) { a" << i << " = a" << i << " + 1 ; }\n"
+             << "while ( a" << i << " > 0 ) { a" << i << " -- ; }\n";
+    }
+    return ostr.str();
+}
+
+class MicroBench {
+public:
+    explicit MicroBench(const Settings *settings) : mSettings(settings), mCode(syntheticCode()), mTokenList(settings) {
+        std::istringstream istr(mCode);
+        mTokenList.createTokens(istr, "bench.cpp");
+    }
+
+    // run op often enough to get a stable time and report nanoseconds/op.
+    // op processes the whole token stream, so the reported unit is one
+    // pass over it - comparisons between benchmarks are not meaningful,
+    // comparisons of the same benchmark between commits are.
+    template<class OP>
+    void run(const char name[], OP op) {
+        long long iterations = 1;
+        double seconds = 0.0;
+        for (;;) {
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (long long i = 0; i < iterations; ++i)
+                op();
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (seconds >= 0.2)
+                break;
+            iterations *= 2;
+        }
+        const double nsPerOp = seconds * 1e9 / (double)iterations;
+        mResults[name] = nsPerOp;
+        std::cout << std::left << std::setw(28) << name
+                  << std::right << std::setw(14) << (long long)nsPerOp << " ns/op" << std::endl;
+    }
+
+    const Token *tokens() const {
+        return mTokenList.front();
+    }
+    const std::string &code() const {
+        return mCode;
+    }
+    const Settings *settings() const {
+        return mSettings;
+    }
+    const std::map<std::string, double> &results() const {
+        return mResults;
+    }
+
+private:
+    const Settings *mSettings;
+    const std::string mCode;
+    TokenList mTokenList;
+    std::map<std::string, double> mResults;
+};
+
+int main(int argc, char **argv)
+{
+    std::string saveFile;
+    std::string compareFile;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg.compare(0, 7, "--save=") == 0)
+            saveFile = arg.substr(7);
+        else if (arg.compare(0, 10, "--compare=") == 0)
+            compareFile = arg.substr(10);
+        else {
+            std::cout << "Syntax: microbench [--save=file] [--compare=file]" << std::endl;
+            return arg == "--help" ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    Settings settings;
+    MicroBench bench(&settings);
+
+    bench.run("Token::Match", [&]() {
+        int matches = 0;
+        for (const Token *tok = bench.tokens(); tok; tok = tok->next()) {
+            if (Token::Match(tok, "%name% = %num% ;"))
+                ++matches;
+            if (Token::Match(tok, "if|while ( %name% <|> %num% )"))
+                ++matches;
+        }
+        if (matches == 0)
+            std::cerr << "Token::Match benchmark is broken" << std::endl;
+    });
+
+    bench.run("Token::simpleMatch", [&]() {
+        int matches = 0;
+        for (const Token *tok = bench.tokens(); tok; tok = tok->next()) {
+            if (Token::simpleMatch(tok, "( a0 < 100 )"))
+                ++matches;
+        }
+        if (matches == 0)
+            std::cerr << "Token::simpleMatch benchmark is broken" << std::endl;
+    });
+
+    bench.run("Token::findmatch", [&]() {
+        // restarting after each hit walks the whole stream in segments
+        for (const Token *tok = bench.tokens(); tok; tok = tok->next()) {
+            tok = Token::findmatch(tok, "while ( %name% > %num% )");
+            if (!tok)
+                break;
+        }
+    });
+
+    bench.run("simplecpp lexer", [&]() {
+        std::istringstream istr(bench.code());
+        std::vector<std::string> files;
+        simplecpp::TokenList tokens(istr, files, "bench.cpp");
+        if (tokens.empty())
+            std::cerr << "simplecpp benchmark is broken" << std::endl;
+    });
+
+    bench.run("Tokenizer::tokenize", [&]() {
+        Settings s;
+        Tokenizer tokenizer(&s, nullptr);
+        std::istringstream istr("void f ( ) {\n" + bench.code() + "}\n");
+        if (!tokenizer.tokenize(istr, "bench.cpp"))
+            std::cerr << "Tokenizer benchmark is broken" << std::endl;
+    });
+
+    bench.run("MathLib conversions", [&]() {
+        static const char * const numbers[] = {
+            "123", "0xff", "077", "0b101", "123456789012345", "'a'", "1e10", "123.456", "42U", "7LL"
+        };
+        MathLib::bigint sum = 0;
+        for (const char *str : numbers) {
+            if (MathLib::isInt(str))
+                sum += MathLib::toLongNumber(str);
+            else
+                sum += (MathLib::bigint)MathLib::toDoubleNumber(str);
+        }
+        if (sum == 0)
+            std::cerr << "MathLib benchmark is broken" << std::endl;
+    });
+
+    if (!saveFile.empty()) {
+        std::ofstream fout(saveFile);
+        for (const std::pair<const std::string, double> &result : bench.results())
+            fout << result.first << ';' << result.second << '\n';
+    }
+
+    if (!compareFile.empty()) {
+        std::ifstream fin(compareFile);
+        if (!fin.is_open()) {
+            std::cerr << "Failed to open baseline " << compareFile << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cout << "\nComparison against " << compareFile << ":" << std::endl;
+        std::string line;
+        while (std::getline(fin, line)) {
+            const std::string::size_type sep = line.rfind(';');
+            if (sep == std::string::npos)
+                continue;
+            const std::string name = line.substr(0, sep);
+            const double baseline = std::atof(line.c_str() + sep + 1);
+            const std::map<std::string, double>::const_iterator it = bench.results().find(name);
+            if (it == bench.results().end() || baseline <= 0.0)
+                continue;
+            const double change = 100.0 * (it->second - baseline) / baseline;
+            std::cout << std::left << std::setw(28) << name
+                      << std::right << std::setw(13) << std::fixed << std::setprecision(1) << change << " %" << std::endl;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -44,6 +44,13 @@
 #include <tinyxml2.h>
 #endif
 
+// native check plugins are loaded with the platform's dynamic loader
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
 static void addFilesToList(const std::string& FileList, std::vector<std::string>& PathNames)
 {
     // To keep things initially simple, if the file can't be opened, just be silent and move on.
@@ -102,6 +109,7 @@ CmdLineParser::CmdLineParser(Settings *settings)
     , mShowVersion(false)
     , mShowErrorMessages(false)
     , mExitAfterPrint(false)
+    , mBuildDirGCDays(0)
 {
 }
 
@@ -128,12 +136,28 @@ bool CmdLineParser::parseFromArgs(int argc, const char* const argv[])
                 return true;
             }
 
+            // Remove old analyzer information and exit
+            else if (std::strncmp(argv[i], "--build-dir-gc=", 15) == 0) {
+                std::istringstream iss(argv[i] + 15);
+                if (!(iss >> mBuildDirGCDays) || mBuildDirGCDays <= 0) {
+                    printMessage("cppcheck: argument to '--build-dir-gc=' is not a valid number of days.");
+                    return false;
+                }
+                mExitAfterPrint = true;
+            }
+
             else if (std::strncmp(argv[i], "--cppcheck-build-dir=", 21) == 0) {
                 mSettings->buildDir = Path::fromNativeSeparators(argv[i] + 21);
                 if (endsWith(mSettings->buildDir, '/'))
                     mSettings->buildDir.erase(mSettings->buildDir.size() - 1U);
             }
 
+            else if (std::strncmp(argv[i], "--cppcheck-cache-dir=", 21) == 0) {
+                mSettings->cacheDir = Path::fromNativeSeparators(argv[i] + 21);
+                if (endsWith(mSettings->cacheDir, '/'))
+                    mSettings->cacheDir.erase(mSettings->cacheDir.size() - 1U);
+            }
+
             // Flag used for various purposes during debugging
             else if (std::strcmp(argv[i], "--debug-simplified") == 0)
                 mSettings->debugSimplified = true;
@@ -151,10 +175,35 @@ bool CmdLineParser::parseFromArgs(int argc, const char* const argv[])
             else if (std::strcmp(argv[i], "--debug-template") == 0)
                 mSettings->debugtemplate = true;
 
+            // resident mode, read check requests from stdin
+            else if (std::strcmp(argv[i], "--daemon") == 0)
+                mSettings->daemon = true;
+
             // dump cppcheck data
             else if (std::strcmp(argv[i], "--dump") == 0)
                 mSettings->dump = true;
 
+            // dump only the given sections
+            else if (std::strncmp(argv[i], "--dump=", 7) == 0) {
+                mSettings->dump = true;
+                std::string sections(argv[i] + 7);
+                sections += ',';
+                std::string::size_type pos = 0;
+                while (pos < sections.size()) {
+                    const std::string section(sections.substr(pos, sections.find(',', pos) - pos));
+                    if (section != "rawtokens" && section != "directives" && section != "suppressions" &&
+                        section != "tokens" && section != "symbols" && section != "valueflow") {
+                        printMessage("cppcheck: error: unknown --dump section '" + section + "'");
+                        return false;
+                    }
+                    mSettings->dumpSections.insert(section);
+                    pos += section.size() + 1;
+                }
+                // the symbol database and the value flow data reference tokens
+                if (mSettings->isDumpSectionEnabled("symbols") || mSettings->isDumpSectionEnabled("valueflow"))
+                    mSettings->dumpSections.insert("tokens");
+            }
+
             // max ctu depth
             else if (std::strncmp(argv[i], "--max-ctu-depth=", 16) == 0)
                 mSettings->maxCtuDepth = std::atoi(argv[i] + 16);
@@ -218,6 +267,15 @@ bool CmdLineParser::parseFromArgs(int argc, const char* const argv[])
                 }
             }
 
+            // Time budget for one sub-check on one file
+            else if (std::strncmp(argv[i], "--sub-check-budget=", 19) == 0) {
+                std::istringstream iss(19+argv[i]);
+                if (!(iss >> mSettings->subCheckBudgetMs)) {
+                    printMessage("cppcheck: argument to '--sub-check-budget=' is not a number.");
+                    return false;
+                }
+            }
+
             // Filter errors
             else if (std::strncmp(argv[i], "--suppressions-list=", 20) == 0) {
                 std::string filename = argv[i]+20;
@@ -301,6 +359,34 @@ bool CmdLineParser::parseFromArgs(int argc, const char* const argv[])
             else if (std::strncmp(argv[i], "--output-file=", 14) == 0)
                 mSettings->outputFile = Path::simplifyPath(Path::fromNativeSeparators(argv[i] + 14));
 
+            // Write results in SARIF format in the given file
+            else if (std::strncmp(argv[i], "--sarif=", 8) == 0)
+                mSettings->sarifOutput = Path::simplifyPath(Path::fromNativeSeparators(argv[i] + 8));
+
+            // Write machine readable performance report in file
+            else if (std::strncmp(argv[i], "--perf-report=", 14) == 0) {
+                mSettings->perfReport = Path::simplifyPath(Path::fromNativeSeparators(argv[i] + 14));
+                if (mSettings->perfReport.empty()) {
+                    printMessage("cppcheck: error: no filename has been specified for --perf-report");
+                    return false;
+                }
+                // collect the phase timings without printing them
+                if (mSettings->showtime == SHOWTIME_NONE)
+                    mSettings->showtime = SHOWTIME_REPORT;
+            }
+
+            // Write Chrome trace of the timer runs in file
+            else if (std::strncmp(argv[i], "--trace-report=", 15) == 0) {
+                mSettings->traceReport = Path::simplifyPath(Path::fromNativeSeparators(argv[i] + 15));
+                if (mSettings->traceReport.empty()) {
+                    printMessage("cppcheck: error: no filename has been specified for --trace-report");
+                    return false;
+                }
+                // collect the phase timings without printing them
+                if (mSettings->showtime == SHOWTIME_NONE)
+                    mSettings->showtime = SHOWTIME_REPORT;
+            }
+
             // Write results in results.plist
             else if (std::strncmp(argv[i], "--plist-output=", 15) == 0) {
                 mSettings->plistOutput = Path::simplifyPath(Path::fromNativeSeparators(argv[i] + 15));
@@ -455,7 +541,18 @@ bool CmdLineParser::parseFromArgs(int argc, const char* const argv[])
                     path += '/';
 
                 mSettings->includePaths.push_back(path);
-            } else if (std::strncmp(argv[i], "--include=", 10) == 0) {
+            }
+
+            // Declaration-only model headers that shadow the real vendor
+            // headers
+            else if (std::strncmp(argv[i], "--header-models=", 16) == 0) {
+                std::string path = Path::fromNativeSeparators(argv[i] + 16);
+                if (!endsWith(path,'/'))
+                    path += '/';
+                mSettings->headerModelsPath = path;
+            }
+
+            else if (std::strncmp(argv[i], "--include=", 10) == 0) {
                 std::string path = argv[i] + 10;
 
                 path = Path::fromNativeSeparators(path);
@@ -472,6 +569,12 @@ bool CmdLineParser::parseFromArgs(int argc, const char* const argv[])
                 std::string path = argv[i] + 17;
                 path = Path::fromNativeSeparators(path);
                 mSettings->configExcludePaths.insert(path);
+            } else if (std::strncmp(argv[i], "--cpu-affinity=", 15) == 0) {
+                mSettings->cpuAffinity = argv[i] + 15;
+                if (mSettings->cpuAffinity != "compact" && mSettings->cpuAffinity != "scatter") {
+                    printMessage("cppcheck: error: argument to '--cpu-affinity=' must be 'compact' or 'scatter'.");
+                    return false;
+                }
             } else if (std::strncmp(argv[i], "--config-excludes-file=", 23) == 0) {
                 // open this file and read every input file (1 file name per line)
                 const std::string cfgExcludesFile(23 + argv[i]);
@@ -526,6 +629,30 @@ bool CmdLineParser::parseFromArgs(int argc, const char* const argv[])
                     return false;
             }
 
+            // --plugin
+            else if (std::strncmp(argv[i], "--plugin=", 9) == 0) {
+                // a plugin is a shared object with static instances of Check
+                // subclasses; loading it runs their constructors, which
+                // register the checks in Check::instances() like the built-in
+                // checks do. The binary is linked with -rdynamic so the
+                // plugin resolves the cppcheck symbols at load time.
+                const std::string plugin = argv[i] + 9;
+#ifdef _WIN32
+                if (!LoadLibraryA(plugin.c_str())) {
+                    printMessage("cppcheck: error: failed to load plugin '" + plugin + "'.");
+                    return false;
+                }
+#else
+                if (!dlopen(plugin.c_str(), RTLD_NOW | RTLD_GLOBAL)) {
+                    const char *dlerr = dlerror();
+                    printMessage("cppcheck: error: failed to load plugin '" + plugin + "'" +
+                                 (dlerr ? std::string(": ") + dlerr : "") + ".");
+                    return false;
+                }
+#endif
+                mSettings->plugins.push_back(plugin);
+            }
+
             // --project
             else if (std::strncmp(argv[i], "--project=", 10) == 0) {
                 const std::string projectFile = argv[i]+10;
@@ -582,6 +709,10 @@ bool CmdLineParser::parseFromArgs(int argc, const char* const argv[])
             }
 
             // Report progress
+            // re-check a single file using the recorded project state
+            else if (std::strncmp(argv[i], "--recheck=", 10) == 0)
+                mSettings->recheckFile = Path::fromNativeSeparators(argv[i] + 10);
+
             else if (std::strcmp(argv[i], "--report-progress") == 0) {
                 mSettings->reportProgress = true;
             }
@@ -711,7 +842,7 @@ bool CmdLineParser::parseFromArgs(int argc, const char* const argv[])
             else if (std::strcmp(argv[i], "--doc") == 0) {
                 std::ostringstream doc;
                 // Get documentation..
-                for (std::list<Check *>::iterator it = Check::instances().begin(); it != Check::instances().end(); ++it) {
+                for (std::list<Check *>::const_iterator it = Check::instances().begin(); it != Check::instances().end(); ++it) {
                     const std::string& name((*it)->name());
                     const std::string info((*it)->classInfo());
                     if (!name.empty() && !info.empty())
@@ -724,6 +855,19 @@ bool CmdLineParser::parseFromArgs(int argc, const char* const argv[])
                 return true;
             }
 
+            // Write the results sorted and deduplicated at the end of the run
+            else if (std::strcmp(argv[i], "--sorted-results") == 0)
+                mSettings->sortedResults = true;
+
+            // Analysis order of the input files
+            else if (std::strncmp(argv[i], "--order=", 8) == 0) {
+                mSettings->analysisOrder = argv[i] + 8;
+                if (mSettings->analysisOrder != "size" && mSettings->analysisOrder != "mtime") {
+                    printMessage("cppcheck: error: argument to '--order=' must be 'size' or 'mtime'.");
+                    return false;
+                }
+            }
+
             // show timing information..
             else if (std::strncmp(argv[i], "--showtime=", 11) == 0) {
                 const std::string showtimeMode = argv[i] + 11;
@@ -839,6 +983,42 @@ bool CmdLineParser::parseFromArgs(int argc, const char* const argv[])
                 maxconfigs = true;
             }
 
+            // Set maximum number of tokens template expansion may generate
+            else if (std::strncmp(argv[i], "--max-template-tokens=", 22) == 0) {
+                std::istringstream iss(22+argv[i]);
+                if (!(iss >> mSettings->maxTemplateTokens)) {
+                    printMessage("cppcheck: argument to '--max-template-tokens=' is not a number.");
+                    return false;
+                }
+            }
+
+            // Set soft deadline for checking a file
+            else if (std::strncmp(argv[i], "--max-time-per-file=", 20) == 0) {
+                std::istringstream iss(20+argv[i]);
+                if (!(iss >> mSettings->maxTimePerFile)) {
+                    printMessage("cppcheck: argument to '--max-time-per-file=' is not a number.");
+                    return false;
+                }
+
+                if (mSettings->maxTimePerFile < 1) {
+                    printMessage("cppcheck: argument to '--max-time-per-file=' must be greater than 0.");
+                    return false;
+                }
+            }
+
+            // Set value flow effort budget per function
+            else if (std::strncmp(argv[i], "--valueflow-max-effort=", 23) == 0) {
+                std::istringstream iss(23+argv[i]);
+                if (!(iss >> mSettings->valueFlowMaxEffort)) {
+                    printMessage("cppcheck: argument to '--valueflow-max-effort=' is not a number.");
+                    return false;
+                }
+            }
+
+            // Write value flow statistics
+            else if (std::strcmp(argv[i], "--valueflow-stats") == 0)
+                mSettings->valueFlowStatistics = true;
+
             // Print help
             else if (std::strcmp(argv[i], "-h") == 0 || std::strcmp(argv[i], "--help") == 0) {
                 mPathNames.clear();
@@ -875,6 +1055,11 @@ bool CmdLineParser::parseFromArgs(int argc, const char* const argv[])
         printMessage("cppcheck: unusedFunction check can't be used with '-j' option. Disabling unusedFunction check.");
     }
 
+    if (mSettings->sortedResults && mSettings->jobs <= 1) {
+        printMessage("cppcheck: error: --sorted-results requires the '-j' option.");
+        return false;
+    }
+
     if (argc <= 1) {
         mShowHelp = true;
         mExitAfterPrint = true;
@@ -885,8 +1070,34 @@ bool CmdLineParser::parseFromArgs(int argc, const char* const argv[])
         return true;
     }
 
+    // --recheck: limit the run to one TU. The include paths and defines of a
+    // loaded project still apply, but only the given file is analyzed; the
+    // whole program analysis reuses the state the full run recorded in the
+    // build dir for all the other files.
+    if (!mSettings->recheckFile.empty()) {
+        if (mSettings->buildDir.empty()) {
+            printMessage("cppcheck: error: --recheck requires --cppcheck-build-dir.");
+            return false;
+        }
+        if (!mSettings->project.fileSettings.empty()) {
+            std::list<ImportProject::FileSettings> recheckSettings;
+            for (const ImportProject::FileSettings &fs : mSettings->project.fileSettings) {
+                if (Path::fromNativeSeparators(fs.filename) == mSettings->recheckFile)
+                    recheckSettings.push_back(fs);
+            }
+            if (recheckSettings.empty()) {
+                printMessage("cppcheck: error: --recheck file '" + mSettings->recheckFile + "' is not part of the project.");
+                return false;
+            }
+            mSettings->project.fileSettings.swap(recheckSettings);
+        } else {
+            mPathNames.clear();
+            mPathNames.push_back(mSettings->recheckFile);
+        }
+    }
+
     // Print error only if we have "real" command and expect files
-    if (!mExitAfterPrint && mPathNames.empty() && mSettings->project.fileSettings.empty()) {
+    if (!mExitAfterPrint && !mSettings->daemon && mPathNames.empty() && mSettings->project.fileSettings.empty()) {
         printMessage("cppcheck: No C or C++ source files found.");
         return false;
     }
@@ -911,7 +1122,27 @@ void CmdLineParser::printHelp()
               "    --cppcheck-build-dir=<dir>\n"
               "                         Analysis output directory. Useful for various data.\n"
               "                         Some possible usages are; whole program analysis,\n"
-              "                         incremental analysis, distributed analysis.\n"
+              "                         incremental analysis, distributed analysis. An\n"
+              "                         interrupted analysis also continues where it\n"
+              "                         stopped when the same command is rerun.\n"
+              "    --cppcheck-cache-dir=<dir>\n"
+              "                         Shared analysis cache, used together with\n"
+              "                         --cppcheck-build-dir. Results are stored by content\n"
+              "                         checksum, so identical files are analyzed only once\n"
+              "                         across branches, worktrees and machines. Analyze\n"
+              "                         with relative paths so replayed results refer to\n"
+              "                         the local checkout.\n"
+              "    --build-dir-gc=<days>\n"
+              "                         Remove analyzer information that has not been used\n"
+              "                         for more than <days> days from the directories\n"
+              "                         given with --cppcheck-build-dir and\n"
+              "                         --cppcheck-cache-dir, then exit.\n"
+              "    --recheck=<file>     Re-check a single file of a previously analyzed\n"
+              "                         project. Requires --cppcheck-build-dir; only the\n"
+              "                         given file is analyzed and the whole program\n"
+              "                         analysis reuses the recorded state of the other\n"
+              "                         files. When a project is loaded, <file> must be\n"
+              "                         part of the project.\n"
               "    --check-config       Check cppcheck configuration. The normal code\n"
               "                         analysis is disabled by this flag.\n"
               "    --check-library      Show information messages when library files have\n"
@@ -923,9 +1154,25 @@ void CmdLineParser::printHelp()
               "                         be considered for evaluation.\n"
               "    --config-excludes-file=<file>\n"
               "                         A file that contains a list of config-excludes\n"
+              "    --cpu-affinity=<policy>\n"
+              "                         Pin the worker processes to cpus when checking with\n"
+              "                         -j. 'compact' fills the cpus in enumeration order,\n"
+              "                         'scatter' spreads the workers evenly over all cpus.\n"
+              "                         The memory a worker allocates then stays on the\n"
+              "                         NUMA node of its cpu.\n"
+              "    --daemon             Keep the process resident after the files given on\n"
+              "                         the command line (if any) are checked. Each line\n"
+              "                         read from stdin is checked as one source file and\n"
+              "                         a '<daemon-done exitcode=\"N\"/>' line is written to\n"
+              "                         stdout when its results are complete. The settings\n"
+              "                         and library configurations are loaded only once.\n"
               "    --dump               Dump xml data for each translation unit. The dump\n"
               "                         files have the extension .dump and contain ast,\n"
               "                         tokenlist, symboldatabase, valueflow.\n"
+              "    --dump=<sections>    Dump only the given comma separated sections:\n"
+              "                         rawtokens, directives, suppressions, tokens,\n"
+              "                         symbols, valueflow. Smaller dumps are faster to\n"
+              "                         write and to load in addons.\n"
               "    -D<ID>               Define preprocessor symbol. Unless --max-configs or\n"
               "                         --force is used, Cppcheck will only check the given\n"
               "                         configuration when -D is used.\n"
@@ -988,6 +1235,13 @@ void CmdLineParser::printHelp()
               "                         First given path is searched for contained header\n"
               "                         files first. If paths are relative to source files,\n"
               "                         this is not needed.\n"
+              "    --header-models=<dir>\n"
+              "                         Directory with declaration-only model headers that are\n"
+              "                         used instead of the real vendor headers of the same\n"
+              "                         name. The models keep the declarations the checks need\n"
+              "                         and drop the implementation detail that dominates the\n"
+              "                         preprocessing time. Models can be generated from real\n"
+              "                         headers with the makeheadermodel tool.\n"
               "    --include=<file>\n"
               "                         Force inclusion of a file before the checked file. Can\n"
               "                         be used for example when checking the Linux kernel,\n"
@@ -1026,6 +1280,9 @@ void CmdLineParser::printHelp()
               "                         is 2. A larger value will mean more errors can be found\n"
               "                         but also means the analysis will be slower.\n"
               "    --output-file=<file> Write results to file, rather than standard error.\n"
+              "    --perf-report=<file> Write a JSON report with phase timings, the slowest\n"
+              "                         files and analysis statistics for the run to the\n"
+              "                         given file.\n"
               "    --project=<file>     Run Cppcheck on project. The <file> can be a Visual\n"
               "                         Studio Solution (*.sln), Visual Studio Project\n"
               "                         (*.vcxproj), compile database (compile_commands.json),\n"
@@ -1037,6 +1294,24 @@ void CmdLineParser::printHelp()
               "                         before skipping it. Default is '12'. If used together\n"
               "                         with '--force', the last option is the one that is\n"
               "                         effective.\n"
+              "    --max-template-tokens=<limit>\n"
+              "                         Maximum number of tokens that template instantiation\n"
+              "                         is allowed to generate in a file before further\n"
+              "                         instantiations are skipped and an information message\n"
+              "                         is written. Default is 0 = no limit.\n"
+              "    --max-time-per-file=<seconds>\n"
+              "                         Soft deadline for checking one file. When it passes,\n"
+              "                         the remaining passes and configurations of the file\n"
+              "                         are abandoned, the findings so far are reported and\n"
+              "                         an information message is written. Default is 0 = no\n"
+              "                         deadline.\n"
+              "    --order=<order>      The order the input files are analyzed in:\n"
+              "                          * size\n"
+              "                                 Biggest files first (default).\n"
+              "                          * mtime\n"
+              "                                 Recently modified files first, for the\n"
+              "                                 fastest time to a finding in freshly\n"
+              "                                 edited code.\n"
               "    --platform=<type>, --platform=<file>\n"
               "                         Specifies platform specific types and sizes. The\n"
               "                         available builtin platforms are:\n"
@@ -1059,6 +1334,11 @@ void CmdLineParser::printHelp()
               "                                 Unknown type sizes\n"
               "    --plist-output=<path>\n"
               "                         Generate Clang-plist output files in folder.\n"
+              "    --plugin=<lib>       Load a native check plugin: a shared object whose\n"
+              "                         static Check instances register themselves on load\n"
+              "                         and then run like the built-in checks, with full\n"
+              "                         token and symbol information. A fast alternative\n"
+              "                         to regex rules for custom checks.\n"
               "    -q, --quiet          Do not show progress reports.\n"
               "    -rp, --relative-paths\n"
               "    -rp=<paths>, --relative-paths=<paths>\n"
@@ -1075,6 +1355,12 @@ void CmdLineParser::printHelp()
               "    --rule-file=<file>   Use given rule file. For more information, see: \n"
               "                         http://sourceforge.net/projects/cppcheck/files/Articles/\n"
 #endif
+              "    --sarif=<file>       Write results in SARIF format to the given file. The\n"
+              "                         file is written incrementally while checking, so no\n"
+              "                         separate conversion pass is needed afterwards.\n"
+              "    --sorted-results     Report the results sorted and deduplicated at the end\n"
+              "                         of the run. The workers write sorted result shards\n"
+              "                         that are merged with bounded memory use. Requires -j.\n"
               "    --std=<id>           Set standard.\n"
               "                         The available options are:\n"
               "                          * posix\n"
@@ -1093,6 +1379,11 @@ void CmdLineParser::printHelp()
               "                                 C++ code is C++14 compatible (default)\n"
               "                         More than one --std can be used:\n"
               "                           'cppcheck --std=c99 --std=posix file.c'\n"
+              "    --sub-check-budget=<ms>\n"
+              "                         Wall-time budget in milliseconds for one sub-check on\n"
+              "                         one file. A sub-check that overruns the budget is\n"
+              "                         reported and skipped for the rest of the run. Default\n"
+              "                         is 0 (no budget).\n"
               "    --suppress=<spec>    Suppress warnings that match <spec>. The format of\n"
               "                         <spec> is:\n"
               "                         [error id]:[filename]:[line]\n"
@@ -1136,7 +1427,18 @@ void CmdLineParser::printHelp()
               "                           \\r         insert carriage return\n"
               "                         Example format (gcc-like):\n"
               "                         '{file}:{line}:{column}: note: {info}\\n{code}'\n"
+              "    --trace-report=<file>\n"
+              "                         Write the timer runs in Chrome trace event format to\n"
+              "                         the given file, for chrome://tracing and compatible\n"
+              "                         viewers.\n"
               "    -v, --verbose        Output more detailed error information.\n"
+              "    --valueflow-max-effort=<limit>\n"
+              "                         Maximum number of token visits value flow analysis\n"
+              "                         may spend inside one function. Functions that use up\n"
+              "                         the budget are analyzed with reduced precision.\n"
+              "                         Default is 0 = no limit.\n"
+              "    --valueflow-stats    Write value flow statistics (values added per pass,\n"
+              "                         bailouts fired) for each file as JSON.\n"
               "    --version            Print out version number.\n"
               "    --xml                Write results in xml format to error stream (stderr).\n"
               "    --xml-version=<version>\n"
@@ -93,6 +93,13 @@ public:
         return mIgnoredPaths;
     }
 
+    /**
+     * Age limit in days given with --build-dir-gc, 0 if not given.
+     */
+    int getBuildDirGCDays() const {
+        return mBuildDirGCDays;
+    }
+
 protected:
 
     /**
@@ -114,6 +121,7 @@ private:
     bool mShowVersion;
     bool mShowErrorMessages;
     bool mExitAfterPrint;
+    int mBuildDirGCDays;
 };
 
 /// @}
@@ -29,21 +29,42 @@
 #include "pathmatch.h"
 #include "preprocessor.h"
 #include "settings.h"
+#include "simplecpp.h"
 #include "standards.h"
 #include "suppressions.h"
 #include "threadexecutor.h"
 #include "utils.h"
 #include "checkunusedfunctions.h"
 
+#include <algorithm>
+#include <cctype>
 #include <csignal>
 #include <cstdio>
 #include <cstdlib> // EXIT_SUCCESS and EXIT_FAILURE
 #include <cstring>
+#include <ctime>
+#include <fstream>
 #include <iostream>
 #include <list>
+#include <thread>
 #include <utility>
 #include <vector>
 
+#if !defined(_WIN32)
+#include <sys/resource.h> // getrusage, for --perf-report
+#endif
+
+/** Peak resident set size so far, as reported by the OS */
+static long currentPeakRssKb()
+{
+#if !defined(_WIN32)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return usage.ru_maxrss;
+#endif
+    return 0;
+}
+
 #if !defined(NO_UNIX_SIGNAL_HANDLING) && defined(__GNUC__) && !defined(__MINGW32__) && !defined(__OS2__)
 #define USE_UNIX_SIGNAL_HANDLING
 #include <unistd.h>
@@ -75,17 +96,94 @@
 #include <excpt.h>
 #endif
 
+// for --build-dir-gc
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+#include <sys/stat.h>
+
 
 /*static*/ FILE* CppCheckExecutor::exceptionOutput = stdout;
 
 CppCheckExecutor::CppCheckExecutor()
-    : _settings(nullptr), latestProgressOutputTime(0), errorOutput(nullptr), errorlist(false)
+    : _settings(nullptr), latestProgressOutputTime(0), errorOutput(nullptr), sarifOutput(nullptr), _sarifResultCount(0), errorlist(false)
 {
 }
 
 CppCheckExecutor::~CppCheckExecutor()
 {
+    flushErrorOutput();
     delete errorOutput;
+    closeSarifOutput();
+}
+
+/** Is this the name of an analyzer info file? Also matches the temporary
+ * that an interrupted run leaves behind. */
+static bool isAnalyzerInfoName(std::string name)
+{
+    if (endsWith(name, ".tmp", 4))
+        name.erase(name.size() - 4);
+    if (endsWith(name, ".analyzerinfo", 13))
+        return true;
+    // basename.a<N>, the naming used in files.txt
+    const std::string::size_type pos = name.rfind(".a");
+    if (pos == std::string::npos || pos + 2 >= name.size())
+        return false;
+    for (std::string::size_type i = pos + 2; i < name.size(); ++i) {
+        if (!std::isdigit(static_cast<unsigned char>(name[i])))
+            return false;
+    }
+    return true;
+}
+
+/** Remove analyzer information that has not been used for the given number
+ * of days. AnalyzerInformation updates the modification time of an entry
+ * whenever its results are reused, so the mtime is the time of last use. */
+static void gcAnalyzerInfo(const std::string &dir, int days)
+{
+    std::vector<std::string> names;
+#ifdef _WIN32
+    WIN32_FIND_DATAA ffd;
+    HANDLE hFind = FindFirstFileA((dir + "\\*").c_str(), &ffd);
+    if (hFind != INVALID_HANDLE_VALUE) {
+        do {
+            if (!(ffd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+                names.push_back(ffd.cFileName);
+        } while (FindNextFileA(hFind, &ffd) != FALSE);
+        FindClose(hFind);
+    }
+#else
+    DIR * const d = opendir(dir.c_str());
+    if (d) {
+        while (const dirent * const entry = readdir(d)) {
+            if (entry->d_name[0] != '.')
+                names.push_back(entry->d_name);
+        }
+        closedir(d);
+    }
+#endif
+
+    const std::time_t limit = std::time(nullptr) - std::time_t(days) * 24 * 60 * 60;
+    std::size_t removed = 0;
+    unsigned long long removedBytes = 0;
+    for (const std::string &name : names) {
+        if (!isAnalyzerInfoName(name))
+            continue;
+        const std::string path = dir + '/' + name;
+        struct stat filestat;
+        if (stat(path.c_str(), &filestat) != 0)
+            continue;
+        if (filestat.st_mtime >= limit)
+            continue;
+        if (std::remove(path.c_str()) == 0) {
+            ++removed;
+            removedBytes += static_cast<unsigned long long>(filestat.st_size);
+        }
+    }
+    std::cout << "cppcheck: " << dir << ": removed " << removed << " unused analyzer info file(s), "
+              << (removedBytes + 1023) / 1024 << " kb" << std::endl;
 }
 
 bool CppCheckExecutor::parseFromArgs(CppCheck *cppcheck, int argc, const char* const argv[])
@@ -111,6 +209,15 @@ bool CppCheckExecutor::parseFromArgs(CppCheck *cppcheck, int argc, const char* c
             std::cout << ErrorLogger::ErrorMessage::getXMLFooter() << std::endl;
         }
 
+        if (parser.getBuildDirGCDays() > 0) {
+            if (settings.buildDir.empty() && settings.cacheDir.empty())
+                std::cout << "cppcheck: --build-dir-gc needs a directory, use --cppcheck-build-dir and/or --cppcheck-cache-dir." << std::endl;
+            if (!settings.buildDir.empty())
+                gcAnalyzerInfo(settings.buildDir, parser.getBuildDirGCDays());
+            if (!settings.cacheDir.empty())
+                gcAnalyzerInfo(settings.cacheDir, parser.getBuildDirGCDays());
+        }
+
         if (parser.exitAfterPrinting()) {
             settings.terminate();
             return true;
@@ -159,13 +266,23 @@ bool CppCheckExecutor::parseFromArgs(CppCheck *cppcheck, int argc, const char* c
     const bool caseSensitive = true;
 #endif
     if (!pathnames.empty()) {
+#if defined(THREADING_MODEL_FORK)
+        if (settings.jobs > 1 && ThreadExecutor::isEnabled()) {
+            // Defer the directory scan - check_internal() runs it on a
+            // separate thread and streams the discovered files to the
+            // worker processes, overlapping the scan with the analysis
+            _deferredScanPaths = pathnames;
+            _deferredIgnoredPaths = ignored;
+            return true;
+        }
+#endif
         // Execute recursiveAddFiles() to each given file parameter
         const PathMatch matcher(ignored, caseSensitive);
         for (std::vector<std::string>::const_iterator iter = pathnames.begin(); iter != pathnames.end(); ++iter)
             FileLister::recursiveAddFiles(_files, Path::toNativeSeparators(*iter), _settings->library.markupExtensions(), matcher);
     }
 
-    if (_files.empty() && settings.project.fileSettings.empty()) {
+    if (_files.empty() && settings.project.fileSettings.empty() && !settings.daemon) {
         std::cout << "cppcheck: error: could not find or open any of the paths given." << std::endl;
         if (!ignored.empty())
             std::cout << "cppcheck: Maybe all paths were ignored?" << std::endl;
@@ -293,7 +410,7 @@ static void print_stacktrace(FILE* output, bool demangling, int maxdepth, bool l
 #endif
 }
 
-static const size_t MYSTACKSIZE = 16*1024+SIGSTKSZ; // wild guess about a reasonable buffer
+static const size_t MYSTACKSIZE = 16*1024+32768; // wild guess about a reasonable buffer, 32768 is the traditional SIGSTKSZ which is no longer a compile-time constant in recent glibc
 static char mytstack[MYSTACKSIZE]= {0}; // alternative stack for signal handler
 static bool bStackBelowHeap=false; // lame attempt to locate heap vs. stack address space. See CppCheckExecutor::check_wrapper()
 
@@ -843,11 +960,28 @@ int CppCheckExecutor::check_internal(CppCheck& cppcheck, int /*argc*/, const cha
         errorOutput = new std::ofstream(settings.outputFile);
     }
 
+    if (!settings.sarifOutput.empty()) {
+        sarifOutput = new std::ofstream(settings.sarifOutput);
+        if (!sarifOutput->is_open()) {
+            std::cerr << "cppcheck: Failed to open SARIF output file '" << settings.sarifOutput << "'." << std::endl;
+            delete sarifOutput;
+            sarifOutput = nullptr;
+            return EXIT_FAILURE;
+        }
+        // the results are streamed while checking; the rules and artifacts
+        // they reference follow in the footer, JSON members are unordered
+        *sarifOutput << "{\"version\":\"2.1.0\","
+                     << "\"$schema\":\"https://raw.githubusercontent.com/oasis-tcs/sarif-spec/master/Schemas/sarif-schema-2.1.0.json\","
+                     << "\"runs\":[\n  {\"results\":[";
+    }
+
     if (settings.xml) {
         reportErr(ErrorLogger::ErrorMessage::getXMLHeader());
     }
 
-    if (!settings.buildDir.empty()) {
+    // files.txt records the whole project for the whole program analysis; a
+    // single file re-check must not overwrite it with just one entry
+    if (!settings.buildDir.empty() && settings.recheckFile.empty()) {
         std::list<std::string> fileNames;
         for (std::map<std::string, std::size_t>::const_iterator i = _files.begin(); i != _files.end(); ++i)
             fileNames.push_back(i->first);
@@ -855,7 +989,34 @@ int CppCheckExecutor::check_internal(CppCheck& cppcheck, int /*argc*/, const cha
     }
 
     unsigned int returnValue = 0;
-    if (settings.jobs == 1) {
+    std::map<std::string, double> fileTimes;
+    // peak RSS after the file was checked; the peak only grows, so this
+    // shows which file made it jump
+    std::map<std::string, long> filePeakRss;
+    if (settings.daemon) {
+        // Resident mode. The settings and the library configurations loaded
+        // above are reused for every request, so a request costs only the
+        // analysis itself and not the process startup. Each line read from
+        // stdin is one source file to check; a terminator line on stdout
+        // tells the client that the results for the request are complete.
+        std::string path;
+        while (std::getline(std::cin, path)) {
+            if (path.empty())
+                continue;
+            // each request reports independently, even when the same file is
+            // checked again and produces the same findings
+            _errorList.clear();
+            // the header caches assume the headers do not change during one
+            // run; between daemon requests they may have been edited
+            simplecpp::clearHeaderCache();
+            CppCheck fileChecker(*this, true);
+            fileChecker.settings() = settings;
+            const unsigned int result = fileChecker.check(Path::fromNativeSeparators(path));
+            returnValue += result;
+            // flush so a client blocked on the pipe sees the terminator
+            std::cout << "<daemon-done exitcode=\"" << result << "\"/>" << std::endl;
+        }
+    } else if (settings.jobs == 1) {
         // Single process
         settings.jointSuppressionReport = true;
 
@@ -864,12 +1025,31 @@ int CppCheckExecutor::check_internal(CppCheck& cppcheck, int /*argc*/, const cha
             totalfilesize += i->second;
         }
 
+        // --order=mtime: check recently modified files first so findings in
+        // freshly edited code surface early
+        std::vector<std::pair<std::string, std::size_t> > filelist(_files.begin(), _files.end());
+        if (settings.analysisOrder == "mtime") {
+            std::map<std::string, time_t> mtime;
+            for (std::vector<std::pair<std::string, std::size_t> >::const_iterator i = filelist.begin(); i != filelist.end(); ++i) {
+                struct stat sb;
+                mtime[i->first] = (stat(i->first.c_str(), &sb) == 0) ? sb.st_mtime : 0;
+            }
+            std::stable_sort(filelist.begin(), filelist.end(), [&](const std::pair<std::string, std::size_t> &f1, const std::pair<std::string, std::size_t> &f2) {
+                return mtime[f1.first] > mtime[f2.first];
+            });
+        }
+
         std::size_t processedsize = 0;
         unsigned int c = 0;
-        for (std::map<std::string, std::size_t>::const_iterator i = _files.begin(); i != _files.end(); ++i) {
+        for (std::vector<std::pair<std::string, std::size_t> >::const_iterator i = filelist.begin(); i != filelist.end(); ++i) {
             if (!_settings->library.markupFile(i->first)
                 || !_settings->library.processMarkupAfterCode(i->first)) {
+                const std::clock_t checkStart = std::clock();
                 returnValue += cppcheck.check(i->first);
+                if (!settings.perfReport.empty()) {
+                    fileTimes[i->first] += (double)(std::clock() - checkStart) / CLOCKS_PER_SEC;
+                    filePeakRss[i->first] = currentPeakRssKb();
+                }
                 processedsize += i->second;
                 if (!settings.quiet)
                     reportStatus(c + 1, _files.size(), processedsize, totalfilesize);
@@ -880,7 +1060,12 @@ int CppCheckExecutor::check_internal(CppCheck& cppcheck, int /*argc*/, const cha
         // filesettings
         c = 0;
         for (std::list<ImportProject::FileSettings>::const_iterator fs = settings.project.fileSettings.begin(); fs != settings.project.fileSettings.end(); ++fs) {
+            const std::clock_t checkStart = std::clock();
             returnValue += cppcheck.check(*fs);
+            if (!settings.perfReport.empty()) {
+                fileTimes[fs->filename] += (double)(std::clock() - checkStart) / CLOCKS_PER_SEC;
+                filePeakRss[fs->filename] = currentPeakRssKb();
+            }
             ++c;
             if (!settings.quiet)
                 reportStatus(c, settings.project.fileSettings.size(), c, settings.project.fileSettings.size());
@@ -890,7 +1075,12 @@ int CppCheckExecutor::check_internal(CppCheck& cppcheck, int /*argc*/, const cha
         // c/cpp files have been parsed and checked
         for (std::map<std::string, std::size_t>::const_iterator i = _files.begin(); i != _files.end(); ++i) {
             if (_settings->library.markupFile(i->first) && _settings->library.processMarkupAfterCode(i->first)) {
+                const std::clock_t checkStart = std::clock();
                 returnValue += cppcheck.check(i->first);
+                if (!settings.perfReport.empty()) {
+                    fileTimes[i->first] += (double)(std::clock() - checkStart) / CLOCKS_PER_SEC;
+                    filePeakRss[i->first] = currentPeakRssKb();
+                }
                 processedsize += i->second;
                 if (!settings.quiet)
                     reportStatus(c + 1, _files.size(), processedsize, totalfilesize);
@@ -904,7 +1094,45 @@ int CppCheckExecutor::check_internal(CppCheck& cppcheck, int /*argc*/, const cha
     } else {
         // Multiple processes
         ThreadExecutor executor(_files, settings, *this);
+
+        // Deferred file enumeration: scan the paths on a separate thread
+        // and stream the files to the workers as they are discovered, so
+        // the scan overlaps with the analysis instead of preceding it
+        std::thread enumerationThread;
+        std::map<std::string, std::size_t> streamedFiles;
+        if (!_deferredScanPaths.empty()) {
+            executor.enableStreaming();
+            enumerationThread = std::thread([&]() {
+#if defined(_WIN32)
+                const bool caseSensitive = false;
+#else
+                const bool caseSensitive = true;
+#endif
+                const PathMatch matcher(_deferredIgnoredPaths, caseSensitive);
+                for (const std::string &path : _deferredScanPaths) {
+                    std::map<std::string, std::size_t> found;
+                    FileLister::recursiveAddFiles(found, Path::toNativeSeparators(path), settings.library.markupExtensions(), matcher);
+                    for (const std::pair<const std::string, std::size_t> &f : found) {
+                        if (streamedFiles.insert(f).second)
+                            executor.addFileJob(f.first, f.second);
+                    }
+                }
+                executor.endOfFiles();
+            });
+        }
+
         returnValue = executor.check();
+
+        if (enumerationThread.joinable())
+            enumerationThread.join();
+        // the post-run reporting below iterates the file map
+        _files.insert(streamedFiles.begin(), streamedFiles.end());
+        if (_files.empty() && settings.project.fileSettings.empty()) {
+            std::cout << "cppcheck: error: could not find or open any of the paths given." << std::endl;
+            if (!_deferredIgnoredPaths.empty())
+                std::cout << "cppcheck: Maybe all paths were ignored?" << std::endl;
+            return EXIT_FAILURE;
+        }
     }
 
     cppcheck.analyseWholeProgram(_settings->buildDir, _files);
@@ -947,14 +1175,123 @@ int CppCheckExecutor::check_internal(CppCheck& cppcheck, int /*argc*/, const cha
 
     if (settings.xml) {
         reportErr(ErrorLogger::ErrorMessage::getXMLFooter());
+        flushErrorOutput();
     }
 
+    closeSarifOutput();
+
+    if (!settings.perfReport.empty())
+        writePerfReport(cppcheck, fileTimes, filePeakRss);
+
+#if defined(THREADING_MODEL_FORK)
+    // with worker processes the executor merged their trace shards, the
+    // trace collected in this process would overwrite the merged file
+    const bool traceWrittenByExecutor = (settings.jobs > 1 && ThreadExecutor::isEnabled());
+#else
+    const bool traceWrittenByExecutor = false;
+#endif
+    if (!settings.traceReport.empty() && !traceWrittenByExecutor)
+        writeTraceReport();
+
     _settings = nullptr;
     if (returnValue)
         return settings.exitCode;
     return 0;
 }
 
+/** Quote and escape a string for JSON output. Not named toJson: inside the
+ * member functions below an unqualified toJson() would bind to
+ * ErrorLogger::toJson(), which escapes but does not add the quotes. */
+static std::string jsonString(const std::string &str)
+{
+    return '"' + ErrorLogger::toJson(str) + '"';
+}
+
+static bool slowerFile(const std::pair<std::string, double> &lhs, const std::pair<std::string, double> &rhs)
+{
+    return lhs.second > rhs.second;
+}
+
+void CppCheckExecutor::writePerfReport(const CppCheck &cppcheck, const std::map<std::string, double> &fileTimes, const std::map<std::string, long> &filePeakRss) const
+{
+    std::ofstream fout(_settings->perfReport);
+    if (!fout.is_open()) {
+        std::cerr << "cppcheck: Failed to open performance report file '" << _settings->perfReport << "'." << std::endl;
+        return;
+    }
+
+    std::size_t totalfilesize = 0;
+    for (std::map<std::string, std::size_t>::const_iterator i = _files.begin(); i != _files.end(); ++i)
+        totalfilesize += i->second;
+
+    const long peakRssKb = currentPeakRssKb();
+
+    fout << "{\n";
+    fout << "    \"version\": " << jsonString(CppCheck::version()) << ",\n";
+    fout << "    \"jobs\": " << _settings->jobs << ",\n";
+    fout << "    \"files\": " << _files.size() << ",\n";
+    fout << "    \"totalFileSize\": " << totalfilesize << ",\n";
+    fout << "    \"peakRssKb\": " << peakRssKb << ",\n";
+
+    const AnalyzerInformation::Statistics &stats = cppcheck.analyzerStatistics();
+    fout << "    \"analyzerCache\": {\n"
+         << "        \"reused\": " << stats.reused << ",\n"
+         << "        \"cacheHits\": " << stats.cacheHits << ",\n"
+         << "        \"analyzedNew\": " << stats.analyzedNew << ",\n"
+         << "        \"analyzedChanged\": " << stats.analyzedChanged << "\n"
+         << "    },\n";
+
+    // Allocation accounting of the big pools, see MemUsage. The high
+    // water mark is the most the pool held at the same time.
+    fout << "    \"memoryPools\": {";
+    for (int pool = 0; pool < MemUsage::POOL_COUNT; ++pool) {
+        fout << (pool == 0 ? "\n" : ",\n")
+             << "        " << jsonString(MemUsage::poolName((MemUsage::Pool)pool))
+             << ": { \"allocatedBytes\": " << MemUsage::allocatedBytes((MemUsage::Pool)pool)
+             << ", \"highWaterBytes\": " << MemUsage::highWaterBytes((MemUsage::Pool)pool) << " }";
+    }
+    fout << "\n    },\n";
+
+    // Phase timings. These are empty when the checking ran in worker
+    // processes (-j) since the timings are collected per process.
+    fout << "    \"phases\": {";
+    const std::map<std::string, TimerResultsData> &timerResults = CppCheck::timerResults().results();
+    for (std::map<std::string, TimerResultsData>::const_iterator i = timerResults.begin(); i != timerResults.end(); ++i) {
+        fout << (i == timerResults.begin() ? "\n" : ",\n")
+             << "        " << jsonString(i->first)
+             << ": { \"seconds\": " << i->second.seconds()
+             << ", \"results\": " << i->second.mNumberOfResults
+             << ", \"allocBytes\": " << i->second.mAllocBytes << " }";
+    }
+    fout << (timerResults.empty() ? "},\n" : "\n    },\n");
+
+    // The files that took the longest to check
+    std::vector<std::pair<std::string, double> > slowestFiles(fileTimes.begin(), fileTimes.end());
+    std::sort(slowestFiles.begin(), slowestFiles.end(), slowerFile);
+    if (slowestFiles.size() > 10)
+        slowestFiles.resize(10);
+    fout << "    \"slowestFiles\": [";
+    for (std::vector<std::pair<std::string, double> >::const_iterator i = slowestFiles.begin(); i != slowestFiles.end(); ++i) {
+        const std::map<std::string, long>::const_iterator rss = filePeakRss.find(i->first);
+        fout << (i == slowestFiles.begin() ? "\n" : ",\n")
+             << "        { \"file\": " << jsonString(i->first)
+             << ", \"seconds\": " << i->second
+             << ", \"peakRssKb\": " << (rss == filePeakRss.end() ? 0L : rss->second) << " }";
+    }
+    fout << (slowestFiles.empty() ? "]\n" : "\n    ]\n");
+    fout << "}\n";
+}
+
+void CppCheckExecutor::writeTraceReport() const
+{
+    std::ofstream fout(_settings->traceReport);
+    if (!fout.is_open()) {
+        std::cerr << "cppcheck: Failed to open trace report file '" << _settings->traceReport << "'." << std::endl;
+        return;
+    }
+    CppCheck::timerResults().writeChromeTrace(fout);
+}
+
 #ifdef _WIN32
 // fix trac ticket #439 'Cppcheck reports wrong filename for filenames containing 8-bit ASCII'
 static inline std::string ansiToOEM(const std::string &msg, bool doConvert)
@@ -986,13 +1323,34 @@ void CppCheckExecutor::reportErr(const std::string &errmsg)
         return;
 
     _errorList.insert(errmsg);
-    if (errorOutput)
+    if (_settings && _settings->xml) {
+        // XML output is written in large chunks; writing every message
+        // separately costs one syscall per finding.
+        _errorBuffer += errmsg;
+        _errorBuffer += '\n';
+        if (_errorBuffer.size() >= 65536)
+            flushErrorOutput();
+    } else if (errorOutput)
         *errorOutput << errmsg << std::endl;
     else {
         std::cerr << ansiToOEM(errmsg, (_settings == nullptr) ? true : !_settings->xml) << std::endl;
     }
 }
 
+void CppCheckExecutor::flushErrorOutput()
+{
+    if (_errorBuffer.empty())
+        return;
+    if (errorOutput) {
+        errorOutput->write(_errorBuffer.data(), _errorBuffer.size());
+        errorOutput->flush();
+    } else {
+        std::cerr.write(_errorBuffer.data(), _errorBuffer.size());
+        std::cerr.flush();
+    }
+    _errorBuffer.clear();
+}
+
 void CppCheckExecutor::reportOut(const std::string &outmsg)
 {
     std::cout << ansiToOEM(outmsg, true) << std::endl;
@@ -1029,11 +1387,38 @@ void CppCheckExecutor::reportInfo(const ErrorLogger::ErrorMessage &msg)
 void CppCheckExecutor::reportStatus(std::size_t fileindex, std::size_t filecount, std::size_t sizedone, std::size_t sizetotal)
 {
     if (filecount > 1) {
+        static std::time_t startTime;
+        static std::time_t latestStatusOutputTime;
+        const std::time_t currentTime = std::time(nullptr);
+        if (fileindex <= 1 || startTime == 0) {
+            startTime = currentTime;
+            latestStatusOutputTime = 0;
+        }
+
+        // Print the aggregated status at most once per second. With many
+        // small files and many jobs a line per completed file slows the
+        // parent down with terminal/pipe writes. The last file is always
+        // reported so the output ends with "N/N files checked".
+        if (fileindex < filecount && currentTime == latestStatusOutputTime)
+            return;
+        latestStatusOutputTime = currentTime;
+
         std::ostringstream oss;
         const long percentDone = (sizetotal > 0) ? static_cast<long>(static_cast<long double>(sizedone) / sizetotal * 100) : 0;
         oss << fileindex << '/' << filecount
             << " files checked " << percentDone
             << "% done";
+
+        // Size-weighted time estimate for the rest of the run
+        const std::time_t elapsed = currentTime - startTime;
+        if (elapsed > 0 && sizedone > 0 && sizedone < sizetotal) {
+            const long etaSeconds = static_cast<long>(static_cast<long double>(sizetotal - sizedone) * elapsed / sizedone);
+            if (etaSeconds >= 60)
+                oss << " (ETA " << (etaSeconds + 59) / 60 << " min)";
+            else
+                oss << " (ETA " << etaSeconds << " s)";
+        }
+
         std::cout << oss.str() << std::endl;
     }
 }
@@ -1042,11 +1427,86 @@ void CppCheckExecutor::reportErr(const ErrorLogger::ErrorMessage &msg)
 {
     if (errorlist) {
         reportOut(msg.toXML());
-    } else if (_settings->xml) {
-        reportErr(msg.toXML());
-    } else {
-        reportErr(msg.toString(_settings->verbose, _settings->templateFormat, _settings->templateLocation));
+        return;
+    }
+
+    const std::string formatted = _settings->xml ?
+                                  msg.toXML() :
+                                  msg.toString(_settings->verbose, _settings->templateFormat, _settings->templateLocation);
+
+    // stream the result to the SARIF file; the same duplicate filter is
+    // used as for the normal output, so check it before the insert below
+    if (sarifOutput && _errorList.find(formatted) == _errorList.end())
+        writeSarifResult(msg);
+
+    reportErr(formatted);
+}
+
+void CppCheckExecutor::writeSarifResult(const ErrorLogger::ErrorMessage &msg)
+{
+    std::ostream &out = *sarifOutput;
+    if (_sarifResultCount > 0)
+        out << ',';
+    ++_sarifResultCount;
+    _sarifRules.insert(std::make_pair(msg.id(), msg._severity));
+
+    out << "\n   {\"ruleId\":\"" << ErrorLogger::toJson(msg.id())
+        << "\",\"level\":\"" << ErrorLogger::sarifLevel(msg._severity)
+        << "\",\"message\":{\"text\":\"" << ErrorLogger::toJson(msg.shortMessage())
+        << "\"},\"locations\":[";
+    bool firstLocation = true;
+    for (std::list<ErrorLogger::ErrorMessage::FileLocation>::const_iterator loc = msg._callStack.begin(); loc != msg._callStack.end(); ++loc) {
+        const std::string file = loc->getfile();
+        // intern the artifact record; the result references it by index
+        const std::map<std::string, unsigned int>::const_iterator it = _sarifArtifacts.find(file);
+        const unsigned int index = (it != _sarifArtifacts.end()) ?
+                                   it->second :
+                                   _sarifArtifacts.insert(std::make_pair(file, static_cast<unsigned int>(_sarifArtifacts.size()))).first->second;
+        if (!firstLocation)
+            out << ',';
+        firstLocation = false;
+        out << "{\"physicalLocation\":{\"artifactLocation\":{\"uri\":\"" << ErrorLogger::toJson(file)
+            << "\",\"index\":" << index
+            << "},\"region\":{\"startLine\":" << (loc->line > 0 ? loc->line : 1);
+        if (loc->col > 0)
+            out << ",\"startColumn\":" << loc->col;
+        out << "}}}";
+    }
+    out << "]}";
+
+    // one flush per result so the file is usable while checking is running
+    out.flush();
+}
+
+void CppCheckExecutor::closeSarifOutput()
+{
+    if (!sarifOutput)
+        return;
+
+    std::ostream &out = *sarifOutput;
+    out << "\n   ],\n   \"tool\":{\"driver\":{\"name\":\"Cppcheck\",\"version\":\"" << CppCheck::version() << "\",\"rules\":[";
+    bool first = true;
+    for (std::map<std::string, Severity::SeverityType>::const_iterator rule = _sarifRules.begin(); rule != _sarifRules.end(); ++rule) {
+        if (!first)
+            out << ',';
+        first = false;
+        out << "\n    {\"id\":\"" << ErrorLogger::toJson(rule->first)
+            << "\",\"defaultConfiguration\":{\"level\":\"" << ErrorLogger::sarifLevel(rule->second) << "\"}}";
+    }
+    out << "]}},\n   \"artifacts\":[";
+    // the artifact records in index order
+    std::vector<const std::string *> artifacts(_sarifArtifacts.size(), nullptr);
+    for (std::map<std::string, unsigned int>::const_iterator it = _sarifArtifacts.begin(); it != _sarifArtifacts.end(); ++it)
+        artifacts[it->second] = &it->first;
+    for (std::size_t i = 0; i < artifacts.size(); ++i) {
+        if (i > 0)
+            out << ',';
+        out << "\n    {\"location\":{\"uri\":\"" << ErrorLogger::toJson(*artifacts[i]) << "\"}}";
     }
+    out << "]}\n]}\n";
+
+    delete sarifOutput;
+    sarifOutput = nullptr;
 }
 
 void CppCheckExecutor::setExceptionOutput(FILE* exception_output)
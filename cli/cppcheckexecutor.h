@@ -26,6 +26,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 class CppCheck;
 class Library;
@@ -108,6 +109,11 @@ public:
 
 protected:
 
+    /**
+     * Write the buffered XML error output, one write per flush.
+     */
+    void flushErrorOutput();
+
     /**
      * Helper function to print out errors. Appends a line change.
      * @param errmsg String printed to error stream
@@ -157,6 +163,35 @@ private:
     */
     int check_internal(CppCheck& cppcheck, int argc, const char* const argv[]);
 
+    /**
+     * Write the --perf-report JSON file.
+     *
+     * @param cppcheck cppcheck instance
+     * @param fileTimes seconds spent checking each file, empty when the
+     *        checking ran in worker processes
+     * @param filePeakRss peak RSS in kb after each file was checked
+     */
+    void writePerfReport(const CppCheck &cppcheck, const std::map<std::string, double> &fileTimes, const std::map<std::string, long> &filePeakRss) const;
+
+    /**
+     * Write the --trace-report Chrome trace file. Empty when the checking
+     * ran in worker processes since the timings are collected per process.
+     */
+    void writeTraceReport() const;
+
+    /**
+     * Append one result to the --sarif output file. The results are
+     * streamed as they arrive; only the seen rule ids and artifact names
+     * are kept in memory for the footer, see closeSarifOutput().
+     */
+    void writeSarifResult(const ErrorLogger::ErrorMessage &msg);
+
+    /**
+     * Write the rules and artifacts collected by writeSarifResult() and
+     * close the --sarif output file.
+     */
+    void closeSarifOutput();
+
     /**
      * Pointer to current settings; set while check() is running.
      */
@@ -167,11 +202,29 @@ private:
      */
     std::set<std::string> _errorList;
 
+    /**
+     * Buffered XML error output, flushed in large chunks so half a million
+     * findings do not cause one write syscall each.
+     */
+    std::string _errorBuffer;
+
     /**
      * Filename associated with size of file
      */
     std::map<std::string, std::size_t> _files;
 
+    /**
+     * Paths whose directory scan was deferred so the multi-process executor
+     * can stream the discovered files to the workers while the scan is
+     * still running, see parseFromArgs() and check_internal().
+     */
+    std::vector<std::string> _deferredScanPaths;
+
+    /**
+     * Ignored paths for the deferred directory scan.
+     */
+    std::vector<std::string> _deferredIgnoredPaths;
+
     /**
      * Report progress time
      */
@@ -187,6 +240,28 @@ private:
      */
     std::ofstream *errorOutput;
 
+    /**
+     * SARIF output file, nullptr unless --sarif= was given.
+     */
+    std::ofstream *sarifOutput;
+
+    /**
+     * Rule id => severity of the rules seen in the SARIF results, for the
+     * rules record in the footer.
+     */
+    std::map<std::string, Severity::SeverityType> _sarifRules;
+
+    /**
+     * File name => index of the interned SARIF artifact records; the
+     * results reference the files by index.
+     */
+    std::map<std::string, unsigned int> _sarifArtifacts;
+
+    /**
+     * Number of results written to the SARIF output so far.
+     */
+    unsigned int _sarifResultCount;
+
     /**
      * Has --errorlist been given?
      */
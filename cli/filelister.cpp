@@ -141,7 +141,10 @@ void FileLister::addFiles(std::map<std::string, std::size_t> &files, const std::
         } else {
             // Directory
             if (recursive) {
-                if (!ignored.match(fname))
+                // Also match with a trailing '/' so that directory masks like
+                // "-isrc/" prune the whole subtree instead of the files in it
+                // being matched one by one.
+                if (!ignored.match(fname) && !ignored.match(fname + '/'))
                     FileLister::recursiveAddFiles(files, fname, extra, ignored);
             }
         }
@@ -175,6 +178,9 @@ bool FileLister::fileExists(const std::string &path)
 #include <sys/stat.h>
 
 
+// Add the files in the directory 'path'. The caller has already determined
+// that the path is a directory, so it is not stat()'ed again here for every
+// level of the recursion.
 static void addFiles2(std::map<std::string, std::size_t> &files,
                       const std::string &path,
                       const std::set<std::string> &extra,
@@ -182,46 +188,44 @@ static void addFiles2(std::map<std::string, std::size_t> &files,
                       const PathMatch& ignored
                      )
 {
-    struct stat file_stat;
-    if (stat(path.c_str(), &file_stat) != -1) {
-        if ((file_stat.st_mode & S_IFMT) == S_IFDIR) {
-            DIR * dir = opendir(path.c_str());
-            if (!dir)
-                return;
+    DIR * dir = opendir(path.c_str());
+    if (!dir)
+        return;
 
-            dirent entry;
-            dirent * dir_result;
-            std::string new_path;
-            new_path.reserve(path.length() + 100);// prealloc some memory to avoid constant new/deletes in loop
+    struct stat file_stat;
+    dirent entry;
+    dirent * dir_result;
+    std::string new_path;
+    new_path.reserve(path.length() + 100);// prealloc some memory to avoid constant new/deletes in loop
 
-            while ((readdir_r(dir, &entry, &dir_result) == 0) && (dir_result != nullptr)) {
+    while ((readdir_r(dir, &entry, &dir_result) == 0) && (dir_result != nullptr)) {
 
-                if ((std::strcmp(dir_result->d_name, ".") == 0) ||
-                    (std::strcmp(dir_result->d_name, "..") == 0))
-                    continue;
+        if ((std::strcmp(dir_result->d_name, ".") == 0) ||
+            (std::strcmp(dir_result->d_name, "..") == 0))
+            continue;
 
-                new_path = path + '/' + dir_result->d_name;
+        new_path = path + '/' + dir_result->d_name;
 
 #if defined(_DIRENT_HAVE_D_TYPE) || defined(_BSD_SOURCE)
-                bool path_is_directory = (dir_result->d_type == DT_DIR || (dir_result->d_type == DT_UNKNOWN && FileLister::isDirectory(new_path)));
+        bool path_is_directory = (dir_result->d_type == DT_DIR || (dir_result->d_type == DT_UNKNOWN && FileLister::isDirectory(new_path)));
 #else
-                bool path_is_directory = FileLister::isDirectory(new_path);
+        bool path_is_directory = FileLister::isDirectory(new_path);
 #endif
-                if (path_is_directory) {
-                    if (recursive && !ignored.match(new_path)) {
-                        addFiles2(files, new_path, extra, recursive, ignored);
-                    }
-                } else {
-                    if (Path::acceptFile(new_path, extra) && !ignored.match(new_path)) {
-                        stat(new_path.c_str(), &file_stat);
-                        files[new_path] = file_stat.st_size;
-                    }
-                }
+        if (path_is_directory) {
+            // Also match with a trailing '/' so that directory masks like
+            // "-isrc/" prune the whole subtree instead of the files in it
+            // being matched one by one.
+            if (recursive && !ignored.match(new_path) && !ignored.match(new_path + '/')) {
+                addFiles2(files, new_path, extra, recursive, ignored);
             }
-            closedir(dir);
-        } else
-            files[path] = file_stat.st_size;
+        } else {
+            if (Path::acceptFile(new_path, extra) && !ignored.match(new_path)) {
+                stat(new_path.c_str(), &file_stat);
+                files[new_path] = file_stat.st_size;
+            }
+        }
     }
+    closedir(dir);
 }
 
 void FileLister::recursiveAddFiles(std::map<std::string, std::size_t> &files, const std::string &path, const std::set<std::string> &extra, const PathMatch& ignored)
@@ -236,7 +240,13 @@ void FileLister::addFiles(std::map<std::string, std::size_t> &files, const std::
         if (endsWith(corrected_path, '/'))
             corrected_path.erase(corrected_path.end() - 1);
 
-        addFiles2(files, corrected_path, extra, recursive, ignored);
+        struct stat file_stat;
+        if (stat(corrected_path.c_str(), &file_stat) == -1)
+            return;
+        if ((file_stat.st_mode & S_IFMT) == S_IFDIR)
+            addFiles2(files, corrected_path, extra, recursive, ignored);
+        else
+            files[corrected_path] = file_stat.st_size;
     }
 }
 
@@ -24,22 +24,38 @@
 #include "importproject.h"
 #include "settings.h"
 #include "suppressions.h"
+#include "timer.h"
 
 #include <algorithm>
 #include <cerrno>
+#include <chrono>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <utility>
+#include <vector>
+
+#ifndef P_tmpdir
+#define P_tmpdir "/tmp"
+#endif
 
 #ifdef __SVR4  // Solaris
 #include <sys/loadavg.h>
 #endif
 #ifdef THREADING_MODEL_FORK
+#include <dirent.h>
 #include <sys/select.h>
+#include <sys/stat.h>
 #include <sys/wait.h>
 #include <fcntl.h>
 #include <unistd.h>
+#if defined(__linux__)
+#include <sched.h>
+#endif
 #endif
 #ifdef THREADING_MODEL_WIN
 #include <process.h>
@@ -51,15 +67,21 @@ using std::memset;
 
 ThreadExecutor::ThreadExecutor(const std::map<std::string, std::size_t> &files, Settings &settings, ErrorLogger &errorLogger)
     : _files(files), _settings(settings), _errorLogger(errorLogger), _fileCount(0)
-      // Not initialized _fileSync, _errorSync, _reportSync
+      // Not initialized _fileSync, _reportSync
 {
 #if defined(THREADING_MODEL_FORK)
     _wpipe = 0;
+    mStreaming = false;
+    mStreamingDone = true;
 #elif defined(THREADING_MODEL_WIN)
     _processedFiles = 0;
     _totalFiles = 0;
     _processedSize = 0;
     _totalFileSize = 0;
+    mWorkerQueues = nullptr;
+    mNextQueueSlot = 0;
+    mWorkersDone = false;
+    mQueueEvent = nullptr;
 #endif
 }
 
@@ -80,6 +102,28 @@ void ThreadExecutor::addFileContent(const std::string &path, const std::string &
     _fileContents[ path ] = content;
 }
 
+// Read an exact number of bytes from a non-blocking pipe. The worker may be
+// in the middle of writing a buffer that is larger than the pipe capacity,
+// so wait for the rest of the frame when the pipe runs empty.
+static bool readAll(int rpipe, char *buf, std::size_t size)
+{
+    std::size_t done = 0;
+    while (done < size) {
+        const ssize_t r = read(rpipe, buf + done, size - done);
+        if (r > 0) {
+            done += static_cast<std::size_t>(r);
+        } else if (r == -1 && errno == EAGAIN) {
+            fd_set rfds;
+            FD_ZERO(&rfds);
+            FD_SET(rpipe, &rfds);
+            select(rpipe + 1, &rfds, nullptr, nullptr, nullptr);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
 int ThreadExecutor::handleRead(int rpipe, unsigned int &result)
 {
     char type = 0;
@@ -87,7 +131,7 @@ int ThreadExecutor::handleRead(int rpipe, unsigned int &result)
         if (errno == EAGAIN)
             return 0;
 
-        return -1;
+        return -2;
     }
 
     if (type != REPORT_OUT && type != REPORT_ERROR && type != REPORT_INFO && type != CHILD_END) {
@@ -96,7 +140,7 @@ int ThreadExecutor::handleRead(int rpipe, unsigned int &result)
     }
 
     unsigned int len = 0;
-    if (read(rpipe, &len, sizeof(len)) <= 0) {
+    if (!readAll(rpipe, reinterpret_cast<char *>(&len), sizeof(len))) {
         std::cerr << "#### You found a bug from cppcheck.\nThreadExecutor::handleRead error, type was:" << type << std::endl;
         std::exit(0);
     }
@@ -104,12 +148,11 @@ int ThreadExecutor::handleRead(int rpipe, unsigned int &result)
     // Don't rely on incoming data being null-terminated.
     // Allocate +1 element and null-terminate the buffer.
     char *buf = new char[len + 1];
-    const ssize_t readIntoBuf = read(rpipe, buf, len);
-    if (readIntoBuf <= 0) {
+    if (!readAll(rpipe, buf, len)) {
         std::cerr << "#### You found a bug from cppcheck.\nThreadExecutor::handleRead error, type was:" << type << std::endl;
         std::exit(0);
     }
-    buf[readIntoBuf] = 0;
+    buf[len] = 0;
 
     if (type == REPORT_OUT) {
         _errorLogger.reportOut(buf);
@@ -118,10 +161,10 @@ int ThreadExecutor::handleRead(int rpipe, unsigned int &result)
         msg.deserialize(buf);
 
         if (!_settings.nomsg.isSuppressed(msg.toSuppressionsErrorMessage())) {
-            // Alert only about unique errors
-            std::string errmsg = msg.toString(_settings.verbose);
-            if (std::find(_errorList.begin(), _errorList.end(), errmsg) == _errorList.end()) {
-                _errorList.push_back(errmsg);
+            // Alert only about unique errors. The same message from a widely
+            // included header arrives once per translation unit, so the seen
+            // set is hashed instead of searched linearly.
+            if (_errorList.insert(msg.toString(_settings.verbose)).second) {
                 if (type == REPORT_ERROR)
                     _errorLogger.reportErr(msg);
                 else
@@ -161,6 +204,27 @@ bool ThreadExecutor::checkLoadAverage(size_t nchildren)
 #endif
 }
 
+void ThreadExecutor::enableStreaming()
+{
+    std::lock_guard<std::mutex> lock(mStreamMutex);
+    mStreaming = true;
+    mStreamingDone = false;
+}
+
+void ThreadExecutor::addFileJob(const std::string &filename, std::size_t filesize)
+{
+    std::lock_guard<std::mutex> lock(mStreamMutex);
+    mStreamedFiles.push_back(std::make_pair(filename, filesize));
+    mStreamCond.notify_one();
+}
+
+void ThreadExecutor::endOfFiles()
+{
+    std::lock_guard<std::mutex> lock(mStreamMutex);
+    mStreamingDone = true;
+    mStreamCond.notify_one();
+}
+
 unsigned int ThreadExecutor::check()
 {
     _fileCount = 0;
@@ -171,89 +235,363 @@ unsigned int ThreadExecutor::check()
         totalfilesize += i->second;
     }
 
-    std::list<int> rpipes;
-    std::map<pid_t, std::string> childFile;
-    std::map<int, std::string> pipeFile;
+    // Start the biggest files first. A big multi-configuration file that is
+    // started last keeps a single worker busy long after the other workers
+    // have drained the queue; starting it early hides it behind the small
+    // files instead.
+    std::vector<std::pair<std::string, std::size_t> > filelist(_files.begin(), _files.end());
+    std::stable_sort(filelist.begin(), filelist.end(), [](const std::pair<std::string, std::size_t> &f1, const std::pair<std::string, std::size_t> &f2) {
+        return f1.second > f2.second;
+    });
+
+    // --order=mtime: recently modified files first so findings in freshly
+    // edited code surface early; the biggest-first order above stays the
+    // tie breaker, so files of the same age still balance by size.
+    if (_settings.analysisOrder == "mtime") {
+        std::map<std::string, time_t> mtime;
+        for (const std::pair<std::string, std::size_t> &f : filelist) {
+            struct stat sb;
+            mtime[f.first] = (stat(f.first.c_str(), &sb) == 0) ? sb.st_mtime : 0;
+        }
+        std::stable_sort(filelist.begin(), filelist.end(), [&](const std::pair<std::string, std::size_t> &f1, const std::pair<std::string, std::size_t> &f2) {
+            return mtime[f1.first] > mtime[f2.first];
+        });
+    }
+
+    // Flat list of the project file settings for indexed access. Job i is
+    // fileSettings[i] when i < fileSettings.size(), otherwise
+    // filelist[i - fileSettings.size()]. The project files are not in _files
+    // so their sizes are read from disk for the same biggest-first ordering.
+    std::vector<const ImportProject::FileSettings *> fileSettings;
+    for (const ImportProject::FileSettings &fs : _settings.project.fileSettings)
+        fileSettings.push_back(&fs);
+    std::map<const ImportProject::FileSettings *, std::size_t> fileSettingsSize;
+    for (const ImportProject::FileSettings *fs : fileSettings) {
+        struct stat sb;
+        fileSettingsSize[fs] = (stat(fs->filename.c_str(), &sb) == 0) ? (std::size_t)sb.st_size : 0;
+    }
+    std::stable_sort(fileSettings.begin(), fileSettings.end(), [&](const ImportProject::FileSettings *f1, const ImportProject::FileSettings *f2) {
+        return fileSettingsSize[f1] > fileSettingsSize[f2];
+    });
+
+    // Group the project files by their preprocessor signature (defines,
+    // include paths, standard, platform). Files of the same target pull in
+    // the same headers, so a worker that stays within one group keeps its
+    // caches warm; alternating between unrelated targets thrashes them.
+    // Each worker prefers the group of the file it checked last and
+    // otherwise picks the group with the most remaining bytes.
+    std::map<std::string, std::size_t> groupIndexOf;   // signature => group
+    std::vector<std::list<std::size_t> > groupJobs;    // job indices, biggest file first
+    std::vector<std::size_t> groupRemainingSize;       // remaining bytes of the group
+    for (std::size_t i = 0; i < fileSettings.size(); ++i) {
+        const ImportProject::FileSettings *fs = fileSettings[i];
+        std::ostringstream sig;
+        sig << fs->cppcheckDefines() << '\n' << fs->standard << '\n' << static_cast<int>(fs->platformType) << '\n';
+        for (const std::string &undef : fs->undefs)
+            sig << 'U' << undef << '\n';
+        for (const std::string &path : fs->includePaths)
+            sig << 'I' << path << '\n';
+        for (const std::string &path : fs->systemIncludePaths)
+            sig << 'S' << path << '\n';
+        const std::map<std::string, std::size_t>::const_iterator g = groupIndexOf.find(sig.str());
+        std::size_t group;
+        if (g == groupIndexOf.end()) {
+            group = groupJobs.size();
+            groupIndexOf[sig.str()] = group;
+            groupJobs.push_back(std::list<std::size_t>());
+            groupRemainingSize.push_back(0);
+        } else
+            group = g->second;
+        groupJobs[group].push_back(i); // fileSettings is already sorted biggest-first
+        groupRemainingSize[group] += fileSettingsSize[fs];
+    }
+    std::size_t fileSettingsRemaining = fileSettings.size();
+    std::map<int, std::size_t> workerGroup; // result fd => group the worker last checked
+
+    const std::size_t jobCount = fileSettings.size() + filelist.size();
+    std::size_t nextJob = 0;
+
+    // Streamed jobs (addFileJob() while the enumeration is still running)
+    // are sent to the workers as this marker followed by the length and the
+    // bytes of the file name; indexed jobs are sent as a plain index.
+    const std::size_t streamedJobMarker = std::numeric_limits<std::size_t>::max();
+    std::map<std::string, std::size_t> streamedSizes; // dispatched streamed files
+    std::size_t streamedDispatched = 0;
+
+    const auto streamedFileQueued = [this]() {
+        std::lock_guard<std::mutex> lock(mStreamMutex);
+        return !mStreamedFiles.empty();
+    };
+    const auto streamingPending = [this]() {
+        std::lock_guard<std::mutex> lock(mStreamMutex);
+        return mStreaming && (!mStreamedFiles.empty() || !mStreamingDone);
+    };
+
+    std::vector<std::string> shardFiles;    // per-worker result shard files (--sorted-results)
+    std::vector<std::string> traceShardFiles; // per-worker trace shard files (--trace-report)
+    std::map<pid_t, std::string> childFile; // worker pid => current file, for crash reports
+    std::map<int, std::string> pipeFile;    // result fd => current file, for the progress output
+    std::map<int, int> workerCmdFd;         // result fd => command fd of the worker
+    std::map<int, pid_t> workerPid;         // result fd => worker pid
+    std::list<int> idle;                    // result fds of workers waiting for a file
+    std::list<int> busy;                    // result fds of workers checking a file
     std::size_t processedsize = 0;
-    std::map<std::string, std::size_t>::const_iterator iFile = _files.begin();
-    std::list<ImportProject::FileSettings>::const_iterator iFileSettings = _settings.project.fileSettings.begin();
+
+    // Cross-worker deduplication markers, see claimFinding(). A fresh run
+    // must not inherit the claims of the previous one, so the directory is
+    // emptied before the workers are forked.
+    if (!_settings.buildDir.empty()) {
+        _markerDir = _settings.buildDir + "/header-findings";
+        DIR *markerDir = opendir(_markerDir.c_str());
+        if (markerDir) {
+            while (const dirent *entry = readdir(markerDir)) {
+                if (entry->d_name[0] != '.')
+                    unlink((_markerDir + "/" + entry->d_name).c_str());
+            }
+            closedir(markerDir);
+        } else {
+            mkdir(_markerDir.c_str(), 0755);
+        }
+    }
+
     for (;;) {
-        // Start a new child
-        size_t nchildren = rpipes.size();
-        if ((iFile != _files.end() || iFileSettings != _settings.project.fileSettings.end()) && nchildren < _settings.jobs && checkLoadAverage(nchildren)) {
-            int pipes[2];
-            if (pipe(pipes) == -1) {
+        if ((nextJob < jobCount || streamedFileQueued()) && idle.empty() && workerPid.size() < _settings.jobs) {
+            // Start a new worker. The workers are long-lived and are handed
+            // one file after another through their command pipe; forking per
+            // file would pay the process spawn cost for every file.
+            int cmdpipe[2];
+            int respipe[2];
+            if (pipe(cmdpipe) == -1 || pipe(respipe) == -1) {
                 std::cerr << "pipe() failed: "<< std::strerror(errno) << std::endl;
                 std::exit(EXIT_FAILURE);
             }
 
             int flags = 0;
-            if ((flags = fcntl(pipes[0], F_GETFL, 0)) < 0) {
+            if ((flags = fcntl(respipe[0], F_GETFL, 0)) < 0) {
                 std::cerr << "fcntl(F_GETFL) failed: "<< std::strerror(errno) << std::endl;
                 std::exit(EXIT_FAILURE);
             }
 
-            if (fcntl(pipes[0], F_SETFL, flags | O_NONBLOCK) < 0) {
+            if (fcntl(respipe[0], F_SETFL, flags | O_NONBLOCK) < 0) {
                 std::cerr << "fcntl(F_SETFL) failed: "<< std::strerror(errno) << std::endl;
                 std::exit(EXIT_FAILURE);
             }
 
+            std::string shardFile;
+            if (_settings.sortedResults) {
+                std::ostringstream oss;
+                oss << (_settings.buildDir.empty() ? std::string(P_tmpdir) : _settings.buildDir)
+                    << "/cppcheck-results-" << getpid() << '-' << shardFiles.size() << ".dat";
+                shardFile = oss.str();
+                shardFiles.push_back(shardFile);
+            }
+
+            std::string traceShardFile;
+            if (!_settings.traceReport.empty()) {
+                std::ostringstream oss;
+                oss << (_settings.buildDir.empty() ? std::string(P_tmpdir) : _settings.buildDir)
+                    << "/cppcheck-trace-" << getpid() << '-' << traceShardFiles.size() << ".json";
+                traceShardFile = oss.str();
+                traceShardFiles.push_back(traceShardFile);
+            }
+
             pid_t pid = fork();
             if (pid < 0) {
                 // Error
                 std::cerr << "Failed to create child process: "<< std::strerror(errno) << std::endl;
                 std::exit(EXIT_FAILURE);
             } else if (pid == 0) {
-                close(pipes[0]);
-                _wpipe = pipes[1];
+                // The inherited command fds of the other workers must be
+                // closed, otherwise those workers never see end-of-file when
+                // they are dismissed.
+                for (std::map<int, int>::const_iterator it = workerCmdFd.begin(); it != workerCmdFd.end(); ++it)
+                    close(it->second);
+                close(cmdpipe[1]);
+                close(respipe[0]);
+                _wpipe = respipe[1];
+                _shardFileName = shardFile;
+                _traceShardFileName = traceShardFile;
+
+#if defined(__linux__)
+                // Pin this worker to one cpu before it allocates anything.
+                // The token lists are first touched after the pinning, so
+                // they end up on the NUMA node of that cpu instead of
+                // wherever the scheduler migrated the worker to.
+                if (!_settings.cpuAffinity.empty()) {
+                    const long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+                    if (ncpu > 0) {
+                        const std::size_t worker = workerPid.size();
+                        std::size_t cpu;
+                        if (_settings.cpuAffinity == "scatter" && _settings.jobs > 0 && static_cast<std::size_t>(ncpu) > _settings.jobs)
+                            cpu = (worker * static_cast<std::size_t>(ncpu) / _settings.jobs) % static_cast<std::size_t>(ncpu);
+                        else // compact
+                            cpu = worker % static_cast<std::size_t>(ncpu);
+                        cpu_set_t cpuset;
+                        CPU_ZERO(&cpuset);
+                        CPU_SET(cpu, &cpuset);
+                        // Failure is not fatal, the worker just stays unpinned
+                        sched_setaffinity(0, sizeof(cpuset), &cpuset);
+                    }
+                }
+#endif
 
+                // Check files until the command pipe is closed. One CppCheck
+                // instance is reused for all the files, like in the single
+                // job code path - Settings with a loaded Library and long
+                // suppression lists is expensive to copy for every file.
                 CppCheck fileChecker(*this, false);
                 fileChecker.settings() = _settings;
-                unsigned int resultOfCheck = 0;
 
-                if (iFileSettings != _settings.project.fileSettings.end()) {
-                    resultOfCheck = fileChecker.check(*iFileSettings);
-                } else if (!_fileContents.empty() && _fileContents.find(iFile->first) != _fileContents.end()) {
-                    // File content was given as a string
-                    resultOfCheck = fileChecker.check(iFile->first, _fileContents[ iFile->first ]);
-                } else {
-                    // Read file from a file
-                    resultOfCheck = fileChecker.check(iFile->first);
-                }
+                for (;;) {
+                    std::size_t job = 0;
+                    bool dismissed = (read(cmdpipe[0], &job, sizeof(job)) != (ssize_t)sizeof(job));
+
+                    std::string streamedName;
+                    if (!dismissed && job == streamedJobMarker) {
+                        // a streamed file - read its name from the pipe
+                        std::size_t len = 0;
+                        dismissed = (read(cmdpipe[0], &len, sizeof(len)) != (ssize_t)sizeof(len) || len == 0);
+                        std::size_t done = 0;
+                        std::vector<char> nameBuf(dismissed ? 1 : len);
+                        while (!dismissed && done < len) {
+                            const ssize_t r = read(cmdpipe[0], &nameBuf[done], len - done);
+                            if (r <= 0)
+                                dismissed = true;
+                            else
+                                done += r;
+                        }
+                        if (!dismissed)
+                            streamedName.assign(nameBuf.begin(), nameBuf.end());
+                    } else if (!dismissed && job >= jobCount)
+                        dismissed = true;
+
+                    if (dismissed) {
+                        // Dismissed - write the collected results before
+                        // exiting; std::exit() does not run the destructor
+                        // that would wait for the analyzer info writes
+                        fileChecker.flushAnalyzerInformation();
+                        writeShard();
+                        writeTraceShard();
+                        std::exit(0);
+                    }
+
+                    unsigned int resultOfCheck = 0;
+
+                    if (!streamedName.empty()) {
+                        resultOfCheck = fileChecker.check(streamedName);
+                    } else if (job < fileSettings.size()) {
+                        resultOfCheck = fileChecker.check(*fileSettings[job]);
+                    } else {
+                        const std::string &fname = filelist[job - fileSettings.size()].first;
+                        if (!_fileContents.empty() && _fileContents.find(fname) != _fileContents.end()) {
+                            // File content was given as a string
+                            resultOfCheck = fileChecker.check(fname, _fileContents[fname]);
+                        } else {
+                            // Read file from a file
+                            resultOfCheck = fileChecker.check(fname);
+                        }
+                    }
 
-                std::ostringstream oss;
-                oss << resultOfCheck;
-                writeToPipe(CHILD_END, oss.str());
-                std::exit(0);
+                    std::ostringstream oss;
+                    oss << resultOfCheck;
+                    writeToPipe(CHILD_END, oss.str());
+                }
             }
 
-            close(pipes[1]);
-            rpipes.push_back(pipes[0]);
-            if (iFileSettings != _settings.project.fileSettings.end()) {
-                childFile[pid] = iFileSettings->filename + ' ' + iFileSettings->cfg;
-                pipeFile[pipes[0]] = iFileSettings->filename + ' ' + iFileSettings->cfg;
-                ++iFileSettings;
+            close(cmdpipe[0]);
+            close(respipe[1]);
+            workerCmdFd[respipe[0]] = cmdpipe[1];
+            workerPid[respipe[0]] = pid;
+            idle.push_back(respipe[0]);
+        } else if ((nextJob < jobCount || streamedFileQueued()) && !idle.empty() && checkLoadAverage(busy.size())) {
+            // Hand the next file to an idle worker
+            const int rfd = idle.front();
+            idle.pop_front();
+
+            std::string name;
+            if (nextJob < jobCount) {
+                // the indexed jobs known up front go first, they are sorted
+                // biggest-first
+                std::size_t job;
+                if (fileSettingsRemaining > 0) {
+                    // cache affinity - stay in the group the worker last
+                    // checked a file from while it has files left
+                    std::size_t group = groupJobs.size();
+                    const std::map<int, std::size_t>::const_iterator wg = workerGroup.find(rfd);
+                    if (wg != workerGroup.end() && !groupJobs[wg->second].empty())
+                        group = wg->second;
+                    else {
+                        for (std::size_t g = 0; g < groupJobs.size(); ++g) {
+                            if (!groupJobs[g].empty() && (group == groupJobs.size() || groupRemainingSize[g] > groupRemainingSize[group]))
+                                group = g;
+                        }
+                    }
+                    job = groupJobs[group].front();
+                    groupJobs[group].pop_front();
+                    groupRemainingSize[group] -= fileSettingsSize[fileSettings[job]];
+                    workerGroup[rfd] = group;
+                    --fileSettingsRemaining;
+                    ++nextJob;
+                    name = fileSettings[job]->filename + ' ' + fileSettings[job]->cfg;
+                } else {
+                    job = nextJob++;
+                    name = filelist[job - fileSettings.size()].first;
+                }
+
+                if (write(workerCmdFd[rfd], &job, sizeof(job)) != (ssize_t)sizeof(job)) {
+                    std::cerr << "#### ThreadExecutor::check, Failed to write to command pipe" << std::endl;
+                    std::exit(EXIT_FAILURE);
+                }
             } else {
-                childFile[pid] = iFile->first;
-                pipeFile[pipes[0]] = iFile->first;
-                ++iFile;
+                // a streamed file
+                std::pair<std::string, std::size_t> streamed;
+                {
+                    std::lock_guard<std::mutex> lock(mStreamMutex);
+                    if (mStreamedFiles.empty()) {
+                        // drained since the condition was evaluated
+                        idle.push_front(rfd);
+                        continue;
+                    }
+                    streamed = mStreamedFiles.front();
+                    mStreamedFiles.pop_front();
+                }
+                name = streamed.first;
+                streamedSizes[name] = streamed.second;
+                totalfilesize += streamed.second;
+                ++streamedDispatched;
+
+                const std::size_t len = name.size();
+                if (write(workerCmdFd[rfd], &streamedJobMarker, sizeof(streamedJobMarker)) != (ssize_t)sizeof(streamedJobMarker) ||
+                    write(workerCmdFd[rfd], &len, sizeof(len)) != (ssize_t)sizeof(len) ||
+                    write(workerCmdFd[rfd], name.c_str(), len) != (ssize_t)len) {
+                    std::cerr << "#### ThreadExecutor::check, Failed to write to command pipe" << std::endl;
+                    std::exit(EXIT_FAILURE);
+                }
             }
-        } else if (!rpipes.empty()) {
+            childFile[workerPid[rfd]] = name;
+            pipeFile[rfd] = name;
+            busy.push_back(rfd);
+        } else if (!busy.empty()) {
             fd_set rfds;
             FD_ZERO(&rfds);
-            for (std::list<int>::const_iterator rp = rpipes.begin(); rp != rpipes.end(); ++rp)
+            for (std::list<int>::const_iterator rp = busy.begin(); rp != busy.end(); ++rp)
                 FD_SET(*rp, &rfds);
             struct timeval tv; // for every second polling of load average condition
             tv.tv_sec = 1;
             tv.tv_usec = 0;
-            int r = select(*std::max_element(rpipes.begin(), rpipes.end()) + 1, &rfds, nullptr, nullptr, &tv);
+            int r = select(*std::max_element(busy.begin(), busy.end()) + 1, &rfds, nullptr, nullptr, &tv);
 
             if (r > 0) {
-                std::list<int>::iterator rp = rpipes.begin();
-                while (rp != rpipes.end()) {
+                std::list<int>::iterator rp = busy.begin();
+                while (rp != busy.end()) {
                     if (FD_ISSET(*rp, &rfds)) {
+                        // drain the pipe so a worker with many buffered
+                        // results does not wait a select round per message
                         int readRes = handleRead(*rp, result);
-                        if (readRes == -1) {
+                        while (readRes == 1)
+                            readRes = handleRead(*rp, result);
+                        if (readRes == -1 || readRes == -2) {
+                            // the file is done (or the worker died while checking it)
                             std::size_t size = 0;
                             std::map<int, std::string>::iterator p = pipeFile.find(*rp);
                             if (p != pipeFile.end()) {
@@ -262,16 +600,30 @@ unsigned int ThreadExecutor::check()
                                 std::map<std::string, std::size_t>::const_iterator fs = _files.find(name);
                                 if (fs != _files.end()) {
                                     size = fs->second;
+                                } else {
+                                    const std::map<std::string, std::size_t>::const_iterator ss = streamedSizes.find(name);
+                                    if (ss != streamedSizes.end())
+                                        size = ss->second;
                                 }
                             }
 
                             _fileCount++;
                             processedsize += size;
                             if (!_settings.quiet)
-                                CppCheckExecutor::reportStatus(_fileCount, _files.size() + _settings.project.fileSettings.size(), processedsize, totalfilesize);
+                                CppCheckExecutor::reportStatus(_fileCount, _files.size() + _settings.project.fileSettings.size() + streamedDispatched, processedsize, totalfilesize);
+                        }
 
+                        if (readRes == -1) {
+                            // the worker is idle again
+                            idle.push_back(*rp);
+                            rp = busy.erase(rp);
+                        } else if (readRes == -2) {
+                            // the worker terminated
+                            close(workerCmdFd[*rp]);
+                            workerCmdFd.erase(*rp);
+                            workerPid.erase(*rp);
                             close(*rp);
-                            rp = rpipes.erase(rp);
+                            rp = busy.erase(rp);
                         } else
                             ++rp;
                     } else
@@ -306,31 +658,218 @@ unsigned int ThreadExecutor::check()
                         _errorLogger.reportErr(errmsg);
                 }
             }
+        } else if (streamingPending()) {
+            // Nothing to run right now, but the enumeration thread is still
+            // delivering files - wait for the next one
+            std::unique_lock<std::mutex> lock(mStreamMutex);
+            if (mStreamedFiles.empty() && !mStreamingDone)
+                mStreamCond.wait_for(lock, std::chrono::milliseconds(100));
         } else {
-            // All done
+            // All files done - dismiss the workers
+            for (std::list<int>::const_iterator i = idle.begin(); i != idle.end(); ++i) {
+                close(workerCmdFd[*i]);
+                close(*i);
+            }
             break;
         }
     }
 
+    // Reap the workers, reporting any that crashed
+    int stat = 0;
+    pid_t child = 0;
+    while ((child = waitpid(0, &stat, 0)) > 0) {
+        if (WIFSIGNALED(stat)) {
+            std::string childname;
+            std::map<pid_t, std::string>::iterator c = childFile.find(child);
+            if (c != childFile.end()) {
+                childname = c->second;
+                childFile.erase(c);
+            }
+
+            std::ostringstream oss;
+            oss << "Internal error: Child process crashed with signal " << WTERMSIG(stat);
+
+            std::list<ErrorLogger::ErrorMessage::FileLocation> locations;
+            locations.emplace_back(childname, 0);
+            const ErrorLogger::ErrorMessage errmsg(locations,
+                                                   emptyString,
+                                                   Severity::error,
+                                                   oss.str(),
+                                                   "cppcheckError",
+                                                   false);
+
+            if (!_settings.nomsg.isSuppressed(errmsg.toSuppressionsErrorMessage()))
+                _errorLogger.reportErr(errmsg);
+        }
+    }
+
+    // All the workers have written their shards - merge them
+    if (_settings.sortedResults)
+        mergeShards(shardFiles);
+
+    if (!_settings.traceReport.empty())
+        mergeTraceShards(traceShardFiles);
 
     return result;
 }
 
-void ThreadExecutor::writeToPipe(PipeSignal type, const std::string &data)
+void ThreadExecutor::writeTraceShard()
 {
-    unsigned int len = static_cast<unsigned int>(data.length() + 1);
-    char *out = new char[ len + 1 + sizeof(len)];
-    out[0] = static_cast<char>(type);
-    std::memcpy(&(out[1]), &len, sizeof(len));
-    std::memcpy(&(out[1+sizeof(len)]), data.c_str(), len);
-    if (write(_wpipe, out, len + 1 + sizeof(len)) <= 0) {
-        delete [] out;
-        out = nullptr;
-        std::cerr << "#### ThreadExecutor::writeToPipe, Failed to write to pipe" << std::endl;
-        std::exit(0);
+    if (_traceShardFileName.empty())
+        return;
+
+    std::ofstream fout(_traceShardFileName.c_str());
+    if (fout.is_open())
+        CppCheck::timerResults().writeChromeTrace(fout, (int)getpid());
+}
+
+void ThreadExecutor::mergeTraceShards(const std::vector<std::string> &traceShardFiles)
+{
+    std::ofstream fout(_settings.traceReport.c_str());
+    if (!fout.is_open()) {
+        std::cerr << "cppcheck: Failed to open trace report file '" << _settings.traceReport << "'." << std::endl;
+        return;
+    }
+
+    fout << "[";
+    bool first = true;
+    for (std::vector<std::string>::const_iterator name = traceShardFiles.begin(); name != traceShardFiles.end(); ++name) {
+        std::ifstream fin(name->c_str());
+        std::ostringstream oss;
+        oss << fin.rdbuf();
+        const std::string shard = oss.str();
+        // each shard is a complete event array - strip the brackets and
+        // join, skipping shards without events
+        const std::string::size_type begin = shard.find('[');
+        const std::string::size_type end = shard.rfind(']');
+        if (begin == std::string::npos || end == std::string::npos || end <= begin)
+            continue;
+        const std::string events = shard.substr(begin + 1, end - begin - 1);
+        if (events.find('{') == std::string::npos)
+            continue;
+        fout << (first ? "" : ",") << events;
+        first = false;
     }
+    fout << "]\n";
+
+    for (std::vector<std::string>::const_iterator name = traceShardFiles.begin(); name != traceShardFiles.end(); ++name)
+        std::remove(name->c_str());
+}
+
+void ThreadExecutor::writeShard()
+{
+    if (!_settings.sortedResults || _shardFileName.empty())
+        return;
+
+    std::sort(_sortedRecords.begin(), _sortedRecords.end());
 
-    delete [] out;
+    std::ofstream fout(_shardFileName.c_str(), std::ios::binary);
+    for (std::vector<std::string>::const_iterator record = _sortedRecords.begin(); record != _sortedRecords.end(); ++record) {
+        const unsigned int len = static_cast<unsigned int>(record->size());
+        fout.write(reinterpret_cast<const char *>(&len), sizeof(len));
+        fout.write(record->data(), len);
+    }
+}
+
+/** Read one length-prefixed record from a result shard */
+static bool readShardRecord(std::ifstream &f, std::string &record)
+{
+    unsigned int len = 0;
+    if (!f.read(reinterpret_cast<char *>(&len), sizeof(len)))
+        return false;
+    record.resize(len);
+    return len == 0 || !!f.read(&record[0], len);
+}
+
+void ThreadExecutor::mergeShards(const std::vector<std::string> &shardFiles)
+{
+    std::vector<std::ifstream *> shards;
+    std::vector<std::string> heads;
+
+    for (std::vector<std::string>::const_iterator name = shardFiles.begin(); name != shardFiles.end(); ++name) {
+        std::ifstream *f = new std::ifstream(name->c_str(), std::ios::binary);
+        std::string record;
+        if (f->is_open() && readShardRecord(*f, record)) {
+            shards.push_back(f);
+            heads.push_back(record);
+        } else {
+            // empty shard, or the worker crashed before writing it
+            delete f;
+        }
+    }
+
+    std::string previous;
+    bool first = true;
+    while (!shards.empty()) {
+        // report the smallest head record, skipping duplicates
+        std::size_t m = 0;
+        for (std::size_t i = 1; i < heads.size(); ++i) {
+            if (heads[i] < heads[m])
+                m = i;
+        }
+        if (first || heads[m] != previous) {
+            previous = heads[m];
+            first = false;
+            reportRecord(previous);
+        }
+        if (!readShardRecord(*shards[m], heads[m])) {
+            delete shards[m];
+            shards.erase(shards.begin() + m);
+            heads.erase(heads.begin() + m);
+        }
+    }
+
+    for (std::vector<std::string>::const_iterator name = shardFiles.begin(); name != shardFiles.end(); ++name)
+        std::remove(name->c_str());
+}
+
+void ThreadExecutor::reportRecord(const std::string &record)
+{
+    if (record.empty())
+        return;
+
+    ErrorLogger::ErrorMessage msg;
+    if (!msg.deserialize(record.substr(1)))
+        return;
+
+    if (_settings.nomsg.isSuppressed(msg.toSuppressionsErrorMessage()))
+        return;
+
+    if (record[0] == static_cast<char>(REPORT_INFO))
+        _errorLogger.reportInfo(msg);
+    else
+        _errorLogger.reportErr(msg);
+}
+
+void ThreadExecutor::writeToPipe(PipeSignal type, const std::string &data)
+{
+    const unsigned int len = static_cast<unsigned int>(data.length() + 1);
+    _pipeBuffer += static_cast<char>(type);
+    _pipeBuffer.append(reinterpret_cast<const char *>(&len), sizeof(len));
+    _pipeBuffer.append(data.c_str(), len);
+
+    // Errors are buffered so checking does not block on the pipe for each
+    // finding while the master is busy with another worker. Progress output
+    // and the end of the file are flushed at once so the master stays
+    // responsive.
+    if ((type != REPORT_ERROR && type != REPORT_INFO) || _pipeBuffer.size() >= 0x10000)
+        flushToPipe();
+}
+
+void ThreadExecutor::flushToPipe()
+{
+    const char *p = _pipeBuffer.data();
+    std::size_t left = _pipeBuffer.size();
+    while (left > 0) {
+        const ssize_t n = write(_wpipe, p, left);
+        if (n <= 0) {
+            std::cerr << "#### ThreadExecutor::writeToPipe, Failed to write to pipe" << std::endl;
+            std::exit(0);
+        }
+        p += n;
+        left -= static_cast<std::size_t>(n);
+    }
+    _pipeBuffer.clear();
 }
 
 void ThreadExecutor::reportOut(const std::string &outmsg)
@@ -338,18 +877,54 @@ void ThreadExecutor::reportOut(const std::string &outmsg)
     writeToPipe(REPORT_OUT, outmsg);
 }
 
+bool ThreadExecutor::claimFinding(const ErrorLogger::ErrorMessage &msg) const
+{
+    // Cross-worker deduplication of header findings. The same warning in a
+    // widely included header is rediscovered by every translation unit and
+    // the master drops all but the first copy, but only after each copy was
+    // serialized, sent and deserialized. With a build dir available a worker
+    // claims a header finding by atomically creating a marker file keyed by
+    // its hash; a finding that was already claimed by another worker is not
+    // even sent. Findings in the checked source file itself are always sent,
+    // they cannot repeat across workers.
+    if (_markerDir.empty() || msg._callStack.empty())
+        return true;
+    if (msg.file0.empty() || msg._callStack.back().getfile(false) == msg.file0)
+        return true;
+    std::ostringstream markerFile;
+    markerFile << _markerDir << '/' << std::hex << std::hash<std::string>()(msg.toString(_settings.verbose));
+    const int fd = open(markerFile.str().c_str(), O_CREAT | O_EXCL | O_WRONLY, 0644);
+    if (fd == -1)
+        return errno != EEXIST; // claimed by another worker; on any other error just send
+    close(fd);
+    return true;
+}
+
 void ThreadExecutor::reportErr(const ErrorLogger::ErrorMessage &msg)
 {
-    writeToPipe(REPORT_ERROR, msg.serialize());
+    if (!claimFinding(msg))
+        return;
+    if (_settings.sortedResults)
+        _sortedRecords.push_back(static_cast<char>(REPORT_ERROR) + msg.serialize());
+    else
+        writeToPipe(REPORT_ERROR, msg.serialize());
 }
 
 void ThreadExecutor::reportInfo(const ErrorLogger::ErrorMessage &msg)
 {
-    writeToPipe(REPORT_INFO, msg.serialize());
+    if (!claimFinding(msg))
+        return;
+    if (_settings.sortedResults)
+        _sortedRecords.push_back(static_cast<char>(REPORT_INFO) + msg.serialize());
+    else
+        writeToPipe(REPORT_INFO, msg.serialize());
 }
 
 #elif defined(THREADING_MODEL_WIN)
 
+// Result queue slot of this worker thread, claimed in threadProc().
+static thread_local unsigned int tlsQueueSlot = 0xffffffffU;
+
 void ThreadExecutor::addFileContent(const std::string &path, const std::string &content)
 {
     _fileContents[path] = content;
@@ -371,9 +946,28 @@ unsigned int ThreadExecutor::check()
     }
 
     InitializeCriticalSection(&_fileSync);
-    InitializeCriticalSection(&_errorSync);
     InitializeCriticalSection(&_reportSync);
 
+    mWorkerQueues = new WorkerQueue[_settings.jobs];
+    for (unsigned int i = 0; i < _settings.jobs; ++i)
+        mWorkerQueues[i].head = nullptr;
+    mNextQueueSlot = 0;
+    mWorkersDone = false;
+    mQueueEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (!mQueueEvent) {
+        std::cerr << "#### .\nThreadExecutor::check create event failed, error:" << GetLastError() << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // The workers push their results onto their lock-free queues; this
+    // thread drains the queues and does all the reporting, so the workers
+    // never contend on a reporting lock.
+    HANDLE reporterHandle = (HANDLE)_beginthreadex(nullptr, 0, reporterProc, this, 0, nullptr);
+    if (!reporterHandle) {
+        std::cerr << "#### .\nThreadExecutor::check error, errno :" << errno << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
     for (unsigned int i = 0; i < _settings.jobs; ++i) {
         threadHandles[i] = (HANDLE)_beginthreadex(nullptr, 0, threadProc, this, 0, nullptr);
         if (!threadHandles[i]) {
@@ -410,12 +1004,41 @@ unsigned int ThreadExecutor::check()
         }
     }
 
+    // Wake the reporter thread for the final drain and wait for it
+    mWorkersDone = true;
+    SetEvent(mQueueEvent);
+    WaitForSingleObject(reporterHandle, INFINITE);
+    CloseHandle(reporterHandle);
+    CloseHandle(mQueueEvent);
+    mQueueEvent = nullptr;
+    delete[] mWorkerQueues;
+    mWorkerQueues = nullptr;
+
     DeleteCriticalSection(&_fileSync);
-    DeleteCriticalSection(&_errorSync);
     DeleteCriticalSection(&_reportSync);
 
     delete[] threadHandles;
 
+    // The threads share the process memory, so there are no shard files to
+    // merge; sort and deduplicate the collected results directly.
+    if (_settings.sortedResults) {
+        std::sort(_sortedRecords.begin(), _sortedRecords.end());
+        std::string previous;
+        for (std::vector<std::string>::const_iterator record = _sortedRecords.begin(); record != _sortedRecords.end(); ++record) {
+            if (record->empty() || *record == previous)
+                continue;
+            previous = *record;
+            ErrorLogger::ErrorMessage msg;
+            if (!msg.deserialize(record->substr(1)))
+                continue;
+            if ((*record)[0] == '3')
+                _errorLogger.reportInfo(msg);
+            else
+                _errorLogger.reportErr(msg);
+        }
+        _sortedRecords.clear();
+    }
+
     return result;
 }
 
@@ -424,6 +1047,7 @@ unsigned int __stdcall ThreadExecutor::threadProc(void *args)
     unsigned int result = 0;
 
     ThreadExecutor *threadExecutor = static_cast<ThreadExecutor*>(args);
+    tlsQueueSlot = threadExecutor->mNextQueueSlot++;
     std::map<std::string, std::size_t>::const_iterator &itFile = threadExecutor->_itNextFile;
     std::list<ImportProject::FileSettings>::const_iterator &itFileSettings = threadExecutor->_itNextFileSettings;
 
@@ -475,54 +1099,116 @@ unsigned int __stdcall ThreadExecutor::threadProc(void *args)
     return result;
 }
 
-void ThreadExecutor::reportOut(const std::string &outmsg)
+unsigned int __stdcall ThreadExecutor::reporterProc(void *args)
 {
-    EnterCriticalSection(&_reportSync);
-
-    _errorLogger.reportOut(outmsg);
+    ThreadExecutor *threadExecutor = static_cast<ThreadExecutor*>(args);
 
-    LeaveCriticalSection(&_reportSync);
-}
-void ThreadExecutor::reportErr(const ErrorLogger::ErrorMessage &msg)
-{
-    report(msg, REPORT_ERROR);
+    while (!threadExecutor->mWorkersDone) {
+        threadExecutor->drainWorkerQueues();
+        WaitForSingleObject(threadExecutor->mQueueEvent, 100);
+    }
+    // mWorkersDone is set after the workers have been joined, so no more
+    // records arrive and this final drain reports the last of them
+    threadExecutor->drainWorkerQueues();
+    return 0;
 }
 
-void ThreadExecutor::reportInfo(const ErrorLogger::ErrorMessage &msg)
+void ThreadExecutor::pushRecord(RecordType recordType, const std::string &data)
 {
-    report(msg, REPORT_INFO);
-}
+    ResultRecord *record = new ResultRecord(recordType, data);
 
-void ThreadExecutor::report(const ErrorLogger::ErrorMessage &msg, MessageType msgType)
-{
-    if (_settings.nomsg.isSuppressed(msg.toSuppressionsErrorMessage()))
+    if (tlsQueueSlot == 0xffffffffU) {
+        // not called from a worker thread - report directly
+        handleRecord(*record);
+        delete record;
         return;
+    }
 
-    // Alert only about unique errors
-    bool reportError = false;
-    const std::string errmsg = msg.toString(_settings.verbose);
+    WorkerQueue &queue = mWorkerQueues[tlsQueueSlot];
+    ResultRecord *head = queue.head.load(std::memory_order_relaxed);
+    do {
+        record->next = head;
+    } while (!queue.head.compare_exchange_weak(head, record, std::memory_order_release, std::memory_order_relaxed));
 
-    EnterCriticalSection(&_errorSync);
-    if (std::find(_errorList.begin(), _errorList.end(), errmsg) == _errorList.end()) {
-        _errorList.push_back(errmsg);
-        reportError = true;
+    if (!record->next) {
+        // the queue was empty - wake the reporter thread
+        SetEvent(mQueueEvent);
     }
-    LeaveCriticalSection(&_errorSync);
+}
 
-    if (reportError) {
-        EnterCriticalSection(&_reportSync);
+void ThreadExecutor::drainWorkerQueues()
+{
+    for (unsigned int i = 0; i < _settings.jobs; ++i) {
+        ResultRecord *record = mWorkerQueues[i].head.exchange(nullptr, std::memory_order_acquire);
+
+        // the stack is newest-first - reverse it to report in push order
+        ResultRecord *ordered = nullptr;
+        while (record) {
+            ResultRecord *next = record->next;
+            record->next = ordered;
+            ordered = record;
+            record = next;
+        }
 
-        switch (msgType) {
-        case REPORT_ERROR:
-            _errorLogger.reportErr(msg);
-            break;
-        case REPORT_INFO:
-            _errorLogger.reportInfo(msg);
-            break;
+        while (ordered) {
+            handleRecord(*ordered);
+            ResultRecord *next = ordered->next;
+            delete ordered;
+            ordered = next;
         }
+    }
+}
 
+void ThreadExecutor::handleRecord(const ResultRecord &record)
+{
+    if (record.recordType == RECORD_OUT) {
+        EnterCriticalSection(&_reportSync);
+        _errorLogger.reportOut(record.data);
         LeaveCriticalSection(&_reportSync);
+        return;
+    }
+
+    if (_settings.sortedResults) {
+        // Collect now, sort and deduplicate when the threads have finished
+        _sortedRecords.push_back(static_cast<char>(record.recordType == RECORD_INFO ? '3' : '2') + record.data);
+        return;
     }
+
+    ErrorLogger::ErrorMessage msg;
+    if (!msg.deserialize(record.data))
+        return;
+
+    // Alert only about unique errors. Hashed, not searched linearly - the
+    // same message from a widely included header arrives once per
+    // translation unit.
+    if (!_errorList.insert(msg.toString(_settings.verbose)).second)
+        return;
+
+    EnterCriticalSection(&_reportSync);
+    if (record.recordType == RECORD_ERROR)
+        _errorLogger.reportErr(msg);
+    else
+        _errorLogger.reportInfo(msg);
+    LeaveCriticalSection(&_reportSync);
+}
+
+void ThreadExecutor::reportOut(const std::string &outmsg)
+{
+    pushRecord(RECORD_OUT, outmsg);
+}
+
+void ThreadExecutor::reportErr(const ErrorLogger::ErrorMessage &msg)
+{
+    if (_settings.nomsg.isSuppressed(msg.toSuppressionsErrorMessage()))
+        return;
+    pushRecord(RECORD_ERROR, msg.serialize());
+}
+
+void ThreadExecutor::reportInfo(const ErrorLogger::ErrorMessage &msg)
+{
+    if (_settings.nomsg.isSuppressed(msg.toSuppressionsErrorMessage()))
+        return;
+    pushRecord(RECORD_INFO, msg.serialize());
 }
 
 #else
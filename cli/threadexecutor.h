@@ -22,10 +22,16 @@
 #include "errorlogger.h"
 #include "importproject.h"
 
+#include <atomic>
+#include <condition_variable>
 #include <cstddef>
 #include <list>
 #include <map>
+#include <mutex>
 #include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #if (defined(__GNUC__) || defined(__sun)) && !defined(__MINGW32__)
 #define THREADING_MODEL_FORK
@@ -77,19 +83,47 @@ private:
 
     /**
      * Read from the pipe, parse and handle what ever is in there.
-     *@return -1 in case of error
+     *@return -2 if the pipe was closed (the worker terminated)
+     *         -1 if the worker finished checking its file
      *         0 if there is nothing in the pipe to be read
      *         1 if we did read something
      */
     int handleRead(int rpipe, unsigned int &result);
     void writeToPipe(PipeSignal type, const std::string &data);
+
+    /**
+     * Flush the buffered messages to the status pipe. Only used in the
+     * worker processes.
+     */
+    void flushToPipe();
+
+    /** @brief Seen error texts, hashed so a message repeated by many
+     * translation units is deduplicated in constant time.
+     * Only used in the master process. */
+    std::unordered_set<std::string> _errorList;
+
+    /** @brief Directory of the cross-worker deduplication markers when a
+     * build dir is available, see claimFinding(). Empty = no markers. */
+    std::string _markerDir;
+
+    /**
+     * Has this worker claimed the given header finding? A finding already
+     * claimed by another worker is a duplicate the master would drop, so
+     * it is not sent at all.
+     */
+    bool claimFinding(const ErrorLogger::ErrorMessage &msg) const;
+
     /**
      * Write end of status pipe, different for each child.
      * Not used in master process.
      */
-    std::list<std::string> _errorList;
     int _wpipe;
 
+    /** @brief Messages not yet written to the status pipe. The errors are
+     * buffered so the worker does not block on the pipe for each finding
+     * when the master is busy with another worker. */
+    std::string _pipeBuffer;
+
     /**
      * @brief Check load average condition
      * @param nchildren - count of currently ran children
@@ -97,7 +131,77 @@ private:
      */
     bool checkLoadAverage(size_t nchildren);
 
+    /** @brief Serialized results collected when --sorted-results is used,
+     * written to the shard file when the worker is dismissed.
+     * Only used in the worker processes. */
+    std::vector<std::string> _sortedRecords;
+
+    /** @brief Result shard file of this worker (--sorted-results). */
+    std::string _shardFileName;
+
+    /** @brief Trace shard file of this worker (--trace-report). */
+    std::string _traceShardFileName;
+
+    /**
+     * Sort the collected results and write them to the shard file.
+     * Only used in the worker processes.
+     */
+    void writeShard();
+
+    /**
+     * Merge the sorted result shards of the dismissed workers and report
+     * the deduplicated results. One open stream and one read-ahead record
+     * per shard, so the memory use is bounded by the worker count and not
+     * by the result count. Only used in the master process.
+     */
+    void mergeShards(const std::vector<std::string> &shardFiles);
+
+    /** @brief Report one merged shard record to the error logger. */
+    void reportRecord(const std::string &record);
+
+    /**
+     * Write the trace events collected by this worker to its trace shard
+     * file. Only used in the worker processes.
+     */
+    void writeTraceShard();
+
+    /**
+     * Merge the trace shards of the dismissed workers into the
+     * --trace-report file, one trace process per worker. Only used in
+     * the master process.
+     */
+    void mergeTraceShards(const std::vector<std::string> &traceShardFiles);
+
+    /** @brief Streaming intake enabled, see enableStreaming(). */
+    bool mStreaming;
+
+    /** @brief No more streamed files will arrive, see endOfFiles(). */
+    bool mStreamingDone;
+
+    /** @brief Streamed files waiting to be dispatched: name and size. */
+    std::list<std::pair<std::string, std::size_t> > mStreamedFiles;
+
+    std::mutex mStreamMutex;
+    std::condition_variable mStreamCond;
+
 public:
+    /**
+     * @brief Enable streaming file intake. check() then also dispatches
+     * files queued with addFileJob() while the workers are already running,
+     * so the file enumeration overlaps with the analysis, and does not
+     * finish until endOfFiles() was called.
+     */
+    void enableStreaming();
+
+    /**
+     * @brief Queue a file discovered while check() is running.
+     * Thread-safe, called from the enumeration thread.
+     */
+    void addFileJob(const std::string &filename, std::size_t filesize);
+
+    /** @brief Signal that no more files will be queued with addFileJob(). */
+    void endOfFiles();
+
     /**
      * @return true if support for threads exist.
      */
@@ -108,7 +212,7 @@ public:
 #elif defined(THREADING_MODEL_WIN)
 
 private:
-    enum MessageType {REPORT_ERROR, REPORT_INFO};
+    enum RecordType {RECORD_OUT, RECORD_ERROR, RECORD_INFO};
 
     std::map<std::string, std::string> _fileContents;
     std::map<std::string, std::size_t>::const_iterator _itNextFile;
@@ -119,15 +223,60 @@ private:
     std::size_t _totalFileSize;
     CRITICAL_SECTION _fileSync;
 
-    std::list<std::string> _errorList;
-    CRITICAL_SECTION _errorSync;
+    /** @brief Seen error texts, used by the reporter thread to report only
+     * unique errors. Only accessed by the reporter thread. */
+    std::unordered_set<std::string> _errorList;
+
+    /** @brief Serialized results collected when --sorted-results is used,
+     * sorted and reported when the threads have finished.
+     * Only filled by the reporter thread. */
+    std::vector<std::string> _sortedRecords;
 
     CRITICAL_SECTION _reportSync;
 
-    void report(const ErrorLogger::ErrorMessage &msg, MessageType msgType);
+    /** @brief One queued result message, see WorkerQueue. */
+    struct ResultRecord {
+        ResultRecord(RecordType recordType_, const std::string &data_) : recordType(recordType_), data(data_), next(nullptr) {}
+        RecordType recordType;
+        std::string data; ///< outmsg or a serialized ErrorMessage
+        ResultRecord *next;
+    };
+
+    /** @brief Lock-free result queue of one worker thread. The worker
+     * pushes its records onto the stack with a compare-and-swap; the
+     * reporter thread takes the whole stack with an exchange and reverses
+     * it. The workers never wait on a lock to report a finding, which used
+     * to serialize all the workers during high finding rate phases. */
+    struct WorkerQueue {
+        std::atomic<ResultRecord *> head;
+    };
+
+    /** @brief One result queue per worker thread, allocated in check(). */
+    WorkerQueue *mWorkerQueues;
+
+    /** @brief Next free worker queue slot, claimed by the worker threads. */
+    std::atomic<unsigned int> mNextQueueSlot;
+
+    /** @brief The worker threads have all finished. */
+    std::atomic<bool> mWorkersDone;
+
+    /** @brief Auto-reset event, signaled when an empty queue gets its
+     * first record so the reporter thread wakes up. */
+    HANDLE mQueueEvent;
+
+    /** @brief Push one record onto this worker's queue. */
+    void pushRecord(RecordType recordType, const std::string &data);
+
+    /** @brief Report all queued records. Only used by the reporter thread. */
+    void drainWorkerQueues();
+
+    /** @brief Report one dequeued record. Only used by the reporter thread. */
+    void handleRecord(const ResultRecord &record);
 
     static unsigned __stdcall threadProc(void*);
 
+    static unsigned __stdcall reporterProc(void*);
+
 public:
     /**
      * @return true if support for threads exist.
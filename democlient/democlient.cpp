@@ -1,8 +1,15 @@
+#include <condition_variable>
 #include <ctime>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "cppcheck.h"
 #include "version.h"
@@ -26,47 +33,126 @@ static void unencode(const char *src, char *dest)
 
 static FILE *logfile = nullptr;
 
+/**
+ * One pre-initialized analysis context. The constructor does all the
+ * per-process setup - enabling the checks and loading the standard library
+ * configuration - so that run() costs only the analysis of the given code.
+ * A context is meant to be constructed once and reused for many requests;
+ * the thread-local token slabs it allocates from are recycled between
+ * requests, so the memory per context stays bounded by the largest request
+ * it has seen.
+ */
 class CppcheckExecutor : public ErrorLogger {
 private:
-    const std::time_t stoptime;
+    std::time_t stoptime;
+    std::string report;
     CppCheck cppcheck;
 
 public:
-    CppcheckExecutor()
+    explicit CppcheckExecutor(const char exename[])
         : ErrorLogger()
-        , stoptime(std::time(nullptr)+2U)
+        , stoptime(0)
         , cppcheck(*this, false) {
         cppcheck.settings().addEnabled("all");
         cppcheck.settings().inconclusive = true;
+        cppcheck.settings().library.load(exename, "std.cfg");
     }
 
-    void run(const char code[]) {
+    const std::string &run(const char code[]) {
+        report.clear();
+        stoptime = std::time(nullptr) + 2U;
         cppcheck.check("test.cpp", code);
+        return report;
     }
 
     void reportOut(const std::string &outmsg) override { }
     void reportErr(const ErrorLogger::ErrorMessage &msg) override {
-        const std::string s = msg.toString(true);
-
-        std::cout << s << std::endl;
-
-        if (logfile != nullptr)
-            std::fprintf(logfile, "%s\n", s.c_str());
+        report += msg.toString(true);
+        report += '\n';
     }
 
     void reportProgress(const std::string& filename,
                         const char stage[],
                         const std::size_t value) override {
         if (std::time(nullptr) >= stoptime) {
-            std::cout << "Time to analyse the code exceeded 2 seconds. Terminating.\n\n";
+            report += "Time to analyse the code exceeded 2 seconds. Terminating.\n\n";
             cppcheck.terminate();
         }
     }
 };
 
+// Pooled mode: requests are read from stdin, one URL-encoded code snippet
+// per line, and handed to a pool of worker threads that each own one
+// pre-initialized CppcheckExecutor. Responses carry the request number so
+// the client can match them when they complete out of order.
+static std::mutex requestLock;
+static std::condition_variable requestCond;
+static std::queue<std::pair<unsigned int, std::string> > requestQueue;
+static bool noMoreRequests = false;
+static std::mutex responseLock;
+
+static void poolWorker(const char *exename)
+{
+    // the expensive setup happens once per worker, before the first request
+    CppcheckExecutor executor(exename);
+    for (;;) {
+        std::pair<unsigned int, std::string> request;
+        {
+            std::unique_lock<std::mutex> lock(requestLock);
+            requestCond.wait(lock, [] {
+                return noMoreRequests || !requestQueue.empty();
+            });
+            if (requestQueue.empty())
+                return;
+            request = requestQueue.front();
+            requestQueue.pop();
+        }
+
+        std::vector<char> code(request.second.size() + 1, '\0');
+        unencode(request.second.c_str(), code.data());
+        const std::string &report = executor.run(code.data());
 
-int main()
+        std::lock_guard<std::mutex> lock(responseLock);
+        std::cout << report
+                  << "<done request=\"" << request.first << "\"/>" << std::endl;
+    }
+}
+
+static int runPool(const char *exename, unsigned int poolSize)
 {
+    std::vector<std::thread> workers;
+    for (unsigned int i = 0; i < poolSize; ++i)
+        workers.emplace_back(poolWorker, exename);
+
+    unsigned int requestNumber = 0;
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        if (line.empty())
+            continue;
+        std::lock_guard<std::mutex> lock(requestLock);
+        requestQueue.push(std::make_pair(requestNumber++, line));
+        requestCond.notify_one();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(requestLock);
+        noMoreRequests = true;
+        requestCond.notify_all();
+    }
+    for (std::thread &worker : workers)
+        worker.join();
+
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv)
+{
+    // persistent snippet service: ./democlient --daemon [poolsize]
+    if (argc >= 2 && std::strcmp(argv[1], "--daemon") == 0) {
+        const int poolSize = (argc >= 3) ? std::atoi(argv[2]) : 2;
+        return runPool(argv[0], (poolSize >= 1) ? poolSize : 1);
+    }
+
     std::cout << "Content-type: text/html\r\n\r\n"
               << "<!DOCTYPE html>\n";
 
@@ -100,8 +186,11 @@ int main()
 
     std::cout << "<html><body>Cppcheck " CPPCHECK_VERSION_STRING "<pre>";
 
-    CppcheckExecutor cppcheckExecutor;
-    cppcheckExecutor.run(code);
+    CppcheckExecutor cppcheckExecutor(argv[0]);
+    const std::string &report = cppcheckExecutor.run(code);
+    std::cout << report;
+    if (logfile != nullptr)
+        std::fprintf(logfile, "%s\n", report.c_str());
 
     std::fclose(logfile);
 
@@ -29,6 +29,7 @@
 #include <fstream>
 #include <iostream>
 #include <limits>
+#include <mutex>
 #include <sstream>
 #include <stack>
 #include <stdexcept>
@@ -355,7 +356,12 @@ static unsigned short getAndSkipBOM(std::istream &istr)
 
 static bool isNameChar(unsigned char ch)
 {
-    return std::isalnum(ch) || ch == '_' || ch == '$';
+    // explicit ranges instead of the locale-dependent std::isalnum();
+    // this is called for almost every character in the input
+    return (ch >= 'a' && ch <= 'z') ||
+           (ch >= 'A' && ch <= 'Z') ||
+           (ch >= '0' && ch <= '9') ||
+           ch == '_' || ch == '$';
 }
 
 static std::string escapeString(const std::string &str)
@@ -467,6 +473,18 @@ void simplecpp::TokenList::readfile(std::istream &istr, const std::string &filen
 
         if (std::isspace(ch)) {
             location.col++;
+            if (bom == 0) {
+                // Consume the rest of the blank run directly from the stream
+                // buffer. istream::get() constructs a sentry for every
+                // character which dominates the profile for indented code.
+                std::streambuf * const sb = istr.rdbuf();
+                int c = sb->sgetc();
+                while (c == ' ' || c == '\t') {
+                    location.col++;
+                    sb->sbumpc();
+                    c = sb->sgetc();
+                }
+            }
             continue;
         }
 
@@ -490,6 +508,19 @@ void simplecpp::TokenList::readfile(std::istream &istr, const std::string &filen
             const bool num = std::isdigit(ch);
             while (istr.good() && isNameChar(ch)) {
                 currentToken += ch;
+                if (bom == 0) {
+                    // consume the rest of the identifier/number run directly
+                    // from the stream buffer (see the whitespace loop above);
+                    // name characters never need the \r and UTF-16 handling
+                    // in readChar()
+                    std::streambuf * const sb = istr.rdbuf();
+                    int c = sb->sgetc();
+                    while (c != EOF && isNameChar((unsigned char)c)) {
+                        currentToken += (char)c;
+                        sb->sbumpc();
+                        c = sb->sgetc();
+                    }
+                }
                 ch = readChar(istr,bom);
                 if (num && ch=='\'' && isNameChar(peekChar(istr,bom)))
                     ch = readChar(istr,bom);
@@ -1116,7 +1147,7 @@ unsigned int simplecpp::TokenList::fileIndex(const std::string &filename)
 namespace simplecpp {
     class Macro {
     public:
-        explicit Macro(std::vector<std::string> &f) : nameTokDef(NULL), variadic(false), valueToken(NULL), endToken(NULL), files(f), tokenListDefine(f), valueDefinedInCode_(false) {}
+        explicit Macro(std::vector<std::string> &f) : nameTokDef(NULL), variadic(false), valueToken(NULL), endToken(NULL), files(f), tokenListDefine(f), valueDefinedInCode_(false), expansionCacheState(CACHE_UNKNOWN) {}
 
         Macro(const Token *tok, std::vector<std::string> &f) : nameTokDef(NULL), files(f), tokenListDefine(f), valueDefinedInCode_(true) {
             if (sameline(tok->previous, tok))
@@ -1308,6 +1339,8 @@ namespace simplecpp {
         bool parseDefine(const Token *nametoken) {
             nameTokDef = nametoken;
             variadic = false;
+            expansionCacheState = CACHE_UNKNOWN;
+            expansionCache.clear();
             if (!nameTokDef) {
                 valueToken = endToken = NULL;
                 args.clear();
@@ -1445,6 +1478,33 @@ namespace simplecpp {
                 return nameTokInst->next;
             }
 
+            // An object-like macro whose replacement list contains no macro
+            // name and no '#' operator expands to the same token strings for
+            // every use, so the first expansion is recorded and replayed for
+            // later uses. Config headers full of constant macros hit this
+            // path constantly.
+            if (expansionCacheState == CACHE_UNKNOWN) {
+                expansionCacheState = CACHE_EMPTY;
+                if (functionLike())
+                    expansionCacheState = CACHE_UNUSABLE;
+                else {
+                    for (const Token *tok = valueToken; tok != endToken; tok = tok->next) {
+                        if (tok->name || tok->op == '#') {
+                            expansionCacheState = CACHE_UNUSABLE;
+                            break;
+                        }
+                    }
+                }
+            }
+            if (expansionCacheState == CACHE_FILLED) {
+                for (std::vector<TokenString>::const_iterator it = expansionCache.begin(); it != expansionCache.end(); ++it) {
+                    Token * const tok = new Token(*it, loc);
+                    tok->macro = nameTokInst->str();
+                    output->push_back(tok);
+                }
+                return nameTokInst->next;
+            }
+
             const bool calledInDefine = (loc.fileIndex != nameTokInst->location.fileIndex ||
                                          loc.line < nameTokInst->location.line);
 
@@ -1552,6 +1612,12 @@ namespace simplecpp {
                 }
             }
 
+            if (expansionCacheState == CACHE_EMPTY) {
+                for (const Token *tok = output_end_1 ? output_end_1->next : output->cfront(); tok; tok = tok->next)
+                    expansionCache.push_back(tok->str());
+                expansionCacheState = CACHE_FILLED;
+            }
+
             if (!parametertokens1.empty())
                 parametertokens1.swap(parametertokens2);
 
@@ -1835,6 +1901,13 @@ namespace simplecpp {
 
         /** was the value of this macro actually defined in the code? */
         bool valueDefinedInCode_;
+
+        /** state of the expansion replay cache, see expand() */
+        enum ExpansionCacheState { CACHE_UNKNOWN, CACHE_EMPTY, CACHE_FILLED, CACHE_UNUSABLE };
+        mutable ExpansionCacheState expansionCacheState;
+
+        /** recorded expansion of a simple object-like macro */
+        mutable std::vector<TokenString> expansionCache;
     };
 }
 
@@ -2241,6 +2314,107 @@ static bool hasFile(const std::map<std::string, simplecpp::TokenList *> &filedat
     return !getFileName(filedata, sourcefile, header, dui, systemheader).empty();
 }
 
+// State of the two header caches below, at file scope so
+// simplecpp::clearHeaderCache() can reset it between runs.
+static std::map<std::string, std::string> resolutionCache;
+static const std::size_t maxResolutionCacheSize = 100000U;
+static std::mutex resolutionCacheMutex;
+static std::map<std::string, std::string> contentCache;
+static std::size_t contentCacheSize = 0;
+static const std::size_t maxContentCacheSize = 64U * 1024U * 1024U;
+static std::mutex contentCacheMutex;
+
+void simplecpp::clearHeaderCache()
+{
+    std::lock_guard<std::mutex> lockResolutions(resolutionCacheMutex);
+    std::lock_guard<std::mutex> lockContents(contentCacheMutex);
+    resolutionCache.clear();
+    contentCache.clear();
+    contentCacheSize = 0;
+}
+
+/**
+ * Cross-TU cache of include resolution results.
+ *
+ * Resolving an #include probes the include directories in order until one
+ * of them opens, so with long -I lists the failed opens dominate, and the
+ * same spellings resolve to the same files in every translation unit of a
+ * run. Remember the outcome per (source directory, include path list,
+ * spelling) - failed resolutions too, those are the expensive ones - so
+ * later lookups go straight to the resolved file or give up without
+ * touching the filesystem. Like the content cache below this assumes the
+ * header set does not change during one run.
+ *
+ * On success 'f' is the opened resolved file, like with openHeader().
+ */
+static std::string resolveHeaderCached(std::ifstream &f, const simplecpp::DUI &dui, const std::string &sourcefile, const std::string &header, bool systemheader)
+{
+    std::string key(systemheader ? "<" : "\"");
+    if (!systemheader && sourcefile.find_first_of("\\/") != std::string::npos)
+        key += sourcefile.substr(0, sourcefile.find_last_of("\\/") + 1U);
+    key += header;
+    for (std::list<std::string>::const_iterator it = dui.includePaths.begin(); it != dui.includePaths.end(); ++it) {
+        key += '\n';
+        key += *it;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(resolutionCacheMutex);
+        const std::map<std::string, std::string>::const_iterator it = resolutionCache.find(key);
+        if (it != resolutionCache.end()) {
+            if (it->second.empty())
+                return "";
+            f.open(it->second.c_str());
+            if (f.is_open())
+                return it->second;
+            // the cached file disappeared during the run; resolve again
+        }
+    }
+
+    const std::string resolved = openHeader(f, dui, sourcefile, header, systemheader);
+
+    std::lock_guard<std::mutex> lock(resolutionCacheMutex);
+    if (resolutionCache.size() < maxResolutionCacheSize)
+        resolutionCache[key] = resolved;
+    return resolved;
+}
+
+/**
+ * Cross-TU cache of header file contents.
+ *
+ * When many translation units are analyzed in one run, the same system/common
+ * headers are opened and read once per TU. Cache the bytes per process so
+ * later TUs lex them from memory instead of the filesystem. Header files are
+ * assumed not to change during one run. The cache stops growing at a fixed
+ * budget so huge header sets cannot exhaust memory.
+ *
+ * If the file is already cached, 'fin' is not used (and need not be open).
+ * Returns false if the content is unavailable.
+ */
+static bool readHeaderCached(const std::string &filename, std::ifstream &fin, std::string &content)
+{
+    std::lock_guard<std::mutex> lock(contentCacheMutex);
+
+    const std::map<std::string, std::string>::const_iterator it = contentCache.find(filename);
+    if (it != contentCache.end()) {
+        content = it->second;
+        return true;
+    }
+
+    if (!fin.is_open())
+        return false;
+
+    std::ostringstream ostr;
+    ostr << fin.rdbuf();
+    content = ostr.str();
+
+    if (contentCacheSize + content.size() <= maxContentCacheSize) {
+        contentCache[filename] = content;
+        contentCacheSize += content.size();
+    }
+    return true;
+}
+
 std::map<std::string, simplecpp::TokenList*> simplecpp::load(const simplecpp::TokenList &rawtokens, std::vector<std::string> &fileNumbers, const simplecpp::DUI &dui, simplecpp::OutputList *outputList)
 {
     std::map<std::string, simplecpp::TokenList*> ret;
@@ -2255,10 +2429,12 @@ std::map<std::string, simplecpp::TokenList*> simplecpp::load(const simplecpp::To
             continue;
 
         std::ifstream fin(filename.c_str());
-        if (!fin.is_open())
+        std::string filedata;
+        if (!readHeaderCached(filename, fin, filedata))
             continue;
+        std::istringstream fdata(filedata);
 
-        TokenList *tokenlist = new TokenList(fin, fileNumbers, filename, outputList);
+        TokenList *tokenlist = new TokenList(fdata, fileNumbers, filename, outputList);
         if (!tokenlist->front()) {
             delete tokenlist;
             continue;
@@ -2294,11 +2470,15 @@ std::map<std::string, simplecpp::TokenList*> simplecpp::load(const simplecpp::To
             continue;
 
         std::ifstream f;
-        const std::string header2 = openHeader(f,dui,sourcefile,header,systemheader);
+        const std::string header2 = resolveHeaderCached(f,dui,sourcefile,header,systemheader);
         if (!f.is_open())
             continue;
 
-        TokenList *tokens = new TokenList(f, fileNumbers, header2, outputList);
+        std::string filedata;
+        if (!readHeaderCached(header2, f, filedata))
+            continue;
+        std::istringstream fdata(filedata);
+        TokenList *tokens = new TokenList(fdata, fileNumbers, header2, outputList);
         ret[header2] = tokens;
         if (tokens->front())
             filelist.push_back(tokens->front());
@@ -2515,7 +2695,7 @@ void simplecpp::preprocess(simplecpp::TokenList &output, const simplecpp::TokenL
                 if (header2.empty()) {
                     // try to load file..
                     std::ifstream f;
-                    header2 = openHeader(f, dui, rawtok->location.file(), header, systemheader);
+                    header2 = resolveHeaderCached(f, dui, rawtok->location.file(), header, systemheader);
                     if (f.is_open()) {
                         TokenList *tokens = new TokenList(f, files, header2, outputList);
                         filedata[header2] = tokens;
@@ -310,6 +310,13 @@ namespace simplecpp {
      */
     SIMPLECPP_LIB void cleanup(std::map<std::string, TokenList*> &filedata);
 
+    /**
+     * Forget the cached header contents and include resolutions. The caches
+     * assume the headers do not change during one run; a resident process
+     * that starts a new run must call this so edited headers are re-read.
+     */
+    SIMPLECPP_LIB void clearHeaderCache();
+
     /** Simplify path */
     SIMPLECPP_LIB std::string simplifyPath(std::string path);
 }
@@ -425,7 +425,7 @@ void CheckThread::parseClangErrors(const QString &tool, const QString &file0, QS
         Suppressions::ErrorMessage errorMessage;
         errorMessage.setFileName(e.errorPath.back().file.toStdString());
         errorMessage.lineNumber = e.errorPath.back().line;
-        errorMessage.errorId = e.errorId.toStdString();
+        errorMessage.setErrorId(e.errorId.toStdString());
         errorMessage.symbolNames = e.symbolNames.toStdString();
 
         bool isSuppressed = false;
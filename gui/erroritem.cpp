@@ -40,7 +40,7 @@ ErrorItem::ErrorItem()
 }
 
 ErrorItem::ErrorItem(const ErrorLogger::ErrorMessage &errmsg)
-    : errorId(QString::fromStdString(errmsg._id))
+    : errorId(QString::fromStdString(errmsg.id()))
     , severity(errmsg._severity)
     , inconclusive(errmsg._inconclusive)
     , summary(QString::fromStdString(errmsg.shortMessage()))
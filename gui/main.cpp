@@ -78,8 +78,9 @@ int main(int argc, char *argv[])
 
     app.setWindowIcon(QIcon(":cppcheck-gui.png"));
 
-    // Register this metatype that is used to transfer error info
+    // Register these metatypes that are used to transfer error info
     qRegisterMetaType<ErrorItem>("ErrorItem");
+    qRegisterMetaType<QList<ErrorItem> >("QList<ErrorItem>");
 
     MainWindow window(th, settings);
     window.show();
@@ -534,8 +534,8 @@ void MainWindow::analyzeCode(const QString& code, const QString& filename)
     result.setFiles(QStringList(filename));
     connect(&result, SIGNAL(progress(int, const QString&)),
             mUI.mResults, SLOT(progress(int, const QString&)));
-    connect(&result, SIGNAL(error(const ErrorItem &)),
-            mUI.mResults, SLOT(error(const ErrorItem &)));
+    connect(&result, SIGNAL(errorBatch(const QList<ErrorItem> &)),
+            mUI.mResults, SLOT(errorBatch(const QList<ErrorItem> &)));
     connect(&result, SIGNAL(log(const QString &)),
             mUI.mResults, SLOT(log(const QString &)));
     connect(&result, SIGNAL(debugError(const ErrorItem &)),
@@ -550,6 +550,7 @@ void MainWindow::analyzeCode(const QString& code, const QString& filename)
     clearResults();
     mUI.mResults->checkingStarted(1);
     cppcheck.check(filename.toStdString(), code.toStdString());
+    result.flushPendingErrors();
     analysisDone();
 
     // Expand results
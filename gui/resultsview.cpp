@@ -121,6 +121,21 @@ void ResultsView::error(const ErrorItem &item)
     }
 }
 
+void ResultsView::errorBatch(const QList<ErrorItem> &errorItems)
+{
+    bool gotErrors = false;
+    mUI.mTree->setUpdatesEnabled(false);
+    foreach (const ErrorItem &item, errorItems) {
+        if (mUI.mTree->addErrorItem(item)) {
+            gotErrors = true;
+            mStatistics->addItem(item.tool(), ShowTypes::SeverityToShowType(item.severity));
+        }
+    }
+    mUI.mTree->setUpdatesEnabled(true);
+    if (gotErrors)
+        emit gotResults();
+}
+
 void ResultsView::filterResults(const QString& filter)
 {
     mUI.mTree->filterResults(filter);
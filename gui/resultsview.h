@@ -275,6 +275,16 @@ public slots:
     */
     void error(const ErrorItem &item);
 
+    /**
+    * @brief Slot for a batch of new errors to be displayed
+    *
+    * The whole batch is added with updates disabled so the result tree
+    * repaints once per batch instead of once per result.
+    *
+    * @param errorItems Error data
+    */
+    void errorBatch(const QList<ErrorItem> &errorItems);
+
     /**
     * @brief Filters the results in the result list.
     */
@@ -160,6 +160,7 @@ void ThreadHandler::threadDone()
 
     mRunningThreadCount--;
     if (mRunningThreadCount == 0) {
+        mResults.flushPendingErrors();
         emit done();
 
         mScanDuration = mTime.elapsed();
@@ -186,8 +187,8 @@ void ThreadHandler::initialize(ResultsView *view)
     connect(&mResults, &ThreadResult::progress,
             view, &ResultsView::progress);
 
-    connect(&mResults, &ThreadResult::error,
-            view, &ResultsView::error);
+    connect(&mResults, &ThreadResult::errorBatch,
+            view, &ResultsView::errorBatch);
 
     connect(&mResults, &ThreadResult::log,
             this, &ThreadHandler::log);
@@ -46,6 +46,12 @@ void ThreadResult::fileChecked(const QString &file)
 {
     QMutexLocker locker(&mutex);
 
+    // show the results of the finished file without waiting for a full batch
+    if (!mPendingErrors.isEmpty()) {
+        emit errorBatch(mPendingErrors);
+        mPendingErrors.clear();
+    }
+
     mProgress += QFile(file).size();
     mFilesChecked ++;
 
@@ -57,14 +63,33 @@ void ThreadResult::fileChecked(const QString &file)
     }
 }
 
+// Emitting one queued signal per result floods the UI thread's event loop
+// when a run produces a very large number of findings, so the results are
+// delivered in batches of this size.
+static const int ErrorBatchSize = 100;
+
 void ThreadResult::reportErr(const ErrorLogger::ErrorMessage &msg)
 {
     QMutexLocker locker(&mutex);
     const ErrorItem item(msg);
-    if (msg._severity != Severity::debug)
-        emit error(item);
-    else
+    if (msg._severity == Severity::debug) {
         emit debugError(item);
+        return;
+    }
+    mPendingErrors.append(item);
+    if (mPendingErrors.size() >= ErrorBatchSize) {
+        emit errorBatch(mPendingErrors);
+        mPendingErrors.clear();
+    }
+}
+
+void ThreadResult::flushPendingErrors()
+{
+    QMutexLocker locker(&mutex);
+    if (!mPendingErrors.isEmpty()) {
+        emit errorBatch(mPendingErrors);
+        mPendingErrors.clear();
+    }
 }
 
 QString ThreadResult::getNextFile()
@@ -20,6 +20,7 @@
 #ifndef THREADRESULT_H
 #define THREADRESULT_H
 
+#include <QList>
 #include <QMutex>
 #include <QObject>
 #include <QStringList>
@@ -75,6 +76,11 @@ public:
     void reportOut(const std::string &outmsg) override;
     void reportErr(const ErrorLogger::ErrorMessage &msg) override;
 
+    /**
+    * @brief Emit the results that are still waiting in the current batch
+    */
+    void flushPendingErrors();
+
 public slots:
 
     /**
@@ -91,11 +97,14 @@ signals:
     void progress(int value, const QString& description);
 
     /**
-    * @brief Signal of a new error
+    * @brief Signal of a batch of new errors
     *
-    * @param item Error data
+    * The results are batched so that checking 100k findings does not
+    * queue 100k events to the UI thread.
+    *
+    * @param errorItems Error data
     */
-    void error(const ErrorItem &item);
+    void errorBatch(const QList<ErrorItem> &errorItems);
 
     /**
     * @brief Signal of a new log message
@@ -127,6 +136,12 @@ protected:
 
     std::list<ImportProject::FileSettings> mFileSettings;
 
+    /**
+    * @brief Results waiting to be emitted in the next errorBatch() signal
+    *
+    */
+    QList<ErrorItem> mPendingErrors;
+
     /**
     * @brief Max progress
     *
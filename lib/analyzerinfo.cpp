@@ -22,13 +22,40 @@
 #include "utils.h"
 
 #include <tinyxml2.h>
+#include <cstdio>
 #include <cstring>
+#include <fstream>
 #include <map>
 #include <sstream>
+#include <utility>
+
+#ifdef _WIN32
+#include <sys/utime.h>
+#else
+#include <utime.h>
+#endif
+
+/** Update the modification time so it records when the entry was last used.
+ * That is what --build-dir-gc evicts old entries by. */
+static void markUsed(const std::string &filename)
+{
+#ifdef _WIN32
+    _utime(filename.c_str(), nullptr);
+#else
+    utime(filename.c_str(), nullptr);
+#endif
+}
 
 AnalyzerInformation::~AnalyzerInformation()
 {
     close();
+    {
+        std::lock_guard<std::mutex> lock(mWriteSync);
+        mShutdown = true;
+    }
+    mWriteCond.notify_all();
+    if (mWriterThread.joinable())
+        mWriterThread.join();
 }
 
 static std::string getFilename(const std::string &fullpath)
@@ -64,17 +91,207 @@ void AnalyzerInformation::writeFilesTxt(const std::string &buildDir, const std::
     }
 }
 
+static bool readFileContent(const std::string &filename, std::string *content)
+{
+    std::ifstream fin(filename);
+    if (!fin.is_open())
+        return false;
+    std::ostringstream ostr;
+    ostr << fin.rdbuf();
+    *content = ostr.str();
+    return true;
+}
+
+/** Copy an analyzer info file, publishing it atomically so a reader in
+ * another process never sees a partial copy. A torn temporary caused by two
+ * processes writing the same entry at once does not validate as XML and is
+ * treated as a cache miss on the next lookup. */
+static void copyAnalyzerInfoFile(const std::string &src, const std::string &dest)
+{
+    std::string content;
+    if (!readFileContent(src, &content))
+        return;
+    std::ofstream fout(dest + ".tmp");
+    if (!fout.is_open())
+        return;
+    fout << content;
+    fout.close();
+    std::rename((dest + ".tmp").c_str(), dest.c_str());
+}
+
+/** Write an analyzer info file, publishing it atomically like
+ * copyAnalyzerInfoFile(). The analyzer info only becomes visible once it
+ * is complete, so an interrupted run never records a half-analyzed file
+ * and a rerun resumes with exactly the files that were not finished. */
+static void writeAnalyzerInfoFile(const std::string &filename, const std::string &content)
+{
+    std::ofstream fout(filename + ".tmp");
+    if (!fout.is_open())
+        return;
+    fout << content;
+    fout.close();
+    std::rename((filename + ".tmp").c_str(), filename.c_str());
+}
+
 void AnalyzerInformation::close()
 {
+    if (mOpen) {
+        mContent << "</analyzerinfo>\n";
+        // The completed file is written by the background thread so the
+        // worker can move to the next file without waiting for the
+        // filesystem
+        enqueueWrite(mAnalyzerInfoFile, mCacheFile, mContent.str());
+        mContent.str(std::string());
+        mOpen = false;
+    }
     mAnalyzerInfoFile.clear();
-    if (mOutputStream.is_open()) {
-        mOutputStream << "</analyzerinfo>\n";
-        mOutputStream.close();
+    mCacheFile.clear();
+}
+
+void AnalyzerInformation::enqueueWrite(const std::string &infoFile, const std::string &cacheFile, std::string content)
+{
+    WriteJob job;
+    job.infoFile = infoFile;
+    job.cacheFile = cacheFile;
+    job.content = std::move(content);
+    {
+        std::lock_guard<std::mutex> lock(mWriteSync);
+        mWriteQueue.push_back(std::move(job));
+        ++mPendingWrites;
+        if (!mWriterThread.joinable())
+            mWriterThread = std::thread(&AnalyzerInformation::writerThreadProc, this);
+    }
+    mWriteCond.notify_all();
+}
+
+void AnalyzerInformation::writerThreadProc()
+{
+    std::unique_lock<std::mutex> lock(mWriteSync);
+    for (;;) {
+        while (mWriteQueue.empty() && !mShutdown)
+            mWriteCond.wait(lock);
+        if (mWriteQueue.empty())
+            return;
+        const WriteJob job = std::move(mWriteQueue.front());
+        mWriteQueue.pop_front();
+        lock.unlock();
+        writeAnalyzerInfoFile(job.infoFile, job.content);
+        if (!job.cacheFile.empty())
+            writeAnalyzerInfoFile(job.cacheFile, job.content);
+        lock.lock();
+        --mPendingWrites;
+        if (mPendingWrites == 0)
+            mWriteCond.notify_all(); // wake up flush()
+    }
+}
+
+void AnalyzerInformation::flush()
+{
+    std::unique_lock<std::mutex> lock(mWriteSync);
+    while (mPendingWrites > 0)
+        mWriteCond.wait(lock);
+}
+
+// 64-bit FNV-1a. Only compared against hashes computed by the same code, so
+// the algorithm just needs to be cheap and stable.
+static unsigned long long contentHash(const std::string &data)
+{
+    unsigned long long hash = 0xcbf29ce484222325ULL;
+    for (std::string::const_iterator c = data.begin(); c != data.end(); ++c) {
+        hash ^= (unsigned char)*c;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+void AnalyzerInformation::setFileHashes(const std::string &toolinfo, const std::list<std::string> &sourcefiles)
+{
+    if (!mOpen)
+        return;
+
+    // write the element to a buffer first; if some file can't be read back
+    // the closure can't be validated later so nothing is recorded
+    std::ostringstream ostr;
+    ostr << "  <filehashes toolinfo=\"" << contentHash(toolinfo) << "\">\n";
+    for (const std::string &f : sourcefiles) {
+        std::string content;
+        if (!readFileContent(f, &content))
+            return;
+        ostr << "    <file name=\"" << ErrorLogger::toxml(f) << "\" hash=\"" << contentHash(content) << "\"/>\n";
+    }
+    ostr << "  </filehashes>\n";
+    mContent << ostr.str();
+}
+
+bool AnalyzerInformation::filesUnchanged(const std::string &analyzerInfoFile, const std::string &toolinfo, std::list<ErrorLogger::ErrorMessage> *errors)
+{
+    tinyxml2::XMLDocument doc;
+    if (doc.LoadFile(analyzerInfoFile.c_str()) != tinyxml2::XML_SUCCESS)
+        return false;
+
+    const tinyxml2::XMLElement * const rootNode = doc.FirstChildElement();
+    if (rootNode == nullptr)
+        return false;
+
+    const tinyxml2::XMLElement *filehashes = nullptr;
+    for (const tinyxml2::XMLElement *e = rootNode->FirstChildElement(); e; e = e->NextSiblingElement()) {
+        if (std::strcmp(e->Name(), "filehashes") == 0) {
+            filehashes = e;
+            break;
+        }
+    }
+    if (!filehashes)
+        return false;
+
+    const char *toolinfoAttr = filehashes->Attribute("toolinfo");
+    if (!toolinfoAttr || toolinfoAttr != std::to_string(contentHash(toolinfo)))
+        return false;
+
+    for (const tinyxml2::XMLElement *e = filehashes->FirstChildElement(); e; e = e->NextSiblingElement()) {
+        if (std::strcmp(e->Name(), "file") != 0)
+            return false;
+        const char *name = e->Attribute("name");
+        const char *hash = e->Attribute("hash");
+        if (!name || !hash)
+            return false;
+        std::string content;
+        if (!readFileContent(name, &content))
+            return false;
+        if (hash != std::to_string(contentHash(content)))
+            return false;
     }
+
+    for (const tinyxml2::XMLElement *e = rootNode->FirstChildElement(); e; e = e->NextSiblingElement()) {
+        if (std::strcmp(e->Name(), "error") == 0)
+            errors->emplace_back(e);
+    }
+
+    markUsed(analyzerInfoFile);
+    return true;
 }
 
-static bool skipAnalysis(const std::string &analyzerInfoFile, unsigned long long checksum, std::list<ErrorLogger::ErrorMessage> *errors)
+static bool skipAnalysis(const std::string &analyzerInfoFile, unsigned long long checksum, std::list<ErrorLogger::ErrorMessage> *errors, bool *recorded)
 {
+    // Cheap probe first. The checksum is in the fixed header that
+    // analyzeFile writes, so a changed file is rejected with one small read
+    // instead of parsing the whole XML. Probing all the analyzer info files
+    // of a big project is a measurable part of a rerun.
+    {
+        std::ifstream fin(analyzerInfoFile);
+        if (!fin.is_open())
+            return false;
+        if (recorded)
+            *recorded = true;
+        char buf[128] = {0};
+        fin.read(buf, sizeof(buf) - 1);
+        const char *attr = std::strstr(buf, "checksum=\"");
+        if (!attr)
+            return false;
+        const std::string expected = std::to_string(checksum);
+        if (std::strncmp(attr + 10, expected.c_str(), expected.size()) != 0 || attr[10 + expected.size()] != '\"')
+            return false;
+    }
+
     tinyxml2::XMLDocument doc;
     const tinyxml2::XMLError error = doc.LoadFile(analyzerInfoFile.c_str());
     if (error != tinyxml2::XML_SUCCESS)
@@ -93,6 +310,7 @@ static bool skipAnalysis(const std::string &analyzerInfoFile, unsigned long long
             errors->emplace_back(e);
     }
 
+    markUsed(analyzerInfoFile);
     return true;
 }
 
@@ -126,36 +344,70 @@ std::string AnalyzerInformation::getAnalyzerInfoFile(const std::string &buildDir
     return filename;
 }
 
-bool AnalyzerInformation::analyzeFile(const std::string &buildDir, const std::string &sourcefile, const std::string &cfg, unsigned long long checksum, std::list<ErrorLogger::ErrorMessage> *errors)
+bool AnalyzerInformation::analyzeFile(const std::string &buildDir, const std::string &cacheDir, const std::string &sourcefile, const std::string &cfg, unsigned long long checksum, std::list<ErrorLogger::ErrorMessage> *errors)
 {
     if (buildDir.empty() || sourcefile.empty())
         return true;
     close();
 
     mAnalyzerInfoFile = AnalyzerInformation::getAnalyzerInfoFile(buildDir,sourcefile,cfg);
+    if (!cacheDir.empty())
+        mCacheFile = cacheDir + '/' + std::to_string(checksum) + ".analyzerinfo";
 
-    if (skipAnalysis(mAnalyzerInfoFile, checksum, errors))
+    bool recorded = false;
+    if (skipAnalysis(mAnalyzerInfoFile, checksum, errors, &recorded)) {
+        statistics.reused++;
+        mCacheFile.clear();
         return false;
+    }
 
-    mOutputStream.open(mAnalyzerInfoFile);
-    if (mOutputStream.is_open()) {
-        mOutputStream << "<?xml version=\"1.0\"?>\n";
-        mOutputStream << "<analyzerinfo checksum=\"" << checksum << "\">\n";
-    } else {
-        mAnalyzerInfoFile.clear();
+    // The shared cache is keyed by the checksum alone, so a TU with the same
+    // preprocessor output that was analyzed from another build dir - another
+    // branch, worktree or machine - is found there. A hit is copied into the
+    // build dir so whole program analysis and later runs see it locally.
+    if (!mCacheFile.empty() && skipAnalysis(mCacheFile, checksum, errors, nullptr)) {
+        copyAnalyzerInfoFile(mCacheFile, mAnalyzerInfoFile);
+        statistics.reused++;
+        statistics.cacheHits++;
+        mCacheFile.clear();
+        return false;
     }
 
+    if (recorded)
+        statistics.analyzedChanged++;
+    else
+        statistics.analyzedNew++;
+
+    mContent.str(std::string());
+    mOpen = true;
+    mContent << "<?xml version=\"1.0\"?>\n";
+    mContent << "<analyzerinfo checksum=\"" << checksum << "\">\n";
+
     return true;
 }
 
 void AnalyzerInformation::reportErr(const ErrorLogger::ErrorMessage &msg, bool /*verbose*/)
 {
-    if (mOutputStream.is_open())
-        mOutputStream << msg.toXML() << '\n';
+    if (mOpen)
+        mContent << msg.toXML() << '\n';
 }
 
 void AnalyzerInformation::setFileInfo(const std::string &check, const std::string &fileInfo)
 {
-    if (mOutputStream.is_open() && !fileInfo.empty())
-        mOutputStream << "  <FileInfo check=\"" << check << "\">\n" << fileInfo << "  </FileInfo>\n";
+    if (mOpen && !fileInfo.empty())
+        mContent << "  <FileInfo check=\"" << check << "\">\n" << fileInfo << "  </FileInfo>\n";
+}
+
+std::string AnalyzerInformation::statisticsString() const
+{
+    const unsigned int total = statistics.reused + statistics.analyzedNew + statistics.analyzedChanged;
+    if (total == 0)
+        return "";
+    std::ostringstream ostr;
+    ostr << "Analyzer information: " << statistics.reused << "/" << total << " file(s) reused";
+    if (statistics.cacheHits > 0)
+        ostr << " (" << statistics.cacheHits << " from the shared cache)";
+    ostr << ", " << statistics.analyzedNew << " analyzed for the first time, "
+         << statistics.analyzedChanged << " reanalyzed after source or settings changed";
+    return ostr.str();
 }
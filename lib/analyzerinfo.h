@@ -25,9 +25,12 @@
 #include "errorlogger.h"
 #include "importproject.h"
 
-#include <fstream>
+#include <condition_variable>
 #include <list>
+#include <mutex>
+#include <sstream>
 #include <string>
+#include <thread>
 
 /// @addtogroup Core
 /// @{
@@ -51,15 +54,82 @@ public:
 
     static void writeFilesTxt(const std::string &buildDir, const std::list<std::string> &sourcefiles, const std::list<ImportProject::FileSettings> &fileSettings);
 
-    /** Close current TU.analyzerinfo file */
+    /** Close current TU.analyzerinfo file and queue it for writing */
     void close();
-    bool analyzeFile(const std::string &buildDir, const std::string &sourcefile, const std::string &cfg, unsigned long long checksum, std::list<ErrorLogger::ErrorMessage> *errors);
+
+    /**
+     * Wait until the queued analyzer info files are written to disk.
+     * Must be called before the files are read back (whole program
+     * analysis) and before a worker process exits.
+     */
+    void flush();
+    bool analyzeFile(const std::string &buildDir, const std::string &cacheDir, const std::string &sourcefile, const std::string &cfg, unsigned long long checksum, std::list<ErrorLogger::ErrorMessage> *errors);
+
+    /** Cache effectiveness counters for this run, see statisticsString() */
+    struct Statistics {
+        unsigned int reused = 0;          /**< recorded results replayed without analysis */
+        unsigned int cacheHits = 0;       /**< of the reused results, found in the shared cache */
+        unsigned int analyzedNew = 0;     /**< analyzed, no results were recorded */
+        unsigned int analyzedChanged = 0; /**< analyzed, the source or the settings changed */
+    };
+    Statistics statistics;
+
+    /** One line summarizing the statistics, empty if no file was processed */
+    std::string statisticsString() const;
     void reportErr(const ErrorLogger::ErrorMessage &msg, bool verbose);
     void setFileInfo(const std::string &check, const std::string &fileInfo);
     static std::string getAnalyzerInfoFile(const std::string &buildDir, const std::string &sourcefile, const std::string &cfg);
+
+    /**
+     * Record the include closure of the TU with content hashes so the next
+     * run can detect an untouched TU without preprocessing it.
+     * @param toolinfo string describing the analysis settings, results are
+     *                 invalid if it changes
+     * @param sourcefiles the TU and all included files
+     */
+    void setFileHashes(const std::string &toolinfo, const std::list<std::string> &sourcefiles);
+
+    /**
+     * Quick check before preprocessing: is the include closure recorded in
+     * the analyzer info untouched? If so the stored results can be reused.
+     * @param analyzerInfoFile filename, see getAnalyzerInfoFile()
+     * @param toolinfo string describing the analysis settings, must match
+     *                 what was recorded by setFileHashes()
+     * @param errors output parameter, the stored error messages
+     * @return true if all recorded files have unchanged contents
+     */
+    static bool filesUnchanged(const std::string &analyzerInfoFile, const std::string &toolinfo, std::list<ErrorLogger::ErrorMessage> *errors);
 private:
-    std::ofstream mOutputStream;
+    /** One completed analyzer info file waiting to be written */
+    struct WriteJob {
+        std::string infoFile;
+        std::string cacheFile;
+        std::string content;
+    };
+
+    void enqueueWrite(const std::string &infoFile, const std::string &cacheFile, std::string content);
+    void writerThreadProc();
+
+    /** The analyzer info of the current TU. It is buffered and written on
+     * close() so serializing the XML to a slow (network) filesystem
+     * overlaps with the analysis of the next file instead of stalling the
+     * worker. */
+    std::ostringstream mContent;
+    bool mOpen = false;
     std::string mAnalyzerInfoFile;
+
+    /** Entry for the current TU in the shared cache (--cppcheck-cache-dir), keyed by checksum. Empty if no cache dir is used. */
+    std::string mCacheFile;
+
+    /** The writer thread, started lazily by the first queued file so an
+     * executor that forks worker processes never forks with it running */
+    std::thread mWriterThread;
+    std::mutex mWriteSync;
+    std::condition_variable mWriteCond;
+    std::list<WriteJob> mWriteQueue;
+    /** queued plus in progress writes, flush() waits until it is 0 */
+    unsigned int mPendingWrites = 0;
+    bool mShutdown = false;
 };
 
 /// @}
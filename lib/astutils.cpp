@@ -27,8 +27,11 @@
 #include "token.h"
 #include "valueflow.h"
 
+#include <algorithm>
 #include <list>
+#include <map>
 #include <stack>
+#include <unordered_map>
 
 
 void visitAstNodes(const Token *ast, std::function<ChildrenToVisit(const Token *)> visitor)
@@ -185,11 +188,21 @@ static bool hasToken(const Token * startTok, const Token * stopTok, const Token
     return false;
 }
 
+/** tok => nextAfterAstRightmostLeaf(tok). Keyed by token address, dropped
+ * by clearAstCaches() before tokens are deallocated. */
+static thread_local std::map<const Token *, const Token *> astExtentCache;
+
 const Token * nextAfterAstRightmostLeaf(const Token * tok)
 {
     const Token * rightmostLeaf = tok;
     if (!rightmostLeaf || !rightmostLeaf->astOperand1())
         return nullptr;
+    // The extent of an expression does not change while the AST exists, and
+    // FwdAnalysis and the value flow analysis query the same roots over and
+    // over again, so the result is memoized.
+    const std::map<const Token *, const Token *>::const_iterator it = astExtentCache.find(tok);
+    if (it != astExtentCache.end())
+        return it->second;
     do {
         if (rightmostLeaf->astOperand2())
             rightmostLeaf = rightmostLeaf->astOperand2();
@@ -200,6 +213,7 @@ const Token * nextAfterAstRightmostLeaf(const Token * tok)
         rightmostLeaf = rightmostLeaf->next();
     if (rightmostLeaf->str() == "{" && rightmostLeaf->link())
         rightmostLeaf = rightmostLeaf->link();
+    astExtentCache[tok] = rightmostLeaf->next();
     return rightmostLeaf->next();
 }
 
@@ -350,12 +364,69 @@ static void followVariableExpressionError(const Token *tok1, const Token *tok2,
     errors->push_back(item);
 }
 
-bool isSameExpression(bool cpp, bool macro, const Token *tok1, const Token *tok2, const Library& library, bool pure, bool followVar, ErrorPath* errors)
+namespace {
+    /** Memoized result of isSameExpression() for one token pair, with the
+     * error path items that were recorded while it was computed so they
+     * can be replayed on a cache hit. */
+    struct SameExpressionResult {
+        bool same;
+        ErrorPath errors;
+    };
+}
+
+/** (tok1,tok2,flags) => memoized isSameExpression() result. The keys are
+ * token addresses so the cache must be dropped with clearAstCaches() before
+ * tokens are deallocated. thread_local because the Windows threading model
+ * checks several files in one process. */
+static thread_local std::map<std::pair<std::pair<const Token *, const Token *>, int>, SameExpressionResult> sameExpressionCache;
+
+/** ftok => Library::isFunctionConst(ftok), same lifetime rules as
+ * sameExpressionCache. */
+static thread_local std::map<const Token *, bool> constFunctionCache;
+
+/** drop the change-point index of isVariableChanged(), defined next to it */
+static void clearVariableChangeCache();
+
+void clearAstCaches()
+{
+    astExtentCache.clear();
+    sameExpressionCache.clear();
+    constFunctionCache.clear();
+    clearVariableChangeCache();
+}
+
+static bool isFunctionConstCached(const Library &library, const Token *ftok)
+{
+    const std::map<const Token *, bool>::const_iterator it = constFunctionCache.find(ftok);
+    if (it != constFunctionCache.end())
+        return it->second;
+    const bool isconst = library.isFunctionConst(ftok);
+    constFunctionCache[ftok] = isconst;
+    return isconst;
+}
+
+/** Append the error path items of @p from to @p errors, skipping items that
+ * are already in the list like followVariableExpressionError() does. */
+static void mergeErrorPath(const ErrorPath &from, ErrorPath *errors)
+{
+    if (!errors)
+        return;
+    for (ErrorPath::const_iterator it = from.begin(); it != from.end(); ++it) {
+        if (std::find(errors->begin(), errors->end(), *it) == errors->end())
+            errors->push_back(*it);
+    }
+}
+
+static bool isSameExpressionInternal(bool cpp, bool macro, const Token *tok1, const Token *tok2, const Library& library, bool pure, bool followVar, ErrorPath* errors)
 {
     if (tok1 == nullptr && tok2 == nullptr)
         return true;
     if (tok1 == nullptr || tok2 == nullptr)
         return false;
+    // identical side-effect-free expressions share a nonzero expression id,
+    // see SymbolDatabase::createSymbolDatabaseExprIds
+    if (tok1->exprId() != 0 && tok1->exprId() == tok2->exprId())
+        return true;
     if (cpp) {
         if (tok1->str() == "." && tok1->astOperand1() && tok1->astOperand1()->str() == "this")
             tok1 = tok1->astOperand2();
@@ -370,24 +441,24 @@ bool isSameExpression(bool cpp, bool macro, const Token *tok1, const Token *tok2
         return isSameExpression(cpp, macro, tok1, tok2->astOperand1()->astOperand1(), library, pure, followVar, errors);
     }
     // Follow variable
-    if (followVar && tok1->str() != tok2->str() && (Token::Match(tok1, "%var%") || Token::Match(tok2, "%var%"))) {
+    if (followVar && !tok1->sameStr(tok2) && (Token::Match(tok1, "%var%") || Token::Match(tok2, "%var%"))) {
         const Token * varTok1 = followVariableExpression(tok1, cpp, tok2);
-        if (varTok1->str() == tok2->str()) {
+        if (varTok1->sameStr(tok2)) {
             followVariableExpressionError(tok1, varTok1, errors);
             return isSameExpression(cpp, macro, varTok1, tok2, library, true, followVar, errors);
         }
         const Token * varTok2 = followVariableExpression(tok2, cpp, tok1);
-        if (tok1->str() == varTok2->str()) {
+        if (tok1->sameStr(varTok2)) {
             followVariableExpressionError(tok2, varTok2, errors);
             return isSameExpression(cpp, macro, tok1, varTok2, library, true, followVar, errors);
         }
-        if (varTok1->str() == varTok2->str()) {
+        if (varTok1->sameStr(varTok2)) {
             followVariableExpressionError(tok1, varTok1, errors);
             followVariableExpressionError(tok2, varTok2, errors);
             return isSameExpression(cpp, macro, varTok1, varTok2, library, true, followVar, errors);
         }
     }
-    if (tok1->varId() != tok2->varId() || tok1->str() != tok2->str() || tok1->originalName() != tok2->originalName()) {
+    if (tok1->varId() != tok2->varId() || !tok1->sameStr(tok2) || tok1->originalName() != tok2->originalName()) {
         if ((Token::Match(tok1,"<|>")   && Token::Match(tok2,"<|>")) ||
             (Token::Match(tok1,"<=|>=") && Token::Match(tok2,"<=|>="))) {
             return isSameExpression(cpp, macro, tok1->astOperand1(), tok2->astOperand2(), library, pure, followVar, errors) &&
@@ -413,14 +484,14 @@ bool isSameExpression(bool cpp, bool macro, const Token *tok1, const Token *tok2
                     lhs = lhs->astOperand1();
                 const bool lhsIsConst = (lhs->variable() && lhs->variable()->isConst()) ||
                                         (lhs->valueType() && lhs->valueType()->constness > 0) ||
-                                        (Token::Match(lhs, "%var% . %name% (") && library.isFunctionConst(lhs->tokAt(2)));
+                                        (Token::Match(lhs, "%var% . %name% (") && isFunctionConstCached(library, lhs->tokAt(2)));
                 if (!lhsIsConst)
                     return false;
             } else {
                 const Token * ftok = tok1;
                 if (Token::simpleMatch(tok1->previous(), "::"))
                     ftok = tok1->previous();
-                if (!library.isFunctionConst(ftok) && !ftok->isAttributeConst() && !ftok->isAttributePure())
+                if (!isFunctionConstCached(library, ftok) && !ftok->isAttributeConst() && !ftok->isAttributePure())
                     return false;
             }
         } else {
@@ -444,7 +515,7 @@ bool isSameExpression(bool cpp, bool macro, const Token *tok1, const Token *tok2
         const Token *end1 = t1->link();
         const Token *end2 = t2->link();
         while (t1 && t2 && t1 != end1 && t2 != end2) {
-            if (t1->str() != t2->str())
+            if (!t1->sameStr(t2))
                 return false;
             t1 = t1->next();
             t2 = t2->next();
@@ -464,7 +535,7 @@ bool isSameExpression(bool cpp, bool macro, const Token *tok1, const Token *tok2
         const Token *t1 = tok1->next();
         const Token *t2 = tok2->next();
         while (t1 && t2 &&
-               t1->str() == t2->str() &&
+               t1->sameStr(t2) &&
                t1->isLong() == t2->isLong() &&
                t1->isUnsigned() == t2->isUnsigned() &&
                t1->isSigned() == t2->isSigned() &&
@@ -501,6 +572,35 @@ bool isSameExpression(bool cpp, bool macro, const Token *tok1, const Token *tok2
     return commutativeEquals;
 }
 
+bool isSameExpression(bool cpp, bool macro, const Token *tok1, const Token *tok2, const Library& library, bool pure, bool followVar, ErrorPath* errors)
+{
+    if (tok1 == nullptr || tok2 == nullptr)
+        return tok1 == tok2;
+    if (tok1->exprId() != 0 && tok1->exprId() == tok2->exprId())
+        return true;
+
+    // The same token pairs are compared over and over again when checks
+    // such as CheckOther::checkDuplicateExpression walk the token pairs of
+    // a scope, so the result is memoized. The 'cpp' flag is not part of the
+    // key since it is fixed for the whole token list.
+    const std::pair<std::pair<const Token *, const Token *>, int> key(
+        std::make_pair(tok1, tok2),
+        (macro ? 0x1 : 0) | (pure ? 0x2 : 0) | (followVar ? 0x4 : 0) | (errors ? 0x8 : 0));
+    const std::map<std::pair<std::pair<const Token *, const Token *>, int>, SameExpressionResult>::const_iterator it = sameExpressionCache.find(key);
+    if (it != sameExpressionCache.end()) {
+        mergeErrorPath(it->second.errors, errors);
+        return it->second.same;
+    }
+
+    ErrorPath localErrors;
+    const bool same = isSameExpressionInternal(cpp, macro, tok1, tok2, library, pure, followVar, errors ? &localErrors : nullptr);
+    SameExpressionResult &entry = sameExpressionCache[key];
+    entry.same = same;
+    entry.errors = localErrors;
+    mergeErrorPath(localErrors, errors);
+    return same;
+}
+
 bool isEqualKnownValue(const Token * const tok1, const Token * const tok2)
 {
     return tok1->hasKnownValue() && tok2->hasKnownValue() && tok1->values() == tok2->values();
@@ -900,56 +1000,144 @@ bool isVariableChangedByFunctionCall(const Token *tok, const Settings *settings,
     return arg && !arg->isConst() && arg->isReference();
 }
 
-bool isVariableChanged(const Token *start, const Token *end, const unsigned int varid, bool globalvar, const Settings *settings, bool cpp)
+/** May this occurrence of a variable change the variable? The per-token
+ * predicate behind isVariableChanged(); it only looks at the token itself,
+ * never at which variable id the caller asked about. */
+static bool isVariableChangedAt(const Token *tok, const Settings *settings, bool cpp)
 {
-    for (const Token *tok = start; tok != end; tok = tok->next()) {
-        if (tok->varId() != varid) {
-            if (globalvar && Token::Match(tok, "%name% ("))
-                // TODO: Is global variable really changed by function call?
-                return true;
-            continue;
+    if (Token::Match(tok, "%name% %assign%|++|--"))
+        return true;
+
+    if (Token::Match(tok->previous(), "++|-- %name%"))
+        return true;
+
+    if (isLikelyStreamRead(cpp, tok->previous()))
+        return true;
+
+    // Member function call
+    if (Token::Match(tok, "%name% . %name% (")) {
+        const Variable * var = tok->variable();
+        bool isConst = var && var->isConst();
+        if (!isConst && var) {
+            const ValueType * valueType = var->valueType();
+            isConst = (valueType && valueType->pointer == 1 && valueType->constness == 1);
         }
 
-        if (Token::Match(tok, "%name% %assign%|++|--"))
+        const Token *ftok = tok->tokAt(2);
+        const Function * fun = ftok->function();
+        if (!isConst && (!fun || !fun->isConst()))
             return true;
+    }
 
-        if (Token::Match(tok->previous(), "++|-- %name%"))
-            return true;
+    const Token *ftok = tok;
+    while (ftok && !Token::Match(ftok, "[({[]"))
+        ftok = ftok->astParent();
 
-        if (isLikelyStreamRead(cpp, tok->previous()))
+    if (ftok && Token::Match(ftok->link(), ") !!{")) {
+        bool inconclusive = false;
+        bool isChanged = isVariableChangedByFunctionCall(tok, settings, &inconclusive);
+        isChanged |= inconclusive;
+        if (isChanged)
             return true;
+    }
 
-        // Member function call
-        if (Token::Match(tok, "%name% . %name% (")) {
-            const Variable * var = tok->variable();
-            bool isConst = var && var->isConst();
-            if (!isConst && var) {
-                const ValueType * valueType = var->valueType();
-                isConst = (valueType && valueType->pointer == 1 && valueType->constness == 1);
-            }
+    const Token *parent = tok->astParent();
+    while (Token::Match(parent, ".|::"))
+        parent = parent->astParent();
+    if (parent && parent->tokType() == Token::eIncDecOp)
+        return true;
 
-            const Token *ftok = tok->tokAt(2);
-            const Function * fun = ftok->function();
-            if (!isConst && (!fun || !fun->isConst()))
-                return true;
-        }
+    return false;
+}
+
+namespace {
+    /** Change-point index for one function body: for each variable id the
+     * body offsets where isVariableChangedAt() holds, plus the offsets of
+     * the function calls for the global variable bailout. Range queries in
+     * isVariableChanged() become binary searches in the sorted offsets
+     * instead of token walks over the range. */
+    struct VariableChangeIndex {
+        /** body offset of every token between bodyStart and bodyEnd */
+        std::unordered_map<const Token *, unsigned int> position;
+        /** varId => sorted offsets of the possible changes */
+        std::unordered_map<unsigned int, std::vector<unsigned int> > changePoints;
+        /** (offset, varId of the name token) of each "%name% (" call */
+        std::vector<std::pair<unsigned int, unsigned int> > calls;
+    };
+}
 
-        const Token *ftok = tok;
-        while (ftok && !Token::Match(ftok, "[({[]"))
-            ftok = ftok->astParent();
+/** (function body start, settings) => change-point index. The predicate
+ * behind the index depends on the settings and some callers pass none, so
+ * the settings pointer is part of the key. The keys are token addresses,
+ * the cache is dropped by clearAstCaches() before tokens are deallocated. */
+static thread_local std::map<std::pair<const Token *, const Settings *>, VariableChangeIndex> variableChangeCache;
 
-        if (ftok && Token::Match(ftok->link(), ") !!{")) {
-            bool inconclusive = false;
-            bool isChanged = isVariableChangedByFunctionCall(tok, settings, &inconclusive);
-            isChanged |= inconclusive;
-            if (isChanged)
+static void clearVariableChangeCache()
+{
+    variableChangeCache.clear();
+}
+
+static const VariableChangeIndex &variableChangeIndex(const Scope *scope, const Settings *settings, bool cpp)
+{
+    VariableChangeIndex &index = variableChangeCache[std::make_pair(scope->bodyStart, settings)];
+    if (!index.position.empty())
+        return index;
+    unsigned int pos = 0;
+    for (const Token *tok = scope->bodyStart; tok; tok = tok->next()) {
+        index.position[tok] = pos;
+        if (Token::Match(tok, "%name% ("))
+            index.calls.push_back(std::make_pair(pos, tok->varId()));
+        if (tok->varId() != 0 && isVariableChangedAt(tok, settings, cpp))
+            index.changePoints[tok->varId()].push_back(pos);
+        if (tok == scope->bodyEnd)
+            break;
+        ++pos;
+    }
+    return index;
+}
+
+bool isVariableChanged(const Token *start, const Token *end, const unsigned int varid, bool globalvar, const Settings *settings, bool cpp)
+{
+    // when the whole range is inside one function body, overlapping queries
+    // share the change-point index of the function
+    const Scope *scope = start ? start->scope() : nullptr;
+    while (scope && scope->isExecutable() && scope->nestedIn && scope->nestedIn->isExecutable())
+        scope = scope->nestedIn;
+    if (end && scope && scope->isExecutable() && scope->bodyStart && scope->bodyEnd) {
+        const VariableChangeIndex &index = variableChangeIndex(scope, settings, cpp);
+        const std::unordered_map<const Token *, unsigned int>::const_iterator startIt = index.position.find(start);
+        const std::unordered_map<const Token *, unsigned int>::const_iterator endIt = index.position.find(end);
+        if (startIt != index.position.end() && endIt != index.position.end() && startIt->second <= endIt->second) {
+            const unsigned int first = startIt->second;
+            const unsigned int last = endIt->second; // the range is [first, last)
+            if (globalvar) {
+                std::vector<std::pair<unsigned int, unsigned int> >::const_iterator call =
+                    std::lower_bound(index.calls.begin(), index.calls.end(), std::make_pair(first, 0U));
+                for (; call != index.calls.end() && call->first < last; ++call) {
+                    // TODO: Is global variable really changed by function call?
+                    if (call->second != varid)
+                        return true;
+                }
+            }
+            const std::unordered_map<unsigned int, std::vector<unsigned int> >::const_iterator cp = index.changePoints.find(varid);
+            if (cp != index.changePoints.end()) {
+                const std::vector<unsigned int>::const_iterator it = std::lower_bound(cp->second.begin(), cp->second.end(), first);
+                if (it != cp->second.end() && *it < last)
+                    return true;
+            }
+            return false;
+        }
+    }
+
+    for (const Token *tok = start; tok != end; tok = tok->next()) {
+        if (tok->varId() != varid) {
+            if (globalvar && Token::Match(tok, "%name% ("))
+                // TODO: Is global variable really changed by function call?
                 return true;
+            continue;
         }
 
-        const Token *parent = tok->astParent();
-        while (Token::Match(parent, ".|::"))
-            parent = parent->astParent();
-        if (parent && parent->tokType() == Token::eIncDecOp)
+        if (isVariableChangedAt(tok, settings, cpp))
             return true;
     }
     return false;
@@ -1027,11 +1215,11 @@ bool isLikelyStreamRead(bool cpp, const Token *op)
     if (!Token::Match(op, "&|>>") || !op->isBinaryOp())
         return false;
 
-    if (!Token::Match(op->astOperand2(), "%name%|.|*|[") && op->str() != op->astOperand2()->str())
+    if (!Token::Match(op->astOperand2(), "%name%|.|*|[") && !op->sameStr(op->astOperand2()))
         return false;
 
     const Token *parent = op;
-    while (parent->astParent() && parent->astParent()->str() == op->str())
+    while (parent->astParent() && parent->astParent()->sameStr(op))
         parent = parent->astParent();
     if (parent->astParent() && !Token::Match(parent->astParent(), "%oror%|&&|(|,|!"))
         return false;
@@ -1409,6 +1597,22 @@ bool FwdAnalysis::possiblyAliased(const Token *expr, const Token *startToken) co
     if (expr->isUnaryOp("*"))
         return true;
 
+    // If no alias of the expression variables is created anywhere in the
+    // function then the backward scan can be skipped
+    if (mDefUse) {
+        bool maybeAliased = false;
+        visitAstNodes(expr, [&](const Token *tok) {
+            // unknown name => the summary cannot vouch for it
+            if (tok->isName() && tok->varId() == 0 && tok->previous()->str() != ".")
+                maybeAliased = true;
+            else if (tok->varId() > 0 && mDefUse->addressTaken(tok->varId()))
+                maybeAliased = true;
+            return maybeAliased ? ChildrenToVisit::done : ChildrenToVisit::op1_and_op2;
+        });
+        if (!maybeAliased)
+            return false;
+    }
+
     const bool macro = false;
     const bool pure = false;
     const bool followVar = false;
@@ -1458,3 +1662,90 @@ bool FwdAnalysis::isNullOperand(const Token *expr)
         return true;
     return Token::Match(expr, "NULL|nullptr");
 }
+
+namespace {
+    // Does writing through an ancestor expression possibly write the variable?
+    bool isPossibleWriteAccess(const Token *vartok, bool cpp)
+    {
+        // climb member access / array index, the variable stays the written object
+        const Token *child = vartok;
+        const Token *parent = vartok->astParent();
+        while (parent && (parent->str() == "." || parent->str() == "[")) {
+            child = parent;
+            parent = parent->astParent();
+        }
+        if (!parent)
+            return false;
+        if (parent->isAssignmentOp() && parent->astOperand1() == child)
+            return true;
+        if (parent->tokType() == Token::eIncDecOp)
+            return true;
+        // address taken somewhere in the expression => anything can happen
+        for (const Token *tok = parent; tok; tok = tok->astParent()) {
+            if (tok->isUnaryOp("&"))
+                return true;
+            // function call argument: the function may write through a
+            // pointer or (C++) reference parameter
+            if (tok->str() == "(" && tok->previous() && tok->previous()->isName())
+                return true;
+        }
+        // stream read 'cin >> x' and similar overloaded operators
+        if (isLikelyStreamRead(cpp, parent))
+            return true;
+        return false;
+    }
+}
+
+namespace {
+    // Collect the varIds occurring in the expression into the given set
+    void collectVarIds(const Token *expr, std::set<unsigned int> &varIds)
+    {
+        visitAstNodes(expr, [&](const Token *tok) {
+            if (tok->varId() > 0)
+                varIds.insert(tok->varId());
+            return ChildrenToVisit::op1_and_op2;
+        });
+    }
+}
+
+DefUseIndex::DefUseIndex(const Scope *functionScope)
+{
+    if (!functionScope || !functionScope->bodyStart)
+        return;
+    const bool cpp = functionScope->check && functionScope->check->isCPP();
+    for (const Token *tok = functionScope->bodyStart; tok != functionScope->bodyEnd; tok = tok->next()) {
+        // alias summary, matching the sites FwdAnalysis::possiblyAliased scans for
+        if (tok->isUnaryOp("&"))
+            collectVarIds(tok->astOperand1(), mAliased);
+        else if (Token::Match(tok, "& %name% ="))
+            collectVarIds(tok->tokAt(2)->astOperand2(), mAliased);
+        else if (Token::simpleMatch(tok, "std :: ref ("))
+            collectVarIds(tok->tokAt(3)->astOperand2(), mAliased);
+        else if (Token::Match(tok, "%name% (") && !Token::Match(tok, "if|while|for|switch")) {
+            for (const Token *arg : getArguments(tok))
+                collectVarIds(arg, mAliased);
+        }
+
+        if (tok->varId() == 0)
+            continue;
+        const Access access = { tok, isPossibleWriteAccess(tok, cpp) };
+        mAccesses[tok->varId()].push_back(access);
+    }
+}
+
+const std::vector<DefUseIndex::Access> &DefUseIndex::accesses(unsigned int varId) const
+{
+    static const std::vector<Access> emptyAccesses;
+    const std::unordered_map<unsigned int, std::vector<Access> >::const_iterator it = mAccesses.find(varId);
+    return (it != mAccesses.end()) ? it->second : emptyAccesses;
+}
+
+std::size_t DefUseIndex::writeCount(unsigned int varId) const
+{
+    std::size_t result = 0;
+    for (const Access &access : accesses(varId)) {
+        if (access.write)
+            ++result;
+    }
+    return result;
+}
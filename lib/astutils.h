@@ -22,13 +22,17 @@
 #define astutilsH
 //---------------------------------------------------------------------------
 
+#include <cstddef>
 #include <functional>
+#include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "errorlogger.h"
 
 class Library;
+class Scope;
 class Settings;
 class Token;
 class Variable;
@@ -83,6 +87,10 @@ bool precedes(const Token * tok1, const Token * tok2);
 
 bool isSameExpression(bool cpp, bool macro, const Token *tok1, const Token *tok2, const Library& library, bool pure, bool followVar, ErrorPath* errors=nullptr);
 
+/** Drop the memoized isSameExpression() results. Must be called before
+ * tokens are deallocated since the caches are keyed by token addresses. */
+void clearAstCaches();
+
 bool isEqualKnownValue(const Token * const tok1, const Token * const tok2);
 
 bool isDifferentKnownValues(const Token * const tok1, const Token * const tok2);
@@ -170,9 +178,15 @@ bool isConstVarExpression(const Token *tok);
  *  - redundant assignment
  *  - valueflow analysis
  */
+class DefUseIndex;
+
 class FwdAnalysis {
 public:
-    FwdAnalysis(bool cpp, const Library &library) : mCpp(cpp), mLibrary(library), mWhat(What::Reassign), mValueFlowKnown(true) {}
+    /** The optional def-use index must be built for the function scope that
+     * contains the analyzed tokens. When given, possiblyAliased() can skip
+     * its backward scan for expressions whose variables are never aliased
+     * anywhere in the function. */
+    FwdAnalysis(bool cpp, const Library &library, const DefUseIndex *defUse = nullptr) : mCpp(cpp), mLibrary(library), mDefUse(defUse), mWhat(What::Reassign), mValueFlowKnown(true) {}
 
     bool hasOperand(const Token *tok, const Token *lhs) const;
 
@@ -222,9 +236,50 @@ private:
 
     const bool mCpp;
     const Library &mLibrary;
+    const DefUseIndex *mDefUse;
     enum class What { Reassign, UnusedValue, ValueFlow } mWhat;
     std::vector<KnownAndToken> mValueFlow;
     bool mValueFlowKnown;
 };
 
+/**
+ * Def-use index for one function: for each varId used in the function
+ * body, the tokens that access the variable in body order, classified as
+ * read or (possible) write. Built with a single walk so checks that would
+ * otherwise rescan the function per variable can query it instead.
+ *
+ * The write classification is deliberately an over-approximation: taking
+ * the address of a variable, passing it to a function or reading it from
+ * a stream all count as writes. Consumers may therefore use writeCount()
+ * to skip work when there are not enough writes for a finding, but not to
+ * conclude that a write certainly happens.
+ */
+class DefUseIndex {
+public:
+    explicit DefUseIndex(const Scope *functionScope);
+
+    struct Access {
+        const Token *tok;
+        bool write;
+    };
+
+    /** accesses of the variable in body order, empty if the varId does not occur */
+    const std::vector<Access> &accesses(unsigned int varId) const;
+
+    /** number of possible writes to the variable inside the function */
+    std::size_t writeCount(unsigned int varId) const;
+
+    /** is an alias of the variable possibly created somewhere in the
+     * function: address taken, bound to a reference, passed to std::ref or
+     * used in a function call argument. Over-approximated, so 'false' means
+     * the variable is certainly never aliased. */
+    bool addressTaken(unsigned int varId) const {
+        return mAliased.find(varId) != mAliased.end();
+    }
+
+private:
+    std::unordered_map<unsigned int, std::vector<Access> > mAccesses;
+    std::set<unsigned int> mAliased;
+};
+
 #endif // astutilsH
@@ -19,21 +19,25 @@
 //---------------------------------------------------------------------------
 
 #include "check.h"
+#include "symboldatabase.h"
+#include "timer.h"
 
 #include <iostream>
+#include <set>
 
 //---------------------------------------------------------------------------
 
 Check::Check(const std::string &aname)
     : mTokenizer(nullptr), mSettings(nullptr), mErrorLogger(nullptr), mName(aname)
 {
-    for (std::list<Check*>::iterator i = instances().begin(); i != instances().end(); ++i) {
+    std::list<Check*> &registry = registrationList();
+    for (std::list<Check*>::iterator i = registry.begin(); i != registry.end(); ++i) {
         if ((*i)->name() > aname) {
-            instances().insert(i, this);
+            registry.insert(i, this);
             return;
         }
     }
-    instances().push_back(this);
+    registry.push_back(this);
 }
 
 void Check::reportError(const ErrorLogger::ErrorMessage &errmsg)
@@ -54,7 +58,122 @@ bool Check::wrongData(const Token *tok, bool condition, const char *str)
     return condition;
 }
 
-std::list<Check *> &Check::instances()
+// Sub-check accounting state. thread_local because the Windows executor
+// runs several files in threads of one process.
+static TimerResultsIntf *subCheckTimerResults = nullptr;
+static thread_local std::set<std::string> overrunSubChecks;
+
+void Check::SubCheck::setTimerResults(TimerResultsIntf *timerResults)
+{
+    subCheckTimerResults = timerResults;
+}
+
+Check::SubCheck::SubCheck(Check *check, const char id[])
+    : mCheck(check)
+    , mId(check->name() + "::" + id)
+    , mStart(0)
+    , mTimed(false)
+    , mEnabled(true)
+{
+    const Settings * const settings = check->mSettings;
+    if (!settings)
+        return;
+    if (settings->subCheckBudgetMs > 0 && overrunSubChecks.find(mId) != overrunSubChecks.end()) {
+        mEnabled = false;
+        return;
+    }
+    if (settings->subCheckBudgetMs > 0 || settings->showtime != SHOWTIME_NONE) {
+        mTimed = true;
+        mStart = std::clock();
+    }
+}
+
+Check::SubCheck::~SubCheck()
+{
+    if (!mEnabled || !mTimed)
+        return;
+    const std::clock_t diff = std::clock() - mStart;
+    const Settings * const settings = mCheck->mSettings;
+    if (settings->showtime != SHOWTIME_NONE && subCheckTimerResults)
+        subCheckTimerResults->AddResults(mId, diff);
+    if (settings->subCheckBudgetMs > 0 &&
+        (unsigned long)diff * 1000UL > (unsigned long)settings->subCheckBudgetMs * (unsigned long)CLOCKS_PER_SEC) {
+        overrunSubChecks.insert(mId);
+        mCheck->reportError(nullptr, Severity::information, "subCheckBudgetExceeded",
+                            mId + " exceeded the time budget given by --sub-check-budget and is skipped from now on.");
+    }
+}
+
+// Fused token traversal state. thread_local because the Windows executor
+// runs several files in threads of one process.
+static thread_local bool fusedWalkIsActive = false;
+static thread_local std::list<Check *> *fusedInstances = nullptr;
+
+bool Check::fusedWalkActive()
+{
+    return fusedWalkIsActive;
+}
+
+void Check::startFusedWalk()
+{
+    fusedWalkIsActive = true;
+}
+
+void Check::queueFusedInstance(Check *instance)
+{
+    if (!fusedInstances)
+        fusedInstances = new std::list<Check *>;
+    fusedInstances->push_back(instance);
+}
+
+void Check::runFusedWalk(const Tokenizer *tokenizer)
+{
+    fusedWalkIsActive = false;
+    if (!fusedInstances)
+        return;
+    for (const Token *tok = tokenizer->tokens(); tok; tok = tok->next()) {
+        for (Check *instance : *fusedInstances)
+            instance->fusedToken(tok);
+    }
+    for (Check *instance : *fusedInstances)
+        delete instance;
+    delete fusedInstances;
+    fusedInstances = nullptr;
+}
+
+// Functions whose cached results were replayed by the per-function result
+// cache. thread_local for the same reason as the fused walk state.
+static thread_local std::set<const Scope *> replayedFunctionScopes;
+
+bool Check::functionResultsReplayed(const Scope *scope)
+{
+    if (replayedFunctionScopes.empty())
+        return false;
+    // the cache tracks top level functions; any scope inside the body maps
+    // to the outermost executable scope
+    const Scope *outermost = nullptr;
+    for (const Scope *s = scope; s && s->isExecutable(); s = s->nestedIn)
+        outermost = s;
+    return outermost && replayedFunctionScopes.find(outermost) != replayedFunctionScopes.end();
+}
+
+void Check::setReplayedFunctionScopes(const std::set<const Scope *> &scopes)
+{
+    replayedFunctionScopes = scopes;
+}
+
+void Check::cancelFusedWalk()
+{
+    fusedWalkIsActive = false;
+    if (!fusedInstances)
+        return;
+    for (Check *instance : *fusedInstances)
+        delete instance;
+    delete fusedInstances;
+    fusedInstances = nullptr;
+}
+
+std::list<Check *> &Check::registrationList()
 {
 #ifdef __SVR4
     // Under Solaris, destructors are called in wrong order which causes a segmentation fault.
@@ -66,3 +185,8 @@ std::list<Check *> &Check::instances()
     return _instances;
 #endif
 }
+
+const std::list<Check *> &Check::instances()
+{
+    return registrationList();
+}
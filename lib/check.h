@@ -28,7 +28,9 @@
 #include "tokenize.h"
 #include "valueflow.h"
 
+#include <ctime>
 #include <list>
+#include <set>
 #include <string>
 
 namespace tinyxml2 {
@@ -39,6 +41,9 @@ namespace CTU {
     class FileInfo;
 }
 
+class Scope;
+class TimerResultsIntf;
+
 /** Use WRONG_DATA in checkers to mark conditions that check that data is correct */
 #define WRONG_DATA(COND, TOK)  (wrongData((TOK), (COND), #COND))
 
@@ -61,19 +66,109 @@ public:
 
     virtual ~Check() {
         if (!mTokenizer)
-            instances().remove(this);
+            registrationList().remove(this);
     }
 
-    /** List of registered check classes. This is used by Cppcheck to run checks and generate documentation */
-    static std::list<Check *> &instances();
+    /**
+     * The registry of check classes, used by Cppcheck to run the checks
+     * and to generate documentation. The checks register themselves when
+     * their file scope instances are constructed at program init; after
+     * that the registry is immutable, so any number of threads can
+     * iterate it without locking.
+     */
+    static const std::list<Check *> &instances();
+
+    /**
+     * Create an instance of this check bound to one translation unit.
+     * The registered instances form a registry that is shared by all
+     * threads; a thread runs the checks on its own bound instances
+     * created through this factory, so no check state is shared between
+     * the threads of an in-process executor.
+     */
+    virtual Check *createInstance(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) const = 0;
 
     /** run checks, the token list is not simplified */
     virtual void runChecks(const Tokenizer *, const Settings *, ErrorLogger *) {
     }
 
+    /**
+     * @name Fused token traversal
+     * Checks whose passes are plain per-token walks can share a single
+     * walk over the token list instead of each walking it themselves.
+     * When CppCheck::checkNormalTokens() drives the checks it activates
+     * the scheduler; a participating runChecks() implementation then
+     * queues a bound check instance with queueFusedInstance() and the
+     * queued instances get their fusedToken() called once per token by
+     * one shared walk. When runChecks() is called directly (unit tests),
+     * the scheduler is inactive and the check does its own single walk,
+     * so the results are the same either way.
+     */
+    /** @{ */
+    /** is the fused traversal collecting instances? */
+    static bool fusedWalkActive();
+
+    /** activate the fused traversal, instances can be queued until runFusedWalk() */
+    static void startFusedWalk();
+
+    /** queue a check instance for the fused traversal, takes ownership */
+    static void queueFusedInstance(Check *instance);
+
+    /** walk the token list once, dispatching to all queued instances, and deactivate */
+    static void runFusedWalk(const Tokenizer *tokenizer);
+
+    /** discard queued instances without running them, and deactivate */
+    static void cancelFusedWalk();
+
+    /** called once for each token by the fused traversal, in list order */
+    virtual void fusedToken(const Token *) {
+    }
+    /** @} */
+
+    /**
+     * @name Per-function result cache
+     * When a file is rechecked with --cppcheck-build-dir, the findings of
+     * functions whose body and call graph neighbourhood are unchanged are
+     * replayed from the per-function cache before the checks run, see
+     * CppCheck::loadFunctionCache(). A pass whose analysis is strictly
+     * function local can then skip such a function; passes that look
+     * across functions must not.
+     */
+    /** @{ */
+    /** did an incremental run replay the cached results of this function?
+     * Any scope inside the function body can be passed. */
+    static bool functionResultsReplayed(const Scope *scope);
+
+    /** set by CppCheck before the checks run, cleared afterwards */
+    static void setReplayedFunctionScopes(const std::set<const Scope *> &scopes);
+    /** @} */
+
     /** run checks, the token list is simplified */
     virtual void runSimplifiedChecks(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) = 0;
 
+    /**
+     * Would runSimplifiedChecks() do anything for this file? The simplified
+     * token list is built lazily: when no registered check reports interest,
+     * CppCheck skips the second simplification stage altogether. Classes
+     * whose runSimplifiedChecks() is empty or guarded by an early return
+     * mirror that guard here; the conservative default is to ask for the
+     * simplified tokens.
+     */
+    virtual bool hasSimplifiedChecks(const Tokenizer *tokenizer, const Settings *settings) const {
+        (void)tokenizer;
+        (void)settings;
+        return true;
+    }
+
+    /**
+     * Identifier that must occur somewhere in the raw source for this check
+     * to possibly produce a finding, or nullptr when the check always has to
+     * run. CppCheck probes the raw tokens once per file and skips checks
+     * whose trigger identifier cannot match.
+     */
+    virtual const char *triggerIdentifier() const {
+        return nullptr;
+    }
+
     /** get error messages */
     virtual void getErrorMessages(ErrorLogger *errorLogger, const Settings *settings) const = 0;
 
@@ -92,6 +187,42 @@ public:
      */
     static void reportError(const ErrorLogger::ErrorMessage &errmsg);
 
+    /**
+     * RAII wall-time accounting for one sub-check. Feeds --showtime with
+     * "<check>::<sub-check>" granularity and enforces --sub-check-budget:
+     * a sub-check that overruns the budget on some file is reported with
+     * an information message and skipped for the files that follow in the
+     * same process. Usage, at the top of a sub-check function:
+     * \code
+     * SubCheck subCheck(this, "checkSomething");
+     * if (!subCheck.enabled())
+     *     return;
+     * \endcode
+     */
+    class CPPCHECKLIB SubCheck {
+    public:
+        SubCheck(Check *check, const char id[]);
+        ~SubCheck();
+
+        /** false when the sub-check overran its budget earlier and should not run */
+        bool enabled() const {
+            return mEnabled;
+        }
+
+        /** set the sink for the per-sub-check times shown by --showtime */
+        static void setTimerResults(TimerResultsIntf *timerResults);
+
+    private:
+        SubCheck(const SubCheck &) = delete;
+        void operator=(const SubCheck &) = delete;
+
+        Check * const mCheck;
+        const std::string mId;
+        std::clock_t mStart;
+        bool mTimed;
+        bool mEnabled;
+    };
+
     /** Base class used for whole-program analysis */
     class CPPCHECKLIB FileInfo {
     public:
@@ -187,6 +318,10 @@ protected:
      */
     bool wrongData(const Token *tok, bool condition, const char *str);
 private:
+    /** The mutable list behind instances(). Only the registration
+     * constructor and the destructor touch it, both at program init/exit. */
+    static std::list<Check *> &registrationList();
+
     const std::string mName;
 
     /** disabled assignment operator and copy constructor */
@@ -51,6 +51,11 @@ public:
         : Check(myName(), tokenizer, settings, errorLogger) {
     }
 
+    /** @brief Create a bound instance, see Check::createInstance() */
+    Check *createInstance(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) const OVERRIDE {
+        return new Check64BitPortability(tokenizer, settings, errorLogger);
+    }
+
     /** @brief Run checks against the normal token list */
     void runChecks(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) OVERRIDE {
         Check64BitPortability check64BitPortability(tokenizer, settings, errorLogger);
@@ -64,6 +69,10 @@ public:
         (void)errorLogger;
     }
 
+    bool hasSimplifiedChecks(const Tokenizer * /*tokenizer*/, const Settings * /*settings*/) const OVERRIDE {
+        return false;
+    }
+
     /** Check for pointer assignment */
     void pointerassignment();
 
@@ -49,6 +49,11 @@ public:
         : Check(myName(), tokenizer, settings, errorLogger) {
     }
 
+    /** @brief Create a bound instance, see Check::createInstance() */
+    Check *createInstance(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) const OVERRIDE {
+        return new CheckAssert(tokenizer, settings, errorLogger);
+    }
+
     virtual void runSimplifiedChecks(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) OVERRIDE {
         CheckAssert check(tokenizer, settings, errorLogger);
         check.assertWithSideEffects();
@@ -49,6 +49,11 @@ public:
         : Check(myName(), tokenizer, settings, errorLogger) {
     }
 
+    /** @brief Create a bound instance, see Check::createInstance() */
+    Check *createInstance(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) const OVERRIDE {
+        return new CheckBool(tokenizer, settings, errorLogger);
+    }
+
     /** @brief Run checks against the normal token list */
     void runChecks(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) OVERRIDE {
         CheckBool checkBool(tokenizer, settings, errorLogger);
@@ -48,6 +48,11 @@ public:
         : Check(myName(), tokenizer, settings, errorLogger) {
     }
 
+    /** @brief Create a bound instance, see Check::createInstance() */
+    Check *createInstance(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) const OVERRIDE {
+        return new CheckBoost(tokenizer, settings, errorLogger);
+    }
+
     /** Simplified checks. The token list is simplified. */
     void runSimplifiedChecks(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) OVERRIDE {
         if (!tokenizer->isCPP())
@@ -58,6 +63,15 @@ public:
         checkBoost.checkBoostForeachModification();
     }
 
+    bool hasSimplifiedChecks(const Tokenizer *tokenizer, const Settings * /*settings*/) const OVERRIDE {
+        return tokenizer->isCPP();
+    }
+
+    /** The check can only fire when BOOST_FOREACH occurs in the source */
+    const char *triggerIdentifier() const OVERRIDE {
+        return "BOOST_FOREACH";
+    }
+
     /** @brief %Check for container modification while using the BOOST_FOREACH macro */
     void checkBoostForeachModification();
 
@@ -895,22 +895,69 @@ void CheckBufferOverrun::valueFlowCheckArrayIndex(const Token * const tok, const
 
 
 
+void CheckBufferOverrun::fillArrayIndexes()
+{
+    if (mArrayIndexesFilled)
+        return;
+    mArrayIndexesFilled = true;
+
+    for (const Token *tok = mTokenizer->tokens(); tok; tok = tok->next()) {
+        if (tok->varId() != 0)
+            mVarIdUses[tok->varId()].push_back(tok);
+    }
+
+    const SymbolDatabase *symbolDatabase = mTokenizer->getSymbolDatabase();
+    for (std::size_t varId = 1; varId < symbolDatabase->variableList().size(); varId++) {
+        const Variable *var = symbolDatabase->getVariableFromVarId(varId);
+        if (var && var->isArray() && var->typeStartToken() && var->typeEndToken())
+            mArrayInfoByVarId.insert(std::make_pair(static_cast<unsigned int>(varId), ArrayInfo(var, symbolDatabase)));
+    }
+}
+
+const CheckBufferOverrun::ArrayInfo *CheckBufferOverrun::arrayInfoByVarId(unsigned int varId)
+{
+    fillArrayIndexes();
+    const std::map<unsigned int, ArrayInfo>::const_iterator it = mArrayInfoByVarId.find(varId);
+    return (it != mArrayInfoByVarId.end()) ? &it->second : nullptr;
+}
+
+const std::vector<const Token *> &CheckBufferOverrun::varIdUses(unsigned int varId)
+{
+    fillArrayIndexes();
+    static const std::vector<const Token *> emptyUses;
+    const std::map<unsigned int, std::vector<const Token *> >::const_iterator it = mVarIdUses.find(varId);
+    return (it != mVarIdUses.end()) ? it->second : emptyUses;
+}
+
 void CheckBufferOverrun::checkScope(const Token *tok, const ArrayInfo &arrayInfo)
 {
-    bool reassigned = false;
+    // Visit only the tokens that actually use the array instead of walking
+    // the whole scope for each array.
+    const std::vector<const Token *> &uses = varIdUses(arrayInfo.declarationId());
+    if (uses.empty())
+        return;
 
-    for (const Token* const end = tok->scope()->bodyEnd; tok != end; tok = tok->next()) {
-        if (reassigned && tok->str() == ";")
-            break;
+    const Token * const end = tok->scope()->bodyEnd;
+    std::vector<const Token *>::const_iterator it =
+        std::lower_bound(uses.begin(), uses.end(), tok->progressValue(),
+    [](const Token *use, unsigned int progressValue) {
+        return use->progressValue() < progressValue;
+    });
 
-        if (tok->varId() != arrayInfo.declarationId())
-            continue;
+    // ';' ending the statement that reassigns the array - don't check beyond it
+    const Token *reassignEnd = nullptr;
 
-        if (tok->strAt(1) == "=") {
-            reassigned = true;
-        }
+    for (; it != uses.end(); ++it) {
+        const Token * const use = *it;
+        if (end && use->progressValue() >= end->progressValue())
+            break;
+        if (reassignEnd && use->progressValue() > reassignEnd->progressValue())
+            break;
+
+        if (!reassignEnd && use->strAt(1) == "=")
+            reassignEnd = Token::findsimplematch(use, ";");
 
-        checkScope_inner(tok, arrayInfo);
+        checkScope_inner(use, arrayInfo);
     }
 }
 
@@ -1169,7 +1216,7 @@ void CheckBufferOverrun::checkGlobalAndLocalVariable()
             if (!value)
                 continue;
 
-            for (std::list<ValueFlow::Value>::const_iterator it = tok->values().begin(); it != tok->values().end(); ++it) {
+            for (ValueFlow::ValueList::const_iterator it = tok->values().begin(); it != tok->values().end(); ++it) {
                 if (!it->isTokValue() || !it->tokvalue)
                     continue;
                 const Variable *var = it->tokvalue->variable();
@@ -1177,7 +1224,8 @@ void CheckBufferOverrun::checkGlobalAndLocalVariable()
                     if (astCanonicalType(tok) != astCanonicalType(it->tokvalue))
                         continue;
 
-                    const ArrayInfo arrayInfo(var, symbolDatabase);
+                    const ArrayInfo *tableEntry = arrayInfoByVarId(var->declarationId());
+                    const ArrayInfo arrayInfo(tableEntry ? *tableEntry : ArrayInfo(var, symbolDatabase));
                     const MathLib::bigint elements = arrayInfo.numberOfElements();
                     if (elements <= 0) // unknown size
                         continue;
@@ -1227,7 +1275,8 @@ void CheckBufferOverrun::checkGlobalAndLocalVariable()
             } while (tok && tok->str() != ";");
             if (!tok)
                 break;
-            arrayInfos[var.declarationId()] = ArrayInfo(&var, symbolDatabase, var.declarationId());
+            const ArrayInfo *tableEntry = arrayInfoByVarId(var.declarationId());
+            arrayInfos[var.declarationId()] = tableEntry ? *tableEntry : ArrayInfo(&var, symbolDatabase, var.declarationId());
         }
         if (!arrayInfos.empty())
             checkScope(scope.bodyStart ? scope.bodyStart : mTokenizer->tokens(), arrayInfos);
@@ -73,6 +73,11 @@ public:
         : Check(myName(), tokenizer, settings, errorLogger) {
     }
 
+    /** @brief Create a bound instance, see Check::createInstance() */
+    Check *createInstance(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) const OVERRIDE {
+        return new CheckBufferOverrun(tokenizer, settings, errorLogger);
+    }
+
     void runSimplifiedChecks(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) OVERRIDE {
         CheckBufferOverrun checkBufferOverrun(tokenizer, settings, errorLogger);
         checkBufferOverrun.checkGlobalAndLocalVariable();
@@ -274,6 +279,24 @@ private:
 
     void valueFlowCheckArrayIndex(const Token * const tok, const ArrayInfo &arrayInfo);
 
+    /** Fill mArrayInfoByVarId and mVarIdUses, one pass over the token list */
+    void fillArrayIndexes();
+
+    /** Precomputed array dimensions, nullptr if varId is not a known array */
+    const ArrayInfo *arrayInfoByVarId(unsigned int varId);
+
+    /** All tokens with the given varid, in token list order */
+    const std::vector<const Token *> &varIdUses(unsigned int varId);
+
+    /** varid -> array dimensions, computed once per token list */
+    std::map<unsigned int, ArrayInfo> mArrayInfoByVarId;
+
+    /** varid -> access sites in token list order, computed once per token list */
+    std::map<unsigned int, std::vector<const Token *> > mVarIdUses;
+
+    /** have the tables above been filled */
+    bool mArrayIndexesFilled = false;
+
 public:
     void getErrorMessages(ErrorLogger *errorLogger, const Settings *settings) const OVERRIDE {
         CheckBufferOverrun c(nullptr, settings, errorLogger);
@@ -91,19 +91,22 @@ void CheckClass::constructors()
         return;
 
     const bool printInconclusive = mSettings->inconclusive;
-    for (const Scope * scope : mSymbolDatabase->classAndStructScopes) {
 
-        bool usedInUnion = false;
-        for (const Scope &unionScope : mSymbolDatabase->scopeList) {
-            if (unionScope.type != Scope::eUnion)
-                continue;
-            for (const Variable &var : unionScope.varlist) {
-                if (var.type() && var.type()->classScope == scope) {
-                    usedInUnion = true;
-                    break;
-                }
-            }
+    // class scopes used as union members - collect them once instead of
+    // rescanning all scopes for every class
+    std::set<const Scope *> unionMemberClasses;
+    for (const Scope &unionScope : mSymbolDatabase->scopeList) {
+        if (unionScope.type != Scope::eUnion)
+            continue;
+        for (const Variable &var : unionScope.varlist) {
+            if (var.type() && var.type()->classScope)
+                unionMemberClasses.insert(var.type()->classScope);
         }
+    }
+
+    for (const Scope * scope : mSymbolDatabase->classAndStructScopes) {
+
+        const bool usedInUnion = unionMemberClasses.find(scope) != unionMemberClasses.end();
 
         // There are no constructors.
         if (scope->numConstructors == 0 && printStyle && !usedInUnion) {
@@ -573,7 +576,7 @@ bool CheckClass::isBaseClassFunc(const Token *tok, const Scope *scope)
             const std::list<Function>& functionList = derivedFrom->classScope->functionList;
 
             for (const Function &func : functionList) {
-                if (func.tokenDef->str() == tok->str())
+                if (func.tokenDef->sameStr(tok))
                     return true;
             }
         }
@@ -1029,8 +1032,8 @@ static bool checkFunctionUsage(const Function *privfunc, const Scope* scope)
             return true;
     }
 
-    const std::map<std::string, Type*>::const_iterator end = scope->definedTypesMap.end();
-    for (std::map<std::string, Type*>::const_iterator iter = scope->definedTypesMap.begin(); iter != end; ++ iter) {
+    const std::unordered_map<std::string, Type*>::const_iterator end = scope->definedTypesMap.end();
+    for (std::unordered_map<std::string, Type*>::const_iterator iter = scope->definedTypesMap.begin(); iter != end; ++ iter) {
         const Type *type = (*iter).second;
         if (type->enclosingScope == scope && checkFunctionUsage(privfunc, type->classScope))
             return true;
@@ -1407,7 +1410,7 @@ void CheckClass::checkReturnPtrThis(const Scope *scope, const Function *func, co
             for (std::list<Function>::const_iterator it = scope->functionList.begin(); it != scope->functionList.end(); ++it) {
                 // check for a regular function with the same name and a body
                 if (it->type == Function::eFunction && it->hasBody() &&
-                    it->token->str() == tok->next()->str()) {
+                    it->token->sameStr(tok->next())) {
                     // check for the proper return type
                     if (it->tokenDef->previous()->str() == "&" &&
                         it->tokenDef->strAt(-2) == scope->className) {
@@ -1583,7 +1586,7 @@ bool CheckClass::hasAssignSelf(const Function *func, const Token *rhs)
                 tok2 = tok2->astOperand1();
             else
                 return ChildrenToVisit::op1_and_op2;
-            if (tok2 && tok2->isUnaryOp("&") && tok2->astOperand1()->str() == rhs->str())
+            if (tok2 && tok2->isUnaryOp("&") && tok2->astOperand1()->sameStr(rhs))
                 ret = true;
             return ret ? ChildrenToVisit::done : ChildrenToVisit::op1_and_op2;
         });
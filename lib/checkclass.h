@@ -52,6 +52,11 @@ public:
     /** @brief This constructor is used when running checks. */
     CheckClass(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger);
 
+    /** @brief Create a bound instance, see Check::createInstance() */
+    Check *createInstance(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) const OVERRIDE {
+        return new CheckClass(tokenizer, settings, errorLogger);
+    }
+
     /** @brief Run checks on the normal token list */
     void runChecks(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) OVERRIDE {
         if (tokenizer->isC())
@@ -94,6 +99,10 @@ public:
         checkClass.checkOverride();
     }
 
+    bool hasSimplifiedChecks(const Tokenizer *tokenizer, const Settings * /*settings*/) const OVERRIDE {
+        return !tokenizer->isC();
+    }
+
 
     /** @brief %Check that all class constructors are ok */
     void constructors();
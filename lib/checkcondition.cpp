@@ -245,11 +245,11 @@ static void getnumchildren(const Token *tok, std::list<MathLib::bigint> &numchil
 {
     if (tok->astOperand1() && tok->astOperand1()->isNumber())
         numchildren.push_back(MathLib::toLongNumber(tok->astOperand1()->str()));
-    else if (tok->astOperand1() && tok->str() == tok->astOperand1()->str())
+    else if (tok->astOperand1() && tok->sameStr(tok->astOperand1()))
         getnumchildren(tok->astOperand1(), numchildren);
     if (tok->astOperand2() && tok->astOperand2()->isNumber())
         numchildren.push_back(MathLib::toLongNumber(tok->astOperand2()->str()));
-    else if (tok->astOperand2() && tok->str() == tok->astOperand2()->str())
+    else if (tok->astOperand2() && tok->sameStr(tok->astOperand2()))
         getnumchildren(tok->astOperand2(), numchildren);
 }
 
@@ -276,20 +276,24 @@ void CheckCondition::checkBadBitmaskCheck()
     if (!mSettings->isEnabled(Settings::WARNING))
         return;
 
-    for (const Token *tok = mTokenizer->tokens(); tok; tok = tok->next()) {
-        if (tok->str() == "|" && tok->astOperand1() && tok->astOperand2() && tok->astParent()) {
-            const Token* parent = tok->astParent();
-            const bool isBoolean = Token::Match(parent, "&&|%oror%") ||
-                                   (parent->str() == "?" && parent->astOperand1() == tok) ||
-                                   (parent->str() == "=" && parent->astOperand2() == tok && parent->astOperand1() && parent->astOperand1()->variable() && Token::Match(parent->astOperand1()->variable()->typeStartToken(), "bool|_Bool")) ||
-                                   (parent->str() == "(" && Token::Match(parent->astOperand1(), "if|while")) ||
-                                   (parent->str() == "return" && parent->astOperand1() == tok && inBooleanFunction(tok));
-
-            const bool isTrue = (tok->astOperand1()->hasKnownIntValue() && tok->astOperand1()->values().front().intvalue != 0) ||
-                                (tok->astOperand2()->hasKnownIntValue() && tok->astOperand2()->values().front().intvalue != 0);
-
-            if (isBoolean && isTrue)
-                badBitmaskCheckError(tok);
+    // conditions only exist in executable code, don't walk the declarations
+    const SymbolDatabase *symbolDatabase = mTokenizer->getSymbolDatabase();
+    for (const Scope * scope : symbolDatabase->functionScopes) {
+        for (const Token *tok = scope->bodyStart; tok != scope->bodyEnd; tok = tok->next()) {
+            if (tok->str() == "|" && tok->astOperand1() && tok->astOperand2() && tok->astParent()) {
+                const Token* parent = tok->astParent();
+                const bool isBoolean = Token::Match(parent, "&&|%oror%") ||
+                                       (parent->str() == "?" && parent->astOperand1() == tok) ||
+                                       (parent->str() == "=" && parent->astOperand2() == tok && parent->astOperand1() && parent->astOperand1()->variable() && Token::Match(parent->astOperand1()->variable()->typeStartToken(), "bool|_Bool")) ||
+                                       (parent->str() == "(" && Token::Match(parent->astOperand1(), "if|while")) ||
+                                       (parent->str() == "return" && parent->astOperand1() == tok && inBooleanFunction(tok));
+
+                const bool isTrue = (tok->astOperand1()->hasKnownIntValue() && tok->astOperand1()->values().front().intvalue != 0) ||
+                                    (tok->astOperand2()->hasKnownIntValue() && tok->astOperand2()->values().front().intvalue != 0);
+
+                if (isBoolean && isTrue)
+                    badBitmaskCheckError(tok);
+            }
         }
     }
 }
@@ -304,55 +308,59 @@ void CheckCondition::comparison()
     if (!mSettings->isEnabled(Settings::STYLE))
         return;
 
-    for (const Token *tok = mTokenizer->tokens(); tok; tok = tok->next()) {
-        if (!tok->isComparisonOp())
-            continue;
+    // comparisons only exist in executable code, don't walk the declarations
+    const SymbolDatabase *symbolDatabase = mTokenizer->getSymbolDatabase();
+    for (const Scope * scope : symbolDatabase->functionScopes) {
+        for (const Token *tok = scope->bodyStart; tok != scope->bodyEnd; tok = tok->next()) {
+            if (!tok->isComparisonOp())
+                continue;
 
-        const Token *expr1 = tok->astOperand1();
-        const Token *expr2 = tok->astOperand2();
-        if (!expr1 || !expr2)
-            continue;
-        if (expr1->isNumber())
-            std::swap(expr1,expr2);
-        if (!expr2->isNumber())
-            continue;
-        const MathLib::bigint num2 = MathLib::toLongNumber(expr2->str());
-        if (num2 < 0)
-            continue;
-        if (!Token::Match(expr1,"[&|]"))
-            continue;
-        std::list<MathLib::bigint> numbers;
-        getnumchildren(expr1, numbers);
-        for (const MathLib::bigint num1 : numbers) {
-            if (num1 < 0)
+            const Token *expr1 = tok->astOperand1();
+            const Token *expr2 = tok->astOperand2();
+            if (!expr1 || !expr2)
                 continue;
-            if (Token::Match(tok, "==|!=")) {
-                if ((expr1->str() == "&" && (num1 & num2) != num2) ||
-                    (expr1->str() == "|" && (num1 | num2) != num2)) {
-                    const std::string& op(tok->str());
-                    comparisonError(expr1, expr1->str(), num1, op, num2, op=="==" ? false : true);
-                }
-            } else if (expr1->str() == "&") {
-                const bool or_equal = Token::Match(tok, ">=|<=");
-                const std::string& op(tok->str());
-                if ((Token::Match(tok, ">=|<")) && (num1 < num2)) {
-                    comparisonError(expr1, expr1->str(), num1, op, num2, or_equal ? false : true);
-                } else if ((Token::Match(tok, "<=|>")) && (num1 <= num2)) {
-                    comparisonError(expr1, expr1->str(), num1, op, num2, or_equal ? true : false);
-                }
-            } else if (expr1->str() == "|") {
-                if ((expr1->astOperand1()->valueType()) &&
-                    (expr1->astOperand1()->valueType()->sign == ValueType::Sign::UNSIGNED)) {
+            if (expr1->isNumber())
+                std::swap(expr1,expr2);
+            if (!expr2->isNumber())
+                continue;
+            const MathLib::bigint num2 = MathLib::toLongNumber(expr2->str());
+            if (num2 < 0)
+                continue;
+            if (!Token::Match(expr1,"[&|]"))
+                continue;
+            std::list<MathLib::bigint> numbers;
+            getnumchildren(expr1, numbers);
+            for (const MathLib::bigint num1 : numbers) {
+                if (num1 < 0)
+                    continue;
+                if (Token::Match(tok, "==|!=")) {
+                    if ((expr1->str() == "&" && (num1 & num2) != num2) ||
+                        (expr1->str() == "|" && (num1 | num2) != num2)) {
+                        const std::string& op(tok->str());
+                        comparisonError(expr1, expr1->str(), num1, op, num2, op=="==" ? false : true);
+                    }
+                } else if (expr1->str() == "&") {
                     const bool or_equal = Token::Match(tok, ">=|<=");
                     const std::string& op(tok->str());
-                    if ((Token::Match(tok, ">=|<")) && (num1 >= num2)) {
-                        //"(a | 0x07) >= 7U" is always true for unsigned a
-                        //"(a | 0x07) < 7U" is always false for unsigned a
-                        comparisonError(expr1, expr1->str(), num1, op, num2, or_equal ? true : false);
-                    } else if ((Token::Match(tok, "<=|>")) && (num1 > num2)) {
-                        //"(a | 0x08) <= 7U" is always false for unsigned a
-                        //"(a | 0x07) > 6U" is always true for unsigned a
+                    if ((Token::Match(tok, ">=|<")) && (num1 < num2)) {
                         comparisonError(expr1, expr1->str(), num1, op, num2, or_equal ? false : true);
+                    } else if ((Token::Match(tok, "<=|>")) && (num1 <= num2)) {
+                        comparisonError(expr1, expr1->str(), num1, op, num2, or_equal ? true : false);
+                    }
+                } else if (expr1->str() == "|") {
+                    if ((expr1->astOperand1()->valueType()) &&
+                        (expr1->astOperand1()->valueType()->sign == ValueType::Sign::UNSIGNED)) {
+                        const bool or_equal = Token::Match(tok, ">=|<=");
+                        const std::string& op(tok->str());
+                        if ((Token::Match(tok, ">=|<")) && (num1 >= num2)) {
+                            //"(a | 0x07) >= 7U" is always true for unsigned a
+                            //"(a | 0x07) < 7U" is always false for unsigned a
+                            comparisonError(expr1, expr1->str(), num1, op, num2, or_equal ? true : false);
+                        } else if ((Token::Match(tok, "<=|>")) && (num1 > num2)) {
+                            //"(a | 0x08) <= 7U" is always false for unsigned a
+                            //"(a | 0x07) > 6U" is always true for unsigned a
+                            comparisonError(expr1, expr1->str(), num1, op, num2, or_equal ? false : true);
+                        }
                     }
                 }
             }
@@ -537,6 +545,79 @@ static bool isNonConstFunctionCall(const Token *ftok, const Library &library)
     return true;
 }
 
+// Is the result of comparing this condition with another condition independent
+// of where the conditions are located? Only then can the result be memoized by
+// expression ids. Function calls and macros have no expression id, variables
+// with an initialization can be substituted by followVariableExpression and
+// known values queried by isOppositeCond depend on the value flow at the token.
+static bool isStableCondition(const Token *cond)
+{
+    bool stable = true;
+    visitAstNodes(cond, [&](const Token *tok) {
+        if (tok->exprId() == 0) {
+            stable = false;
+            return ChildrenToVisit::done;
+        }
+        if (tok->varId() != 0) {
+            const Variable *var = tok->variable();
+            if (var && var->declEndToken() &&
+                (var->declEndToken()->astOperand2() || Token::Match(var->declEndToken(), "; %varid% =", tok->varId()))) {
+                stable = false;
+                return ChildrenToVisit::done;
+            }
+        }
+        if (!tok->isLiteral() && !tok->enumerator() && tok->hasKnownIntValue()) {
+            stable = false;
+            return ChildrenToVisit::done;
+        }
+        return ChildrenToVisit::op1_and_op2;
+    });
+    return stable;
+}
+
+bool CheckCondition::canMemoizeConditions(const Token *cond1, const Token *cond2)
+{
+    if (!cond1 || !cond2 || cond1->exprId() == 0 || cond2->exprId() == 0)
+        return false;
+    std::map<unsigned int, bool>::const_iterator it = mStableCondition.find(cond1->exprId());
+    if (it == mStableCondition.end())
+        it = mStableCondition.insert(std::make_pair(cond1->exprId(), isStableCondition(cond1))).first;
+    if (!it->second)
+        return false;
+    it = mStableCondition.find(cond2->exprId());
+    if (it == mStableCondition.end())
+        it = mStableCondition.insert(std::make_pair(cond2->exprId(), isStableCondition(cond2))).first;
+    return it->second;
+}
+
+bool CheckCondition::isSameConditionCached(const Token *cond1, const Token *cond2, ErrorPath *errorPath)
+{
+    if (canMemoizeConditions(cond1, cond2)) {
+        const std::pair<unsigned int, unsigned int> key(cond1->exprId(), cond2->exprId());
+        const std::map<std::pair<unsigned int, unsigned int>, bool>::const_iterator it = mSameConditionCache.find(key);
+        if (it != mSameConditionCache.end())
+            return it->second;
+        const bool result = isSameExpression(mTokenizer->isCPP(), true, cond1, cond2, mSettings->library, true, true, errorPath);
+        mSameConditionCache[key] = result;
+        return result;
+    }
+    return isSameExpression(mTokenizer->isCPP(), true, cond1, cond2, mSettings->library, true, true, errorPath);
+}
+
+bool CheckCondition::isOppositeConditionCached(const Token *cond1, const Token *cond2, ErrorPath *errorPath)
+{
+    if (canMemoizeConditions(cond1, cond2)) {
+        const std::pair<unsigned int, unsigned int> key(cond1->exprId(), cond2->exprId());
+        const std::map<std::pair<unsigned int, unsigned int>, bool>::const_iterator it = mOppositeConditionCache.find(key);
+        if (it != mOppositeConditionCache.end())
+            return it->second;
+        const bool result = isOppositeCond(false, mTokenizer->isCPP(), cond1, cond2, mSettings->library, true, true, errorPath);
+        mOppositeConditionCache[key] = result;
+        return result;
+    }
+    return isOppositeCond(false, mTokenizer->isCPP(), cond1, cond2, mSettings->library, true, true, errorPath);
+}
+
 void CheckCondition::multiCondition2()
 {
     if (!mSettings->isEnabled(Settings::WARNING))
@@ -653,10 +734,10 @@ void CheckCondition::multiCondition2()
                                 tokens1.push(firstCondition->astOperand1());
                                 tokens1.push(firstCondition->astOperand2());
                             } else if (!firstCondition->hasKnownIntValue()) {
-                                if (!isReturnVar && isOppositeCond(false, mTokenizer->isCPP(), firstCondition, cond2, mSettings->library, true, true, &errorPath)) {
+                                if (!isReturnVar && isOppositeConditionCached(firstCondition, cond2, &errorPath)) {
                                     if (!isAliased(vars))
                                         oppositeInnerConditionError(firstCondition, cond2, errorPath);
-                                } else if (!isReturnVar && isSameExpression(mTokenizer->isCPP(), true, firstCondition, cond2, mSettings->library, true, true, &errorPath)) {
+                                } else if (!isReturnVar && isSameConditionCached(firstCondition, cond2, &errorPath)) {
                                     identicalInnerConditionError(firstCondition, cond2, errorPath);
                                 }
                             }
@@ -673,7 +754,7 @@ void CheckCondition::multiCondition2()
                                 tokens2.push(secondCondition->astOperand1());
                                 tokens2.push(secondCondition->astOperand2());
                             } else if ((!cond1->hasKnownIntValue() || !secondCondition->hasKnownIntValue()) &&
-                                       isSameExpression(mTokenizer->isCPP(), true, cond1, secondCondition, mSettings->library, true, true, &errorPath)) {
+                                       isSameConditionCached(cond1, secondCondition, &errorPath)) {
                                 if (!isAliased(vars))
                                     identicalConditionAfterEarlyExitError(cond1, secondCondition, errorPath);
                             }
@@ -1038,7 +1119,7 @@ void CheckCondition::checkIncorrectLogicOperator()
 
             // Comparison #1 (LHS)
             const Token *comp1 = tok->astOperand1();
-            if (comp1 && comp1->str() == tok->str())
+            if (comp1 && comp1->sameStr(tok))
                 comp1 = comp1->astOperand2();
 
             // Comparison #2 (RHS)
@@ -1300,10 +1381,17 @@ void CheckCondition::alwaysTrueFalse()
     if (!mSettings->isEnabled(Settings::STYLE))
         return;
 
-    const SymbolDatabase *symbolDatabase = mTokenizer->getSymbolDatabase();
-    for (const Scope * scope : symbolDatabase->functionScopes) {
-        for (const Token* tok = scope->bodyStart->next(); tok != scope->bodyEnd; tok = tok->next()) {
+    // Only tokens with known values can be always true/false - iterate the
+    // tokens carrying values instead of every token of every function.
+    for (const Token *tok : mTokenizer->list.valueTokens()) {
+        // the enclosing function scope
+        const Scope *scope = tok->scope();
+        while (scope && scope->isExecutable() && scope->type != Scope::eFunction)
+            scope = scope->nestedIn;
+        if (!scope || scope->type != Scope::eFunction)
+            continue;
 
+        {
             if (tok->link()) // don't write false positives when templates are used
                 continue;
             if (!tok->hasKnownIntValue())
@@ -26,7 +26,9 @@
 #include "config.h"
 #include "mathlib.h"
 
+#include <map>
 #include <string>
+#include <utility>
 
 class ErrorLogger;
 class Settings;
@@ -51,6 +53,11 @@ public:
         : Check(myName(), tokenizer, settings, errorLogger) {
     }
 
+    /** @brief Create a bound instance, see Check::createInstance() */
+    Check *createInstance(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) const OVERRIDE {
+        return new CheckCondition(tokenizer, settings, errorLogger);
+    }
+
     void runChecks(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) OVERRIDE {
         CheckCondition checkCondition(tokenizer, settings, errorLogger);
         checkCondition.multiCondition();
@@ -126,6 +133,20 @@ private:
     bool diag(const Token* tok, bool insert=true);
     bool isAliased(const std::set<unsigned int> &vars) const;
     bool isOverlappingCond(const Token * const cond1, const Token * const cond2, bool pure) const;
+
+    /** can the relation between the two conditions be memoized by expression ids? */
+    bool canMemoizeConditions(const Token *cond1, const Token *cond2);
+    /** memoized isSameExpression for condition pairs, see mSameConditionCache */
+    bool isSameConditionCached(const Token *cond1, const Token *cond2, ErrorPath *errorPath);
+    /** memoized isOppositeCond for condition pairs, see mOppositeConditionCache */
+    bool isOppositeConditionCached(const Token *cond1, const Token *cond2, ErrorPath *errorPath);
+
+    // Relation caches for multiCondition2, keyed by expression ids. Only
+    // "stable" conditions whose comparison result does not depend on the
+    // program location are cached; see isStableCondition in checkcondition.cpp.
+    std::map<std::pair<unsigned int, unsigned int>, bool> mSameConditionCache;
+    std::map<std::pair<unsigned int, unsigned int>, bool> mOppositeConditionCache;
+    std::map<unsigned int, bool> mStableCondition;
     void assignIfError(const Token *tok1, const Token *tok2, const std::string &condition, bool result);
     void mismatchingBitAndError(const Token *tok1, const MathLib::bigint num1, const Token *tok2, const MathLib::bigint num2);
     void badBitmaskCheckError(const Token *tok);
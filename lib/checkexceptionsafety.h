@@ -61,6 +61,11 @@ public:
         : Check(myName(), tokenizer, settings, errorLogger) {
     }
 
+    /** @brief Create a bound instance, see Check::createInstance() */
+    Check *createInstance(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) const OVERRIDE {
+        return new CheckExceptionSafety(tokenizer, settings, errorLogger);
+    }
+
     /** Checks that uses the simplified token list */
     void runSimplifiedChecks(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) OVERRIDE {
         if (tokenizer->isC())
@@ -75,6 +80,10 @@ public:
         checkExceptionSafety.unhandledExceptionSpecification();
     }
 
+    bool hasSimplifiedChecks(const Tokenizer *tokenizer, const Settings * /*settings*/) const OVERRIDE {
+        return !tokenizer->isC();
+    }
+
     /** Don't throw exceptions in destructors */
     void destructors();
 
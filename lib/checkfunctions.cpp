@@ -23,6 +23,7 @@
 #include "checkfunctions.h"
 
 #include "astutils.h"
+#include "library.h"
 #include "mathlib.h"
 #include "standards.h"
 #include "symboldatabase.h"
@@ -214,8 +215,9 @@ void CheckFunctions::checkIgnoredReturnValue()
                 continue;
             }
 
+            const Library::Annotation *annotation = mTokenizer->libraryAnnotation(tok);
             if ((!tok->function() || !Token::Match(tok->function()->retDef, "void %name%")) &&
-                (mSettings->library.isUseRetVal(tok) || (tok->function() && tok->function()->isAttributeNodiscard())) &&
+                ((annotation && annotation->function && annotation->function->useretval) || (tok->function() && tok->function()->isAttributeNodiscard())) &&
                 !WRONG_DATA(!tok->next()->astOperand1(), tok)) {
                 ignoredReturnValueError(tok, tok->next()->astOperand1()->expressionString());
             }
@@ -347,6 +347,120 @@ void CheckInternal::checkExtraWhitespace()
     }
 }
 
+void CheckInternal::checkUncompiledPatterns()
+{
+    const SymbolDatabase *symbolDatabase = mTokenizer->getSymbolDatabase();
+    for (const Scope *scope : symbolDatabase->functionScopes) {
+        for (const Token* tok = scope->bodyStart->next(); tok != scope->bodyEnd; tok = tok->next()) {
+            if (!Token::Match(tok, "Token :: simpleMatch|findsimplematch|Match|findmatch ("))
+                continue;
+
+            // Get pattern argument
+            const Token *patternTok = tok->tokAt(4)->nextArgument();
+            if (!patternTok)
+                continue;
+
+            // a pattern that is not a string literal is built at runtime and
+            // is matched by the interpreting fallback on every call
+            if (patternTok->tokType() != Token::eString)
+                uncompiledPatternError(tok, tok->strAt(2));
+        }
+    }
+}
+
+void CheckInternal::checkDuplicateAlternatives()
+{
+    const SymbolDatabase *symbolDatabase = mTokenizer->getSymbolDatabase();
+    for (const Scope *scope : symbolDatabase->functionScopes) {
+        for (const Token* tok = scope->bodyStart->next(); tok != scope->bodyEnd; tok = tok->next()) {
+            if (!Token::Match(tok, "Token :: Match|findmatch ("))
+                continue;
+
+            const std::string& funcname = tok->strAt(2);
+
+            // Get pattern string
+            const Token *patternTok = tok->tokAt(4)->nextArgument();
+            if (!patternTok || patternTok->tokType() != Token::eString)
+                continue;
+
+            const std::string pattern = patternTok->strValue();
+
+            // check each multicompare for repeated alternatives: every copy
+            // after the first is compared and can never match
+            std::string::size_type wordStart = 0;
+            while (wordStart < pattern.size()) {
+                std::string::size_type wordEnd = pattern.find(' ', wordStart);
+                if (wordEnd == std::string::npos)
+                    wordEnd = pattern.size();
+                const std::string word = pattern.substr(wordStart, wordEnd - wordStart);
+                wordStart = wordEnd + 1;
+                if (word.find('|') == std::string::npos)
+                    continue;
+                std::set<std::string> seen;
+                std::string::size_type altStart = 0;
+                while (altStart <= word.size()) {
+                    std::string::size_type altEnd = word.find('|', altStart);
+                    if (altEnd == std::string::npos)
+                        altEnd = word.size();
+                    const std::string alternative = word.substr(altStart, altEnd - altStart);
+                    altStart = altEnd + 1;
+                    if (alternative.empty() || alternative == "!!")
+                        continue;
+                    if (!seen.insert(alternative).second) {
+                        duplicateAlternativeError(tok, word, funcname);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void CheckInternal::checkTokenListScanInScopeLoop()
+{
+    const SymbolDatabase *symbolDatabase = mTokenizer->getSymbolDatabase();
+    for (const Scope *scope : symbolDatabase->functionScopes) {
+        for (const Token* tok = scope->bodyStart->next(); tok != scope->bodyEnd; tok = tok->next()) {
+            if (!Token::simpleMatch(tok, "for ("))
+                continue;
+
+            // a loop over the scopes of the symbol database..
+            const Token *parenEnd = tok->linkAt(1);
+            bool scopeLoop = false;
+            for (const Token *tok2 = tok->tokAt(2); tok2 && tok2 != parenEnd; tok2 = tok2->next()) {
+                if (Token::Match(tok2, "functionScopes|scopeList|classAndStructScopes")) {
+                    scopeLoop = true;
+                    break;
+                }
+            }
+            if (!scopeLoop || !Token::simpleMatch(parenEnd, ") {"))
+                continue;
+
+            // ..that restarts from the full token list in its body is a scan
+            // of the whole translation unit per scope
+            const Token *bodyEnd = parenEnd->next()->link();
+            for (const Token *tok2 = parenEnd->tokAt(2); tok2 && tok2 != bodyEnd; tok2 = tok2->next()) {
+                if (Token::Match(tok2, "%name% . tokens ( )") || Token::Match(tok2, "%name% . list . front ( )"))
+                    tokenListScanError(tok2);
+            }
+        }
+    }
+}
+
+void CheckInternal::checkTokenStrCopies()
+{
+    const SymbolDatabase *symbolDatabase = mTokenizer->getSymbolDatabase();
+    for (const Scope *scope : symbolDatabase->functionScopes) {
+        for (const Token* tok = scope->bodyStart->next(); tok != scope->bodyEnd; tok = tok->next()) {
+            // Token::str() and Token::strAt() return a const reference;
+            // binding it to a plain std::string copies the string
+            if (Token::Match(tok, "std :: string %name% = %name% . str|strAt (") &&
+                Token::simpleMatch(tok->linkAt(8), ") ;"))
+                tokenStrCopyError(tok, tok->strAt(3));
+        }
+    }
+}
+
 void CheckInternal::checkStlUsage()
 {
     const SymbolDatabase *symbolDatabase = mTokenizer->getSymbolDatabase();
@@ -413,4 +527,28 @@ void CheckInternal::extraWhitespaceError(const Token* tok, const std::string& pa
                );
 }
 
+void CheckInternal::uncompiledPatternError(const Token* tok, const std::string &funcname)
+{
+    reportError(tok, Severity::performance, "uncompiledPattern",
+                "Token::" + funcname + "() pattern is built at runtime and cannot be precompiled by the matchcompiler.");
+}
+
+void CheckInternal::duplicateAlternativeError(const Token* tok, const std::string& pattern, const std::string &funcname)
+{
+    reportError(tok, Severity::performance, "duplicateAlternative",
+                "Duplicate alternative in Token::" + funcname + "() multicompare \"" + pattern + "\", every copy after the first is compared but can never match.");
+}
+
+void CheckInternal::tokenListScanError(const Token* tok)
+{
+    reportError(tok, Severity::performance, "tokenListScanInScopeLoop",
+                "Full token list scan inside a loop over the scopes, the whole translation unit is rescanned per scope. Scan the scope body instead.");
+}
+
+void CheckInternal::tokenStrCopyError(const Token* tok, const std::string &varname)
+{
+    reportError(tok, Severity::performance, "tokenStrCopy",
+                "The token string is copied into '" + varname + "'. Use 'const std::string &' to bind it without a copy.");
+}
+
 #endif // #ifdef CHECK_INTERNAL
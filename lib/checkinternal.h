@@ -43,6 +43,11 @@ public:
         : Check(myName(), tokenizer, settings, errorLogger) {
     }
 
+    /** @brief Create a bound instance, see Check::createInstance() */
+    Check *createInstance(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) const OVERRIDE {
+        return new CheckInternal(tokenizer, settings, errorLogger);
+    }
+
     /** Simplified checks. The token list is simplified. */
     void runSimplifiedChecks(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) OVERRIDE {
         if (!settings->isEnabled(Settings::INTERNAL))
@@ -58,6 +63,14 @@ public:
         checkInternal.checkExtraWhitespace();
         checkInternal.checkRedundantTokCheck();
         checkInternal.checkStlUsage();
+        checkInternal.checkUncompiledPatterns();
+        checkInternal.checkDuplicateAlternatives();
+        checkInternal.checkTokenListScanInScopeLoop();
+        checkInternal.checkTokenStrCopies();
+    }
+
+    bool hasSimplifiedChecks(const Tokenizer * /*tokenizer*/, const Settings *settings) const OVERRIDE {
+        return settings->isEnabled(Settings::INTERNAL);
     }
 
     /** @brief %Check if a simple pattern is used inside Token::Match or Token::findmatch */
@@ -83,6 +96,18 @@ public:
 
     /** @brief Try to avoid some new functions that are not fully supported in Linux */
     void checkStlUsage();
+
+    /** @brief %Check for patterns that are built at runtime and so cannot be precompiled by the matchcompiler */
+    void checkUncompiledPatterns();
+
+    /** @brief %Check for repeated alternatives in a multicompare, like "a|b|a" */
+    void checkDuplicateAlternatives();
+
+    /** @brief %Check for full token list scans inside a loop over the scopes */
+    void checkTokenListScanInScopeLoop();
+
+    /** @brief %Check for copies of the token string where a const reference binds without one */
+    void checkTokenStrCopies();
 private:
     void multiComparePatternError(const Token *tok, const std::string &pattern, const std::string &funcname);
     void simplePatternError(const Token *tok, const std::string &pattern, const std::string &funcname);
@@ -93,6 +118,10 @@ private:
     void orInComplexPattern(const Token *tok, const std::string &pattern, const std::string &funcname);
     void extraWhitespaceError(const Token *tok, const std::string &pattern, const std::string &funcname);
     void checkRedundantTokCheckError(const Token *tok);
+    void uncompiledPatternError(const Token *tok, const std::string &funcname);
+    void duplicateAlternativeError(const Token *tok, const std::string &pattern, const std::string &funcname);
+    void tokenListScanError(const Token *tok);
+    void tokenStrCopyError(const Token *tok, const std::string &varname);
 
     void getErrorMessages(ErrorLogger *errorLogger, const Settings *settings) const OVERRIDE {
         CheckInternal c(nullptr, settings, errorLogger);
@@ -105,6 +134,10 @@ private:
         c.orInComplexPattern(nullptr, "||", "Match");
         c.extraWhitespaceError(nullptr, "%str% ", "Match");
         c.checkRedundantTokCheckError(nullptr);
+        c.uncompiledPatternError(nullptr, "Match");
+        c.duplicateAlternativeError(nullptr, "a|b|a", "Match");
+        c.tokenListScanError(nullptr);
+        c.tokenStrCopyError(nullptr, "str");
     }
 
     static std::string myName() {
@@ -53,6 +53,16 @@ static const CWE CWE687(687U);  // Function Call With Incorrectly Specified Argu
 static const CWE CWE704(704U);  // Incorrect Type Conversion or Cast
 static const CWE CWE910(910U);  // Use of Expired File Descriptor
 
+// Is this a call of a noreturn function? Uses the annotations resolved by
+// Tokenizer::stampLibraryAnnotations() instead of querying the library.
+static bool isNoreturnCall(const Tokenizer *tokenizer, const Token *tok)
+{
+    if (tok->function() && tok->function()->isAttributeNoreturn())
+        return true;
+    const Library::Annotation *annotation = tokenizer->libraryAnnotation(tok);
+    return annotation && annotation->noreturn == 1;
+}
+
 //---------------------------------------------------------------------------
 //    std::cout << std::cout;
 //---------------------------------------------------------------------------
@@ -156,7 +166,7 @@ void CheckIO::checkFileUsage()
                         i->second.lastOperation = Filepointer::UNKNOWN_OP;
                     }
                 }
-            } else if (tok->str() == "return" || tok->str() == "continue" || tok->str() == "break" || mSettings->library.isnoreturn(tok)) { // Reset upon return, continue or break
+            } else if (tok->str() == "return" || tok->str() == "continue" || tok->str() == "break" || isNoreturnCall(mTokenizer, tok)) { // Reset upon return, continue or break
                 for (std::map<unsigned int, Filepointer>::iterator i = filepointers.begin(); i != filepointers.end(); ++i) {
                     i->second.mode_indent = 0;
                     i->second.mode = UNKNOWN_OM;
@@ -472,7 +482,7 @@ static bool findFormat(unsigned int arg, const Token *firstArg,
                  argTok->variable()->dimension(0) != 0))) {
         *formatArgTok = argTok->nextArgument();
         if (!argTok->values().empty()) {
-            std::list<ValueFlow::Value>::const_iterator value = std::find_if(
+            ValueFlow::ValueList::const_iterator value = std::find_if(
                         argTok->values().begin(), argTok->values().end(), std::mem_fn(&ValueFlow::Value::isTokValue));
             if (value != argTok->values().end() && value->isTokValue() && value->tokvalue &&
                 value->tokvalue->tokType() == Token::eString) {
@@ -506,10 +516,17 @@ void CheckIO::checkWrongPrintfScanfArguments()
             bool scanf_s = false;
             int formatStringArgNo = -1;
 
-            if (tok->strAt(1) == "(" && mSettings->library.formatstr_function(tok)) {
-                formatStringArgNo = mSettings->library.formatstr_argno(tok);
-                scan = mSettings->library.formatstr_scan(tok);
-                scanf_s = mSettings->library.formatstr_secure(tok);
+            const Library::Annotation *annotation = mTokenizer->libraryAnnotation(tok);
+            const Library::Function *libFunc = annotation ? annotation->function : nullptr;
+            if (tok->strAt(1) == "(" && libFunc && libFunc->formatstr) {
+                for (std::map<int, Library::ArgumentChecks>::const_iterator i = libFunc->argumentChecks.cbegin(); i != libFunc->argumentChecks.cend(); ++i) {
+                    if (i->second.formatstr) {
+                        formatStringArgNo = i->first - 1;
+                        break;
+                    }
+                }
+                scan = libFunc->formatstr_scan;
+                scanf_s = libFunc->formatstr_secure;
             }
 
             if (formatStringArgNo >= 0) {
@@ -560,6 +577,155 @@ void CheckIO::checkWrongPrintfScanfArguments()
     }
 }
 
+namespace {
+    /**
+     * One % conversion of a format string, extracted by parseFormatString().
+     * Only the result of walking the characters is stored - everything that
+     * depends on the arguments at the call site is checked when the
+     * descriptor is replayed in checkFormatString().
+     */
+    struct FormatConversion {
+        enum TailType { None, CharClass, Specifier };
+
+        FormatConversion()
+            : tail(None)
+            , parameterPosition(0)
+            , hasParameterPosition(false)
+            , skip(false)
+            , printfStarArgs(0)
+            , directCharClass(false)
+            , charClassClosed(false)
+            , truncated(false)
+            , bodyPos(0) {
+        }
+
+        /** what follows the flags/width/position characters */
+        TailType tail;
+
+        /** field width digits */
+        std::string width;
+
+        /** POSIX positional parameter ("%1$d") */
+        unsigned int parameterPosition;
+        bool hasParameterPosition;
+
+        /** a '*' was seen ("%*d") */
+        bool skip;
+
+        /** print functions: number of arguments consumed by '*' */
+        unsigned int printfStarArgs;
+
+        /** "%[...]" with nothing between the '%' and the '[' */
+        bool directCharClass;
+
+        /** the ']' that closes a character class was found */
+        bool charClassClosed;
+
+        /** the string ended inside the conversion */
+        bool truncated;
+
+        /** Specifier: offset of the length modifier / conversion character */
+        std::string::size_type bodyPos;
+    };
+
+    /** A format string parsed into its conversions, see parsedFormatString() */
+    struct FormatDescriptor {
+        std::vector<FormatConversion> conversions;
+    };
+
+    FormatDescriptor parseFormatString(const std::string &formatString, const bool scan)
+    {
+        FormatDescriptor desc;
+        bool percent = false;
+        for (std::string::const_iterator i = formatString.begin(); i != formatString.end(); ++i) {
+            if (*i == '%') {
+                percent = !percent;
+            } else if (percent && *i == '[') {
+                FormatConversion conv;
+                conv.directCharClass = true;
+                while (i != formatString.end()) {
+                    if (*i == ']') {
+                        conv.charClassClosed = true;
+                        percent = false;
+                        break;
+                    }
+                    ++i;
+                }
+                desc.conversions.push_back(conv);
+                if (i == formatString.end())
+                    break;
+            } else if (percent) {
+                percent = false;
+
+                FormatConversion conv;
+                bool _continue = false;
+                while (i != formatString.end() && *i != '[' && !std::isalpha((unsigned char)*i)) {
+                    if (*i == '*') {
+                        conv.skip = true;
+                        if (scan)
+                            _continue = true;
+                        else
+                            conv.printfStarArgs++;
+                    } else if (std::isdigit(*i)) {
+                        conv.width += *i;
+                    } else if (*i == '$') {
+                        conv.parameterPosition = static_cast<unsigned int>(std::atoi(conv.width.c_str()));
+                        conv.hasParameterPosition = true;
+                        conv.width.clear();
+                    }
+                    ++i;
+                }
+                if (i != formatString.end() && *i == '[') {
+                    conv.tail = FormatConversion::CharClass;
+                    while (i != formatString.end()) {
+                        if (*i == ']') {
+                            conv.charClassClosed = true;
+                            break;
+                        }
+                        ++i;
+                    }
+                    desc.conversions.push_back(conv);
+                    if (i == formatString.end())
+                        break;
+                    continue;
+                }
+                if (i == formatString.end()) {
+                    conv.truncated = true;
+                    desc.conversions.push_back(conv);
+                    break;
+                }
+                if (_continue) {
+                    // suppressed scanf conversion - no argument, but record it
+                    // in case '*' and '[' were combined
+                    desc.conversions.push_back(conv);
+                    continue;
+                }
+                conv.tail = FormatConversion::Specifier;
+                conv.bodyPos = i - formatString.begin();
+                desc.conversions.push_back(conv);
+            }
+        }
+        return desc;
+    }
+
+    /**
+     * The parsed form of the given format string. Identical format literals
+     * are common - logging macros repeat the same "%s:%d" thousands of
+     * times - so the descriptors are cached by string identity and each
+     * distinct literal is only parsed once per process. Thread local
+     * because the Windows executor checks files in several threads.
+     */
+    const FormatDescriptor &parsedFormatString(const std::string &formatString, const bool scan)
+    {
+        static thread_local std::map<std::string, FormatDescriptor> cache[2];
+        std::map<std::string, FormatDescriptor> &scanCache = cache[scan ? 1 : 0];
+        const std::map<std::string, FormatDescriptor>::const_iterator it = scanCache.find(formatString);
+        if (it != scanCache.end())
+            return it->second;
+        return scanCache.insert(std::make_pair(formatString, parseFormatString(formatString, scan))).first->second;
+    }
+}
+
 void CheckIO::checkFormatString(const Token * const tok,
                                 const Token * const formatStringTok,
                                 const Token *       argListTok,
@@ -569,25 +735,23 @@ void CheckIO::checkFormatString(const Token * const tok,
     const bool printWarning = mSettings->isEnabled(Settings::WARNING);
     const std::string &formatString = formatStringTok->str();
 
-    // Count format string parameters..
+    // Replay the parsed conversions of the format string and check the
+    // arguments at this call site against them. The parse itself is done
+    // only once per distinct format literal, see parsedFormatString().
     unsigned int numFormat = 0;
     unsigned int numSecure = 0;
-    bool percent = false;
     const Token* argListTok2 = argListTok;
     std::set<unsigned int> parameterPositionsUsed;
-    for (std::string::const_iterator i = formatString.begin(); i != formatString.end(); ++i) {
-        if (*i == '%') {
-            percent = !percent;
-        } else if (percent && *i == '[') {
-            while (i != formatString.end()) {
-                if (*i == ']') {
-                    numFormat++;
-                    if (argListTok)
-                        argListTok = argListTok->nextArgument();
-                    percent = false;
-                    break;
-                }
-                ++i;
+    const FormatDescriptor &descriptor = parsedFormatString(formatString, scan);
+    for (std::vector<FormatConversion>::const_iterator convIt = descriptor.conversions.begin(); convIt != descriptor.conversions.end(); ++convIt) {
+        const FormatConversion &conv = *convIt;
+
+        if (conv.directCharClass) {
+            // "%[...]"
+            if (conv.charClassClosed) {
+                numFormat++;
+                if (argListTok)
+                    argListTok = argListTok->nextArgument();
             }
             if (scanf_s) {
                 numSecure++;
@@ -595,689 +759,670 @@ void CheckIO::checkFormatString(const Token * const tok,
                     argListTok = argListTok->nextArgument();
                 }
             }
-            if (i == formatString.end())
+            if (!conv.charClassClosed)
                 break;
-        } else if (percent) {
-            percent = false;
-
-            bool _continue = false;
-            bool skip = false;
-            std::string width;
-            unsigned int parameterPosition = 0;
-            bool hasParameterPosition = false;
-            while (i != formatString.end() && *i != '[' && !std::isalpha((unsigned char)*i)) {
-                if (*i == '*') {
-                    skip = true;
-                    if (scan)
-                        _continue = true;
-                    else {
-                        numFormat++;
-                        if (argListTok)
-                            argListTok = argListTok->nextArgument();
-                    }
-                } else if (std::isdigit(*i)) {
-                    width += *i;
-                } else if (*i == '$') {
-                    parameterPosition = static_cast<unsigned int>(std::atoi(width.c_str()));
-                    hasParameterPosition = true;
-                    width.clear();
-                }
-                ++i;
+            continue;
+        }
+
+        // print functions: each '*' consumes an argument
+        numFormat += conv.printfStarArgs;
+        for (unsigned int star = 0; star < conv.printfStarArgs && argListTok; ++star)
+            argListTok = argListTok->nextArgument();
+
+        if (conv.tail == FormatConversion::CharClass) {
+            if (conv.charClassClosed && !conv.skip) {
+                numFormat++;
+                if (argListTok)
+                    argListTok = argListTok->nextArgument();
             }
-            if (i != formatString.end() && *i == '[') {
-                while (i != formatString.end()) {
-                    if (*i == ']') {
-                        if (!skip) {
-                            numFormat++;
-                            if (argListTok)
-                                argListTok = argListTok->nextArgument();
-                        }
-                        break;
-                    }
-                    ++i;
-                }
-                if (scanf_s && !skip) {
-                    numSecure++;
-                    if (argListTok) {
-                        argListTok = argListTok->nextArgument();
-                    }
+            if (scanf_s && !conv.skip) {
+                numSecure++;
+                if (argListTok) {
+                    argListTok = argListTok->nextArgument();
                 }
-                _continue = true;
             }
-            if (i == formatString.end())
+            if (!conv.charClassClosed)
                 break;
-            if (_continue)
-                continue;
-
-            if (scan || *i != 'm') { // %m is a non-standard extension that requires no parameter on print functions.
-                ++numFormat;
-
-                // Handle parameter positions (POSIX extension) - Ticket #4900
-                if (hasParameterPosition) {
-                    if (parameterPositionsUsed.find(parameterPosition) == parameterPositionsUsed.end())
-                        parameterPositionsUsed.insert(parameterPosition);
-                    else // Parameter already referenced, hence don't consider it a new format
-                        --numFormat;
-                }
-
-                // Perform type checks
-                ArgumentInfo argInfo(argListTok, mSettings, mTokenizer->isCPP());
+            continue;
+        }
+        if (conv.truncated)
+            break;
+        if (conv.tail != FormatConversion::Specifier)
+            continue; // suppressed scanf conversion, no argument
+
+        const std::string &width = conv.width;
+        const unsigned int parameterPosition = conv.parameterPosition;
+        const bool hasParameterPosition = conv.hasParameterPosition;
+        std::string::const_iterator i = formatString.begin() + conv.bodyPos;
+
+        if (scan || *i != 'm') { // %m is a non-standard extension that requires no parameter on print functions.
+            ++numFormat;
+
+            // Handle parameter positions (POSIX extension) - Ticket #4900
+            if (hasParameterPosition) {
+                if (parameterPositionsUsed.find(parameterPosition) == parameterPositionsUsed.end())
+                    parameterPositionsUsed.insert(parameterPosition);
+                else // Parameter already referenced, hence don't consider it a new format
+                    --numFormat;
+            }
 
-                if (argInfo.typeToken && !argInfo.isLibraryType(mSettings)) {
-                    if (scan) {
-                        std::string specifier;
-                        bool done = false;
-                        while (!done) {
-                            switch (*i) {
-                            case 's':
-                                specifier += *i;
-                                if (argInfo.variableInfo && argInfo.isKnownType() && argInfo.variableInfo->isArray() && (argInfo.variableInfo->dimensions().size() == 1) && argInfo.variableInfo->dimensions()[0].known) {
-                                    if (!width.empty()) {
-                                        const int numWidth = std::atoi(width.c_str());
-                                        if (numWidth != (argInfo.variableInfo->dimension(0) - 1))
-                                            invalidScanfFormatWidthError(tok, numFormat, numWidth, argInfo.variableInfo, 's');
-                                    }
+            // Perform type checks
+            ArgumentInfo argInfo(argListTok, mSettings, mTokenizer->isCPP());
+
+            if (argInfo.typeToken && !argInfo.isLibraryType(mSettings)) {
+                if (scan) {
+                    std::string specifier;
+                    bool done = false;
+                    while (!done) {
+                        switch (*i) {
+                        case 's':
+                            specifier += *i;
+                            if (argInfo.variableInfo && argInfo.isKnownType() && argInfo.variableInfo->isArray() && (argInfo.variableInfo->dimensions().size() == 1) && argInfo.variableInfo->dimensions()[0].known) {
+                                if (!width.empty()) {
+                                    const int numWidth = std::atoi(width.c_str());
+                                    if (numWidth != (argInfo.variableInfo->dimension(0) - 1))
+                                        invalidScanfFormatWidthError(tok, numFormat, numWidth, argInfo.variableInfo, 's');
                                 }
-                                if (argListTok && argListTok->tokType() != Token::eString &&
-                                    argInfo.isKnownType() && argInfo.isArrayOrPointer() &&
-                                    (!Token::Match(argInfo.typeToken, "char|wchar_t") ||
-                                     argInfo.typeToken->strAt(-1) == "const")) {
-                                    if (!(argInfo.isArrayOrPointer() && argInfo.element && !argInfo.typeToken->isStandardType()))
-                                        invalidScanfArgTypeError_s(tok, numFormat, specifier, &argInfo);
-                                }
-                                if (scanf_s) {
-                                    numSecure++;
-                                    if (argListTok) {
-                                        argListTok = argListTok->nextArgument();
-                                    }
+                            }
+                            if (argListTok && argListTok->tokType() != Token::eString &&
+                                argInfo.isKnownType() && argInfo.isArrayOrPointer() &&
+                                (!Token::Match(argInfo.typeToken, "char|wchar_t") ||
+                                 argInfo.typeToken->strAt(-1) == "const")) {
+                                if (!(argInfo.isArrayOrPointer() && argInfo.element && !argInfo.typeToken->isStandardType()))
+                                    invalidScanfArgTypeError_s(tok, numFormat, specifier, &argInfo);
+                            }
+                            if (scanf_s) {
+                                numSecure++;
+                                if (argListTok) {
+                                    argListTok = argListTok->nextArgument();
                                 }
-                                done = true;
-                                break;
-                            case 'c':
-                                if (argInfo.variableInfo && argInfo.isKnownType() && argInfo.variableInfo->isArray() && (argInfo.variableInfo->dimensions().size() == 1) && argInfo.variableInfo->dimensions()[0].known) {
-                                    if (!width.empty()) {
-                                        const int numWidth = std::atoi(width.c_str());
-                                        if (numWidth > argInfo.variableInfo->dimension(0))
-                                            invalidScanfFormatWidthError(tok, numFormat, numWidth, argInfo.variableInfo, 'c');
-                                    }
+                            }
+                            done = true;
+                            break;
+                        case 'c':
+                            if (argInfo.variableInfo && argInfo.isKnownType() && argInfo.variableInfo->isArray() && (argInfo.variableInfo->dimensions().size() == 1) && argInfo.variableInfo->dimensions()[0].known) {
+                                if (!width.empty()) {
+                                    const int numWidth = std::atoi(width.c_str());
+                                    if (numWidth > argInfo.variableInfo->dimension(0))
+                                        invalidScanfFormatWidthError(tok, numFormat, numWidth, argInfo.variableInfo, 'c');
                                 }
-                                if (scanf_s) {
-                                    numSecure++;
-                                    if (argListTok) {
-                                        argListTok = argListTok->nextArgument();
-                                    }
+                            }
+                            if (scanf_s) {
+                                numSecure++;
+                                if (argListTok) {
+                                    argListTok = argListTok->nextArgument();
                                 }
-                                done = true;
-                                break;
-                            case 'x':
-                            case 'X':
-                            case 'u':
-                            case 'o':
-                                specifier += *i;
-                                if (argInfo.typeToken->tokType() == Token::eString)
-                                    invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, true);
-                                else if (argInfo.isKnownType()) {
-                                    if (!Token::Match(argInfo.typeToken, "char|short|int|long")) {
-                                        if (argInfo.typeToken->isStandardType() || !argInfo.element)
-                                            invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, true);
-                                    } else if (!argInfo.typeToken->isUnsigned() ||
-                                               !argInfo.isArrayOrPointer() ||
-                                               argInfo.typeToken->strAt(-1) == "const") {
+                            }
+                            done = true;
+                            break;
+                        case 'x':
+                        case 'X':
+                        case 'u':
+                        case 'o':
+                            specifier += *i;
+                            if (argInfo.typeToken->tokType() == Token::eString)
+                                invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, true);
+                            else if (argInfo.isKnownType()) {
+                                if (!Token::Match(argInfo.typeToken, "char|short|int|long")) {
+                                    if (argInfo.typeToken->isStandardType() || !argInfo.element)
                                         invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, true);
-                                    } else {
-                                        switch (specifier[0]) {
-                                        case 'h':
-                                            if (specifier[1] == 'h') {
-                                                if (argInfo.typeToken->str() != "char")
-                                                    invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, true);
-                                            } else if (argInfo.typeToken->str() != "short")
+                                } else if (!argInfo.typeToken->isUnsigned() ||
+                                           !argInfo.isArrayOrPointer() ||
+                                           argInfo.typeToken->strAt(-1) == "const") {
+                                    invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, true);
+                                } else {
+                                    switch (specifier[0]) {
+                                    case 'h':
+                                        if (specifier[1] == 'h') {
+                                            if (argInfo.typeToken->str() != "char")
                                                 invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, true);
-                                            break;
-                                        case 'l':
-                                            if (specifier[1] == 'l') {
-                                                if (argInfo.typeToken->str() != "long" || !argInfo.typeToken->isLong())
-                                                    invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, true);
-                                                else if (typesMatch(argInfo.typeToken->originalName(), "size_t") ||
-                                                         typesMatch(argInfo.typeToken->originalName(), "ptrdiff_t") ||
-                                                         typesMatch(argInfo.typeToken->originalName(), "uintmax_t"))
-                                                    invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, true);
-                                            } else if (argInfo.typeToken->str() != "long" || argInfo.typeToken->isLong())
+                                        } else if (argInfo.typeToken->str() != "short")
+                                            invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, true);
+                                        break;
+                                    case 'l':
+                                        if (specifier[1] == 'l') {
+                                            if (argInfo.typeToken->str() != "long" || !argInfo.typeToken->isLong())
                                                 invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, true);
                                             else if (typesMatch(argInfo.typeToken->originalName(), "size_t") ||
                                                      typesMatch(argInfo.typeToken->originalName(), "ptrdiff_t") ||
                                                      typesMatch(argInfo.typeToken->originalName(), "uintmax_t"))
                                                 invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, true);
-                                            break;
-                                        case 'I':
-                                            if (specifier.find("I64") != std::string::npos) {
-                                                if (argInfo.typeToken->str() != "long" || !argInfo.typeToken->isLong())
-                                                    invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, true);
-                                            } else if (specifier.find("I32") != std::string::npos) {
-                                                if (argInfo.typeToken->str() != "int" || argInfo.typeToken->isLong())
-                                                    invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, true);
-                                            } else if (!typesMatch(argInfo.typeToken->originalName(), "size_t"))
-                                                invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, true);
-                                            break;
-                                        case 'j':
-                                            if (!typesMatch(argInfo.typeToken->originalName(), "uintmax_t"))
-                                                invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, true);
-                                            break;
-                                        case 'z':
-                                            if (!typesMatch(argInfo.typeToken->originalName(), "size_t"))
-                                                invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, true);
-                                            break;
-                                        case 't':
-                                            if (!typesMatch(argInfo.typeToken->originalName(), "ptrdiff_t"))
-                                                invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, true);
-                                            break;
-                                        case 'L':
+                                        } else if (argInfo.typeToken->str() != "long" || argInfo.typeToken->isLong())
+                                            invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, true);
+                                        else if (typesMatch(argInfo.typeToken->originalName(), "size_t") ||
+                                                 typesMatch(argInfo.typeToken->originalName(), "ptrdiff_t") ||
+                                                 typesMatch(argInfo.typeToken->originalName(), "uintmax_t"))
+                                            invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, true);
+                                        break;
+                                    case 'I':
+                                        if (specifier.find("I64") != std::string::npos) {
                                             if (argInfo.typeToken->str() != "long" || !argInfo.typeToken->isLong())
                                                 invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, true);
-                                            else if (typesMatch(argInfo.typeToken->originalName(), "size_t") ||
-                                                     typesMatch(argInfo.typeToken->originalName(), "uintmax_t"))
-                                                invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, true);
-                                            break;
-                                        default:
-                                            if (argInfo.typeToken->str() != "int")
-                                                invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, true);
-                                            else if (typesMatch(argInfo.typeToken->originalName(), "size_t") ||
-                                                     typesMatch(argInfo.typeToken->originalName(), "ptrdiff_t") ||
-                                                     typesMatch(argInfo.typeToken->originalName(), "uintmax_t"))
+                                        } else if (specifier.find("I32") != std::string::npos) {
+                                            if (argInfo.typeToken->str() != "int" || argInfo.typeToken->isLong())
                                                 invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, true);
-                                            break;
-                                        }
+                                        } else if (!typesMatch(argInfo.typeToken->originalName(), "size_t"))
+                                            invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, true);
+                                        break;
+                                    case 'j':
+                                        if (!typesMatch(argInfo.typeToken->originalName(), "uintmax_t"))
+                                            invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, true);
+                                        break;
+                                    case 'z':
+                                        if (!typesMatch(argInfo.typeToken->originalName(), "size_t"))
+                                            invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, true);
+                                        break;
+                                    case 't':
+                                        if (!typesMatch(argInfo.typeToken->originalName(), "ptrdiff_t"))
+                                            invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, true);
+                                        break;
+                                    case 'L':
+                                        if (argInfo.typeToken->str() != "long" || !argInfo.typeToken->isLong())
+                                            invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, true);
+                                        else if (typesMatch(argInfo.typeToken->originalName(), "size_t") ||
+                                                 typesMatch(argInfo.typeToken->originalName(), "uintmax_t"))
+                                            invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, true);
+                                        break;
+                                    default:
+                                        if (argInfo.typeToken->str() != "int")
+                                            invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, true);
+                                        else if (typesMatch(argInfo.typeToken->originalName(), "size_t") ||
+                                                 typesMatch(argInfo.typeToken->originalName(), "ptrdiff_t") ||
+                                                 typesMatch(argInfo.typeToken->originalName(), "uintmax_t"))
+                                            invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, true);
+                                        break;
                                     }
                                 }
-                                done = true;
-                                break;
-                            case 'n':
-                            case 'd':
-                            case 'i':
-                                specifier += *i;
-                                if (argInfo.typeToken->tokType() == Token::eString)
-                                    invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, false);
-                                else if (argInfo.isKnownType()) {
-                                    if (!Token::Match(argInfo.typeToken, "char|short|int|long")) {
-                                        if (argInfo.typeToken->isStandardType() || !argInfo.element)
-                                            invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, false);
-                                    } else if (argInfo.typeToken->isUnsigned() ||
-                                               !argInfo.isArrayOrPointer() ||
-                                               argInfo.typeToken->strAt(-1) == "const") {
+                            }
+                            done = true;
+                            break;
+                        case 'n':
+                        case 'd':
+                        case 'i':
+                            specifier += *i;
+                            if (argInfo.typeToken->tokType() == Token::eString)
+                                invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, false);
+                            else if (argInfo.isKnownType()) {
+                                if (!Token::Match(argInfo.typeToken, "char|short|int|long")) {
+                                    if (argInfo.typeToken->isStandardType() || !argInfo.element)
                                         invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, false);
-                                    } else {
-                                        switch (specifier[0]) {
-                                        case 'h':
-                                            if (specifier[1] == 'h') {
-                                                if (argInfo.typeToken->str() != "char")
-                                                    invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, false);
-                                            } else if (argInfo.typeToken->str() != "short")
+                                } else if (argInfo.typeToken->isUnsigned() ||
+                                           !argInfo.isArrayOrPointer() ||
+                                           argInfo.typeToken->strAt(-1) == "const") {
+                                    invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, false);
+                                } else {
+                                    switch (specifier[0]) {
+                                    case 'h':
+                                        if (specifier[1] == 'h') {
+                                            if (argInfo.typeToken->str() != "char")
                                                 invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, false);
-                                            break;
-                                        case 'l':
-                                            if (specifier[1] == 'l') {
-                                                if (argInfo.typeToken->str() != "long" || !argInfo.typeToken->isLong())
-                                                    invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, false);
-                                                else if (typesMatch(argInfo.typeToken->originalName(), "ptrdiff_t") ||
-                                                         typesMatch(argInfo.typeToken->originalName(), "intmax_t"))
-                                                    invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, false);
-                                            } else if (argInfo.typeToken->str() != "long" || argInfo.typeToken->isLong())
+                                        } else if (argInfo.typeToken->str() != "short")
+                                            invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, false);
+                                        break;
+                                    case 'l':
+                                        if (specifier[1] == 'l') {
+                                            if (argInfo.typeToken->str() != "long" || !argInfo.typeToken->isLong())
                                                 invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, false);
                                             else if (typesMatch(argInfo.typeToken->originalName(), "ptrdiff_t") ||
                                                      typesMatch(argInfo.typeToken->originalName(), "intmax_t"))
                                                 invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, false);
-                                            break;
-                                        case 'I':
-                                            if (specifier.find("I64") != std::string::npos) {
-                                                if (argInfo.typeToken->str() != "long" || !argInfo.typeToken->isLong())
-                                                    invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, false);
-                                            } else if (specifier.find("I32") != std::string::npos) {
-                                                if (argInfo.typeToken->str() != "int" || argInfo.typeToken->isLong())
-                                                    invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, false);
-                                            } else if (!typesMatch(argInfo.typeToken->originalName(), "ptrdiff_t"))
-                                                invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, false);
-                                            break;
-                                        case 'j':
-                                            if (!typesMatch(argInfo.typeToken->originalName(), "intmax_t"))
-                                                invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, false);
-                                            break;
-                                        case 'z':
-                                            if (!typesMatch(argInfo.typeToken->originalName(), "ssize_t"))
-                                                invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, false);
-                                            break;
-                                        case 't':
-                                            if (!typesMatch(argInfo.typeToken->originalName(), "ptrdiff_t"))
-                                                invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, false);
-                                            break;
-                                        case 'L':
+                                        } else if (argInfo.typeToken->str() != "long" || argInfo.typeToken->isLong())
+                                            invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, false);
+                                        else if (typesMatch(argInfo.typeToken->originalName(), "ptrdiff_t") ||
+                                                 typesMatch(argInfo.typeToken->originalName(), "intmax_t"))
+                                            invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, false);
+                                        break;
+                                    case 'I':
+                                        if (specifier.find("I64") != std::string::npos) {
                                             if (argInfo.typeToken->str() != "long" || !argInfo.typeToken->isLong())
                                                 invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, false);
-                                            break;
-                                        default:
-                                            if (argInfo.typeToken->str() != "int")
-                                                invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, false);
-                                            else if (typesMatch(argInfo.typeToken->originalName(), "ptrdiff_t") ||
-                                                     argInfo.typeToken->originalName() == "intmax_t")
+                                        } else if (specifier.find("I32") != std::string::npos) {
+                                            if (argInfo.typeToken->str() != "int" || argInfo.typeToken->isLong())
                                                 invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, false);
-                                            break;
-                                        }
+                                        } else if (!typesMatch(argInfo.typeToken->originalName(), "ptrdiff_t"))
+                                            invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, false);
+                                        break;
+                                    case 'j':
+                                        if (!typesMatch(argInfo.typeToken->originalName(), "intmax_t"))
+                                            invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, false);
+                                        break;
+                                    case 'z':
+                                        if (!typesMatch(argInfo.typeToken->originalName(), "ssize_t"))
+                                            invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, false);
+                                        break;
+                                    case 't':
+                                        if (!typesMatch(argInfo.typeToken->originalName(), "ptrdiff_t"))
+                                            invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, false);
+                                        break;
+                                    case 'L':
+                                        if (argInfo.typeToken->str() != "long" || !argInfo.typeToken->isLong())
+                                            invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, false);
+                                        break;
+                                    default:
+                                        if (argInfo.typeToken->str() != "int")
+                                            invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, false);
+                                        else if (typesMatch(argInfo.typeToken->originalName(), "ptrdiff_t") ||
+                                                 argInfo.typeToken->originalName() == "intmax_t")
+                                            invalidScanfArgTypeError_int(tok, numFormat, specifier, &argInfo, false);
+                                        break;
                                     }
                                 }
-                                done = true;
-                                break;
-                            case 'e':
-                            case 'E':
-                            case 'f':
-                            case 'g':
-                            case 'G':
-                            case 'a':
-                                specifier += *i;
-                                if (argInfo.typeToken->tokType() == Token::eString)
+                            }
+                            done = true;
+                            break;
+                        case 'e':
+                        case 'E':
+                        case 'f':
+                        case 'g':
+                        case 'G':
+                        case 'a':
+                            specifier += *i;
+                            if (argInfo.typeToken->tokType() == Token::eString)
+                                invalidScanfArgTypeError_float(tok, numFormat, specifier, &argInfo);
+                            else if (argInfo.isKnownType()) {
+                                if (!Token::Match(argInfo.typeToken, "float|double")) {
+                                    if (argInfo.typeToken->isStandardType())
+                                        invalidScanfArgTypeError_float(tok, numFormat, specifier, &argInfo);
+                                } else if (!argInfo.isArrayOrPointer() ||
+                                           argInfo.typeToken->strAt(-1) == "const") {
                                     invalidScanfArgTypeError_float(tok, numFormat, specifier, &argInfo);
-                                else if (argInfo.isKnownType()) {
-                                    if (!Token::Match(argInfo.typeToken, "float|double")) {
-                                        if (argInfo.typeToken->isStandardType())
+                                } else {
+                                    switch (specifier[0]) {
+                                    case 'l':
+                                        if (argInfo.typeToken->str() != "double" || argInfo.typeToken->isLong())
                                             invalidScanfArgTypeError_float(tok, numFormat, specifier, &argInfo);
-                                    } else if (!argInfo.isArrayOrPointer() ||
-                                               argInfo.typeToken->strAt(-1) == "const") {
-                                        invalidScanfArgTypeError_float(tok, numFormat, specifier, &argInfo);
-                                    } else {
-                                        switch (specifier[0]) {
-                                        case 'l':
-                                            if (argInfo.typeToken->str() != "double" || argInfo.typeToken->isLong())
-                                                invalidScanfArgTypeError_float(tok, numFormat, specifier, &argInfo);
-                                            break;
-                                        case 'L':
-                                            if (argInfo.typeToken->str() != "double" || !argInfo.typeToken->isLong())
-                                                invalidScanfArgTypeError_float(tok, numFormat, specifier, &argInfo);
-                                            break;
-                                        default:
-                                            if (argInfo.typeToken->str() != "float")
-                                                invalidScanfArgTypeError_float(tok, numFormat, specifier, &argInfo);
-                                            break;
-                                        }
+                                        break;
+                                    case 'L':
+                                        if (argInfo.typeToken->str() != "double" || !argInfo.typeToken->isLong())
+                                            invalidScanfArgTypeError_float(tok, numFormat, specifier, &argInfo);
+                                        break;
+                                    default:
+                                        if (argInfo.typeToken->str() != "float")
+                                            invalidScanfArgTypeError_float(tok, numFormat, specifier, &argInfo);
+                                        break;
                                     }
                                 }
-                                done = true;
-                                break;
-                            case 'I':
-                                if ((i+1 != formatString.end() && *(i+1) == '6' &&
-                                     i+2 != formatString.end() && *(i+2) == '4') ||
-                                    (i+1 != formatString.end() && *(i+1) == '3' &&
-                                     i+2 != formatString.end() && *(i+2) == '2')) {
-                                    specifier += *i++;
-                                    specifier += *i++;
-                                    if ((i+1) != formatString.end() && !isalpha(*(i+1))) {
-                                        specifier += *i;
-                                        invalidLengthModifierError(tok, numFormat, specifier);
-                                        done = true;
-                                    } else {
-                                        specifier += *i++;
-                                    }
+                            }
+                            done = true;
+                            break;
+                        case 'I':
+                            if ((i+1 != formatString.end() && *(i+1) == '6' &&
+                                 i+2 != formatString.end() && *(i+2) == '4') ||
+                                (i+1 != formatString.end() && *(i+1) == '3' &&
+                                 i+2 != formatString.end() && *(i+2) == '2')) {
+                                specifier += *i++;
+                                specifier += *i++;
+                                if ((i+1) != formatString.end() && !isalpha(*(i+1))) {
+                                    specifier += *i;
+                                    invalidLengthModifierError(tok, numFormat, specifier);
+                                    done = true;
                                 } else {
-                                    if ((i+1) != formatString.end() && !isalpha(*(i+1))) {
-                                        specifier += *i;
-                                        invalidLengthModifierError(tok, numFormat, specifier);
-                                        done = true;
-                                    } else {
-                                        specifier += *i++;
-                                    }
-                                }
-                                break;
-                            case 'h':
-                            case 'l':
-                                if (i+1 != formatString.end() && *(i+1) == *i)
                                     specifier += *i++;
-                            // fallthrough
-                            case 'j':
-                            case 'q':
-                            case 't':
-                            case 'z':
-                            case 'L':
-                                // Expect an alphabetical character after these specifiers
-                                if (i != formatString.end() && !isalpha(*(i+1))) {
+                                }
+                            } else {
+                                if ((i+1) != formatString.end() && !isalpha(*(i+1))) {
                                     specifier += *i;
                                     invalidLengthModifierError(tok, numFormat, specifier);
                                     done = true;
                                 } else {
                                     specifier += *i++;
                                 }
-                                break;
-                            default:
+                            }
+                            break;
+                        case 'h':
+                        case 'l':
+                            if (i+1 != formatString.end() && *(i+1) == *i)
+                                specifier += *i++;
+                        // fallthrough
+                        case 'j':
+                        case 'q':
+                        case 't':
+                        case 'z':
+                        case 'L':
+                            // Expect an alphabetical character after these specifiers
+                            if (i != formatString.end() && !isalpha(*(i+1))) {
+                                specifier += *i;
+                                invalidLengthModifierError(tok, numFormat, specifier);
                                 done = true;
-                                break;
+                            } else {
+                                specifier += *i++;
                             }
+                            break;
+                        default:
+                            done = true;
+                            break;
                         }
-                    } else if (printWarning) {
-                        std::string specifier;
-                        bool done = false;
-                        while (!done) {
-                            switch (*i) {
-                            case 's':
-                                if (argListTok->tokType() != Token::eString &&
-                                    argInfo.isKnownType() && !argInfo.isArrayOrPointer()) {
-                                    if (!Token::Match(argInfo.typeToken, "char|wchar_t")) {
-                                        if (!(!argInfo.isArrayOrPointer() && argInfo.element))
-                                            invalidPrintfArgTypeError_s(tok, numFormat, &argInfo);
-                                    }
+                    }
+                } else if (printWarning) {
+                    std::string specifier;
+                    bool done = false;
+                    while (!done) {
+                        switch (*i) {
+                        case 's':
+                            if (argListTok->tokType() != Token::eString &&
+                                argInfo.isKnownType() && !argInfo.isArrayOrPointer()) {
+                                if (!Token::Match(argInfo.typeToken, "char|wchar_t")) {
+                                    if (!(!argInfo.isArrayOrPointer() && argInfo.element))
+                                        invalidPrintfArgTypeError_s(tok, numFormat, &argInfo);
                                 }
-                                done = true;
-                                break;
-                            case 'n':
-                                if ((argInfo.isKnownType() && (!argInfo.isArrayOrPointer() || argInfo.typeToken->strAt(-1) == "const")) || argListTok->tokType() == Token::eString)
-                                    invalidPrintfArgTypeError_n(tok, numFormat, &argInfo);
-                                done = true;
-                                break;
-                            case 'c':
-                            case 'x':
-                            case 'X':
-                            case 'o':
-                                specifier += *i;
-                                if (argInfo.typeToken->tokType() == Token::eString)
-                                    invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                else if (argInfo.isArrayOrPointer() && !argInfo.element) {
-                                    // use %p on pointers and arrays
-                                    invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                } else if (argInfo.isKnownType()) {
-                                    if (!Token::Match(argInfo.typeToken, "bool|short|long|int|char|wchar_t")) {
-                                        if (!(!argInfo.isArrayOrPointer() && argInfo.element))
-                                            invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                    } else {
-                                        switch (specifier[0]) {
-                                        case 'h':
-                                            if (specifier[1] == 'h') {
-                                                if (!(argInfo.typeToken->str() == "char" && argInfo.typeToken->isUnsigned()))
-                                                    invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                            } else if (!(argInfo.typeToken->str() == "short" && argInfo.typeToken->isUnsigned()))
+                            }
+                            done = true;
+                            break;
+                        case 'n':
+                            if ((argInfo.isKnownType() && (!argInfo.isArrayOrPointer() || argInfo.typeToken->strAt(-1) == "const")) || argListTok->tokType() == Token::eString)
+                                invalidPrintfArgTypeError_n(tok, numFormat, &argInfo);
+                            done = true;
+                            break;
+                        case 'c':
+                        case 'x':
+                        case 'X':
+                        case 'o':
+                            specifier += *i;
+                            if (argInfo.typeToken->tokType() == Token::eString)
+                                invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
+                            else if (argInfo.isArrayOrPointer() && !argInfo.element) {
+                                // use %p on pointers and arrays
+                                invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
+                            } else if (argInfo.isKnownType()) {
+                                if (!Token::Match(argInfo.typeToken, "bool|short|long|int|char|wchar_t")) {
+                                    if (!(!argInfo.isArrayOrPointer() && argInfo.element))
+                                        invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
+                                } else {
+                                    switch (specifier[0]) {
+                                    case 'h':
+                                        if (specifier[1] == 'h') {
+                                            if (!(argInfo.typeToken->str() == "char" && argInfo.typeToken->isUnsigned()))
                                                 invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                            break;
-                                        case 'l':
-                                            if (specifier[1] == 'l') {
-                                                if (argInfo.typeToken->str() != "long" || !argInfo.typeToken->isLong())
-                                                    invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                                else if (typesMatch(argInfo.typeToken->originalName(), "size_t") ||
-                                                         argInfo.typeToken->originalName() == "uintmax_t")
-                                                    invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                            } else if (argInfo.typeToken->str() != "long" || argInfo.typeToken->isLong())
+                                        } else if (!(argInfo.typeToken->str() == "short" && argInfo.typeToken->isUnsigned()))
+                                            invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
+                                        break;
+                                    case 'l':
+                                        if (specifier[1] == 'l') {
+                                            if (argInfo.typeToken->str() != "long" || !argInfo.typeToken->isLong())
                                                 invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
                                             else if (typesMatch(argInfo.typeToken->originalName(), "size_t") ||
                                                      argInfo.typeToken->originalName() == "uintmax_t")
                                                 invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                            break;
-                                        case 'j':
-                                            if (argInfo.typeToken->originalName() != "uintmax_t")
-                                                invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                            break;
-                                        case 'z':
-                                            if (!typesMatch(argInfo.typeToken->originalName(), "size_t"))
-                                                invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                            break;
-                                        case 't':
-                                            if (!typesMatch(argInfo.typeToken->originalName(), "ptrdiff_t"))
-                                                invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                            break;
-                                        case 'I':
-                                            if (specifier.find("I64") != std::string::npos) {
-                                                if (argInfo.typeToken->str() != "long" || !argInfo.typeToken->isLong())
-                                                    invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                            } else if (specifier.find("I32") != std::string::npos) {
-                                                if (argInfo.typeToken->str() != "int" || argInfo.typeToken->isLong())
-                                                    invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                            } else if (!(typesMatch(argInfo.typeToken->originalName(), "size_t") ||
-                                                         argInfo.typeToken->originalName() == "WPARAM" ||
-                                                         argInfo.typeToken->originalName() == "UINT_PTR" ||
-                                                         argInfo.typeToken->originalName() == "LONG_PTR" ||
-                                                         argInfo.typeToken->originalName() == "LPARAM" ||
-                                                         argInfo.typeToken->originalName() == "LRESULT"))
+                                        } else if (argInfo.typeToken->str() != "long" || argInfo.typeToken->isLong())
+                                            invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
+                                        else if (typesMatch(argInfo.typeToken->originalName(), "size_t") ||
+                                                 argInfo.typeToken->originalName() == "uintmax_t")
+                                            invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
+                                        break;
+                                    case 'j':
+                                        if (argInfo.typeToken->originalName() != "uintmax_t")
+                                            invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
+                                        break;
+                                    case 'z':
+                                        if (!typesMatch(argInfo.typeToken->originalName(), "size_t"))
+                                            invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
+                                        break;
+                                    case 't':
+                                        if (!typesMatch(argInfo.typeToken->originalName(), "ptrdiff_t"))
+                                            invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
+                                        break;
+                                    case 'I':
+                                        if (specifier.find("I64") != std::string::npos) {
+                                            if (argInfo.typeToken->str() != "long" || !argInfo.typeToken->isLong())
                                                 invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                            break;
-                                        default:
-                                            if (!Token::Match(argInfo.typeToken, "bool|char|short|wchar_t|int"))
+                                        } else if (specifier.find("I32") != std::string::npos) {
+                                            if (argInfo.typeToken->str() != "int" || argInfo.typeToken->isLong())
                                                 invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                            break;
-                                        }
+                                        } else if (!(typesMatch(argInfo.typeToken->originalName(), "size_t") ||
+                                                     argInfo.typeToken->originalName() == "WPARAM" ||
+                                                     argInfo.typeToken->originalName() == "UINT_PTR" ||
+                                                     argInfo.typeToken->originalName() == "LONG_PTR" ||
+                                                     argInfo.typeToken->originalName() == "LPARAM" ||
+                                                     argInfo.typeToken->originalName() == "LRESULT"))
+                                            invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
+                                        break;
+                                    default:
+                                        if (!Token::Match(argInfo.typeToken, "bool|char|short|wchar_t|int"))
+                                            invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
+                                        break;
                                     }
                                 }
-                                done = true;
-                                break;
-                            case 'd':
-                            case 'i':
-                                specifier += *i;
-                                if (argInfo.typeToken->tokType() == Token::eString) {
-                                    invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
-                                } else if (argInfo.isArrayOrPointer() && !argInfo.element) {
-                                    // use %p on pointers and arrays
-                                    invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
-                                } else if (argInfo.isKnownType()) {
-                                    if (argInfo.typeToken->isUnsigned() && !Token::Match(argInfo.typeToken, "char|short")) {
-                                        if (!(!argInfo.isArrayOrPointer() && argInfo.element))
-                                            invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
-                                    } else if (!Token::Match(argInfo.typeToken, "bool|char|short|int|long")) {
-                                        if (!(!argInfo.isArrayOrPointer() && argInfo.element))
-                                            invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
-                                    } else {
-                                        switch (specifier[0]) {
-                                        case 'h':
-                                            if (specifier[1] == 'h') {
-                                                if (!(argInfo.typeToken->str() == "char" && !argInfo.typeToken->isUnsigned()))
-                                                    invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
-                                            } else if (!(argInfo.typeToken->str() == "short" && !argInfo.typeToken->isUnsigned()))
+                            }
+                            done = true;
+                            break;
+                        case 'd':
+                        case 'i':
+                            specifier += *i;
+                            if (argInfo.typeToken->tokType() == Token::eString) {
+                                invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
+                            } else if (argInfo.isArrayOrPointer() && !argInfo.element) {
+                                // use %p on pointers and arrays
+                                invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
+                            } else if (argInfo.isKnownType()) {
+                                if (argInfo.typeToken->isUnsigned() && !Token::Match(argInfo.typeToken, "char|short")) {
+                                    if (!(!argInfo.isArrayOrPointer() && argInfo.element))
+                                        invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
+                                } else if (!Token::Match(argInfo.typeToken, "bool|char|short|int|long")) {
+                                    if (!(!argInfo.isArrayOrPointer() && argInfo.element))
+                                        invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
+                                } else {
+                                    switch (specifier[0]) {
+                                    case 'h':
+                                        if (specifier[1] == 'h') {
+                                            if (!(argInfo.typeToken->str() == "char" && !argInfo.typeToken->isUnsigned()))
                                                 invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
-                                            break;
-                                        case 'l':
-                                            if (specifier[1] == 'l') {
-                                                if (argInfo.typeToken->str() != "long" || !argInfo.typeToken->isLong())
-                                                    invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
-                                                else if (typesMatch(argInfo.typeToken->originalName(), "ptrdiff_t") ||
-                                                         argInfo.typeToken->originalName() == "intmax_t")
-                                                    invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
-                                            } else if (argInfo.typeToken->str() != "long" || argInfo.typeToken->isLong())
+                                        } else if (!(argInfo.typeToken->str() == "short" && !argInfo.typeToken->isUnsigned()))
+                                            invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
+                                        break;
+                                    case 'l':
+                                        if (specifier[1] == 'l') {
+                                            if (argInfo.typeToken->str() != "long" || !argInfo.typeToken->isLong())
                                                 invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
                                             else if (typesMatch(argInfo.typeToken->originalName(), "ptrdiff_t") ||
                                                      argInfo.typeToken->originalName() == "intmax_t")
                                                 invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
-                                            break;
-                                        case 'j':
-                                            if (argInfo.typeToken->originalName() != "intmax_t")
-                                                invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
-                                            break;
-                                        case 't':
-                                            if (!typesMatch(argInfo.typeToken->originalName(), "ptrdiff_t"))
-                                                invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
-                                            break;
-                                        case 'I':
-                                            if (specifier.find("I64") != std::string::npos) {
-                                                if (argInfo.typeToken->str() != "long" || !argInfo.typeToken->isLong())
-                                                    invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
-                                            } else if (specifier.find("I32") != std::string::npos) {
-                                                if (argInfo.typeToken->str() != "int" || argInfo.typeToken->isLong())
-                                                    invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
-                                            } else if (!typesMatch(argInfo.typeToken->originalName(), "ptrdiff_t"))
-                                                invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
-                                            break;
-                                        case 'z':
-                                            if (!typesMatch(argInfo.typeToken->originalName(), "ssize_t"))
-                                                invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
-                                            break;
-                                        case 'L':
+                                        } else if (argInfo.typeToken->str() != "long" || argInfo.typeToken->isLong())
+                                            invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
+                                        else if (typesMatch(argInfo.typeToken->originalName(), "ptrdiff_t") ||
+                                                 argInfo.typeToken->originalName() == "intmax_t")
+                                            invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
+                                        break;
+                                    case 'j':
+                                        if (argInfo.typeToken->originalName() != "intmax_t")
+                                            invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
+                                        break;
+                                    case 't':
+                                        if (!typesMatch(argInfo.typeToken->originalName(), "ptrdiff_t"))
+                                            invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
+                                        break;
+                                    case 'I':
+                                        if (specifier.find("I64") != std::string::npos) {
                                             if (argInfo.typeToken->str() != "long" || !argInfo.typeToken->isLong())
                                                 invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
-                                            break;
-                                        default:
-                                            if (!Token::Match(argInfo.typeToken, "bool|char|short|int"))
-                                                invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
-                                            else if (typesMatch(argInfo.typeToken->originalName(), "ptrdiff_t") ||
-                                                     argInfo.typeToken->originalName() == "intmax_t")
+                                        } else if (specifier.find("I32") != std::string::npos) {
+                                            if (argInfo.typeToken->str() != "int" || argInfo.typeToken->isLong())
                                                 invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
-                                            break;
-                                        }
+                                        } else if (!typesMatch(argInfo.typeToken->originalName(), "ptrdiff_t"))
+                                            invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
+                                        break;
+                                    case 'z':
+                                        if (!typesMatch(argInfo.typeToken->originalName(), "ssize_t"))
+                                            invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
+                                        break;
+                                    case 'L':
+                                        if (argInfo.typeToken->str() != "long" || !argInfo.typeToken->isLong())
+                                            invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
+                                        break;
+                                    default:
+                                        if (!Token::Match(argInfo.typeToken, "bool|char|short|int"))
+                                            invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
+                                        else if (typesMatch(argInfo.typeToken->originalName(), "ptrdiff_t") ||
+                                                 argInfo.typeToken->originalName() == "intmax_t")
+                                            invalidPrintfArgTypeError_sint(tok, numFormat, specifier, &argInfo);
+                                        break;
                                     }
                                 }
-                                done = true;
-                                break;
-                            case 'u':
-                                specifier += *i;
-                                if (argInfo.typeToken->tokType() == Token::eString) {
-                                    invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                } else if (argInfo.isArrayOrPointer() && !argInfo.element) {
-                                    // use %p on pointers and arrays
-                                    invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                } else if (argInfo.isKnownType()) {
-                                    if (!argInfo.typeToken->isUnsigned() && !Token::Match(argInfo.typeToken, "bool|_Bool")) {
-                                        if (!(!argInfo.isArrayOrPointer() && argInfo.element))
-                                            invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                    } else if (!Token::Match(argInfo.typeToken, "bool|char|short|long|int")) {
-                                        if (!(!argInfo.isArrayOrPointer() && argInfo.element))
-                                            invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                    } else {
-                                        switch (specifier[0]) {
-                                        case 'h':
-                                            if (specifier[1] == 'h') {
-                                                if (!(argInfo.typeToken->str() == "char" && argInfo.typeToken->isUnsigned()))
-                                                    invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                            } else if (!(argInfo.typeToken->str() == "short" && argInfo.typeToken->isUnsigned()))
+                            }
+                            done = true;
+                            break;
+                        case 'u':
+                            specifier += *i;
+                            if (argInfo.typeToken->tokType() == Token::eString) {
+                                invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
+                            } else if (argInfo.isArrayOrPointer() && !argInfo.element) {
+                                // use %p on pointers and arrays
+                                invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
+                            } else if (argInfo.isKnownType()) {
+                                if (!argInfo.typeToken->isUnsigned() && !Token::Match(argInfo.typeToken, "bool|_Bool")) {
+                                    if (!(!argInfo.isArrayOrPointer() && argInfo.element))
+                                        invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
+                                } else if (!Token::Match(argInfo.typeToken, "bool|char|short|long|int")) {
+                                    if (!(!argInfo.isArrayOrPointer() && argInfo.element))
+                                        invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
+                                } else {
+                                    switch (specifier[0]) {
+                                    case 'h':
+                                        if (specifier[1] == 'h') {
+                                            if (!(argInfo.typeToken->str() == "char" && argInfo.typeToken->isUnsigned()))
                                                 invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                            break;
-                                        case 'l':
-                                            if (specifier[1] == 'l') {
-                                                if (argInfo.typeToken->str() != "long" || !argInfo.typeToken->isLong())
-                                                    invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                                else if (typesMatch(argInfo.typeToken->originalName(), "size_t") ||
-                                                         argInfo.typeToken->originalName() == "uintmax_t")
-                                                    invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                            } else if (argInfo.typeToken->str() != "long" || argInfo.typeToken->isLong())
+                                        } else if (!(argInfo.typeToken->str() == "short" && argInfo.typeToken->isUnsigned()))
+                                            invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
+                                        break;
+                                    case 'l':
+                                        if (specifier[1] == 'l') {
+                                            if (argInfo.typeToken->str() != "long" || !argInfo.typeToken->isLong())
                                                 invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
                                             else if (typesMatch(argInfo.typeToken->originalName(), "size_t") ||
                                                      argInfo.typeToken->originalName() == "uintmax_t")
                                                 invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                            break;
-                                        case 'j':
-                                            if (argInfo.typeToken->originalName() != "uintmax_t")
-                                                invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                            break;
-                                        case 'z':
-                                            if (!typesMatch(argInfo.typeToken->originalName(), "size_t"))
-                                                invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                            break;
-                                        case 't':
-                                            if (!typesMatch(argInfo.typeToken->originalName(), "ptrdiff_t"))
-                                                invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                            break;
-                                        case 'I':
-                                            if (specifier.find("I64") != std::string::npos) {
-                                                if (argInfo.typeToken->str() != "long" || !argInfo.typeToken->isLong())
-                                                    invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                            } else if (specifier.find("I32") != std::string::npos) {
-                                                if (argInfo.typeToken->str() != "int" || argInfo.typeToken->isLong())
-                                                    invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                            } else if (!typesMatch(argInfo.typeToken->originalName(), "size_t"))
-                                                invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                            break;
-                                        case 'L':
+                                        } else if (argInfo.typeToken->str() != "long" || argInfo.typeToken->isLong())
+                                            invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
+                                        else if (typesMatch(argInfo.typeToken->originalName(), "size_t") ||
+                                                 argInfo.typeToken->originalName() == "uintmax_t")
+                                            invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
+                                        break;
+                                    case 'j':
+                                        if (argInfo.typeToken->originalName() != "uintmax_t")
+                                            invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
+                                        break;
+                                    case 'z':
+                                        if (!typesMatch(argInfo.typeToken->originalName(), "size_t"))
+                                            invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
+                                        break;
+                                    case 't':
+                                        if (!typesMatch(argInfo.typeToken->originalName(), "ptrdiff_t"))
+                                            invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
+                                        break;
+                                    case 'I':
+                                        if (specifier.find("I64") != std::string::npos) {
                                             if (argInfo.typeToken->str() != "long" || !argInfo.typeToken->isLong())
                                                 invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                            break;
-                                        default:
-                                            if (!Token::Match(argInfo.typeToken, "bool|char|short|int"))
+                                        } else if (specifier.find("I32") != std::string::npos) {
+                                            if (argInfo.typeToken->str() != "int" || argInfo.typeToken->isLong())
                                                 invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                            else if (typesMatch(argInfo.typeToken->originalName(), "size_t") ||
-                                                     argInfo.typeToken->originalName() == "intmax_t")
-                                                invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
-                                            break;
-                                        }
+                                        } else if (!typesMatch(argInfo.typeToken->originalName(), "size_t"))
+                                            invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
+                                        break;
+                                    case 'L':
+                                        if (argInfo.typeToken->str() != "long" || !argInfo.typeToken->isLong())
+                                            invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
+                                        break;
+                                    default:
+                                        if (!Token::Match(argInfo.typeToken, "bool|char|short|int"))
+                                            invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
+                                        else if (typesMatch(argInfo.typeToken->originalName(), "size_t") ||
+                                                 argInfo.typeToken->originalName() == "intmax_t")
+                                            invalidPrintfArgTypeError_uint(tok, numFormat, specifier, &argInfo);
+                                        break;
                                     }
                                 }
-                                done = true;
-                                break;
-                            case 'p':
-                                if (argInfo.typeToken->tokType() == Token::eString)
-                                    ;// string literals are passed as pointers to literal start, okay
-                                else if (argInfo.isKnownType() && !argInfo.isArrayOrPointer())
-                                    invalidPrintfArgTypeError_p(tok, numFormat, &argInfo);
-                                done = true;
-                                break;
-                            case 'e':
-                            case 'E':
-                            case 'f':
-                            case 'g':
-                            case 'G':
-                                specifier += *i;
-                                if (argInfo.typeToken->tokType() == Token::eString)
-                                    invalidPrintfArgTypeError_float(tok, numFormat, specifier, &argInfo);
-                                else if (argInfo.isArrayOrPointer() && !argInfo.element) {
-                                    // use %p on pointers and arrays
-                                    invalidPrintfArgTypeError_float(tok, numFormat, specifier, &argInfo);
-                                } else if (argInfo.isKnownType()) {
-                                    if (!Token::Match(argInfo.typeToken, "float|double")) {
-                                        if (!(!argInfo.isArrayOrPointer() && argInfo.element))
-                                            invalidPrintfArgTypeError_float(tok, numFormat, specifier, &argInfo);
-                                    } else if ((specifier[0] == 'L' && (!argInfo.typeToken->isLong() || argInfo.typeToken->str() != "double")) ||
-                                               (specifier[0] != 'L' && argInfo.typeToken->isLong()))
+                            }
+                            done = true;
+                            break;
+                        case 'p':
+                            if (argInfo.typeToken->tokType() == Token::eString)
+                                ;// string literals are passed as pointers to literal start, okay
+                            else if (argInfo.isKnownType() && !argInfo.isArrayOrPointer())
+                                invalidPrintfArgTypeError_p(tok, numFormat, &argInfo);
+                            done = true;
+                            break;
+                        case 'e':
+                        case 'E':
+                        case 'f':
+                        case 'g':
+                        case 'G':
+                            specifier += *i;
+                            if (argInfo.typeToken->tokType() == Token::eString)
+                                invalidPrintfArgTypeError_float(tok, numFormat, specifier, &argInfo);
+                            else if (argInfo.isArrayOrPointer() && !argInfo.element) {
+                                // use %p on pointers and arrays
+                                invalidPrintfArgTypeError_float(tok, numFormat, specifier, &argInfo);
+                            } else if (argInfo.isKnownType()) {
+                                if (!Token::Match(argInfo.typeToken, "float|double")) {
+                                    if (!(!argInfo.isArrayOrPointer() && argInfo.element))
                                         invalidPrintfArgTypeError_float(tok, numFormat, specifier, &argInfo);
+                                } else if ((specifier[0] == 'L' && (!argInfo.typeToken->isLong() || argInfo.typeToken->str() != "double")) ||
+                                           (specifier[0] != 'L' && argInfo.typeToken->isLong()))
+                                    invalidPrintfArgTypeError_float(tok, numFormat, specifier, &argInfo);
+                            }
+                            done = true;
+                            break;
+                        case 'h': // Can be 'hh' (signed char or unsigned char) or 'h' (short int or unsigned short int)
+                        case 'l': { // Can be 'll' (long long int or unsigned long long int) or 'l' (long int or unsigned long int)
+                            // If the next character is the same (which makes 'hh' or 'll') then expect another alphabetical character
+                            const bool isSecondCharAvailable = ((i + 1) != formatString.end());
+                            if (i != formatString.end() && isSecondCharAvailable && *(i + 1) == *i) {
+                                if (!isalpha(*(i + 2))) {
+                                    std::string modifier;
+                                    modifier += *i;
+                                    modifier += *(i + 1);
+                                    invalidLengthModifierError(tok, numFormat, modifier);
+                                    done = true;
+                                } else {
+                                    specifier = *i++;
+                                    specifier += *i++;
                                 }
-                                done = true;
-                                break;
-                            case 'h': // Can be 'hh' (signed char or unsigned char) or 'h' (short int or unsigned short int)
-                            case 'l': { // Can be 'll' (long long int or unsigned long long int) or 'l' (long int or unsigned long int)
-                                // If the next character is the same (which makes 'hh' or 'll') then expect another alphabetical character
-                                const bool isSecondCharAvailable = ((i + 1) != formatString.end());
-                                if (i != formatString.end() && isSecondCharAvailable && *(i + 1) == *i) {
-                                    if (!isalpha(*(i + 2))) {
+                            } else {
+                                if (i != formatString.end()) {
+                                    if ((i + 1) != formatString.end() && !isalpha(*(i + 1))) {
                                         std::string modifier;
                                         modifier += *i;
-                                        modifier += *(i + 1);
                                         invalidLengthModifierError(tok, numFormat, modifier);
                                         done = true;
                                     } else {
                                         specifier = *i++;
-                                        specifier += *i++;
                                     }
                                 } else {
-                                    if (i != formatString.end()) {
-                                        if ((i + 1) != formatString.end() && !isalpha(*(i + 1))) {
-                                            std::string modifier;
-                                            modifier += *i;
-                                            invalidLengthModifierError(tok, numFormat, modifier);
-                                            done = true;
-                                        } else {
-                                            specifier = *i++;
-                                        }
-                                    } else {
-                                        done = true;
-                                    }
-                                }
-                            }
-                            break;
-                            case 'I': // Microsoft extension: I for size_t and ptrdiff_t, I32 for __int32, and I64 for __int64
-                                if ((*(i+1) == '3' && *(i+2) == '2') ||
-                                    (*(i+1) == '6' && *(i+2) == '4')) {
-                                    specifier += *i++;
-                                    specifier += *i++;
-                                }
-                            // fallthrough
-                            case 'j': // intmax_t or uintmax_t
-                            case 'z': // size_t
-                            case 't': // ptrdiff_t
-                            case 'L': // long double
-                                // Expect an alphabetical character after these specifiers
-                                if (i != formatString.end() && !isalpha(*(i+1))) {
-                                    specifier += *i;
-                                    invalidLengthModifierError(tok, numFormat, specifier);
                                     done = true;
-                                } else {
-                                    specifier += *i++;
                                 }
-                                break;
-                            default:
+                            }
+                        }
+                        break;
+                        case 'I': // Microsoft extension: I for size_t and ptrdiff_t, I32 for __int32, and I64 for __int64
+                            if ((*(i+1) == '3' && *(i+2) == '2') ||
+                                (*(i+1) == '6' && *(i+2) == '4')) {
+                                specifier += *i++;
+                                specifier += *i++;
+                            }
+                        // fallthrough
+                        case 'j': // intmax_t or uintmax_t
+                        case 'z': // size_t
+                        case 't': // ptrdiff_t
+                        case 'L': // long double
+                            // Expect an alphabetical character after these specifiers
+                            if (i != formatString.end() && !isalpha(*(i+1))) {
+                                specifier += *i;
+                                invalidLengthModifierError(tok, numFormat, specifier);
                                 done = true;
-                                break;
+                            } else {
+                                specifier += *i++;
                             }
+                            break;
+                        default:
+                            done = true;
+                            break;
                         }
                     }
                 }
-
-                if (argListTok)
-                    argListTok = argListTok->nextArgument(); // Find next argument
             }
+
+            if (argListTok)
+                argListTok = argListTok->nextArgument(); // Find next argument
         }
     }
 
@@ -101,6 +101,19 @@ void VarInfo::possibleUsageAll(const std::string &functionName)
 }
 
 
+const Library::AllocFunc* CheckLeakAutoVar::libAlloc(const Token* tok) const
+{
+    const Library::Annotation *annotation = mTokenizer->libraryAnnotation(tok);
+    return annotation ? annotation->allocFunc : nullptr;
+}
+
+const Library::AllocFunc* CheckLeakAutoVar::libDealloc(const Token* tok) const
+{
+    const Library::Annotation *annotation = mTokenizer->libraryAnnotation(tok);
+    return annotation ? annotation->deallocFunc : nullptr;
+}
+
+
 void CheckLeakAutoVar::leakError(const Token *tok, const std::string &varname, int type)
 {
     const CheckMemoryLeak checkmemleak(mTokenizer, mErrorLogger, mSettings);
@@ -332,7 +345,7 @@ void CheckLeakAutoVar::checkScope(const Token * const startToken,
 
             // allocation?
             if (tokRightAstOperand && Token::Match(tokRightAstOperand->previous(), "%type% (")) {
-                const Library::AllocFunc* f = mSettings->library.alloc(tokRightAstOperand->previous());
+                const Library::AllocFunc* f = libAlloc(tokRightAstOperand->previous());
                 if (f && f->arg == -1) {
                     VarInfo::AllocInfo& varAlloc = alloctype[varTok->varId()];
                     varAlloc.type = f->groupId;
@@ -367,7 +380,7 @@ void CheckLeakAutoVar::checkScope(const Token * const startToken,
                 if (Token::Match(innerTok, "%var% =") && innerTok->astParent() == innerTok->next()) {
                     // allocation?
                     if (Token::Match(innerTok->tokAt(2), "%type% (")) {
-                        const Library::AllocFunc* f = mSettings->library.alloc(innerTok->tokAt(2));
+                        const Library::AllocFunc* f = libAlloc(innerTok->tokAt(2));
                         if (f && f->arg == -1) {
                             VarInfo::AllocInfo& varAlloc = alloctype[innerTok->varId()];
                             varAlloc.type = f->groupId;
@@ -541,7 +554,7 @@ void CheckLeakAutoVar::checkScope(const Token * const startToken,
         // Function call..
         else if (isFunctionCall(ftok)) {
             const Token * openingPar = isFunctionCall(ftok);
-            const Library::AllocFunc* af = mSettings->library.dealloc(ftok);
+            const Library::AllocFunc* af = libDealloc(ftok);
             VarInfo::AllocInfo allocation(af ? af->groupId : 0, VarInfo::DEALLOC);
             if (allocation.type == 0)
                 allocation.status = VarInfo::NOALLOC;
@@ -627,7 +640,7 @@ void CheckLeakAutoVar::checkScope(const Token * const startToken,
                 // Check if its a pointer to a function
                 const Token * dtok = Token::findmatch(deleterToken, "& %name%", endDeleterToken);
                 if (dtok) {
-                    af = mSettings->library.dealloc(dtok->tokAt(1));
+                    af = libDealloc(dtok->tokAt(1));
                 } else {
                     const Token * tscopeStart = nullptr;
                     const Token * tscopeEnd = nullptr;
@@ -649,7 +662,7 @@ void CheckLeakAutoVar::checkScope(const Token * const startToken,
 
                     if (tscopeStart && tscopeEnd) {
                         for (const Token *tok2 = tscopeStart; tok2 != tscopeEnd; tok2 = tok2->next()) {
-                            af = mSettings->library.dealloc(tok2);
+                            af = libDealloc(tok2);
                             if (af)
                                 break;
                         }
@@ -688,7 +701,7 @@ const Token * CheckLeakAutoVar::checkTokenInsideExpression(const Token * const t
     // check for function call
     const Token * const openingPar = isFunctionCall(tok);
     if (openingPar) {
-        const Library::AllocFunc* allocFunc = mSettings->library.dealloc(tok);
+        const Library::AllocFunc* allocFunc = libDealloc(tok);
         VarInfo::AllocInfo alloc(allocFunc ? allocFunc->groupId : 0, VarInfo::DEALLOC);
         if (alloc.type == 0)
             alloc.status = VarInfo::NOALLOC;
@@ -785,14 +798,14 @@ void CheckLeakAutoVar::functionCall(const Token *tokName, const Token *tokOpenin
                 // Check if its a pointer to a function
                 const Token * dtok = Token::findmatch(deleterToken, "& %name%", endDeleterToken);
                 if (dtok) {
-                    sp_af = mSettings->library.dealloc(dtok->tokAt(1));
+                    sp_af = libDealloc(dtok->tokAt(1));
                 } else {
                     // If the deleter is a class, check if class calls the dealloc function
                     dtok = Token::findmatch(deleterToken, "%type%", endDeleterToken);
                     if (dtok && dtok->type()) {
                         const Scope * tscope = dtok->type()->classScope;
                         for (const Token *tok2 = tscope->bodyStart; tok2 != tscope->bodyEnd; tok2 = tok2->next()) {
-                            sp_af = mSettings->library.dealloc(tok2);
+                            sp_af = libDealloc(tok2);
                             if (sp_af)
                                 break;
                         }
@@ -103,6 +103,11 @@ public:
         : Check(myName(), tokenizer, settings, errorLogger) {
     }
 
+    /** @brief Create a bound instance, see Check::createInstance() */
+    Check *createInstance(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) const OVERRIDE {
+        return new CheckLeakAutoVar(tokenizer, settings, errorLogger);
+    }
+
     /** @brief Run checks against the simplified token list */
     void runSimplifiedChecks(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) OVERRIDE {
         CheckLeakAutoVar checkLeakAutoVar(tokenizer, settings, errorLogger);
@@ -111,6 +116,12 @@ public:
 
 private:
 
+    /** allocation info for a call token, resolved by Tokenizer::stampLibraryAnnotations() */
+    const Library::AllocFunc* libAlloc(const Token* tok) const;
+
+    /** deallocation info for a call token, resolved by Tokenizer::stampLibraryAnnotations() */
+    const Library::AllocFunc* libDealloc(const Token* tok) const;
+
     /** check for leaks in all scopes */
     void check();
 
@@ -115,6 +115,21 @@ bool CheckMemoryLeak::isclass(const Token *tok, unsigned int varid) const
 //---------------------------------------------------------------------------
 
 CheckMemoryLeak::AllocType CheckMemoryLeak::getAllocationType(const Token *tok2, unsigned int varid, std::list<const Function*> *callstack) const
+{
+    // with a callstack the answer depends on the callers, don't cache it
+    if (callstack)
+        return getAllocationTypeImpl(tok2, varid, callstack);
+
+    const std::pair<const Token *, unsigned int> key(tok2, varid);
+    const std::map<std::pair<const Token *, unsigned int>, AllocType>::const_iterator it = mAllocTypeCache.find(key);
+    if (it != mAllocTypeCache.end())
+        return it->second;
+    const AllocType allocType = getAllocationTypeImpl(tok2, varid, nullptr);
+    mAllocTypeCache[key] = allocType;
+    return allocType;
+}
+
+CheckMemoryLeak::AllocType CheckMemoryLeak::getAllocationTypeImpl(const Token *tok2, unsigned int varid, std::list<const Function*> *callstack) const
 {
     // What we may have...
     //     * var = (char *)malloc(10);
@@ -38,7 +38,9 @@
 #include "tokenize.h"
 
 #include <list>
+#include <map>
 #include <string>
+#include <utility>
 
 class Function;
 class Scope;
@@ -105,7 +107,10 @@ public:
     AllocType getDeallocationType(const Token *tok, unsigned int varid) const;
 
     /**
-     * @brief Get type of allocation at given position
+     * @brief Get type of allocation at given position. The classification is
+     * memoized per instance; classifying a call to a user function follows
+     * the function body and the leak checks ask about the same allocation
+     * sites repeatedly.
      */
     AllocType getAllocationType(const Token *tok2, unsigned int varid, std::list<const Function*> *callstack = nullptr) const;
 
@@ -152,6 +157,13 @@ public:
 
     /** Function allocates pointed-to argument (a la asprintf)? */
     const char *functionArgAlloc(const Function *func, unsigned int targetpar, AllocType &allocType) const;
+
+private:
+    /** uncached worker for getAllocationType */
+    AllocType getAllocationTypeImpl(const Token *tok2, unsigned int varid, std::list<const Function*> *callstack) const;
+
+    /** (token, varid) -> allocation type, see getAllocationType */
+    mutable std::map<std::pair<const Token *, unsigned int>, AllocType> mAllocTypeCache;
 };
 
 /// @}
@@ -183,6 +195,11 @@ public:
         : Check(myName(), tokenizer, settings, errorLogger), CheckMemoryLeak(tokenizer, errorLogger, settings) {
     }
 
+    /** @brief Create a bound instance, see Check::createInstance() */
+    Check *createInstance(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) const OVERRIDE {
+        return new CheckMemoryLeakInFunction(tokenizer, settings, errorLogger);
+    }
+
     /** @brief run all simplified checks */
     void runSimplifiedChecks(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) OVERRIDE {
         CheckMemoryLeakInFunction checkMemoryLeak(tokenizer, settings, errorLogger);
@@ -245,6 +262,11 @@ public:
         : Check(myName(), tokenizer, settings, errorLogger), CheckMemoryLeak(tokenizer, errorLogger, settings) {
     }
 
+    /** @brief Create a bound instance, see Check::createInstance() */
+    Check *createInstance(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) const OVERRIDE {
+        return new CheckMemoryLeakInClass(tokenizer, settings, errorLogger);
+    }
+
     void runSimplifiedChecks(const Tokenizer *tokenizr, const Settings *settings, ErrorLogger *errLog) OVERRIDE {
         if (!tokenizr->isCPP())
             return;
@@ -253,6 +275,10 @@ public:
         checkMemoryLeak.check();
     }
 
+    bool hasSimplifiedChecks(const Tokenizer *tokenizr, const Settings * /*settings*/) const OVERRIDE {
+        return tokenizr->isCPP();
+    }
+
     void check();
 
 private:
@@ -292,6 +318,11 @@ public:
         : Check(myName(), tokenizer, settings, errorLogger), CheckMemoryLeak(tokenizer, errorLogger, settings) {
     }
 
+    /** @brief Create a bound instance, see Check::createInstance() */
+    Check *createInstance(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) const OVERRIDE {
+        return new CheckMemoryLeakStructMember(tokenizer, settings, errorLogger);
+    }
+
     void runSimplifiedChecks(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) OVERRIDE {
         CheckMemoryLeakStructMember checkMemoryLeak(tokenizer, settings, errorLogger);
         checkMemoryLeak.check();
@@ -331,6 +362,11 @@ public:
         : Check(myName(), tokenizer, settings, errorLogger), CheckMemoryLeak(tokenizer, errorLogger, settings) {
     }
 
+    /** @brief Create a bound instance, see Check::createInstance() */
+    Check *createInstance(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) const OVERRIDE {
+        return new CheckMemoryLeakNoVar(tokenizer, settings, errorLogger);
+    }
+
     void runSimplifiedChecks(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) OVERRIDE {
         CheckMemoryLeakNoVar checkMemoryLeak(tokenizer, settings, errorLogger);
         checkMemoryLeak.check();
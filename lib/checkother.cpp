@@ -234,6 +234,10 @@ void CheckOther::clarifyStatementError(const Token *tok)
 //---------------------------------------------------------------------------
 void CheckOther::checkSuspiciousSemicolon()
 {
+    SubCheck subCheck(this, "checkSuspiciousSemicolon");
+    if (!subCheck.enabled())
+        return;
+
     if (!mSettings->inconclusive || !mSettings->isEnabled(Settings::WARNING))
         return;
 
@@ -265,6 +269,10 @@ void CheckOther::SuspiciousSemicolonError(const Token* tok)
 //---------------------------------------------------------------------------
 void CheckOther::warningOldStylePointerCast()
 {
+    SubCheck subCheck(this, "warningOldStylePointerCast");
+    if (!subCheck.enabled())
+        return;
+
     // Only valid on C++ code
     if (!mSettings->isEnabled(Settings::STYLE) || !mTokenizer->isCPP())
         return;
@@ -316,6 +324,10 @@ void CheckOther::cstyleCastError(const Token *tok)
 
 void CheckOther::invalidPointerCast()
 {
+    SubCheck subCheck(this, "invalidPointerCast");
+    if (!subCheck.enabled())
+        return;
+
     if (!mSettings->isEnabled(Settings::PORTABILITY))
         return;
 
@@ -414,12 +426,17 @@ void CheckOther::checkPipeParameterSizeError(const Token *tok, const std::string
 
 void CheckOther::checkRedundantAssignment()
 {
+    SubCheck subCheck(this, "checkRedundantAssignment");
+    if (!subCheck.enabled())
+        return;
+
     if (!mSettings->isEnabled(Settings::STYLE))
         return;
     const SymbolDatabase* symbolDatabase = mTokenizer->getSymbolDatabase();
     for (const Scope *scope : symbolDatabase->functionScopes) {
         if (!scope->bodyStart)
             continue;
+        const DefUseIndex defUse(scope);
         for (const Token* tok = scope->bodyStart->next(); tok != scope->bodyEnd; tok = tok->next()) {
             if (Token::simpleMatch(tok, "] ("))
                 // todo: handle lambdas
@@ -431,6 +448,14 @@ void CheckOther::checkRedundantAssignment()
                 if (tok->astParent())
                     continue;
 
+                // A redundant assignment needs a second write of the variable.
+                // For a plain variable each reassignment is counted as a write
+                // by the def-use index, so with fewer than 2 possible writes
+                // the forward analysis below cannot find anything.
+                if (tok->astOperand1()->varId() != 0 && !tok->astOperand1()->astOperand1() &&
+                    defUse.writeCount(tok->astOperand1()->varId()) < 2)
+                    continue;
+
                 // Do not warn about redundant initialization when rhs is trivial
                 // TODO : do not simplify the variable declarations
                 if (Token::Match(tok->tokAt(-3), "%var% ; %var% =") && tok->previous()->variable() && tok->previous()->variable()->nameToken() == tok->tokAt(-3) && tok->tokAt(-3)->linenr() == tok->previous()->linenr()) {
@@ -570,6 +595,10 @@ static inline bool isFunctionOrBreakPattern(const Token *tok)
 
 void CheckOther::checkRedundantAssignmentInSwitch()
 {
+    SubCheck subCheck(this, "checkRedundantAssignmentInSwitch");
+    if (!subCheck.enabled())
+        return;
+
     if (!mSettings->isEnabled(Settings::WARNING))
         return;
 
@@ -697,6 +726,10 @@ void CheckOther::redundantBitwiseOperationInSwitchError(const Token *tok, const
 //---------------------------------------------------------------------------
 void CheckOther::checkSuspiciousCaseInSwitch()
 {
+    SubCheck subCheck(this, "checkSuspiciousCaseInSwitch");
+    if (!subCheck.enabled())
+        return;
+
     if (!mSettings->inconclusive || !mSettings->isEnabled(Settings::WARNING))
         return;
 
@@ -793,6 +826,10 @@ void CheckOther::suspiciousEqualityComparisonError(const Token* tok)
 //---------------------------------------------------------------------------
 void CheckOther::checkUnreachableCode()
 {
+    SubCheck subCheck(this, "checkUnreachableCode");
+    if (!subCheck.enabled())
+        return;
+
     if (!mSettings->isEnabled(Settings::STYLE))
         return;
     const bool printInconclusive = mSettings->inconclusive;
@@ -906,6 +943,10 @@ void CheckOther::unreachableCodeError(const Token *tok, bool inconclusive)
 //---------------------------------------------------------------------------
 void CheckOther::checkVariableScope()
 {
+    SubCheck subCheck(this, "checkVariableScope");
+    if (!subCheck.enabled())
+        return;
+
     if (!mSettings->isEnabled(Settings::STYLE))
         return;
 
@@ -1090,6 +1131,10 @@ void CheckOther::variableScopeError(const Token *tok, const std::string &varname
 //---------------------------------------------------------------------------
 void CheckOther::checkCommaSeparatedReturn()
 {
+    SubCheck subCheck(this, "checkCommaSeparatedReturn");
+    if (!subCheck.enabled())
+        return;
+
     // This is experimental for now. See #5076
     if (!mSettings->experimental)
         return;
@@ -1304,6 +1349,10 @@ void CheckOther::passedByValueError(const Token *tok, const std::string &parname
 
 void CheckOther::checkCharVariable()
 {
+    SubCheck subCheck(this, "checkCharVariable");
+    if (!subCheck.enabled())
+        return;
+
     const bool warning = mSettings->isEnabled(Settings::WARNING);
     const bool portability = mSettings->isEnabled(Settings::PORTABILITY);
     if (!warning && !portability)
@@ -1454,8 +1503,19 @@ void CheckOther::constStatementError(const Token *tok, const std::string &type)
 //---------------------------------------------------------------------------
 void CheckOther::checkZeroDivision()
 {
-    for (const Token *tok = mTokenizer->tokens(); tok; tok = tok->next()) {
-        if (!tok->astOperand2() || !tok->astOperand1())
+    SubCheck subCheck(this, "checkZeroDivision");
+    if (!subCheck.enabled())
+        return;
+
+    // The interesting division operators are the AST parents of tokens
+    // that can be zero - iterate the tokens carrying values instead of
+    // the whole token list.
+    for (const Token *vtok : mTokenizer->list.valueTokens()) {
+        const ValueFlow::Value *value = vtok->getValue(0LL);
+        if (!value)
+            continue;
+        const Token *tok = vtok->astParent();
+        if (!tok || tok->astOperand2() != vtok || !tok->astOperand1())
             continue;
         if (tok->str() != "%" && tok->str() != "/" && tok->str() != "%=" && tok->str() != "/=")
             continue;
@@ -1470,9 +1530,7 @@ void CheckOther::checkZeroDivision()
         } else if (!tok->astOperand1()->isArithmeticalOp())
             continue;
 
-        // Value flow..
-        const ValueFlow::Value *value = tok->astOperand2()->getValue(0LL);
-        if (value && mSettings->isEnabled(value, false))
+        if (mSettings->isEnabled(value, false))
             zerodivError(tok, value);
     }
 }
@@ -1508,6 +1566,10 @@ void CheckOther::zerodivError(const Token *tok, const ValueFlow::Value *value)
 
 void CheckOther::checkNanInArithmeticExpression()
 {
+    SubCheck subCheck(this, "checkNanInArithmeticExpression");
+    if (!subCheck.enabled())
+        return;
+
     if (!mSettings->isEnabled(Settings::STYLE))
         return;
     for (const Token *tok = mTokenizer->tokens(); tok; tok = tok->next()) {
@@ -1583,6 +1645,10 @@ static const Token * getSingleExpressionInBlock(const Token * tok)
 //-----------------------------------------------------------------------------
 void CheckOther::checkDuplicateBranch()
 {
+    SubCheck subCheck(this, "checkDuplicateBranch");
+    if (!subCheck.enabled())
+        return;
+
     // This is inconclusive since in practice most warnings are noise:
     // * There can be unfixed low-priority todos. The code is fine as it
     //   is but it could be possible to enhance it. Writing a warning
@@ -1635,7 +1701,7 @@ void CheckOther::checkDuplicateBranch()
             const Token * branchTop2 = getSingleExpressionInBlock(scope.bodyEnd->tokAt(3));
             if (!branchTop1 || !branchTop2)
                 continue;
-            if (branchTop1->str() != branchTop2->str())
+            if (!branchTop1->sameStr(branchTop2))
                 continue;
             if (isSameExpression(mTokenizer->isCPP(), false, branchTop1->astOperand1(), branchTop2->astOperand1(), mSettings->library, true, true, &errorPath) &&
                 isSameExpression(mTokenizer->isCPP(), false, branchTop1->astOperand2(), branchTop2->astOperand2(), mSettings->library, true, true, &errorPath))
@@ -1768,6 +1834,10 @@ namespace {
 
 void CheckOther::checkDuplicateExpression()
 {
+    SubCheck subCheck(this, "checkDuplicateExpression");
+    if (!subCheck.enabled())
+        return;
+
     const bool styleEnabled = mSettings->isEnabled(Settings::STYLE);
     const bool warningEnabled = mSettings->isEnabled(Settings::WARNING);
     if (!styleEnabled && !warningEnabled)
@@ -1855,11 +1925,11 @@ void CheckOther::checkDuplicateExpression()
                            isWithoutSideEffects(mTokenizer->isCPP(), tok->astOperand1())) {
                     oppositeExpressionError(tok, errorPath);
                 } else if (!Token::Match(tok, "[-/%]")) { // These operators are not associative
-                    if (styleEnabled && tok->astOperand2() && tok->str() == tok->astOperand1()->str() && isSameExpression(mTokenizer->isCPP(), true, tok->astOperand2(), tok->astOperand1()->astOperand2(), mSettings->library, true, true, &errorPath) && isWithoutSideEffects(mTokenizer->isCPP(), tok->astOperand2()))
+                    if (styleEnabled && tok->astOperand2() && tok->sameStr(tok->astOperand1()) && isSameExpression(mTokenizer->isCPP(), true, tok->astOperand2(), tok->astOperand1()->astOperand2(), mSettings->library, true, true, &errorPath) && isWithoutSideEffects(mTokenizer->isCPP(), tok->astOperand2()))
                         duplicateExpressionError(tok->astOperand2(), tok->astOperand1()->astOperand2(), tok, errorPath);
                     else if (tok->astOperand2() && isConstExpression(tok->astOperand1(), mSettings->library, true, mTokenizer->isCPP())) {
                         const Token *ast1 = tok->astOperand1();
-                        while (ast1 && tok->str() == ast1->str()) {
+                        while (ast1 && tok->sameStr(ast1)) {
                             if (isSameExpression(mTokenizer->isCPP(), true, ast1->astOperand1(), tok->astOperand2(), mSettings->library, true, true, &errorPath) &&
                                 isWithoutSideEffects(mTokenizer->isCPP(), ast1->astOperand1()) &&
                                 isWithoutSideEffects(mTokenizer->isCPP(), ast1->astOperand2()))
@@ -2009,6 +2079,10 @@ void CheckOther::checkComparisonFunctionIsAlwaysTrueOrFalseError(const Token* to
 //---------------------------------------------------------------------------
 void CheckOther::checkSignOfUnsignedVariable()
 {
+    SubCheck subCheck(this, "checkSignOfUnsignedVariable");
+    if (!subCheck.enabled())
+        return;
+
     if (!mSettings->isEnabled(Settings::STYLE))
         return;
 
@@ -2157,6 +2231,10 @@ static bool isNegative(const Token *tok, const Settings *settings)
 
 void CheckOther::checkNegativeBitwiseShift()
 {
+    SubCheck subCheck(this, "checkNegativeBitwiseShift");
+    if (!subCheck.enabled())
+        return;
+
     const bool portability = mSettings->isEnabled(Settings::PORTABILITY);
 
     for (const Token* tok = mTokenizer->tokens(); tok; tok = tok->next()) {
@@ -2209,6 +2287,10 @@ void CheckOther::negativeBitwiseShiftError(const Token *tok, int op)
 //---------------------------------------------------------------------------
 void CheckOther::checkIncompleteArrayFill()
 {
+    SubCheck subCheck(this, "checkIncompleteArrayFill");
+    if (!subCheck.enabled())
+        return;
+
     if (!mSettings->inconclusive)
         return;
     const bool printWarning = mSettings->isEnabled(Settings::WARNING);
@@ -2262,6 +2344,10 @@ void CheckOther::incompleteArrayFillError(const Token* tok, const std::string& b
 
 void CheckOther::checkVarFuncNullUB()
 {
+    SubCheck subCheck(this, "checkVarFuncNullUB");
+    if (!subCheck.enabled())
+        return;
+
     if (!mSettings->isEnabled(Settings::PORTABILITY))
         return;
 
@@ -2345,6 +2431,10 @@ void CheckOther::varFuncNullUBError(const Token *tok)
 
 void CheckOther::checkRedundantPointerOp()
 {
+    SubCheck subCheck(this, "checkRedundantPointerOp");
+    if (!subCheck.enabled())
+        return;
+
     if (!mSettings->isEnabled(Settings::STYLE))
         return;
 
@@ -2374,6 +2464,10 @@ void CheckOther::redundantPointerOpError(const Token* tok, const std::string &va
 
 void CheckOther::checkInterlockedDecrement()
 {
+    SubCheck subCheck(this, "checkInterlockedDecrement");
+    if (!subCheck.enabled())
+        return;
+
     if (!mSettings->isWindowsPlatform()) {
         return;
     }
@@ -2384,8 +2478,8 @@ void CheckOther::checkInterlockedDecrement()
             const Token* checkStartTok =  interlockedVarTok->tokAt(5);
             if ((Token::Match(checkStartTok, "0 %comp% %name% )") && checkStartTok->strAt(2) == interlockedVarTok->str()) ||
                 (Token::Match(checkStartTok, "! %name% )") && checkStartTok->strAt(1) == interlockedVarTok->str()) ||
-                (Token::Match(checkStartTok, "%name% )") && checkStartTok->str() == interlockedVarTok->str()) ||
-                (Token::Match(checkStartTok, "%name% %comp% 0 )") && checkStartTok->str() == interlockedVarTok->str())) {
+                (Token::Match(checkStartTok, "%name% )") && checkStartTok->sameStr(interlockedVarTok)) ||
+                (Token::Match(checkStartTok, "%name% %comp% 0 )") && checkStartTok->sameStr(interlockedVarTok))) {
                 raceAfterInterlockedDecrementError(checkStartTok);
             }
         } else if (Token::Match(tok, "if ( ::| InterlockedDecrement ( & %name%")) {
@@ -2396,12 +2490,12 @@ void CheckOther::checkInterlockedDecrement()
                 const Token* ifEndTok = condEnd->next()->link();
                 if (Token::Match(ifEndTok, "} return %name%")) {
                     const Token* secondAccessTok = ifEndTok->tokAt(2);
-                    if (secondAccessTok->str() == firstAccessTok->str()) {
+                    if (secondAccessTok->sameStr(firstAccessTok)) {
                         raceAfterInterlockedDecrementError(secondAccessTok);
                     }
                 } else if (Token::Match(ifEndTok, "} else { return %name%")) {
                     const Token* secondAccessTok = ifEndTok->tokAt(4);
-                    if (secondAccessTok->str() == firstAccessTok->str()) {
+                    if (secondAccessTok->sameStr(firstAccessTok)) {
                         raceAfterInterlockedDecrementError(secondAccessTok);
                     }
                 }
@@ -2418,6 +2512,10 @@ void CheckOther::raceAfterInterlockedDecrementError(const Token* tok)
 
 void CheckOther::checkUnusedLabel()
 {
+    SubCheck subCheck(this, "checkUnusedLabel");
+    if (!subCheck.enabled())
+        return;
+
     if (!mSettings->isEnabled(Settings::STYLE) && !mSettings->isEnabled(Settings::WARNING))
         return;
 
@@ -2453,6 +2551,10 @@ void CheckOther::unusedLabelError(const Token* tok, bool inSwitch)
 
 void CheckOther::checkEvaluationOrder()
 {
+    SubCheck subCheck(this, "checkEvaluationOrder");
+    if (!subCheck.enabled())
+        return;
+
     // This checker is not written according to C++11 sequencing rules
     if (mTokenizer->isCPP() && mSettings->standards.cpp >= Standards::CPP11)
         return;
@@ -2617,6 +2719,10 @@ void CheckOther::accessMovedError(const Token *tok, const std::string &varname,
 
 void CheckOther::checkFuncArgNamesDifferent()
 {
+    SubCheck subCheck(this, "checkFuncArgNamesDifferent");
+    if (!subCheck.enabled())
+        return;
+
     const bool style = mSettings->isEnabled(Settings::STYLE);
     const bool inconclusive = mSettings->inconclusive;
     const bool warning = mSettings->isEnabled(Settings::WARNING);
@@ -2753,6 +2859,10 @@ static const Token *findShadowed(const Scope *scope, const std::string &varname,
 
 void CheckOther::checkShadowVariables()
 {
+    SubCheck subCheck(this, "checkShadowVariables");
+    if (!subCheck.enabled())
+        return;
+
     if (!mSettings->isEnabled(Settings::STYLE))
         return;
     const SymbolDatabase *symbolDatabase = mTokenizer->getSymbolDatabase();
@@ -2783,6 +2893,10 @@ void CheckOther::shadowError(const Token *var, const Token *shadowed, bool shado
 
 void CheckOther::checkConstArgument()
 {
+    SubCheck subCheck(this, "checkConstArgument");
+    if (!subCheck.enabled())
+        return;
+
     if (!mSettings->isEnabled(Settings::STYLE))
         return;
     const SymbolDatabase *symbolDatabase = mTokenizer->getSymbolDatabase();
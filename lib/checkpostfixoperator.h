@@ -50,6 +50,11 @@ public:
         : Check(myName(), tokenizer, settings, errorLogger) {
     }
 
+    /** @brief Create a bound instance, see Check::createInstance() */
+    Check *createInstance(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) const OVERRIDE {
+        return new CheckPostfixOperator(tokenizer, settings, errorLogger);
+    }
+
     void runChecks(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) OVERRIDE {
         if (tokenizer->isC())
             return;
@@ -60,6 +65,10 @@ public:
     void runSimplifiedChecks(const Tokenizer * /*tokenizer*/, const Settings * /*settings*/, ErrorLogger * /*errorLogger*/) OVERRIDE {
     }
 
+    bool hasSimplifiedChecks(const Tokenizer * /*tokenizer*/, const Settings * /*settings*/) const OVERRIDE {
+        return false;
+    }
+
     /** Check postfix operators */
     void postfixOperator();
 
@@ -254,16 +254,16 @@ void CheckSizeof::divideBySizeofError(const Token *tok, const std::string &memfu
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
-void CheckSizeof::sizeofsizeof()
+void CheckSizeof::sizeofsizeof(const Token *tok)
 {
     if (!mSettings->isEnabled(Settings::WARNING))
         return;
 
-    for (const Token *tok = mTokenizer->tokens(); tok; tok = tok->next()) {
-        if (Token::Match(tok, "sizeof (| sizeof")) {
-            sizeofsizeofError(tok);
-            tok = tok->next();
-        }
+    if (tok == mSizeofsizeofSkip)
+        return;
+    if (Token::Match(tok, "sizeof (| sizeof")) {
+        sizeofsizeofError(tok);
+        mSizeofsizeofSkip = tok->next();
     }
 }
 
@@ -278,31 +278,27 @@ void CheckSizeof::sizeofsizeofError(const Token *tok)
 
 //-----------------------------------------------------------------------------
 
-void CheckSizeof::sizeofCalculation()
+void CheckSizeof::sizeofCalculation(const Token *tok)
 {
     if (!mSettings->isEnabled(Settings::WARNING))
         return;
 
-    const bool printInconclusive = mSettings->inconclusive;
-
-    for (const Token *tok = mTokenizer->tokens(); tok; tok = tok->next()) {
-        if (!Token::simpleMatch(tok, "sizeof ("))
-            continue;
+    if (!Token::simpleMatch(tok, "sizeof ("))
+        return;
 
-        // ignore if the `sizeof` result is cast to void inside a macro, i.e. the calculation is
-        // expected to be parsed but skipped, such as in a disabled custom ASSERT() macro
-        if (tok->isExpandedMacro() && tok->previous()) {
-            const Token *cast_end = (tok->previous()->str() == "(") ? tok->previous() : tok;
-            if (Token::simpleMatch(cast_end->tokAt(-3), "( void )") ||
-                Token::simpleMatch(cast_end->previous(), "static_cast<void>")) {
-                continue;
-            }
+    // ignore if the `sizeof` result is cast to void inside a macro, i.e. the calculation is
+    // expected to be parsed but skipped, such as in a disabled custom ASSERT() macro
+    if (tok->isExpandedMacro() && tok->previous()) {
+        const Token *cast_end = (tok->previous()->str() == "(") ? tok->previous() : tok;
+        if (Token::simpleMatch(cast_end->tokAt(-3), "( void )") ||
+            Token::simpleMatch(cast_end->previous(), "static_cast<void>")) {
+            return;
         }
-
-        const Token *argument = tok->next()->astOperand2();
-        if (argument && argument->isCalculation() && (!argument->isExpandedMacro() || printInconclusive))
-            sizeofCalculationError(argument, argument->isExpandedMacro());
     }
+
+    const Token *argument = tok->next()->astOperand2();
+    if (argument && argument->isCalculation() && (!argument->isExpandedMacro() || mSettings->inconclusive))
+        sizeofCalculationError(argument, argument->isExpandedMacro());
 }
 
 void CheckSizeof::sizeofCalculationError(const Token *tok, bool inconclusive)
@@ -313,33 +309,36 @@ void CheckSizeof::sizeofCalculationError(const Token *tok, bool inconclusive)
 
 //-----------------------------------------------------------------------------
 
-void CheckSizeof::sizeofFunction()
+void CheckSizeof::sizeofFunction(const Token *tok)
 {
     if (!mSettings->isEnabled(Settings::WARNING))
         return;
 
-    for (const Token *tok = mTokenizer->tokens(); tok; tok = tok->next()) {
-        if (Token::simpleMatch(tok, "sizeof (")) {
+    if (mSizeofFunctionStopped)
+        return;
 
-            // ignore if the `sizeof` result is cast to void inside a macro, i.e. the calculation is
-            // expected to be parsed but skipped, such as in a disabled custom ASSERT() macro
-            if (tok->isExpandedMacro() && tok->previous()) {
-                const Token *cast_end = (tok->previous()->str() == "(") ? tok->previous() : tok;
-                if (Token::simpleMatch(cast_end->tokAt(-3), "( void )") ||
-                    Token::simpleMatch(cast_end->previous(), "static_cast<void>")) {
-                    continue;
-                }
+    if (Token::simpleMatch(tok, "sizeof (")) {
+
+        // ignore if the `sizeof` result is cast to void inside a macro, i.e. the calculation is
+        // expected to be parsed but skipped, such as in a disabled custom ASSERT() macro
+        if (tok->isExpandedMacro() && tok->previous()) {
+            const Token *cast_end = (tok->previous()->str() == "(") ? tok->previous() : tok;
+            if (Token::simpleMatch(cast_end->tokAt(-3), "( void )") ||
+                Token::simpleMatch(cast_end->previous(), "static_cast<void>")) {
+                return;
             }
+        }
 
-            if (const Token *argument = tok->next()->astOperand2()) {
-                const Token *checkToken = argument->previous();
-                if (checkToken->tokType() == Token::eName)
-                    break;
-                const Function * fun = checkToken->function();
-                // Don't report error if the function is overloaded
-                if (fun && fun->nestedIn->functionMap.count(checkToken->str()) == 1) {
-                    sizeofFunctionError(tok);
-                }
+        if (const Token *argument = tok->next()->astOperand2()) {
+            const Token *checkToken = argument->previous();
+            if (checkToken->tokType() == Token::eName) {
+                mSizeofFunctionStopped = true;
+                return;
+            }
+            const Function * fun = checkToken->function();
+            // Don't report error if the function is overloaded
+            if (fun && fun->nestedIn->functionMap.count(checkToken->str()) == 1) {
+                sizeofFunctionError(tok);
             }
         }
     }
@@ -354,22 +353,20 @@ void CheckSizeof::sizeofFunctionError(const Token *tok)
 //-----------------------------------------------------------------------------
 // Check for code like sizeof()*sizeof() or sizeof(ptr)/value
 //-----------------------------------------------------------------------------
-void CheckSizeof::suspiciousSizeofCalculation()
+void CheckSizeof::suspiciousSizeofCalculation(const Token *tok)
 {
     if (!mSettings->isEnabled(Settings::WARNING) || !mSettings->inconclusive)
         return;
 
     // TODO: Use AST here. This should be possible as soon as sizeof without brackets is correctly parsed
-    for (const Token *tok = mTokenizer->tokens(); tok; tok = tok->next()) {
-        if (Token::simpleMatch(tok, "sizeof (")) {
-            const Token* const end = tok->linkAt(1);
-            const Variable* var = end->previous()->variable();
-            if (end->strAt(-1) == "*" || (var && var->isPointer() && !var->isArray())) {
-                if (end->strAt(1) == "/")
-                    divideSizeofError(tok);
-            } else if (Token::simpleMatch(end, ") * sizeof") && end->next()->astOperand1() == tok->next())
-                multiplySizeofError(tok);
-        }
+    if (Token::simpleMatch(tok, "sizeof (")) {
+        const Token* const end = tok->linkAt(1);
+        const Variable* var = end->previous()->variable();
+        if (end->strAt(-1) == "*" || (var && var->isPointer() && !var->isArray())) {
+            if (end->strAt(1) == "/")
+                divideSizeofError(tok);
+        } else if (Token::simpleMatch(end, ") * sizeof") && end->next()->astOperand1() == tok->next())
+            multiplySizeofError(tok);
     }
 }
 
@@ -387,39 +384,37 @@ void CheckSizeof::divideSizeofError(const Token *tok)
                 "not the size of the memory area it points to.", CWE682, true);
 }
 
-void CheckSizeof::sizeofVoid()
+void CheckSizeof::sizeofVoid(const Token *tok)
 {
     if (!mSettings->isEnabled(Settings::PORTABILITY))
         return;
 
-    for (const Token *tok = mTokenizer->tokens(); tok; tok = tok->next()) {
-        if (Token::simpleMatch(tok, "sizeof ( )")) { // "sizeof(void)" gets simplified to sizeof ( )
-            sizeofVoidError(tok);
-        } else if (Token::simpleMatch(tok, "sizeof (") && tok->next()->astOperand2()) {
-            const ValueType *vt = tok->next()->astOperand2()->valueType();
-            if (vt && vt->type == ValueType::Type::VOID && vt->pointer == 0U)
-                sizeofDereferencedVoidPointerError(tok, tok->strAt(3));
-        } else if (tok->str() == "-") {
-            // only warn for: 'void *' - 'integral'
-            const ValueType *vt1  = tok->astOperand1() ? tok->astOperand1()->valueType() : nullptr;
-            const ValueType *vt2  = tok->astOperand2() ? tok->astOperand2()->valueType() : nullptr;
-            const bool op1IsvoidPointer = (vt1 && vt1->type == ValueType::Type::VOID && vt1->pointer == 1U);
-            const bool op2IsIntegral    = (vt2 && vt2->isIntegral() && vt2->pointer == 0U);
-            if (op1IsvoidPointer && op2IsIntegral)
-                arithOperationsOnVoidPointerError(tok, tok->astOperand1()->expressionString(), vt1->str());
-        } else if (Token::Match(tok, "+|++|--|+=|-=")) { // Arithmetic operations on variable of type "void*"
-            const ValueType *vt1 = tok->astOperand1() ? tok->astOperand1()->valueType() : nullptr;
-            const ValueType *vt2 = tok->astOperand2() ? tok->astOperand2()->valueType() : nullptr;
-
-            const bool voidpointer1 = (vt1 && vt1->type == ValueType::Type::VOID && vt1->pointer == 1U);
-            const bool voidpointer2 = (vt2 && vt2->type == ValueType::Type::VOID && vt2->pointer == 1U);
-
-            if (voidpointer1)
-                arithOperationsOnVoidPointerError(tok, tok->astOperand1()->expressionString(), vt1->str());
-
-            if (!tok->isAssignmentOp() && voidpointer2)
-                arithOperationsOnVoidPointerError(tok, tok->astOperand2()->expressionString(), vt2->str());
-        }
+    if (Token::simpleMatch(tok, "sizeof ( )")) { // "sizeof(void)" gets simplified to sizeof ( )
+        sizeofVoidError(tok);
+    } else if (Token::simpleMatch(tok, "sizeof (") && tok->next()->astOperand2()) {
+        const ValueType *vt = tok->next()->astOperand2()->valueType();
+        if (vt && vt->type == ValueType::Type::VOID && vt->pointer == 0U)
+            sizeofDereferencedVoidPointerError(tok, tok->strAt(3));
+    } else if (tok->str() == "-") {
+        // only warn for: 'void *' - 'integral'
+        const ValueType *vt1  = tok->astOperand1() ? tok->astOperand1()->valueType() : nullptr;
+        const ValueType *vt2  = tok->astOperand2() ? tok->astOperand2()->valueType() : nullptr;
+        const bool op1IsvoidPointer = (vt1 && vt1->type == ValueType::Type::VOID && vt1->pointer == 1U);
+        const bool op2IsIntegral    = (vt2 && vt2->isIntegral() && vt2->pointer == 0U);
+        if (op1IsvoidPointer && op2IsIntegral)
+            arithOperationsOnVoidPointerError(tok, tok->astOperand1()->expressionString(), vt1->str());
+    } else if (Token::Match(tok, "+|++|--|+=|-=")) { // Arithmetic operations on variable of type "void*"
+        const ValueType *vt1 = tok->astOperand1() ? tok->astOperand1()->valueType() : nullptr;
+        const ValueType *vt2 = tok->astOperand2() ? tok->astOperand2()->valueType() : nullptr;
+
+        const bool voidpointer1 = (vt1 && vt1->type == ValueType::Type::VOID && vt1->pointer == 1U);
+        const bool voidpointer2 = (vt2 && vt2->type == ValueType::Type::VOID && vt2->pointer == 1U);
+
+        if (voidpointer1)
+            arithOperationsOnVoidPointerError(tok, tok->astOperand1()->expressionString(), vt1->str());
+
+        if (!tok->isAssignmentOp() && voidpointer2)
+            arithOperationsOnVoidPointerError(tok, tok->astOperand2()->expressionString(), vt2->str());
     }
 }
 
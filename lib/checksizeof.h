@@ -49,36 +49,47 @@ public:
         : Check(myName(), tokenizer, settings, errorLogger) {
     }
 
+    /** @brief Create a bound instance, see Check::createInstance() */
+    Check *createInstance(const Tokenizer* tokenizer, const Settings* settings, ErrorLogger* errorLogger) const OVERRIDE {
+        return new CheckSizeof(tokenizer, settings, errorLogger);
+    }
+
     /** @brief Run checks against the normal token list */
     void runChecks(const Tokenizer* tokenizer, const Settings* settings, ErrorLogger* errorLogger) OVERRIDE {
         CheckSizeof checkSizeof(tokenizer, settings, errorLogger);
 
-        // Checks
-        checkSizeof.sizeofsizeof();
-        checkSizeof.sizeofCalculation();
-        checkSizeof.sizeofFunction();
-        checkSizeof.suspiciousSizeofCalculation();
+        // Checks that walk the symbol database
         checkSizeof.checkSizeofForArrayParameter();
         checkSizeof.checkSizeofForPointerSize();
         checkSizeof.checkSizeofForNumericParameter();
-        checkSizeof.sizeofVoid();
+
+        // The remaining checks are plain per-token passes, dispatched from
+        // fusedToken(). Share the traversal when the scheduler is active,
+        // otherwise (unit tests) do a single local walk.
+        if (Check::fusedWalkActive())
+            Check::queueFusedInstance(new CheckSizeof(tokenizer, settings, errorLogger));
+        else {
+            for (const Token* tok = tokenizer->tokens(); tok; tok = tok->next())
+                checkSizeof.fusedToken(tok);
+        }
+    }
+
+    /** @brief Per-token dispatcher for the fused traversal */
+    void fusedToken(const Token* tok) OVERRIDE {
+        sizeofsizeof(tok);
+        sizeofCalculation(tok);
+        sizeofFunction(tok);
+        suspiciousSizeofCalculation(tok);
+        sizeofVoid(tok);
     }
 
     /** @brief Run checks against the simplified token list */
     void runSimplifiedChecks(const Tokenizer* /*tokenizer*/, const Settings* /*settings*/, ErrorLogger* /*errorLogger*/) OVERRIDE {
     }
 
-    /** @brief %Check for 'sizeof sizeof ..' */
-    void sizeofsizeof();
-
-    /** @brief %Check for calculations inside sizeof */
-    void sizeofCalculation();
-
-    /** @brief %Check for function call inside sizeof */
-    void sizeofFunction();
-
-    /** @brief %Check for suspicious calculations with sizeof results */
-    void suspiciousSizeofCalculation();
+    bool hasSimplifiedChecks(const Tokenizer* /*tokenizer*/, const Settings* /*settings*/) const OVERRIDE {
+        return false;
+    }
 
     /** @brief %Check for using sizeof with array given as function argument */
     void checkSizeofForArrayParameter();
@@ -89,10 +100,28 @@ public:
     /** @brief %Check for using sizeof with numeric given as function argument */
     void checkSizeofForNumericParameter();
 
+private:
+    /** @brief %Check for 'sizeof sizeof ..' */
+    void sizeofsizeof(const Token* tok);
+
+    /** @brief %Check for calculations inside sizeof */
+    void sizeofCalculation(const Token* tok);
+
+    /** @brief %Check for function call inside sizeof */
+    void sizeofFunction(const Token* tok);
+
+    /** @brief %Check for suspicious calculations with sizeof results */
+    void suspiciousSizeofCalculation(const Token* tok);
+
     /** @brief %Check for using sizeof(void) */
-    void sizeofVoid();
+    void sizeofVoid(const Token* tok);
+
+    /** skip token in sizeofsizeof(), mirrors the skip of the old full walk */
+    const Token* mSizeofsizeofSkip = nullptr;
+
+    /** sizeofFunction() has stopped reporting, see the 'break' it used to do */
+    bool mSizeofFunctionStopped = false;
 
-private:
     // Error messages..
     void sizeofsizeofError(const Token* tok);
     void sizeofCalculationError(const Token* tok, bool inconclusive);
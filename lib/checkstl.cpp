@@ -840,6 +840,17 @@ void CheckStl::stlOutOfBoundsError(const Token *tok, const std::string &num, con
         reportError(tok, Severity::error, "stlOutOfBounds", "$symbol:" + var + "\nWhen " + num + "==$symbol.size(), $symbol[" + num + "] is out of bounds.", CWE788, false);
 }
 
+const Library::Container *CheckStl::detectContainer(const Token *typeStart, bool iterator)
+{
+    const std::pair<const Token *, bool> key(typeStart, iterator);
+    const std::map<std::pair<const Token *, bool>, const Library::Container *>::const_iterator it = mContainerCache.find(key);
+    if (it != mContainerCache.end())
+        return it->second;
+    const Library::Container *container = mSettings->library.detectContainer(typeStart, iterator);
+    mContainerCache[key] = container;
+    return container;
+}
+
 void CheckStl::negativeIndex()
 {
     // Negative index is out of bounds..
@@ -851,7 +862,7 @@ void CheckStl::negativeIndex()
             const Variable * const var = tok->variable();
             if (!var || tok == var->nameToken())
                 continue;
-            const Library::Container * const container = mSettings->library.detectContainer(var->typeStartToken());
+            const Library::Container * const container = detectContainer(var->typeStartToken());
             if (!container || !container->arrayLike_indexOp)
                 continue;
             const ValueFlow::Value *index = tok->next()->astOperand2()->getValueLE(-1, mSettings);
@@ -1097,7 +1108,7 @@ void CheckStl::stlBoundaries()
         if (!var || !var->scope() || !var->scope()->isExecutable())
             continue;
 
-        const Library::Container* container = mSettings->library.detectContainer(var->typeStartToken(), true);
+        const Library::Container* container = detectContainer(var->typeStartToken(), true);
         if (!container || container->opLessAllowed)
             continue;
 
@@ -1158,7 +1169,7 @@ void CheckStl::if_find()
                 tok = tok->linkAt(1);
 
             else if (tok->variable() && Token::Match(tok, "%var% . %name% (")) {
-                container = mSettings->library.detectContainer(tok->variable()->typeStartToken());
+                container = detectContainer(tok->variable()->typeStartToken());
                 funcTok = tok->tokAt(2);
             }
 
@@ -1172,16 +1183,16 @@ void CheckStl::if_find()
                 funcTok = tok2->astParent()->next();
 
                 if (tok->variable()->isArrayOrPointer())
-                    container = mSettings->library.detectContainer(tok->variable()->typeStartToken());
+                    container = detectContainer(tok->variable()->typeStartToken());
                 else { // Container of container - find the inner container
-                    container = mSettings->library.detectContainer(tok->variable()->typeStartToken()); // outer container
+                    container = detectContainer(tok->variable()->typeStartToken()); // outer container
                     tok2 = Token::findsimplematch(tok->variable()->typeStartToken(), "<", tok->variable()->typeEndToken());
                     if (container && container->type_templateArgNo >= 0 && tok2) {
                         tok2 = tok2->next();
                         for (int j = 0; j < container->type_templateArgNo; j++)
                             tok2 = tok2->nextTemplateArgument();
 
-                        container = mSettings->library.detectContainer(tok2); // innner container
+                        container = detectContainer(tok2); // innner container
                     } else
                         container = nullptr;
                 }
@@ -1313,9 +1324,9 @@ void CheckStl::redundantCondition()
         const Token *any2 = var3->tokAt(4);
 
         // Check if all the "%name%" fields are the same and if all the "%any%" are the same..
-        if (var1->str() == var2->str() &&
-            var2->str() == var3->str() &&
-            any1->str() == any2->str()) {
+        if (var1->sameStr(var2) &&
+            var2->sameStr(var3) &&
+            any1->sameStr(any2)) {
             redundantIfRemoveError(tok);
         }
     }
@@ -1673,7 +1684,7 @@ void CheckStl::checkAutoPointer()
                         if (Token::simpleMatch(tok3->previous(), "[ ] )")) {
                             autoPointerArrayError(tok2->next());
                         } else if (tok3->varId()) {
-                            const Token *decltok = Token::findmatch(mTokenizer->tokens(), "%varid% = new %type%", tok3->varId());
+                            const Token *decltok = mTokenizer->list.findVarIdMatch("%varid% = new %type%", tok3->varId());
                             if (decltok && hasArrayEnd(decltok)) {
                                 autoPointerArrayError(tok2->next());
                             }
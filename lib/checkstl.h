@@ -29,6 +29,7 @@
 
 #include <map>
 #include <string>
+#include <utility>
 
 class ErrorLogger;
 class Scope;
@@ -53,6 +54,11 @@ public:
         : Check(myName(), tokenizer, settings, errorLogger) {
     }
 
+    /** @brief Create a bound instance, see Check::createInstance() */
+    Check *createInstance(const Tokenizer* tokenizer, const Settings* settings, ErrorLogger* errorLogger) const OVERRIDE {
+        return new CheckStl(tokenizer, settings, errorLogger);
+    }
+
     /** run checks, the token list is not simplified */
     virtual void runChecks(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) OVERRIDE {
         if (!tokenizer->isCPP()) {
@@ -92,6 +98,10 @@ public:
         checkStl.useStlAlgorithm();
     }
 
+    bool hasSimplifiedChecks(const Tokenizer* tokenizer, const Settings* /*settings*/) const OVERRIDE {
+        return tokenizer->isCPP();
+    }
+
     /** Accessing container out of bounds using ValueFlow */
     void outOfBounds();
 
@@ -192,6 +202,17 @@ private:
     bool isContainerSize(const Token *container, const Token *expr) const;
     bool isContainerSizeGE(const Token * containerToken, const Token *expr) const;
 
+    /**
+     * Library::detectContainer pattern-matches every configured container
+     * against the type tokens; the sub-checks ask for the same declarations
+     * over and over. Resolve each (type start token, iterator) query once
+     * and answer later queries from the table.
+     */
+    const Library::Container *detectContainer(const Token *typeStart, bool iterator = false);
+
+    /** (type start token, iterator) -> resolved container, see detectContainer */
+    std::map<std::pair<const Token *, bool>, const Library::Container *> mContainerCache;
+
     void missingComparisonError(const Token* incrementToken1, const Token* incrementToken2);
     void string_c_strThrowError(const Token* tok);
     void string_c_strError(const Token* tok);
@@ -57,45 +57,40 @@ void CheckType::checkTooBigBitwiseShift()
     if (mSettings->platformType == Settings::Unspecified)
         return;
 
-    for (const Token *tok = mTokenizer->tokens(); tok; tok = tok->next()) {
-        // C++ and macro: OUT(x<<y)
-        if (mTokenizer->isCPP() && Token::Match(tok, "[;{}] %name% (") && Token::simpleMatch(tok->linkAt(2), ") ;") && tok->next()->isUpperCaseName() && !tok->next()->function())
-            tok = tok->linkAt(2);
+    // shifts are interesting in executable code only, don't walk the declarations
+    const SymbolDatabase *symbolDatabase = mTokenizer->getSymbolDatabase();
+    for (const Scope * scope : symbolDatabase->functionScopes) {
+        for (const Token *tok = scope->bodyStart; tok != scope->bodyEnd; tok = tok->next()) {
+            // C++ and macro: OUT(x<<y)
+            if (mTokenizer->isCPP() && Token::Match(tok, "[;{}] %name% (") && Token::simpleMatch(tok->linkAt(2), ") ;") && tok->next()->isUpperCaseName() && !tok->next()->function())
+                tok = tok->linkAt(2);
 
-        if (!tok->astOperand1() || !tok->astOperand2())
-            continue;
+            if (!tok->astOperand1() || !tok->astOperand2())
+                continue;
 
-        if (!Token::Match(tok, "<<|>>|<<=|>>="))
-            continue;
+            if (!Token::Match(tok, "<<|>>|<<=|>>="))
+                continue;
 
-        // get number of bits of lhs
-        const ValueType * const lhstype = tok->astOperand1()->valueType();
-        if (!lhstype || !lhstype->isIntegral() || lhstype->pointer >= 1U)
-            continue;
-        // C11 Standard, section 6.5.7 Bitwise shift operators, states:
-        //   The integer promotions are performed on each of the operands.
-        //   The type of the result is that of the promoted left operand.
-        int lhsbits;
-        if ((lhstype->type == ValueType::Type::CHAR) ||
-            (lhstype->type == ValueType::Type::SHORT) ||
-            (lhstype->type == ValueType::Type::BOOL) ||
-            (lhstype->type == ValueType::Type::INT))
-            lhsbits = mSettings->int_bit;
-        else if (lhstype->type == ValueType::Type::LONG)
-            lhsbits = mSettings->long_bit;
-        else if (lhstype->type == ValueType::Type::LONGLONG)
-            lhsbits = mSettings->long_long_bit;
-        else
-            continue;
+            // get number of bits of lhs
+            const ValueType * const lhstype = tok->astOperand1()->valueType();
+            if (!lhstype || !lhstype->isIntegral() || lhstype->pointer >= 1U)
+                continue;
+            // C11 Standard, section 6.5.7 Bitwise shift operators, states:
+            //   The integer promotions are performed on each of the operands.
+            //   The type of the result is that of the promoted left operand.
+            const int lhsbits = lhstype->promotedTypeBits(*mSettings);
+            if (lhsbits == 0)
+                continue;
 
-        // Get biggest rhs value. preferably a value which doesn't have 'condition'.
-        const ValueFlow::Value * value = tok->astOperand2()->getValueGE(lhsbits, mSettings);
-        if (value && mSettings->isEnabled(value, false))
-            tooBigBitwiseShiftError(tok, lhsbits, *value);
-        else if (lhstype->sign == ValueType::Sign::SIGNED) {
-            value = tok->astOperand2()->getValueGE(lhsbits-1, mSettings);
+            // Get biggest rhs value. preferably a value which doesn't have 'condition'.
+            const ValueFlow::Value * value = tok->astOperand2()->getValueGE(lhsbits, mSettings);
             if (value && mSettings->isEnabled(value, false))
-                tooBigSignedBitwiseShiftError(tok, lhsbits, *value);
+                tooBigBitwiseShiftError(tok, lhsbits, *value);
+            else if (lhstype->sign == ValueType::Sign::SIGNED) {
+                value = tok->astOperand2()->getValueGE(lhsbits-1, mSettings);
+                if (value && mSettings->isEnabled(value, false))
+                    tooBigSignedBitwiseShiftError(tok, lhsbits, *value);
+            }
         }
     }
 }
@@ -157,15 +152,9 @@ void CheckType::checkIntegerOverflow()
         if (!vt || !vt->isIntegral() || vt->sign != ValueType::Sign::SIGNED)
             continue;
 
-        unsigned int bits;
-        if (vt->type == ValueType::Type::INT)
-            bits = mSettings->int_bit;
-        else if (vt->type == ValueType::Type::LONG)
-            bits = mSettings->long_bit;
-        else if (vt->type == ValueType::Type::LONGLONG)
-            bits = mSettings->long_long_bit;
-        else
+        if (vt->type < ValueType::Type::INT || vt->type > ValueType::Type::LONGLONG)
             continue;
+        const unsigned int bits = vt->typeBits(*mSettings);
 
         if (bits >= MathLib::bigint_bits)
             continue;
@@ -359,7 +348,7 @@ void CheckType::checkFloatToIntegerOverflow()
 {
     for (const Token *tok = mTokenizer->tokens(); tok; tok = tok->next()) {
         const ValueType *vtint, *vtfloat;
-        const std::list<ValueFlow::Value> *floatValues;
+        const ValueFlow::ValueList *floatValues;
 
         // Explicit cast
         if (Token::Match(tok, "( %name%") && tok->astOperand1() && !tok->astOperand2()) {
@@ -396,18 +385,8 @@ void CheckType::checkFloatToIntegerOverflow()
             else if ((-f.floatValue) > (1ULL<<62))
                 floatToIntegerOverflowError(tok, f);
             else if (mSettings->platformType != Settings::Unspecified) {
-                int bits = 0;
-                if (vtint->type == ValueType::Type::CHAR)
-                    bits = mSettings->char_bit;
-                else if (vtint->type == ValueType::Type::SHORT)
-                    bits = mSettings->short_bit;
-                else if (vtint->type == ValueType::Type::INT)
-                    bits = mSettings->int_bit;
-                else if (vtint->type == ValueType::Type::LONG)
-                    bits = mSettings->long_bit;
-                else if (vtint->type == ValueType::Type::LONGLONG)
-                    bits = mSettings->long_long_bit;
-                else
+                const int bits = vtint->typeBits(*mSettings);
+                if (bits == 0)
                     continue;
                 if (bits < MathLib::bigint_bits && f.floatValue >= (((MathLib::biguint)1) << bits))
                     floatToIntegerOverflowError(tok, f);
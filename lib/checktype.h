@@ -48,6 +48,11 @@ public:
         : Check(myName(), tokenizer, settings, errorLogger) {
     }
 
+    /** @brief Create a bound instance, see Check::createInstance() */
+    Check *createInstance(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) const OVERRIDE {
+        return new CheckType(tokenizer, settings, errorLogger);
+    }
+
     /** @brief Run checks against the normal token list */
     void runChecks(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) OVERRIDE {
         // These are not "simplified" because casts can't be ignored
@@ -66,6 +71,10 @@ public:
         (void)errorLogger;
     }
 
+    bool hasSimplifiedChecks(const Tokenizer * /*tokenizer*/, const Settings * /*settings*/) const OVERRIDE {
+        return false;
+    }
+
     /** @brief %Check for bitwise shift with too big right operand */
     void checkTooBigBitwiseShift();
 
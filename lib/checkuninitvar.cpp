@@ -67,6 +67,10 @@ void CheckUninitVar::check()
     // check every executable scope
     for (const Scope &scope : symbolDatabase->scopeList) {
         if (scope.isExecutable()) {
+            // this pass is strictly function local, cached results of an
+            // incremental run can be reused
+            if (functionResultsReplayed(&scope))
+                continue;
             checkScope(&scope, arrayTypeDefs);
         }
     }
@@ -74,6 +78,11 @@ void CheckUninitVar::check()
 
 void CheckUninitVar::checkScope(const Scope* scope, const std::set<std::string> &arrayTypeDefs)
 {
+    // Single pass over the scope body: where is each variable accessed? The
+    // recursive walks below scale with variable count * scope size, so skip
+    // them for variables that are never used after their declaration.
+    const DefUseIndex defUse(scope);
+
     for (const Variable &var : scope->varlist) {
         if ((mTokenizer->isCPP() && var.type() && !var.isPointer() && var.type()->needInitialization != Type::True) ||
             var.isStatic() || var.isExtern() || var.isReference())
@@ -86,6 +95,15 @@ void CheckUninitVar::checkScope(const Scope* scope, const std::set<std::string>
         if (Token::Match(var.nameToken()->next(), "[({:]"))
             continue;
 
+        // the declaration is the only access => the variable can't be read uninitialized.
+        // Variables declared in a for-loop header live outside the indexed scope body,
+        // so require that the indexed access really is the declaration.
+        if (var.declarationId() != 0U) {
+            const std::vector<DefUseIndex::Access> &accesses = defUse.accesses(var.declarationId());
+            if (accesses.size() == 1U && accesses.front().tok == var.nameToken())
+                continue;
+        }
+
         if (Token::Match(var.nameToken(), "%name% =")) { // Variable is initialized, but Rhs might be not
             checkRhs(var.nameToken(), var, NO_ALLOC, 0U, emptyString);
             continue;
@@ -140,7 +158,8 @@ void CheckUninitVar::checkScope(const Scope* scope, const std::set<std::string>
 
     if (scope->function) {
         for (const Variable &arg : scope->function->argumentList) {
-            if (arg.declarationId() && Token::Match(arg.typeStartToken(), "%type% * %name% [,)]")) {
+            if (arg.declarationId() && !defUse.accesses(arg.declarationId()).empty() &&
+                Token::Match(arg.typeStartToken(), "%type% * %name% [,)]")) {
                 // Treat the pointer as initialized until it is assigned by malloc
                 for (const Token *tok = scope->bodyStart; tok != scope->bodyEnd; tok = tok->next()) {
                     if (Token::Match(tok, "[;{}] %varid% = %name% (", arg.declarationId()) &&
@@ -1339,8 +1358,6 @@ bool CheckUninitVar::analyseWholeProgram(const CTU::FileInfo *ctu, const std::li
     bool foundErrors = false;
     (void)settings; // This argument is unused
 
-    const std::map<std::string, std::list<const CTU::FileInfo::CallBase *>> callsMap = ctu->getCallsMap();
-
     for (Check::FileInfo *fi1 : fileInfo) {
         const MyFileInfo *fi = dynamic_cast<MyFileInfo*>(fi1);
         if (!fi)
@@ -1351,7 +1368,6 @@ bool CheckUninitVar::analyseWholeProgram(const CTU::FileInfo *ctu, const std::li
             const std::list<ErrorLogger::ErrorMessage::FileLocation> &locationList =
                 ctu->getErrorPath(CTU::FileInfo::InvalidValueType::uninit,
                                   unsafeUsage,
-                                  callsMap,
                                   "Using argument ARG",
                                   &functionCall,
                                   false);
@@ -33,6 +33,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <istream>
+#include <unordered_set>
 #include <utility>
 //---------------------------------------------------------------------------
 
@@ -91,27 +92,37 @@ void CheckUnusedFunctions::parseTokens(const Tokenizer &tokenizer, const char Fi
         }
     }
 
+    // Resolve the markup tables once instead of looking them up through the
+    // file name for every token
+    const Library::CodeBlock *codeBlocks = doMarkup ? settings->library.markupCodeBlocks(FileName) : nullptr;
+    const std::unordered_set<std::string> *keywords = doMarkup ? settings->library.markupKeywords(FileName) : nullptr;
+    const std::unordered_set<std::string> *importers = doMarkup ? settings->library.markupImporters(FileName) : nullptr;
+
     // Function usage..
     for (const Token *tok = tokenizer.tokens(); tok; tok = tok->next()) {
 
         // parsing of library code to find called functions
-        if (settings->library.isexecutableblock(FileName, tok->str())) {
-            const Token * markupVarToken = tok->tokAt(settings->library.blockstartoffset(FileName));
+        // executable blocks are defined by markup extensions only, so don't
+        // look up the block table for each token in ordinary source files
+        if (codeBlocks && codeBlocks->isBlock(tok->str())) {
+            const Token * markupVarToken = tok->tokAt(codeBlocks->offset());
             // not found
             if (!markupVarToken)
                 continue;
             int scope = 0;
             bool start = true;
+            const std::string &blockStart = codeBlocks->start();
+            const std::string &blockEnd = codeBlocks->end();
             // find all function calls in library code (starts with '(', not if or while etc)
             while ((scope || start) && markupVarToken) {
-                if (markupVarToken->str() == settings->library.blockstart(FileName)) {
+                if (markupVarToken->str() == blockStart) {
                     scope++;
                     if (start) {
                         start = false;
                     }
-                } else if (markupVarToken->str() == settings->library.blockend(FileName))
+                } else if (markupVarToken->str() == blockEnd)
                     scope--;
-                else if (!settings->library.iskeyword(FileName, markupVarToken->str())) {
+                else if (!keywords || keywords->find(markupVarToken->str()) == keywords->end()) {
                     mFunctionCalls.insert(markupVarToken->str());
                     if (mFunctions.find(markupVarToken->str()) != mFunctions.end())
                         mFunctions[markupVarToken->str()].usedOtherFile = true;
@@ -129,7 +140,7 @@ void CheckUnusedFunctions::parseTokens(const Tokenizer &tokenizer, const char Fi
         }
 
         if (!doMarkup // only check source files
-            && settings->library.isexporter(tok->str()) && tok->next() != nullptr) {
+            && tok->isName() && settings->library.isexporter(tok->str()) && tok->next() != nullptr) {
             const Token * propToken = tok->next();
             while (propToken && propToken->str() != ")") {
                 if (settings->library.isexportedprefix(tok->str(), propToken->str())) {
@@ -152,7 +163,7 @@ void CheckUnusedFunctions::parseTokens(const Tokenizer &tokenizer, const char Fi
             }
         }
 
-        if (doMarkup && settings->library.isimporter(FileName, tok->str()) && tok->next()) {
+        if (importers && importers->find(tok->str()) != importers->end() && tok->next()) {
             const Token * propToken = tok->next();
             if (propToken->next()) {
                 propToken = propToken->next();
@@ -168,7 +179,7 @@ void CheckUnusedFunctions::parseTokens(const Tokenizer &tokenizer, const char Fi
             }
         }
 
-        if (settings->library.isreflection(tok->str())) {
+        if (tok->isName() && settings->library.isreflection(tok->str())) {
             const int argIndex = settings->library.reflectionArgument(tok->str());
             if (argIndex >= 0) {
                 const Token * funcToken = tok->next();
@@ -372,72 +383,33 @@ std::string CheckUnusedFunctions::analyzerInfo() const
     return ret.str();
 }
 
-namespace {
-    struct Location {
-        Location() : lineNumber(0) {}
-        Location(const std::string &f, const int l) : fileName(f), lineNumber(l) {}
-        std::string fileName;
-        int lineNumber;
-    };
-}
-
-void CheckUnusedFunctions::analyseWholeProgram(ErrorLogger * const errorLogger, const std::string &buildDir)
+void CheckUnusedFunctions::WholeProgramInfo::loadInfo(const tinyxml2::XMLElement *info, const std::string &sourcefile)
 {
-    std::map<std::string, Location> decls;
-    std::set<std::string> calls;
-
-    const std::string filesTxt(buildDir + "/files.txt");
-    std::ifstream fin(filesTxt.c_str());
-    std::string filesTxtLine;
-    while (std::getline(fin, filesTxtLine)) {
-        const std::string::size_type firstColon = filesTxtLine.find(':');
-        if (firstColon == std::string::npos)
+    for (const tinyxml2::XMLElement *e = info->FirstChildElement(); e; e = e->NextSiblingElement()) {
+        const char* functionName = e->Attribute("functionName");
+        if (functionName == nullptr)
             continue;
-        const std::string::size_type secondColon = filesTxtLine.find(':', firstColon+1);
-        if (secondColon == std::string::npos)
-            continue;
-        const std::string xmlfile = buildDir + '/' + filesTxtLine.substr(0,firstColon);
-        const std::string sourcefile = filesTxtLine.substr(secondColon+1);
-
-        tinyxml2::XMLDocument doc;
-        const tinyxml2::XMLError error = doc.LoadFile(xmlfile.c_str());
-        if (error != tinyxml2::XML_SUCCESS)
-            continue;
-
-        const tinyxml2::XMLElement * const rootNode = doc.FirstChildElement();
-        if (rootNode == nullptr)
+        if (std::strcmp(e->Name(),"functioncall") == 0) {
+            mCalls.insert(functionName);
             continue;
-
-        for (const tinyxml2::XMLElement *e = rootNode->FirstChildElement(); e; e = e->NextSiblingElement()) {
-            if (std::strcmp(e->Name(), "FileInfo") != 0)
-                continue;
-            const char *checkattr = e->Attribute("check");
-            if (checkattr == nullptr || std::strcmp(checkattr,"CheckUnusedFunctions") != 0)
-                continue;
-            for (const tinyxml2::XMLElement *e2 = e->FirstChildElement(); e2; e2 = e2->NextSiblingElement()) {
-                const char* functionName = e2->Attribute("functionName");
-                if (functionName == nullptr)
-                    continue;
-                if (std::strcmp(e2->Name(),"functioncall") == 0) {
-                    calls.insert(functionName);
-                    continue;
-                } else if (std::strcmp(e2->Name(),"functiondecl") == 0) {
-                    const char* lineNumber = e2->Attribute("lineNumber");
-                    if (lineNumber)
-                        decls[functionName] = Location(sourcefile, std::atoi(lineNumber));
-                }
-            }
+        } else if (std::strcmp(e->Name(),"functiondecl") == 0) {
+            const char* lineNumber = e->Attribute("lineNumber");
+            if (lineNumber)
+                mDecls[functionName] = Location(sourcefile, std::atoi(lineNumber));
         }
     }
+}
 
-    for (std::map<std::string, Location>::const_iterator decl = decls.begin(); decl != decls.end(); ++decl) {
+void CheckUnusedFunctions::WholeProgramInfo::check(ErrorLogger * const errorLogger) const
+{
+    for (std::map<std::string, Location>::const_iterator decl = mDecls.begin(); decl != mDecls.end(); ++decl) {
         const std::string &functionName = decl->first;
 
         if (functionName == "main" || functionName == "WinMain" || functionName == "_tmain" ||
             functionName == "if")
             continue;
 
-        if (calls.find(functionName) == calls.end() && !isOperatorFunction(functionName)) {
+        if (mCalls.find(functionName) == mCalls.end() && !isOperatorFunction(functionName)) {
             const Location &loc = decl->second;
             unusedFunctionError(errorLogger, loc.fileName, loc.lineNumber, functionName);
         }
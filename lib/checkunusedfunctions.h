@@ -50,6 +50,11 @@ public:
         : Check(myName(), tokenizer, settings, errorLogger) {
     }
 
+    /** @brief Create a bound instance, see Check::createInstance() */
+    Check *createInstance(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) const OVERRIDE {
+        return new CheckUnusedFunctions(tokenizer, settings, errorLogger);
+    }
+
     static void clear() {
         instance.mFunctions.clear();
         instance.mFunctionCalls.clear();
@@ -73,8 +78,27 @@ public:
 
     std::string analyzerInfo() const;
 
-    /** @brief Combine and analyze all analyzerInfos for all TUs */
-    static void analyseWholeProgram(ErrorLogger * const errorLogger, const std::string &buildDir);
+    /** @brief Combined analyzer-info data of all TUs for the whole program
+     * analysis. CppCheck::analyseWholeProgram() loads the
+     * "CheckUnusedFunctions" file info of each TU into it while it walks
+     * the analyzer info files and then reports the functions that are
+     * never called. */
+    class CPPCHECKLIB WholeProgramInfo {
+    public:
+        void loadInfo(const tinyxml2::XMLElement *info, const std::string &sourcefile);
+        void check(ErrorLogger * const errorLogger) const;
+
+    private:
+        struct Location {
+            Location() : lineNumber(0) {}
+            Location(const std::string &f, const int l) : fileName(f), lineNumber(l) {}
+            std::string fileName;
+            int lineNumber;
+        };
+
+        std::map<std::string, Location> mDecls;
+        std::set<std::string> mCalls;
+    };
 
 private:
 
@@ -96,6 +120,10 @@ private:
     void runSimplifiedChecks(const Tokenizer* /*tokenizer*/, const Settings* /*settings*/, ErrorLogger* /*errorLogger*/) OVERRIDE {
     }
 
+    bool hasSimplifiedChecks(const Tokenizer* /*tokenizer*/, const Settings* /*settings*/) const OVERRIDE {
+        return false;
+    }
+
     static std::string myName() {
         return "Unused functions";
     }
@@ -1101,6 +1101,13 @@ void CheckUnusedVar::checkFunctionVariableUsage()
         if (scope->hasInlineOrLambdaFunction())
             continue;
 
+        // this pass is strictly function local, cached results of an
+        // incremental run can be reused
+        if (functionResultsReplayed(scope))
+            continue;
+
+        const DefUseIndex defUse(scope);
+
         for (const Token *tok = scope->bodyStart; tok != scope->bodyEnd; tok = tok->next()) {
             if (findLambdaEndToken(tok))
                 // todo: handle lambdas
@@ -1155,7 +1162,7 @@ void CheckUnusedVar::checkFunctionVariableUsage()
 
             const Token *expr = varDecl ? varDecl : tok->astOperand1();
 
-            FwdAnalysis fwdAnalysis(mTokenizer->isCPP(), mSettings->library);
+            FwdAnalysis fwdAnalysis(mTokenizer->isCPP(), mSettings->library, &defUse);
             if (fwdAnalysis.unusedValue(expr, start, scope->bodyEnd))
                 // warn
                 unreadVariableError(tok, expr->expressionString(), false);
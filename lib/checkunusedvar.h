@@ -52,6 +52,11 @@ public:
         : Check(myName(), tokenizer, settings, errorLogger) {
     }
 
+    /** @brief Create a bound instance, see Check::createInstance() */
+    Check *createInstance(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) const OVERRIDE {
+        return new CheckUnusedVar(tokenizer, settings, errorLogger);
+    }
+
     /** @brief Run checks against the normal token list */
     void runChecks(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger) OVERRIDE {
         CheckUnusedVar checkUnusedVar(tokenizer, settings, errorLogger);
@@ -68,6 +73,10 @@ public:
         (void)errorLogger;
     }
 
+    bool hasSimplifiedChecks(const Tokenizer * /*tokenizer*/, const Settings * /*settings*/) const OVERRIDE {
+        return false;
+    }
+
     /** @brief %Check for unused function variables */
     void checkFunctionVariableUsage_iterateScopes(const Scope* const scope, Variables& variables);
     void checkFunctionVariableUsage();
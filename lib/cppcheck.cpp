@@ -26,18 +26,27 @@
 #include "platform.h"
 #include "preprocessor.h" // Preprocessor
 #include "suppressions.h"
+#include "symboldatabase.h"
+#include "templatesimplifier.h"
 #include "timer.h"
 #include "token.h"
 #include "tokenize.h" // Tokenizer
 #include "tokenlist.h"
+#include "valueflow.h"
 #include "version.h"
 
 #include <simplecpp.h>
 #include <tinyxml2.h>
 #include <algorithm>
+#include <cstdlib>
 #include <cstring>
+#include <ctime>
+#include <fstream>
+#include <map>
 #include <new>
 #include <set>
+#include <sstream>
+#include <stack>
 #include <stdexcept>
 #include <vector>
 
@@ -46,11 +55,35 @@
 #include <pcre.h>
 #endif
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 static const char Version[] = CPPCHECK_VERSION_STRING;
 static const char ExtraVersion[] = "";
 
 static TimerResults S_timerResults;
 
+namespace {
+    /** Emits one Chrome trace span (--trace-report) for the lifetime of
+     * the object. A no-op unless trace collection is enabled. */
+    class TraceSpan {
+    public:
+        explicit TraceSpan(const std::string &name)
+            : mName(name), mBegin(Timer::wallSeconds()) {
+        }
+        ~TraceSpan() {
+            S_timerResults.AddTraceEvent(mName, mBegin, Timer::wallSeconds() - mBegin, Timer::threadId());
+        }
+    private:
+        const std::string mName;
+        const double mBegin;
+    };
+}
+
 // CWE ids used
 static const CWE CWE398(398U);  // Indicator of Poor Code Quality
 
@@ -68,8 +101,9 @@ static std::vector<std::string> split(const std::string &str, const std::string
 }
 
 CppCheck::CppCheck(ErrorLogger &errorLogger, bool useGlobalSuppressions)
-    : mErrorLogger(errorLogger), mExitCode(0), mSuppressInternalErrorFound(false), mUseGlobalSuppressions(useGlobalSuppressions), mTooManyConfigs(false), mSimplify(true)
+    : mErrorLogger(errorLogger), mExitCode(0), mSuppressInternalErrorFound(false), mUseGlobalSuppressions(useGlobalSuppressions), mTooManyConfigs(false), mSimplify(true), mFileContentFromDisk(false), mUnattributedFindings(0)
 {
+    Check::SubCheck::setTimerResults(&S_timerResults);
 }
 
 CppCheck::~CppCheck()
@@ -78,9 +112,19 @@ CppCheck::~CppCheck()
         delete mFileInfo.back();
         mFileInfo.pop_back();
     }
+    if (mSettings.verbose) {
+        const std::string analyzerStatistics = mAnalyzerInformation.statisticsString();
+        if (!analyzerStatistics.empty())
+            mErrorLogger.reportOut(analyzerStatistics);
+    }
     S_timerResults.ShowResults(mSettings.showtime);
 }
 
+const TimerResults &CppCheck::timerResults()
+{
+    return S_timerResults;
+}
+
 const char * CppCheck::version()
 {
     return Version;
@@ -91,8 +135,208 @@ const char * CppCheck::extraVersion()
     return ExtraVersion;
 }
 
+// not const Settings - Suppressions::dump() is not const
+/**
+ * Cheap structural validation of the preprocessed tokens: bracket
+ * balance only. A half-generated file with unbalanced brackets would
+ * burn through tokenization and most of the simplification pipeline
+ * before the syntax error is finally detected; rejecting it here costs
+ * one linear scan. Returns the offending token, or nullptr when the
+ * brackets balance.
+ */
+static const simplecpp::Token *findUnmatchedBracket(const simplecpp::TokenList &tokens)
+{
+    std::stack<const simplecpp::Token *> brackets;
+    for (const simplecpp::Token *tok = tokens.cfront(); tok; tok = tok->next) {
+        switch (tok->op) {
+        case '(':
+        case '[':
+        case '{':
+            brackets.push(tok);
+            break;
+        case ')':
+        case ']':
+        case '}': {
+            const char open = (tok->op == ')') ? '(' : (tok->op == ']') ? '[' : '{';
+            if (brackets.empty() || brackets.top()->op != open)
+                return tok;
+            brackets.pop();
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    return brackets.empty() ? nullptr : brackets.top();
+}
+
+/**
+ * Order the configurations so that a budget limited prefix covers as many
+ * distinct preprocessor branches as possible. Every configuration is a ';'
+ * separated list of defines, each standing for one preprocessor branch; a
+ * greedy set cover picks next the configuration that enables the most
+ * branches that no earlier pick enabled. The default configuration ""
+ * stays first - its findings are the baseline.
+ */
+static std::vector<std::string> selectCoveringConfigurations(const std::set<std::string> &configurations)
+{
+    std::vector<std::pair<std::string, std::set<std::string> > > candidates;
+    for (const std::string &cfg : configurations) {
+        std::set<std::string> defines;
+        for (const std::string &def : split(cfg, ";"))
+            defines.insert(def.substr(0, def.find('=')));
+        candidates.push_back(std::make_pair(cfg, defines));
+    }
+
+    std::vector<std::string> ordered;
+    std::vector<bool> used(candidates.size(), false);
+    std::set<std::string> covered;
+
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+        if (candidates[i].first.empty()) {
+            ordered.push_back(candidates[i].first);
+            used[i] = true;
+            break;
+        }
+    }
+
+    while (ordered.size() < candidates.size()) {
+        std::size_t best = candidates.size();
+        std::size_t bestNewDefines = 0;
+        for (std::size_t i = 0; i < candidates.size(); ++i) {
+            if (used[i])
+                continue;
+            std::size_t newDefines = 0;
+            for (const std::string &define : candidates[i].second) {
+                if (covered.find(define) == covered.end())
+                    ++newDefines;
+            }
+            if (best == candidates.size() || newDefines > bestNewDefines) {
+                best = i;
+                bestNewDefines = newDefines;
+            }
+        }
+        ordered.push_back(candidates[best].first);
+        used[best] = true;
+        covered.insert(candidates[best].second.begin(), candidates[best].second.end());
+    }
+
+    return ordered;
+}
+
+static std::string analyzerToolInfo(Settings &settings)
+{
+    std::ostringstream toolinfo;
+    toolinfo << CPPCHECK_VERSION_STRING;
+    toolinfo << (settings.isEnabled(Settings::WARNING) ? 'w' : ' ');
+    toolinfo << (settings.isEnabled(Settings::STYLE) ? 's' : ' ');
+    toolinfo << (settings.isEnabled(Settings::PERFORMANCE) ? 'p' : ' ');
+    toolinfo << (settings.isEnabled(Settings::PORTABILITY) ? 'p' : ' ');
+    toolinfo << (settings.isEnabled(Settings::INFORMATION) ? 'i' : ' ');
+    toolinfo << settings.userDefines;
+    settings.nomsg.dump(toolinfo);
+    return toolinfo.str();
+}
+
+// The include-closure shortcut is also invalid if includes would resolve
+// differently, so fold the include configuration into its toolinfo.
+static std::string closureToolInfo(Settings &settings)
+{
+    std::string ret = analyzerToolInfo(settings) + '\n';
+    for (const std::string &path : settings.includePaths)
+        ret += path + ';';
+    ret += '\n';
+    for (const std::string &include : settings.userIncludes)
+        ret += include + ';';
+    return ret;
+}
+
+namespace {
+    /**
+     * Contents of a source file, memory mapped where the platform supports
+     * it so the lexer reads from one contiguous buffer instead of going
+     * through a file stream. Falls back to reading the whole file into
+     * memory.
+     */
+    class SourceFile {
+    public:
+        explicit SourceFile(const std::string &path) {
+#ifndef _WIN32
+            const int fd = open(path.c_str(), O_RDONLY);
+            if (fd >= 0) {
+                struct stat filestat;
+                if (fstat(fd, &filestat) == 0 && S_ISREG(filestat.st_mode) && filestat.st_size > 0) {
+                    void * const map = mmap(nullptr, filestat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (map != MAP_FAILED) {
+                        mMapped = map;
+                        mData = static_cast<const char *>(map);
+                        mMappedSize = mSize = static_cast<std::size_t>(filestat.st_size);
+                    }
+                }
+                close(fd);
+            }
+            if (mMapped)
+                return;
+#endif
+            std::ifstream fin(path);
+            if (!fin.is_open())
+                return;
+            std::ostringstream ostr;
+            ostr << fin.rdbuf();
+            mContent = ostr.str();
+            mData = mContent.c_str();
+            mSize = mContent.size();
+        }
+
+        ~SourceFile() {
+#ifndef _WIN32
+            if (mMapped)
+                munmap(mMapped, mMappedSize);
+#endif
+        }
+
+        SourceFile(const SourceFile &) = delete;
+        SourceFile &operator=(const SourceFile &) = delete;
+
+        bool isOpen() const {
+            return mData != nullptr;
+        }
+        const char *data() const {
+            return mData;
+        }
+        std::size_t size() const {
+            return mSize;
+        }
+
+    private:
+        const char *mData = nullptr;
+        std::size_t mSize = 0;
+        std::string mContent;
+#ifndef _WIN32
+        void *mMapped = nullptr;
+        std::size_t mMappedSize = 0;
+#endif
+    };
+
+    /** istream over an in-memory buffer, see SourceFile */
+    class SourceBuffer : public std::streambuf {
+    public:
+        SourceBuffer(const char *data, std::size_t size) {
+            char * const p = const_cast<char *>(data);
+            setg(p, p, p + size);
+        }
+    };
+}
+
 unsigned int CppCheck::check(const std::string &path)
 {
+    mFileContentFromDisk = true;
+    SourceFile sourceFile(path);
+    if (sourceFile.isOpen()) {
+        SourceBuffer buffer(sourceFile.data(), sourceFile.size());
+        std::istream in(&buffer);
+        return checkFile(Path::simplifyPath(path), emptyString, in);
+    }
     std::ifstream fin(path);
     return checkFile(Path::simplifyPath(path), emptyString, fin);
 }
@@ -115,6 +359,13 @@ unsigned int CppCheck::check(const ImportProject::FileSettings &fs)
     if (fs.platformType != Settings::Unspecified) {
         temp.mSettings.platform(fs.platformType);
     }
+    temp.mFileContentFromDisk = true;
+    SourceFile sourceFile(fs.filename);
+    if (sourceFile.isOpen()) {
+        SourceBuffer buffer(sourceFile.data(), sourceFile.size());
+        std::istream in(&buffer);
+        return temp.checkFile(Path::simplifyPath(fs.filename), fs.cfg, in);
+    }
     std::ifstream fin(fs.filename);
     return temp.checkFile(Path::simplifyPath(fs.filename), fs.cfg, fin);
 }
@@ -123,6 +374,15 @@ unsigned int CppCheck::checkFile(const std::string& filename, const std::string
 {
     mExitCode = 0;
     mSuppressInternalErrorFound = false;
+    S_timerResults.collectTraceEvents(!mSettings.traceReport.empty());
+    // sticky: turning the accounting off again could underflow the
+    // live counters of objects created while it was on
+    if (mSettings.showtime != SHOWTIME_NONE)
+        MemUsage::enabled = true;
+
+    // soft deadline for this file (--max-time-per-file), so one
+    // pathological file cannot hold a worker indefinitely
+    const std::time_t maxFileTime = (mSettings.maxTimePerFile > 0) ? (std::time(nullptr) + mSettings.maxTimePerFile) : 0;
 
     // only show debug warnings for accepted C/C++ source files
     if (!Path::acceptFile(filename))
@@ -158,6 +418,26 @@ unsigned int CppCheck::checkFile(const std::string& filename, const std::string
         plistFile.close();
     }
 
+    // Cached results can only be reused with --dump if the dump file from
+    // the previous run is still there for the addons to read
+    const std::string dumpFilename(mSettings.dumpFile.empty() ? (filename + ".dump") : mSettings.dumpFile);
+    const bool dumpIsUpToDate = !mSettings.dump || Path::fileExists(dumpFilename);
+
+    // If the include closure recorded in the analyzer information is
+    // untouched, reuse the stored results without even preprocessing the file
+    if (!mSettings.buildDir.empty() && mFileContentFromDisk && mSettings.plistOutput.empty() && dumpIsUpToDate) {
+        const std::string analyzerInfoFile = AnalyzerInformation::getAnalyzerInfoFile(mSettings.buildDir, filename, cfgname);
+        std::list<ErrorLogger::ErrorMessage> errors;
+        if (AnalyzerInformation::filesUnchanged(analyzerInfoFile, closureToolInfo(mSettings), &errors)) {
+            mAnalyzerInformation.statistics.reused++;
+            while (!errors.empty()) {
+                reportErr(errors.front());
+                errors.pop_front();
+            }
+            return mExitCode;
+        }
+    }
+
     CheckUnusedFunctions checkUnusedFunctions(nullptr, nullptr, nullptr);
 
     bool internalErrorFound(false);
@@ -203,6 +483,16 @@ unsigned int CppCheck::checkFile(const std::string& filename, const std::string
 
         preprocessor.loadFiles(tokens1, files);
 
+        // Probe the raw tokens once for the trigger identifiers registered
+        // by the checks; a check whose trigger cannot match is skipped for
+        // every configuration of this file.
+        mSkippedChecks.clear();
+        for (const Check *check : Check::instances()) {
+            const char * const trigger = check->triggerIdentifier();
+            if (trigger && !preprocessor.containsIdentifier(tokens1, trigger))
+                mSkippedChecks.insert(check->name());
+        }
+
         if (!mSettings.plistOutput.empty()) {
             std::string filename2;
             if (filename.find('/') != std::string::npos)
@@ -214,14 +504,48 @@ unsigned int CppCheck::checkFile(const std::string& filename, const std::string
             plistFile << ErrorLogger::plistHeader(version(), files);
         }
 
+        // Parse inline suppressions while the comments are still available
+        preprocessor.inlineSuppressions(tokens1);
+
+        if (!mSettings.buildDir.empty()) {
+            // Calculate checksum so it can be compared with old checksum / future checksums.
+            // calculateChecksum() skips comment tokens so the result matches a
+            // checksum taken after removeComments(). This must happen before
+            // the dump file is opened below - when the TU is unchanged the
+            // cached dump from the previous run is kept as-is so addons only
+            // need to be rerun on dumps that were actually rewritten.
+            const unsigned int checksum = preprocessor.calculateChecksum(tokens1, analyzerToolInfo(mSettings));
+            std::list<ErrorLogger::ErrorMessage> errors;
+            if (!mAnalyzerInformation.analyzeFile(mSettings.buildDir, mSettings.cacheDir, filename, cfgname, checksum, &errors)) {
+                if (dumpIsUpToDate) {
+                    while (!errors.empty()) {
+                        reportErr(errors.front());
+                        errors.pop_front();
+                    }
+                    return mExitCode;  // known results => no need to reanalyze file
+                }
+                // the dump file is gone - reanalyze to regenerate it, the
+                // checks report the recorded errors again along the way
+            }
+
+            // Record the include closure so the next run can detect an
+            // untouched TU before preprocessing it
+            if (mFileContentFromDisk) {
+                std::list<std::string> closure = preprocessor.getIncludedFiles();
+                closure.push_front(filename);
+                mAnalyzerInformation.setFileHashes(closureToolInfo(mSettings), closure);
+            }
+        }
+
         // write dump file xml prolog
         std::ofstream fdump;
+        // seek index appended to the dump, see the epilog below
+        std::ostringstream fdumpIndex;
         if (mSettings.dump) {
-            const std::string dumpfile(mSettings.dumpFile.empty() ? (filename + ".dump") : mSettings.dumpFile);
-            fdump.open(dumpfile);
+            fdump.open(dumpFilename);
             if (fdump.is_open()) {
-                fdump << "<?xml version=\"1.0\"?>" << std::endl;
-                fdump << "<dumps>" << std::endl;
+                fdump << "<?xml version=\"1.0\"?>" << '\n';
+                fdump << "<dumps>" << '\n';
                 fdump << "  <platform"
                       << " name=\"" << mSettings.platformString() << '\"'
                       << " char_bit=\"" << mSettings.char_bit << '\"'
@@ -231,52 +555,28 @@ unsigned int CppCheck::checkFile(const std::string& filename, const std::string
                       << " long_long_bit=\"" << mSettings.long_long_bit << '\"'
                       << " pointer_bit=\"" << (mSettings.sizeof_pointer * mSettings.char_bit) << '\"'
                       << "/>\n";
-                fdump << "  <rawtokens>" << std::endl;
-                for (unsigned int i = 0; i < files.size(); ++i)
-                    fdump << "    <file index=\"" << i << "\" name=\"" << ErrorLogger::toxml(files[i]) << "\"/>" << std::endl;
-                for (const simplecpp::Token *tok = tokens1.cfront(); tok; tok = tok->next) {
-                    fdump << "    <tok "
-                          << "fileIndex=\"" << tok->location.fileIndex << "\" "
-                          << "linenr=\"" << tok->location.line << "\" "
-                          << "str=\"" << ErrorLogger::toxml(tok->str()) << "\""
-                          << "/>" << std::endl;
+                if (mSettings.isDumpSectionEnabled("rawtokens")) {
+                    fdump << "  <rawtokens>" << '\n';
+                    for (unsigned int i = 0; i < files.size(); ++i)
+                        fdump << "    <file index=\"" << i << "\" name=\"" << ErrorLogger::toxml(files[i]) << "\"/>" << '\n';
+                    for (const simplecpp::Token *tok = tokens1.cfront(); tok; tok = tok->next) {
+                        fdump << "    <tok "
+                              << "fileIndex=\"" << tok->location.fileIndex << "\" "
+                              << "linenr=\"" << tok->location.line << "\" "
+                              << "str=\"" << ErrorLogger::toxml(tok->str()) << "\""
+                              << "/>" << '\n';
+                    }
+                    fdump << "  </rawtokens>" << '\n';
                 }
-                fdump << "  </rawtokens>" << std::endl;
             }
         }
 
-        // Parse comments and then remove them
-        preprocessor.inlineSuppressions(tokens1);
-        if (mSettings.dump && fdump.is_open()) {
+        if (mSettings.dump && fdump.is_open() && mSettings.isDumpSectionEnabled("suppressions")) {
             mSettings.nomsg.dump(fdump);
         }
         tokens1.removeComments();
         preprocessor.removeComments();
 
-        if (!mSettings.buildDir.empty()) {
-            // Get toolinfo
-            std::ostringstream toolinfo;
-            toolinfo << CPPCHECK_VERSION_STRING;
-            toolinfo << (mSettings.isEnabled(Settings::WARNING) ? 'w' : ' ');
-            toolinfo << (mSettings.isEnabled(Settings::STYLE) ? 's' : ' ');
-            toolinfo << (mSettings.isEnabled(Settings::PERFORMANCE) ? 'p' : ' ');
-            toolinfo << (mSettings.isEnabled(Settings::PORTABILITY) ? 'p' : ' ');
-            toolinfo << (mSettings.isEnabled(Settings::INFORMATION) ? 'i' : ' ');
-            toolinfo << mSettings.userDefines;
-            mSettings.nomsg.dump(toolinfo);
-
-            // Calculate checksum so it can be compared with old checksum / future checksums
-            const unsigned int checksum = preprocessor.calculateChecksum(tokens1, toolinfo.str());
-            std::list<ErrorLogger::ErrorMessage> errors;
-            if (!mAnalyzerInformation.analyzeFile(mSettings.buildDir, filename, cfgname, checksum, &errors)) {
-                while (!errors.empty()) {
-                    reportErr(errors.front());
-                    errors.pop_front();
-                }
-                return mExitCode;  // known results => no need to reanalyze file
-            }
-        }
-
         // Get directives
         preprocessor.setDirectives(tokens1);
         preprocessor.simplifyPragmaAsm(&tokens1);
@@ -304,10 +604,10 @@ unsigned int CppCheck::checkFile(const std::string& filename, const std::string
                 continue;
 
             std::string code;
-            const std::list<Directive> &directives = preprocessor.getDirectives();
+            const std::vector<Directive> &directives = preprocessor.getDirectives();
             for (const Directive &dir : directives) {
                 if (dir.str.compare(0,8,"#define ") == 0)
-                    code += "#line " + MathLib::toString(dir.linenr) + " \"" + dir.file + "\"\n" + dir.str + '\n';
+                    code += "#line " + MathLib::toString(dir.linenr) + " \"" + *dir.file + "\"\n" + dir.str + '\n';
             }
             Tokenizer tokenizer2(&mSettings, this);
             std::istringstream istr2(code);
@@ -316,7 +616,12 @@ unsigned int CppCheck::checkFile(const std::string& filename, const std::string
             break;
         }
 
+        // With more configurations than the budget, don't just check the
+        // alphabetically first ones: order them so the checked subset
+        // enables as many distinct preprocessor branches as possible.
+        std::vector<std::string> orderedConfigurations(configurations.begin(), configurations.end());
         if (!mSettings.force && configurations.size() > mSettings.maxConfigs) {
+            orderedConfigurations = selectCoveringConfigurations(configurations);
             if (mSettings.isEnabled(Settings::INFORMATION)) {
                 tooManyConfigsError(Path::toNativeSeparators(filename),configurations.size());
             } else {
@@ -325,14 +630,23 @@ unsigned int CppCheck::checkFile(const std::string& filename, const std::string
         }
 
         std::set<unsigned long long> checksums;
+        std::set<unsigned long long> preprocessedChecksums;
+        // most template instantiations are identical in every configuration;
+        // expand them once and copy the output into the other configurations
+        TemplateExpansionCache templateExpansionCache;
         unsigned int checkCount = 0;
         bool hasValidConfig = false;
         std::list<std::string> configurationError;
-        for (const std::string &currCfg : configurations) {
+        for (const std::string &currCfg : orderedConfigurations) {
             // bail out if terminated
             if (mSettings.terminated())
                 break;
 
+            // the deadline passed - drop the remaining configurations, the
+            // findings so far were already reported
+            if (maxFileTime > 0 && std::time(nullptr) > maxFileTime)
+                break;
+
             // Check only a few configurations (default 12), after that bail out, unless --force
             // was used.
             if (!mSettings.force && ++checkCount > mSettings.maxConfigs)
@@ -350,6 +664,10 @@ unsigned int CppCheck::checkFile(const std::string& filename, const std::string
                 mCurrentConfig = currCfg;
             }
 
+            // one span per checked configuration, so the trace timeline
+            // shows which file and configuration each worker was busy with
+            TraceSpan traceSpan("check " + filename + (mCurrentConfig.empty() ? emptyString : (" [" + mCurrentConfig + "]")));
+
             if (mSettings.preprocessOnly) {
                 Timer t("Preprocessor::getcode", mSettings.showtime, &S_timerResults);
                 std::string codeWithoutCfg = preprocessor.getcode(tokens1, mCurrentConfig, files, true);
@@ -373,6 +691,14 @@ unsigned int CppCheck::checkFile(const std::string& filename, const std::string
             Tokenizer mTokenizer(&mSettings, this);
             if (mSettings.showtime != SHOWTIME_NONE)
                 mTokenizer.setTimerResults(&S_timerResults);
+            // the tokenizer passes and the check loops stop at their pass
+            // boundaries when the deadline passes
+            if (maxFileTime > 0)
+                mTokenizer.setMaxTime(maxFileTime);
+            // with a single configuration there is nobody to share with and
+            // filling the cache would only cost time and memory
+            if (configurations.size() > 1)
+                mTokenizer.setTemplateExpansionCache(&templateExpansionCache);
 
             try {
                 bool result;
@@ -380,6 +706,31 @@ unsigned int CppCheck::checkFile(const std::string& filename, const std::string
                 // Create tokens, skip rest of iteration if failed
                 Timer timer("Tokenizer::createTokens", mSettings.showtime, &S_timerResults);
                 const simplecpp::TokenList &tokensP = preprocessor.preprocess(tokens1, mCurrentConfig, files, true);
+
+                // Fail fast on hopeless input before building the check
+                // token list for it. The message matches the one
+                // Tokenizer::unmatchedToken() would have produced much
+                // later in the pipeline.
+                if (const simplecpp::Token *unmatched = findUnmatchedBracket(tokensP)) {
+                    hasValidConfig = true;
+                    std::list<ErrorLogger::ErrorMessage::FileLocation> locationList;
+                    ErrorLogger::ErrorMessage::FileLocation loc;
+                    loc.line = unmatched->location.line;
+                    loc.col = unmatched->location.col;
+                    loc.setfile(Path::toNativeSeparators(unmatched->location.file()));
+                    locationList.push_back(loc);
+                    const ErrorLogger::ErrorMessage errmsg(locationList,
+                                                           filename,
+                                                           Severity::error,
+                                                           "Unmatched '" + unmatched->str() + "'. Configuration: '" + mCurrentConfig + "'.",
+                                                           "syntaxError",
+                                                           false);
+                    reportErr(errmsg);
+                    if (!mSuppressInternalErrorFound)
+                        internalErrorFound = true;
+                    continue;
+                }
+
                 mTokenizer.createTokens(&tokensP);
                 timer.Stop();
                 hasValidConfig = true;
@@ -398,6 +749,31 @@ unsigned int CppCheck::checkFile(const std::string& filename, const std::string
                 if (mSettings.checkConfiguration)
                     continue;
 
+                // Skip if we already met the same preprocessed token list. Several
+                // configurations often preprocess to identical streams, and everything
+                // below only depends on the tokens; skipping here avoids the whole
+                // simplification/analysis for duplicates. Don't skip when dumping so
+                // each configuration still gets its <dump> element.
+                if ((mSettings.force || mSettings.maxConfigs > 1) && !mSettings.dump) {
+                    const unsigned long long checksum = mTokenizer.list.calculateChecksum();
+                    if (preprocessedChecksums.find(checksum) != preprocessedChecksums.end()) {
+                        if (mSettings.debugwarnings)
+                            purgedConfigurationMessage(filename, mCurrentConfig);
+                        continue;
+                    }
+                    preprocessedChecksums.insert(checksum);
+                }
+
+                // Bound the peak memory for huge generated files: with a
+                // single configuration the raw token lists of the file and
+                // its includes are not needed anymore once the check tokens
+                // have been created, so don't hold them through the
+                // simplification and checking below.
+                if (configurations.size() == 1 && !mSettings.dump) {
+                    tokens1.clear();
+                    preprocessor.unloadFiles();
+                }
+
                 // Check raw tokens
                 checkRawTokens(mTokenizer);
 
@@ -410,10 +786,11 @@ unsigned int CppCheck::checkFile(const std::string& filename, const std::string
 
                 // dump xml if --dump
                 if (mSettings.dump && fdump.is_open()) {
-                    fdump << "<dump cfg=\"" << ErrorLogger::toxml(mCurrentConfig) << "\">" << std::endl;
+                    fdumpIndex << "dump " << fdump.tellp() << " cfg=\"" << ErrorLogger::toxml(mCurrentConfig) << "\"\n";
+                    fdump << "<dump cfg=\"" << ErrorLogger::toxml(mCurrentConfig) << "\">" << '\n';
                     preprocessor.dump(fdump);
-                    mTokenizer.dump(fdump);
-                    fdump << "</dump>" << std::endl;
+                    mTokenizer.dump(fdump, &fdumpIndex);
+                    fdump << "</dump>" << '\n';
                 }
 
                 // Skip if we already met the same simplified token list
@@ -434,8 +811,11 @@ unsigned int CppCheck::checkFile(const std::string& filename, const std::string
                 if (!mSettings.buildDir.empty())
                     checkUnusedFunctions.parseTokens(mTokenizer, filename.c_str(), &mSettings);
 
-                // simplify more if required, skip rest of iteration if failed
-                if (mSimplify) {
+                // simplify more if required, skip rest of iteration if failed.
+                // the simplified token list is built lazily: when nothing
+                // would consume it, stage 2 is skipped and the skip shows up
+                // in the --showtime report instead of the stage itself.
+                if (mSimplify && hasSimplifiedChecks(mTokenizer)) {
                     if (!mSettings.experimentalFast) {
                         // if further simplification fails then skip rest of iteration
                         Timer timer3("Tokenizer::simplifyTokenList2", mSettings.showtime, &S_timerResults);
@@ -447,6 +827,9 @@ unsigned int CppCheck::checkFile(const std::string& filename, const std::string
 
                     // Check simplified tokens
                     checkSimplifiedTokens(mTokenizer);
+                } else if (mSimplify) {
+                    Timer timer3("Tokenizer::simplifyTokenList2::skipped", mSettings.showtime, &S_timerResults);
+                    timer3.Stop();
                 }
 
             } catch (const simplecpp::Output &o) {
@@ -485,6 +868,21 @@ unsigned int CppCheck::checkFile(const std::string& filename, const std::string
             }
         }
 
+        if (maxFileTime > 0 && std::time(nullptr) > maxFileTime && mSettings.isEnabled(Settings::INFORMATION)) {
+            std::list<ErrorLogger::ErrorMessage::FileLocation> locationList;
+            ErrorLogger::ErrorMessage::FileLocation loc;
+            loc.setfile(Path::toNativeSeparators(filename));
+            locationList.push_back(loc);
+            ErrorLogger::ErrorMessage errmsg(locationList,
+                                             loc.getfile(),
+                                             Severity::information,
+                                             "Checking this file was interrupted after " + MathLib::toString(mSettings.maxTimePerFile) +
+                                             " second(s) (--max-time-per-file). The results for this file may be incomplete.",
+                                             "maxTimePerFile",
+                                             false);
+            reportErr(errmsg);
+        }
+
         if (!hasValidConfig && configurations.size() > 1 && mSettings.isEnabled(Settings::INFORMATION)) {
             std::string msg;
             msg = "This file is not analyzed. Cppcheck failed to extract a valid configuration. Use -v for more details.";
@@ -506,8 +904,18 @@ unsigned int CppCheck::checkFile(const std::string& filename, const std::string
         }
 
         // dumped all configs, close root </dumps> element now
-        if (mSettings.dump && fdump.is_open())
-            fdump << "</dumps>" << std::endl;
+        if (mSettings.dump && fdump.is_open()) {
+            fdump << "</dumps>" << '\n';
+            // epilog: a seek index with the byte offsets of each <dump>
+            // element, section and function token region. It is written as
+            // an XML comment so whole-document parsers are unaffected, and
+            // the final line tells a reader that seeks to the end of the
+            // file where the index itself starts.
+            const std::ostream::pos_type indexPos = fdump.tellp();
+            fdump << "<!-- index\n" << fdumpIndex.str() << "-->\n";
+            fdump << "<!-- index at " << indexPos << " -->\n";
+            fdump.flush();
+        }
 
     } catch (const std::runtime_error &e) {
         internalError(filename, e.what());
@@ -571,20 +979,305 @@ void CppCheck::checkRawTokens(const Tokenizer &tokenizer)
 // CppCheck - A function that checks a normal token list
 //---------------------------------------------------------------------------
 
+//---------------------------------------------------------------------------
+// Per-function result cache (--cppcheck-build-dir)
+//---------------------------------------------------------------------------
+
+// FNV-1a, with a separator after every string so that moving text between
+// adjacent tokens changes the hash
+static void hashAppend(unsigned long long &hash, const std::string &str)
+{
+    for (const char c : str) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    hash ^= 0xffU;
+    hash *= 1099511628211ULL;
+}
+
+void CppCheck::loadFunctionCache(const Tokenizer &tokenizer)
+{
+    mFunctionCache.clear();
+    mFunctionCacheFile.clear();
+    mUnattributedFindings = 0;
+
+    const SymbolDatabase *symbolDatabase = tokenizer.getSymbolDatabase();
+    if (!symbolDatabase)
+        return;
+
+    mFunctionCacheSourceFile = tokenizer.list.getSourceFilePath();
+
+    // Hash every top level function body. Nested executable scopes
+    // (lambdas, local classes) are part of the enclosing body.
+    std::map<const Scope *, unsigned long long> bodyHash;
+    std::map<const Token *, const Token *> bodyRange; // bodyStart => bodyEnd
+    for (const Scope *scope : symbolDatabase->functionScopes) {
+        if (!scope->bodyStart || !scope->bodyEnd)
+            continue;
+        bool nested = false;
+        for (const Scope *outer = scope->nestedIn; outer && !nested; outer = outer->nestedIn)
+            nested = outer->isExecutable();
+        if (nested)
+            continue;
+        unsigned long long hash = 1469598103934665603ULL;
+        for (const Token *tok = scope->bodyStart; tok != scope->bodyEnd; tok = tok->next())
+            hashAppend(hash, tok->str());
+        bodyHash[scope] = hash;
+        bodyRange[scope->bodyStart] = scope->bodyEnd;
+    }
+    if (bodyHash.empty())
+        return;
+
+    // Everything outside the function bodies is the environment: includes,
+    // types, globals and all the function signatures. A change there
+    // invalidates all functions of the file.
+    unsigned long long envHash = 1469598103934665603ULL;
+    hashAppend(envHash, analyzerToolInfo(mSettings));
+    hashAppend(envHash, mCurrentConfig);
+    for (const Token *tok = tokenizer.list.front(); tok; tok = tok->next()) {
+        const std::map<const Token *, const Token *>::const_iterator body = bodyRange.find(tok);
+        if (body != bodyRange.end()) {
+            tok = body->second;
+            continue;
+        }
+        hashAppend(envHash, tok->str());
+    }
+
+    // Call graph edges. The intra-TU value flow pushes values from a call
+    // site into the callee and return expressions back into the caller, so
+    // the results of a function also depend on its direct callers and
+    // callees.
+    std::map<const Scope *, std::set<const Scope *>> neighbours;
+    for (std::map<const Scope *, unsigned long long>::const_iterator it = bodyHash.begin(); it != bodyHash.end(); ++it) {
+        const Scope * const scope = it->first;
+        for (const Token *tok = scope->bodyStart; tok != scope->bodyEnd; tok = tok->next()) {
+            const Function *calledFunction = tok->function();
+            if (!calledFunction || !calledFunction->functionScope || calledFunction->functionScope == scope)
+                continue;
+            if (bodyHash.find(calledFunction->functionScope) == bodyHash.end())
+                continue;
+            neighbours[scope].insert(calledFunction->functionScope);
+            neighbours[calledFunction->functionScope].insert(scope);
+        }
+    }
+
+    // The intra-TU value flow iterates until convergence, so values chain
+    // through any number of call hops and a change anywhere in a connected
+    // component of the call graph can change the findings of every function
+    // in it. Fold a hash of the whole component into the key of each member.
+    // The wrapping sum is independent of the traversal order and, unlike
+    // xor, two callees with identical bodies do not cancel each other out.
+    std::map<const Scope *, unsigned long long> keyHash = bodyHash;
+    std::set<const Scope *> assigned;
+    for (std::map<const Scope *, unsigned long long>::const_iterator it = bodyHash.begin(); it != bodyHash.end(); ++it) {
+        if (assigned.find(it->first) != assigned.end())
+            continue;
+        std::list<const Scope *> members(1, it->first);
+        assigned.insert(it->first);
+        for (std::list<const Scope *>::const_iterator member = members.begin(); member != members.end(); ++member) {
+            for (const Scope *neighbour : neighbours[*member]) {
+                if (assigned.insert(neighbour).second)
+                    members.push_back(neighbour);
+            }
+        }
+        unsigned long long componentHash = 0;
+        for (const Scope *member : members)
+            componentHash += bodyHash[member] * 1099511628211ULL;
+        for (const Scope *member : members)
+            keyHash[member] ^= componentHash;
+    }
+
+    for (std::map<const Scope *, unsigned long long>::const_iterator it = bodyHash.begin(); it != bodyHash.end(); ++it) {
+        const Scope * const scope = it->first;
+        CachedFunction entry;
+        entry.scope = scope;
+        std::ostringstream hexkey;
+        hexkey << std::hex << (keyHash[scope] ^ envHash);
+        entry.key = hexkey.str();
+        entry.bodyStartLine = scope->bodyStart->linenr();
+        entry.bodyEndLine = scope->bodyEnd->linenr();
+        entry.replayed = false;
+        // two function bodies starting on the same line cannot be told
+        // apart when a finding is attributed, leave both uncached
+        if (!mFunctionCache.insert(std::make_pair(entry.bodyStartLine, entry)).second)
+            mFunctionCache.erase(entry.bodyStartLine);
+    }
+
+    const std::string cacheFile = AnalyzerInformation::getAnalyzerInfoFile(mSettings.buildDir, mFunctionCacheSourceFile, mCurrentConfig) + ".functions";
+
+    // Read the results of the previous run
+    std::map<std::string, std::list<std::string>> oldFindings;
+    unsigned int oldUnattributed = 0;
+    bool haveOldCache = false;
+    std::ifstream fin(cacheFile.c_str(), std::ios::binary);
+    if (fin) {
+        std::ostringstream content;
+        content << fin.rdbuf();
+        const std::string data = content.str();
+        const std::string header("cppcheck-function-cache 1\n");
+        if (data.compare(0, header.size(), header) == 0) {
+            haveOldCache = true;
+            std::string::size_type pos = header.size();
+            std::list<std::string> *current = nullptr;
+            while (pos < data.size()) {
+                const std::string::size_type eol = data.find('\n', pos);
+                if (eol == std::string::npos)
+                    break;
+                if (data.compare(pos, 13, "unattributed ") == 0) {
+                    oldUnattributed = std::atoi(data.c_str() + pos + 13);
+                    pos = eol + 1;
+                } else if (data.compare(pos, 9, "function ") == 0) {
+                    current = &oldFindings[data.substr(pos + 9, eol - pos - 9)];
+                    pos = eol + 1;
+                } else if (data.compare(pos, 8, "finding ") == 0 && current) {
+                    // length prefixed, the serialized message may contain newlines
+                    const std::size_t len = std::atoi(data.c_str() + pos + 8);
+                    const std::string::size_type blob = data.find(' ', pos + 8);
+                    if (blob == std::string::npos || blob + 1 + len > data.size())
+                        break;
+                    current->push_back(data.substr(blob + 1, len));
+                    pos = blob + 1 + len;
+                    if (pos < data.size() && data[pos] == '\n')
+                        ++pos;
+                } else
+                    break;
+            }
+        }
+    }
+
+    // Replay the findings of the unchanged functions. The replay runs
+    // before recording is activated below, so the serialized strings are
+    // carried over as they are instead of being re-recorded.
+    std::set<const Scope *> replayedScopes;
+    if (haveOldCache) {
+        for (std::map<int, CachedFunction>::iterator it = mFunctionCache.begin(); it != mFunctionCache.end(); ++it) {
+            CachedFunction &entry = it->second;
+            const std::map<std::string, std::list<std::string>>::const_iterator old = oldFindings.find(entry.key);
+            if (old == oldFindings.end())
+                continue;
+            entry.findings = old->second;
+            bool ok = true;
+            for (const std::string &serialized : entry.findings) {
+                ErrorLogger::ErrorMessage msg;
+                try {
+                    if (!msg.deserialize(serialized)) {
+                        ok = false;
+                        break;
+                    }
+                } catch (const InternalError &) {
+                    ok = false;
+                    break;
+                }
+                // the lines were stored relative to the body start so the
+                // findings survive the function moving up or down the file
+                for (ErrorLogger::ErrorMessage::FileLocation &loc : msg._callStack)
+                    loc.line += entry.bodyStartLine;
+                reportErr(msg);
+            }
+            if (!ok) {
+                entry.findings.clear();
+                continue;
+            }
+            // when the previous run had findings it could not attribute to
+            // one function, the pass that produced them is unknown and no
+            // function may be skipped
+            if (oldUnattributed == 0) {
+                entry.replayed = true;
+                replayedScopes.insert(entry.scope);
+            }
+        }
+    }
+    Check::setReplayedFunctionScopes(replayedScopes);
+
+    // Activate recording in reportErr()
+    mFunctionCacheFile = cacheFile;
+}
+
+void CppCheck::cacheFinding(const ErrorLogger::ErrorMessage &msg)
+{
+    if (mFunctionCacheFile.empty())
+        return;
+    if (msg._callStack.empty() || msg._callStack.back().line <= 0) {
+        ++mUnattributedFindings;
+        return;
+    }
+    std::map<int, CachedFunction>::iterator it = mFunctionCache.upper_bound(msg._callStack.back().line);
+    if (it == mFunctionCache.begin()) {
+        ++mUnattributedFindings;
+        return;
+    }
+    --it;
+    CachedFunction &entry = it->second;
+    for (const ErrorLogger::ErrorMessage::FileLocation &loc : msg._callStack) {
+        if (loc.line < entry.bodyStartLine || loc.line > entry.bodyEndLine ||
+            loc.getfile(false) != mFunctionCacheSourceFile) {
+            ++mUnattributedFindings;
+            return;
+        }
+    }
+    if (entry.replayed)
+        return; // already carried over from the previous run
+    ErrorLogger::ErrorMessage relative(msg);
+    for (ErrorLogger::ErrorMessage::FileLocation &loc : relative._callStack)
+        loc.line -= entry.bodyStartLine;
+    entry.findings.push_back(relative.serialize());
+}
+
+void CppCheck::writeFunctionCache()
+{
+    Check::setReplayedFunctionScopes(std::set<const Scope *>());
+    if (!mFunctionCacheFile.empty()) {
+        std::ofstream fout(mFunctionCacheFile.c_str(), std::ios::binary);
+        if (fout) {
+            fout << "cppcheck-function-cache 1\n";
+            fout << "unattributed " << mUnattributedFindings << '\n';
+            for (std::map<int, CachedFunction>::const_iterator it = mFunctionCache.begin(); it != mFunctionCache.end(); ++it) {
+                fout << "function " << it->second.key << '\n';
+                for (const std::string &finding : it->second.findings)
+                    fout << "finding " << finding.size() << ' ' << finding << '\n';
+            }
+        }
+    }
+    mFunctionCacheFile.clear();
+    mFunctionCache.clear();
+    mFunctionCacheSourceFile.clear();
+    mUnattributedFindings = 0;
+}
+
 void CppCheck::checkNormalTokens(const Tokenizer &tokenizer)
 {
+    // Replay the cached results of unchanged functions and start recording
+    // the results of this run
+    if (!mSettings.buildDir.empty())
+        loadFunctionCache(tokenizer);
+
+    // Activate the fused traversal: checks with plain per-token passes
+    // queue a bound instance from runChecks() and share one walk over the
+    // token list instead of each walking it themselves.
+    Check::startFusedWalk();
+
     // call all "runChecks" in all registered Check classes
     for (Check *check : Check::instances()) {
-        if (mSettings.terminated())
+        if (mSettings.terminated() || tokenizer.isMaxTime()) {
+            Check::cancelFusedWalk();
+            // discard the incomplete results of this run
+            mFunctionCacheFile.clear();
+            writeFunctionCache();
             return;
+        }
 
-        if (tokenizer.isMaxTime())
-            return;
+        if (mSkippedChecks.find(check->name()) != mSkippedChecks.end())
+            continue;
 
         Timer timerRunChecks(check->name() + "::runChecks", mSettings.showtime, &S_timerResults);
         check->runChecks(&tokenizer, &mSettings, this);
     }
 
+    {
+        Timer timerFusedWalk("CppCheck::checkNormalTokens::fusedWalk", mSettings.showtime, &S_timerResults);
+        Check::runFusedWalk(&tokenizer);
+    }
+
     // Analyse the tokens..
 
     CTU::FileInfo *fi1 = CTU::getFileInfo(&tokenizer);
@@ -593,6 +1286,11 @@ void CppCheck::checkNormalTokens(const Tokenizer &tokenizer)
         mAnalyzerInformation.setFileInfo("ctu", fi1->toString());
     }
 
+    // Store per-function value flow summaries. They are not loaded back yet;
+    // storing them is the first step towards reusing value flow results for
+    // unchanged functions in incremental runs.
+    mAnalyzerInformation.setFileInfo("valueflow", ValueFlow::analyzerInfo(tokenizer.getSymbolDatabase()));
+
     for (const Check *check : Check::instances()) {
         Check::FileInfo *fi = check->getFileInfo(&tokenizer, &mSettings);
         if (fi != nullptr) {
@@ -602,6 +1300,8 @@ void CppCheck::checkNormalTokens(const Tokenizer &tokenizer)
     }
 
     executeRules("normal", tokenizer);
+
+    writeFunctionCache();
 }
 
 //---------------------------------------------------------------------------
@@ -618,6 +1318,9 @@ void CppCheck::checkSimplifiedTokens(const Tokenizer &tokenizer)
         if (tokenizer.isMaxTime())
             return;
 
+        if (mSkippedChecks.find((*it)->name()) != mSkippedChecks.end())
+            continue;
+
         Timer timerSimpleChecks((*it)->name() + "::runSimplifiedChecks", mSettings.showtime, &S_timerResults);
         (*it)->runSimplifiedChecks(&tokenizer, &mSettings, this);
         timerSimpleChecks.Stop();
@@ -627,6 +1330,29 @@ void CppCheck::checkSimplifiedTokens(const Tokenizer &tokenizer)
         executeRules("simple", tokenizer);
 }
 
+bool CppCheck::hasSimplifiedChecks(const Tokenizer &tokenizer) const
+{
+    // --debug-simplified prints the simplified token list, so it has to be built
+    if (mSettings.debugSimplified)
+        return true;
+
+#ifdef HAVE_RULES
+    for (const Settings::Rule &rule : mSettings.rules) {
+        if (rule.tokenlist == "simple")
+            return true;
+    }
+#endif
+
+    for (const Check *check : Check::instances()) {
+        if (mSkippedChecks.find(check->name()) != mSkippedChecks.end())
+            continue;
+        if (check->hasSimplifiedChecks(&tokenizer, &mSettings))
+            return true;
+    }
+
+    return false;
+}
+
 #ifdef HAVE_RULES
 
 static const char * pcreErrorCodeToString(const int pcreExecRet)
@@ -758,6 +1484,156 @@ static const char * pcreErrorCodeToString(const int pcreExecRet)
     return "";
 }
 
+namespace {
+    /**
+     * Cache of compiled --rule patterns. The rules do not change after the
+     * command line has been parsed, but executeRules() used to recompile
+     * and re-study every pattern for every checked file; with many rules
+     * the repeated pcre_compile/pcre_study calls cost more than the
+     * matching. A pattern is compiled (and JIT optimized when the PCRE
+     * library supports it) the first time it is used and reused for the
+     * files that follow. The cache is thread local because the Windows
+     * executor checks files in several threads of one process.
+     */
+    class CompiledRuleCache {
+    public:
+        struct CompiledRule {
+            pcre *re;
+            pcre_extra *extra;
+        };
+
+        ~CompiledRuleCache() {
+            for (std::map<std::string, CompiledRule>::iterator it = mCache.begin(); it != mCache.end(); ++it) {
+                if (it->second.re)
+                    pcre_free(it->second.re);
+#ifdef PCRE_CONFIG_JIT
+                if (it->second.extra)
+                    pcre_free_study(it->second.extra);
+#endif
+            }
+        }
+
+        /**
+         * Get the compiled pattern, compiling it on the first call. If the
+         * compilation fails then the returned rule has no regex and @p
+         * errorId / @p errorMessage are set - but only on that first call,
+         * a cached failure stays silent so the error is not repeated for
+         * every checked file.
+         */
+        const CompiledRule *get(const std::string &pattern, std::string *errorId, std::string *errorMessage) {
+            const std::map<std::string, CompiledRule>::const_iterator it = mCache.find(pattern);
+            if (it != mCache.end())
+                return &it->second;
+
+            CompiledRule rule = {nullptr, nullptr};
+            const char *pcreCompileErrorStr = nullptr;
+            int erroffset = 0;
+            rule.re = pcre_compile(pattern.c_str(), 0, &pcreCompileErrorStr, &erroffset, nullptr);
+            if (!rule.re && pcreCompileErrorStr) {
+                *errorId = "pcre_compile";
+                *errorMessage = "pcre_compile failed: " + std::string(pcreCompileErrorStr);
+            }
+#ifdef PCRE_CONFIG_JIT
+            // Optimize the regex, but only if PCRE_CONFIG_JIT is available
+            if (rule.re) {
+                const char *pcreStudyErrorStr = nullptr;
+                rule.extra = pcre_study(rule.re, PCRE_STUDY_JIT_COMPILE, &pcreStudyErrorStr);
+                // pcre_study() returns NULL for both errors and when it can not optimize the regex.
+                // The last argument is how one checks for errors.
+                // It is NULL if everything works, and points to an error string otherwise.
+                if (pcreStudyErrorStr) {
+                    *errorId = "pcre_study";
+                    *errorMessage = "pcre_study failed: " + std::string(pcreStudyErrorStr);
+                    // pcre_compile() worked, but pcre_study() returned an error. Free the resources allocated by pcre_compile().
+                    pcre_free(rule.re);
+                    rule.re = nullptr;
+                }
+            }
+#endif
+            return &mCache.insert(std::make_pair(pattern, rule)).first->second;
+        }
+
+    private:
+        std::map<std::string, CompiledRule> mCache;
+    };
+
+    CompiledRuleCache &compiledRuleCache()
+    {
+        static thread_local CompiledRuleCache cache;
+        return cache;
+    }
+
+    /**
+     * Combine the patterns of the rules for the given token list into one
+     * "does any rule match?" alternation, so one scan can prefilter the
+     * file for all rules at once. Returns an empty string when the
+     * patterns can not be combined: a pattern with a backreference
+     * changes its meaning when the patterns around it add capturing
+     * groups. Correctness never depends on the prefilter - a prefilter
+     * match is always followed by the full per-rule matching.
+     */
+    /**
+     * The stringified token list that the rule patterns are matched
+     * against. Built once and shared by all the rules, together with an
+     * offset index so that a match position maps back to its token with a
+     * binary search instead of walking the multi-million-token list for
+     * every match.
+     */
+    class RuleTokenText {
+    public:
+        explicit RuleTokenText(const Token *tokens) {
+            std::ostringstream ostr;
+            std::size_t len = 0;
+            for (const Token *tok = tokens; tok; tok = tok->next()) {
+                ostr << " " << tok->str();
+                len += 1U + tok->str().size();
+                mEnds.push_back(len);
+                mTokens.push_back(tok);
+            }
+            mText = ostr.str();
+        }
+
+        const std::string &text() const {
+            return mText;
+        }
+
+        /** the token that the match position @p pos is in */
+        const Token *tokenAt(std::size_t pos) const {
+            const std::vector<std::size_t>::const_iterator it = std::upper_bound(mEnds.begin(), mEnds.end(), pos);
+            if (it == mEnds.end())
+                return nullptr;
+            return mTokens[it - mEnds.begin()];
+        }
+
+    private:
+        std::string mText;
+
+        /** end offset of each token in the text, for tokenAt() */
+        std::vector<std::size_t> mEnds;
+        std::vector<const Token *> mTokens;
+    };
+
+    std::string combinedRulePattern(const std::list<Settings::Rule> &rules, const std::string &tokenlist)
+    {
+        std::string combined;
+        for (std::list<Settings::Rule>::const_iterator it = rules.begin(); it != rules.end(); ++it) {
+            const Settings::Rule &rule = *it;
+            if (rule.pattern.empty() || rule.id.empty() || rule.severity == Severity::none || rule.tokenlist != tokenlist)
+                continue;
+            for (std::string::size_type pos = 0; pos + 1 < rule.pattern.size(); ++pos) {
+                const char c = rule.pattern[pos + 1];
+                // might be a backreference (\1, \g1, \k<name>, ...), don't combine
+                if (rule.pattern[pos] == '\\' && ((c >= '0' && c <= '9') || c == 'g' || c == 'k'))
+                    return emptyString;
+            }
+            if (!combined.empty())
+                combined += '|';
+            combined += "(?:" + rule.pattern + ')';
+        }
+        return combined;
+    }
+}
+
 #endif // HAVE_RULES
 
 
@@ -778,59 +1654,48 @@ void CppCheck::executeRules(const std::string &tokenlist, const Tokenizer &token
     if (isrule == false)
         return;
 
-    // Write all tokens in a string that can be parsed by pcre
-    std::ostringstream ostr;
-    for (const Token *tok = tokenizer.tokens(); tok; tok = tok->next())
-        ostr << " " << tok->str();
-    const std::string str(ostr.str());
+    // Write all tokens in a string that can be parsed by pcre. The string
+    // is built once and shared by all the rules.
+    const RuleTokenText ruleText(tokenizer.tokens());
+    const std::string &str = ruleText.text();
+
+    // Prefilter: one scan with all the patterns combined answers whether
+    // any rule matches anywhere in this file. In the common case nothing
+    // matches and the per-rule scans below are all skipped.
+    const std::string combinedPattern = combinedRulePattern(mSettings.rules, tokenlist);
+    if (!combinedPattern.empty()) {
+        std::string errorId, errorMessage; // compile errors are reported by the per-rule compilation below
+        const CompiledRuleCache::CompiledRule * const combined = compiledRuleCache().get(combinedPattern, &errorId, &errorMessage);
+        if (combined->re) {
+            int ovector[30] = {0};
+            if (pcre_exec(combined->re, combined->extra, str.c_str(), (int)str.size(), 0, 0, ovector, 30) == PCRE_ERROR_NOMATCH)
+                return;
+        }
+    }
 
     for (std::list<Settings::Rule>::const_iterator it = mSettings.rules.begin(); it != mSettings.rules.end(); ++it) {
         const Settings::Rule &rule = *it;
         if (rule.pattern.empty() || rule.id.empty() || rule.severity == Severity::none || rule.tokenlist != tokenlist)
             continue;
 
-        const char *pcreCompileErrorStr = nullptr;
-        int erroffset = 0;
-        pcre * const re = pcre_compile(rule.pattern.c_str(),0,&pcreCompileErrorStr,&erroffset,nullptr);
-        if (!re) {
-            if (pcreCompileErrorStr) {
-                const std::string msg = "pcre_compile failed: " + std::string(pcreCompileErrorStr);
+        std::string errorId;
+        std::string errorMessage;
+        const CompiledRuleCache::CompiledRule * const compiledRule = compiledRuleCache().get(rule.pattern, &errorId, &errorMessage);
+        if (!compiledRule->re) {
+            if (!errorMessage.empty()) {
                 const ErrorLogger::ErrorMessage errmsg(std::list<ErrorLogger::ErrorMessage::FileLocation>(),
                                                        emptyString,
                                                        Severity::error,
-                                                       msg,
-                                                       "pcre_compile",
+                                                       errorMessage,
+                                                       errorId,
                                                        false);
 
                 reportErr(errmsg);
             }
             continue;
         }
-
-        // Optimize the regex, but only if PCRE_CONFIG_JIT is available
-#ifdef PCRE_CONFIG_JIT
-        const char *pcreStudyErrorStr = nullptr;
-        pcre_extra * const pcreExtra = pcre_study(re, PCRE_STUDY_JIT_COMPILE, &pcreStudyErrorStr);
-        // pcre_study() returns NULL for both errors and when it can not optimize the regex.
-        // The last argument is how one checks for errors.
-        // It is NULL if everything works, and points to an error string otherwise.
-        if (pcreStudyErrorStr) {
-            const std::string msg = "pcre_study failed: " + std::string(pcreStudyErrorStr);
-            const ErrorLogger::ErrorMessage errmsg(std::list<ErrorLogger::ErrorMessage::FileLocation>(),
-                                                   emptyString,
-                                                   Severity::error,
-                                                   msg,
-                                                   "pcre_study",
-                                                   false);
-
-            reportErr(errmsg);
-            // pcre_compile() worked, but pcre_study() returned an error. Free the resources allocated by pcre_compile().
-            pcre_free(re);
-            continue;
-        }
-#else
-        const pcre_extra * const pcreExtra = nullptr;
-#endif
+        pcre * const re = compiledRule->re;
+        const pcre_extra * const pcreExtra = compiledRule->extra;
 
         int pos = 0;
         int ovector[30]= {0};
@@ -861,14 +1726,10 @@ void CppCheck::executeRules(const std::string &tokenlist, const Tokenizer &token
             loc.setfile(tokenizer.list.getSourceFilePath());
             loc.line = 0;
 
-            std::size_t len = 0;
-            for (const Token *tok = tokenizer.tokens(); tok; tok = tok->next()) {
-                len = len + 1U + tok->str().size();
-                if (len > pos1) {
-                    loc.setfile(tokenizer.list.getFiles().at(tok->fileIndex()));
-                    loc.line = tok->linenr();
-                    break;
-                }
+            const Token * const matchedToken = ruleText.tokenAt(pos1);
+            if (matchedToken) {
+                loc.setfile(tokenizer.list.getFiles().at(matchedToken->fileIndex()));
+                loc.line = matchedToken->linenr();
             }
 
             const std::list<ErrorLogger::ErrorMessage::FileLocation> callStack(1, loc);
@@ -884,14 +1745,7 @@ void CppCheck::executeRules(const std::string &tokenlist, const Tokenizer &token
             // Report error
             reportErr(errmsg);
         }
-
-        pcre_free(re);
-#ifdef PCRE_CONFIG_JIT
-        // Free up the EXTRA PCRE value (may be NULL at this point)
-        if (pcreExtra) {
-            pcre_free_study(pcreExtra);
-        }
-#endif
+        // re/pcreExtra are owned by the cache and reused for the next file
     }
 #endif
 }
@@ -975,14 +1829,6 @@ void CppCheck::reportErr(const ErrorLogger::ErrorMessage &msg)
     if (!mSettings.library.reportErrors(msg.file0))
         return;
 
-    const std::string errmsg = msg.toString(mSettings.verbose);
-    if (errmsg.empty())
-        return;
-
-    // Alert only about unique errors
-    if (std::find(mErrorList.begin(), mErrorList.end(), errmsg) != mErrorList.end())
-        return;
-
     const Suppressions::ErrorMessage errorMessage = msg.toSuppressionsErrorMessage();
 
     if (mUseGlobalSuppressions) {
@@ -997,16 +1843,32 @@ void CppCheck::reportErr(const ErrorLogger::ErrorMessage &msg)
         }
     }
 
+    // Format the message only after it has survived the suppression
+    // filtering; for heavily suppressed projects most messages are
+    // filtered out and never need the formatted text.
+    const std::string errmsg = msg.toString(mSettings.verbose);
+    if (errmsg.empty())
+        return;
+
+    // Alert only about unique errors
+    if (mErrorList.find(errmsg) != mErrorList.end())
+        return;
+
     if (!mSettings.nofail.isSuppressed(errorMessage) && (mUseGlobalSuppressions || !mSettings.nomsg.isSuppressed(errorMessage)))
         mExitCode = 1;
 
-    mErrorList.push_back(errmsg);
+    mErrorList.insert(errmsg);
 
     mErrorLogger.reportErr(msg);
     mAnalyzerInformation.reportErr(msg, mSettings.verbose);
     if (!mSettings.plistOutput.empty() && plistFile.is_open()) {
         plistFile << ErrorLogger::plistData(msg);
     }
+
+    // Record into the per-function result cache. Only findings that survived
+    // the suppression filtering above are recorded; the suppressions are part
+    // of the environment hash, so a changed suppression invalidates the cache.
+    cacheFinding(msg);
 }
 
 void CppCheck::reportOut(const std::string &outmsg)
@@ -1076,8 +1938,11 @@ void CppCheck::analyseWholeProgram(const std::string &buildDir, const std::map<s
     (void)files;
     if (buildDir.empty())
         return;
-    if (mSettings.isEnabled(Settings::UNUSED_FUNCTION))
-        CheckUnusedFunctions::analyseWholeProgram(this, buildDir);
+    // the analyzer info files are written by a background thread, make
+    // sure they are all on disk before reading them back
+    mAnalyzerInformation.flush();
+    const bool unusedFunctions = mSettings.isEnabled(Settings::UNUSED_FUNCTION);
+    CheckUnusedFunctions::WholeProgramInfo unusedFunctionsInfo;
     std::list<Check::FileInfo*> fileInfoList;
     CTU::FileInfo ctuFileInfo;
 
@@ -1093,19 +1958,36 @@ void CppCheck::analyseWholeProgram(const std::string &buildDir, const std::map<s
         if (firstColon == lastColon)
             continue;
         const std::string xmlfile = buildDir + '/' + filesTxtLine.substr(0,firstColon);
-        //const std::string sourcefile = filesTxtLine.substr(lastColon+1);
-
-        tinyxml2::XMLDocument doc;
-        const tinyxml2::XMLError error = doc.LoadFile(xmlfile.c_str());
-        if (error != tinyxml2::XML_SUCCESS)
+        const std::string sourcefile = filesTxtLine.substr(lastColon+1);
+
+        // The analyzer info mostly consists of the recorded error messages;
+        // only the FileInfo elements matter here. Read the file in one pass
+        // and parse just those sections instead of building a DOM for the
+        // whole document. toXML() escapes '<' so an error message can not
+        // contain a literal FileInfo tag.
+        std::ifstream fxml(xmlfile);
+        if (!fxml.is_open())
             continue;
+        std::ostringstream xmlStream;
+        xmlStream << fxml.rdbuf();
+        const std::string xmlContent = xmlStream.str();
+
+        std::string::size_type startPos = 0;
+        while ((startPos = xmlContent.find("<FileInfo", startPos)) != std::string::npos) {
+            const std::string::size_type endPos = xmlContent.find("</FileInfo>", startPos);
+            if (endPos == std::string::npos)
+                break;
+            const std::string::size_type nextPos = endPos + 11;
 
-        const tinyxml2::XMLElement * const rootNode = doc.FirstChildElement();
-        if (rootNode == nullptr)
-            continue;
+            tinyxml2::XMLDocument doc;
+            if (doc.Parse(xmlContent.c_str() + startPos, nextPos - startPos) != tinyxml2::XML_SUCCESS) {
+                startPos = nextPos;
+                continue;
+            }
+            startPos = nextPos;
 
-        for (const tinyxml2::XMLElement *e = rootNode->FirstChildElement(); e; e = e->NextSiblingElement()) {
-            if (std::strcmp(e->Name(), "FileInfo") != 0)
+            const tinyxml2::XMLElement * const e = doc.FirstChildElement();
+            if (e == nullptr)
                 continue;
             const char *checkClassAttr = e->Attribute("check");
             if (!checkClassAttr)
@@ -1114,6 +1996,11 @@ void CppCheck::analyseWholeProgram(const std::string &buildDir, const std::map<s
                 ctuFileInfo.loadFromXml(e);
                 continue;
             }
+            if (std::strcmp(checkClassAttr, "CheckUnusedFunctions") == 0) {
+                if (unusedFunctions)
+                    unusedFunctionsInfo.loadInfo(e, sourcefile);
+                continue;
+            }
             for (Check *check : Check::instances()) {
                 if (checkClassAttr == check->name())
                     fileInfoList.push_back(check->loadFileInfoFromXml(e));
@@ -1121,6 +2008,9 @@ void CppCheck::analyseWholeProgram(const std::string &buildDir, const std::map<s
         }
     }
 
+    if (unusedFunctions)
+        unusedFunctionsInfo.check(this);
+
     // Set CTU max depth
     CTU::maxCtuDepth = mSettings.maxCtuDepth;
 
@@ -1136,3 +2026,39 @@ bool CppCheck::isUnusedFunctionCheckEnabled() const
 {
     return (mSettings.jobs == 1 && mSettings.isEnabled(Settings::UNUSED_FUNCTION));
 }
+
+namespace {
+    // Adapts the AnalysisContext::ResultHandler callback interface to the
+    // ErrorLogger interface the checking engine reports through.
+    class ResultForwarder : public ErrorLogger {
+    public:
+        explicit ResultForwarder(AnalysisContext::ResultHandler &handler) : mHandler(handler) {}
+
+        void reportOut(const std::string &outmsg) OVERRIDE {
+            mHandler.reportStatus(outmsg);
+        }
+
+        void reportErr(const ErrorLogger::ErrorMessage &msg) OVERRIDE {
+            mHandler.reportResult(msg);
+        }
+
+    private:
+        AnalysisContext::ResultHandler &mHandler;
+    };
+}
+
+unsigned int AnalysisContext::check(const std::string &path, ResultHandler &handler) const
+{
+    ResultForwarder errorLogger(handler);
+    CppCheck cppcheck(errorLogger, true);
+    cppcheck.settings() = mSettings;
+    return cppcheck.check(path);
+}
+
+unsigned int AnalysisContext::check(const std::string &path, const std::string &content, ResultHandler &handler) const
+{
+    ResultForwarder errorLogger(handler);
+    CppCheck cppcheck(errorLogger, true);
+    cppcheck.settings() = mSettings;
+    return cppcheck.check(path, content);
+}
@@ -27,13 +27,16 @@
 #include "errorlogger.h"
 #include "importproject.h"
 #include "settings.h"
+#include "timer.h"
 
 #include <cstddef>
 #include <istream>
 #include <list>
 #include <map>
 #include <string>
+#include <unordered_set>
 
+class Scope;
 class Tokenizer;
 
 /// @addtogroup Core
@@ -107,6 +110,28 @@ public:
      */
     static const char * extraVersion();
 
+    /**
+     * @brief Returns the timing results collected when the showtime mode
+     * is active (--showtime / --perf-report).
+     */
+    static const TimerResults &timerResults();
+
+    /**
+     * @brief Returns the analyzer information cache counters for this run.
+     */
+    const AnalyzerInformation::Statistics &analyzerStatistics() const {
+        return mAnalyzerInformation.statistics;
+    }
+
+    /**
+     * @brief Wait until the analyzer information of the checked files is
+     * on disk, see AnalyzerInformation::flush(). A worker process that
+     * exits without running the destructors must call this.
+     */
+    void flushAnalyzerInformation() {
+        mAnalyzerInformation.flush();
+    }
+
     virtual void reportStatus(unsigned int fileindex, unsigned int filecount, std::size_t sizedone, std::size_t sizetotal);
 
     /**
@@ -175,6 +200,15 @@ private:
      */
     void checkSimplifiedTokens(const Tokenizer &tokenizer);
 
+    /**
+     * @brief Is the simplified token list needed at all? It is built lazily:
+     * when every registered check reports through Check::hasSimplifiedChecks()
+     * that it would not run, and no rule or debug option consumes the
+     * simplified list either, the second simplification stage is skipped.
+     * @param tokenizer tokenizer instance
+     */
+    bool hasSimplifiedChecks(const Tokenizer &tokenizer) const;
+
     /**
      * @brief Execute rules, if any
      * @param tokenlist token list to use (normal / simple)
@@ -198,7 +232,7 @@ private:
      */
     virtual void reportOut(const std::string &outmsg) OVERRIDE;
 
-    std::list<std::string> mErrorList;
+    std::unordered_set<std::string> mErrorList;
     Settings mSettings;
 
     void reportProgress(const std::string &filename, const char stage[], const std::size_t value) OVERRIDE;
@@ -213,6 +247,11 @@ private:
     /** @brief Current preprocessor configuration */
     std::string mCurrentConfig;
 
+    /** Checks whose trigger identifier does not occur in the raw source of
+     * the current file, see Check::triggerIdentifier(). They are skipped
+     * for every configuration of the file. */
+    std::unordered_set<std::string> mSkippedChecks;
+
     unsigned int mExitCode;
 
     bool mSuppressInternalErrorFound;
@@ -225,12 +264,108 @@ private:
     /** Simplify code? true by default */
     bool mSimplify;
 
+    /** checkFile() reads the file contents from disk. Enables the
+     * include-closure shortcut in the analyzer information; contents that
+     * were passed in as a string can't be validated against the disk. */
+    bool mFileContentFromDisk;
+
     /** File info used for whole program analysis */
     std::list<Check::FileInfo*> mFileInfo;
 
+    /**
+     * @brief One function of the checked file in the per-function result
+     * cache, see loadFunctionCache().
+     */
+    struct CachedFunction {
+        const Scope *scope;
+        std::string key;                 /**< body + call graph neighbourhood + environment hash */
+        int bodyStartLine;
+        int bodyEndLine;
+        bool replayed;                   /**< the recorded findings were replayed */
+        std::list<std::string> findings; /**< serialized, line numbers relative to the body start */
+    };
+
+    /**
+     * @brief Load the per-function result cache of the current file, replay
+     * the recorded findings of functions whose hash is unchanged and mark
+     * those functions so function local checks can skip them, see
+     * Check::functionResultsReplayed(). Activates recording of the findings
+     * reported while the checks run.
+     */
+    void loadFunctionCache(const Tokenizer &tokenizer);
+
+    /** @brief Write the per-function results recorded by reportErr() and deactivate the cache */
+    void writeFunctionCache();
+
+    /** @brief Record one reported finding into the per-function cache */
+    void cacheFinding(const ErrorLogger::ErrorMessage &msg);
+
+    /** body start line => function entry of the file being checked */
+    std::map<int, CachedFunction> mFunctionCache;
+
+    /** file the per-function results are stored in; empty when the cache is not recording */
+    std::string mFunctionCacheFile;
+
+    /** source file the entries in mFunctionCache belong to */
+    std::string mFunctionCacheSourceFile;
+
+    /** findings of the current file that are not inside a single function
+     * body. When the previous run had any, no function is skipped because
+     * the pass that produced them cannot be identified. */
+    unsigned int mUnattributedFindings;
+
     AnalyzerInformation mAnalyzerInformation;
 };
 
+/**
+ * @brief Embedding API.
+ *
+ * Holds fully initialized settings - including the parsed library
+ * configurations, the most expensive part of process startup - so an
+ * embedding application can check many files without re-initialization
+ * and without shelling out to the cppcheck binary.
+ *
+ * Results are delivered through ResultHandler as structured
+ * ErrorLogger::ErrorMessage objects; formatting them is left to the
+ * embedder. The context itself is immutable after construction, so one
+ * context can be shared by several threads each calling check()
+ * concurrently.
+ */
+class CPPCHECKLIB AnalysisContext {
+public:
+    /** @brief Receives the results of AnalysisContext::check() calls. */
+    class CPPCHECKLIB ResultHandler {
+    public:
+        virtual ~ResultHandler() {}
+
+        /** One finding. Use ErrorMessage::callStack, _severity, id() etc
+         * directly; call toString()/toXML() only if text output is wanted. */
+        virtual void reportResult(const ErrorLogger::ErrorMessage &msg) = 0;
+
+        /** Progress/status text, for example "Checking file.c ...". */
+        virtual void reportStatus(const std::string &/*line*/) {}
+    };
+
+    /** @param settings fully prepared settings; the library configurations
+     * must already be loaded into settings.library */
+    explicit AnalysisContext(const Settings &settings) : mSettings(settings) {}
+
+    /**
+     * @brief Check one file.
+     * @param path path of the file to check
+     * @param handler receives the results
+     * @return amount of errors found or 0 if none were found
+     */
+    unsigned int check(const std::string &path, ResultHandler &handler) const;
+
+    /** As check(path, handler) but the file content is given as a string
+     * instead of being read from disk; @p path is only used in results. */
+    unsigned int check(const std::string &path, const std::string &content, ResultHandler &handler) const;
+
+private:
+    const Settings mSettings;
+};
+
 /// @}
 //---------------------------------------------------------------------------
 #endif // cppcheckH
@@ -223,14 +223,50 @@ void CTU::FileInfo::loadFromXml(const tinyxml2::XMLElement *xmlElement)
     }
 }
 
-std::map<std::string, std::list<const CTU::FileInfo::CallBase *>> CTU::FileInfo::getCallsMap() const
+// The two probe positions in the callee id bloom filter. The second value
+// is the first one with the bits mixed so the probes are (mostly)
+// independent of each other.
+static void calleeIdHashes(const std::string &callId, std::size_t *h1, std::size_t *h2)
 {
-    std::map<std::string, std::list<const CTU::FileInfo::CallBase *>> ret;
-    for (const CTU::FileInfo::NestedCall &nc : nestedCalls)
-        ret[nc.callId].push_back(&nc);
-    for (const CTU::FileInfo::FunctionCall &fc : functionCalls)
-        ret[fc.callId].push_back(&fc);
-    return ret;
+    const std::size_t h = std::hash<std::string>()(callId);
+    *h1 = h;
+    *h2 = (h ^ (h >> 13)) * static_cast<std::size_t>(0x9e3779b97f4a7c15ULL);
+}
+
+const std::unordered_map<std::string, std::list<const CTU::FileInfo::CallBase *>> &CTU::FileInfo::getCallsMap() const
+{
+    if (mCallsMap.empty()) {
+        for (const CTU::FileInfo::NestedCall &nc : nestedCalls)
+            mCallsMap[nc.callId].push_back(&nc);
+        for (const CTU::FileInfo::FunctionCall &fc : functionCalls)
+            mCallsMap[fc.callId].push_back(&fc);
+
+        // Size the bloom filter to roughly 16 bits per callee id; with
+        // the two probes in mayHaveCaller() that keeps the false positive
+        // rate around a percent.
+        std::size_t bits = 1024;
+        while (bits < 16 * mCallsMap.size())
+            bits *= 2;
+        mCalleeIdFilter.assign(bits / 64, 0ULL);
+        for (std::unordered_map<std::string, std::list<const CallBase *>>::const_iterator it = mCallsMap.begin(); it != mCallsMap.end(); ++it) {
+            std::size_t h1, h2;
+            calleeIdHashes(it->first, &h1, &h2);
+            mCalleeIdFilter[(h1 % bits) / 64] |= 1ULL << (h1 % 64);
+            mCalleeIdFilter[(h2 % bits) / 64] |= 1ULL << (h2 % 64);
+        }
+    }
+    return mCallsMap;
+}
+
+bool CTU::FileInfo::mayHaveCaller(const std::string &callId) const
+{
+    if (mCalleeIdFilter.empty())
+        return true;
+    const std::size_t bits = mCalleeIdFilter.size() * 64;
+    std::size_t h1, h2;
+    calleeIdHashes(callId, &h1, &h2);
+    return (mCalleeIdFilter[(h1 % bits) / 64] & (1ULL << (h1 % 64))) != 0 &&
+           (mCalleeIdFilter[(h2 % bits) / 64] & (1ULL << (h2 % 64))) != 0;
 }
 
 std::list<CTU::FileInfo::UnsafeUsage> CTU::loadUnsafeUsageListFromXml(const tinyxml2::XMLElement *xmlElement)
@@ -422,7 +458,7 @@ std::list<CTU::FileInfo::UnsafeUsage> CTU::getUnsafeUsage(const Tokenizer *token
 static bool findPath(const std::string &callId,
                      unsigned int callArgNr,
                      CTU::FileInfo::InvalidValueType invalidValue,
-                     const std::map<std::string, std::list<const CTU::FileInfo::CallBase *>> &callsMap,
+                     const CTU::FileInfo &ctuInfo,
                      const CTU::FileInfo::CallBase *path[10],
                      int index,
                      bool warning)
@@ -430,7 +466,13 @@ static bool findPath(const std::string &callId,
     if (index >= CTU::maxCtuDepth || index >= 10)
         return false;
 
-    const std::map<std::string, std::list<const CTU::FileInfo::CallBase *>>::const_iterator it = callsMap.find(callId);
+    // Most ids never show up as a callee in the recorded calls; reject
+    // those in the bloom filter before the hash map lookup
+    if (!ctuInfo.mayHaveCaller(callId))
+        return false;
+
+    const std::unordered_map<std::string, std::list<const CTU::FileInfo::CallBase *>> &callsMap = ctuInfo.getCallsMap();
+    const std::unordered_map<std::string, std::list<const CTU::FileInfo::CallBase *>>::const_iterator it = callsMap.find(callId);
     if (it == callsMap.end())
         return false;
 
@@ -460,7 +502,7 @@ static bool findPath(const std::string &callId,
         if (!nestedCall)
             continue;
 
-        if (findPath(nestedCall->myId, nestedCall->myArgNr, invalidValue, callsMap, path, index + 1, warning)) {
+        if (findPath(nestedCall->myId, nestedCall->myArgNr, invalidValue, ctuInfo, path, index + 1, warning)) {
             path[index] = nestedCall;
             return true;
         }
@@ -471,7 +513,6 @@ static bool findPath(const std::string &callId,
 
 std::list<ErrorLogger::ErrorMessage::FileLocation> CTU::FileInfo::getErrorPath(InvalidValueType invalidValue,
         const CTU::FileInfo::UnsafeUsage &unsafeUsage,
-        const std::map<std::string, std::list<const CTU::FileInfo::CallBase *>> &callsMap,
         const char info[],
         const FunctionCall * * const functionCallPtr,
         bool warning) const
@@ -480,7 +521,7 @@ std::list<ErrorLogger::ErrorMessage::FileLocation> CTU::FileInfo::getErrorPath(I
 
     const CTU::FileInfo::CallBase *path[10] = {0};
 
-    if (!findPath(unsafeUsage.myId, unsafeUsage.myArgNr, invalidValue, callsMap, path, 0, warning))
+    if (!findPath(unsafeUsage.myId, unsafeUsage.myArgNr, invalidValue, *this, path, 0, warning))
         return locationList;
 
     const std::string value1 = (invalidValue == InvalidValueType::null) ? "null" : "uninitialized";
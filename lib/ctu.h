@@ -25,6 +25,8 @@
 #include "check.h"
 #include "valueflow.h"
 
+#include <unordered_map>
+
 /// @addtogroup Core
 /// @{
 
@@ -107,14 +109,30 @@ namespace CTU {
         std::list<NestedCall> nestedCalls;
 
         void loadFromXml(const tinyxml2::XMLElement *xmlElement);
-        std::map<std::string, std::list<const CallBase *>> getCallsMap() const;
+
+        /** Map from callee id to all calls of it. It is built from all the
+         * function calls on the first use and then shared by the checks so
+         * it is not rebuilt for each whole program check. */
+        const std::unordered_map<std::string, std::list<const CallBase *>> &getCallsMap() const;
+
+        /** First level of the call index: a bloom filter over the callee
+         * ids in the calls map. Most functions are never called with an
+         * interesting value, so the common case is rejected with two bit
+         * tests instead of a hash map lookup; false positives fall
+         * through to getCallsMap(). */
+        bool mayHaveCaller(const std::string &callId) const;
 
         std::list<ErrorLogger::ErrorMessage::FileLocation> getErrorPath(InvalidValueType invalidValue,
                 const UnsafeUsage &unsafeUsage,
-                const std::map<std::string, std::list<const CallBase *>> &callsMap,
                 const char info[],
                 const FunctionCall * * const functionCallPtr,
                 bool warning) const;
+
+    private:
+        mutable std::unordered_map<std::string, std::list<const CallBase *>> mCallsMap;
+
+        /** Bit array of the bloom filter, see mayHaveCaller() */
+        mutable std::vector<unsigned long long> mCalleeIdFilter;
     };
 
     extern int maxCtuDepth;
@@ -29,9 +29,13 @@
 #include <array>
 #include <cassert>
 #include <cctype>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <iomanip>
+#include <map>
+#include <mutex>
+#include <set>
 
 InternalError::InternalError(const Token *tok, const std::string &errorMsg, Type type) :
     token(tok), errorMessage(errorMsg), type(type)
@@ -52,14 +56,58 @@ InternalError::InternalError(const Token *tok, const std::string &errorMsg, Type
     }
 }
 
+namespace {
+    // Process wide error id registry, see ErrorLogger::internErrorId().
+    // The map nodes keep the id strings alive so the string table can
+    // point straight into them.
+    struct ErrorIdRegistry {
+        std::map<std::string, unsigned int> index;
+        std::vector<const std::string *> strings;
+        std::mutex lock;
+    };
+}
+
+static ErrorIdRegistry &errorIdRegistry()
+{
+    static ErrorIdRegistry registry;
+    return registry;
+}
+
+unsigned int ErrorLogger::internErrorId(const std::string &id)
+{
+    ErrorIdRegistry &registry = errorIdRegistry();
+    std::lock_guard<std::mutex> lock(registry.lock);
+    if (registry.strings.empty()) {
+        // index 0 is reserved for the empty id so default constructed
+        // messages materialize an empty string
+        const std::map<std::string, unsigned int>::iterator empty = registry.index.insert(std::make_pair(std::string(), 0U)).first;
+        registry.strings.push_back(&empty->first);
+    }
+    std::map<std::string, unsigned int>::iterator it = registry.index.find(id);
+    if (it == registry.index.end()) {
+        it = registry.index.insert(std::make_pair(id, static_cast<unsigned int>(registry.strings.size()))).first;
+        registry.strings.push_back(&it->first);
+    }
+    return it->second;
+}
+
+const std::string &ErrorLogger::errorIdString(unsigned int idIndex)
+{
+    ErrorIdRegistry &registry = errorIdRegistry();
+    std::lock_guard<std::mutex> lock(registry.lock);
+    if (idIndex >= registry.strings.size())
+        return emptyString;
+    return *registry.strings[idIndex];
+}
+
 ErrorLogger::ErrorMessage::ErrorMessage()
-    : _severity(Severity::none), _cwe(0U), _inconclusive(false)
+    : _idIndex(0), _severity(Severity::none), _cwe(0U), _inconclusive(false)
 {
 }
 
 ErrorLogger::ErrorMessage::ErrorMessage(const std::list<FileLocation> &callStack, const std::string& file1, Severity::SeverityType severity, const std::string &msg, const std::string &id, bool inconclusive) :
     _callStack(callStack), // locations for this error message
-    _id(id),               // set the message id
+    _idIndex(internErrorId(id)), // set the message id
     file0(file1),
     _severity(severity),   // severity for this error message
     _cwe(0U),
@@ -73,7 +121,7 @@ ErrorLogger::ErrorMessage::ErrorMessage(const std::list<FileLocation> &callStack
 
 ErrorLogger::ErrorMessage::ErrorMessage(const std::list<FileLocation> &callStack, const std::string& file1, Severity::SeverityType severity, const std::string &msg, const std::string &id, const CWE &cwe, bool inconclusive) :
     _callStack(callStack), // locations for this error message
-    _id(id),               // set the message id
+    _idIndex(internErrorId(id)), // set the message id
     file0(file1),
     _severity(severity),   // severity for this error message
     _cwe(cwe.id),
@@ -84,7 +132,7 @@ ErrorLogger::ErrorMessage::ErrorMessage(const std::list<FileLocation> &callStack
 }
 
 ErrorLogger::ErrorMessage::ErrorMessage(const std::list<const Token*>& callstack, const TokenList* list, Severity::SeverityType severity, const std::string& id, const std::string& msg, bool inconclusive)
-    : _id(id), _severity(severity), _cwe(0U), _inconclusive(inconclusive)
+    : _idIndex(internErrorId(id)), _severity(severity), _cwe(0U), _inconclusive(inconclusive)
 {
     // Format callstack
     for (std::list<const Token *>::const_iterator it = callstack.begin(); it != callstack.end(); ++it) {
@@ -103,7 +151,7 @@ ErrorLogger::ErrorMessage::ErrorMessage(const std::list<const Token*>& callstack
 
 
 ErrorLogger::ErrorMessage::ErrorMessage(const std::list<const Token*>& callstack, const TokenList* list, Severity::SeverityType severity, const std::string& id, const std::string& msg, const CWE &cwe, bool inconclusive)
-    : _id(id), _severity(severity), _cwe(cwe.id), _inconclusive(inconclusive)
+    : _idIndex(internErrorId(id)), _severity(severity), _cwe(cwe.id), _inconclusive(inconclusive)
 {
     // Format callstack
     for (std::list<const Token *>::const_iterator it = callstack.begin(); it != callstack.end(); ++it) {
@@ -121,7 +169,7 @@ ErrorLogger::ErrorMessage::ErrorMessage(const std::list<const Token*>& callstack
 }
 
 ErrorLogger::ErrorMessage::ErrorMessage(const ErrorPath &errorPath, const TokenList *tokenList, Severity::SeverityType severity, const char id[], const std::string &msg, const CWE &cwe, bool inconclusive)
-    : _id(id), _severity(severity), _cwe(cwe.id), _inconclusive(inconclusive)
+    : _idIndex(internErrorId(id)), _severity(severity), _cwe(cwe.id), _inconclusive(inconclusive)
 {
     // Format callstack
     for (ErrorPath::const_iterator it = errorPath.begin(); it != errorPath.end(); ++it) {
@@ -140,14 +188,15 @@ ErrorLogger::ErrorMessage::ErrorMessage(const ErrorPath &errorPath, const TokenL
 }
 
 ErrorLogger::ErrorMessage::ErrorMessage(const tinyxml2::XMLElement * const errmsg)
-    : _severity(Severity::none),
+    : _idIndex(0),
+      _severity(Severity::none),
       _cwe(0U),
       _inconclusive(false)
 {
     const char * const unknown = "<UNKNOWN>";
 
     const char *attr = errmsg->Attribute("id");
-    _id = attr ? attr : unknown;
+    setId(attr ? attr : unknown);
 
     attr = errmsg->Attribute("severity");
     _severity = attr ? Severity::fromString(attr) : Severity::none;
@@ -194,20 +243,23 @@ void ErrorLogger::ErrorMessage::setmsg(const std::string &msg)
     const std::string symbolName = mSymbolNames.empty() ? std::string() : mSymbolNames.substr(0, mSymbolNames.find('\n'));
     if (pos == std::string::npos) {
         mShortMessage = replaceStr(msg, "$symbol", symbolName);
-        mVerboseMessage = replaceStr(msg, "$symbol", symbolName);
+        // no separate verbose text, verboseMessage() falls back to the short message
+        mVerboseMessage.clear();
     } else if (msg.compare(0,8,"$symbol:") == 0) {
         mSymbolNames += msg.substr(8, pos-7);
         setmsg(msg.substr(pos + 1));
     } else {
         mShortMessage = replaceStr(msg.substr(0, pos), "$symbol", symbolName);
         mVerboseMessage = replaceStr(msg.substr(pos + 1), "$symbol", symbolName);
+        if (mVerboseMessage == mShortMessage)
+            mVerboseMessage.clear();
     }
 }
 
 Suppressions::ErrorMessage ErrorLogger::ErrorMessage::toSuppressionsErrorMessage() const
 {
     Suppressions::ErrorMessage ret;
-    ret.errorId = _id;
+    ret.errorIdIndex = _idIndex;
     if (!_callStack.empty()) {
         ret.setFileName(_callStack.back().getfile(false));
         ret.lineNumber = _callStack.back().line;
@@ -222,25 +274,27 @@ std::string ErrorLogger::ErrorMessage::serialize() const
 {
     // Serialize this message into a simple string
     std::ostringstream oss;
-    oss << _id.length() << " " << _id;
-    oss << Severity::toString(_severity).length() << " " << Severity::toString(_severity);
-    oss << MathLib::toString(_cwe.id).length() << " " << MathLib::toString(_cwe.id);
+    const std::string &errorId = id();
+    oss << errorId.length() << " " << errorId;
+    const std::string severity = Severity::toString(_severity);
+    oss << severity.length() << " " << severity;
+    const std::string cwe = MathLib::toString(_cwe.id);
+    oss << cwe.length() << " " << cwe;
     if (_inconclusive) {
         const std::string inconclusive("inconclusive");
         oss << inconclusive.length() << " " << inconclusive;
     }
 
     const std::string saneShortMessage = fixInvalidChars(mShortMessage);
-    const std::string saneVerboseMessage = fixInvalidChars(mVerboseMessage);
+    const std::string saneVerboseMessage = fixInvalidChars(verboseMessage());
 
     oss << saneShortMessage.length() << " " << saneShortMessage;
     oss << saneVerboseMessage.length() << " " << saneVerboseMessage;
     oss << _callStack.size() << " ";
 
     for (std::list<ErrorLogger::ErrorMessage::FileLocation>::const_iterator loc = _callStack.begin(); loc != _callStack.end(); ++loc) {
-        std::ostringstream smallStream;
-        smallStream << (*loc).line << ':' << (*loc).getfile() << '\t' << loc->getinfo();
-        oss << smallStream.str().length() << " " << smallStream.str();
+        const std::string frame = MathLib::toString((*loc).line) + ':' + (*loc).getfile() + '\t' + loc->getinfo();
+        oss << frame.length() << " " << frame;
     }
 
     return oss.str();
@@ -250,20 +304,34 @@ bool ErrorLogger::ErrorMessage::deserialize(const std::string &data)
 {
     _inconclusive = false;
     _callStack.clear();
-    std::istringstream iss(data);
+
+    // Single pass over the data; character-by-character stream parsing is
+    // too slow when the parent process deserializes the results of all the
+    // worker processes.
+    std::string::size_type pos = 0;
+
+    // read a decimal length and skip the separator after it
+    const auto readLength = [&data, &pos](std::size_t &len) -> bool {
+        if (pos >= data.size() || !std::isdigit(static_cast<unsigned char>(data[pos])))
+            return false;
+        len = 0;
+        while (pos < data.size() && std::isdigit(static_cast<unsigned char>(data[pos])))
+            len = len * 10U + static_cast<std::size_t>(data[pos++] - '0');
+        ++pos;
+        return true;
+    };
+
     std::array<std::string, 5> results;
     std::size_t elem = 0;
-    while (iss.good()) {
-        unsigned int len = 0;
-        if (!(iss >> len))
+    while (elem < 5) {
+        std::size_t len = 0;
+        if (!readLength(len))
             return false;
+        if (pos + len > data.size())
+            throw InternalError(nullptr, "Internal Error: Deserialization of error message failed");
 
-        iss.get();
-        std::string temp;
-        for (unsigned int i = 0; i < len && iss.good(); ++i) {
-            const char c = static_cast<char>(iss.get());
-            temp.append(1, c);
-        }
+        std::string temp = data.substr(pos, len);
+        pos += len;
 
         if (temp == "inconclusive") {
             _inconclusive = true;
@@ -271,35 +339,30 @@ bool ErrorLogger::ErrorMessage::deserialize(const std::string &data)
         }
 
         results[elem++] = temp;
-        if (elem == 5)
-            break;
     }
 
-    if (elem != 5)
-        throw InternalError(nullptr, "Internal Error: Deserialization of error message failed");
-
-    _id = results[0];
+    setId(results[0]);
     _severity = Severity::fromString(results[1]);
     std::istringstream scwe(results[2]);
     scwe >> _cwe.id;
     mShortMessage = results[3];
     mVerboseMessage = results[4];
+    if (mVerboseMessage == mShortMessage)
+        mVerboseMessage.clear();
 
-    unsigned int stackSize = 0;
-    if (!(iss >> stackSize))
+    std::size_t stackSize = 0;
+    if (!readLength(stackSize))
         return false;
 
-    while (iss.good()) {
-        unsigned int len = 0;
-        if (!(iss >> len))
+    while (_callStack.size() < stackSize) {
+        std::size_t len = 0;
+        if (!readLength(len))
             return false;
+        if (pos + len > data.size())
+            throw InternalError(nullptr, "Internal Error: Deserialization of error message failed");
 
-        iss.get();
-        std::string temp;
-        for (unsigned int i = 0; i < len && iss.good(); ++i) {
-            const char c = static_cast<char>(iss.get());
-            temp.append(1, c);
-        }
+        std::string temp = data.substr(pos, len);
+        pos += len;
 
         const std::string::size_type colonPos = temp.find(':');
         if (colonPos == std::string::npos)
@@ -320,9 +383,6 @@ bool ErrorLogger::ErrorMessage::deserialize(const std::string &data)
         fiss >> loc.line;
 
         _callStack.push_back(loc);
-
-        if (_callStack.size() >= stackSize)
-            break;
     }
 
     return true;
@@ -380,10 +440,10 @@ std::string ErrorLogger::ErrorMessage::toXML() const
 {
     tinyxml2::XMLPrinter printer(nullptr, false, 2);
     printer.OpenElement("error", false);
-    printer.PushAttribute("id", _id.c_str());
+    printer.PushAttribute("id", id().c_str());
     printer.PushAttribute("severity", Severity::toString(_severity).c_str());
     printer.PushAttribute("msg", fixInvalidChars(mShortMessage).c_str());
-    printer.PushAttribute("verbose", fixInvalidChars(mVerboseMessage).c_str());
+    printer.PushAttribute("verbose", fixInvalidChars(verboseMessage()).c_str());
     if (_cwe.id)
         printer.PushAttribute("cwe", _cwe.id);
     if (_inconclusive)
@@ -458,7 +518,7 @@ std::string ErrorLogger::ErrorMessage::toString(bool verbose, const std::string
                 text << ", inconclusive";
             text << ") ";
         }
-        text << (verbose ? mVerboseMessage : mShortMessage);
+        text << (verbose ? verboseMessage() : mShortMessage);
         return text.str();
     }
 
@@ -471,7 +531,7 @@ std::string ErrorLogger::ErrorMessage::toString(bool verbose, const std::string
     findAndReplace(result, "\\r", "\r");
     findAndReplace(result, "\\t", "\t");
 
-    findAndReplace(result, "{id}", _id);
+    findAndReplace(result, "{id}", id());
     if (result.find("{inconclusive:") != std::string::npos) {
         const std::string::size_type pos1 = result.find("{inconclusive:");
         const std::string::size_type pos2 = result.find('}', pos1+1);
@@ -481,7 +541,7 @@ std::string ErrorLogger::ErrorMessage::toString(bool verbose, const std::string
     }
     findAndReplace(result, "{severity}", Severity::toString(_severity));
     findAndReplace(result, "{cwe}", MathLib::toString(_cwe.id));
-    findAndReplace(result, "{message}", verbose ? mVerboseMessage : mShortMessage);
+    findAndReplace(result, "{message}", verbose ? verboseMessage() : mShortMessage);
     findAndReplace(result, "{callstack}", _callStack.empty() ? emptyString : callStackToString(_callStack));
     if (!_callStack.empty()) {
         findAndReplace(result, "{file}", _callStack.back().getfile());
@@ -579,41 +639,47 @@ std::string ErrorLogger::callStackToString(const std::list<ErrorLogger::ErrorMes
 }
 
 
+const std::string *ErrorLogger::ErrorMessage::FileLocation::intern(const std::string &file)
+{
+    static std::set<std::string> pool;
+    static std::mutex poolMutex;
+    std::lock_guard<std::mutex> lock(poolMutex);
+    return &*pool.insert(file).first;
+}
+
 ErrorLogger::ErrorMessage::FileLocation::FileLocation(const Token* tok, const TokenList* tokenList)
-    : fileIndex(tok->fileIndex()), line(tok->linenr()), col(tok->col()), mOrigFileName(tokenList->getOrigFile(tok)), mFileName(tokenList->file(tok))
+    : fileIndex(tok->fileIndex()), line(tok->linenr()), col(tok->col()), mOrigFileName(intern(tokenList->getOrigFile(tok))), mFileName(intern(tokenList->file(tok)))
 {
 }
 
 ErrorLogger::ErrorMessage::FileLocation::FileLocation(const Token* tok, const std::string &info, const TokenList* tokenList)
-    : fileIndex(tok->fileIndex()), line(tok->linenr()), col(tok->col()), mOrigFileName(tokenList->getOrigFile(tok)), mFileName(tokenList->file(tok)), mInfo(info)
+    : fileIndex(tok->fileIndex()), line(tok->linenr()), col(tok->col()), mOrigFileName(intern(tokenList->getOrigFile(tok))), mFileName(intern(tokenList->file(tok))), mInfo(info)
 {
 }
 
 std::string ErrorLogger::ErrorMessage::FileLocation::getfile(bool convert) const
 {
     if (convert)
-        return Path::toNativeSeparators(mFileName);
-    return mFileName;
+        return Path::toNativeSeparators(*mFileName);
+    return *mFileName;
 }
 
 std::string ErrorLogger::ErrorMessage::FileLocation::getOrigFile(bool convert) const
 {
     if (convert)
-        return Path::toNativeSeparators(mOrigFileName);
-    return mOrigFileName;
+        return Path::toNativeSeparators(*mOrigFileName);
+    return *mOrigFileName;
 }
 
 void ErrorLogger::ErrorMessage::FileLocation::setfile(const std::string &file)
 {
-    mFileName = file;
-    mFileName = Path::fromNativeSeparators(mFileName);
-    mFileName = Path::simplifyPath(mFileName);
+    mFileName = intern(Path::simplifyPath(Path::fromNativeSeparators(file)));
 }
 
 std::string ErrorLogger::ErrorMessage::FileLocation::stringify() const
 {
     std::ostringstream oss;
-    oss << '[' << Path::toNativeSeparators(mFileName);
+    oss << '[' << Path::toNativeSeparators(*mFileName);
     if (line != Suppressions::Suppression::NO_LINE)
         oss << ':' << line;
     oss << ']';
@@ -652,6 +718,53 @@ std::string ErrorLogger::toxml(const std::string &str)
     return xml.str();
 }
 
+std::string ErrorLogger::toJson(const std::string &str)
+{
+    std::ostringstream json;
+    for (std::size_t i = 0U; i < str.length(); i++) {
+        const unsigned char c = str[i];
+        switch (c) {
+        case '\"':
+            json << "\\\"";
+            break;
+        case '\\':
+            json << "\\\\";
+            break;
+        case '\n':
+            json << "\\n";
+            break;
+        case '\r':
+            json << "\\r";
+            break;
+        case '\t':
+            json << "\\t";
+            break;
+        default:
+            if (c >= ' ' && c <= 0x7f)
+                json << c;
+            else {
+                char buf[8];
+                std::sprintf(buf, "\\u%04x", c);
+                json << buf;
+            }
+            break;
+        }
+    }
+    return json.str();
+}
+
+const char *ErrorLogger::sarifLevel(Severity::SeverityType severity)
+{
+    switch (severity) {
+    case Severity::error:
+        return "error";
+    case Severity::warning:
+        return "warning";
+    default:
+        return "note";
+    }
+}
+
 std::string ErrorLogger::plistHeader(const std::string &version, const std::vector<std::string> &files)
 {
     std::ostringstream ostr;
@@ -741,7 +854,7 @@ std::string ErrorLogger::plistData(const ErrorLogger::ErrorMessage &msg)
           << "   <key>description</key><string>" << ErrorLogger::toxml(msg.shortMessage()) << "</string>\r\n"
           << "   <key>category</key><string>" << Severity::toString(msg._severity) << "</string>\r\n"
           << "   <key>type</key><string>" << ErrorLogger::toxml(msg.shortMessage()) << "</string>\r\n"
-          << "   <key>check_name</key><string>" << msg._id << "</string>\r\n"
+          << "   <key>check_name</key><string>" << msg.id() << "</string>\r\n"
           << "   <!-- This hash is experimental and going to change! -->\r\n"
           << "   <key>issue_hash_content_of_line_in_context</key><string>" << 0 << "</string>\r\n"
           << "  <key>issue_context_kind</key><string></string>\r\n"
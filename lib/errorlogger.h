@@ -177,6 +177,20 @@ protected:
     std::ofstream plistFile;
 public:
 
+    /**
+     * Intern an error id into the process wide id registry. Each distinct
+     * id is assigned a compact index the first time it is seen - when a
+     * check creates a message with the id or when a suppression referring
+     * to it is added. Messages carry the index instead of the string so
+     * the suppression matching and id comparisons on every diagnostic are
+     * plain integer operations; the string is only materialized again for
+     * output, see errorIdString().
+     */
+    static unsigned int internErrorId(const std::string &id);
+
+    /** The id string behind an index from internErrorId() */
+    static const std::string &errorIdString(unsigned int idIndex);
+
     /**
      * Wrapper for error messages, provided by reportErr()
      */
@@ -190,15 +204,15 @@ public:
         class CPPCHECKLIB FileLocation {
         public:
             FileLocation()
-                : fileIndex(0), line(0), col(0) {
+                : fileIndex(0), line(0), col(0), mOrigFileName(intern(emptyString)), mFileName(intern(emptyString)) {
             }
 
             FileLocation(const std::string &file, unsigned int aline)
-                : fileIndex(0), line(aline), col(0), mOrigFileName(file), mFileName(file) {
+                : fileIndex(0), line(aline), col(0), mOrigFileName(intern(file)), mFileName(mOrigFileName) {
             }
 
             FileLocation(const std::string &file, const std::string &info, unsigned int aline)
-                : fileIndex(0), line(aline), col(0), mOrigFileName(file), mFileName(file), mInfo(info) {
+                : fileIndex(0), line(aline), col(0), mOrigFileName(intern(file)), mFileName(mOrigFileName), mInfo(info) {
             }
 
             FileLocation(const Token* tok, const TokenList* tokenList);
@@ -236,8 +250,16 @@ public:
             }
 
         private:
-            std::string mOrigFileName;
-            std::string mFileName;
+            /**
+             * Intern a file path into the run-wide pool. The same path is
+             * reported for many findings, so locations hold a pointer into
+             * the pool instead of copying the string; the full path is only
+             * materialized again when the message is output.
+             */
+            static const std::string *intern(const std::string &file);
+
+            const std::string *mOrigFileName;
+            const std::string *mFileName;
             std::string mInfo;
         };
 
@@ -272,7 +294,9 @@ public:
         bool deserialize(const std::string &data);
 
         std::list<FileLocation> _callStack;
-        std::string _id;
+
+        /** Compact index of the error id in the id registry, see ErrorLogger::internErrorId() */
+        unsigned int _idIndex;
 
         /** source file (not header) */
         std::string file0;
@@ -284,6 +308,16 @@ public:
         /** set short and verbose messages */
         void setmsg(const std::string &msg);
 
+        /** set the error id, interning it into the id registry */
+        void setId(const std::string &id) {
+            _idIndex = internErrorId(id);
+        }
+
+        /** error id string, materialized from the id registry */
+        const std::string &id() const {
+            return errorIdString(_idIndex);
+        }
+
         /** Short message (single line short message) */
         const std::string &shortMessage() const {
             return mShortMessage;
@@ -291,7 +325,7 @@ public:
 
         /** Verbose message (may be the same as the short message) */
         const std::string &verboseMessage() const {
-            return mVerboseMessage;
+            return mVerboseMessage.empty() ? mShortMessage : mVerboseMessage;
         }
 
         /** Symbol names */
@@ -316,7 +350,8 @@ public:
         /** Short message */
         std::string mShortMessage;
 
-        /** Verbose message */
+        /** Verbose message. Most messages have no separate verbose text; it
+         * is then left empty instead of storing a copy of the short message. */
         std::string mVerboseMessage;
 
         /** symbol names */
@@ -383,6 +418,16 @@ public:
      */
     static std::string toxml(const std::string &str);
 
+    /**
+     * Escape a string for use inside a JSON string literal
+     * @param str The input string
+     * @return The escaped string, without the surrounding quotes
+     */
+    static std::string toJson(const std::string &str);
+
+    /** SARIF level of a severity: "error", "warning" or "note" */
+    static const char *sarifLevel(Severity::SeverityType severity);
+
     static std::string plistHeader(const std::string &version, const std::vector<std::string> &files);
     static std::string plistData(const ErrorLogger::ErrorMessage &msg);
     static const char *plistFooter() {
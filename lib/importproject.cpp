@@ -27,6 +27,7 @@
 #include "utils.h"
 #include "../externals/picojson.h"
 
+#include <cctype>
 #include <cstring>
 #include <fstream>
 #include <utility>
@@ -168,6 +169,141 @@ void ImportProject::FileSettings::setIncludePaths(const std::string &basepath, c
     includePaths.swap(I);
 }
 
+static unsigned long long hashString(const std::string &str)
+{
+    // FNV-1a
+    unsigned long long hash = 0xcbf29ce484222325ULL;
+    for (const char c : str) {
+        hash ^= (unsigned char)c;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static unsigned long long hashFileContent(const std::string &filename)
+{
+    std::ifstream fin(filename, std::ios::binary);
+    if (!fin.is_open())
+        return 0;
+    unsigned long long hash = 0xcbf29ce484222325ULL;
+    char buf[4096];
+    while (fin.read(buf, sizeof(buf)), fin.gcount() > 0) {
+        for (std::streamsize i = 0; i < fin.gcount(); ++i) {
+            hash ^= (unsigned char)buf[i];
+            hash *= 0x100000001b3ULL;
+        }
+    }
+    return hash;
+}
+
+static std::string vsImportCacheFile(const std::string &buildDir, const std::string &filename)
+{
+    // one cache file per project file location so a changed project
+    // overwrites its old cache instead of leaving stale files behind
+    return buildDir + '/' + std::to_string(hashString(filename)) + ".vsimport";
+}
+
+bool ImportProject::readVsImportCache(const std::string &cacheFile)
+{
+    tinyxml2::XMLDocument doc;
+    if (doc.LoadFile(cacheFile.c_str()) != tinyxml2::XML_SUCCESS)
+        return false;
+    const tinyxml2::XMLElement * const rootnode = doc.FirstChildElement();
+    if (rootnode == nullptr || std::strcmp(rootnode->Name(), "vs-import") != 0)
+        return false;
+
+    // the cache is only valid if every project/property file that was read
+    // during the import still has the same content
+    for (const tinyxml2::XMLElement *node = rootnode->FirstChildElement(); node; node = node->NextSiblingElement()) {
+        if (std::strcmp(node->Name(), "project") != 0)
+            continue;
+        const char * const file = node->Attribute("file");
+        const char * const hash = node->Attribute("hash");
+        if (!file || !hash)
+            return false;
+        if (std::to_string(hashFileContent(file)) != hash)
+            return false;
+    }
+
+    std::list<FileSettings> cached;
+    for (const tinyxml2::XMLElement *node = rootnode->FirstChildElement(); node; node = node->NextSiblingElement()) {
+        if (std::strcmp(node->Name(), "filesettings") != 0)
+            continue;
+        FileSettings fs;
+        const char * const file = node->Attribute("file");
+        if (!file)
+            return false;
+        fs.filename = file;
+        const char * const cfg = node->Attribute("cfg");
+        if (cfg)
+            fs.cfg = cfg;
+        const char * const defines = node->Attribute("defines");
+        if (defines)
+            fs.defines = defines;
+        const char * const standard = node->Attribute("standard");
+        if (standard)
+            fs.standard = standard;
+        fs.platformType = (cppcheck::Platform::PlatformType)node->IntAttribute("platform");
+        fs.msc = node->BoolAttribute("msc");
+        fs.useMfc = node->BoolAttribute("mfc");
+        for (const tinyxml2::XMLElement *e = node->FirstChildElement(); e; e = e->NextSiblingElement()) {
+            const char * const name = e->Attribute("name");
+            if (!name)
+                return false;
+            if (std::strcmp(e->Name(), "undef") == 0)
+                fs.undefs.insert(name);
+            else if (std::strcmp(e->Name(), "includedir") == 0)
+                fs.includePaths.push_back(name);
+            else if (std::strcmp(e->Name(), "systemincludedir") == 0)
+                fs.systemIncludePaths.push_back(name);
+        }
+        cached.push_back(fs);
+    }
+
+    fileSettings.insert(fileSettings.end(), cached.begin(), cached.end());
+    return true;
+}
+
+void ImportProject::writeVsImportCache(const std::string &cacheFile) const
+{
+    tinyxml2::XMLDocument doc;
+    tinyxml2::XMLElement * const rootnode = doc.NewElement("vs-import");
+    doc.InsertEndChild(rootnode);
+    for (const std::string &file : mVsSourceFiles) {
+        tinyxml2::XMLElement * const node = doc.NewElement("project");
+        node->SetAttribute("file", file.c_str());
+        node->SetAttribute("hash", std::to_string(hashFileContent(file)).c_str());
+        rootnode->InsertEndChild(node);
+    }
+    for (const FileSettings &fs : fileSettings) {
+        tinyxml2::XMLElement * const node = doc.NewElement("filesettings");
+        node->SetAttribute("file", fs.filename.c_str());
+        node->SetAttribute("cfg", fs.cfg.c_str());
+        node->SetAttribute("defines", fs.defines.c_str());
+        node->SetAttribute("standard", fs.standard.c_str());
+        node->SetAttribute("platform", (int)fs.platformType);
+        node->SetAttribute("msc", fs.msc);
+        node->SetAttribute("mfc", fs.useMfc);
+        for (const std::string &undef : fs.undefs) {
+            tinyxml2::XMLElement * const e = doc.NewElement("undef");
+            e->SetAttribute("name", undef.c_str());
+            node->InsertEndChild(e);
+        }
+        for (const std::string &includePath : fs.includePaths) {
+            tinyxml2::XMLElement * const e = doc.NewElement("includedir");
+            e->SetAttribute("name", includePath.c_str());
+            node->InsertEndChild(e);
+        }
+        for (const std::string &includePath : fs.systemIncludePaths) {
+            tinyxml2::XMLElement * const e = doc.NewElement("systemincludedir");
+            e->SetAttribute("name", includePath.c_str());
+            node->InsertEndChild(e);
+        }
+        rootnode->InsertEndChild(node);
+    }
+    doc.SaveFile(cacheFile.c_str());
+}
+
 ImportProject::Type ImportProject::import(const std::string &filename, Settings *settings)
 {
     std::ifstream fin(filename);
@@ -180,11 +316,24 @@ ImportProject::Type ImportProject::import(const std::string &filename, Settings
         std::string path(Path::getPathFromFilename(Path::fromNativeSeparators(filename)));
         if (!path.empty() && !endsWith(path,'/'))
             path += '/';
+        const std::string cacheFile = (settings && !settings->buildDir.empty()) ? vsImportCacheFile(settings->buildDir, filename) : emptyString;
+        if (!cacheFile.empty() && readVsImportCache(cacheFile))
+            return ImportProject::Type::VS_SLN;
+        mVsSourceFiles.clear();
+        mVsSourceFiles.push_back(filename);
         importSln(fin,path);
+        if (!cacheFile.empty())
+            writeVsImportCache(cacheFile);
         return ImportProject::Type::VS_SLN;
     } else if (endsWith(filename, ".vcxproj", 8)) {
+        const std::string cacheFile = (settings && !settings->buildDir.empty()) ? vsImportCacheFile(settings->buildDir, filename) : emptyString;
+        if (!cacheFile.empty() && readVsImportCache(cacheFile))
+            return ImportProject::Type::VS_VCXPROJ;
+        mVsSourceFiles.clear();
         std::map<std::string, std::string, cppcheck::stricmp> variables;
         importVcxproj(filename, variables, emptyString);
+        if (!cacheFile.empty())
+            writeVsImportCache(cacheFile);
         return ImportProject::Type::VS_VCXPROJ;
     } else if (endsWith(filename, ".bpr", 4)) {
         importBcb6Prj(filename);
@@ -255,12 +404,29 @@ void ImportProject::FileSettings::parseCommand(const std::string &command)
 
 void ImportProject::importCompileCommands(std::istream &istr)
 {
-    picojson::value compileCommands;
-    istr >> compileCommands;
-    if (!compileCommands.is<picojson::array>())
+    // Parse the top level array one entry at a time instead of reading the
+    // whole compile database into memory first; compile_commands.json can
+    // be hundreds of megabytes for big projects.
+    char ch = ' ';
+    while (istr.get(ch) && std::isspace((unsigned char)ch))
+        ;
+    if (!istr.good() || ch != '[')
         return;
 
-    for (const picojson::value &fileInfo : compileCommands.get<picojson::array>()) {
+    while (istr.good()) {
+        while (istr.get(ch) && std::isspace((unsigned char)ch))
+            ;
+        if (!istr.good() || ch == ']')
+            break;
+        if (ch == ',')
+            continue;
+        istr.unget();
+
+        picojson::value fileInfo;
+        istr >> fileInfo;
+        if (istr.fail() || !fileInfo.is<picojson::object>())
+            return;
+
         picojson::object obj = fileInfo.get<picojson::object>();
         std::string dirpath = Path::fromNativeSeparators(obj["directory"].get<std::string>());
 
@@ -453,7 +619,7 @@ static void importPropertyGroup(const tinyxml2::XMLElement *node, std::map<std::
     }
 }
 
-static void loadVisualStudioProperties(const std::string &props, std::map<std::string,std::string,cppcheck::stricmp> *variables, std::string *includePath, const std::string &additionalIncludeDirectories, std::list<ItemDefinitionGroup> &itemDefinitionGroupList)
+static void loadVisualStudioProperties(const std::string &props, std::map<std::string,std::string,cppcheck::stricmp> *variables, std::string *includePath, const std::string &additionalIncludeDirectories, std::list<ItemDefinitionGroup> &itemDefinitionGroupList, std::vector<std::string> *sourceFiles)
 {
     std::string filename(props);
     // variables can't be resolved
@@ -467,6 +633,7 @@ static void loadVisualStudioProperties(const std::string &props, std::map<std::s
     tinyxml2::XMLDocument doc;
     if (doc.LoadFile(filename.c_str()) != tinyxml2::XML_SUCCESS)
         return;
+    sourceFiles->push_back(filename);
     const tinyxml2::XMLElement * const rootnode = doc.FirstChildElement();
     if (rootnode == nullptr)
         return;
@@ -484,7 +651,7 @@ static void loadVisualStudioProperties(const std::string &props, std::map<std::s
                     if (loadprj.find('$') == std::string::npos) {
                         loadprj = Path::getPathFromFilename(filename) + loadprj;
                     }
-                    loadVisualStudioProperties(loadprj, variables, includePath, additionalIncludeDirectories, itemDefinitionGroupList);
+                    loadVisualStudioProperties(loadprj, variables, includePath, additionalIncludeDirectories, itemDefinitionGroupList, sourceFiles);
                 }
             }
         } else if (std::strcmp(node->Name(),"PropertyGroup")==0) {
@@ -513,6 +680,7 @@ void ImportProject::importVcxproj(const std::string &filename, std::map<std::str
     const tinyxml2::XMLElement * const rootnode = doc.FirstChildElement();
     if (rootnode == nullptr)
         return;
+    mVsSourceFiles.push_back(filename);
     for (const tinyxml2::XMLElement *node = rootnode->FirstChildElement(); node; node = node->NextSiblingElement()) {
         if (std::strcmp(node->Name(), "ItemGroup") == 0) {
             const char *labelAttribute = node->Attribute("Label");
@@ -544,36 +712,47 @@ void ImportProject::importVcxproj(const std::string &filename, std::map<std::str
                     if (std::strcmp(e->Name(), "Import") == 0) {
                         const char *projectAttribute = e->Attribute("Project");
                         if (projectAttribute)
-                            loadVisualStudioProperties(projectAttribute, &variables, &includePath, additionalIncludeDirectories, itemDefinitionGroupList);
+                            loadVisualStudioProperties(projectAttribute, &variables, &includePath, additionalIncludeDirectories, itemDefinitionGroupList, &mVsSourceFiles);
                     }
                 }
             }
         }
     }
 
+    // Evaluate each configuration once. The defines and include paths are
+    // the same for every file in the project, so there is no need to
+    // re-evaluate the conditions (which tokenizes each of them) and
+    // re-normalize the paths for every file/configuration pair.
+    std::list<FileSettings> configurationSettings;
+    for (const ProjectConfiguration &p : projectConfigurationList) {
+        FileSettings fs;
+        fs.cfg = p.name;
+        fs.msc = true;
+        fs.useMfc = useOfMfc;
+        fs.defines = "_WIN32=1";
+        if (p.platform == ProjectConfiguration::Win32)
+            fs.platformType = cppcheck::Platform::Win32W;
+        else if (p.platform == ProjectConfiguration::x64) {
+            fs.platformType = cppcheck::Platform::Win64;
+            fs.defines += ";_WIN64=1";
+        }
+        std::string additionalIncludePaths;
+        for (const ItemDefinitionGroup &i : itemDefinitionGroupList) {
+            if (!i.conditionIsTrue(p))
+                continue;
+            fs.defines += ';' + i.preprocessorDefinitions;
+            additionalIncludePaths += ';' + i.additionalIncludePaths;
+        }
+        fs.setDefines(fs.defines);
+        fs.setIncludePaths(Path::getPathFromFilename(filename), toStringList(includePath + ';' + additionalIncludePaths), variables);
+        configurationSettings.push_back(fs);
+    }
+
     for (const std::string &c : compileList) {
-        for (const ProjectConfiguration &p : projectConfigurationList) {
-            FileSettings fs;
-            fs.filename = Path::simplifyPath(Path::isAbsolute(c) ? c : Path::getPathFromFilename(filename) + c);
-            fs.cfg = p.name;
-            fs.msc = true;
-            fs.useMfc = useOfMfc;
-            fs.defines = "_WIN32=1";
-            if (p.platform == ProjectConfiguration::Win32)
-                fs.platformType = cppcheck::Platform::Win32W;
-            else if (p.platform == ProjectConfiguration::x64) {
-                fs.platformType = cppcheck::Platform::Win64;
-                fs.defines += ";_WIN64=1";
-            }
-            std::string additionalIncludePaths;
-            for (const ItemDefinitionGroup &i : itemDefinitionGroupList) {
-                if (!i.conditionIsTrue(p))
-                    continue;
-                fs.defines += ';' + i.preprocessorDefinitions;
-                additionalIncludePaths += ';' + i.additionalIncludePaths;
-            }
-            fs.setDefines(fs.defines);
-            fs.setIncludePaths(Path::getPathFromFilename(filename), toStringList(includePath + ';' + additionalIncludePaths), variables);
+        const std::string sourcefile = Path::simplifyPath(Path::isAbsolute(c) ? c : Path::getPathFromFilename(filename) + c);
+        for (const FileSettings &cfs : configurationSettings) {
+            FileSettings fs(cfs);
+            fs.filename = sourcefile;
             fileSettings.push_back(fs);
         }
     }
@@ -102,6 +102,20 @@ private:
     void importSln(std::istream &istr, const std::string &path);
     void importVcxproj(const std::string &filename, std::map<std::string, std::string, cppcheck::stricmp> &variables, const std::string &additionalIncludeDirectories);
     void importBcb6Prj(const std::string &projectFilename);
+
+    /**
+     * Load cached Visual Studio import results from the build dir.
+     * The cache is only used when every recorded project/property file
+     * still has the same content hash.
+     * @return true if the cache was valid and fileSettings was filled
+     */
+    bool readVsImportCache(const std::string &cacheFile);
+
+    /** Write the Visual Studio import results to the build dir. */
+    void writeVsImportCache(const std::string &cacheFile) const;
+
+    /** project/property files read by the current Visual Studio import */
+    std::vector<std::string> mVsSourceFiles;
 };
 
 /// @}
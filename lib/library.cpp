@@ -30,7 +30,10 @@
 #include <cctype>
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
 #include <list>
+#include <sstream>
+#include <sys/stat.h>
 
 static std::vector<std::string> getnames(const char *names)
 {
@@ -59,41 +62,97 @@ Library::Library() : mAllocId(0)
 {
 }
 
+/** Library configurations embedded into the binary, by name. Function local
+ * so registration from a static initializer cannot run into an unconstructed
+ * map. */
+static std::map<std::string, std::pair<const char *, std::size_t> > &embeddedCfg()
+{
+    static std::map<std::string, std::pair<const char *, std::size_t> > cfgdata;
+    return cfgdata;
+}
+
+void Library::embed(const char name[], const char xmldata[], std::size_t len)
+{
+    embeddedCfg()[name] = std::make_pair(xmldata, len);
+}
+
+/** Read a library file into one buffer so it can be parsed from memory */
+static bool readfile(const std::string &filename, std::string *filedata)
+{
+    struct stat filestat;
+    if (stat(filename.c_str(), &filestat) != 0 || (filestat.st_mode & S_IFMT) != S_IFREG)
+        return false;
+    std::ifstream fin(filename);
+    if (!fin.is_open())
+        return false;
+    std::ostringstream ostr;
+    ostr << fin.rdbuf();
+    *filedata = ostr.str();
+    return true;
+}
+
+/** Save the XML of a section so it can be parsed when it is first queried */
+static void deferSection(const tinyxml2::XMLElement * const node, std::list<std::string> &sections)
+{
+    tinyxml2::XMLPrinter printer;
+    node->Accept(&printer);
+    sections.emplace_back(printer.CStr(), printer.CStrSize() - 1);
+}
+
 Library::Error Library::load(const char exename[], const char path[])
 {
     if (std::strchr(path,',') != nullptr) {
-        std::string p(path);
+        const std::string p(path);
+        std::string::size_type pos = 0;
         for (;;) {
-            const std::string::size_type pos = p.find(',');
-            if (pos == std::string::npos)
+            const std::string::size_type next = p.find(',', pos);
+            if (next == std::string::npos)
                 break;
-            const Error &e = load(exename, p.substr(0,pos).c_str());
+            const Error &e = load(exename, p.substr(pos, next-pos).c_str());
             if (e.errorcode != OK)
                 return e;
-            p = p.substr(pos+1);
+            pos = next + 1;
         }
-        if (!p.empty())
-            return load(exename, p.c_str());
+        if (pos < p.size())
+            return load(exename, p.substr(pos).c_str());
         return Error();
     }
 
+    // Resolve the file before parsing so a library that is given twice is
+    // not parsed twice, and so the file is read in one pass.
     std::string absolute_path;
-    // open file..
-    tinyxml2::XMLDocument doc;
-    tinyxml2::XMLError error = doc.LoadFile(path);
-    if (error == tinyxml2::XML_ERROR_FILE_READ_ERROR && Path::getFilenameExtension(path).empty())
-        // Reading file failed, try again...
-        error = tinyxml2::XML_ERROR_FILE_NOT_FOUND;
-    if (error == tinyxml2::XML_ERROR_FILE_NOT_FOUND) {
+    std::string filedata;
+    if (readfile(path, &filedata))
+        absolute_path = Path::getAbsoluteFilePath(path);
+    else {
         // failed to open file.. is there no extension?
         std::string fullfilename(path);
         if (Path::getFilenameExtension(fullfilename).empty()) {
             fullfilename += ".cfg";
-            error = doc.LoadFile(fullfilename.c_str());
-            if (error != tinyxml2::XML_ERROR_FILE_NOT_FOUND)
+            if (readfile(fullfilename, &filedata))
                 absolute_path = Path::getAbsoluteFilePath(fullfilename);
         }
 
+        // Configurations embedded into the binary (see tools/embedcfg.py)
+        // are used unless a file in the current directory overrides them, so
+        // the default libraries load without file system access.
+        if (absolute_path.empty()) {
+            const std::map<std::string, std::pair<const char *, std::size_t> >::const_iterator it = embeddedCfg().find(fullfilename);
+            if (it != embeddedCfg().end()) {
+                if (mFiles.find("embedded:" + fullfilename) != mFiles.end())
+                    return Error(OK); // ignore duplicates
+                tinyxml2::XMLDocument doc;
+                if (doc.Parse(it->second.first, it->second.second) != tinyxml2::XML_SUCCESS) {
+                    doc.PrintError();
+                    return Error(BAD_XML);
+                }
+                Error err = load(doc, true);
+                if (err.errorcode == OK)
+                    mFiles.insert("embedded:" + fullfilename);
+                return err;
+            }
+        }
+
         std::list<std::string> cfgfolders;
 #ifdef CFGDIR
         cfgfolders.push_back(CFGDIR);
@@ -104,35 +163,32 @@ Library::Error Library::load(const char exename[], const char path[])
             cfgfolders.push_back(exepath);
         }
 
-        while (error == tinyxml2::XML_ERROR_FILE_NOT_FOUND && !cfgfolders.empty()) {
+        while (absolute_path.empty() && !cfgfolders.empty()) {
             const std::string cfgfolder(cfgfolders.front());
             cfgfolders.pop_front();
             const char *sep = (!cfgfolder.empty() && endsWith(cfgfolder,'/') ? "" : "/");
             const std::string filename(cfgfolder + sep + fullfilename);
-            error = doc.LoadFile(filename.c_str());
-            if (error != tinyxml2::XML_ERROR_FILE_NOT_FOUND)
+            if (readfile(filename, &filedata))
                 absolute_path = Path::getAbsoluteFilePath(filename);
         }
-    } else
-        absolute_path = Path::getAbsoluteFilePath(path);
 
-    if (error == tinyxml2::XML_SUCCESS) {
-        if (mFiles.find(absolute_path) == mFiles.end()) {
-            Error err = load(doc);
-            if (err.errorcode == OK)
-                mFiles.insert(absolute_path);
-            return err;
-        }
+        if (absolute_path.empty())
+            return Error(FILE_NOT_FOUND);
+    }
 
+    if (mFiles.find(absolute_path) != mFiles.end())
         return Error(OK); // ignore duplicates
-    }
 
-    if (error == tinyxml2::XML_ERROR_FILE_NOT_FOUND)
-        return Error(FILE_NOT_FOUND);
-    else {
+    tinyxml2::XMLDocument doc;
+    if (doc.Parse(filedata.c_str(), filedata.size()) != tinyxml2::XML_SUCCESS) {
         doc.PrintError();
         return Error(BAD_XML);
     }
+
+    Error err = load(doc, true);
+    if (err.errorcode == OK)
+        mFiles.insert(absolute_path);
+    return err;
 }
 
 bool Library::loadxmldata(const char xmldata[], std::size_t len)
@@ -142,6 +198,11 @@ bool Library::loadxmldata(const char xmldata[], std::size_t len)
 }
 
 Library::Error Library::load(const tinyxml2::XMLDocument &doc)
+{
+    return load(doc, false);
+}
+
+Library::Error Library::load(const tinyxml2::XMLDocument &doc, bool deferSections)
 {
     const tinyxml2::XMLElement * const rootnode = doc.FirstChildElement();
 
@@ -258,208 +319,33 @@ Library::Error Library::load(const tinyxml2::XMLDocument &doc)
         }
 
         else if (nodename == "markup") {
-            const char * const extension = node->Attribute("ext");
-            if (!extension)
+            if (!node->Attribute("ext"))
                 return Error(MISSING_ATTRIBUTE, "ext");
-            mMarkupExtensions.insert(extension);
-
-            mReportErrors[extension] = (node->Attribute("reporterrors", "true") != nullptr);
-            mProcessAfterCode[extension] = (node->Attribute("aftercode", "true") != nullptr);
-
-            for (const tinyxml2::XMLElement *markupnode = node->FirstChildElement(); markupnode; markupnode = markupnode->NextSiblingElement()) {
-                const std::string markupnodename = markupnode->Name();
-                if (markupnodename == "keywords") {
-                    for (const tinyxml2::XMLElement *librarynode = markupnode->FirstChildElement(); librarynode; librarynode = librarynode->NextSiblingElement()) {
-                        if (strcmp(librarynode->Name(), "keyword") == 0) {
-                            const char* nodeName = librarynode->Attribute("name");
-                            if (nodeName == nullptr)
-                                return Error(MISSING_ATTRIBUTE, "name");
-                            mKeywords[extension].insert(nodeName);
-                        } else
-                            unknown_elements.insert(librarynode->Name());
-                    }
-                }
-
-                else if (markupnodename == "exported") {
-                    for (const tinyxml2::XMLElement *exporter = markupnode->FirstChildElement(); exporter; exporter = exporter->NextSiblingElement()) {
-                        if (strcmp(exporter->Name(), "exporter") != 0) {
-                            unknown_elements.insert(exporter->Name());
-                            continue;
-                        }
-
-                        const char * const prefix = exporter->Attribute("prefix");
-                        if (!prefix)
-                            return Error(MISSING_ATTRIBUTE, "prefix");
-
-                        for (const tinyxml2::XMLElement *e = exporter->FirstChildElement(); e; e = e->NextSiblingElement()) {
-                            const std::string ename = e->Name();
-                            if (ename == "prefix")
-                                mExporters[prefix].addPrefix(e->GetText());
-                            else if (ename == "suffix")
-                                mExporters[prefix].addSuffix(e->GetText());
-                            else
-                                unknown_elements.insert(ename);
-                        }
-                    }
-                }
-
-                else if (markupnodename == "imported") {
-                    for (const tinyxml2::XMLElement *librarynode = markupnode->FirstChildElement(); librarynode; librarynode = librarynode->NextSiblingElement()) {
-                        if (strcmp(librarynode->Name(), "importer") == 0)
-                            mImporters[extension].insert(librarynode->GetText());
-                        else
-                            unknown_elements.insert(librarynode->Name());
-                    }
-                }
-
-                else if (markupnodename == "codeblocks") {
-                    for (const tinyxml2::XMLElement *blocknode = markupnode->FirstChildElement(); blocknode; blocknode = blocknode->NextSiblingElement()) {
-                        const std::string blocknodename = blocknode->Name();
-                        if (blocknodename == "block") {
-                            const char * blockName = blocknode->Attribute("name");
-                            if (blockName)
-                                mExecutableBlocks[extension].addBlock(blockName);
-                        } else if (blocknodename == "structure") {
-                            const char * start = blocknode->Attribute("start");
-                            if (start)
-                                mExecutableBlocks[extension].setStart(start);
-                            const char * end = blocknode->Attribute("end");
-                            if (end)
-                                mExecutableBlocks[extension].setEnd(end);
-                            const char * offset = blocknode->Attribute("offset");
-                            if (offset)
-                                mExecutableBlocks[extension].setOffset(atoi(offset));
-                        }
-
-                        else
-                            unknown_elements.insert(blocknodename);
-                    }
-                }
-
-                else
-                    unknown_elements.insert(markupnodename);
+            if (deferSections) {
+                // The extension and its attributes are needed to recognize
+                // markup files; the keyword/exporter/importer/codeblock
+                // tables are only built when such a file is analyzed.
+                const char * const extension = node->Attribute("ext");
+                mMarkupExtensions.insert(extension);
+                mReportErrors[extension] = (node->Attribute("reporterrors", "true") != nullptr);
+                mProcessAfterCode[extension] = (node->Attribute("aftercode", "true") != nullptr);
+                deferSection(node, mDeferredMarkup);
+            } else {
+                const Error err = loadMarkup(node, unknown_elements);
+                if (err.errorcode != OK)
+                    return err;
             }
         }
 
         else if (nodename == "container") {
-            const char* const id = node->Attribute("id");
-            if (!id)
+            if (!node->Attribute("id"))
                 return Error(MISSING_ATTRIBUTE, "id");
-
-            Container& container = containers[id];
-
-            const char* const inherits = node->Attribute("inherits");
-            if (inherits) {
-                const std::map<std::string, Container>::const_iterator i = containers.find(inherits);
-                if (i != containers.end())
-                    container = i->second; // Take values from parent and overwrite them if necessary
-                else
-                    return Error(BAD_ATTRIBUTE_VALUE, inherits);
-            }
-
-            const char* const startPattern = node->Attribute("startPattern");
-            if (startPattern)
-                container.startPattern = startPattern;
-            const char* const endPattern = node->Attribute("endPattern");
-            if (endPattern)
-                container.endPattern = endPattern;
-            const char* const itEndPattern = node->Attribute("itEndPattern");
-            if (itEndPattern)
-                container.itEndPattern = itEndPattern;
-            const char* const opLessAllowed = node->Attribute("opLessAllowed");
-            if (opLessAllowed)
-                container.opLessAllowed = std::string(opLessAllowed) == "true";
-
-            for (const tinyxml2::XMLElement *containerNode = node->FirstChildElement(); containerNode; containerNode = containerNode->NextSiblingElement()) {
-                const std::string containerNodeName = containerNode->Name();
-                if (containerNodeName == "size" || containerNodeName == "access" || containerNodeName == "other") {
-                    for (const tinyxml2::XMLElement *functionNode = containerNode->FirstChildElement(); functionNode; functionNode = functionNode->NextSiblingElement()) {
-                        if (std::string(functionNode->Name()) != "function") {
-                            unknown_elements.insert(functionNode->Name());
-                            continue;
-                        }
-
-                        const char* const functionName = functionNode->Attribute("name");
-                        if (!functionName)
-                            return Error(MISSING_ATTRIBUTE, "name");
-
-                        const char* const action_ptr = functionNode->Attribute("action");
-                        Container::Action action = Container::NO_ACTION;
-                        if (action_ptr) {
-                            std::string actionName = action_ptr;
-                            if (actionName == "resize")
-                                action = Container::RESIZE;
-                            else if (actionName == "clear")
-                                action = Container::CLEAR;
-                            else if (actionName == "push")
-                                action = Container::PUSH;
-                            else if (actionName == "pop")
-                                action = Container::POP;
-                            else if (actionName == "find")
-                                action = Container::FIND;
-                            else if (actionName == "insert")
-                                action = Container::INSERT;
-                            else if (actionName == "erase")
-                                action = Container::ERASE;
-                            else if (actionName == "change-content")
-                                action = Container::CHANGE_CONTENT;
-                            else if (actionName == "change-internal")
-                                action = Container::CHANGE_INTERNAL;
-                            else if (actionName == "change")
-                                action = Container::CHANGE;
-                            else
-                                return Error(BAD_ATTRIBUTE_VALUE, actionName);
-                        }
-
-                        const char* const yield_ptr = functionNode->Attribute("yields");
-                        Container::Yield yield = Container::NO_YIELD;
-                        if (yield_ptr) {
-                            std::string yieldName = yield_ptr;
-                            if (yieldName == "at_index")
-                                yield = Container::AT_INDEX;
-                            else if (yieldName == "item")
-                                yield = Container::ITEM;
-                            else if (yieldName == "buffer")
-                                yield = Container::BUFFER;
-                            else if (yieldName == "buffer-nt")
-                                yield = Container::BUFFER_NT;
-                            else if (yieldName == "start-iterator")
-                                yield = Container::START_ITERATOR;
-                            else if (yieldName == "end-iterator")
-                                yield = Container::END_ITERATOR;
-                            else if (yieldName == "iterator")
-                                yield = Container::ITERATOR;
-                            else if (yieldName == "size")
-                                yield = Container::SIZE;
-                            else if (yieldName == "empty")
-                                yield = Container::EMPTY;
-                            else
-                                return Error(BAD_ATTRIBUTE_VALUE, yieldName);
-                        }
-
-                        container.functions[functionName].action = action;
-                        container.functions[functionName].yield = yield;
-                    }
-
-                    if (containerNodeName == "size") {
-                        const char* const templateArg = containerNode->Attribute("templateParameter");
-                        if (templateArg)
-                            container.size_templateArgNo = atoi(templateArg);
-                    } else if (containerNodeName == "access") {
-                        const char* const indexArg = containerNode->Attribute("indexOperator");
-                        if (indexArg)
-                            container.arrayLike_indexOp = std::string(indexArg) == "array-like";
-                    }
-                } else if (containerNodeName == "type") {
-                    const char* const templateArg = containerNode->Attribute("templateParameter");
-                    if (templateArg)
-                        container.type_templateArgNo = atoi(templateArg);
-
-                    const char* const string = containerNode->Attribute("string");
-                    if (string)
-                        container.stdStringLike = std::string(string) == "std-like";
-                } else
-                    unknown_elements.insert(containerNodeName);
+            if (deferSections)
+                deferSection(node, mDeferredContainers);
+            else {
+                const Error err = loadContainer(node, unknown_elements);
+                if (err.errorcode != OK)
+                    return err;
             }
         }
 
@@ -733,6 +619,240 @@ Library::Error Library::loadFunction(const tinyxml2::XMLElement * const node, co
     return Error(OK);
 }
 
+Library::Error Library::loadMarkup(const tinyxml2::XMLElement * const node, std::set<std::string> &unknown_elements)
+{
+    const char * const extension = node->Attribute("ext");
+    if (!extension)
+        return Error(MISSING_ATTRIBUTE, "ext");
+    mMarkupExtensions.insert(extension);
+
+    mReportErrors[extension] = (node->Attribute("reporterrors", "true") != nullptr);
+    mProcessAfterCode[extension] = (node->Attribute("aftercode", "true") != nullptr);
+
+    for (const tinyxml2::XMLElement *markupnode = node->FirstChildElement(); markupnode; markupnode = markupnode->NextSiblingElement()) {
+        const std::string markupnodename = markupnode->Name();
+        if (markupnodename == "keywords") {
+            for (const tinyxml2::XMLElement *librarynode = markupnode->FirstChildElement(); librarynode; librarynode = librarynode->NextSiblingElement()) {
+                if (strcmp(librarynode->Name(), "keyword") == 0) {
+                    const char* nodeName = librarynode->Attribute("name");
+                    if (nodeName == nullptr)
+                        return Error(MISSING_ATTRIBUTE, "name");
+                    mKeywords[extension].insert(nodeName);
+                } else
+                    unknown_elements.insert(librarynode->Name());
+            }
+        }
+
+        else if (markupnodename == "exported") {
+            for (const tinyxml2::XMLElement *exporter = markupnode->FirstChildElement(); exporter; exporter = exporter->NextSiblingElement()) {
+                if (strcmp(exporter->Name(), "exporter") != 0) {
+                    unknown_elements.insert(exporter->Name());
+                    continue;
+                }
+
+                const char * const prefix = exporter->Attribute("prefix");
+                if (!prefix)
+                    return Error(MISSING_ATTRIBUTE, "prefix");
+
+                for (const tinyxml2::XMLElement *e = exporter->FirstChildElement(); e; e = e->NextSiblingElement()) {
+                    const std::string ename = e->Name();
+                    if (ename == "prefix")
+                        mExporters[prefix].addPrefix(e->GetText());
+                    else if (ename == "suffix")
+                        mExporters[prefix].addSuffix(e->GetText());
+                    else
+                        unknown_elements.insert(ename);
+                }
+            }
+        }
+
+        else if (markupnodename == "imported") {
+            for (const tinyxml2::XMLElement *librarynode = markupnode->FirstChildElement(); librarynode; librarynode = librarynode->NextSiblingElement()) {
+                if (strcmp(librarynode->Name(), "importer") == 0)
+                    mImporters[extension].insert(librarynode->GetText());
+                else
+                    unknown_elements.insert(librarynode->Name());
+            }
+        }
+
+        else if (markupnodename == "codeblocks") {
+            for (const tinyxml2::XMLElement *blocknode = markupnode->FirstChildElement(); blocknode; blocknode = blocknode->NextSiblingElement()) {
+                const std::string blocknodename = blocknode->Name();
+                if (blocknodename == "block") {
+                    const char * blockName = blocknode->Attribute("name");
+                    if (blockName)
+                        mExecutableBlocks[extension].addBlock(blockName);
+                } else if (blocknodename == "structure") {
+                    const char * start = blocknode->Attribute("start");
+                    if (start)
+                        mExecutableBlocks[extension].setStart(start);
+                    const char * end = blocknode->Attribute("end");
+                    if (end)
+                        mExecutableBlocks[extension].setEnd(end);
+                    const char * offset = blocknode->Attribute("offset");
+                    if (offset)
+                        mExecutableBlocks[extension].setOffset(atoi(offset));
+                }
+
+                else
+                    unknown_elements.insert(blocknodename);
+            }
+        }
+
+        else
+            unknown_elements.insert(markupnodename);
+    }
+    return Error(OK);
+}
+
+Library::Error Library::loadContainer(const tinyxml2::XMLElement * const node, std::set<std::string> &unknown_elements)
+{
+    const char* const id = node->Attribute("id");
+    if (!id)
+        return Error(MISSING_ATTRIBUTE, "id");
+
+    Container& container = containers[id];
+
+    const char* const inherits = node->Attribute("inherits");
+    if (inherits) {
+        const std::map<std::string, Container>::const_iterator i = containers.find(inherits);
+        if (i != containers.end())
+            container = i->second; // Take values from parent and overwrite them if necessary
+        else
+            return Error(BAD_ATTRIBUTE_VALUE, inherits);
+    }
+
+    const char* const startPattern = node->Attribute("startPattern");
+    if (startPattern)
+        container.startPattern = startPattern;
+    const char* const endPattern = node->Attribute("endPattern");
+    if (endPattern)
+        container.endPattern = endPattern;
+    const char* const itEndPattern = node->Attribute("itEndPattern");
+    if (itEndPattern)
+        container.itEndPattern = itEndPattern;
+    const char* const opLessAllowed = node->Attribute("opLessAllowed");
+    if (opLessAllowed)
+        container.opLessAllowed = std::string(opLessAllowed) == "true";
+
+    for (const tinyxml2::XMLElement *containerNode = node->FirstChildElement(); containerNode; containerNode = containerNode->NextSiblingElement()) {
+        const std::string containerNodeName = containerNode->Name();
+        if (containerNodeName == "size" || containerNodeName == "access" || containerNodeName == "other") {
+            for (const tinyxml2::XMLElement *functionNode = containerNode->FirstChildElement(); functionNode; functionNode = functionNode->NextSiblingElement()) {
+                if (std::string(functionNode->Name()) != "function") {
+                    unknown_elements.insert(functionNode->Name());
+                    continue;
+                }
+
+                const char* const functionName = functionNode->Attribute("name");
+                if (!functionName)
+                    return Error(MISSING_ATTRIBUTE, "name");
+
+                const char* const action_ptr = functionNode->Attribute("action");
+                Container::Action action = Container::NO_ACTION;
+                if (action_ptr) {
+                    std::string actionName = action_ptr;
+                    if (actionName == "resize")
+                        action = Container::RESIZE;
+                    else if (actionName == "clear")
+                        action = Container::CLEAR;
+                    else if (actionName == "push")
+                        action = Container::PUSH;
+                    else if (actionName == "pop")
+                        action = Container::POP;
+                    else if (actionName == "find")
+                        action = Container::FIND;
+                    else if (actionName == "insert")
+                        action = Container::INSERT;
+                    else if (actionName == "erase")
+                        action = Container::ERASE;
+                    else if (actionName == "change-content")
+                        action = Container::CHANGE_CONTENT;
+                    else if (actionName == "change-internal")
+                        action = Container::CHANGE_INTERNAL;
+                    else if (actionName == "change")
+                        action = Container::CHANGE;
+                    else
+                        return Error(BAD_ATTRIBUTE_VALUE, actionName);
+                }
+
+                const char* const yield_ptr = functionNode->Attribute("yields");
+                Container::Yield yield = Container::NO_YIELD;
+                if (yield_ptr) {
+                    std::string yieldName = yield_ptr;
+                    if (yieldName == "at_index")
+                        yield = Container::AT_INDEX;
+                    else if (yieldName == "item")
+                        yield = Container::ITEM;
+                    else if (yieldName == "buffer")
+                        yield = Container::BUFFER;
+                    else if (yieldName == "buffer-nt")
+                        yield = Container::BUFFER_NT;
+                    else if (yieldName == "start-iterator")
+                        yield = Container::START_ITERATOR;
+                    else if (yieldName == "end-iterator")
+                        yield = Container::END_ITERATOR;
+                    else if (yieldName == "iterator")
+                        yield = Container::ITERATOR;
+                    else if (yieldName == "size")
+                        yield = Container::SIZE;
+                    else if (yieldName == "empty")
+                        yield = Container::EMPTY;
+                    else
+                        return Error(BAD_ATTRIBUTE_VALUE, yieldName);
+                }
+
+                container.functions[functionName].action = action;
+                container.functions[functionName].yield = yield;
+            }
+
+            if (containerNodeName == "size") {
+                const char* const templateArg = containerNode->Attribute("templateParameter");
+                if (templateArg)
+                    container.size_templateArgNo = atoi(templateArg);
+            } else if (containerNodeName == "access") {
+                const char* const indexArg = containerNode->Attribute("indexOperator");
+                if (indexArg)
+                    container.arrayLike_indexOp = std::string(indexArg) == "array-like";
+            }
+        } else if (containerNodeName == "type") {
+            const char* const templateArg = containerNode->Attribute("templateParameter");
+            if (templateArg)
+                container.type_templateArgNo = atoi(templateArg);
+
+            const char* const string = containerNode->Attribute("string");
+            if (string)
+                container.stdStringLike = std::string(string) == "std-like";
+        } else
+            unknown_elements.insert(containerNodeName);
+    }
+    return Error(OK);
+}
+
+void Library::loadDeferredSections(std::list<std::string> &sections) const
+{
+    // Casting the constness away is ok: parsing a deferred section does not
+    // change what the library contains, only when the tables are built.
+    Library * const lib = const_cast<Library *>(this);
+    std::set<std::string> unknown_elements;
+    for (const std::string &xmldata : sections) {
+        tinyxml2::XMLDocument doc;
+        if (doc.Parse(xmldata.c_str(), xmldata.size()) != tinyxml2::XML_SUCCESS)
+            continue;
+        const tinyxml2::XMLElement * const node = doc.FirstChildElement();
+        if (!node)
+            continue;
+        // Missing mandatory attributes were rejected when the section was
+        // deferred; other errors cannot be reported from here and the
+        // entries that have them are ignored.
+        if (strcmp(node->Name(), "container") == 0)
+            lib->loadContainer(node, unknown_elements);
+        else if (strcmp(node->Name(), "markup") == 0)
+            lib->loadMarkup(node, unknown_elements);
+    }
+    sections.clear();
+}
+
 bool Library::isIntArgValid(const Token *ftok, int argnr, const MathLib::bigint argvalue) const
 {
     const ArgumentChecks *ac = getarg(ftok, argnr);
@@ -843,7 +963,7 @@ bool Library::isnullargbad(const Token *ftok, int argnr) const
     if (!arg) {
         // scan format string argument should not be null
         const std::string funcname = getFunctionName(ftok);
-        const std::map<std::string, Function>::const_iterator it = functions.find(funcname);
+        const std::unordered_map<std::string, Function>::const_iterator it = functions.find(funcname);
         if (it != functions.cend() && it->second.formatstr && it->second.formatstr_scan)
             return true;
     }
@@ -856,7 +976,7 @@ bool Library::isuninitargbad(const Token *ftok, int argnr) const
     if (!arg) {
         // non-scan format string argument should not be uninitialized
         const std::string funcname = getFunctionName(ftok);
-        const std::map<std::string, Function>::const_iterator it = functions.find(funcname);
+        const std::unordered_map<std::string, Function>::const_iterator it = functions.find(funcname);
         if (it != functions.cend() && it->second.formatstr && !it->second.formatstr_scan)
             return true;
     }
@@ -868,14 +988,14 @@ bool Library::isuninitargbad(const Token *ftok, int argnr) const
 const Library::AllocFunc* Library::alloc(const Token *tok) const
 {
     const std::string funcname = getFunctionName(tok);
-    return isNotLibraryFunction(tok) && functions.find(funcname) != functions.end() ? nullptr : getAllocDealloc(mAlloc, funcname);
+    return isNotLibraryFunction(tok, funcname) && functions.find(funcname) != functions.end() ? nullptr : getAllocDealloc(mAlloc, funcname);
 }
 
 /** get deallocation info for function */
 const Library::AllocFunc* Library::dealloc(const Token *tok) const
 {
     const std::string funcname = getFunctionName(tok);
-    return isNotLibraryFunction(tok) && functions.find(funcname) != functions.end() ? nullptr : getAllocDealloc(mDealloc, funcname);
+    return isNotLibraryFunction(tok, funcname) && functions.find(funcname) != functions.end() ? nullptr : getAllocDealloc(mDealloc, funcname);
 }
 
 /** get allocation id for function */
@@ -892,19 +1012,39 @@ int Library::dealloc(const Token *tok, int arg) const
     return (af && af->arg == arg) ? af->groupId : 0;
 }
 
+bool Library::annotate(const Token *ftok, Annotation *annotation) const
+{
+    const std::string funcname = getFunctionName(ftok);
+    if (funcname.empty())
+        return false;
+    const bool notLibraryFunction = isNotLibraryFunction(ftok, funcname);
+    const std::unordered_map<std::string, Function>::const_iterator it = functions.find(funcname);
+    const bool inFunctions = (it != functions.cend());
+    annotation->function = (!notLibraryFunction && inFunctions) ? &it->second : nullptr;
+    // alloc()/dealloc() answer even when the arguments don't match, as long
+    // as the functions table has no entry for the name
+    annotation->allocFunc = (notLibraryFunction && inFunctions) ? nullptr : getAllocDealloc(mAlloc, funcname);
+    annotation->deallocFunc = (notLibraryFunction && inFunctions) ? nullptr : getAllocDealloc(mDealloc, funcname);
+    annotation->noreturn = -1;
+    if (!notLibraryFunction) {
+        const std::unordered_map<std::string, bool>::const_iterator nr = mNoReturn.find(funcname);
+        if (nr != mNoReturn.end())
+            annotation->noreturn = nr->second ? 1 : 0;
+    }
+    return annotation->function || annotation->allocFunc || annotation->deallocFunc || annotation->noreturn != -1;
+}
+
 
 const Library::ArgumentChecks * Library::getarg(const Token *ftok, int argnr) const
 {
-    if (isNotLibraryFunction(ftok))
-        return nullptr;
-    const std::map<std::string, Function>::const_iterator it1 = functions.find(getFunctionName(ftok));
-    if (it1 == functions.cend())
+    const Function *func = getFunction(ftok);
+    if (!func)
         return nullptr;
-    const std::map<int,ArgumentChecks>::const_iterator it2 = it1->second.argumentChecks.find(argnr);
-    if (it2 != it1->second.argumentChecks.cend())
+    const std::map<int,ArgumentChecks>::const_iterator it2 = func->argumentChecks.find(argnr);
+    if (it2 != func->argumentChecks.cend())
         return &it2->second;
-    const std::map<int,ArgumentChecks>::const_iterator it3 = it1->second.argumentChecks.find(-1);
-    if (it3 != it1->second.argumentChecks.cend())
+    const std::map<int,ArgumentChecks>::const_iterator it3 = func->argumentChecks.find(-1);
+    if (it3 != func->argumentChecks.cend())
         return &it3->second;
     return nullptr;
 }
@@ -950,6 +1090,8 @@ bool Library::isScopeNoReturn(const Token *end, std::string *unknownFunc) const
 
 const Library::Container* Library::detectContainer(const Token* typeStart, bool iterator) const
 {
+    if (!mDeferredContainers.empty())
+        loadDeferredSections(mDeferredContainers);
     for (std::map<std::string, Container>::const_iterator i = containers.begin(); i != containers.end(); ++i) {
         const Container& container = i->second;
         if (container.startPattern.empty())
@@ -1008,15 +1150,49 @@ bool Library::isNotLibraryFunction(const Token *ftok) const
     return !matchArguments(ftok, getFunctionName(ftok));
 }
 
+bool Library::isNotLibraryFunction(const Token *ftok, const std::string &funcname) const
+{
+    if (ftok->function() && ftok->function()->nestedIn && ftok->function()->nestedIn->type != Scope::eGlobal)
+        return true;
+
+    // variables are not library functions.
+    if (ftok->varId())
+        return true;
+
+    return !matchArguments(ftok, funcname);
+}
+
+const Library::Function *Library::getFunction(const Token *ftok) const
+{
+    if (ftok->function() && ftok->function()->nestedIn && ftok->function()->nestedIn->type != Scope::eGlobal)
+        return nullptr;
+
+    // variables are not library functions.
+    if (ftok->varId())
+        return nullptr;
+
+    const std::unordered_map<std::string, Function>::const_iterator it = functions.find(getFunctionName(ftok));
+    if (it == functions.cend())
+        return nullptr;
+    if (!matchArguments(ftok, it->second))
+        return nullptr;
+    return &it->second;
+}
+
 bool Library::matchArguments(const Token *ftok, const std::string &functionName) const
 {
-    const int callargs = numberOfArguments(ftok);
-    const std::map<std::string, Function>::const_iterator it = functions.find(functionName);
+    const std::unordered_map<std::string, Function>::const_iterator it = functions.find(functionName);
     if (it == functions.cend())
-        return (callargs == 0);
+        return (numberOfArguments(ftok) == 0);
+    return matchArguments(ftok, it->second);
+}
+
+bool Library::matchArguments(const Token *ftok, const Function &func) const
+{
+    const int callargs = numberOfArguments(ftok);
     int args = 0;
     int firstOptionalArg = -1;
-    for (std::map<int, ArgumentChecks>::const_iterator it2 = it->second.argumentChecks.cbegin(); it2 != it->second.argumentChecks.cend(); ++it2) {
+    for (std::map<int, ArgumentChecks>::const_iterator it2 = func.argumentChecks.cbegin(); it2 != func.argumentChecks.cend(); ++it2) {
         if (it2->first > args)
             args = it2->first;
         if (it2->second.optional && (firstOptionalArg == -1 || firstOptionalArg > it2->first))
@@ -1040,13 +1216,8 @@ const Library::WarnInfo* Library::getWarnInfo(const Token* ftok) const
 
 bool Library::formatstr_function(const Token* ftok) const
 {
-    if (isNotLibraryFunction(ftok))
-        return false;
-
-    const std::map<std::string, Function>::const_iterator it = functions.find(getFunctionName(ftok));
-    if (it != functions.cend())
-        return it->second.formatstr;
-    return false;
+    const Function *func = getFunction(ftok);
+    return func && func->formatstr;
 }
 
 int Library::formatstr_argno(const Token* ftok) const
@@ -1072,41 +1243,40 @@ bool Library::formatstr_secure(const Token* ftok) const
 
 bool Library::isUseRetVal(const Token* ftok) const
 {
-    if (isNotLibraryFunction(ftok))
-        return false;
-    const std::map<std::string, Function>::const_iterator it = functions.find(getFunctionName(ftok));
-    if (it != functions.cend())
-        return it->second.useretval;
-    return false;
+    const Function *func = getFunction(ftok);
+    return func && func->useretval;
 }
 
 const std::string& Library::returnValue(const Token *ftok) const
 {
-    if (isNotLibraryFunction(ftok))
+    const std::string funcname = getFunctionName(ftok);
+    if (isNotLibraryFunction(ftok, funcname))
         return emptyString;
-    const std::map<std::string, std::string>::const_iterator it = mReturnValue.find(getFunctionName(ftok));
+    const std::unordered_map<std::string, std::string>::const_iterator it = mReturnValue.find(funcname);
     return it != mReturnValue.end() ? it->second : emptyString;
 }
 
 const std::string& Library::returnValueType(const Token *ftok) const
 {
-    if (isNotLibraryFunction(ftok))
+    const std::string funcname = getFunctionName(ftok);
+    if (isNotLibraryFunction(ftok, funcname))
         return emptyString;
-    const std::map<std::string, std::string>::const_iterator it = mReturnValueType.find(getFunctionName(ftok));
+    const std::unordered_map<std::string, std::string>::const_iterator it = mReturnValueType.find(funcname);
     return it != mReturnValueType.end() ? it->second : emptyString;
 }
 
 int Library::returnValueContainer(const Token *ftok) const
 {
-    if (isNotLibraryFunction(ftok))
+    const std::string funcname = getFunctionName(ftok);
+    if (isNotLibraryFunction(ftok, funcname))
         return -1;
-    const std::map<std::string, int>::const_iterator it = mReturnValueContainer.find(getFunctionName(ftok));
+    const std::unordered_map<std::string, int>::const_iterator it = mReturnValueContainer.find(funcname);
     return it != mReturnValueContainer.end() ? it->second : -1;
 }
 
 bool Library::hasminsize(const std::string &functionName) const
 {
-    const std::map<std::string, Function>::const_iterator it1 = functions.find(functionName);
+    const std::unordered_map<std::string, Function>::const_iterator it1 = functions.find(functionName);
     if (it1 == functions.cend())
         return false;
     for (std::map<int, ArgumentChecks>::const_iterator it2 = it1->second.argumentChecks.cbegin(); it2 != it1->second.argumentChecks.cend(); ++it2) {
@@ -1118,28 +1288,28 @@ bool Library::hasminsize(const std::string &functionName) const
 
 bool Library::ignorefunction(const std::string& functionName) const
 {
-    const std::map<std::string, Function>::const_iterator it = functions.find(functionName);
+    const std::unordered_map<std::string, Function>::const_iterator it = functions.find(functionName);
     if (it != functions.cend())
         return it->second.ignore;
     return false;
 }
 bool Library::isUse(const std::string& functionName) const
 {
-    const std::map<std::string, Function>::const_iterator it = functions.find(functionName);
+    const std::unordered_map<std::string, Function>::const_iterator it = functions.find(functionName);
     if (it != functions.cend())
         return it->second.use;
     return false;
 }
 bool Library::isLeakIgnore(const std::string& functionName) const
 {
-    const  std::map<std::string, Function>::const_iterator it = functions.find(functionName);
+    const std::unordered_map<std::string, Function>::const_iterator it = functions.find(functionName);
     if (it != functions.cend())
         return it->second.leakignore;
     return false;
 }
 bool Library::isFunctionConst(const std::string& functionName, bool pure) const
 {
-    const std::map<std::string, Function>::const_iterator it = functions.find(functionName);
+    const std::unordered_map<std::string, Function>::const_iterator it = functions.find(functionName);
     if (it != functions.cend())
         return pure ? it->second.ispure : it->second.isconst;
     return false;
@@ -1148,18 +1318,17 @@ bool Library::isFunctionConst(const Token *ftok) const
 {
     if (ftok->function() && ftok->function()->isAttributeConst())
         return true;
-    if (isNotLibraryFunction(ftok))
-        return false;
-    const std::map<std::string, Function>::const_iterator it = functions.find(getFunctionName(ftok));
-    return (it != functions.end() && it->second.isconst);
+    const Function *func = getFunction(ftok);
+    return func && func->isconst;
 }
 bool Library::isnoreturn(const Token *ftok) const
 {
     if (ftok->function() && ftok->function()->isAttributeNoreturn())
         return true;
-    if (isNotLibraryFunction(ftok))
+    const std::string funcname = getFunctionName(ftok);
+    if (isNotLibraryFunction(ftok, funcname))
         return false;
-    const std::map<std::string, bool>::const_iterator it = mNoReturn.find(getFunctionName(ftok));
+    const std::unordered_map<std::string, bool>::const_iterator it = mNoReturn.find(funcname);
     return (it != mNoReturn.end() && it->second);
 }
 
@@ -1167,9 +1336,10 @@ bool Library::isnotnoreturn(const Token *ftok) const
 {
     if (ftok->function() && ftok->function()->isAttributeNoreturn())
         return false;
-    if (isNotLibraryFunction(ftok))
+    const std::string funcname = getFunctionName(ftok);
+    if (isNotLibraryFunction(ftok, funcname))
         return false;
-    const std::map<std::string, bool>::const_iterator it = mNoReturn.find(getFunctionName(ftok));
+    const std::unordered_map<std::string, bool>::const_iterator it = mNoReturn.find(funcname);
     return (it != mNoReturn.end() && !it->second);
 }
 
@@ -1180,66 +1350,41 @@ bool Library::markupFile(const std::string &path) const
 
 bool Library::processMarkupAfterCode(const std::string &path) const
 {
-    const std::map<std::string, bool>::const_iterator it = mProcessAfterCode.find(Path::getFilenameExtensionInLowerCase(path));
+    const std::unordered_map<std::string, bool>::const_iterator it = mProcessAfterCode.find(Path::getFilenameExtensionInLowerCase(path));
     return (it == mProcessAfterCode.end() || it->second);
 }
 
 bool Library::reportErrors(const std::string &path) const
 {
-    const std::map<std::string, bool>::const_iterator it = mReportErrors.find(Path::getFilenameExtensionInLowerCase(path));
+    const std::unordered_map<std::string, bool>::const_iterator it = mReportErrors.find(Path::getFilenameExtensionInLowerCase(path));
     return (it == mReportErrors.end() || it->second);
 }
 
-bool Library::isexecutableblock(const std::string &file, const std::string &token) const
+const Library::CodeBlock *Library::markupCodeBlocks(const std::string &path) const
 {
-    const std::map<std::string, CodeBlock>::const_iterator it = mExecutableBlocks.find(Path::getFilenameExtensionInLowerCase(file));
-    return (it != mExecutableBlocks.end() && it->second.isBlock(token));
+    if (!mDeferredMarkup.empty())
+        loadDeferredSections(mDeferredMarkup);
+    const std::unordered_map<std::string, CodeBlock>::const_iterator it = mExecutableBlocks.find(Path::getFilenameExtensionInLowerCase(path));
+    return (it != mExecutableBlocks.end()) ? &it->second : nullptr;
 }
 
-int Library::blockstartoffset(const std::string &file) const
+const std::unordered_set<std::string> *Library::markupKeywords(const std::string &path) const
 {
-    int offset = -1;
-    const std::map<std::string, CodeBlock>::const_iterator map_it
-        = mExecutableBlocks.find(Path::getFilenameExtensionInLowerCase(file));
-
-    if (map_it != mExecutableBlocks.end()) {
-        offset = map_it->second.offset();
-    }
-    return offset;
+    if (!mDeferredMarkup.empty())
+        loadDeferredSections(mDeferredMarkup);
+    const std::unordered_map<std::string, std::unordered_set<std::string> >::const_iterator it = mKeywords.find(Path::getFilenameExtensionInLowerCase(path));
+    return (it != mKeywords.end()) ? &it->second : nullptr;
 }
 
-const std::string& Library::blockstart(const std::string &file) const
+const std::unordered_set<std::string> *Library::markupImporters(const std::string &path) const
 {
-    const std::map<std::string, CodeBlock>::const_iterator map_it
-        = mExecutableBlocks.find(Path::getFilenameExtensionInLowerCase(file));
-
-    if (map_it != mExecutableBlocks.end()) {
-        return map_it->second.start();
-    }
-    return emptyString;
+    if (!mDeferredMarkup.empty())
+        loadDeferredSections(mDeferredMarkup);
+    const std::unordered_map<std::string, std::unordered_set<std::string> >::const_iterator it = mImporters.find(Path::getFilenameExtensionInLowerCase(path));
+    return (it != mImporters.end()) ? &it->second : nullptr;
 }
 
-const std::string& Library::blockend(const std::string &file) const
-{
-    const std::map<std::string, CodeBlock>::const_iterator map_it
-        = mExecutableBlocks.find(Path::getFilenameExtensionInLowerCase(file));
 
-    if (map_it != mExecutableBlocks.end()) {
-        return map_it->second.end();
-    }
-    return emptyString;
-}
 
-bool Library::iskeyword(const std::string &file, const std::string &keyword) const
-{
-    const std::map<std::string, std::set<std::string> >::const_iterator it =
-        mKeywords.find(Path::getFilenameExtensionInLowerCase(file));
-    return (it != mKeywords.end() && it->second.count(keyword));
-}
 
-bool Library::isimporter(const std::string& file, const std::string &importer) const
-{
-    const std::map<std::string, std::set<std::string> >::const_iterator it =
-        mImporters.find(Path::getFilenameExtensionInLowerCase(file));
-    return (it != mImporters.end() && it->second.count(importer) > 0);
-}
+
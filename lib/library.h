@@ -27,9 +27,12 @@
 #include "standards.h"
 
 #include <cstddef>
+#include <list>
 #include <map>
 #include <set>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -70,6 +73,13 @@ public:
     /** this is primarily meant for unit tests. it only returns true/false */
     bool loadxmldata(const char xmldata[], std::size_t len);
 
+    /**
+     * Register a library configuration that is embedded into the binary at
+     * build time (see tools/embedcfg.py). load() uses it when the named
+     * configuration is not overridden by a file.
+     */
+    static void embed(const char name[], const char xmldata[], std::size_t len);
+
     struct AllocFunc {
         int groupId;
         int arg;
@@ -276,7 +286,35 @@ public:
         Function() : use(false), leakignore(false), isconst(false), ispure(false), useretval(false), ignore(false), formatstr(false), formatstr_scan(false), formatstr_secure(false) {}
     };
 
-    std::map<std::string, Function> functions;
+    std::unordered_map<std::string, Function> functions;
+
+    /**
+     * Get the function entry for a function call token, or nullptr if it is
+     * not a library function. The function name is built and looked up only
+     * once, so prefer this over isNotLibraryFunction() followed by a second
+     * lookup on hot paths.
+     */
+    const Function *getFunction(const Token *ftok) const;
+
+    /**
+     * All library annotations for one function call token. Resolved in one
+     * pass by Tokenizer::stampLibraryAnnotations() so checks that query the
+     * same token repeatedly do not repeat the name lookup, see annotate().
+     */
+    struct Annotation {
+        const Function *function;
+        const AllocFunc *allocFunc;
+        const AllocFunc *deallocFunc;
+        char noreturn; // 1=noreturn, 0=not noreturn, -1=unknown
+    };
+
+    /**
+     * Resolve the annotations for a function call token. The results match
+     * getFunction(), alloc(), dealloc(), isnoreturn() and isnotnoreturn()
+     * for the same token. Returns false if there is nothing to record.
+     */
+    bool annotate(const Token *ftok, Annotation *annotation) const;
+
     bool isUse(const std::string& functionName) const;
     bool isLeakIgnore(const std::string& functionName) const;
     bool isFunctionConst(const std::string& functionName, bool pure) const;
@@ -332,37 +370,77 @@ public:
 
     bool ignorefunction(const std::string &functionName) const;
 
-    bool isexecutableblock(const std::string &file, const std::string &token) const;
+    class CodeBlock {
+    public:
+        CodeBlock() : mOffset(0) {}
 
-    int blockstartoffset(const std::string &file) const;
+        void setStart(const char* s) {
+            mStart = s;
+        }
+        void setEnd(const char* e) {
+            mEnd = e;
+        }
+        void setOffset(const int o) {
+            mOffset = o;
+        }
+        void addBlock(const char* blockName) {
+            mBlocks.insert(blockName);
+        }
+        const std::string& start() const {
+            return mStart;
+        }
+        const std::string& end() const {
+            return mEnd;
+        }
+        int offset() const {
+            return mOffset;
+        }
+        bool isBlock(const std::string& blockName) const {
+            return mBlocks.find(blockName) != mBlocks.end();
+        }
 
-    const std::string& blockstart(const std::string &file) const;
-    const std::string& blockend(const std::string &file) const;
+    private:
+        std::string mStart;
+        std::string mEnd;
+        int mOffset;
+        std::unordered_set<std::string> mBlocks;
+    };
 
-    bool iskeyword(const std::string &file, const std::string &keyword) const;
+    /** executable code blocks for a markup file, or nullptr if it has none */
+    const CodeBlock *markupCodeBlocks(const std::string &path) const;
+
+    /** keywords to skip when scanning a markup file, or nullptr if it has none */
+    const std::unordered_set<std::string> *markupKeywords(const std::string &path) const;
+
+    /** import keywords for a markup file, or nullptr if it has none */
+    const std::unordered_set<std::string> *markupImporters(const std::string &path) const;
 
     bool isexporter(const std::string &prefix) const {
+        if (!mDeferredMarkup.empty())
+            loadDeferredSections(mDeferredMarkup);
         return mExporters.find(prefix) != mExporters.end();
     }
 
     bool isexportedprefix(const std::string &prefix, const std::string &token) const {
-        const std::map<std::string, ExportedFunctions>::const_iterator it = mExporters.find(prefix);
+        if (!mDeferredMarkup.empty())
+            loadDeferredSections(mDeferredMarkup);
+        const std::unordered_map<std::string, ExportedFunctions>::const_iterator it = mExporters.find(prefix);
         return (it != mExporters.end() && it->second.isPrefix(token));
     }
 
     bool isexportedsuffix(const std::string &prefix, const std::string &token) const {
-        const std::map<std::string, ExportedFunctions>::const_iterator it = mExporters.find(prefix);
+        if (!mDeferredMarkup.empty())
+            loadDeferredSections(mDeferredMarkup);
+        const std::unordered_map<std::string, ExportedFunctions>::const_iterator it = mExporters.find(prefix);
         return (it != mExporters.end() && it->second.isSuffix(token));
     }
 
-    bool isimporter(const std::string& file, const std::string &importer) const;
-
     bool isreflection(const std::string &token) const {
         return mReflection.find(token) != mReflection.end();
     }
 
     int reflectionArgument(const std::string &token) const {
-        const std::map<std::string, int>::const_iterator it = mReflection.find(token);
+        const std::unordered_map<std::string, int>::const_iterator it = mReflection.find(token);
         if (it != mReflection.end())
             return it->second;
         return -1;
@@ -438,9 +516,30 @@ public:
     static bool isContainerYield(const Token * const cond, Library::Container::Yield y, const std::string& fallback="");
 
 private:
+    // load all nodes of a parsed configuration file
+    Error load(const tinyxml2::XMLDocument &doc, bool deferSections);
+
     // load a <function> xml node
     Error loadFunction(const tinyxml2::XMLElement * const node, const std::string &name, std::set<std::string> &unknown_elements);
 
+    // load a <markup> xml node
+    Error loadMarkup(const tinyxml2::XMLElement * const node, std::set<std::string> &unknown_elements);
+
+    // load a <container> xml node
+    Error loadContainer(const tinyxml2::XMLElement * const node, std::set<std::string> &unknown_elements);
+
+    /**
+     * XML text of sections that are parsed when they are first queried
+     * instead of at load time, so configurations loaded from files only
+     * materialize the container and markup tables when the analysis uses
+     * them. @sa loadDeferredSections
+     */
+    mutable std::list<std::string> mDeferredContainers;
+    mutable std::list<std::string> mDeferredMarkup;
+
+    /** parse deferred section XML and clear the given list */
+    void loadDeferredSections(std::list<std::string> &sections) const;
+
     class ExportedFunctions {
     public:
         void addPrefix(const std::string& prefix) {
@@ -457,66 +556,34 @@ private:
         }
 
     private:
-        std::set<std::string> mPrefixes;
-        std::set<std::string> mSuffixes;
-    };
-    class CodeBlock {
-    public:
-        CodeBlock() : mOffset(0) {}
-
-        void setStart(const char* s) {
-            mStart = s;
-        }
-        void setEnd(const char* e) {
-            mEnd = e;
-        }
-        void setOffset(const int o) {
-            mOffset = o;
-        }
-        void addBlock(const char* blockName) {
-            mBlocks.insert(blockName);
-        }
-        const std::string& start() const {
-            return mStart;
-        }
-        const std::string& end() const {
-            return mEnd;
-        }
-        int offset() const {
-            return mOffset;
-        }
-        bool isBlock(const std::string& blockName) const {
-            return mBlocks.find(blockName) != mBlocks.end();
-        }
-
-    private:
-        std::string mStart;
-        std::string mEnd;
-        int mOffset;
-        std::set<std::string> mBlocks;
+        std::unordered_set<std::string> mPrefixes;
+        std::unordered_set<std::string> mSuffixes;
     };
     int mAllocId;
     std::set<std::string> mFiles;
     std::map<std::string, AllocFunc> mAlloc; // allocation functions
     std::map<std::string, AllocFunc> mDealloc; // deallocation functions
-    std::map<std::string, bool> mNoReturn; // is function noreturn?
-    std::map<std::string, std::string> mReturnValue;
-    std::map<std::string, std::string> mReturnValueType;
-    std::map<std::string, int> mReturnValueContainer;
-    std::map<std::string, bool> mReportErrors;
-    std::map<std::string, bool> mProcessAfterCode;
+    std::unordered_map<std::string, bool> mNoReturn; // is function noreturn?
+    std::unordered_map<std::string, std::string> mReturnValue;
+    std::unordered_map<std::string, std::string> mReturnValueType;
+    std::unordered_map<std::string, int> mReturnValueContainer;
+    std::unordered_map<std::string, bool> mReportErrors;
+    std::unordered_map<std::string, bool> mProcessAfterCode;
     std::set<std::string> mMarkupExtensions; // file extensions of markup files
-    std::map<std::string, std::set<std::string> > mKeywords; // keywords for code in the library
-    std::map<std::string, CodeBlock> mExecutableBlocks; // keywords for blocks of executable code
-    std::map<std::string, ExportedFunctions> mExporters; // keywords that export variables/functions to libraries (meta-code/macros)
-    std::map<std::string, std::set<std::string> > mImporters; // keywords that import variables/functions
-    std::map<std::string, int> mReflection; // invocation of reflection
+    std::unordered_map<std::string, std::unordered_set<std::string> > mKeywords; // keywords for code in the library
+    std::unordered_map<std::string, CodeBlock> mExecutableBlocks; // keywords for blocks of executable code
+    std::unordered_map<std::string, ExportedFunctions> mExporters; // keywords that export variables/functions to libraries (meta-code/macros)
+    std::unordered_map<std::string, std::unordered_set<std::string> > mImporters; // keywords that import variables/functions
+    std::unordered_map<std::string, int> mReflection; // invocation of reflection
     std::map<std::string, struct PodType> mPodTypes; // pod types
     std::map<std::string, PlatformType> mPlatformTypes; // platform independent typedefs
     std::map<std::string, Platform> mPlatforms; // platform dependent typedefs
 
     const ArgumentChecks * getarg(const Token *ftok, int argnr) const;
 
+    bool isNotLibraryFunction(const Token *ftok, const std::string &funcname) const;
+    bool matchArguments(const Token *ftok, const Function &func) const;
+
     std::string getFunctionName(const Token *ftok, bool *error) const;
 
     static const AllocFunc* getAllocDealloc(const std::map<std::string, AllocFunc> &data, const std::string &name) {
@@ -20,7 +20,11 @@
 #ifndef matchcompilerH
 #define matchcompilerH
 
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
 #include <string>
+#include <vector>
 
 namespace MatchCompiler {
 
@@ -69,6 +73,102 @@ namespace MatchCompiler {
     {
         return ConstString<n>(s);
     }
+
+    /**
+     * Counters of one compiled match site, used by the profiling mode of
+     * tools/matchcompiler.py ('make SRCDIR=build MATCH_PROFILE=yes').
+     *
+     * Each generated match/findmatch function owns one file scope
+     * instance. When the program exits, the counters are dumped to
+     * matchprofile.txt, one tab separated line per pattern:
+     *     calls <tab> matches <tab> branch hits <tab> pattern
+     * where the branch hits are the comma separated hit counts of the
+     * a|b|c alternatives, in pattern order, or '-' if the pattern has
+     * none. Feed the dump back with
+     * 'python tools/matchcompiler.py --frequency-file=matchprofile.txt'
+     * to reorder the alternatives by the observed frequencies.
+     *
+     * The increments are deliberately not synchronised; a profiling
+     * build is not for production use and counts lost to races do not
+     * change the ordering decisions. Note that the workers of a
+     * parallel run overwrite each other's dump, so profile with -j1.
+     */
+    class PatternProfile {
+    public:
+        PatternProfile(const char pattern[], unsigned int branchCount)
+            : mPattern(pattern)
+            , mBranchCount(branchCount)
+            , mCalls(0)
+            , mMatches(0)
+            , mNext(listHead()) {
+            for (unsigned int i = 0; i < MaxBranches; ++i)
+                mBranchHits[i] = 0;
+            listHead() = this;
+            if (!mNext)
+                std::atexit(dumpAll);
+        }
+
+        /** count one invocation of the match site */
+        bool hit(bool matched) {
+            ++mCalls;
+            if (matched)
+                ++mMatches;
+            return matched;
+        }
+
+        /** count one taken a|b|c alternative; wraps the compiled
+         * condition so the short-circuit evaluation is kept */
+        bool branch(unsigned int index, bool matched) {
+            if (matched && index < MaxBranches)
+                ++mBranchHits[index];
+            return matched;
+        }
+
+    private:
+        // an enum so no out-of-class definition is needed
+        enum : unsigned int { MaxBranches = 64 };
+
+        const char * const mPattern;
+        const unsigned int mBranchCount;
+        unsigned long long mCalls;
+        unsigned long long mMatches;
+        unsigned long long mBranchHits[MaxBranches];
+
+        /** the profiles register themselves in a list, a function local
+         * static so no translation unit is needed for the head */
+        static PatternProfile *&listHead() {
+            static PatternProfile *head = nullptr;
+            return head;
+        }
+
+        static bool moreCalls(const PatternProfile *p1, const PatternProfile *p2) {
+            return p1->mCalls > p2->mCalls;
+        }
+
+        static void dumpAll() {
+            std::vector<const PatternProfile *> profiles;
+            for (const PatternProfile *p = listHead(); p; p = p->mNext)
+                profiles.push_back(p);
+            std::sort(profiles.begin(), profiles.end(), moreCalls);
+            std::FILE * const f = std::fopen("matchprofile.txt", "wt");
+            if (!f)
+                return;
+            for (const PatternProfile *p : profiles) {
+                std::fprintf(f, "%llu\t%llu\t", p->mCalls, p->mMatches);
+                if (p->mBranchCount == 0)
+                    std::fputc('-', f);
+                else {
+                    const unsigned int n = std::min(p->mBranchCount, (unsigned int)MaxBranches);
+                    for (unsigned int i = 0; i < n; ++i)
+                        std::fprintf(f, "%s%llu", (i == 0) ? "" : ",", p->mBranchHits[i]);
+                }
+                std::fprintf(f, "\t%s\n", p->mPattern);
+            }
+            std::fclose(f);
+        }
+
+        PatternProfile * const mNext;
+    };
 }
 
 #endif // matchcompilerH
@@ -293,27 +293,12 @@ MathLib::value MathLib::value::shiftRight(const MathLib::value &v) const
 MathLib::biguint MathLib::toULongNumber(const std::string & str)
 {
     // hexadecimal numbers:
-    if (isIntHex(str)) {
-        if (str[0] == '-') {
-            biguint ret = 0;
-            std::istringstream istr(str);
-            istr >> std::hex >> ret;
-            return ret;
-        } else {
-            unsigned long long ret = 0;
-            std::istringstream istr(str);
-            istr >> std::hex >> ret;
-            return (biguint)ret;
-        }
-    }
+    if (isIntHex(str))
+        return (biguint)std::strtoull(str.c_str(), nullptr, 16);
 
     // octal numbers:
-    if (isOct(str)) {
-        biguint ret = 0;
-        std::istringstream istr(str);
-        istr >> std::oct >> ret;
-        return ret;
-    }
+    if (isOct(str))
+        return (biguint)std::strtoull(str.c_str(), nullptr, 8);
 
     // binary numbers:
     if (isBin(str)) {
@@ -338,10 +323,7 @@ MathLib::biguint MathLib::toULongNumber(const std::string & str)
             return static_cast<biguint>(doubleval);
     }
 
-    biguint ret = 0;
-    std::istringstream istr(str);
-    istr >> ret;
-    return ret;
+    return (biguint)std::strtoull(str.c_str(), nullptr, 10);
 }
 
 static unsigned int encodeMultiChar(const std::string& str)
@@ -485,26 +467,14 @@ MathLib::bigint MathLib::toLongNumber(const std::string & str)
 {
     // hexadecimal numbers:
     if (isIntHex(str)) {
-        if (str[0] == '-') {
-            bigint ret = 0;
-            std::istringstream istr(str);
-            istr >> std::hex >> ret;
-            return ret;
-        } else {
-            unsigned long long ret = 0;
-            std::istringstream istr(str);
-            istr >> std::hex >> ret;
-            return (bigint)ret;
-        }
+        if (str[0] == '-')
+            return (bigint)std::strtoll(str.c_str(), nullptr, 16);
+        return (bigint)std::strtoull(str.c_str(), nullptr, 16);
     }
 
     // octal numbers:
-    if (isOct(str)) {
-        bigint ret = 0;
-        std::istringstream istr(str);
-        istr >> std::oct >> ret;
-        return ret;
-    }
+    if (isOct(str))
+        return (bigint)std::strtoll(str.c_str(), nullptr, 8);
 
     // binary numbers:
     if (isBin(str)) {
@@ -535,17 +505,10 @@ MathLib::bigint MathLib::toLongNumber(const std::string & str)
         return characterLiteralToLongNumber(str.substr(1,str.size()-2));
     }
 
-    if (str[0] == '-') {
-        bigint ret = 0;
-        std::istringstream istr(str);
-        istr >> ret;
-        return ret;
-    }
+    if (str[0] == '-')
+        return (bigint)std::strtoll(str.c_str(), nullptr, 10);
 
-    biguint ret = 0;
-    std::istringstream istr(str);
-    istr >> ret;
-    return ret;
+    return (bigint)std::strtoull(str.c_str(), nullptr, 10);
 }
 
 // in-place conversion of (sub)string to double. Requires no heap.
@@ -607,19 +570,11 @@ double MathLib::toDoubleNumber(const std::string &str)
     // nullcheck
     if (isNullValue(str))
         return 0.0;
-#ifdef __clang__
-    if (isFloat(str)) // Workaround libc++ bug at http://llvm.org/bugs/show_bug.cgi?id=17782
-        // TODO : handle locale
-        return std::strtod(str.c_str(), nullptr);
-#endif
     if (isFloatHex(str))
         return FloatHexToDoubleNumber(str);
-    // otherwise, convert to double
-    std::istringstream istr(str);
-    istr.imbue(std::locale::classic());
-    double ret;
-    istr >> ret;
-    return ret;
+    // otherwise, convert to double. The locale is never changed so strtod
+    // parses with the classic "C" locale.
+    return std::strtod(str.c_str(), nullptr);
 }
 
 template<> std::string MathLib::toString(double value)
@@ -1125,13 +1080,29 @@ static std::string intsuffix(const std::string & first, const std::string & seco
     return suffix1.empty() ? suffix2 : suffix1;
 }
 
+// Signed overflow is undefined behavior, so the overflow-prone operations
+// are evaluated with well-defined unsigned wrapping, which yields the
+// two's complement result.
+static MathLib::bigint wrappingAdd(MathLib::bigint a, MathLib::bigint b)
+{
+    return (MathLib::bigint)((MathLib::biguint)a + (MathLib::biguint)b);
+}
+static MathLib::bigint wrappingSub(MathLib::bigint a, MathLib::bigint b)
+{
+    return (MathLib::bigint)((MathLib::biguint)a - (MathLib::biguint)b);
+}
+static MathLib::bigint wrappingMul(MathLib::bigint a, MathLib::bigint b)
+{
+    return (MathLib::bigint)((MathLib::biguint)a * (MathLib::biguint)b);
+}
+
 std::string MathLib::add(const std::string & first, const std::string & second)
 {
 #ifdef TEST_MATHLIB_VALUE
     return (value(first) + value(second)).str();
 #else
     if (MathLib::isInt(first) && MathLib::isInt(second)) {
-        return toString(toLongNumber(first) + toLongNumber(second)) + intsuffix(first, second);
+        return toString(wrappingAdd(toLongNumber(first), toLongNumber(second))) + intsuffix(first, second);
     }
 
     double d1 = toDoubleNumber(first);
@@ -1153,7 +1124,7 @@ std::string MathLib::subtract(const std::string &first, const std::string &secon
     return (value(first) - value(second)).str();
 #else
     if (MathLib::isInt(first) && MathLib::isInt(second)) {
-        return toString(toLongNumber(first) - toLongNumber(second)) + intsuffix(first, second);
+        return toString(wrappingSub(toLongNumber(first), toLongNumber(second))) + intsuffix(first, second);
     }
 
     if (first == second)
@@ -1217,7 +1188,7 @@ std::string MathLib::multiply(const std::string &first, const std::string &secon
     return (value(first) * value(second)).str();
 #else
     if (MathLib::isInt(first) && MathLib::isInt(second)) {
-        return toString(toLongNumber(first) * toLongNumber(second)) + intsuffix(first, second);
+        return toString(wrappingMul(toLongNumber(first), toLongNumber(second))) + intsuffix(first, second);
     }
     return toString(toDoubleNumber(first) * toDoubleNumber(second));
 #endif
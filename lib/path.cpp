@@ -28,6 +28,7 @@
 #include <cstring>
 #include <fstream>
 #include <sstream>
+#include <unordered_map>
 
 #ifndef _WIN32
 #include <unistd.h>
@@ -74,7 +75,31 @@ std::string Path::fromNativeSeparators(std::string path)
 
 std::string Path::simplifyPath(std::string originalPath)
 {
-    return simplecpp::simplifyPath(originalPath);
+    // Most paths are already in canonical form. Detecting that with one
+    // scan is much cheaper than running the simplification, which every
+    // include resolution and error location goes through.
+    bool simple = !originalPath.empty() && originalPath[0] != '.';
+    for (std::size_t i = 0; simple && i < originalPath.size(); ++i) {
+        const char c = originalPath[i];
+        if (c == '\\')
+            simple = false;
+        else if (c == '/' && i + 1 < originalPath.size() && (originalPath[i+1] == '/' || originalPath[i+1] == '.'))
+            simple = false;
+    }
+    if (simple)
+        return originalPath;
+
+    // the same non-canonical paths come back over and over. thread_local
+    // because the Windows executor runs checks in parallel threads.
+    static thread_local std::unordered_map<std::string, std::string> cache;
+    if (cache.size() > 10000)
+        cache.clear();
+    const std::unordered_map<std::string, std::string>::const_iterator it = cache.find(originalPath);
+    if (it != cache.end())
+        return it->second;
+    std::string simplified = simplecpp::simplifyPath(originalPath);
+    cache[originalPath] = simplified;
+    return simplified;
 }
 
 std::string Path::getPathFromFilename(const std::string &filename)
@@ -213,6 +238,15 @@ bool Path::isHeader(const std::string &path)
 
 std::string Path::getAbsoluteFilePath(const std::string& filePath)
 {
+    // cache the system call result; the same relative paths are resolved
+    // repeatedly and the working directory doesn't change during a run
+    static thread_local std::unordered_map<std::string, std::string> cache;
+    if (cache.size() > 10000)
+        cache.clear();
+    const std::unordered_map<std::string, std::string>::const_iterator it = cache.find(filePath);
+    if (it != cache.end())
+        return it->second;
+
     std::string absolute_path;
 #ifdef _WIN32
     char absolute[_MAX_PATH];
@@ -226,6 +260,7 @@ std::string Path::getAbsoluteFilePath(const std::string& filePath)
 #else
 #error Platform absolute path function needed
 #endif
+    cache[filePath] = absolute_path;
     return absolute_path;
 }
 
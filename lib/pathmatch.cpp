@@ -25,13 +25,24 @@
 #include <cctype>
 #include <cstddef>
 
+PathMatch::CompiledMask::CompiledMask(const std::string &mask)
+    : text(mask), innerText("/" + mask), directoryMask(endsWith(mask, '/'))
+{
+}
+
 PathMatch::PathMatch(const std::vector<std::string> &excludedPaths, bool caseSensitive)
-    : mExcludedPaths(excludedPaths), mCaseSensitive(caseSensitive)
+    : mCaseSensitive(caseSensitive)
 {
-    if (!mCaseSensitive)
-        for (std::vector<std::string>::iterator i = mExcludedPaths.begin(); i != mExcludedPaths.end(); ++i)
-            std::transform(i->begin(), i->end(), i->begin(), ::tolower);
-    mWorkingDirectory.push_back(Path::getCurrentPath());
+    std::vector<std::string> workingDirectory;
+    workingDirectory.push_back(Path::getCurrentPath());
+
+    for (std::vector<std::string>::const_iterator i = excludedPaths.begin(); i != excludedPaths.end(); ++i) {
+        std::string mask(*i);
+        if (!mCaseSensitive)
+            std::transform(mask.begin(), mask.end(), mask.begin(), ::tolower);
+        mMasks.push_back(CompiledMask(mask));
+        mRelativeMasks.push_back(CompiledMask(Path::isAbsolute(mask) ? Path::getRelativePath(mask, workingDirectory) : mask));
+    }
 }
 
 bool PathMatch::match(const std::string &path) const
@@ -39,38 +50,37 @@ bool PathMatch::match(const std::string &path) const
     if (path.empty())
         return false;
 
-    for (std::vector<std::string>::const_iterator i = mExcludedPaths.begin(); i != mExcludedPaths.end(); ++i) {
-        const std::string excludedPath((!Path::isAbsolute(path) && Path::isAbsolute(*i)) ? Path::getRelativePath(*i, mWorkingDirectory) : *i);
+    std::string findpath = Path::fromNativeSeparators(path);
+    if (!mCaseSensitive)
+        std::transform(findpath.begin(), findpath.end(), findpath.begin(), ::tolower);
 
-        std::string findpath = Path::fromNativeSeparators(path);
-        if (!mCaseSensitive)
-            std::transform(findpath.begin(), findpath.end(), findpath.begin(), ::tolower);
+    // The directory part of the path is shared by all directory masks
+    const std::string finddir(endsWith(findpath,'/') ? findpath : removeFilename(findpath));
 
+    const std::vector<CompiledMask> &masks = Path::isAbsolute(path) ? mMasks : mRelativeMasks;
+    for (std::vector<CompiledMask>::const_iterator i = masks.begin(); i != masks.end(); ++i) {
         // Filtering directory name
-        if (endsWith(excludedPath,'/')) {
-            if (!endsWith(findpath,'/'))
-                findpath = removeFilename(findpath);
-
-            if (excludedPath.length() > findpath.length())
+        if (i->directoryMask) {
+            if (i->text.length() > finddir.length())
                 continue;
             // Match relative paths starting with mask
             // -isrc matches src/foo.cpp
-            if (findpath.compare(0, excludedPath.size(), excludedPath) == 0)
+            if (finddir.compare(0, i->text.size(), i->text) == 0)
                 return true;
             // Match only full directory name in middle or end of the path
             // -isrc matches myproject/src/ but does not match
             // myproject/srcfiles/ or myproject/mysrc/
-            if (findpath.find("/" + excludedPath) != std::string::npos)
+            if (finddir.find(i->innerText) != std::string::npos)
                 return true;
         }
         // Filtering filename
         else {
-            if (excludedPath.length() > findpath.length())
+            if (i->text.length() > findpath.length())
                 continue;
             // Check if path ends with mask
             // -ifoo.cpp matches (./)foo.c, src/foo.cpp and proj/src/foo.cpp
             // -isrc/file.cpp matches src/foo.cpp and proj/src/foo.cpp
-            if (findpath.compare(findpath.size() - excludedPath.size(), findpath.size(), excludedPath) == 0)
+            if (findpath.compare(findpath.size() - i->text.size(), findpath.size(), i->text) == 0)
                 return true;
 
         }
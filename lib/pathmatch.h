@@ -58,9 +58,29 @@ protected:
     static std::string removeFilename(const std::string &path);
 
 private:
-    std::vector<std::string> mExcludedPaths;
+    /** @brief One mask compiled into the forms match() needs, so they are
+     * not rebuilt for every path. */
+    struct CompiledMask {
+        explicit CompiledMask(const std::string &mask);
+
+        /** the mask itself, case-folded when matching is case-insensitive */
+        std::string text;
+
+        /** "/" + mask, for matching a full directory name inside the path */
+        std::string innerText;
+
+        /** mask ends with '/' and matches a whole directory */
+        bool directoryMask;
+    };
+
+    /** @brief Masks used when matching an absolute path. */
+    std::vector<CompiledMask> mMasks;
+
+    /** @brief The same masks, with absolute ones rewritten relative to the
+     * working directory. Used when matching a relative path. */
+    std::vector<CompiledMask> mRelativeMasks;
+
     bool mCaseSensitive;
-    std::vector<std::string> mWorkingDirectory;
 };
 
 /// @}
@@ -45,7 +45,7 @@ static std::string trim(const std::string& s)
     return s.substr(beg, end - beg + 1);
 }
 
-Directive::Directive(const std::string &_file, const int _linenr, const std::string &_str):
+Directive::Directive(const std::string *_file, const int _linenr, const std::string &_str):
     file(_file),
     linenr(_linenr),
     str(trim(_str))
@@ -57,7 +57,7 @@ bool Preprocessor::missingSystemIncludeFlag;
 
 char Preprocessor::macroChar = char(1);
 
-Preprocessor::Preprocessor(Settings& settings, ErrorLogger *errorLogger) : mSettings(settings), mErrorLogger(errorLogger)
+Preprocessor::Preprocessor(Settings& settings, ErrorLogger *errorLogger) : mSettings(settings), mErrorLogger(errorLogger), mLibraryDefinesParsed(false)
 {
 }
 
@@ -80,6 +80,10 @@ static void inlineSuppressions(const simplecpp::TokenList &tokens, Settings &mSe
     std::list<Suppressions::Suppression> inlineSuppressions;
     for (const simplecpp::Token *tok = tokens.cfront(); tok; tok = tok->next) {
         if (tok->comment) {
+            // parseComment() copies the text and sets up a stream; a plain
+            // substring test rejects the ordinary comments much cheaper
+            if (tok->str().find("cppcheck-suppress") == std::string::npos)
+                continue;
             Suppressions::Suppression s;
             std::string errmsg;
             if (!s.parseComment(tok->str(), &errmsg))
@@ -135,6 +139,7 @@ void Preprocessor::setDirectives(const simplecpp::TokenList &tokens)
 {
     // directive list..
     mDirectives.clear();
+    mDirectiveFiles.clear();
 
     std::vector<const simplecpp::TokenList *> list;
     list.reserve(1U + mTokenLists.size());
@@ -149,7 +154,8 @@ void Preprocessor::setDirectives(const simplecpp::TokenList &tokens)
                 continue;
             if (tok->next && tok->next->str() == "endfile")
                 continue;
-            Directive directive(tok->location.file(), tok->location.line, emptyString);
+            const std::string &fileName = *mDirectiveFiles.insert(tok->location.file()).first;
+            Directive directive(&fileName, tok->location.line, emptyString);
             for (const simplecpp::Token *tok2 = tok; tok2 && tok2->location.line == directive.linenr; tok2 = tok2->next) {
                 if (tok2->comment)
                     continue;
@@ -520,36 +526,47 @@ static void splitcfg(const std::string &cfg, std::list<std::string> &defines, co
     }
 }
 
-static simplecpp::DUI createDUI(const Settings &mSettings, const std::string &cfg, const std::string &filename)
+simplecpp::DUI Preprocessor::createDUI(const std::string &cfg, const std::string &filename)
 {
+    // reformatting the library defines does not depend on the configuration,
+    // don't redo it for every configuration of the file
+    if (!mLibraryDefinesParsed) {
+        for (const std::string &def : mSettings.library.defines) {
+            if (def.compare(0,8,"#define ") != 0)
+                continue;
+            std::string s = def.substr(8);
+            const std::string::size_type pos = s.find_first_of(" (");
+            if (pos == std::string::npos) {
+                mLibraryDefines.push_back(s);
+                continue;
+            }
+            if (s[pos] == ' ') {
+                s[pos] = '=';
+            } else {
+                s[s.find(')')+1] = '=';
+            }
+            mLibraryDefines.push_back(s);
+        }
+        mLibraryDefinesParsed = true;
+    }
+
     simplecpp::DUI dui;
 
     splitcfg(mSettings.userDefines, dui.defines, "1");
     if (!cfg.empty())
         splitcfg(cfg, dui.defines, emptyString);
 
-    for (const std::string &def : mSettings.library.defines) {
-        if (def.compare(0,8,"#define ") != 0)
-            continue;
-        std::string s = def.substr(8);
-        const std::string::size_type pos = s.find_first_of(" (");
-        if (pos == std::string::npos) {
-            dui.defines.push_back(s);
-            continue;
-        }
-        if (s[pos] == ' ') {
-            s[pos] = '=';
-        } else {
-            s[s.find(')')+1] = '=';
-        }
-        dui.defines.push_back(s);
-    }
+    dui.defines.insert(dui.defines.end(), mLibraryDefines.begin(), mLibraryDefines.end());
 
     if (Path::isCPP(filename))
         dui.defines.push_back("__cplusplus");
 
     dui.undefined = mSettings.userUndefs; // -U
     dui.includePaths = mSettings.includePaths; // -I
+    // the header model directory shadows the real vendor headers, so it is
+    // searched first (--header-models=)
+    if (!mSettings.headerModelsPath.empty())
+        dui.includePaths.push_front(mSettings.headerModelsPath);
     dui.includes = mSettings.userIncludes;  // --include
     return dui;
 }
@@ -575,11 +592,46 @@ static bool hasErrors(const simplecpp::OutputList &outputList)
 
 void Preprocessor::loadFiles(const simplecpp::TokenList &rawtokens, std::vector<std::string> &files)
 {
-    const simplecpp::DUI dui = createDUI(mSettings, emptyString, files[0]);
+    const simplecpp::DUI dui = createDUI(emptyString, files[0]);
 
     mTokenLists = simplecpp::load(rawtokens, files, dui, nullptr);
 }
 
+void Preprocessor::unloadFiles()
+{
+    for (std::map<std::string, simplecpp::TokenList *>::iterator it = mTokenLists.begin(); it != mTokenLists.end(); ++it)
+        delete it->second;
+    mTokenLists.clear();
+}
+
+static bool tokenListContainsIdentifier(const simplecpp::TokenList &tokens, const std::string &identifier)
+{
+    for (const simplecpp::Token *tok = tokens.cfront(); tok; tok = tok->next) {
+        if (tok->name && tok->str() == identifier)
+            return true;
+    }
+    return false;
+}
+
+bool Preprocessor::containsIdentifier(const simplecpp::TokenList &rawtokens, const std::string &identifier) const
+{
+    if (tokenListContainsIdentifier(rawtokens, identifier))
+        return true;
+    for (std::map<std::string, simplecpp::TokenList *>::const_iterator it = mTokenLists.begin(); it != mTokenLists.end(); ++it) {
+        if (it->second && tokenListContainsIdentifier(*it->second, identifier))
+            return true;
+    }
+    return false;
+}
+
+std::list<std::string> Preprocessor::getIncludedFiles() const
+{
+    std::list<std::string> ret;
+    for (std::map<std::string, simplecpp::TokenList *>::const_iterator it = mTokenLists.begin(); it != mTokenLists.end(); ++it)
+        ret.push_back(it->first);
+    return ret;
+}
+
 void Preprocessor::removeComments()
 {
     for (std::map<std::string, simplecpp::TokenList*>::iterator it = mTokenLists.begin(); it != mTokenLists.end(); ++it) {
@@ -610,7 +662,7 @@ void Preprocessor::setPlatformInfo(simplecpp::TokenList *tokens) const
 
 simplecpp::TokenList Preprocessor::preprocess(const simplecpp::TokenList &tokens1, const std::string &cfg, std::vector<std::string> &files, bool throwError)
 {
-    const simplecpp::DUI dui = createDUI(mSettings, cfg, files[0]);
+    const simplecpp::DUI dui = createDUI(cfg, files[0]);
 
     simplecpp::OutputList outputList;
     std::list<simplecpp::MacroUsage> macroUsage;
@@ -744,12 +796,12 @@ void Preprocessor::missingInclude(const std::string &filename, unsigned int line
 {
     const std::string fname = Path::fromNativeSeparators(filename);
     Suppressions::ErrorMessage errorMessage;
-    errorMessage.errorId = "missingInclude";
+    errorMessage.setErrorId("missingInclude");
     errorMessage.setFileName(fname);
     errorMessage.lineNumber = linenr;
     if (mSettings.nomsg.isSuppressed(errorMessage))
         return;
-    errorMessage.errorId = "missingIncludeSystem";
+    errorMessage.setErrorId("missingIncludeSystem");
     if (headerType == SystemHeader && mSettings.nomsg.isSuppressed(errorMessage))
         return;
 
@@ -792,7 +844,7 @@ bool Preprocessor::validateCfg(const std::string &cfg, const std::list<simplecpp
                 continue;
             bool directiveLocation = false;
             for (const Directive &dir : mDirectives) {
-                if (mu.useLocation.file() == dir.file && mu.useLocation.line == dir.linenr) {
+                if (mu.useLocation.file() == *dir.file && mu.useLocation.line == dir.linenr) {
                     directiveLocation = true;
                     break;
                 }
@@ -834,17 +886,20 @@ void Preprocessor::dump(std::ostream &out) const
     // Create a xml directive dump.
     // The idea is not that this will be readable for humans. It's a
     // data dump that 3rd party tools could load and get useful info from.
-    out << "  <directivelist>" << std::endl;
+    if (!mSettings.isDumpSectionEnabled("directives"))
+        return;
+
+    out << "  <directivelist>" << '\n';
 
     for (const Directive &dir : mDirectives) {
         out << "    <directive "
-            << "file=\"" << ErrorLogger::toxml(dir.file) << "\" "
+            << "file=\"" << ErrorLogger::toxml(*dir.file) << "\" "
             << "linenr=\"" << dir.linenr << "\" "
             // str might contain characters such as '"', '<' or '>' which
             // could result in invalid XML, so run it through toxml().
-            << "str=\"" << ErrorLogger::toxml(dir.str) << "\"/>" << std::endl;
+            << "str=\"" << ErrorLogger::toxml(dir.str) << "\"/>" << '\n';
     }
-    out << "  </directivelist>" << std::endl;
+    out << "  </directivelist>" << '\n';
 }
 
 static const std::uint32_t crc32Table[] = {
@@ -893,30 +948,31 @@ static const std::uint32_t crc32Table[] = {
     0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d
 };
 
-static std::uint32_t crc32(const std::string &data)
+static void crc32Update(std::uint32_t &crc, const std::string &data)
 {
-    std::uint32_t crc = ~0U;
     for (std::string::const_iterator c = data.begin(); c != data.end(); ++c) {
         crc = crc32Table[(crc ^ (unsigned char)(*c)) & 0xFF] ^ (crc >> 8);
     }
-    return crc ^ ~0U;
 }
 
 unsigned int Preprocessor::calculateChecksum(const simplecpp::TokenList &tokens1, const std::string &toolinfo) const
 {
-    std::ostringstream ostr;
-    ostr << toolinfo << '\n';
+    // update the crc incrementally - the source file and all included headers
+    // are hashed, materializing that into one string first is just memory churn
+    std::uint32_t crc = ~0U;
+    crc32Update(crc, toolinfo);
+    crc32Update(crc, "\n");
     for (const simplecpp::Token *tok = tokens1.cfront(); tok; tok = tok->next) {
         if (!tok->comment)
-            ostr << tok->str();
+            crc32Update(crc, tok->str());
     }
     for (std::map<std::string, simplecpp::TokenList *>::const_iterator it = mTokenLists.begin(); it != mTokenLists.end(); ++it) {
         for (const simplecpp::Token *tok = it->second->cfront(); tok; tok = tok->next) {
             if (!tok->comment)
-                ostr << tok->str();
+                crc32Update(crc, tok->str());
         }
     }
-    return crc32(ostr.str());
+    return crc ^ ~0U;
 }
 
 void Preprocessor::simplifyPragmaAsm(simplecpp::TokenList *tokenList)
@@ -45,8 +45,10 @@ class Settings;
 
 class CPPCHECKLIB Directive {
 public:
-    /** name of (possibly included) file where directive is defined */
-    std::string file;
+    /** name of (possibly included) file where directive is defined. Points
+     * into the interning pool of the owning Preprocessor: all directives
+     * from the same file share one string. */
+    const std::string *file;
 
     /** line number in (possibly included) file where directive is defined */
     unsigned int linenr;
@@ -55,7 +57,7 @@ public:
     std::string str;
 
     /** record a directive (possibly filtering src) */
-    Directive(const std::string &_file, const int _linenr, const std::string &_str);
+    Directive(const std::string *_file, const int _linenr, const std::string &_str);
 };
 
 /// @addtogroup Core
@@ -91,8 +93,9 @@ public:
 
     void setDirectives(const simplecpp::TokenList &tokens);
 
-    /** list of all directives met while preprocessing file */
-    const std::list<Directive> &getDirectives() const {
+    /** list of all directives met while preprocessing file. Built once per
+     * file and shared by all configurations and the dump writer. */
+    const std::vector<Directive> &getDirectives() const {
         return mDirectives;
     }
 
@@ -100,6 +103,18 @@ public:
 
     void loadFiles(const simplecpp::TokenList &rawtokens, std::vector<std::string> &files);
 
+    /** files loaded by loadFiles(), i.e. the include closure of the source file */
+    std::list<std::string> getIncludedFiles() const;
+
+    /** Release the include files loaded by loadFiles() to lower the peak
+     * memory use. No more configurations can be preprocessed afterwards. */
+    void unloadFiles();
+
+    /** Whether the identifier occurs in the raw tokens of the source file
+     * or any file loaded by loadFiles(). Used to skip checks whose trigger
+     * identifier cannot match, see Check::triggerIdentifier(). */
+    bool containsIdentifier(const simplecpp::TokenList &rawtokens, const std::string &identifier) const;
+
     void removeComments();
 
     void setPlatformInfo(simplecpp::TokenList *tokens) const;
@@ -206,16 +221,29 @@ private:
     void missingInclude(const std::string &filename, unsigned int linenr, const std::string &header, HeaderTypes headerType);
     void error(const std::string &filename, unsigned int linenr, const std::string &msg);
 
+    /** Create simplecpp settings for the given configuration. The
+     * configuration-invariant parts are cached so checking many
+     * configurations of one file doesn't redo them. */
+    simplecpp::DUI createDUI(const std::string &cfg, const std::string &filename);
+
     Settings& mSettings;
     ErrorLogger *mErrorLogger;
 
     /** list of all directives met while preprocessing file */
-    std::list<Directive> mDirectives;
+    std::vector<Directive> mDirectives;
+
+    /** interned file names referenced by mDirectives */
+    std::set<std::string> mDirectiveFiles;
 
     std::map<std::string, simplecpp::TokenList *> mTokenLists;
 
     /** filename for cpp/c file - useful when reporting errors */
     std::string mFile0;
+
+    /** library defines in simplecpp format, parsed once since they don't
+     * depend on the configuration. see createDUI() */
+    std::list<std::string> mLibraryDefines;
+    bool mLibraryDefinesParsed;
 };
 
 /// @}
@@ -29,6 +29,7 @@ Settings::Settings()
       debugwarnings(false),
       debugtemplate(false),
       maxCtuDepth(2),
+      daemon(false),
       dump(false),
       exceptionHandling(false),
       inconclusive(false),
@@ -45,8 +46,15 @@ Settings::Settings()
       loadAverage(0),
       exitCode(0),
       showtime(SHOWTIME_NONE),
+      sortedResults(false),
+      analysisOrder("size"),
       preprocessOnly(false),
       maxConfigs(12),
+      maxTemplateTokens(0),
+      maxTimePerFile(0),
+      subCheckBudgetMs(0),
+      valueFlowMaxEffort(0),
+      valueFlowStatistics(false),
       enforcedLang(None),
       reportProgress(false),
       checkConfiguration(false),
@@ -106,30 +114,6 @@ std::string Settings::addEnabled(const std::string &str)
     return std::string();
 }
 
-bool Settings::isEnabled(Severity::SeverityType severity) const
-{
-    switch (severity) {
-    case Severity::none:
-        return true;
-    case Severity::error:
-        return true;
-    case Severity::warning:
-        return isEnabled(WARNING);
-    case Severity::style:
-        return isEnabled(STYLE);
-    case Severity::performance:
-        return isEnabled(PERFORMANCE);
-    case Severity::portability:
-        return isEnabled(PORTABILITY);
-    case Severity::information:
-        return isEnabled(INFORMATION);
-    case Severity::debug:
-        return false;
-    default:
-        return false;
-    }
-}
-
 bool Settings::isEnabled(const ValueFlow::Value *value, bool inconclusiveCheck) const
 {
     if (!isEnabled(Settings::WARNING) && (value->condition || value->defaultArg))
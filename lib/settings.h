@@ -73,6 +73,13 @@ public:
     /** @brief --cppcheck-build-dir */
     std::string buildDir;
 
+    /** @brief --cppcheck-cache-dir, shared content-addressed analysis cache */
+    std::string cacheDir;
+
+    /** @brief --cpu-affinity=, cpu pinning policy for the worker processes.
+     * Empty when the workers are not pinned. */
+    std::string cpuAffinity;
+
     /** @brief Is --debug-simplified given? */
     bool debugSimplified;
 
@@ -88,10 +95,21 @@ public:
     /** @brief --max-ctu-depth */
     int maxCtuDepth;
 
+    /** @brief Is --daemon given? Keep the process resident and read check requests from stdin. */
+    bool daemon;
+
     /** @brief Is --dump given? */
     bool dump;
     std::string dumpFile;
 
+    /** @brief --dump=&lt;sections&gt;: sections to write to the dump file, empty = all sections */
+    std::set<std::string> dumpSections;
+
+    /** Is the given dump file section enabled? All sections are written when no selection was given. */
+    bool isDumpSectionEnabled(const std::string &section) const {
+        return dumpSections.empty() || dumpSections.find(section) != dumpSections.end();
+    }
+
     /** @brief Is --exception-handling given */
     bool exceptionHandling;
 
@@ -150,6 +168,11 @@ public:
     /** @brief plist output (--plist-output=&lt;dir&gt;) */
     std::string plistOutput;
 
+    /** @brief SARIF output file, written incrementally as the results
+        arrive so converting for code-review systems needs no
+        post-processing pass. (--sarif=&lt;file&gt;) */
+    std::string sarifOutput;
+
     /** @brief write XML results (--xml) */
     bool xml;
 
@@ -178,6 +201,28 @@ public:
     /** @brief show timing information (--showtime=file|summary|top5) */
     SHOWTIME_MODES showtime;
 
+    /** @brief write a machine readable performance report to this file
+        (--perf-report=&lt;file&gt;) */
+    std::string perfReport;
+
+    /** @brief write the timer runs in Chrome trace event format to this
+        file (--trace-report=&lt;file&gt;) */
+    std::string traceReport;
+
+    /** @brief report the results sorted and deduplicated at the end of the
+        run, merged from per-worker result shards (--sorted-results) */
+    bool sortedResults;
+
+    /** @brief --recheck=&lt;file&gt;: re-check one file, reusing the project
+        state recorded in the build dir by an earlier full run */
+    std::string recheckFile;
+
+    /** @brief the order the input files are analyzed in: "size" (default,
+        biggest files first so one big straggler does not finish the run
+        alone) or "mtime" (recently modified files first, for the fastest
+        time to a finding in freshly edited code). (--order=) */
+    std::string analysisOrder;
+
     /** @brief Using -E for debugging purposes */
     bool preprocessOnly;
 
@@ -185,10 +230,50 @@ public:
         for finding include files inside source files. (-I) */
     std::list<std::string> includePaths;
 
+    /** @brief Directory with declaration-only model headers that shadow the
+        real vendor headers, searched before the -I paths. The models keep
+        the declarations' shapes the checks need and drop the implementation
+        detail that dominates the preprocessing and tokenization time.
+        (--header-models=) */
+    std::string headerModelsPath;
+
+    /** @brief Native check plugins that have been loaded: shared objects
+        whose static Check instances registered themselves on load, giving
+        custom checks full Token/SymbolDatabase access at native speed
+        instead of regex rules over stringified tokens. (--plugin=) */
+    std::list<std::string> plugins;
+
     /** @brief Maximum number of configurations to check before bailing.
         Default is 12. (--max-configs=N) */
     unsigned int maxConfigs;
 
+    /** @brief Maximum number of tokens the template simplifier may generate
+        per translation unit before further instantiations are skipped.
+        Default is 0 = no limit. (--max-template-tokens=N) */
+    std::size_t maxTemplateTokens;
+
+    /** @brief Soft deadline in seconds for checking one file. When it
+        passes, the remaining passes and configurations of the file are
+        abandoned at the next pass boundary and an information message
+        is written. Default is 0 = no deadline. (--max-time-per-file=N) */
+    int maxTimePerFile;
+
+    /** @brief Wall-time budget in milliseconds for one sub-check on one
+        file. A sub-check that overruns it is reported and skipped for the
+        rest of the process. Default is 0 = no budget.
+        (--sub-check-budget=N) */
+    std::size_t subCheckBudgetMs;
+
+    /** @brief Maximum number of token visits the value flow analysis may
+        spend inside one function before further forward analysis of that
+        function is skipped. Default is 0 = no limit.
+        (--valueflow-max-effort=N) */
+    std::size_t valueFlowMaxEffort;
+
+    /** @brief write value flow statistics (values added per pass, bailouts
+        fired) as JSON? (--valueflow-stats) */
+    bool valueFlowStatistics;
+
     /**
      * @brief Returns true if given id is in the list of
      * enabled extra checks (--enable)
@@ -201,9 +286,31 @@ public:
 
     /**
     * @brief Returns true if given severity is enabled
+    *
+    * Inline because this runs once per emitted diagnostic and inside
+    * conditional check bodies.
     * @return true if the check is enabled.
     */
-    bool isEnabled(Severity::SeverityType severity) const;
+    bool isEnabled(Severity::SeverityType severity) const {
+        switch (severity) {
+        case Severity::none:
+        case Severity::error:
+            return true;
+        case Severity::warning:
+            return isEnabled(WARNING);
+        case Severity::style:
+            return isEnabled(STYLE);
+        case Severity::performance:
+            return isEnabled(PERFORMANCE);
+        case Severity::portability:
+            return isEnabled(PORTABILITY);
+        case Severity::information:
+            return isEnabled(INFORMATION);
+        case Severity::debug:
+        default:
+            return false;
+        }
+    }
 
     /**
     * @brief Returns true if given value can be shown
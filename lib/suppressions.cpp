@@ -32,6 +32,25 @@
 
 class ErrorLogger;
 
+Suppressions::Suppressions(const Suppressions &other)
+    : mSuppressions(other.mSuppressions)
+{
+    for (Suppression &s : mSuppressions)
+        indexSuppression(s);
+}
+
+Suppressions &Suppressions::operator=(const Suppressions &other)
+{
+    if (this != &other) {
+        mSuppressions = other.mSuppressions;
+        mSuppressionsById.clear();
+        mGlobSuppressions.clear();
+        for (Suppression &s : mSuppressions)
+            indexSuppression(s);
+    }
+    return *this;
+}
+
 static bool isValidGlobPattern(const std::string &pattern)
 {
     for (std::string::const_iterator i = pattern.begin(); i != pattern.end(); ++i) {
@@ -184,10 +203,29 @@ std::string Suppressions::addSuppression(const Suppressions::Suppression &suppre
         return "Failed to add suppression. Invalid glob pattern '" + suppression.fileName + "'.";
 
     mSuppressions.push_back(suppression);
+    indexSuppression(mSuppressions.back());
 
     return "";
 }
 
+void Suppressions::indexSuppression(Suppressions::Suppression &suppression)
+{
+    if (suppression.errorId.find_first_of("*?") == std::string::npos)
+        mSuppressionsById.insert(std::make_pair(ErrorLogger::internErrorId(suppression.errorId), &suppression));
+    else
+        mGlobSuppressions.push_back(&suppression);
+}
+
+void Suppressions::ErrorMessage::setErrorId(const std::string &id)
+{
+    errorIdIndex = ErrorLogger::internErrorId(id);
+}
+
+const std::string &Suppressions::ErrorMessage::getErrorId() const
+{
+    return ErrorLogger::errorIdString(errorIdIndex);
+}
+
 void Suppressions::ErrorMessage::setFileName(const std::string &s)
 {
     mFileName = Path::simplifyPath(s);
@@ -231,7 +269,7 @@ bool Suppressions::Suppression::parseComment(std::string comment, std::string *e
 
 bool Suppressions::Suppression::isSuppressed(const Suppressions::ErrorMessage &errmsg) const
 {
-    if (!errorId.empty() && !matchglob(errorId, errmsg.errorId))
+    if (!errorId.empty() && !matchglob(errorId, errmsg.getErrorId()))
         return false;
     if (!fileName.empty() && !matchglob(fileName, errmsg.getFileName()))
         return false;
@@ -282,11 +320,22 @@ std::string Suppressions::Suppression::getText() const
 
 bool Suppressions::isSuppressed(const Suppressions::ErrorMessage &errmsg)
 {
-    const bool unmatchedSuppression(errmsg.errorId == "unmatchedSuppression");
-    for (Suppression &s : mSuppressions) {
-        if (unmatchedSuppression && s.errorId != errmsg.errorId)
-            continue;
-        if (s.isMatch(errmsg))
+    // Look up the suppressions with this exact error id..
+    const std::pair<std::unordered_multimap<unsigned int, Suppression *>::iterator,
+          std::unordered_multimap<unsigned int, Suppression *>::iterator> range = mSuppressionsById.equal_range(errmsg.errorIdIndex);
+    for (std::unordered_multimap<unsigned int, Suppression *>::iterator it = range.first; it != range.second; ++it) {
+        if (it->second->isMatch(errmsg))
+            return true;
+    }
+
+    // An unmatchedSuppression message is only hidden by a suppression with
+    // that exact id, never by a glob pattern
+    static const unsigned int unmatchedSuppressionId = ErrorLogger::internErrorId("unmatchedSuppression");
+    if (errmsg.errorIdIndex == unmatchedSuppressionId)
+        return false;
+
+    for (Suppression *s : mGlobSuppressions) {
+        if (s->isMatch(errmsg))
             return true;
     }
     return false;
@@ -294,13 +343,19 @@ bool Suppressions::isSuppressed(const Suppressions::ErrorMessage &errmsg)
 
 bool Suppressions::isSuppressedLocal(const Suppressions::ErrorMessage &errmsg)
 {
-    const bool unmatchedSuppression(errmsg.errorId == "unmatchedSuppression");
-    for (Suppression &s : mSuppressions) {
-        if (!s.isLocal())
-            continue;
-        if (unmatchedSuppression && s.errorId != errmsg.errorId)
-            continue;
-        if (s.isMatch(errmsg))
+    const std::pair<std::unordered_multimap<unsigned int, Suppression *>::iterator,
+          std::unordered_multimap<unsigned int, Suppression *>::iterator> range = mSuppressionsById.equal_range(errmsg.errorIdIndex);
+    for (std::unordered_multimap<unsigned int, Suppression *>::iterator it = range.first; it != range.second; ++it) {
+        if (it->second->isLocal() && it->second->isMatch(errmsg))
+            return true;
+    }
+
+    static const unsigned int unmatchedSuppressionId = ErrorLogger::internErrorId("unmatchedSuppression");
+    if (errmsg.errorIdIndex == unmatchedSuppressionId)
+        return false;
+
+    for (Suppression *s : mGlobSuppressions) {
+        if (s->isLocal() && s->isMatch(errmsg))
             return true;
     }
     return false;
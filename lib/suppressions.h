@@ -26,6 +26,7 @@
 #include <list>
 #include <set>
 #include <string>
+#include <unordered_map>
 
 /// @addtogroup Core
 /// @{
@@ -33,9 +34,24 @@
 /** @brief class for handling suppressions */
 class CPPCHECKLIB Suppressions {
 public:
+    Suppressions() {}
+
+    /** The error id index holds pointers into mSuppressions so it must be rebuilt when copying */
+    Suppressions(const Suppressions &other);
+    Suppressions &operator=(const Suppressions &other);
 
     struct CPPCHECKLIB ErrorMessage {
-        std::string errorId;
+        ErrorMessage() : errorIdIndex(0), lineNumber(0), inconclusive(false) {}
+
+        /** Compact index of the error id in the id registry, see ErrorLogger::internErrorId() */
+        unsigned int errorIdIndex;
+
+        /** Set the error id, interning it into the id registry */
+        void setErrorId(const std::string &id);
+
+        /** Materialize the error id string from the id registry */
+        const std::string &getErrorId() const;
+
         void setFileName(const std::string &s);
         const std::string &getFileName() const {
             return mFileName;
@@ -164,8 +180,20 @@ public:
 
     static bool matchglob(const std::string &pattern, const std::string &name);
 private:
+    /** @brief Register a suppression in the error id index */
+    void indexSuppression(Suppression &suppression);
+
     /** @brief List of error which the user doesn't want to see. */
     std::list<Suppression> mSuppressions;
+
+    /** @brief Suppressions with a literal error id, bucketed by the interned
+     * id index. Most suppressions have a literal id so an integer hash lookup
+     * on the message id replaces a linear scan over all suppressions. */
+    std::unordered_multimap<unsigned int, Suppression *> mSuppressionsById;
+
+    /** @brief Suppressions whose error id contains a glob pattern. Only these
+     * need to be matched one by one. */
+    std::list<Suppression *> mGlobSuppressions;
 };
 
 /// @}
@@ -22,6 +22,7 @@
 #include "errorlogger.h"
 #include "platform.h"
 #include "settings.h"
+#include "timer.h"
 #include "token.h"
 #include "tokenize.h"
 #include "tokenlist.h"
@@ -36,7 +37,7 @@
 //---------------------------------------------------------------------------
 
 SymbolDatabase::SymbolDatabase(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger)
-    : mTokenizer(tokenizer), mSettings(settings), mErrorLogger(errorLogger)
+    : mTokenizer(tokenizer), mSettings(settings), mErrorLogger(errorLogger), mAccountedBytes(0)
 {
     mIsCpp = isCPP();
 
@@ -47,6 +48,13 @@ SymbolDatabase::SymbolDatabase(const Tokenizer *tokenizer, const Settings *setti
     else
         mDefaultSignedness = ValueType::UNKNOWN_SIGN;
 
+    // All sections below are computed eagerly on purpose. Making them
+    // lazy (driven by the enabled checks) has been considered but every
+    // section has an always-on consumer: ValueFlow runs before any check,
+    // regardless of --enable, and needs the value types, the variable
+    // symbol table, the scope/function/variable pointers on the tokens,
+    // the enums and the array dimensions. Only C++-specific sections can
+    // be skipped, and those bail out early for C code instead.
     createSymbolDatabaseFindAllScopes();
     createSymbolDatabaseClassInfo();
     createSymbolDatabaseVariableInfo();
@@ -62,6 +70,20 @@ SymbolDatabase::SymbolDatabase(const Tokenizer *tokenizer, const Settings *setti
     createSymbolDatabaseSetTypePointers();
     createSymbolDatabaseEnums();
     createSymbolDatabaseUnknownArrayDimensions();
+    createSymbolDatabaseExprIds();
+
+    if (MemUsage::enabled) {
+        // estimated size; the scopes own the functions and variables
+        mAccountedBytes = sizeof(SymbolDatabase)
+                          + typeList.size() * sizeof(Type)
+                          + scopeList.size() * sizeof(Scope);
+        for (const Scope &scope : scopeList) {
+            mAccountedBytes += scope.functionList.size() * sizeof(Function)
+                               + scope.varlist.size() * sizeof(Variable)
+                               + scope.enumeratorList.size() * sizeof(Enumerator);
+        }
+        MemUsage::add(MemUsage::POOL_SYMBOLS, mAccountedBytes);
+    }
 }
 
 static const Token* skipScopeIdentifiers(const Token* tok)
@@ -674,7 +696,7 @@ void SymbolDatabase::createSymbolDatabaseClassInfo()
         return;
 
     // fill in using info
-    for (std::list<Scope>::iterator it = scopeList.begin(); it != scopeList.end(); ++it) {
+    for (std::deque<Scope>::iterator it = scopeList.begin(); it != scopeList.end(); ++it) {
         for (std::list<Scope::UsingInfo>::iterator i = it->usingList.begin(); i != it->usingList.end(); ++i) {
             // only find if not already found
             if (i->scope == nullptr) {
@@ -690,7 +712,7 @@ void SymbolDatabase::createSymbolDatabaseClassInfo()
     }
 
     // fill in base class info
-    for (std::list<Type>::iterator it = typeList.begin(); it != typeList.end(); ++it) {
+    for (std::deque<Type>::iterator it = typeList.begin(); it != typeList.end(); ++it) {
         // finish filling in base class info
         for (unsigned int i = 0; i < it->derivedFrom.size(); ++i) {
             const Type* found = findType(it->derivedFrom[i].nameTok, it->enclosingScope);
@@ -703,8 +725,17 @@ void SymbolDatabase::createSymbolDatabaseClassInfo()
         }
     }
 
+    // fill in base -> derived adjacency so hierarchy queries don't need
+    // to rescan the type list
+    for (std::deque<Type>::const_iterator it = typeList.begin(); it != typeList.end(); ++it) {
+        for (unsigned int i = 0; i < it->derivedFrom.size(); ++i) {
+            if (it->derivedFrom[i].type)
+                mDerivedTypes[it->derivedFrom[i].type].push_back(&(*it));
+        }
+    }
+
     // fill in friend info
-    for (std::list<Type>::iterator it = typeList.begin(); it != typeList.end(); ++it) {
+    for (std::deque<Type>::iterator it = typeList.begin(); it != typeList.end(); ++it) {
         for (std::vector<Type::FriendInfo>::iterator i = it->friendList.begin(); i != it->friendList.end(); ++i) {
             i->type = findType(i->nameStart, it->enclosingScope);
         }
@@ -715,13 +746,13 @@ void SymbolDatabase::createSymbolDatabaseClassInfo()
 void SymbolDatabase::createSymbolDatabaseVariableInfo()
 {
     // fill in variable info
-    for (std::list<Scope>::iterator it = scopeList.begin(); it != scopeList.end(); ++it) {
+    for (std::deque<Scope>::iterator it = scopeList.begin(); it != scopeList.end(); ++it) {
         // find variables
         it->getVariableList(mSettings);
     }
 
     // fill in function arguments
-    for (std::list<Scope>::iterator it = scopeList.begin(); it != scopeList.end(); ++it) {
+    for (std::deque<Scope>::iterator it = scopeList.begin(); it != scopeList.end(); ++it) {
         std::list<Function>::iterator func;
 
         for (func = it->functionList.begin(); func != it->functionList.end(); ++func) {
@@ -733,8 +764,11 @@ void SymbolDatabase::createSymbolDatabaseVariableInfo()
 
 void SymbolDatabase::createSymbolDatabaseCopyAndMoveConstructors()
 {
+    if (mTokenizer->isC())
+        return;
+
     // fill in class and struct copy/move constructors
-    for (std::list<Scope>::iterator scope = scopeList.begin(); scope != scopeList.end(); ++scope) {
+    for (std::deque<Scope>::iterator scope = scopeList.begin(); scope != scopeList.end(); ++scope) {
         if (!scope->isClassOrStruct())
             continue;
 
@@ -761,7 +795,7 @@ void SymbolDatabase::createSymbolDatabaseCopyAndMoveConstructors()
 void SymbolDatabase::createSymbolDatabaseFunctionScopes()
 {
     // fill in function scopes
-    for (std::list<Scope>::iterator it = scopeList.begin(); it != scopeList.end(); ++it) {
+    for (std::deque<Scope>::iterator it = scopeList.begin(); it != scopeList.end(); ++it) {
         if (it->type == Scope::eFunction)
             functionScopes.push_back(&*it);
     }
@@ -770,7 +804,7 @@ void SymbolDatabase::createSymbolDatabaseFunctionScopes()
 void SymbolDatabase::createSymbolDatabaseClassAndStructScopes()
 {
     // fill in class and struct scopes
-    for (std::list<Scope>::iterator it = scopeList.begin(); it != scopeList.end(); ++it) {
+    for (std::deque<Scope>::iterator it = scopeList.begin(); it != scopeList.end(); ++it) {
         if (it->isClassOrStruct())
             classAndStructScopes.push_back(&*it);
     }
@@ -779,7 +813,7 @@ void SymbolDatabase::createSymbolDatabaseClassAndStructScopes()
 void SymbolDatabase::createSymbolDatabaseFunctionReturnTypes()
 {
     // fill in function return types
-    for (std::list<Scope>::iterator it = scopeList.begin(); it != scopeList.end(); ++it) {
+    for (std::deque<Scope>::iterator it = scopeList.begin(); it != scopeList.end(); ++it) {
         std::list<Function>::iterator func;
 
         for (func = it->functionList.begin(); func != it->functionList.end(); ++func) {
@@ -802,7 +836,7 @@ void SymbolDatabase::createSymbolDatabaseNeedInitialization()
 {
     if (mTokenizer->isC()) {
         // For C code it is easy, as there are no constructors and no default values
-        for (std::list<Scope>::iterator it = scopeList.begin(); it != scopeList.end(); ++it) {
+        for (std::deque<Scope>::iterator it = scopeList.begin(); it != scopeList.end(); ++it) {
             Scope *scope = &(*it);
             if (scope->definedType)
                 scope->definedType->needInitialization = Type::True;
@@ -815,7 +849,7 @@ void SymbolDatabase::createSymbolDatabaseNeedInitialization()
         do {
             unknowns = 0;
 
-            for (std::list<Scope>::iterator it = scopeList.begin(); it != scopeList.end(); ++it) {
+            for (std::deque<Scope>::iterator it = scopeList.begin(); it != scopeList.end(); ++it) {
                 Scope *scope = &(*it);
 
                 if (!scope->definedType) {
@@ -890,7 +924,7 @@ void SymbolDatabase::createSymbolDatabaseNeedInitialization()
 
         // this shouldn't happen so output a debug warning
         if (retry == 100 && mSettings->debugwarnings) {
-            for (std::list<Scope>::iterator it = scopeList.begin(); it != scopeList.end(); ++it) {
+            for (std::deque<Scope>::iterator it = scopeList.begin(); it != scopeList.end(); ++it) {
                 const Scope *scope = &(*it);
 
                 if (scope->isClassOrStruct() && scope->definedType->needInitialization == Type::Unknown)
@@ -907,7 +941,7 @@ void SymbolDatabase::createSymbolDatabaseVariableSymbolTable()
     std::fill_n(mVariableList.begin(), mVariableList.size(), (const Variable*)nullptr);
 
     // check all scopes for variables
-    for (std::list<Scope>::iterator it = scopeList.begin(); it != scopeList.end(); ++it) {
+    for (std::deque<Scope>::iterator it = scopeList.begin(); it != scopeList.end(); ++it) {
         Scope *scope = &(*it);
 
         // add all variables
@@ -971,7 +1005,7 @@ void SymbolDatabase::createSymbolDatabaseVariableSymbolTable()
 void SymbolDatabase::createSymbolDatabaseSetScopePointers()
 {
     // Set scope pointers
-    for (std::list<Scope>::iterator it = scopeList.begin(); it != scopeList.end(); ++it) {
+    for (std::deque<Scope>::iterator it = scopeList.begin(); it != scopeList.end(); ++it) {
         Token* start = const_cast<Token*>(it->bodyStart);
         Token* end = const_cast<Token*>(it->bodyEnd);
         if (it->type == Scope::eGlobal) {
@@ -1008,7 +1042,7 @@ void SymbolDatabase::createSymbolDatabaseSetFunctionPointers(bool firstPass)
 {
     if (firstPass) {
         // Set function definition and declaration pointers
-        for (std::list<Scope>::iterator it = scopeList.begin(); it != scopeList.end(); ++it) {
+        for (std::deque<Scope>::iterator it = scopeList.begin(); it != scopeList.end(); ++it) {
             for (std::list<Function>::const_iterator func = it->functionList.begin(); func != it->functionList.end(); ++func) {
                 if (func->tokenDef)
                     const_cast<Token *>(func->tokenDef)->function(&*func);
@@ -1029,7 +1063,7 @@ void SymbolDatabase::createSymbolDatabaseSetFunctionPointers(bool firstPass)
     }
 
     // Set C++ 11 delegate constructor function call pointers
-    for (std::list<Scope>::iterator it = scopeList.begin(); it != scopeList.end(); ++it) {
+    for (std::deque<Scope>::iterator it = scopeList.begin(); it != scopeList.end(); ++it) {
         for (std::list<Function>::const_iterator func = it->functionList.begin(); func != it->functionList.end(); ++func) {
             // look for initializer list
             if (func->isConstructor() && func->functionScope && func->functionScope->functionOf && func->arg) {
@@ -1194,7 +1228,7 @@ void SymbolDatabase::createSymbolDatabaseSetVariablePointers()
 void SymbolDatabase::createSymbolDatabaseEnums()
 {
     // fill in enumerators in enum
-    for (std::list<Scope>::iterator it = scopeList.begin(); it != scopeList.end(); ++it) {
+    for (std::deque<Scope>::iterator it = scopeList.begin(); it != scopeList.end(); ++it) {
         if (it->type != Scope::eEnum)
             continue;
 
@@ -1204,7 +1238,7 @@ void SymbolDatabase::createSymbolDatabaseEnums()
     }
 
     // fill in enumerator values
-    for (std::list<Scope>::iterator it = scopeList.begin(); it != scopeList.end(); ++it) {
+    for (std::deque<Scope>::iterator it = scopeList.begin(); it != scopeList.end(); ++it) {
         if (it->type != Scope::eEnum)
             continue;
 
@@ -1347,8 +1381,93 @@ void SymbolDatabase::createSymbolDatabaseUnknownArrayDimensions()
     }
 }
 
+/**
+ * Assign a canonical expression id to a subtree, hash-consing over the AST.
+ * Only side-effect-free expressions built from variables, literals and
+ * const operators get an id; everything else keeps id 0 so that
+ * isSameExpression() falls back to the full structural comparison. For the
+ * expressions that do get an id, equal ids mean the subtrees agree on
+ * everything isSameExpression() compares: string, varId, original name and
+ * the number type flags on every node.
+ */
+static unsigned int createExprId(Token *tok, std::unordered_map<std::string, unsigned int> &exprIdMap, unsigned int &exprIdCount)
+{
+    if (!tok)
+        return 0;
+    if (tok->exprId() != 0)
+        return tok->exprId();
+    // isSameExpression() rejects expanded macros and template arguments
+    if (tok->isExpandedMacro() || tok->isTemplateArg())
+        return 0;
+
+    std::string key;
+    if (tok->astOperand1()) {
+        // only operators that compare purely structurally; no function
+        // calls, casts, assignments, increment/decrement or blocks
+        if (!(tok->isConstOp() || tok->str() == "." || tok->str() == "["))
+            return 0;
+        // don't confuse template/bracket '<'/'>' with comparisons
+        if ((tok->str() == "<" || tok->str() == ">") && tok->link())
+            return 0;
+        const unsigned int id1 = createExprId(const_cast<Token *>(tok->astOperand1()), exprIdMap, exprIdCount);
+        if (id1 == 0)
+            return 0;
+        unsigned int id2 = 0;
+        if (tok->astOperand2()) {
+            id2 = createExprId(const_cast<Token *>(tok->astOperand2()), exprIdMap, exprIdCount);
+            if (id2 == 0)
+                return 0;
+        }
+        key = tok->str() + '(' + std::to_string(id1) + ',' + std::to_string(id2) + ')';
+    } else {
+        if (tok->isName()) {
+            // a name followed by '(' or '<' might be a function call or
+            // template - isSameExpression() has special rules for those
+            if (Token::Match(tok->next(), "(|<"))
+                return 0;
+            // require a resolved variable unless this is a member name
+            if (tok->varId() == 0 &&
+                !(tok->astParent() && tok->astParent()->str() == "." && tok->astParent()->astOperand2() == tok))
+                return 0;
+        } else if (!(tok->isNumber() || tok->tokType() == Token::eString || tok->tokType() == Token::eChar ||
+                     tok->tokType() == Token::eBoolean)) {
+            return 0;
+        }
+        key = tok->str() + '@' + std::to_string(tok->varId());
+    }
+    key += ':' + tok->originalName();
+    key += char('0' + ((tok->isComplex() << 3) | (tok->isLong() << 2) | (tok->isUnsigned() << 1) | tok->isSigned()));
+
+    const std::unordered_map<std::string, unsigned int>::const_iterator it = exprIdMap.find(key);
+    unsigned int id;
+    if (it == exprIdMap.end()) {
+        id = ++exprIdCount;
+        exprIdMap[key] = id;
+    } else
+        id = it->second;
+    tok->exprId(id);
+    return id;
+}
+
+void SymbolDatabase::createSymbolDatabaseExprIds()
+{
+    // the token list may carry ids from a symbol database that was deleted
+    // by simplifyTokenList2() - reset them so ids can't collide
+    for (Token *tok = const_cast<Token *>(mTokenizer->list.front()); tok; tok = tok->next())
+        tok->exprId(0);
+
+    std::unordered_map<std::string, unsigned int> exprIdMap;
+    unsigned int exprIdCount = 0;
+    for (const Scope *scope : functionScopes) {
+        for (Token *tok = const_cast<Token *>(scope->bodyStart); tok != scope->bodyEnd; tok = tok->next())
+            createExprId(tok, exprIdMap, exprIdCount);
+    }
+}
+
 SymbolDatabase::~SymbolDatabase()
 {
+    MemUsage::remove(MemUsage::POOL_SYMBOLS, mAccountedBytes);
+
     // Clear scope, type, function and variable pointers
     for (const Token* tok = mTokenizer->list.front(); tok; tok = tok->next()) {
         const_cast<Token *>(tok)->scope(nullptr);
@@ -1874,7 +1993,7 @@ bool Function::argsMatch(const Scope *scope, const Token *first, const Token *se
 
     unsigned int arg_path_length = path_length;
 
-    while (first->str() == second->str() &&
+    while (first->sameStr(second) &&
            first->isLong() == second->isLong() &&
            first->isUnsigned() == second->isUnsigned()) {
 
@@ -2143,7 +2262,7 @@ void SymbolDatabase::addClassFunction(Scope **scope, const Token **tok, const To
     if (!tok1)
         return;
 
-    std::list<Scope>::iterator it1;
+    std::deque<Scope>::iterator it1;
 
     // search for match
     for (it1 = scopeList.begin(); it1 != scopeList.end(); ++it1) {
@@ -2688,7 +2807,7 @@ void SymbolDatabase::printOut(const char *title) const
     if (title)
         std::cout << "\n### " << title << " ###\n";
 
-    for (std::list<Scope>::const_iterator scope = scopeList.begin(); scope != scopeList.end(); ++scope) {
+    for (std::deque<Scope>::const_iterator scope = scopeList.begin(); scope != scopeList.end(); ++scope) {
         std::cout << "Scope: " << &*scope << " " << scope->type << std::endl;
         std::cout << "    className: " << scope->className << std::endl;
         std::cout << "    classDef: " << tokenToString(scope->classDef, mTokenizer) << std::endl;
@@ -2863,7 +2982,7 @@ void SymbolDatabase::printOut(const char *title) const
         std::cout << std::endl;
     }
 
-    for (std::list<Type>::const_iterator type = typeList.begin(); type != typeList.end(); ++type) {
+    for (std::deque<Type>::const_iterator type = typeList.begin(); type != typeList.end(); ++type) {
         std::cout << "Type: " << &(*type) << std::endl;
         std::cout << "    name: " << type->name() << std::endl;
         std::cout << "    classDef: " << tokenToString(type->classDef, mTokenizer) << std::endl;
@@ -2902,6 +3021,15 @@ void SymbolDatabase::printOut(const char *title) const
 
         std::cout << " )" << std::endl;
 
+        const std::vector<const Type *> &derivedTypes = getDerivedTypes(&(*type));
+        std::cout << "    derivedTypes[" << derivedTypes.size() << "] = (";
+        for (std::size_t i = 0; i < derivedTypes.size(); ++i) {
+            std::cout << " " << derivedTypes[i]->name();
+            if (i+1 < derivedTypes.size())
+                std::cout << ",";
+        }
+        std::cout << " )" << std::endl;
+
         std::cout << "    friendList[" << type->friendList.size() << "] = (";
         for (size_t i = 0; i < type->friendList.size(); i++) {
             if (type->friendList[i].type)
@@ -2937,8 +3065,8 @@ void SymbolDatabase::printXml(std::ostream &out) const
     std::set<const Variable *> variables;
 
     // Scopes..
-    out << "  <scopes>" << std::endl;
-    for (std::list<Scope>::const_iterator scope = scopeList.begin(); scope != scopeList.end(); ++scope) {
+    out << "  <scopes>" << '\n';
+    for (std::deque<Scope>::const_iterator scope = scopeList.begin(); scope != scopeList.end(); ++scope) {
         out << "    <scope";
         out << " id=\"" << &*scope << "\"";
         out << " type=\"" << scope->type << "\"";
@@ -2953,11 +3081,11 @@ void SymbolDatabase::printXml(std::ostream &out) const
         if (scope->function)
             out << " function=\"" << scope->function << "\"";
         if (scope->functionList.empty() && scope->varlist.empty())
-            out << "/>" << std::endl;
+            out << "/>" << '\n';
         else {
-            out << '>' << std::endl;
+            out << '>' << '\n';
             if (!scope->functionList.empty()) {
-                out << "      <functionList>" << std::endl;
+                out << "      <functionList>" << '\n';
                 for (std::list<Function>::const_iterator function = scope->functionList.begin(); function != scope->functionList.end(); ++function) {
                     out << "        <function id=\"" << &*function << "\" tokenDef=\"" << function->tokenDef << "\" name=\"" << ErrorLogger::toxml(function->name()) << '\"';
                     out << " type=\"" << (function->type == Function::eConstructor? "Constructor" :
@@ -2974,34 +3102,34 @@ void SymbolDatabase::printXml(std::ostream &out) const
                             out << " isImplicitlyVirtual=\"true\"";
                     }
                     if (function->argCount() == 0U)
-                        out << "/>" << std::endl;
+                        out << "/>" << '\n';
                     else {
-                        out << ">" << std::endl;
+                        out << ">" << '\n';
                         for (unsigned int argnr = 0; argnr < function->argCount(); ++argnr) {
                             const Variable *arg = function->getArgumentVar(argnr);
-                            out << "          <arg nr=\"" << argnr+1 << "\" variable=\"" << arg << "\"/>" << std::endl;
+                            out << "          <arg nr=\"" << argnr+1 << "\" variable=\"" << arg << "\"/>" << '\n';
                             variables.insert(arg);
                         }
-                        out << "        </function>" << std::endl;
+                        out << "        </function>" << '\n';
                     }
                 }
-                out << "      </functionList>" << std::endl;
+                out << "      </functionList>" << '\n';
             }
             if (!scope->varlist.empty()) {
-                out << "      <varlist>" << std::endl;
+                out << "      <varlist>" << '\n';
                 for (std::list<Variable>::const_iterator var = scope->varlist.begin(); var != scope->varlist.end(); ++var)
-                    out << "        <var id=\""   << &*var << "\"/>" << std::endl;
-                out << "      </varlist>" << std::endl;
+                    out << "        <var id=\""   << &*var << "\"/>" << '\n';
+                out << "      </varlist>" << '\n';
             }
-            out << "    </scope>" << std::endl;
+            out << "    </scope>" << '\n';
         }
     }
-    out << "  </scopes>" << std::endl;
+    out << "  </scopes>" << '\n';
 
     // Variables..
     for (const Variable *var : mVariableList)
         variables.insert(var);
-    out << "  <variables>" << std::endl;
+    out << "  <variables>" << '\n';
     for (const Variable *var : variables) {
         if (!var)
             continue;
@@ -3021,9 +3149,9 @@ void SymbolDatabase::printXml(std::ostream &out) const
         out << " isPointer=\""      << var->isPointer() << '\"';
         out << " isReference=\""    << var->isReference() << '\"';
         out << " isStatic=\""       << var->isStatic() << '\"';
-        out << "/>" << std::endl;
+        out << "/>" << '\n';
     }
-    out << "  </variables>" << std::endl;
+    out << "  </variables>" << '\n';
     out << std::resetiosflags(std::ios::boolalpha);
 }
 
@@ -3200,7 +3328,7 @@ const Function * Function::getOverriddenFunctionRecursive(const ::Type* baseType
 
                 // check for matching return parameters
                 while (temp1->str() != "virtual") {
-                    if (temp1->str() != temp2->str() &&
+                    if (!temp1->sameStr(temp2) &&
                         !(temp1->str() == derivedFromType->name() &&
                           temp2->str() == baseType->name())) {
                         match = false;
@@ -3532,14 +3660,8 @@ const Token *Scope::checkVariable(const Token *tok, AccessControl varaccess, con
 
 const Variable *Scope::getVariable(const std::string &varname) const
 {
-    std::list<Variable>::const_iterator iter;
-
-    for (iter = varlist.begin(); iter != varlist.end(); ++iter) {
-        if (iter->name() == varname)
-            return &*iter;
-    }
-
-    return nullptr;
+    const std::unordered_map<std::string, const Variable *>::const_iterator it = variableMap.find(varname);
+    return it != variableMap.end() ? it->second : nullptr;
 }
 
 static const Token* skipPointers(const Token* tok)
@@ -4048,17 +4170,25 @@ const Function* Scope::findFunction(const Token *tok, bool requireConst) const
 
     // find all the possible functions that could match
     const std::size_t args = arguments.size();
-    for (std::multimap<std::string, const Function *>::const_iterator it = functionMap.find(tok->str()); it != functionMap.cend() && it->first == tok->str(); ++it) {
-        const Function *func = it->second;
-        if (args == func->argCount() ||
-            (func->isVariadic() && args >= (func->argCount() - 1)) ||
-            (args < func->argCount() && args >= func->minArgCount())) {
-            matches.push_back(func);
+    const std::pair<std::string, std::size_t> cacheKey(tok->str(), args);
+    const std::map<std::pair<std::string, std::size_t>, std::vector<const Function *> >::const_iterator cacheIt = functionCandidateCache.find(cacheKey);
+    if (cacheIt != functionCandidateCache.end())
+        matches = cacheIt->second;
+    else {
+        for (std::multimap<std::string, const Function *>::const_iterator it = functionMap.find(tok->str()); it != functionMap.cend() && it->first == tok->str(); ++it) {
+            const Function *func = it->second;
+            if (args == func->argCount() ||
+                (func->isVariadic() && args >= (func->argCount() - 1)) ||
+                (args < func->argCount() && args >= func->minArgCount())) {
+                matches.push_back(func);
+            }
         }
-    }
 
-    // check in base classes
-    findFunctionInBase(tok->str(), args, matches);
+        // check in base classes
+        findFunctionInBase(tok->str(), args, matches);
+
+        functionCandidateCache[cacheKey] = matches;
+    }
 
     const Function* fallback1Func = nullptr;
     const Function* fallback2Func = nullptr;
@@ -4451,7 +4581,7 @@ const Function* SymbolDatabase::findFunction(const Token *tok) const
 
 const Scope *SymbolDatabase::findScopeByName(const std::string& name) const
 {
-    for (std::list<Scope>::const_iterator it = scopeList.begin(); it != scopeList.end(); ++it) {
+    for (std::deque<Scope>::const_iterator it = scopeList.begin(); it != scopeList.end(); ++it) {
         if (it->className == name)
             return &*it;
     }
@@ -4677,6 +4807,15 @@ const Type* SymbolDatabase::findType(const Token *startTok, const Scope *startSc
 
 //---------------------------------------------------------------------------
 
+const std::vector<const Type *> &SymbolDatabase::getDerivedTypes(const Type *type) const
+{
+    static const std::vector<const Type *> emptyTypes;
+    const std::unordered_map<const Type *, std::vector<const Type *> >::const_iterator it = mDerivedTypes.find(type);
+    return (it != mDerivedTypes.end()) ? it->second : emptyTypes;
+}
+
+//---------------------------------------------------------------------------
+
 const Type* SymbolDatabase::findTypeInNested(const Token *startTok, const Scope *startScope) const
 {
     // skip over struct or union
@@ -5170,7 +5309,7 @@ static const Token * parsedecl(const Token *type, ValueType * const valuetype, V
             valuetype->sign = ValueType::Sign::UNSIGNED;
         if (valuetype->type == ValueType::Type::UNKNOWN_TYPE &&
             type->type() && type->type()->isTypeAlias() && type->type()->typeStart &&
-            type->type()->typeStart->str() != type->str())
+            !type->type()->typeStart->sameStr(type))
             parsedecl(type->type()->typeStart, valuetype, defaultSignedness, settings);
         else if (type->str() == "const")
             valuetype->constness |= (1 << (valuetype->pointer - pointer0));
@@ -5276,10 +5415,44 @@ void SymbolDatabase::setValueTypeInTokenList()
 {
     Token * tokens = const_cast<Tokenizer *>(mTokenizer)->list.front();
 
-    for (Token *tok = tokens; tok; tok = tok->next())
+    mDirtyValueTypeRanges.clear();
+    setValueTypesInRange(tokens, nullptr);
+
+    // Update functions with new type information.
+    createSymbolDatabaseSetFunctionPointers(false);
+
+    // Update auto variables with new type information.
+    createSymbolDatabaseSetVariablePointers();
+}
+
+void SymbolDatabase::markValueTypesDirty(Token *start, const Token *end)
+{
+    if (start)
+        mDirtyValueTypeRanges.push_back(std::make_pair(start, end));
+}
+
+void SymbolDatabase::refreshValueTypes()
+{
+    if (mDirtyValueTypeRanges.empty())
+        return;
+
+    for (std::list<std::pair<Token *, const Token *> >::const_iterator it = mDirtyValueTypeRanges.begin(); it != mDirtyValueTypeRanges.end(); ++it)
+        setValueTypesInRange(it->first, it->second);
+    mDirtyValueTypeRanges.clear();
+
+    // Update functions with new type information.
+    createSymbolDatabaseSetFunctionPointers(false);
+
+    // Update auto variables with new type information.
+    createSymbolDatabaseSetVariablePointers();
+}
+
+void SymbolDatabase::setValueTypesInRange(Token *first, const Token *last)
+{
+    for (Token *tok = first; tok && tok != last; tok = tok->next())
         tok->setValueType(nullptr);
 
-    for (Token *tok = tokens; tok; tok = tok->next()) {
+    for (Token *tok = first; tok && tok != last; tok = tok->next()) {
         if (tok->isNumber()) {
             if (MathLib::isFloat(tok->str())) {
                 ValueType::Type type = ValueType::Type::DOUBLE;
@@ -5468,12 +5641,6 @@ void SymbolDatabase::setValueTypeInTokenList()
             setValueType(tok, vt);
         }
     }
-
-    // Update functions with new type information.
-    createSymbolDatabaseSetFunctionPointers(false);
-
-    // Update auto variables with new type information.
-    createSymbolDatabaseSetVariablePointers();
 }
 
 ValueType ValueType::parseDecl(const Token *type, const Settings *settings)
@@ -5562,56 +5729,55 @@ bool ValueType::fromLibraryType(const std::string &typestr, const Settings *sett
     return false;
 }
 
-std::string ValueType::dump() const
+void ValueType::dump(std::ostream &out, bool withTypeScope) const
 {
-    std::ostringstream ret;
     switch (type) {
     case UNKNOWN_TYPE:
-        return "";
+        return;
     case NONSTD:
-        ret << "valueType-type=\"nonstd\"";
+        out << " valueType-type=\"nonstd\"";
         break;
     case RECORD:
-        ret << "valueType-type=\"record\"";
+        out << " valueType-type=\"record\"";
         break;
     case CONTAINER:
-        ret << "valueType-type=\"container\"";
+        out << " valueType-type=\"container\"";
         break;
     case ITERATOR:
-        ret << "valueType-type=\"iterator\"";
+        out << " valueType-type=\"iterator\"";
         break;
     case VOID:
-        ret << "valueType-type=\"void\"";
+        out << " valueType-type=\"void\"";
         break;
     case BOOL:
-        ret << "valueType-type=\"bool\"";
+        out << " valueType-type=\"bool\"";
         break;
     case CHAR:
-        ret << "valueType-type=\"char\"";
+        out << " valueType-type=\"char\"";
         break;
     case SHORT:
-        ret << "valueType-type=\"short\"";
+        out << " valueType-type=\"short\"";
         break;
     case INT:
-        ret << "valueType-type=\"int\"";
+        out << " valueType-type=\"int\"";
         break;
     case LONG:
-        ret << "valueType-type=\"long\"";
+        out << " valueType-type=\"long\"";
         break;
     case LONGLONG:
-        ret << "valueType-type=\"long long\"";
+        out << " valueType-type=\"long long\"";
         break;
     case UNKNOWN_INT:
-        ret << "valueType-type=\"unknown int\"";
+        out << " valueType-type=\"unknown int\"";
         break;
     case FLOAT:
-        ret << "valueType-type=\"float\"";
+        out << " valueType-type=\"float\"";
         break;
     case DOUBLE:
-        ret << "valueType-type=\"double\"";
+        out << " valueType-type=\"double\"";
         break;
     case LONGDOUBLE:
-        ret << "valueType-type=\"long double\"";
+        out << " valueType-type=\"long double\"";
         break;
     };
 
@@ -5619,29 +5785,51 @@ std::string ValueType::dump() const
     case Sign::UNKNOWN_SIGN:
         break;
     case Sign::SIGNED:
-        ret << " valueType-sign=\"signed\"";
+        out << " valueType-sign=\"signed\"";
         break;
     case Sign::UNSIGNED:
-        ret << " valueType-sign=\"unsigned\"";
+        out << " valueType-sign=\"unsigned\"";
         break;
     };
 
     if (bits > 0)
-        ret << " valueType-bits=\"" << bits << '\"';
+        out << " valueType-bits=\"" << bits << '\"';
 
     if (pointer > 0)
-        ret << " valueType-pointer=\"" << pointer << '\"';
+        out << " valueType-pointer=\"" << pointer << '\"';
 
     if (constness > 0)
-        ret << " valueType-constness=\"" << constness << '\"';
+        out << " valueType-constness=\"" << constness << '\"';
 
-    if (typeScope)
-        ret << " valueType-typeScope=\"" << typeScope << '\"';
+    if (withTypeScope && typeScope)
+        out << " valueType-typeScope=\"" << typeScope << '\"';
 
     if (!originalTypeName.empty())
-        ret << " valueType-originalTypeName=\"" << originalTypeName << '\"';
+        out << " valueType-originalTypeName=\"" << originalTypeName << '\"';
+}
 
-    return ret.str();
+unsigned int ValueType::typeBits(const cppcheck::Platform &platform) const
+{
+    // table of the platform field behind each arithmetic type, indexed by
+    // the type id so hot callers get a load instead of a comparison chain
+    static const unsigned int cppcheck::Platform::* const bitField[] = {
+        &cppcheck::Platform::char_bit,      // CHAR
+        &cppcheck::Platform::short_bit,     // SHORT
+        &cppcheck::Platform::int_bit,       // INT
+        &cppcheck::Platform::long_bit,      // LONG
+        &cppcheck::Platform::long_long_bit  // LONGLONG
+    };
+    if (type < ValueType::Type::CHAR || type > ValueType::Type::LONGLONG)
+        return 0;
+    return platform.*bitField[type - ValueType::Type::CHAR];
+}
+
+unsigned int ValueType::promotedTypeBits(const cppcheck::Platform &platform) const
+{
+    // integer promotions: everything below int computes with int width
+    if (type >= ValueType::Type::BOOL && type <= ValueType::Type::INT)
+        return platform.int_bit;
+    return typeBits(platform);
 }
 
 std::string ValueType::str() const
@@ -27,10 +27,12 @@
 #include "token.h"
 
 #include <cstddef>
+#include <deque>
 #include <list>
 #include <map>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -42,6 +44,10 @@ class SymbolDatabase;
 class Tokenizer;
 class ValueType;
 
+namespace cppcheck {
+    class Platform;
+}
+
 /**
  * @brief Access control enumerations.
  */
@@ -940,7 +946,15 @@ public:
     const Token *bodyEnd;    ///< '}' token
     std::list<Function> functionList;
     std::multimap<std::string, const Function *> functionMap;
+    /** overload candidate sets for findFunction, keyed by call name and
+        argument count. The function lists and class hierarchy are fixed once
+        the database is built, so the candidates - including those collected
+        by the recursive base-class walk - only need to be gathered once. */
+    mutable std::map<std::pair<std::string, std::size_t>, std::vector<const Function *> > functionCandidateCache;
     std::list<Variable> varlist;
+    /** name -> variable lookup for getVariable(). Keeps the first variable
+        with each name, matching the old linear search over varlist. */
+    std::unordered_map<std::string, const Variable *> variableMap;
     const Scope *nestedIn;
     std::list<Scope *> nestedList;
     unsigned int numConstructors;
@@ -948,7 +962,7 @@ public:
     std::list<UsingInfo> usingList;
     ScopeType type;
     Type* definedType;
-    std::map<std::string, Type*> definedTypesMap;
+    std::unordered_map<std::string, Type*> definedTypesMap;
 
     // function specific fields
     const Scope *functionOf; ///< scope this function belongs to
@@ -1039,6 +1053,9 @@ public:
         varlist.emplace_back(token_, start_, end_, varlist.size(),
                              access_,
                              type_, scope_, settings);
+        const Variable &var = varlist.back();
+        if (var.nameToken())
+            variableMap.insert(std::make_pair(var.name(), &var));
     }
 
     /** @brief initialize varlist */
@@ -1122,6 +1139,15 @@ public:
         return (type >= ValueType::Type::FLOAT && type <= ValueType::Type::LONGDOUBLE);
     }
 
+    /** Bit width of the type on the given platform: a table lookup for
+     * CHAR..LONGLONG, 0 for everything else. Value propagation asks this
+     * for every truncation/overflow decision, so no comparison chains. */
+    unsigned int typeBits(const cppcheck::Platform &platform) const;
+
+    /** Bit width after the C/C++ integer promotions: BOOL..INT all compute
+     * with int width, 0 for non-promotable types. */
+    unsigned int promotedTypeBits(const cppcheck::Platform &platform) const;
+
     bool fromLibraryType(const std::string &typestr, const Settings *settings);
 
     bool isEnum() const {
@@ -1129,7 +1155,9 @@ public:
     }
 
     std::string str() const;
-    std::string dump() const;
+    /** Write the valueType-* dump attributes. @param withTypeScope write the
+     * typeScope reference, must be false when the scopes are not dumped */
+    void dump(std::ostream &out, bool withTypeScope) const;
 };
 
 
@@ -1139,8 +1167,12 @@ public:
     SymbolDatabase(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger);
     ~SymbolDatabase();
 
-    /** @brief Information about all namespaces/classes/structrues */
-    std::list<Scope> scopeList;
+    /** @brief Information about all namespaces/classes/structrues.
+        Stored in a deque: only ever grown at the back during
+        createSymbolDatabase, so elements stay at stable addresses while
+        iteration streams through contiguous chunks instead of chasing
+        list nodes. */
+    std::deque<Scope> scopeList;
 
     /** @brief Fast access to function scopes */
     std::vector<const Scope *> functionScopes;
@@ -1148,8 +1180,8 @@ public:
     /** @brief Fast access to class and struct scopes */
     std::vector<const Scope *> classAndStructScopes;
 
-    /** @brief Fast access to types */
-    std::list<Type> typeList;
+    /** @brief Fast access to types, see scopeList about the storage */
+    std::deque<Type> typeList;
 
     /**
      * @brief find a variable type if it's a user defined type
@@ -1211,6 +1243,22 @@ public:
     /** Set valuetype in provided tokenlist */
     void setValueTypeInTokenList();
 
+    /**
+     * @brief Mark a token range as needing ValueType recalculation.
+     * Call after the token list was mutated behind the type information's
+     * back. The range is inclusive of @p start and exclusive of @p end
+     * (nullptr means rest of the list) and should cover whole statements
+     * so the AST parents inside it get re-derived too.
+     */
+    void markValueTypesDirty(Token *start, const Token *end);
+
+    /**
+     * @brief Re-derive ValueTypes in the dirty ranges only.
+     * Cheap no-op when nothing was marked; otherwise avoids the full-list
+     * retype pass that setValueTypeInTokenList() performs.
+     */
+    void refreshValueTypes();
+
     /**
      * Calculates sizeof value for given type.
      * @param type Token which will contain e.g. "int", "*", or string.
@@ -1218,6 +1266,16 @@ public:
      */
     unsigned int sizeOfType(const Token *type) const;
 
+    /**
+     * @brief get the types that are directly derived from the given type
+     * The base->derived adjacency is filled in once when the symbol
+     * database is created so hierarchy queries don't need to rescan the
+     * type list.
+     * @param type base type
+     * @return derived types, empty vector if nothing inherits from type
+     */
+    const std::vector<const Type *> &getDerivedTypes(const Type *type) const;
+
 private:
     friend class Scope;
     friend class Function;
@@ -1238,6 +1296,7 @@ private:
     void createSymbolDatabaseSetTypePointers();
     void createSymbolDatabaseEnums();
     void createSymbolDatabaseUnknownArrayDimensions();
+    void createSymbolDatabaseExprIds();
 
     void addClassFunction(Scope **scope, const Token **tok, const Token *argStart);
     Function *addGlobalFunctionDecl(Scope*& scope, const Token* tok, const Token *argStart, const Token* funcStart);
@@ -1263,6 +1322,10 @@ private:
     void setValueType(Token *tok, const Variable &var);
     void setValueType(Token *tok, const Enumerator &enumerator);
 
+    /** worker for setValueTypeInTokenList() / refreshValueTypes():
+     * clear and re-derive the ValueTypes in [first,last) */
+    void setValueTypesInRange(Token *first, const Token *last);
+
     const Tokenizer *mTokenizer;
     const Settings *mSettings;
     ErrorLogger *mErrorLogger;
@@ -1273,9 +1336,19 @@ private:
     /** list for missing types */
     std::list<Type> mBlankTypes;
 
+    /** base -> directly derived types, see getDerivedTypes() */
+    std::unordered_map<const Type *, std::vector<const Type *> > mDerivedTypes;
+
     bool mIsCpp;
     ValueType::Sign mDefaultSignedness;
 
+    /** estimated size in bytes reported to MemUsage, removed again in
+     * the destructor */
+    std::size_t mAccountedBytes;
+
+    /** token ranges whose ValueTypes are stale, see markValueTypesDirty() */
+    std::list<std::pair<Token *, const Token *> > mDirtyValueTypeRanges;
+
     /** "negative cache" list of tokens that we find are not enumeration values */
     mutable std::set<std::string> mTokensThatAreNotEnumeratorValues;
 };
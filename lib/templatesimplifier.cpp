@@ -29,6 +29,7 @@
 #include <cassert>
 #include <iostream>
 #include <stack>
+#include <unordered_map>
 #include <utility>
 
 namespace {
@@ -142,12 +143,20 @@ TemplateSimplifier::TokenAndName::TokenAndName(const TokenAndName& otherTok) :
 
 TemplateSimplifier::TokenAndName::~TokenAndName()
 {
-    if (token)
-        token->templateSimplifierPointers().erase(this);
+    if (token && token->templateSimplifierPointers())
+        token->templateSimplifierPointers()->erase(this);
+}
+
+TemplateExpansionCache::~TemplateExpansionCache()
+{
+    for (std::map<std::string, Entry>::iterator it = entries.begin(); it != entries.end(); ++it)
+        delete it->second.tokens;
 }
 
 TemplateSimplifier::TemplateSimplifier(Tokenizer *tokenizer)
-    : mTokenizer(tokenizer), mTokenList(tokenizer->list), mSettings(tokenizer->mSettings), mErrorLogger(tokenizer->mErrorLogger)
+    : mTokenizer(tokenizer), mTokenList(tokenizer->list), mSettings(tokenizer->mSettings), mErrorLogger(tokenizer->mErrorLogger),
+      mExpandedInstantiations(0), mGeneratedTokens(0), mMaxRecursionDepth(0), mBudgetExceededReported(false),
+      mExpansionCache(nullptr)
 {
 }
 
@@ -1297,6 +1306,11 @@ void TemplateSimplifier::expandTemplate(
 
             if (itype < typeParametersInDeclaration.size()) {
                 typeindentlevel = 0;
+                // build the expanded argument as a detached run and splice it
+                // in front of dst in one operation instead of relinking the
+                // big token list for every token
+                Token * const spliceDest = dst->previous();
+                TokenList argRun(mSettings);
                 for (const Token *typetok = mTypesUsedInTemplateInstantiation[itype].token;
                      typetok && (typeindentlevel > 0 || !Token::Match(typetok, ",|>"));
                      typetok = typetok->next()) {
@@ -1308,12 +1322,15 @@ void TemplateSimplifier::expandTemplate(
                         ++typeindentlevel;
                     else if (typeindentlevel > 0 && typetok->str() == ">")
                         --typeindentlevel;
-                    dst->insertToken(typetok->str(), typetok->originalName(), true);
-                    dst->previous()->isTemplateArg(true);
-                    dst->previous()->isSigned(typetok->isSigned());
-                    dst->previous()->isUnsigned(typetok->isUnsigned());
-                    dst->previous()->isLong(typetok->isLong());
+                    argRun.addtoken(typetok->str(), dst->linenr(), dst->fileIndex());
+                    if (!typetok->originalName().empty())
+                        argRun.back()->originalName(typetok->originalName());
+                    argRun.back()->isTemplateArg(true);
+                    argRun.back()->isSigned(typetok->isSigned());
+                    argRun.back()->isUnsigned(typetok->isUnsigned());
+                    argRun.back()->isLong(typetok->isLong());
                 }
+                mTokenList.spliceTokens(spliceDest, argRun);
             } else {
                 if (isSpecialization && !copy && !scope.empty() && Token::Match(start, (scope + templateDeclarationNameToken->str()).c_str())) {
                     // skip scope
@@ -1949,6 +1966,218 @@ bool TemplateSimplifier::simplifyCalculations(Token* frontToken, Token *backToke
     return ret;
 }
 
+/** Binary operator precedence for the constant expression evaluator.
+ * Outside parentheses "<", ">" and ">>" are template brackets, not
+ * operators. Returns -1 for tokens that are no (allowed) operator. */
+static int constantOperatorPrecedence(const Token *tok, bool insideParens)
+{
+    const std::string &str = tok->str();
+    if (str == "||")
+        return 1;
+    if (str == "&&")
+        return 2;
+    if (str == "|")
+        return 3;
+    if (str == "^")
+        return 4;
+    if (str == "&")
+        return 5;
+    if (str == "==" || str == "!=")
+        return 6;
+    if (str == "<=" || str == ">=")
+        return 7;
+    if (insideParens && (str == "<" || str == ">"))
+        return 7;
+    if (str == "<<")
+        return 8;
+    if (insideParens && str == ">>")
+        return 8;
+    if (str == "+" || str == "-")
+        return 9;
+    if (str == "*" || str == "/" || str == "%")
+        return 10;
+    return -1;
+}
+
+bool TemplateSimplifier::evaluateConstantExpression(const Token *&tok, const Token *end, MathLib::bigint &result, bool insideParens) const
+{
+    MathLib::bigint condition;
+    if (!evaluateConstantBinary(tok, end, condition, insideParens, 1))
+        return false;
+    if (tok != end && tok->str() == "?") {
+        tok = tok->next();
+        MathLib::bigint value1;
+        if (!evaluateConstantExpression(tok, end, value1, insideParens))
+            return false;
+        if (tok == end || tok->str() != ":")
+            return false;
+        tok = tok->next();
+        MathLib::bigint value2;
+        if (!evaluateConstantExpression(tok, end, value2, insideParens))
+            return false;
+        result = condition ? value1 : value2;
+    } else
+        result = condition;
+    return true;
+}
+
+bool TemplateSimplifier::evaluateConstantBinary(const Token *&tok, const Token *end, MathLib::bigint &result, bool insideParens, int minPrecedence) const
+{
+    MathLib::bigint lhs;
+    if (!evaluateConstantUnary(tok, end, lhs, insideParens))
+        return false;
+    while (tok != end) {
+        const int precedence = constantOperatorPrecedence(tok, insideParens);
+        if (precedence < minPrecedence)
+            break;
+        const std::string op = tok->str();
+        tok = tok->next();
+        MathLib::bigint rhs;
+        if (!evaluateConstantBinary(tok, end, rhs, insideParens, precedence + 1))
+            return false;
+        if (op == "||")
+            lhs = (lhs != 0 || rhs != 0) ? 1 : 0;
+        else if (op == "&&")
+            lhs = (lhs != 0 && rhs != 0) ? 1 : 0;
+        else if (op == "==")
+            lhs = (lhs == rhs) ? 1 : 0;
+        else if (op == "!=")
+            lhs = (lhs != rhs) ? 1 : 0;
+        else if (op == "<=")
+            lhs = (lhs <= rhs) ? 1 : 0;
+        else if (op == ">=")
+            lhs = (lhs >= rhs) ? 1 : 0;
+        else if (op == "<")
+            lhs = (lhs < rhs) ? 1 : 0;
+        else if (op == ">")
+            lhs = (lhs > rhs) ? 1 : 0;
+        else if (op == "+")
+            lhs = lhs + rhs;
+        else if (op == "-")
+            lhs = lhs - rhs;
+        else if (op == "*")
+            lhs = lhs * rhs;
+        else if (op == "/" || op == "%") {
+            if (rhs == 0)
+                return false;
+            lhs = (op == "/") ? (lhs / rhs) : (lhs % rhs);
+        } else {
+            // shifting or bitmasking with a negative operand is undefined
+            // or implementation defined behaviour; don't evaluate it, same
+            // as simplifyNumericCalculations()
+            if (lhs < 0 || rhs < 0)
+                return false;
+            if (op == "<<" || op == ">>") {
+                if (rhs >= 64)
+                    return false;
+                lhs = (op == "<<") ? (lhs << rhs) : (lhs >> rhs);
+            } else if (op == "&")
+                lhs = lhs & rhs;
+            else if (op == "|")
+                lhs = lhs | rhs;
+            else if (op == "^")
+                lhs = lhs ^ rhs;
+            else
+                return false;
+        }
+    }
+    result = lhs;
+    return true;
+}
+
+bool TemplateSimplifier::evaluateConstantUnary(const Token *&tok, const Token *end, MathLib::bigint &result, bool insideParens) const
+{
+    if (tok == end)
+        return false;
+    if (Token::Match(tok, "!|~|+|-")) {
+        const char op = tok->str()[0];
+        tok = tok->next();
+        MathLib::bigint value;
+        if (!evaluateConstantUnary(tok, end, value, insideParens))
+            return false;
+        switch (op) {
+        case '!':
+            result = (value == 0) ? 1 : 0;
+            break;
+        case '~':
+            result = ~value;
+            break;
+        case '-':
+            result = -value;
+            break;
+        default:
+            result = value;
+            break;
+        }
+        return true;
+    }
+    if (tok->isNumber()) {
+        if (!MathLib::isInt(tok->str()))
+            return false;
+        result = MathLib::toLongNumber(tok->str());
+        tok = tok->next();
+        return true;
+    }
+    if (tok->str() == "(") {
+        tok = tok->next();
+        if (!evaluateConstantExpression(tok, end, result, true))
+            return false;
+        if (tok == end || tok->str() != ")")
+            return false;
+        tok = tok->next();
+        return true;
+    }
+    if (Token::simpleMatch(tok, "sizeof (") && Token::Match(tok->tokAt(2), "%type% )")) {
+        const unsigned int size = mTokenizer->sizeOfType(tok->tokAt(2));
+        if (size == 0)
+            return false;
+        result = size;
+        tok = tok->tokAt(4);
+        return true;
+    }
+    return false;
+}
+
+void TemplateSimplifier::simplifyTemplateArgConstants(Token *nameToken)
+{
+    if (!Token::Match(nameToken, "%name% <"))
+        return;
+    Token * const closing = nameToken->next()->findClosingBracket();
+    if (!closing)
+        return;
+    Token *argStart = nameToken->tokAt(2);
+    while (argStart && argStart != closing) {
+        // find the end of this argument
+        Token *argEnd = argStart;
+        while (argEnd && argEnd != closing && argEnd->str() != ",") {
+            if (Token::Match(argEnd, "(|[|{")) {
+                if (!argEnd->link())
+                    return;
+                argEnd = argEnd->link();
+            } else if (Token::Match(argEnd, "%name% <") && templateParameters(argEnd->next()) > 0) {
+                Token * const nestedClosing = argEnd->next()->findClosingBracket();
+                if (!nestedClosing)
+                    return;
+                argEnd = nestedClosing;
+            }
+            argEnd = argEnd->next();
+        }
+        if (!argEnd)
+            return;
+        // evaluate the argument in one pass when it is an expression
+        if (argStart->next() != argEnd && argStart != argEnd) {
+            const Token *cursor = argStart;
+            MathLib::bigint value;
+            if (evaluateConstantExpression(cursor, argEnd, value, false) && cursor == argEnd) {
+                argStart->str(MathLib::toString(value));
+                while (argStart->next() != argEnd)
+                    argStart->deleteNext();
+            }
+        }
+        argStart = (argEnd->str() == ",") ? argEnd->next() : argEnd;
+    }
+}
+
 const Token * TemplateSimplifier::getTemplateParametersInDeclaration(
     const Token * tok,
     std::vector<const Token *> & typeParametersInDeclaration)
@@ -2050,6 +2279,204 @@ std::string TemplateSimplifier::getNewName(
     return typeForNewName;
 }
 
+bool TemplateSimplifier::expansionBudgetExceeded(const Token *tok)
+{
+    if (mSettings->maxTemplateTokens == 0 || mGeneratedTokens < mSettings->maxTemplateTokens)
+        return false;
+    if (!mBudgetExceededReported && mErrorLogger) {
+        mBudgetExceededReported = true;
+        std::list<const Token *> callstack(1, tok);
+        mErrorLogger->reportErr(ErrorLogger::ErrorMessage(callstack, &mTokenList, Severity::information, "templateMaxTokens",
+                                "Template instantiation generated more than " + MathLib::toString(mSettings->maxTemplateTokens) +
+                                " tokens (" + MathLib::toString(mExpandedInstantiations) + " instantiations expanded). "
+                                "Remaining templates are not instantiated. Use --max-template-tokens to raise the limit.", false));
+    }
+    return true;
+}
+
+void TemplateSimplifier::recordExpansion(const Token *lastTokenBeforeExpansion, unsigned int recursionDepth)
+{
+    ++mExpandedInstantiations;
+    // expanded code is appended at the end of the token list; in-place
+    // insertions next to the declaration are not counted
+    for (const Token *tok = lastTokenBeforeExpansion ? lastTokenBeforeExpansion->next() : mTokenList.front(); tok; tok = tok->next())
+        ++mGeneratedTokens;
+    if (recursionDepth > mMaxRecursionDepth)
+        mMaxRecursionDepth = recursionDepth;
+    if (mErrorLogger && !mTokenList.getFiles().empty())
+        mErrorLogger->reportProgress(mTokenList.getFiles()[0], "TemplateSimplifier::expandTemplate(): tokens generated", mGeneratedTokens);
+}
+
+/** FNV-1a over the token text and the token flags. The hash goes into the
+ * expansion cache key, so a token run that differs in any way between two
+ * configurations must produce a different value. */
+static unsigned long long hashTokenRun(const Token *start, const Token *end)
+{
+    unsigned long long hash = 0xcbf29ce484222325ULL;
+    for (const Token *tok = start; tok; tok = tok->next()) {
+        for (std::size_t i = 0; i < tok->str().size(); ++i)
+            hash = (hash ^ (unsigned char)tok->str()[i]) * 0x100000001b3ULL;
+        hash = (hash ^ 0xffU) * 0x100000001b3ULL; // token separator
+        hash = (hash ^ tok->flags()) * 0x100000001b3ULL;
+        if (tok == end)
+            break;
+    }
+    return hash;
+}
+
+std::string TemplateSimplifier::expansionCacheKey(
+    const TokenAndName &templateDeclaration,
+    const TokenAndName &templateInstantiation,
+    const std::string &newName) const
+{
+    if (!mExpansionCache)
+        return "";
+
+    // Only self-contained class expansions are cached. Function and
+    // variable templates insert their forward declarations in the middle
+    // of the token list and specializations are expanded in place.
+    if (!templateDeclaration.isClass() || templateDeclaration.isSpecialization() || templateDeclaration.isVariable())
+        return "";
+
+    // declaration: template < ... > class name ... { body }
+    const Token *bodyStart = templateDeclaration.nameToken;
+    while (bodyStart && !Token::Match(bodyStart, "{|;|("))
+        bodyStart = bodyStart->next();
+    if (!Token::simpleMatch(bodyStart, "{") || !bodyStart->link())
+        return "";
+
+    // instantiation arguments: name < ... >
+    const Token * const argsEnd = templateInstantiation.token->next() ? templateInstantiation.token->next()->findClosingBracket() : nullptr;
+    if (!argsEnd)
+        return "";
+
+    const unsigned long long declarationHash = hashTokenRun(templateDeclaration.token, bodyStart->link());
+    const unsigned long long argumentsHash = hashTokenRun(templateInstantiation.token, argsEnd);
+
+    return templateDeclaration.fullName + " " + newName + " # " +
+           std::to_string(declarationHash) + " " + std::to_string(argumentsHash);
+}
+
+bool TemplateSimplifier::replayExpansion(
+    const std::string &cacheKey,
+    const TokenAndName &templateDeclaration,
+    const TokenAndName &templateInstantiation,
+    const std::string &newName)
+{
+    const std::map<std::string, TemplateExpansionCache::Entry>::const_iterator entryIt = mExpansionCache->entries.find(cacheKey);
+    if (entryIt == mExpansionCache->entries.end())
+        return false;
+    const TemplateExpansionCache::Entry &entry = entryIt->second;
+
+    // add the forward declaration, same as expandTemplate()
+    templateDeclaration.token->insertToken(templateDeclaration.paramEnd->strAt(1), "", true);
+    templateDeclaration.token->insertToken(newName, "", true);
+    templateDeclaration.token->insertToken(";", "", true);
+
+    // check if this is an explicit instantiation, same as expandTemplate()
+    Token * start = templateInstantiation.token;
+    while (start && !Token::Match(start->previous(), "}|;|extern"))
+        start = start->previous();
+    if (Token::Match(start, "template !!<")) {
+        if (start->strAt(-1) == "extern")
+            start = start->previous();
+        mExplicitInstantiationsToDelete.emplace_back(start, "");
+    }
+
+    // copy the cached run to the end of the token list
+    std::map<const Token *, Token *> copied;
+    for (const Token *tok = entry.tokens->front(); tok; tok = tok->next()) {
+        mTokenList.addtoken(tok, tok->linenr(), tok->fileIndex());
+        copied[tok] = mTokenList.back();
+    }
+    for (const Token *tok = entry.tokens->front(); tok; tok = tok->next()) {
+        if (tok->link())
+            copied[tok]->link(copied[tok->link()]);
+    }
+
+    // register the nested instantiations that were found in the expansion
+    for (std::size_t i = 0; i < entry.instantiations.size(); ++i)
+        mTemplateInstantiations.emplace_back(copied[entry.instantiations[i].first], entry.instantiations[i].second);
+
+    return true;
+}
+
+void TemplateSimplifier::cacheExpansion(
+    const std::string &cacheKey,
+    const Token *lastTokenBeforeExpansion,
+    std::size_t instantiationCountBefore,
+    std::size_t memberFunctionCountBefore)
+{
+    // out of line member functions depend on tokens outside the hashed
+    // declaration, so such expansions are not transferable
+    if (mMemberFunctionsToDelete.size() != memberFunctionCountBefore)
+        return;
+
+    const Token * const first = lastTokenBeforeExpansion ? lastTokenBeforeExpansion->next() : nullptr;
+    const Token * const last = mTokenList.back();
+    if (!first || !last)
+        return;
+
+    // the self-contained run is "class|struct name ... { ... } ;"
+    if (!Token::Match(first, "class|struct") || !Token::simpleMatch(last, ";") || !Token::simpleMatch(last->previous(), "}"))
+        return;
+    const Token * const bodyStart = last->previous()->link();
+    if (!bodyStart)
+        return;
+    for (const Token *tok = first; tok != bodyStart; tok = tok->next()) {
+        if (!tok || tok == last)
+            return;
+    }
+
+    std::map<const Token *, Token *> copied;
+    TokenList *cachedTokens = new TokenList(mSettings);
+    for (const Token *tok = first; tok; tok = tok->next()) {
+        cachedTokens->addtoken(tok, tok->linenr(), tok->fileIndex());
+        copied[tok] = cachedTokens->back();
+    }
+    for (const Token *tok = first; tok; tok = tok->next()) {
+        if (!tok->link())
+            continue;
+        const std::map<const Token *, Token *>::const_iterator it = copied.find(tok->link());
+        if (it == copied.end()) {
+            // link leaves the expanded run
+            delete cachedTokens;
+            return;
+        }
+        copied[tok]->link(it->second);
+    }
+
+    TemplateExpansionCache::Entry entry(cachedTokens);
+
+    // remember the nested instantiations that expandTemplate() registered
+    std::list<TokenAndName>::const_iterator instIt = mTemplateInstantiations.begin();
+    std::advance(instIt, instantiationCountBefore);
+    for (; instIt != mTemplateInstantiations.end(); ++instIt) {
+        const std::map<const Token *, Token *>::const_iterator it = copied.find(instIt->token);
+        if (it == copied.end()) {
+            delete cachedTokens;
+            return;
+        }
+        entry.instantiations.push_back(std::make_pair(static_cast<const Token *>(it->second), instIt->scope));
+    }
+
+    mExpansionCache->entries.insert(std::make_pair(cacheKey, entry));
+}
+
+bool TemplateSimplifier::isReferencedDeclaration(const TokenAndName &templateDeclaration) const
+{
+    // Instantiations inside template definitions are not collected by
+    // getTemplateInstantiations() (#7914); they only enter the list when
+    // the enclosing template is expanded. The list therefore already
+    // describes what is reachable from the checked code, so a declaration
+    // whose name never occurs in it can't be instantiated by anything.
+    for (const TokenAndName &instantiation : mTemplateInstantiations) {
+        if (instantiation.token && instantiation.name == templateDeclaration.name)
+            return true;
+    }
+    return false;
+}
+
 bool TemplateSimplifier::simplifyTemplateInstantiations(
     const TokenAndName &templateDeclaration,
     const std::list<const Token *> &specializations,
@@ -2074,10 +2501,17 @@ bool TemplateSimplifier::simplifyTemplateInstantiations(
 
     bool instantiated = false;
 
+    // instantiations whose usages have already been rewritten by
+    // replaceTemplateUsage(). That function scans the whole token list and
+    // rewrites every matching usage at once, so repeating it for an
+    // identical instantiation is a full-list scan that finds nothing.
+    std::set<std::string> replacedUsages;
+
     for (const TokenAndName &instantiation : mTemplateInstantiations) {
         if (numberOfTemplateInstantiations != mTemplateInstantiations.size()) {
             numberOfTemplateInstantiations = mTemplateInstantiations.size();
             simplifyCalculations(instantiation.token);
+            replacedUsages.clear();
             ++recursiveCount;
             if (recursiveCount > 100) {
                 // bail out..
@@ -2107,12 +2541,8 @@ bool TemplateSimplifier::simplifyTemplateInstantiations(
         Token * const tok2 = instantiation.token;
         if (mErrorLogger && !mTokenList.getFiles().empty())
             mErrorLogger->reportProgress(mTokenList.getFiles()[0], "TemplateSimplifier::simplifyTemplateInstantiations()", tok2->progressValue());
-#ifdef MAXTIME
-        if (std::time(0) > maxtime)
+        if (maxtime > 0 && std::time(0) > maxtime)
             return false;
-#else
-        (void)maxtime;
-#endif
         assert(mTokenList.validateToken(tok2)); // that assertion fails on examples from #6021
 
         const Token *startToken = tok2;
@@ -2132,6 +2562,11 @@ bool TemplateSimplifier::simplifyTemplateInstantiations(
             (!specialized && !instantiateMatch(tok2, typeParametersInDeclaration.size(), isfunc ? "(" : isVar ? ";|%op%" : "*|&| %name%")))
             continue;
 
+        // Evaluate constant argument expressions in one pass so that
+        // recursive instantiations like "Factorial < 4 - 1 >" don't rely
+        // on the iterative pairwise folding in simplifyCalculations()
+        simplifyTemplateArgConstants(tok2);
+
         // New type..
         mTypesUsedInTemplateInstantiation.clear();
         std::list<std::string> typeStringsUsedInTemplateInstantiation;
@@ -2153,13 +2588,30 @@ bool TemplateSimplifier::simplifyTemplateInstantiations(
         const std::string newFullName(templateDeclaration.scope + (templateDeclaration.scope.empty() ? "" : " :: ") + newName);
 
         if (expandedtemplates.find(newFullName) == expandedtemplates.end()) {
+            if (expansionBudgetExceeded(tok2))
+                continue;
             expandedtemplates.insert(newFullName);
-            expandTemplate(templateDeclaration, instantiation, typeParametersInDeclaration, newName, !specialized && !isVar);
+            const Token * const lastTokenBeforeExpansion = mTokenList.back();
+            const std::string cacheKey = expansionCacheKey(templateDeclaration, instantiation, newName);
+            if (cacheKey.empty() || !replayExpansion(cacheKey, templateDeclaration, instantiation, newName)) {
+                const std::size_t instantiationCountBefore = mTemplateInstantiations.size();
+                const std::size_t memberFunctionCountBefore = mMemberFunctionsToDelete.size();
+                expandTemplate(templateDeclaration, instantiation, typeParametersInDeclaration, newName, !specialized && !isVar);
+                if (!cacheKey.empty())
+                    cacheExpansion(cacheKey, lastTokenBeforeExpansion, instantiationCountBefore, memberFunctionCountBefore);
+            }
+            recordExpansion(lastTokenBeforeExpansion, recursiveCount);
             instantiated = true;
         }
 
         // Replace all these template usages..
-        replaceTemplateUsage(instantiation, typeStringsUsedInTemplateInstantiation, newName);
+        std::string usageKey(newFullName);
+        for (const std::string &typeString : typeStringsUsedInTemplateInstantiation) {
+            usageKey += ' ';
+            usageKey += typeString;
+        }
+        if (replacedUsages.insert(usageKey).second)
+            replaceTemplateUsage(instantiation, typeStringsUsedInTemplateInstantiation, newName);
     }
 
     // process uninstantiated templates
@@ -2170,12 +2622,8 @@ bool TemplateSimplifier::simplifyTemplateInstantiations(
         Token * tok2 = const_cast<Token *>(templateDeclaration.nameToken);
         if (mErrorLogger && !mTokenList.getFiles().empty())
             mErrorLogger->reportProgress(mTokenList.getFiles()[0], "TemplateSimplifier::simplifyTemplateInstantiations()", tok2->progressValue());
-#ifdef MAXTIME
-        if (std::time(0) > maxtime)
+        if (maxtime > 0 && std::time(0) > maxtime)
             return false;
-#else
-        (void)maxtime;
-#endif
         assert(mTokenList.validateToken(tok2)); // that assertion fails on examples from #6021
 
         Token *startToken = tok2;
@@ -2202,6 +2650,8 @@ bool TemplateSimplifier::simplifyTemplateInstantiations(
         if (!matchSpecialization(templateDeclaration.nameToken, tok2, specializations))
             return false;
 
+        simplifyTemplateArgConstants(tok2);
+
         // New type..
         mTypesUsedInTemplateInstantiation.clear();
         std::list<std::string> typeStringsUsedInTemplateInstantiation;
@@ -2221,8 +2671,12 @@ bool TemplateSimplifier::simplifyTemplateInstantiations(
         const std::string newFullName(templateDeclaration.scope + (templateDeclaration.scope.empty() ? "" : " :: ") + newName);
 
         if (expandedtemplates.find(newFullName) == expandedtemplates.end()) {
+            if (expansionBudgetExceeded(tok2))
+                return false;
             expandedtemplates.insert(newFullName);
+            const Token * const lastTokenBeforeExpansion = mTokenList.back();
             expandTemplate(templateDeclaration, templateDeclaration, typeParametersInDeclaration, newName, !specialized && !isVar);
+            recordExpansion(lastTokenBeforeExpansion, recursiveCount);
             instantiated = true;
         }
 
@@ -2261,12 +2715,12 @@ void TemplateSimplifier::replaceTemplateUsage(
             Token::Match(nameTok, "template|const_cast|dynamic_cast|reinterpret_cast|static_cast"))
             continue;
 
-        std::set<TemplateSimplifier::TokenAndName*> & pointers = nameTok->templateSimplifierPointers();
+        const std::set<TemplateSimplifier::TokenAndName*> * const pointers = nameTok->templateSimplifierPointers();
 
         // check if instantiation matches token instantiation from pointer
-        if (pointers.size()) {
+        if (pointers && pointers->size()) {
             // check full name
-            if (instantiation.fullName != (*pointers.begin())->fullName) {
+            if (instantiation.fullName != (*pointers->begin())->fullName) {
                 // FIXME:  fallback to just matching name
                 if (nameTok->str() != instantiation.name)
                     continue;
@@ -2322,7 +2776,7 @@ void TemplateSimplifier::replaceTemplateUsage(
             nameTok->str(newName);
 
             for (Token *tok = nameTok1->next(); tok != tok2; tok = tok->next()) {
-                if (tok->isName() && !tok->templateSimplifierPointers().empty()) {
+                if (tok->isName() && tok->templateSimplifierPointers() && !tok->templateSimplifierPointers()->empty()) {
                     std::list<TokenAndName>::iterator ti;
                     for (ti = mTemplateInstantiations.begin(); ti != mTemplateInstantiations.end();) {
                         if (ti->token == tok) {
@@ -2347,28 +2801,36 @@ void TemplateSimplifier::replaceTemplateUsage(
 
 void TemplateSimplifier::getSpecializations()
 {
+    // name-keyed indexes so each specialization is matched without
+    // rescanning the declaration lists
+    std::unordered_map<std::string, std::vector<const TokenAndName *> > declarationIndex;
+    for (const auto & decl : mTemplateDeclarations) {
+        if (!decl.isSpecialization())
+            declarationIndex[decl.fullName].push_back(&decl);
+    }
+    std::unordered_map<std::string, std::vector<const TokenAndName *> > forwardIndex;
+    for (const auto & decl : mTemplateForwardDeclarations)
+        forwardIndex[decl.fullName].push_back(&decl);
+
     // try to locate a matching declaration for each user defined specialization
     for (auto & spec : mTemplateDeclarations) {
         if (spec.isSpecialization()) {
             bool found = false;
-            for (auto & decl : mTemplateDeclarations) {
-                if (decl.isSpecialization())
-                    continue;
-
-                // make sure the scopes and names match
-                if (spec.fullName == decl.fullName) {
+            const auto it = declarationIndex.find(spec.fullName);
+            if (it != declarationIndex.end()) {
+                for (const TokenAndName *decl : it->second) {
                     // @todo make sure function parameters also match
-                    mTemplateSpecializationMap[spec.token] = decl.token;
+                    mTemplateSpecializationMap[spec.token] = decl->token;
                     found = true;
                 }
             }
 
             if (!found) {
-                for (auto & decl : mTemplateForwardDeclarations) {
-                    // make sure the scopes and names match
-                    if (spec.fullName == decl.fullName) {
+                const auto fit = forwardIndex.find(spec.fullName);
+                if (fit != forwardIndex.end()) {
+                    for (const TokenAndName *decl : fit->second) {
                         // @todo make sure function parameters also match
-                        mTemplateSpecializationMap[spec.token] = decl.token;
+                        mTemplateSpecializationMap[spec.token] = decl->token;
                     }
                 }
             }
@@ -2378,28 +2840,36 @@ void TemplateSimplifier::getSpecializations()
 
 void TemplateSimplifier::getPartialSpecializations()
 {
+    // name-keyed indexes so each partial specialization is matched without
+    // rescanning the declaration lists
+    std::unordered_map<std::string, std::vector<const TokenAndName *> > declarationIndex;
+    for (const auto & decl : mTemplateDeclarations) {
+        if (!decl.isPartialSpecialization())
+            declarationIndex[decl.fullName].push_back(&decl);
+    }
+    std::unordered_map<std::string, std::vector<const TokenAndName *> > forwardIndex;
+    for (const auto & decl : mTemplateForwardDeclarations)
+        forwardIndex[decl.fullName].push_back(&decl);
+
     // try to locate a matching declaration for each user defined partial specialization
     for (auto & spec : mTemplateDeclarations) {
         if (spec.isPartialSpecialization()) {
             bool found = false;
-            for (auto & decl : mTemplateDeclarations) {
-                if (decl.isPartialSpecialization())
-                    continue;
-
-                // make sure the scopes and names match
-                if (spec.fullName == decl.fullName) {
+            const auto it = declarationIndex.find(spec.fullName);
+            if (it != declarationIndex.end()) {
+                for (const TokenAndName *decl : it->second) {
                     // @todo make sure function parameters also match
-                    mTemplatePartialSpecializationMap[spec.token] = decl.token;
+                    mTemplatePartialSpecializationMap[spec.token] = decl->token;
                     found = true;
                 }
             }
 
             if (!found) {
-                for (auto & decl : mTemplateForwardDeclarations) {
-                    // make sure the scopes and names match
-                    if (spec.fullName == decl.fullName) {
+                const auto fit = forwardIndex.find(spec.fullName);
+                if (fit != forwardIndex.end()) {
+                    for (const TokenAndName *decl : fit->second) {
                         // @todo make sure function parameters also match
-                        mTemplatePartialSpecializationMap[spec.token] = decl.token;
+                        mTemplatePartialSpecializationMap[spec.token] = decl->token;
                     }
                 }
             }
@@ -2409,16 +2879,27 @@ void TemplateSimplifier::getPartialSpecializations()
 
 void TemplateSimplifier::fixForwardDeclaredDefaultArgumentValues()
 {
+    // name-keyed index so each forward declaration is matched without
+    // rescanning the whole declaration list
+    std::unordered_map<std::string, std::vector<TokenAndName *> > declarationIndex;
+    for (auto & decl : mTemplateDeclarations) {
+        // skip partializations
+        if (!decl.isPartialSpecialization())
+            declarationIndex[decl.fullName].push_back(&decl);
+    }
+
     // try to locate a matching declaration for each forward declaration
     for (const auto & forwardDecl : mTemplateForwardDeclarations) {
+        const auto it = declarationIndex.find(forwardDecl.fullName);
+        if (it == declarationIndex.end())
+            continue;
+
         std::vector<const Token *> params1;
 
         getTemplateParametersInDeclaration(forwardDecl.token->tokAt(2), params1);
 
-        for (auto & decl : mTemplateDeclarations) {
-            // skip partializations
-            if (decl.isPartialSpecialization())
-                continue;
+        for (TokenAndName *declPtr : it->second) {
+            TokenAndName &decl = *declPtr;
 
             std::vector<const Token *> params2;
 
@@ -2426,8 +2907,7 @@ void TemplateSimplifier::fixForwardDeclaredDefaultArgumentValues()
 
             // make sure the number of arguments match
             if (params1.size() == params2.size()) {
-                // make sure the scopes and names match
-                if (forwardDecl.fullName == decl.fullName) {
+                {
                     // save forward declaration for lookup later
                     if ((decl.nameToken->strAt(1) == "(" && forwardDecl.nameToken->strAt(1) == "(") ||
                         (decl.nameToken->strAt(1) == "{" && forwardDecl.nameToken->strAt(1) == ";")) {
@@ -3112,6 +3592,13 @@ void TemplateSimplifier::simplifyTemplates(
         std::set<std::string> expandedtemplates;
 
         for (std::list<TokenAndName>::reverse_iterator iter1 = mTemplateDeclarations.rbegin(); iter1 != mTemplateDeclarations.rend(); ++iter1) {
+            // Skip declarations nothing references. Check against the live
+            // instantiation list because expanding one template can register
+            // instantiations of another. User specializations are expanded
+            // in place even without an instantiation so they are kept.
+            if (!iter1->isSpecialization() && !isReferencedDeclaration(*iter1))
+                continue;
+
             // get specializations..
             std::list<const Token *> specializations;
             for (std::list<TokenAndName>::const_iterator iter2 = mTemplateDeclarations.begin(); iter2 != mTemplateDeclarations.end(); ++iter2) {
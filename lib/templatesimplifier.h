@@ -23,12 +23,15 @@
 //---------------------------------------------------------------------------
 
 #include "config.h"
+#include "mathlib.h"
 
+#include <cstddef>
 #include <ctime>
 #include <list>
 #include <map>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 class ErrorLogger;
@@ -40,6 +43,42 @@ class TokenList;
 /// @addtogroup Core
 /// @{
 
+/**
+ * @brief Cross-configuration cache of template expansion output.
+ *
+ * When a file is checked under several preprocessor configurations, most
+ * template instantiations are identical in every configuration and
+ * expandTemplate() recreates the same tokens from scratch each time.
+ * The expansion output only depends on the declaration tokens and the
+ * argument tokens, so CppCheck::checkFile keeps one cache per file and
+ * hands it to the tokenizer of every configuration; self-contained class
+ * expansions are then copied from the cache instead of being expanded
+ * again.
+ */
+class CPPCHECKLIB TemplateExpansionCache {
+public:
+    TemplateExpansionCache() {}
+    ~TemplateExpansionCache();
+
+    /** One cached expansion: the token run that expandTemplate() appended
+     * at the end of the token list, together with the nested template
+     * instantiations that were found in it so they can be registered
+     * again when the run is replayed. */
+    struct Entry {
+        explicit Entry(TokenList *tokenList) : tokens(tokenList) {}
+        /** detached copy of the expanded tokens, owned by the cache */
+        TokenList *tokens;
+        /** nested instantiations: name token in @c tokens + its scope */
+        std::vector<std::pair<const Token *, std::string> > instantiations;
+    };
+
+    std::map<std::string, Entry> entries;
+
+private:
+    TemplateExpansionCache(const TemplateExpansionCache &);
+    TemplateExpansionCache &operator=(const TemplateExpansionCache &);
+};
+
 /** @brief Simplify templates from the preprocessed and partially simplified code. */
 class CPPCHECKLIB TemplateSimplifier {
 public:
@@ -218,6 +257,14 @@ public:
         const std::time_t maxtime,
         bool &codeWithTemplates);
 
+    /**
+     * Set the expansion cache that is shared by all configurations of the
+     * file. No expansions are cached or replayed when it is not set.
+     */
+    void setExpansionCache(TemplateExpansionCache *cache) {
+        mExpansionCache = cache;
+    }
+
     /**
      * Simplify constant calculations such as "1+2" => "3"
      * @param tok start token
@@ -274,6 +321,16 @@ private:
      */
     void simplifyTemplateAliases();
 
+    /**
+     * Check whether some located instantiation references the declaration.
+     * Declarations nothing references (typical for header-only libraries
+     * where most of the template machinery is never touched) don't need
+     * to be processed by simplifyTemplateInstantiations() at all.
+     * @param templateDeclaration template declaration
+     * @return true if an instantiation with a matching name exists
+     */
+    bool isReferencedDeclaration(const TokenAndName &templateDeclaration) const;
+
     /**
      * Simplify templates : expand all instantiations for a template
      * @todo It seems that inner templates should be instantiated recursively
@@ -384,6 +441,80 @@ private:
         const std::string &indent = "    ") const;
     void printOut(const std::string &text = "") const;
 
+    /**
+     * One-pass recursive-descent evaluation of a constant expression:
+     * integer arithmetic, comparisons, simple ternaries and sizeof of
+     * basic types. Unlike the iterative rewriting in
+     * simplifyCalculations() the value is computed directly, without
+     * re-running pairwise token folding until fixpoint.
+     * @param tok cursor, advanced past the parsed expression on success
+     * @param end first token after the expression
+     * @param result receives the value of the expression
+     * @param insideParens inside parentheses "<", ">" and ">>" lose
+     *        their template bracket meaning and are parsed as operators
+     * @return true if the expression could be evaluated
+     */
+    bool evaluateConstantExpression(const Token *&tok, const Token *end, MathLib::bigint &result, bool insideParens) const;
+    bool evaluateConstantBinary(const Token *&tok, const Token *end, MathLib::bigint &result, bool insideParens, int minPrecedence) const;
+    bool evaluateConstantUnary(const Token *&tok, const Token *end, MathLib::bigint &result, bool insideParens) const;
+
+    /**
+     * Collapse constant template argument expressions to their value in
+     * one pass, e.g. "A < 2 * 3 + 1 >" => "A < 7 >". Arguments that are
+     * not constant expressions are left alone; the iterative
+     * simplifyCalculations() passes remain as fallback for them.
+     * @param nameToken template name token "name <"
+     */
+    void simplifyTemplateArgConstants(Token *nameToken);
+
+    /**
+     * Build the expansion cache key for one instantiation, or return an
+     * empty string when the expansion cannot be cached. Only
+     * self-contained class expansions qualify; function and variable
+     * templates insert tokens in the middle of the token list. The key
+     * hashes the declaration tokens and the argument tokens, so a
+     * declaration that changes between configurations gets its own entry.
+     */
+    std::string expansionCacheKey(
+        const TokenAndName &templateDeclaration,
+        const TokenAndName &templateInstantiation,
+        const std::string &newName) const;
+
+    /**
+     * Copy a cached expansion to the end of the token list instead of
+     * calling expandTemplate().
+     * @return true if a cache entry was found and replayed
+     */
+    bool replayExpansion(
+        const std::string &cacheKey,
+        const TokenAndName &templateDeclaration,
+        const TokenAndName &templateInstantiation,
+        const std::string &newName);
+
+    /**
+     * Store the output of the expandTemplate() call that just finished.
+     * Nothing is stored when the expansion turned out not to be
+     * self-contained (out of line member functions, links leaving the
+     * expanded run).
+     */
+    void cacheExpansion(
+        const std::string &cacheKey,
+        const Token *lastTokenBeforeExpansion,
+        std::size_t instantiationCountBefore,
+        std::size_t memberFunctionCountBefore);
+
+    /**
+     * Has the expansion budget (Settings::maxTemplateTokens) been used up?
+     * Writes a one-shot information message when the budget is first hit.
+     */
+    bool expansionBudgetExceeded(const Token *tok);
+
+    /**
+     * Update the expansion telemetry counters after expandTemplate() and
+     * surface them through ErrorLogger::reportProgress.
+     */
+    void recordExpansion(const Token *lastTokenBeforeExpansion, unsigned int recursionDepth);
+
     bool simplifyUsing();
 
     Tokenizer *mTokenizer;
@@ -401,6 +532,21 @@ private:
     std::list<TokenAndName> mMemberFunctionsToDelete;
     std::vector<TokenAndName> mExplicitInstantiationsToDelete;
     std::vector<TokenAndName> mTypesUsedInTemplateInstantiation;
+
+    /** @brief number of template instantiations expanded in this TU */
+    unsigned int mExpandedInstantiations;
+
+    /** @brief number of tokens generated by template expansion in this TU */
+    std::size_t mGeneratedTokens;
+
+    /** @brief deepest recursive instantiation depth seen in this TU */
+    unsigned int mMaxRecursionDepth;
+
+    /** @brief expansion budget information message already written */
+    bool mBudgetExceededReported;
+
+    /** @brief cross-configuration expansion cache, not owned. nullptr = disabled */
+    TemplateExpansionCache *mExpansionCache;
 };
 
 /// @}
@@ -19,13 +19,16 @@
 #include "timer.h"
 
 #include <algorithm>
+#include <chrono>
+#include <functional>
 #include <iostream>
+#include <ostream>
+#include <thread>
 #include <utility>
 #include <vector>
 /*
     TODO:
     - rename "file" to "single"
-    - synchronise map access in multithreaded mode or disable timing
     - add unit tests
         - for --showtime (needs input file)
         - for Timer* classes
@@ -37,13 +40,44 @@ namespace {
     {
         return lhs.second.seconds() > rhs.second.seconds();
     }
+
+    // the timers currently running in this thread; gives a started timer
+    // its parent so nested passes aggregate under the enclosing phase
+    thread_local std::vector<const std::string *> activeTimers;
+
+    double secondsSinceProcessStart()
+    {
+        static const std::chrono::steady_clock::time_point processStart = std::chrono::steady_clock::now();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - processStart).count();
+    }
+}
+
+bool MemUsage::enabled = false;
+std::atomic<unsigned long long> MemUsage::mAllocated[MemUsage::POOL_COUNT];
+std::atomic<long long> MemUsage::mLive[MemUsage::POOL_COUNT];
+std::atomic<long long> MemUsage::mHighWater[MemUsage::POOL_COUNT];
+
+const char *MemUsage::poolName(Pool pool)
+{
+    switch (pool) {
+    case POOL_TOKENS:
+        return "tokens";
+    case POOL_VALUES:
+        return "valueflow values";
+    case POOL_SYMBOLS:
+        return "symbol database";
+    default:
+        return "";
+    }
 }
 
 void TimerResults::ShowResults(SHOWTIME_MODES mode) const
 {
-    if (mode == SHOWTIME_NONE)
+    if (mode == SHOWTIME_NONE || mode == SHOWTIME_REPORT)
         return;
 
+    std::lock_guard<std::mutex> lock(mSync);
+
     std::cout << std::endl;
     TimerResultsData overallData;
 
@@ -54,32 +88,107 @@ void TimerResults::ShowResults(SHOWTIME_MODES mode) const
     for (std::vector<dataElementType>::const_iterator iter=data.begin() ; iter!=data.end(); ++iter) {
         const double sec = iter->second.seconds();
         const double secAverage = sec / (double)(iter->second.mNumberOfResults);
-        overallData.mClocks += iter->second.mClocks;
+        // a nested timer's time is already included in its parent, only
+        // top level timers count towards the overall time
+        if (iter->first.find('/') == std::string::npos)
+            overallData.mClocks += iter->second.mClocks;
         if ((mode != SHOWTIME_TOP5) || (ordinal<=5)) {
-            std::cout << iter->first << ": " << sec << "s (avg. " << secAverage << "s - " << iter->second.mNumberOfResults  << " result(s))" << std::endl;
+            std::cout << iter->first << ": " << sec << "s (avg. " << secAverage << "s - " << iter->second.mNumberOfResults  << " result(s))";
+            if (iter->second.mAllocBytes > 0)
+                std::cout << " - " << (double)iter->second.mAllocBytes / (1024.0 * 1024.0) << " MB allocated";
+            std::cout << std::endl;
         }
         ++ordinal;
     }
 
     const double secOverall = overallData.seconds();
     std::cout << "Overall time: " << secOverall << "s" << std::endl;
+
+    if (MemUsage::enabled) {
+        std::cout << "Peak memory:";
+        for (int pool = 0; pool < MemUsage::POOL_COUNT; ++pool) {
+            std::cout << (pool == 0 ? " " : ", ") << MemUsage::poolName((MemUsage::Pool)pool) << " "
+                      << (double)MemUsage::highWaterBytes((MemUsage::Pool)pool) / (1024.0 * 1024.0) << " MB";
+        }
+        std::cout << std::endl;
+    }
 }
 
 void TimerResults::AddResults(const std::string& str, std::clock_t clocks)
 {
+    std::lock_guard<std::mutex> lock(mSync);
     mResults[str].mClocks += clocks;
     mResults[str].mNumberOfResults++;
 }
 
+void TimerResults::AddAllocations(const std::string& str, unsigned long long bytes)
+{
+    std::lock_guard<std::mutex> lock(mSync);
+    mResults[str].mAllocBytes += bytes;
+}
+
+void TimerResults::AddTraceEvent(const std::string& name, double beginSeconds, double durationSeconds, unsigned long long threadId)
+{
+    if (!mCollectTraceEvents)
+        return;
+    std::lock_guard<std::mutex> lock(mSync);
+    TraceEvent event;
+    event.name = name;
+    event.beginSeconds = beginSeconds;
+    event.durationSeconds = durationSeconds;
+    event.threadId = threadId;
+    mTraceEvents.push_back(event);
+}
+
+void TimerResults::writeChromeTrace(std::ostream &out, int pid) const
+{
+    std::lock_guard<std::mutex> lock(mSync);
+    out << "[";
+    for (std::vector<TraceEvent>::const_iterator i = mTraceEvents.begin(); i != mTraceEvents.end(); ++i) {
+        if (i != mTraceEvents.begin())
+            out << ",";
+        out << "\n{\"name\":\"";
+        for (const char c : i->name) {
+            // the names may carry file paths - escape for JSON
+            if (c == '"' || c == '\\')
+                out << '\\';
+            out << c;
+        }
+        out << "\",\"ph\":\"X\",\"pid\":" << pid << ",\"tid\":" << i->threadId
+            << ",\"ts\":" << (unsigned long long)(i->beginSeconds * 1E6)
+            << ",\"dur\":" << (unsigned long long)(i->durationSeconds * 1E6) << "}";
+    }
+    out << "\n]\n";
+}
+
+double Timer::wallSeconds()
+{
+    return secondsSinceProcessStart();
+}
+
+unsigned long long Timer::threadId()
+{
+    return (unsigned long long)std::hash<std::thread::id>()(std::this_thread::get_id());
+}
+
 Timer::Timer(const std::string& str, unsigned int showtimeMode, TimerResultsIntf* timerResults)
-    : mStr(str)
+    : mLabel(str)
+    , mPath(str)
     , mTimerResults(timerResults)
     , mStart(0)
+    , mWallStart(0.0)
+    , mAllocStart(0)
     , mShowTimeMode(showtimeMode)
     , mStopped(false)
 {
-    if (showtimeMode != SHOWTIME_NONE)
+    if (showtimeMode != SHOWTIME_NONE) {
+        if (!activeTimers.empty())
+            mPath = *activeTimers.back() + "/" + str;
+        activeTimers.push_back(&mPath);
+        mWallStart = secondsSinceProcessStart();
+        mAllocStart = MemUsage::totalAllocatedBytes();
         mStart = std::clock();
+    }
 }
 
 Timer::~Timer()
@@ -92,13 +201,21 @@ void Timer::Stop()
     if ((mShowTimeMode != SHOWTIME_NONE) && !mStopped) {
         const std::clock_t end = std::clock();
         const std::clock_t diff = end - mStart;
+        // timers are scoped objects, the innermost one stops first
+        activeTimers.pop_back();
 
         if (mShowTimeMode == SHOWTIME_FILE) {
             const double sec = (double)diff / CLOCKS_PER_SEC;
-            std::cout << mStr << ": " << sec << "s" << std::endl;
+            std::cout << mPath << ": " << sec << "s" << std::endl;
         } else {
-            if (mTimerResults)
-                mTimerResults->AddResults(mStr, diff);
+            if (mTimerResults) {
+                mTimerResults->AddResults(mPath, diff);
+                if (MemUsage::enabled)
+                    mTimerResults->AddAllocations(mPath, MemUsage::totalAllocatedBytes() - mAllocStart);
+                mTimerResults->AddTraceEvent(mLabel, mWallStart,
+                                             secondsSinceProcessStart() - mWallStart,
+                                             threadId());
+            }
         }
     }
 
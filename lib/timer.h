@@ -22,15 +22,81 @@
 
 #include "config.h"
 
+#include <atomic>
+#include <cstddef>
 #include <ctime>
+#include <iosfwd>
 #include <map>
+#include <mutex>
 #include <string>
+#include <vector>
 
 enum SHOWTIME_MODES {
     SHOWTIME_NONE = 0,
     SHOWTIME_FILE,
     SHOWTIME_SUMMARY,
-    SHOWTIME_TOP5
+    SHOWTIME_TOP5,
+    /** collect the timings but print nothing, used for --perf-report */
+    SHOWTIME_REPORT
+};
+
+/**
+ * Optional allocation accounting for the big memory pools: the tokens,
+ * the valueflow values and the symbol database. Enabled together with
+ * the timers, so "cppcheck ran out of memory on file X" can be
+ * diagnosed from --showtime / --perf-report output instead of an
+ * external massif run. The counters are atomic since the executor runs
+ * the checks in parallel threads.
+ */
+class CPPCHECKLIB MemUsage {
+public:
+    enum Pool { POOL_TOKENS = 0, POOL_VALUES, POOL_SYMBOLS, POOL_COUNT };
+
+    /** set once before the checking starts, read-only while checking */
+    static bool enabled;
+
+    static void add(Pool pool, std::size_t bytes) {
+        if (!enabled)
+            return;
+        mAllocated[pool].fetch_add(bytes, std::memory_order_relaxed);
+        const long long liveNow = mLive[pool].fetch_add((long long)bytes, std::memory_order_relaxed) + (long long)bytes;
+        long long highWater = mHighWater[pool].load(std::memory_order_relaxed);
+        while (liveNow > highWater && !mHighWater[pool].compare_exchange_weak(highWater, liveNow, std::memory_order_relaxed))
+            ;
+    }
+
+    static void remove(Pool pool, std::size_t bytes) {
+        if (!enabled)
+            return;
+        mLive[pool].fetch_sub((long long)bytes, std::memory_order_relaxed);
+    }
+
+    /** cumulative bytes handed out by the pool, only grows */
+    static unsigned long long allocatedBytes(Pool pool) {
+        return mAllocated[pool].load(std::memory_order_relaxed);
+    }
+
+    /** most bytes the pool held at the same time */
+    static long long highWaterBytes(Pool pool) {
+        return mHighWater[pool].load(std::memory_order_relaxed);
+    }
+
+    /** cumulative bytes over all pools, sampled by the timers */
+    static unsigned long long totalAllocatedBytes() {
+        unsigned long long total = 0;
+        for (int pool = 0; pool < POOL_COUNT; ++pool)
+            total += mAllocated[pool].load(std::memory_order_relaxed);
+        return total;
+    }
+
+    static const char *poolName(Pool pool);
+
+private:
+    static std::atomic<unsigned long long> mAllocated[POOL_COUNT];
+    /** signed: objects created before the accounting was enabled may be
+     * freed after, letting a pool go slightly negative */
+    static std::atomic<long long> mLive[POOL_COUNT];
+    static std::atomic<long long> mHighWater[POOL_COUNT];
 };
 
 class CPPCHECKLIB TimerResultsIntf {
@@ -38,15 +104,26 @@ public:
     virtual ~TimerResultsIntf() { }
 
     virtual void AddResults(const std::string& str, std::clock_t clocks) = 0;
+
+    /** Bytes the pools handed out while a timer ran. The default
+     * ignores them - only the summary/report output needs them. */
+    virtual void AddAllocations(const std::string& /*str*/, unsigned long long /*bytes*/) { }
+
+    /** A timer finished; begin is wall clock seconds since the process
+     * started. The default ignores the event - only trace export needs it. */
+    virtual void AddTraceEvent(const std::string& /*name*/, double /*beginSeconds*/, double /*durationSeconds*/, unsigned long long /*threadId*/) { }
 };
 
 struct TimerResultsData {
     std::clock_t mClocks;
     long mNumberOfResults;
+    /** bytes the pools handed out while the timer ran, see MemUsage */
+    unsigned long long mAllocBytes;
 
     TimerResultsData()
         : mClocks(0)
-        , mNumberOfResults(0) {
+        , mNumberOfResults(0)
+        , mAllocBytes(0) {
     }
 
     double seconds() const {
@@ -57,14 +134,45 @@ struct TimerResultsData {
 
 class CPPCHECKLIB TimerResults : public TimerResultsIntf {
 public:
-    TimerResults() {
+    TimerResults() : mCollectTraceEvents(false) {
     }
 
     void ShowResults(SHOWTIME_MODES mode) const;
     void AddResults(const std::string& str, std::clock_t clocks) OVERRIDE;
+    void AddAllocations(const std::string& str, unsigned long long bytes) OVERRIDE;
+    void AddTraceEvent(const std::string& name, double beginSeconds, double durationSeconds, unsigned long long threadId) OVERRIDE;
+
+    /** Collect the individual timer runs needed by writeChromeTrace().
+     * Off by default since a big run produces a lot of them. */
+    void collectTraceEvents(bool collect) {
+        mCollectTraceEvents = collect;
+    }
+
+    /** Write the collected timer runs in the Chrome trace event format,
+     * loadable in chrome://tracing and compatible viewers. The pid tells
+     * the events of the executor's worker processes apart after merging. */
+    void writeChromeTrace(std::ostream &out, int pid = 1) const;
+
+    /** The results, keyed by the timer path. Nested timers use
+     * "parent/child" paths so the hierarchy is visible in the key. */
+    const std::map<std::string, struct TimerResultsData> &results() const {
+        return mResults;
+    }
 
 private:
+    struct TraceEvent {
+        std::string name;
+        double beginSeconds;
+        double durationSeconds;
+        unsigned long long threadId;
+    };
+
+    /** AddResults/AddTraceEvent are called concurrently when the executor
+     * runs the checks in parallel threads */
+    mutable std::mutex mSync;
     std::map<std::string, struct TimerResultsData> mResults;
+    std::vector<TraceEvent> mTraceEvents;
+    bool mCollectTraceEvents;
 };
 
 class CPPCHECKLIB Timer {
@@ -73,13 +181,27 @@ public:
     ~Timer();
     void Stop();
 
+    /** wall clock seconds since the process started; the time base of
+     * the trace events */
+    static double wallSeconds();
+
+    /** id of the current thread as written into the trace events */
+    static unsigned long long threadId();
+
 private:
     Timer(const Timer& other); // disallow copying
     Timer& operator=(const Timer&); // disallow assignments
 
-    const std::string mStr;
+    /** the label the timer was started with; the trace events use it
+     * since the viewers nest the events by their timestamps */
+    const std::string mLabel;
+    /** full path of the timer: the enclosing timers of this thread
+     * joined with '/', so nested passes aggregate under their parent */
+    std::string mPath;
     TimerResultsIntf* mTimerResults;
     std::clock_t mStart;
+    double mWallStart;
+    unsigned long long mAllocStart;
     const unsigned int mShowTimeMode;
     bool mStopped;
 };
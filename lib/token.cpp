@@ -23,8 +23,10 @@
 #include "library.h"
 #include "settings.h"
 #include "symboldatabase.h"
+#include "timer.h"
 #include "utils.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cctype>
 #include <cstring>
@@ -32,85 +34,271 @@
 #include <map>
 #include <set>
 #include <stack>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 
-const std::list<ValueFlow::Value> TokenImpl::mEmptyValueList;
+const ValueFlow::ValueList TokenImpl::mEmptyValueList;
+
+namespace {
+    /**
+     * Slab allocator for the fixed-size Token and TokenImpl objects.
+     *
+     * A token list easily contains millions of tokens, so allocating each of
+     * them with a bare operator new is dominated by allocator overhead and
+     * scatters consecutive tokens all over the heap. Instead, carve tokens
+     * out of large slabs; freed tokens are kept in a free list for reuse so
+     * simplifications that delete and insert tokens recycle hot memory.
+     * The pool is thread local because tokens never move between threads.
+     */
+    class TokenSlabPool {
+    public:
+        explicit TokenSlabPool(std::size_t objectSize)
+            : mObjectSize(objectSize)
+            , mFreeList(nullptr)
+            , mSlabUsed(slabObjectCount) {
+        }
+
+        ~TokenSlabPool() {
+            for (std::size_t i = 0; i < mSlabs.size(); ++i)
+                ::operator delete(mSlabs[i]);
+        }
+
+        void *allocate() {
+            if (mFreeList) {
+                void *ptr = mFreeList;
+                mFreeList = mFreeList->next;
+                return ptr;
+            }
+            if (mSlabUsed >= slabObjectCount) {
+                char * const slab = static_cast<char *>(::operator new(mObjectSize * slabObjectCount));
+#ifdef COMPACT_TOKENS
+                const std::pair<const char *, unsigned int> entry(slab, (unsigned int)mSlabs.size());
+                mSortedSlabs.insert(std::upper_bound(mSortedSlabs.begin(), mSortedSlabs.end(), entry), entry);
+#endif
+                mSlabs.push_back(slab);
+                mSlabUsed = 0;
+            }
+            return mSlabs.back() + (mSlabUsed++) * mObjectSize;
+        }
+
+        void deallocate(void *ptr) {
+            FreeNode *node = static_cast<FreeNode *>(ptr);
+            node->next = mFreeList;
+            mFreeList = node;
+        }
+
+#ifdef COMPACT_TOKENS
+        /** Index of the pool object at @p ptr, for encoding compact references */
+        unsigned int indexOf(const void *ptr) const {
+            const char * const p = static_cast<const char *>(ptr);
+            // the first slab with a base address above p, then step back to the slab that contains p
+            std::vector<std::pair<const char *, unsigned int> >::const_iterator it =
+                std::upper_bound(mSortedSlabs.begin(), mSortedSlabs.end(), std::pair<const char *, unsigned int>(p, ~0U));
+            if (it != mSortedSlabs.begin()) {
+                --it;
+                const std::size_t offset = p - it->first;
+                if (offset < mObjectSize * slabObjectCount)
+                    return it->second * (unsigned int)slabObjectCount + (unsigned int)(offset / mObjectSize);
+            }
+            // a stack allocated token was linked into the token graph
+            throw InternalError(nullptr, "Internal error. Compact reference to a token that is not pool allocated.");
+        }
+
+        /** The pool object with the given index, for decoding compact references */
+        void *objectAt(unsigned int index) const {
+            return mSlabs[index / slabObjectCount] + (index % slabObjectCount) * mObjectSize;
+        }
+#endif
+
+    private:
+        struct FreeNode {
+            FreeNode *next;
+        };
+
+        static const std::size_t slabObjectCount = 4096;
+
+        const std::size_t mObjectSize;
+        FreeNode *mFreeList;
+        std::size_t mSlabUsed;
+        std::vector<char *> mSlabs;
+#ifdef COMPACT_TOKENS
+        /** (base address, slab number) pairs sorted by address, for indexOf() */
+        std::vector<std::pair<const char *, unsigned int> > mSortedSlabs;
+#endif
+    };
+
+    TokenSlabPool *tokenPool()
+    {
+        static thread_local TokenSlabPool pool(sizeof(Token));
+        return &pool;
+    }
+
+    TokenSlabPool *tokenImplPool()
+    {
+        static thread_local TokenSlabPool pool(sizeof(TokenImpl));
+        return &pool;
+    }
+}
+
+void *Token::operator new(std::size_t size)
+{
+    if (size != sizeof(Token)) // play it safe for exotic callers
+        return ::operator new(size);
+    return tokenPool()->allocate();
+}
+
+void Token::operator delete(void *ptr, std::size_t size)
+{
+    if (!ptr)
+        return;
+    // the sized form keeps delete symmetric with the fallback in operator new
+    if (size != sizeof(Token))
+        ::operator delete(ptr);
+    else
+        tokenPool()->deallocate(ptr);
+}
+
+#ifdef COMPACT_TOKENS
+Token *refToken(TokenRef ref)
+{
+    return ref ? static_cast<Token *>(tokenPool()->objectAt(ref - 1U)) : nullptr;
+}
+
+TokenRef tokenRef(const Token *tok)
+{
+    return tok ? tokenPool()->indexOf(tok) + 1U : 0U;
+}
+#endif
+
+void *TokenImpl::operator new(std::size_t size)
+{
+    if (size != sizeof(TokenImpl))
+        return ::operator new(size);
+    return tokenImplPool()->allocate();
+}
+
+void TokenImpl::operator delete(void *ptr, std::size_t size)
+{
+    if (!ptr)
+        return;
+    if (size != sizeof(TokenImpl))
+        ::operator delete(ptr);
+    else
+        tokenImplPool()->deallocate(ptr);
+}
+
+const std::string *Token::intern(const std::string &s)
+{
+    static thread_local std::unordered_set<std::string> pool;
+    // the insert only copies the text the first time it is seen
+    return &*pool.insert(s).first;
+}
+
+void Token::setStr(const std::string &s)
+{
+    mStr = intern(s);
+    mImpl->mVarId = 0;
+
+    update_property_info();
+}
 
 Token::Token(TokensFrontBack *tokensFrontBack) :
     mTokensFrontBack(tokensFrontBack),
-    mNext(nullptr),
-    mPrevious(nullptr),
-    mLink(nullptr),
+    mStr(intern(emptyString)),
+    mNext(TokenRef()),
+    mPrevious(TokenRef()),
+    mLink(TokenRef()),
     mTokType(eNone),
     mFlags(0)
 {
     mImpl = new TokenImpl();
+    MemUsage::add(MemUsage::POOL_TOKENS, sizeof(Token) + sizeof(TokenImpl));
 }
 
 Token::~Token()
 {
     delete mImpl;
+    MemUsage::remove(MemUsage::POOL_TOKENS, sizeof(Token) + sizeof(TokenImpl));
 }
 
-static const std::set<std::string> controlFlowKeywords = {
-    "goto",
-    "do",
-    "if",
-    "else",
-    "for",
-    "while",
-    "switch",
-    "case",
-    "break",
-    "continue",
-    "return"
-};
+// Classification of tokens happens for every str() assignment, so the closed
+// keyword sets are dispatched on the first character and then checked with a
+// single string comparison instead of a set lookup.
+static bool isControlFlowKeywordStr(const std::string &str)
+{
+    if (str.empty())
+        return false;
+    switch (str[0]) {
+    case 'b':
+        return str == "break";
+    case 'c':
+        return str == "case" || str == "continue";
+    case 'd':
+        return str == "do";
+    case 'e':
+        return str == "else";
+    case 'f':
+        return str == "for";
+    case 'g':
+        return str == "goto";
+    case 'i':
+        return str == "if";
+    case 'r':
+        return str == "return";
+    case 's':
+        return str == "switch";
+    case 'w':
+        return str == "while";
+    }
+    return false;
+}
 
 void Token::update_property_info()
 {
-    setFlag(fIsControlFlowKeyword, controlFlowKeywords.find(mStr) != controlFlowKeywords.end());
+    setFlag(fIsControlFlowKeyword, isControlFlowKeywordStr(str()));
 
-    if (!mStr.empty()) {
-        if (mStr == "true" || mStr == "false")
+    if (!str().empty()) {
+        if (str() == "true" || str() == "false")
             tokType(eBoolean);
-        else if (std::isalpha((unsigned char)mStr[0]) || mStr[0] == '_' || mStr[0] == '$') { // Name
+        else if (std::isalpha((unsigned char)str()[0]) || str()[0] == '_' || str()[0] == '$') { // Name
             if (mImpl->mVarId)
                 tokType(eVariable);
             else if (mTokType != eVariable && mTokType != eFunction && mTokType != eType && mTokType != eKeyword)
                 tokType(eName);
-        } else if (std::isdigit((unsigned char)mStr[0]) || (mStr.length() > 1 && mStr[0] == '-' && std::isdigit((unsigned char)mStr[1])))
+        } else if (std::isdigit((unsigned char)str()[0]) || (str().length() > 1 && str()[0] == '-' && std::isdigit((unsigned char)str()[1])))
             tokType(eNumber);
-        else if (mStr.length() > 1 && mStr[0] == '"' && endsWith(mStr,'"'))
+        else if (str().length() > 1 && str()[0] == '"' && endsWith(str(),'"'))
             tokType(eString);
-        else if (mStr.length() > 1 && mStr[0] == '\'' && endsWith(mStr,'\''))
+        else if (str().length() > 1 && str()[0] == '\'' && endsWith(str(),'\''))
             tokType(eChar);
-        else if (mStr == "=" || mStr == "<<=" || mStr == ">>=" ||
-                 (mStr.size() == 2U && mStr[1] == '=' && std::strchr("+-*/%&^|", mStr[0])))
+        else if (str() == "=" || str() == "<<=" || str() == ">>=" ||
+                 (str().size() == 2U && str()[1] == '=' && std::strchr("+-*/%&^|", str()[0])))
             tokType(eAssignmentOp);
-        else if (mStr.size() == 1 && mStr.find_first_of(",[]()?:") != std::string::npos)
+        else if (str().size() == 1 && str().find_first_of(",[]()?:") != std::string::npos)
             tokType(eExtendedOp);
-        else if (mStr=="<<" || mStr==">>" || (mStr.size()==1 && mStr.find_first_of("+-*/%") != std::string::npos))
+        else if (str()=="<<" || str()==">>" || (str().size()==1 && str().find_first_of("+-*/%") != std::string::npos))
             tokType(eArithmeticalOp);
-        else if (mStr.size() == 1 && mStr.find_first_of("&|^~") != std::string::npos)
+        else if (str().size() == 1 && str().find_first_of("&|^~") != std::string::npos)
             tokType(eBitOp);
-        else if (mStr.size() <= 2 &&
-                 (mStr == "&&" ||
-                  mStr == "||" ||
-                  mStr == "!"))
+        else if (str().size() <= 2 &&
+                 (str() == "&&" ||
+                  str() == "||" ||
+                  str() == "!"))
             tokType(eLogicalOp);
-        else if (mStr.size() <= 2 && !mLink &&
-                 (mStr == "==" ||
-                  mStr == "!=" ||
-                  mStr == "<"  ||
-                  mStr == "<=" ||
-                  mStr == ">"  ||
-                  mStr == ">="))
+        else if (str().size() <= 2 && !mLink &&
+                 (str() == "==" ||
+                  str() == "!=" ||
+                  str() == "<"  ||
+                  str() == "<=" ||
+                  str() == ">"  ||
+                  str() == ">="))
             tokType(eComparisonOp);
-        else if (mStr.size() == 2 &&
-                 (mStr == "++" ||
-                  mStr == "--"))
+        else if (str().size() == 2 &&
+                 (str() == "++" ||
+                  str() == "--"))
             tokType(eIncDecOp);
-        else if (mStr.size() == 1 && (mStr.find_first_of("{}") != std::string::npos || (mLink && mStr.find_first_of("<>") != std::string::npos)))
+        else if (str().size() == 1 && (str().find_first_of("{}") != std::string::npos || (mLink && str().find_first_of("<>") != std::string::npos)))
             tokType(eBracket);
         else
             tokType(eOther);
@@ -121,27 +309,41 @@ void Token::update_property_info()
     update_property_isStandardType();
 }
 
-static const std::set<std::string> stdTypes = { "bool"
-                                                , "_Bool"
-                                                , "char"
-                                                , "double"
-                                                , "float"
-                                                , "int"
-                                                , "long"
-                                                , "short"
-                                                , "size_t"
-                                                , "void"
-                                                , "wchar_t"
-                                              };
+static bool isStandardTypeName(const std::string &str)
+{
+    switch (str[0]) {
+    case '_':
+        return str == "_Bool";
+    case 'b':
+        return str == "bool";
+    case 'c':
+        return str == "char";
+    case 'd':
+        return str == "double";
+    case 'f':
+        return str == "float";
+    case 'i':
+        return str == "int";
+    case 'l':
+        return str == "long";
+    case 's':
+        return str == "short" || str == "size_t";
+    case 'v':
+        return str == "void";
+    case 'w':
+        return str == "wchar_t";
+    }
+    return false;
+}
 
 void Token::update_property_isStandardType()
 {
     isStandardType(false);
 
-    if (mStr.size() < 3)
+    if (str().size() < 3)
         return;
 
-    if (stdTypes.find(mStr)!=stdTypes.end()) {
+    if (isStandardTypeName(str())) {
         isStandardType(true);
         tokType(eType);
     }
@@ -152,8 +354,8 @@ bool Token::isUpperCaseName() const
 {
     if (!isName())
         return false;
-    for (size_t i = 0; i < mStr.length(); ++i) {
-        if (std::islower(mStr[i]))
+    for (size_t i = 0; i < str().length(); ++i) {
+        if (std::islower(str()[i]))
             return false;
     }
     return true;
@@ -161,8 +363,10 @@ bool Token::isUpperCaseName() const
 
 void Token::concatStr(std::string const& b)
 {
-    mStr.erase(mStr.length() - 1);
-    mStr.append(b.begin() + 1, b.end());
+    std::string newStr(*mStr);
+    newStr.erase(newStr.length() - 1);
+    newStr.append(b.begin() + 1, b.end());
+    mStr = intern(newStr);
 
     update_property_info();
 }
@@ -170,7 +374,7 @@ void Token::concatStr(std::string const& b)
 std::string Token::strValue() const
 {
     assert(mTokType == eString);
-    std::string ret(mStr.substr(1, mStr.length() - 2));
+    std::string ret(str().substr(1, str().length() - 2));
     std::string::size_type pos = 0U;
     while ((pos = ret.find('\\', pos)) != std::string::npos) {
         ret.erase(pos,1U);
@@ -192,19 +396,20 @@ std::string Token::strValue() const
 void Token::deleteNext(unsigned long index)
 {
     while (mNext && index) {
-        Token *n = mNext;
+        Token *n = refToken(mNext);
 
         // #8154 we are about to be unknown -> destroy the link to us
-        if (n->mLink && n->mLink->mLink == n)
-            n->mLink->link(nullptr);
+        Token * const nLink = n->link();
+        if (nLink && nLink->link() == n)
+            nLink->link(nullptr);
 
-        mNext = n->next();
+        mNext = tokenRef(n->next());
         delete n;
         --index;
     }
 
     if (mNext)
-        mNext->previous(this);
+        refToken(mNext)->previous(this);
     else if (mTokensFrontBack)
         mTokensFrontBack->back = this;
 }
@@ -212,19 +417,20 @@ void Token::deleteNext(unsigned long index)
 void Token::deletePrevious(unsigned long index)
 {
     while (mPrevious && index) {
-        Token *p = mPrevious;
+        Token *p = refToken(mPrevious);
 
         // #8154 we are about to be unknown -> destroy the link to us
-        if (p->mLink && p->mLink->mLink == p)
-            p->mLink->link(nullptr);
+        Token * const pLink = p->link();
+        if (pLink && pLink->link() == p)
+            pLink->link(nullptr);
 
-        mPrevious = p->previous();
+        mPrevious = tokenRef(p->previous());
         delete p;
         --index;
     }
 
     if (mPrevious)
-        mPrevious->next(this);
+        refToken(mPrevious)->next(this);
     else if (mTokensFrontBack)
         mTokensFrontBack->front = this;
 }
@@ -232,22 +438,27 @@ void Token::deletePrevious(unsigned long index)
 void Token::swapWithNext()
 {
     if (mNext) {
-        std::swap(mStr, mNext->mStr);
-        std::swap(mTokType, mNext->mTokType);
-        std::swap(mFlags, mNext->mFlags);
-        std::swap(mImpl, mNext->mImpl);
-        for (auto templateSimplifierPointer : mImpl->mTemplateSimplifierPointers) {
-            templateSimplifierPointer->token = this;
+        Token * const nextTok = refToken(mNext);
+        std::swap(mStr, nextTok->mStr);
+        std::swap(mTokType, nextTok->mTokType);
+        std::swap(mFlags, nextTok->mFlags);
+        std::swap(mImpl, nextTok->mImpl);
+        if (mImpl->mTemplateSimplifierPointers) {
+            for (auto templateSimplifierPointer : *mImpl->mTemplateSimplifierPointers) {
+                templateSimplifierPointer->token = this;
+            }
         }
 
-        for (auto templateSimplifierPointer : mNext->mImpl->mTemplateSimplifierPointers) {
-            templateSimplifierPointer->token = mNext;
+        if (nextTok->mImpl->mTemplateSimplifierPointers) {
+            for (auto templateSimplifierPointer : *nextTok->mImpl->mTemplateSimplifierPointers) {
+                templateSimplifierPointer->token = nextTok;
+            }
         }
-        if (mNext->mLink)
-            mNext->mLink->mLink = this;
+        if (nextTok->mLink)
+            refToken(nextTok->mLink)->mLink = tokenRef(this);
         if (this->mLink)
-            this->mLink->mLink = mNext;
-        std::swap(mLink, mNext->mLink);
+            refToken(this->mLink)->mLink = tokenRef(nextTok);
+        std::swap(mLink, nextTok->mLink);
     }
 }
 
@@ -259,26 +470,28 @@ void Token::takeData(Token *fromToken)
     delete mImpl;
     mImpl = fromToken->mImpl;
     fromToken->mImpl = nullptr;
-    for (auto templateSimplifierPointer : mImpl->mTemplateSimplifierPointers) {
-        templateSimplifierPointer->token = this;
+    if (mImpl->mTemplateSimplifierPointers) {
+        for (auto templateSimplifierPointer : *mImpl->mTemplateSimplifierPointers) {
+            templateSimplifierPointer->token = this;
+        }
     }
     mLink = fromToken->mLink;
     if (mLink)
-        mLink->link(this);
+        refToken(mLink)->link(this);
 }
 
 void Token::deleteThis()
 {
     if (mNext) { // Copy next to this and delete next
-        takeData(mNext);
-        mNext->link(nullptr); // mark as unlinked
+        takeData(refToken(mNext));
+        refToken(mNext)->link(nullptr); // mark as unlinked
         deleteNext();
-    } else if (mPrevious && mPrevious->mPrevious) { // Copy previous to this and delete previous
-        takeData(mPrevious);
+    } else if (mPrevious && refToken(mPrevious)->mPrevious) { // Copy previous to this and delete previous
+        Token* toDelete = refToken(mPrevious);
+        takeData(toDelete);
 
-        Token* toDelete = mPrevious;
-        mPrevious = mPrevious->mPrevious;
-        mPrevious->mNext = this;
+        mPrevious = toDelete->mPrevious;
+        refToken(mPrevious)->mNext = tokenRef(this);
 
         delete toDelete;
     } else {
@@ -347,7 +560,7 @@ const Token *Token::linkAt(int index) const
 const std::string &Token::strAt(int index) const
 {
     const Token *tok = this->tokAt(index);
-    return tok ? tok->mStr : emptyString;
+    return tok ? tok->str() : emptyString;
 }
 
 static int multiComparePercent(const Token *tok, const char*& haystack, unsigned int varid)
@@ -552,7 +765,7 @@ bool Token::simpleMatch(const Token *tok, const char pattern[])
     while (*current) {
         const std::size_t length = next - current;
 
-        if (!tok || length != tok->mStr.length() || std::strncmp(current, tok->mStr.c_str(), length))
+        if (!tok || length != tok->str().length() || std::strncmp(current, tok->str().c_str(), length))
             return false;
 
         current = next;
@@ -595,87 +808,131 @@ const char *Token::chrInFirstWord(const char *str, char c)
     }
 }
 
+namespace {
+    /**
+     * One word of a Token::Match pattern, classified when the pattern is
+     * compiled so matching does not re-parse the pattern text on every call.
+     */
+    struct MatchStep {
+        enum Kind { Simple, CharClass, Not, Multi } kind;
+
+        /** Simple: exact token text. CharClass: characters after the leading
+         * '['. Not: text after "!!". Multi: the whole alternative list. */
+        std::string word;
+
+        /** CharClass: number of ']' characters in word */
+        unsigned int closingBrackets;
+    };
+
+    typedef std::vector<MatchStep> CompiledMatchPattern;
+
+    /**
+     * Compile a Token::Match pattern to a step program. Literal patterns are
+     * precompiled by tools/matchcompiler.py in optimized builds, but patterns
+     * built at runtime (user rules, library-driven matching, concatenated
+     * pattern strings) used to be re-parsed on every call. The compiled form
+     * is cached by pattern text; matching then executes the steps directly.
+     */
+    const CompiledMatchPattern *compileMatchPattern(const char pattern[])
+    {
+        static thread_local std::unordered_map<std::string, CompiledMatchPattern> cache;
+        const std::unordered_map<std::string, CompiledMatchPattern>::const_iterator cacheIt = cache.find(pattern);
+        if (cacheIt != cache.end())
+            return &cacheIt->second;
+
+        CompiledMatchPattern compiled;
+        const char *p = pattern;
+        while (*p) {
+            while (*p == ' ')
+                ++p;
+            if (*p == '\0')
+                break;
+            const char *end = p;
+            while (*end && *end != ' ')
+                ++end;
+            const std::string word(p, end);
+
+            MatchStep step;
+            step.closingBrackets = 0;
+            if (word[0] == '[' && word.find(']', 1) != std::string::npos) {
+                step.kind = MatchStep::CharClass;
+                step.word = word.substr(1);
+                for (std::size_t i = 0; i < step.word.size(); ++i) {
+                    if (step.word[i] == ']')
+                        ++step.closingBrackets;
+                }
+            } else if (word.size() > 2 && word[0] == '!' && word[1] == '!') {
+                step.kind = MatchStep::Not;
+                step.word = word.substr(2);
+            } else if (word.find_first_of("%|") == std::string::npos) {
+                step.kind = MatchStep::Simple;
+                step.word = word;
+            } else {
+                step.kind = MatchStep::Multi;
+                step.word = word;
+            }
+            compiled.push_back(step);
+
+            p = end;
+        }
+
+        return &cache.insert(std::make_pair(std::string(pattern), std::move(compiled))).first->second;
+    }
+}
+
 bool Token::Match(const Token *tok, const char pattern[], unsigned int varid)
 {
-    const char *p = pattern;
-    while (*p) {
-        // Skip spaces in pattern..
-        while (*p == ' ')
-            ++p;
+    const CompiledMatchPattern * const compiled = compileMatchPattern(pattern);
 
-        // No token => Success!
-        if (*p == '\0')
-            break;
+    for (std::size_t i = 0; i < compiled->size(); ++i) {
+        const MatchStep &step = (*compiled)[i];
 
         if (!tok) {
             // If we have no tokens, pattern "!!else" should return true
-            if (p[0] == '!' && p[1] == '!' && p[2] != '\0') {
-                while (*p && *p != ' ')
-                    ++p;
+            if (step.kind == MatchStep::Not)
                 continue;
-            } else
-                return false;
+            return false;
         }
 
-        // [.. => search for a one-character token..
-        if (p[0] == '[' && chrInFirstWord(p, ']')) {
+        bool advance = true;
+        switch (step.kind) {
+        case MatchStep::Simple:
+            if (tok->str() != step.word)
+                return false;
+            break;
+        case MatchStep::CharClass: {
+            // search for a one-character token
             if (tok->str().length() != 1)
                 return false;
-
-            const char *temp = p+1;
-            bool chrFound = false;
-            unsigned int count = 0;
-            while (*temp && *temp != ' ') {
-                if (*temp == ']') {
-                    ++count;
-                }
-
-                else if (*temp == tok->str()[0]) {
-                    chrFound = true;
-                    break;
-                }
-
-                ++temp;
-            }
-
-            if (count > 1 && tok->str()[0] == ']')
-                chrFound = true;
-
+            const char c = tok->str()[0];
+            const bool chrFound = (c == ']') ?
+                                  (step.closingBrackets > 1) :
+                                  (step.word.find(c) != std::string::npos);
             if (!chrFound)
                 return false;
-
-            p = temp;
-            while (*p && *p != ' ')
-                ++p;
+            break;
         }
-
-        // Parse "not" options. Token can be anything except the given one
-        else if (p[0] == '!' && p[1] == '!' && p[2] != '\0') {
-            p += 2;
-            if (firstWordEquals(p, tok->str().c_str()))
+        case MatchStep::Not:
+            // Token can be anything except the given one
+            if (tok->str() == step.word)
                 return false;
-            while (*p && *p != ' ')
-                ++p;
-        }
-
-        // Parse multi options, such as void|int|char (accept token which is one of these 3)
-        else {
-            const int res = multiCompare(tok, p, varid);
+            break;
+        case MatchStep::Multi: {
+            // Multi options, such as void|int|char (accept token which is one of these 3)
+            const int res = multiCompare(tok, step.word.c_str(), varid);
             if (res == 0) {
                 // Empty alternative matches, use the same token on next round
-                while (*p && *p != ' ')
-                    ++p;
-                continue;
+                advance = false;
             } else if (res == -1) {
                 // No match
                 return false;
             }
+            break;
+        }
         }
 
-        while (*p && *p != ' ')
-            ++p;
-
-        tok = tok->next();
+        if (advance)
+            tok = tok->next();
     }
 
     // The end of the pattern has been reached and nothing wrong has been found
@@ -819,25 +1076,39 @@ Token* Token::nextTemplateArgument() const
 
 const Token * Token::findClosingBracket() const
 {
-    if (mStr != "<")
+    if (str() != "<")
         return nullptr;
 
     const Token *closing = nullptr;
 
     unsigned int depth = 0;
     for (closing = this; closing != nullptr; closing = closing->next()) {
-        if (Token::Match(closing, "{|[|(")) {
-            closing = closing->link();
-            if (!closing)
-                return nullptr; // #6803
-        } else if (Token::Match(closing, "}|]|)|;"))
-            return nullptr;
-        else if (closing->str() == "<")
-            ++depth;
-        else if (closing->str() == ">") {
-            if (--depth == 0)
-                return closing;
-        } else if (closing->str() == ">>") {
+        const std::string &s = closing->str();
+        if (s.size() == 1) {
+            switch (s[0]) {
+            case '{':
+            case '[':
+            case '(':
+                closing = closing->link();
+                if (!closing)
+                    return nullptr; // #6803
+                break;
+            case '}':
+            case ']':
+            case ')':
+            case ';':
+                return nullptr;
+            case '<':
+                ++depth;
+                break;
+            case '>':
+                if (--depth == 0)
+                    return closing;
+                break;
+            default:
+                break;
+            }
+        } else if (s == ">>") {
             if (depth <= 2)
                 return closing;
             depth -= 2;
@@ -855,7 +1126,7 @@ Token * Token::findClosingBracket()
 
 const Token * Token::findOpeningBracket() const
 {
-    if (mStr != ">")
+    if (str() != ">")
         return nullptr;
 
     const Token *opening = nullptr;
@@ -889,8 +1160,14 @@ Token * Token::findOpeningBracket()
 
 const Token *Token::findsimplematch(const Token * const startTok, const char pattern[])
 {
+    // compare only the first word while scanning, the full pattern is
+    // matched at the candidate anchors only
+    const char * const endOfFirstWord = std::strchr(pattern, ' ');
+    const std::size_t firstWordLen = endOfFirstWord ? static_cast<std::size_t>(endOfFirstWord - pattern) : std::strlen(pattern);
     for (const Token* tok = startTok; tok; tok = tok->next()) {
-        if (Token::simpleMatch(tok, pattern))
+        if (tok->str().length() == firstWordLen &&
+            std::strncmp(pattern, tok->str().c_str(), firstWordLen) == 0 &&
+            Token::simpleMatch(tok, pattern))
             return tok;
     }
     return nullptr;
@@ -898,8 +1175,12 @@ const Token *Token::findsimplematch(const Token * const startTok, const char pat
 
 const Token *Token::findsimplematch(const Token * const startTok, const char pattern[], const Token * const end)
 {
+    const char * const endOfFirstWord = std::strchr(pattern, ' ');
+    const std::size_t firstWordLen = endOfFirstWord ? static_cast<std::size_t>(endOfFirstWord - pattern) : std::strlen(pattern);
     for (const Token* tok = startTok; tok && tok != end; tok = tok->next()) {
-        if (Token::simpleMatch(tok, pattern))
+        if (tok->str().length() == firstWordLen &&
+            std::strncmp(pattern, tok->str().c_str(), firstWordLen) == 0 &&
+            Token::simpleMatch(tok, pattern))
             return tok;
     }
     return nullptr;
@@ -907,6 +1188,17 @@ const Token *Token::findsimplematch(const Token * const startTok, const char pat
 
 const Token *Token::findmatch(const Token * const startTok, const char pattern[], const unsigned int varId)
 {
+    // When the pattern is anchored by a literal first token, compare only
+    // that word while scanning and match the full pattern at the anchors
+    const CompiledMatchPattern * const compiled = compileMatchPattern(pattern);
+    if (!compiled->empty() && compiled->front().kind == MatchStep::Simple) {
+        const std::string &anchor = compiled->front().word;
+        for (const Token* tok = startTok; tok; tok = tok->next()) {
+            if (tok->str() == anchor && Token::Match(tok, pattern, varId))
+                return tok;
+        }
+        return nullptr;
+    }
     for (const Token* tok = startTok; tok; tok = tok->next()) {
         if (Token::Match(tok, pattern, varId))
             return tok;
@@ -916,6 +1208,15 @@ const Token *Token::findmatch(const Token * const startTok, const char pattern[]
 
 const Token *Token::findmatch(const Token * const startTok, const char pattern[], const Token * const end, const unsigned int varId)
 {
+    const CompiledMatchPattern * const compiled = compileMatchPattern(pattern);
+    if (!compiled->empty() && compiled->front().kind == MatchStep::Simple) {
+        const std::string &anchor = compiled->front().word;
+        for (const Token* tok = startTok; tok && tok != end; tok = tok->next()) {
+            if (tok->str() == anchor && Token::Match(tok, pattern, varId))
+                return tok;
+        }
+        return nullptr;
+    }
     for (const Token* tok = startTok; tok && tok != end; tok = tok->next()) {
         if (Token::Match(tok, pattern, varId))
             return tok;
@@ -926,7 +1227,7 @@ const Token *Token::findmatch(const Token * const startTok, const char pattern[]
 void Token::insertToken(const std::string &tokenStr, const std::string &originalNameStr, bool prepend)
 {
     Token *newToken;
-    if (mStr.empty())
+    if (str().empty())
         newToken = this;
     else
         newToken = new Token(mTokensFrontBack);
@@ -1012,31 +1313,78 @@ void Token::stringify(std::ostream& os, bool varid, bool attributes, bool macro)
     }
     if (macro && isExpandedMacro())
         os << "$";
-    if (isName() && mStr.find(' ') != std::string::npos) {
-        for (std::size_t i = 0U; i < mStr.size(); ++i) {
-            if (mStr[i] != ' ')
-                os << mStr[i];
+    if (isName() && str().find(' ') != std::string::npos) {
+        for (std::size_t i = 0U; i < str().size(); ++i) {
+            if (str()[i] != ' ')
+                os << str()[i];
         }
-    } else if (mStr[0] != '\"' || mStr.find('\0') == std::string::npos)
-        os << mStr;
+    } else if (str()[0] != '\"' || str().find('\0') == std::string::npos)
+        os << str();
     else {
-        for (std::size_t i = 0U; i < mStr.size(); ++i) {
-            if (mStr[i] == '\0')
+        for (std::size_t i = 0U; i < str().size(); ++i) {
+            if (str()[i] == '\0')
                 os << "\\0";
             else
-                os << mStr[i];
+                os << str()[i];
         }
     }
     if (varid && mImpl->mVarId != 0)
         os << '@' << mImpl->mVarId;
 }
 
+void Token::stringify(std::string& os, bool varid, bool attributes, bool macro) const
+{
+    if (attributes) {
+        if (isUnsigned())
+            os += "unsigned ";
+        else if (isSigned())
+            os += "signed ";
+        if (isComplex())
+            os += "_Complex ";
+        if (isLong()) {
+            if (mTokType == eString || mTokType == eChar)
+                os += 'L';
+            else
+                os += "long ";
+        }
+    }
+    if (macro && isExpandedMacro())
+        os += '$';
+    if (isName() && str().find(' ') != std::string::npos) {
+        for (std::size_t i = 0U; i < str().size(); ++i) {
+            if (str()[i] != ' ')
+                os += str()[i];
+        }
+    } else if (str()[0] != '\"' || str().find('\0') == std::string::npos)
+        os += str();
+    else {
+        for (std::size_t i = 0U; i < str().size(); ++i) {
+            if (str()[i] == '\0')
+                os += "\\0";
+            else
+                os += str()[i];
+        }
+    }
+    if (varid && mImpl->mVarId != 0) {
+        os += '@';
+        os += std::to_string(mImpl->mVarId);
+    }
+}
+
 std::string Token::stringifyList(bool varid, bool attributes, bool linenumbers, bool linebreaks, bool files, const std::vector<std::string>* fileNames, const Token* end) const
 {
     if (this == end)
         return "";
 
-    std::ostringstream ret;
+    // Building a string for millions of tokens with on-demand growth
+    // reallocates and copies the partial result over and over; estimate
+    // the size from the token texts and reserve it up front.
+    std::size_t estimatedSize = 0;
+    for (const Token *tok = this; tok != end; tok = tok->next())
+        estimatedSize += tok->str().size() + (linenumbers ? 8U : 1U) + (varid ? 8U : 0U);
+
+    std::string ret;
+    ret.reserve(estimatedSize);
 
     unsigned int lineNumber = mImpl->mLineNumber - (linenumbers ? 1U : 0U);
     unsigned int fileInd = files ? ~0U : mImpl->mFileIndex;
@@ -1050,12 +1398,12 @@ std::string Token::stringifyList(bool varid, bool attributes, bool linenumbers,
 
             fileInd = tok->mImpl->mFileIndex;
             if (files) {
-                ret << "\n\n##file ";
+                ret += "\n\n##file ";
                 if (fileNames && fileNames->size() > tok->mImpl->mFileIndex)
-                    ret << fileNames->at(tok->mImpl->mFileIndex);
+                    ret += fileNames->at(tok->mImpl->mFileIndex);
                 else
-                    ret << fileInd;
-                ret << '\n';
+                    ret += std::to_string(fileInd);
+                ret += '\n';
             }
 
             lineNumber = lineNumbers[fileInd];
@@ -1064,19 +1412,25 @@ std::string Token::stringifyList(bool varid, bool attributes, bool linenumbers,
 
         if (linebreaks && (lineNumber != tok->linenr() || fileChange)) {
             if (lineNumber+4 < tok->linenr() && fileInd == tok->mImpl->mFileIndex) {
-                ret << '\n' << lineNumber+1 << ":\n|\n";
-                ret << tok->linenr()-1 << ":\n";
-                ret << tok->linenr() << ": ";
+                ret += '\n';
+                ret += std::to_string(lineNumber+1);
+                ret += ":\n|\n";
+                ret += std::to_string(tok->linenr()-1);
+                ret += ":\n";
+                ret += std::to_string(tok->linenr());
+                ret += ": ";
             } else if (this == tok && linenumbers) {
-                ret << tok->linenr() << ": ";
+                ret += std::to_string(tok->linenr());
+                ret += ": ";
             } else {
                 while (lineNumber < tok->linenr()) {
                     ++lineNumber;
-                    ret << '\n';
+                    ret += '\n';
                     if (linenumbers) {
-                        ret << lineNumber << ':';
+                        ret += std::to_string(lineNumber);
+                        ret += ':';
                         if (lineNumber == tok->linenr())
-                            ret << ' ';
+                            ret += ' ';
                     }
                 }
             }
@@ -1085,11 +1439,11 @@ std::string Token::stringifyList(bool varid, bool attributes, bool linenumbers,
 
         tok->stringify(ret, varid, attributes, attributes); // print token
         if (tok->next() != end && (!linebreaks || (tok->next()->linenr() <= tok->linenr() && tok->next()->fileIndex() == tok->fileIndex())))
-            ret << ' ';
+            ret += ' ';
     }
     if (linebreaks && (files || linenumbers))
-        ret << '\n';
-    return ret.str();
+        ret += '\n';
+    return ret;
 }
 
 std::string Token::stringifyList(const Token* end, bool attributes) const
@@ -1105,36 +1459,38 @@ std::string Token::stringifyList(bool varid) const
 void Token::astOperand1(Token *tok)
 {
     if (mImpl->mAstOperand1)
-        mImpl->mAstOperand1->mImpl->mAstParent = nullptr;
+        refToken(mImpl->mAstOperand1)->mImpl->mAstParent = TokenRef();
     // goto parent operator
     if (tok) {
         std::set<Token*> visitedParents;
         while (tok->mImpl->mAstParent) {
-            if (!visitedParents.insert(tok->mImpl->mAstParent).second) // #6838/#6726/#8352 avoid hang on garbage code
+            Token * const parent = refToken(tok->mImpl->mAstParent);
+            if (!visitedParents.insert(parent).second) // #6838/#6726/#8352 avoid hang on garbage code
                 throw InternalError(this, "Internal error. Token::astOperand1() cyclic dependency.");
-            tok = tok->mImpl->mAstParent;
+            tok = parent;
         }
-        tok->mImpl->mAstParent = this;
+        tok->mImpl->mAstParent = tokenRef(this);
     }
-    mImpl->mAstOperand1 = tok;
+    mImpl->mAstOperand1 = tokenRef(tok);
 }
 
 void Token::astOperand2(Token *tok)
 {
     if (mImpl->mAstOperand2)
-        mImpl->mAstOperand2->mImpl->mAstParent = nullptr;
+        refToken(mImpl->mAstOperand2)->mImpl->mAstParent = TokenRef();
     // goto parent operator
     if (tok) {
         std::set<Token*> visitedParents;
         while (tok->mImpl->mAstParent) {
             //std::cout << tok << " -> " << tok->mAstParent ;
-            if (!visitedParents.insert(tok->mImpl->mAstParent).second) // #6838/#6726 avoid hang on garbage code
+            Token * const parent = refToken(tok->mImpl->mAstParent);
+            if (!visitedParents.insert(parent).second) // #6838/#6726 avoid hang on garbage code
                 throw InternalError(this, "Internal error. Token::astOperand2() cyclic dependency.");
-            tok = tok->mImpl->mAstParent;
+            tok = parent;
         }
-        tok->mImpl->mAstParent = this;
+        tok->mImpl->mAstParent = tokenRef(this);
     }
-    mImpl->mAstOperand2 = tok;
+    mImpl->mAstOperand2 = tokenRef(tok);
 }
 
 static const Token* goToLeftParenthesis(const Token* start, const Token* end)
@@ -1250,15 +1606,15 @@ bool Token::isUnaryPreOp() const
         return false;
     if (!Token::Match(this, "++|--"))
         return true;
-    const Token *tokbefore = mPrevious;
-    const Token *tokafter = mNext;
+    const Token *tokbefore = refToken(mPrevious);
+    const Token *tokafter = refToken(mNext);
     for (int distance = 1; distance < 10 && tokbefore; distance++) {
-        if (tokbefore == mImpl->mAstOperand1)
+        if (tokbefore == refToken(mImpl->mAstOperand1))
             return false;
-        if (tokafter == mImpl->mAstOperand1)
+        if (tokafter == refToken(mImpl->mAstOperand1))
             return true;
-        tokbefore = tokbefore->mPrevious;
-        tokafter  = tokafter->mPrevious;
+        tokbefore = tokbefore->previous();
+        tokafter  = tokafter->previous();
     }
     return false; // <- guess
 }
@@ -1356,7 +1712,7 @@ std::string Token::astStringVerbose(const unsigned int indent1, const unsigned i
 
     if (isExpandedMacro())
         ret += '$';
-    ret += mStr;
+    ret += str();
     if (mImpl->mValueType)
         ret += " \'" + mImpl->mValueType->str() + '\'';
     ret += '\n';
@@ -1365,13 +1721,13 @@ std::string Token::astStringVerbose(const unsigned int indent1, const unsigned i
         unsigned int i1 = indent1, i2 = indent2 + 2;
         if (indent1==indent2 && !mImpl->mAstOperand2)
             i1 += 2;
-        ret += indent(indent1,indent2) + (mImpl->mAstOperand2 ? "|-" : "`-") + mImpl->mAstOperand1->astStringVerbose(i1,i2);
+        ret += indent(indent1,indent2) + (mImpl->mAstOperand2 ? "|-" : "`-") + refToken(mImpl->mAstOperand1)->astStringVerbose(i1,i2);
     }
     if (mImpl->mAstOperand2) {
         unsigned int i1 = indent1, i2 = indent2 + 2;
         if (indent1==indent2)
             i1 += 2;
-        ret += indent(indent1,indent2) + "`-" + mImpl->mAstOperand2->astStringVerbose(i1,i2);
+        ret += indent(indent1,indent2) + "`-" + refToken(mImpl->mAstOperand2)->astStringVerbose(i1,i2);
     }
     return ret;
 }
@@ -1381,14 +1737,14 @@ void Token::printValueFlow(bool xml, std::ostream &out) const
 {
     unsigned int line = 0;
     if (xml)
-        out << "  <valueflow>" << std::endl;
+        out << "  <valueflow>" << '\n';
     else
         out << "\n\n##Value flow" << std::endl;
     for (const Token *tok = this; tok; tok = tok->next()) {
         if (!tok->mImpl->mValues)
             continue;
         if (xml)
-            out << "    <values id=\"" << tok->mImpl->mValues << "\">" << std::endl;
+            out << "    <values id=\"" << tok->mImpl->mValues << "\">" << '\n';
         else if (line != tok->linenr())
             out << "Line " << tok->linenr() << std::endl;
         line = tok->linenr();
@@ -1434,7 +1790,7 @@ void Token::printValueFlow(bool xml, std::ostream &out) const
                     out << " possible=\"true\"";
                 else if (value.isInconclusive())
                     out << " inconclusive=\"true\"";
-                out << "/>" << std::endl;
+                out << "/>" << '\n';
             }
 
             else {
@@ -1469,14 +1825,14 @@ void Token::printValueFlow(bool xml, std::ostream &out) const
             }
         }
         if (xml)
-            out << "    </values>" << std::endl;
+            out << "    </values>" << '\n';
         else if (tok->mImpl->mValues->size() > 1U)
             out << '}' << std::endl;
         else
             out << std::endl;
     }
     if (xml)
-        out << "  </valueflow>" << std::endl;
+        out << "  </valueflow>" << '\n';
 }
 
 const ValueFlow::Value * Token::getValueLE(const MathLib::bigint val, const Settings *settings) const
@@ -1484,7 +1840,7 @@ const ValueFlow::Value * Token::getValueLE(const MathLib::bigint val, const Sett
     if (!mImpl->mValues)
         return nullptr;
     const ValueFlow::Value *ret = nullptr;
-    std::list<ValueFlow::Value>::const_iterator it;
+    ValueFlow::ValueList::const_iterator it;
     for (it = mImpl->mValues->begin(); it != mImpl->mValues->end(); ++it) {
         if (it->isIntValue() && it->intvalue <= val) {
             if (!ret || ret->isInconclusive() || (ret->condition && !it->isInconclusive()))
@@ -1507,7 +1863,7 @@ const ValueFlow::Value * Token::getValueGE(const MathLib::bigint val, const Sett
     if (!mImpl->mValues)
         return nullptr;
     const ValueFlow::Value *ret = nullptr;
-    std::list<ValueFlow::Value>::const_iterator it;
+    ValueFlow::ValueList::const_iterator it;
     for (it = mImpl->mValues->begin(); it != mImpl->mValues->end(); ++it) {
         if (it->isIntValue() && it->intvalue >= val) {
             if (!ret || ret->isInconclusive() || (ret->condition && !it->isInconclusive()))
@@ -1530,7 +1886,7 @@ const ValueFlow::Value * Token::getInvalidValue(const Token *ftok, unsigned int
     if (!mImpl->mValues || !settings)
         return nullptr;
     const ValueFlow::Value *ret = nullptr;
-    std::list<ValueFlow::Value>::const_iterator it;
+    ValueFlow::ValueList::const_iterator it;
     for (it = mImpl->mValues->begin(); it != mImpl->mValues->end(); ++it) {
         if ((it->isIntValue() && !settings->library.isIntArgValid(ftok, argnr, it->intvalue)) ||
             (it->isFloatValue() && !settings->library.isFloatArgValid(ftok, argnr, it->floatValue))) {
@@ -1555,7 +1911,7 @@ const Token *Token::getValueTokenMinStrSize() const
         return nullptr;
     const Token *ret = nullptr;
     std::size_t minsize = ~0U;
-    std::list<ValueFlow::Value>::const_iterator it;
+    ValueFlow::ValueList::const_iterator it;
     for (it = mImpl->mValues->begin(); it != mImpl->mValues->end(); ++it) {
         if (it->isTokValue() && it->tokvalue && it->tokvalue->tokType() == Token::eString) {
             const std::size_t size = getStrSize(it->tokvalue);
@@ -1574,7 +1930,7 @@ const Token *Token::getValueTokenMaxStrLength() const
         return nullptr;
     const Token *ret = nullptr;
     std::size_t maxlength = 0U;
-    std::list<ValueFlow::Value>::const_iterator it;
+    ValueFlow::ValueList::const_iterator it;
     for (it = mImpl->mValues->begin(); it != mImpl->mValues->end(); ++it) {
         if (it->isTokValue() && it->tokvalue && it->tokvalue->tokType() == Token::eString) {
             const std::size_t length = getStrLength(it->tokvalue);
@@ -1598,7 +1954,7 @@ const Token *Token::getValueTokenDeadPointer() const
 {
     const Scope * const functionscope = getfunctionscope(this->scope());
 
-    std::list<ValueFlow::Value>::const_iterator it;
+    ValueFlow::ValueList::const_iterator it;
     for (it = values().begin(); it != values().end(); ++it) {
         // Is this a pointer alias?
         if (!it->isTokValue() || (it->tokvalue && it->tokvalue->str() != "&"))
@@ -1627,13 +1983,17 @@ const Token *Token::getValueTokenDeadPointer() const
     return nullptr;
 }
 
+thread_local std::size_t Token::mValueFlowRevision = 0;
+
 bool Token::addValue(const ValueFlow::Value &value)
 {
     if (value.isKnown() && mImpl->mValues) {
         // Clear all other values of the same type since value is known
+        const std::size_t sizeBefore = mImpl->mValues->size();
         mImpl->mValues->remove_if([&](const ValueFlow::Value & x) {
             return x.valueType == value.valueType;
         });
+        mValueFlowRevision -= sizeBefore - mImpl->mValues->size();
     }
 
     if (mImpl->mValues) {
@@ -1643,7 +2003,7 @@ bool Token::addValue(const ValueFlow::Value &value)
             return false;
 
         // if value already exists, don't add it again
-        std::list<ValueFlow::Value>::iterator it;
+        ValueFlow::ValueList::iterator it;
         for (it = mImpl->mValues->begin(); it != mImpl->mValues->end(); ++it) {
             // different intvalue => continue
             if (it->intvalue != value.intvalue)
@@ -1667,21 +2027,26 @@ bool Token::addValue(const ValueFlow::Value &value)
             return false;
         }
 
-        // Add value
+        // Add value. Copy it into the list directly instead of through a
+        // local so the error path is not deep-copied twice.
         if (it == mImpl->mValues->end()) {
-            ValueFlow::Value v(value);
-            if (v.varId == 0)
-                v.varId = mImpl->mVarId;
-            if (v.isKnown() && v.isIntValue())
-                mImpl->mValues->push_front(v);
-            else
-                mImpl->mValues->push_back(v);
+            ValueFlow::Value *v;
+            if (value.isKnown() && value.isIntValue()) {
+                mImpl->mValues->push_front(value);
+                v = &mImpl->mValues->front();
+            } else {
+                mImpl->mValues->push_back(value);
+                v = &mImpl->mValues->back();
+            }
+            if (v->varId == 0)
+                v->varId = mImpl->mVarId;
+            ++mValueFlowRevision;
         }
     } else {
-        ValueFlow::Value v(value);
-        if (v.varId == 0)
-            v.varId = mImpl->mVarId;
-        mImpl->mValues = new std::list<ValueFlow::Value>(1, v);
+        mImpl->mValues = new ValueFlow::ValueList(1, value);
+        if (mImpl->mValues->front().varId == 0)
+            mImpl->mValues->front().varId = mImpl->mVarId;
+        ++mValueFlowRevision;
     }
 
     return true;
@@ -1721,7 +2086,10 @@ TokenImpl::~TokenImpl()
     delete mValueType;
     delete mValues;
 
-    for (auto templateSimplifierPointer : mTemplateSimplifierPointers) {
-        templateSimplifierPointer->token = nullptr;
+    if (mTemplateSimplifierPointers) {
+        for (auto templateSimplifierPointer : *mTemplateSimplifierPointers) {
+            templateSimplifierPointer->token = nullptr;
+        }
     }
+    delete mTemplateSimplifierPointers;
 }
@@ -32,6 +32,7 @@
 #include <list>
 #include <ostream>
 #include <string>
+#include <utility>
 #include <vector>
 
 class Enumerator;
@@ -42,6 +43,36 @@ class Type;
 class ValueType;
 class Variable;
 
+/**
+ * Define COMPACT_TOKENS to store the intra-token-graph references - the
+ * next/previous/link fields of Token and the AST fields of TokenImpl - as
+ * 32-bit indexes into the token slab pool instead of 64-bit pointers
+ * (build with make CXXFLAGS=-DCOMPACT_TOKENS). That shrinks the per-token
+ * data by about 20 bytes, which adds up on token lists with millions of
+ * tokens, in exchange for a little index arithmetic whenever a reference
+ * is followed. In this mode every token that is linked into the token
+ * graph must be heap allocated; the standalone stack tokens that some
+ * code creates just to call Token::Match are fine as long as nothing
+ * links to them. The slab pool is thread local, so a compact reference is
+ * only meaningful on the thread that allocated the token - which always
+ * holds, tokens never move between threads.
+ */
+#ifdef COMPACT_TOKENS
+typedef unsigned int TokenRef;
+CPPCHECKLIB Token *refToken(TokenRef ref);
+CPPCHECKLIB TokenRef tokenRef(const Token *tok);
+#else
+typedef Token *TokenRef;
+inline Token *refToken(TokenRef ref)
+{
+    return ref;
+}
+inline TokenRef tokenRef(Token *tok)
+{
+    return tok;
+}
+#endif
+
 /**
  * @brief This struct stores pointers to the front and back tokens of the list this token is in.
  */
@@ -51,15 +82,19 @@ struct TokensFrontBack {
 };
 
 struct TokenImpl {
+    /** Tokens are allocated from a thread-local slab pool, see token.cpp */
+    static void *operator new(std::size_t size);
+    static void operator delete(void *ptr, std::size_t size);
+
     unsigned int mVarId;
     unsigned int mFileIndex;
     unsigned int mLineNumber;
     unsigned int mColumn;
 
     // AST..
-    Token *mAstOperand1;
-    Token *mAstOperand2;
-    Token *mAstParent;
+    TokenRef mAstOperand1;
+    TokenRef mAstOperand2;
+    TokenRef mAstParent;
 
     // symbol database information
     const Scope *mScope;
@@ -76,6 +111,13 @@ struct TokenImpl {
      */
     unsigned int mProgressValue;
 
+    /**
+     * Expression identity, see SymbolDatabase::createSymbolDatabaseExprIds.
+     * Two tokens with the same nonzero id are roots of identical
+     * side-effect-free expressions. 0 = no id assigned.
+     */
+    unsigned int mExprId;
+
     // original name like size_t
     std::string* mOriginalName;
 
@@ -83,31 +125,35 @@ struct TokenImpl {
     ValueType *mValueType;
 
     // ValueFlow
-    std::list<ValueFlow::Value>* mValues;
-    static const std::list<ValueFlow::Value> mEmptyValueList;
+    ValueFlow::ValueList* mValues;
+    static const ValueFlow::ValueList mEmptyValueList;
 
     /** Bitfield bit count. */
     unsigned char mBits;
 
-    // Pointer to a template in the template simplifier
-    std::set<TemplateSimplifier::TokenAndName*> mTemplateSimplifierPointers;
+    // Pointers to the template simplifier data that names this token.
+    // Allocated lazily: only template name tokens carry entries, paying
+    // for an empty set in every token is noticeable on template heavy
+    // code where the expansions multiply the token count.
+    std::set<TemplateSimplifier::TokenAndName*>* mTemplateSimplifierPointers;
 
     TokenImpl()
         : mVarId(0)
         , mFileIndex(0)
         , mLineNumber(0)
         , mColumn(0)
-        , mAstOperand1(nullptr)
-        , mAstOperand2(nullptr)
-        , mAstParent(nullptr)
+        , mAstOperand1(TokenRef())
+        , mAstOperand2(TokenRef())
+        , mAstParent(TokenRef())
         , mScope(nullptr)
         , mFunction(nullptr) // Initialize whole union
         , mProgressValue(0)
+        , mExprId(0)
         , mOriginalName(nullptr)
         , mValueType(nullptr)
         , mValues(nullptr)
         , mBits(0)
-        , mTemplateSimplifierPointers()
+        , mTemplateSimplifierPointers(nullptr)
     {}
 
     ~TokenImpl();
@@ -130,6 +176,9 @@ class CPPCHECKLIB Token {
 private:
     TokensFrontBack* mTokensFrontBack;
 
+    // TokenList splices detached token runs and needs to relink/rebind tokens
+    friend class TokenList;
+
     // Not implemented..
     Token(const Token &);
     Token operator=(const Token &);
@@ -147,12 +196,13 @@ public:
     explicit Token(TokensFrontBack *tokensFrontBack = nullptr);
     ~Token();
 
+    /** Tokens are allocated from a thread-local slab pool, see token.cpp */
+    static void *operator new(std::size_t size);
+    static void operator delete(void *ptr, std::size_t size);
+
     template<typename T>
     void str(T&& s) {
-        mStr = s;
-        mImpl->mVarId = 0;
-
-        update_property_info();
+        setStr(std::forward<T>(s));
     }
 
     /**
@@ -162,7 +212,17 @@ public:
     void concatStr(std::string const& b);
 
     const std::string &str() const {
-        return mStr;
+        return *mStr;
+    }
+
+    /**
+     * Do two tokens have the same text? The texts are interned, so this
+     * is one pointer comparison instead of a character compare. Valid for
+     * any two tokens created on the same thread; the intern pool is per
+     * thread.
+     */
+    bool sameStr(const Token *other) const {
+        return mStr == other->mStr;
     }
 
     /**
@@ -325,6 +385,11 @@ public:
         const bool memoizedIsLiteral = (mTokType == eNumber || mTokType == eString || mTokType == eChar ||
                                         mTokType == eBoolean || mTokType == eLiteral || mTokType == eEnumerator);
         setFlag(fIsLiteral, memoizedIsLiteral);
+
+        const bool memoizedIsConstOp = (mTokType == eArithmeticalOp || mTokType == eLogicalOp ||
+                                        mTokType == eComparisonOp || mTokType == eBitOp);
+        setFlag(fIsConstOp, memoizedIsConstOp);
+        setFlag(fIsOp, memoizedIsConstOp || mTokType == eAssignmentOp || mTokType == eIncDecOp);
     }
     void isKeyword(const bool kwd) {
         if (kwd)
@@ -349,18 +414,13 @@ public:
         return mTokType == eEnumerator;
     }
     bool isOp() const {
-        return (isConstOp() ||
-                isAssignmentOp() ||
-                mTokType == eIncDecOp);
+        return getFlag(fIsOp);
     }
     bool isConstOp() const {
-        return (isArithmeticalOp() ||
-                mTokType == eLogicalOp ||
-                mTokType == eComparisonOp ||
-                mTokType == eBitOp);
+        return getFlag(fIsConstOp);
     }
     bool isExtendedOp() const {
-        return isConstOp() ||
+        return getFlag(fIsConstOp) ||
                mTokType == eExtendedOp;
     }
     bool isArithmeticalOp() const {
@@ -379,7 +439,7 @@ public:
         return astOperand1() != nullptr && astOperand2() != nullptr;
     }
     bool isUnaryOp(const std::string &s) const {
-        return s == mStr && astOperand1() != nullptr && astOperand2() == nullptr;
+        return s == *mStr && astOperand1() != nullptr && astOperand2() == nullptr;
     }
     bool isUnaryPreOp() const;
 
@@ -525,11 +585,14 @@ public:
     unsigned char bits() const {
         return mImpl->mBits;
     }
-    std::set<TemplateSimplifier::TokenAndName*> &templateSimplifierPointers() const {
+    /** template simplifier data that names this token, nullptr for most tokens */
+    std::set<TemplateSimplifier::TokenAndName*> *templateSimplifierPointers() const {
         return mImpl->mTemplateSimplifierPointers;
     }
     void templateSimplifierPointer(TemplateSimplifier::TokenAndName* tokenAndName) {
-        mImpl->mTemplateSimplifierPointers.insert(tokenAndName);
+        if (!mImpl->mTemplateSimplifierPointers)
+            mImpl->mTemplateSimplifierPointers = new std::set<TemplateSimplifier::TokenAndName*>;
+        mImpl->mTemplateSimplifierPointers->insert(tokenAndName);
     }
     void setBits(const unsigned char b) {
         mImpl->mBits = b;
@@ -614,7 +677,7 @@ public:
     }
 
     Token *next() const {
-        return mNext;
+        return refToken(mNext);
     }
 
 
@@ -638,7 +701,7 @@ public:
     void insertToken(const std::string &tokenStr, const std::string &originalNameStr=emptyString, bool prepend=false);
 
     Token *previous() const {
-        return mPrevious;
+        return refToken(mPrevious);
     }
 
 
@@ -691,6 +754,13 @@ public:
      */
     void stringify(std::ostream& os, bool varid, bool attributes, bool macro) const;
 
+    /**
+     * Like stringify(std::ostream&,..) but appends to a string; used by
+     * stringifyList() so a huge token list is built into one reserved
+     * buffer instead of a growing stream.
+     */
+    void stringify(std::string& os, bool varid, bool attributes, bool macro) const;
+
     /**
      * Stringify a list of token, from current instance on.
      * @param varid Print varids. (Style: "varname@id")
@@ -722,8 +792,8 @@ public:
      * to.
      */
     void link(Token *linkToToken) {
-        mLink = linkToToken;
-        if (mStr == "<" || mStr == ">")
+        mLink = tokenRef(linkToToken);
+        if (*mStr == "<" || *mStr == ">")
             update_property_info();
     }
 
@@ -737,7 +807,7 @@ public:
      * @return The token where this token links to.
      */
     Token *link() const {
-        return mLink;
+        return refToken(mLink);
     }
 
     /**
@@ -855,6 +925,16 @@ public:
     /** Calculate progress values for all tokens */
     static void assignProgressValues(Token *tok);
 
+    /** Get expression identity, 0 if no id has been assigned */
+    unsigned int exprId() const {
+        return mImpl->mExprId;
+    }
+
+    /** Set expression identity */
+    void exprId(unsigned int id) {
+        mImpl->mExprId = id;
+    }
+
     /**
      * @return the first token of the next argument. Does only work on argument
      * lists. Requires that Tokenizer::createLinks2() has been called before.
@@ -894,7 +974,7 @@ public:
         return mImpl->mOriginalName ? *mImpl->mOriginalName : emptyString;
     }
 
-    const std::list<ValueFlow::Value>& values() const {
+    const ValueFlow::ValueList& values() const {
         return mImpl->mValues ? *mImpl->mValues : mImpl->mEmptyValueList;
     }
 
@@ -974,13 +1054,28 @@ public:
     /** Add token value. Return true if value is added. */
     bool addValue(const ValueFlow::Value &value);
 
+    /**
+     * Net number of values addValue() has stored over all tokens: additions
+     * increment it, the removals done when a value becomes known decrement
+     * it. ValueFlow::setValues() iterates its passes until this count stops
+     * moving, which detects convergence without rescanning the whole token
+     * list. Replacements and balanced add/remove churn leave the count
+     * unchanged on purpose - a pass that only re-derives what is already
+     * there must not keep the iteration alive.
+     */
+    static std::size_t valueFlowRevision() {
+        return mValueFlowRevision;
+    }
+
 private:
 
+    static thread_local std::size_t mValueFlowRevision;
+
     void next(Token *nextToken) {
-        mNext = nextToken;
+        mNext = tokenRef(nextToken);
     }
     void previous(Token *previousToken) {
-        mPrevious = previousToken;
+        mPrevious = tokenRef(previousToken);
     }
 
     /** used by deleteThis() to take data from token to delete */
@@ -1000,11 +1095,20 @@ private:
      */
     static const char *chrInFirstWord(const char *str, char c);
 
-    std::string mStr;
+    /**
+     * The token string is interned: equal token strings share one entry in a
+     * thread-local pool (see Token::intern in token.cpp). That deduplicates
+     * the millions of `(`, `;`, `int`, ... copies in a big token list and
+     * lets tokens with equal text share the pointer.
+     */
+    void setStr(const std::string &s);
+    static const std::string *intern(const std::string &s);
+
+    const std::string* mStr;
 
-    Token *mNext;
-    Token *mPrevious;
-    Token *mLink;
+    TokenRef mNext;
+    TokenRef mPrevious;
+    TokenRef mLink;
 
     enum {
         fIsUnsigned             = (1 << 0),
@@ -1032,6 +1136,8 @@ private:
         fIsTemplateArg          = (1 << 22),
         fIsAttributeNodiscard   = (1 << 23), // __attribute__ ((warn_unused_result)), [[nodiscard]]
         fAtAddress              = (1 << 24), // @ 0x4000
+        fIsConstOp              = (1 << 25), // arithmetical/logical/comparison/bit operator, see tokType()
+        fIsOp                   = (1 << 26), // fIsConstOp, assignment operator or ++/--, see tokType()
     };
 
     Token::Type mTokType;
@@ -1070,18 +1176,18 @@ public:
     void astOperand2(Token *tok);
 
     const Token * astOperand1() const {
-        return mImpl->mAstOperand1;
+        return refToken(mImpl->mAstOperand1);
     }
     const Token * astOperand2() const {
-        return mImpl->mAstOperand2;
+        return refToken(mImpl->mAstOperand2);
     }
     const Token * astParent() const {
-        return mImpl->mAstParent;
+        return refToken(mImpl->mAstParent);
     }
     const Token *astTop() const {
         const Token *ret = this;
         while (ret->mImpl->mAstParent)
-            ret = ret->mImpl->mAstParent;
+            ret = refToken(ret->mImpl->mAstParent);
         return ret;
     }
 
@@ -1097,7 +1203,7 @@ public:
     bool isCalculation() const;
 
     void clearAst() {
-        mImpl->mAstOperand1 = mImpl->mAstOperand2 = mImpl->mAstParent = nullptr;
+        mImpl->mAstOperand1 = mImpl->mAstOperand2 = mImpl->mAstParent = TokenRef();
     }
 
     void clearValueFlow() {
@@ -1108,10 +1214,10 @@ public:
     std::string astString(const char *sep = "") const {
         std::string ret;
         if (mImpl->mAstOperand1)
-            ret = mImpl->mAstOperand1->astString(sep);
+            ret = refToken(mImpl->mAstOperand1)->astString(sep);
         if (mImpl->mAstOperand2)
-            ret += mImpl->mAstOperand2->astString(sep);
-        return ret + sep + mStr;
+            ret += refToken(mImpl->mAstOperand2)->astString(sep);
+        return ret + sep + *mStr;
     }
 
     std::string astStringVerbose(const unsigned int indent1, const unsigned int indent2) const;
@@ -19,6 +19,7 @@
 //---------------------------------------------------------------------------
 #include "tokenize.h"
 
+#include "astutils.h"
 #include "check.h"
 #include "library.h"
 #include "mathlib.h"
@@ -154,6 +155,8 @@ Tokenizer::Tokenizer() :
     mTimerResults(nullptr)
 #ifdef MAXTIME
     ,mMaxTime(std::time(0) + MAXTIME)
+#else
+    ,mMaxTime(0)
 #endif
 {
 }
@@ -170,6 +173,8 @@ Tokenizer::Tokenizer(const Settings *settings, ErrorLogger *errorLogger) :
     mTimerResults(nullptr)
 #ifdef MAXTIME
     ,mMaxTime(std::time(0) + MAXTIME)
+#else
+    ,mMaxTime(0)
 #endif
 {
     // make sure settings are specified
@@ -184,6 +189,12 @@ Tokenizer::~Tokenizer()
     delete mTemplateSimplifier;
 }
 
+void Tokenizer::setTemplateExpansionCache(TemplateExpansionCache *cache)
+{
+    if (mTemplateSimplifier)
+        mTemplateSimplifier->setExpansionCache(cache);
+}
+
 
 //---------------------------------------------------------------------------
 // SizeOfType - gives the size of a type
@@ -549,6 +560,18 @@ void Tokenizer::simplifyTypedef()
     std::string className;
     bool hasClass = false;
     bool goback = false;
+
+    // Count how often each name occurs so the substitution walk below can be
+    // skipped for typedefs that are never used - generated headers declare
+    // thousands of them. Tokens inserted while simplifying are copies of
+    // tokens counted here, so a name occurring only once (in its own typedef
+    // declaration) cannot gain uses later on.
+    std::unordered_map<std::string, unsigned int> nameOccurrences;
+    for (const Token *tok = list.front(); tok; tok = tok->next()) {
+        if (tok->isName())
+            ++nameOccurrences[tok->str()];
+    }
+
     for (Token *tok = list.front(); tok; tok = tok->next()) {
         if (mErrorLogger && !list.getFiles().empty())
             mErrorLogger->reportProgress(list.getFiles()[0], "Tokenize (typedef)", tok->progressValue());
@@ -1024,7 +1047,12 @@ void Tokenizer::simplifyTypedef()
             bool globalScope = false;
             std::size_t classLevel = spaceInfo.size();
 
-            for (Token *tok2 = tok; tok2; tok2 = tok2->next()) {
+            // If the name occurs nowhere outside this declaration there is
+            // nothing to substitute and the scope-tracking walk can be skipped.
+            const std::unordered_map<std::string, unsigned int>::const_iterator nameUses = nameOccurrences.find(typeName->str());
+            const bool maybeUsed = (nameUses == nameOccurrences.end() || nameUses->second > 1U);
+
+            for (Token *tok2 = maybeUsed ? tok : nullptr; tok2; tok2 = tok2->next()) {
                 if (mSettings->terminated())
                     return;
 
@@ -1797,6 +1825,11 @@ bool Tokenizer::simplifyTokens1(const std::string &configuration)
         ValueFlow::setValues(&list, mSymbolDatabase, mErrorLogger, mSettings);
     }
 
+    stampLibraryAnnotations();
+
+    // the token list is final now, build the varid occurrence index
+    list.createVarIdIndex();
+
     printDebugOutput(1);
 
     return true;
@@ -2334,18 +2367,12 @@ void Tokenizer::simplifyTemplates()
         }
     }
 
-    mTemplateSimplifier->simplifyTemplates(
-#ifdef MAXTIME
-        mMaxTime,
-#else
-        0, // ignored
-#endif
-        mCodeWithTemplates);
+    mTemplateSimplifier->simplifyTemplates(mMaxTime, mCodeWithTemplates);
 }
 //---------------------------------------------------------------------------
 
 
-static bool setVarIdParseDeclaration(const Token **tok, const std::map<std::string,unsigned int> &variableId, bool executableScope, bool cpp, bool c)
+static bool setVarIdParseDeclaration(const Token **tok, const std::unordered_map<std::string,unsigned int> &variableId, bool executableScope, bool cpp, bool c)
 {
     const Token *tok2 = *tok;
     if (!tok2->isName())
@@ -2555,7 +2582,7 @@ void Tokenizer::setVarIdClassDeclaration(const Token * const startToken,
             --indentlevel;
             inEnum = false;
         } else if (initList && indentlevel == 0 && Token::Match(tok->previous(), "[,:] %name% [({]")) {
-            const std::map<std::string, unsigned int>::const_iterator it = variableMap.find(tok->str());
+            const std::unordered_map<std::string, unsigned int>::const_iterator it = variableMap.find(tok->str());
             if (it != variableMap.end()) {
                 tok->varId(it->second);
             }
@@ -2573,7 +2600,7 @@ void Tokenizer::setVarIdClassDeclaration(const Token * const startToken,
                 }
 
                 if (!inEnum) {
-                    const std::map<std::string, unsigned int>::const_iterator it = variableMap.find(tok->str());
+                    const std::unordered_map<std::string, unsigned int>::const_iterator it = variableMap.find(tok->str());
                     if (it != variableMap.end()) {
                         tok->varId(it->second);
                         setVarIdStructMembers(&tok, structMembers, variableMap.getVarId());
@@ -2838,7 +2865,7 @@ void Tokenizer::setVarIdPass1()
                         const Token *end = tok->findClosingBracket();
                         while (tok != end) {
                             if (tok->isName()) {
-                                const std::map<std::string, unsigned int>::const_iterator it = variableMap.find(tok->str());
+                                const std::unordered_map<std::string, unsigned int>::const_iterator it = variableMap.find(tok->str());
                                 if (it != variableMap.end())
                                     tok->varId(it->second);
                             }
@@ -2896,7 +2923,7 @@ void Tokenizer::setVarIdPass1()
             }
 
             if (!scopeStack.top().isEnum) {
-                const std::map<std::string, unsigned int>::const_iterator it = variableMap.find(tok->str());
+                const std::unordered_map<std::string, unsigned int>::const_iterator it = variableMap.find(tok->str());
                 if (it != variableMap.end()) {
                     tok->varId(it->second);
                     setVarIdStructMembers(&tok, structMembers, variableMap.getVarId());
@@ -3596,6 +3623,16 @@ bool Tokenizer::simplifySizeof()
     return ret;
 }
 
+void Tokenizer::simplifyPass(const char name[], const std::function<void()> &pass)
+{
+    if (mTimerResults) {
+        Timer t(std::string("Tokenizer::simplifyTokenList1::") + name, mSettings->showtime, mTimerResults);
+        pass();
+    } else {
+        pass();
+    }
+}
+
 bool Tokenizer::simplifyTokenList1(const char FileName[])
 {
     if (mSettings->terminated())
@@ -3617,21 +3654,33 @@ bool Tokenizer::simplifyTokenList1(const char FileName[])
     }
 
     // Is there C++ code in C file?
-    validateC();
+    simplifyPass("validateC", [&] {
+        validateC();
+    });
 
     // remove MACRO in variable declaration: MACRO int x;
-    removeMacroInVarDecl();
+    simplifyPass("removeMacroInVarDecl", [&] {
+        removeMacroInVarDecl();
+    });
 
     // Combine strings and character literals, e.g. L"string", L'c', "string1" "string2"
-    combineStringAndCharLiterals();
+    simplifyPass("combineStringAndCharLiterals", [&] {
+        combineStringAndCharLiterals();
+    });
 
     // replace inline SQL with "asm()" (Oracle PRO*C). Ticket: #1959
-    simplifySQL();
+    simplifyPass("simplifySQL", [&] {
+        simplifySQL();
+    });
 
-    createLinks();
+    simplifyPass("createLinks", [&] {
+        createLinks();
+    });
 
     // Remove __asm..
-    simplifyAsm();
+    simplifyPass("simplifyAsm", [&] {
+        simplifyAsm();
+    });
 
     // Bail out if code is garbage
     if (mTimerResults) {
@@ -3641,7 +3690,9 @@ bool Tokenizer::simplifyTokenList1(const char FileName[])
         findGarbageCode();
     }
 
-    checkConfiguration();
+    simplifyPass("checkConfiguration", [&] {
+        checkConfiguration();
+    });
 
     // if (x) MACRO() ..
     for (const Token *tok = list.front(); tok; tok = tok->next()) {
@@ -3659,35 +3710,53 @@ bool Tokenizer::simplifyTokenList1(const char FileName[])
         return false;
 
     // convert C++17 style nested namespaces to old style namespaces
-    simplifyNestedNamespace();
+    simplifyPass("simplifyNestedNamespace", [&] {
+        simplifyNestedNamespace();
+    });
 
     // simplify namespace aliases
-    simplifyNamespaceAliases();
+    simplifyPass("simplifyNamespaceAliases", [&] {
+        simplifyNamespaceAliases();
+    });
 
     // Remove [[attribute]]
-    simplifyCPPAttribute();
+    simplifyPass("simplifyCPPAttribute", [&] {
+        simplifyCPPAttribute();
+    });
 
     // remove __attribute__((?))
-    simplifyAttribute();
+    simplifyPass("simplifyAttribute", [&] {
+        simplifyAttribute();
+    });
 
     // Combine tokens..
-    combineOperators();
+    simplifyPass("combineOperators", [&] {
+        combineOperators();
+    });
 
     // Simplify the C alternative tokens (and, or, etc.)
-    simplifyCAlternativeTokens();
+    simplifyPass("simplifyCAlternativeTokens", [&] {
+        simplifyCAlternativeTokens();
+    });
 
     // replace 'sin(0)' to '0' and other similar math expressions
-    simplifyMathExpressions();
+    simplifyPass("simplifyMathExpressions", [&] {
+        simplifyMathExpressions();
+    });
 
     // combine "- %num%"
-    concatenateNegativeNumberAndAnyPositive();
+    simplifyPass("concatenateNegativeNumberAndAnyPositive", [&] {
+        concatenateNegativeNumberAndAnyPositive();
+    });
 
     // remove extern "C" and extern "C" {}
     if (isCPP())
         simplifyExternC();
 
     // simplify weird but legal code: "[;{}] ( { code; } ) ;"->"[;{}] code;"
-    simplifyRoundCurlyParentheses();
+    simplifyPass("simplifyRoundCurlyParentheses", [&] {
+        simplifyRoundCurlyParentheses();
+    });
 
     // check for simple syntax errors..
     for (const Token *tok = list.front(); tok; tok = tok->next()) {
@@ -3700,7 +3769,9 @@ bool Tokenizer::simplifyTokenList1(const char FileName[])
     if (!simplifyAddBraces())
         return false;
 
-    sizeofAddParentheses();
+    simplifyPass("sizeofAddParentheses", [&] {
+        sizeofAddParentheses();
+    });
 
     // Simplify: 0[foo] -> *(foo)
     for (Token* tok = list.front(); tok; tok = tok->next()) {
@@ -3715,7 +3786,9 @@ bool Tokenizer::simplifyTokenList1(const char FileName[])
         return false;
 
     // Remove "inline", "register", and "restrict"
-    simplifyKeyword();
+    simplifyPass("simplifyKeyword", [&] {
+        simplifyKeyword();
+    });
 
     // simplify simple calculations inside <..>
     if (isCPP()) {
@@ -3738,16 +3811,24 @@ bool Tokenizer::simplifyTokenList1(const char FileName[])
 
     // Convert K&R function declarations to modern C
     simplifyVarDecl(true);
-    simplifyFunctionParameters();
+    simplifyPass("simplifyFunctionParameters", [&] {
+        simplifyFunctionParameters();
+    });
 
     // simplify case ranges (gcc extension)
-    simplifyCaseRange();
+    simplifyPass("simplifyCaseRange", [&] {
+        simplifyCaseRange();
+    });
 
     // simplify labels and 'case|default'-like syntaxes
-    simplifyLabelsCaseDefault();
+    simplifyPass("simplifyLabelsCaseDefault", [&] {
+        simplifyLabelsCaseDefault();
+    });
 
     // simplify '[;{}] * & ( %any% ) =' to '%any% ='
-    simplifyMulAndParens();
+    simplifyPass("simplifyMulAndParens", [&] {
+        simplifyMulAndParens();
+    });
 
     if (!isC() && !mSettings->library.markupFile(FileName)) {
         findComplicatedSyntaxErrorsInTemplates();
@@ -3757,48 +3838,71 @@ bool Tokenizer::simplifyTokenList1(const char FileName[])
         return false;
 
     // remove calling conventions __cdecl, __stdcall..
-    simplifyCallingConvention();
+    simplifyPass("simplifyCallingConvention", [&] {
+        simplifyCallingConvention();
+    });
 
     // Remove __declspec()
-    simplifyDeclspec();
-    validate();
+    simplifyPass("simplifyDeclspec", [&] {
+        simplifyDeclspec();
+    });
+    simplifyPass("validate", [&] {
+        validate();
+    });
     // remove some unhandled macros in global scope
-    removeMacrosInGlobalScope();
+    simplifyPass("removeMacrosInGlobalScope", [&] {
+        removeMacrosInGlobalScope();
+    });
 
     // remove undefined macro in class definition:
     // class DLLEXPORT Fred { };
     // class Fred FINAL : Base { };
-    removeMacroInClassDef();
+    simplifyPass("removeMacroInClassDef", [&] {
+        removeMacroInClassDef();
+    });
 
     // That call here fixes #7190
-    validate();
+    simplifyPass("validate", [&] {
+        validate();
+    });
 
     // remove unnecessary member qualification..
-    removeUnnecessaryQualification();
-
-    // convert Microsoft memory functions
-    simplifyMicrosoftMemoryFunctions();
+    simplifyPass("removeUnnecessaryQualification", [&] {
+        removeUnnecessaryQualification();
+    });
 
-    // convert Microsoft string functions
-    simplifyMicrosoftStringFunctions();
+    // convert Microsoft memory and string functions in one fused traversal
+    simplifyPass("simplifyMicrosoftFunctions", [&] {
+        simplifyMicrosoftFunctions();
+    });
 
     if (mSettings->terminated())
         return false;
 
     // Remove Qt signals and slots
-    simplifyQtSignalsSlots();
+    simplifyPass("simplifyQtSignalsSlots", [&] {
+        simplifyQtSignalsSlots();
+    });
 
     // remove Borland stuff..
-    simplifyBorland();
+    simplifyPass("simplifyBorland", [&] {
+        simplifyBorland();
+    });
 
     // syntax error: enum with typedef in it
-    checkForEnumsWithTypedef();
+    simplifyPass("checkForEnumsWithTypedef", [&] {
+        checkForEnumsWithTypedef();
+    });
 
     // Add parentheses to ternary operator where necessary
-    prepareTernaryOpForAST();
+    simplifyPass("prepareTernaryOpForAST", [&] {
+        prepareTernaryOpForAST();
+    });
 
     // Change initialisation of variable to assignment
-    simplifyInitVar();
+    simplifyPass("simplifyInitVar", [&] {
+        simplifyInitVar();
+    });
 
     // Split up variable declarations.
     simplifyVarDecl(false);
@@ -3814,7 +3918,9 @@ bool Tokenizer::simplifyTokenList1(const char FileName[])
     // Add parentheses to ternary operator where necessary
     // TODO: this is only necessary if one typedef simplification had a comma and was used within ?:
     // If typedef handling is refactored and moved to symboldatabase someday we can remove this
-    prepareTernaryOpForAST();
+    simplifyPass("prepareTernaryOpForAST", [&] {
+        prepareTernaryOpForAST();
+    });
 
     for (Token* tok = list.front(); tok;) {
         if (Token::Match(tok, "union|struct|class union|struct|class"))
@@ -3837,17 +3943,23 @@ bool Tokenizer::simplifyTokenList1(const char FileName[])
     // to reproduce bad typedef, download upx-ucl from:
     // http://packages.debian.org/sid/upx-ucl
     // analyse the file src/stub/src/i386-linux.elf.interp-main.c
-    validate();
+    simplifyPass("validate", [&] {
+        validate();
+    });
 
     // The simplify enum have inner loops
     if (mSettings->terminated())
         return false;
 
     // Put ^{} statements in asm()
-    simplifyAsm2();
+    simplifyPass("simplifyAsm2", [&] {
+        simplifyAsm2();
+    });
 
     // @..
-    simplifyAt();
+    simplifyPass("simplifyAt", [&] {
+        simplifyAt();
+    });
 
     // When the assembly code has been cleaned up, no @ is allowed
     for (const Token *tok = list.front(); tok; tok = tok->next()) {
@@ -3862,12 +3974,16 @@ bool Tokenizer::simplifyTokenList1(const char FileName[])
     }
 
     // Order keywords "static" and "const"
-    simplifyStaticConst();
+    simplifyPass("simplifyStaticConst", [&] {
+        simplifyStaticConst();
+    });
 
     // convert platform dependent types to standard types
     // 32 bits: size_t -> unsigned long
     // 64 bits: size_t -> unsigned long long
-    simplifyPlatformTypes();
+    simplifyPass("simplifyPlatformTypes", [&] {
+        simplifyPlatformTypes();
+    });
 
     // collapse compound standard types into a single token
     // unsigned long long int => long (with _isUnsigned=true,_isLong=true)
@@ -3877,31 +3993,43 @@ bool Tokenizer::simplifyTokenList1(const char FileName[])
         return false;
 
     // simplify bit fields..
-    simplifyBitfields();
+    simplifyPass("simplifyBitfields", [&] {
+        simplifyBitfields();
+    });
 
     if (mSettings->terminated())
         return false;
 
     // struct simplification "struct S {} s; => struct S { } ; S s ;
-    simplifyStructDecl();
+    simplifyPass("simplifyStructDecl", [&] {
+        simplifyStructDecl();
+    });
 
     if (mSettings->terminated())
         return false;
 
     // x = ({ 123; });  =>   { x = 123; }
-    simplifyAssignmentBlock();
+    simplifyPass("simplifyAssignmentBlock", [&] {
+        simplifyAssignmentBlock();
+    });
 
     if (mSettings->terminated())
         return false;
 
-    simplifyVariableMultipleAssign();
+    simplifyPass("simplifyVariableMultipleAssign", [&] {
+        simplifyVariableMultipleAssign();
+    });
 
     // Collapse operator name tokens into single token
     // operator = => operator=
-    simplifyOperatorName();
+    simplifyPass("simplifyOperatorName", [&] {
+        simplifyOperatorName();
+    });
 
     // Remove redundant parentheses
-    simplifyRedundantParentheses();
+    simplifyPass("simplifyRedundantParentheses", [&] {
+        simplifyRedundantParentheses();
+    });
 
     if (!isC()) {
         // Handle templates..
@@ -3924,13 +4052,19 @@ bool Tokenizer::simplifyTokenList1(const char FileName[])
     }
 
     // Simplify pointer to standard types (C only)
-    simplifyPointerToStandardType();
+    simplifyPass("simplifyPointerToStandardType", [&] {
+        simplifyPointerToStandardType();
+    });
 
     // simplify function pointers
-    simplifyFunctionPointers();
+    simplifyPass("simplifyFunctionPointers", [&] {
+        simplifyFunctionPointers();
+    });
 
     // Change initialisation of variable to assignment
-    simplifyInitVar();
+    simplifyPass("simplifyInitVar", [&] {
+        simplifyInitVar();
+    });
 
     // Split up variable declarations.
     simplifyVarDecl(false);
@@ -3945,44 +4079,72 @@ bool Tokenizer::simplifyTokenList1(const char FileName[])
     }
 
     // Link < with >
-    createLinks2();
+    simplifyPass("createLinks2", [&] {
+        createLinks2();
+    });
 
     // specify array size
-    arraySize();
+    simplifyPass("arraySize", [&] {
+        arraySize();
+    });
 
     // The simplify enum might have inner loops
     if (mSettings->terminated())
         return false;
 
     // Add std:: in front of std classes, when using namespace std; was given
-    simplifyNamespaceStd();
+    simplifyPass("simplifyNamespaceStd", [&] {
+        simplifyNamespaceStd();
+    });
 
     // Change initialisation of variable to assignment
-    simplifyInitVar();
+    simplifyPass("simplifyInitVar", [&] {
+        simplifyInitVar();
+    });
 
     // Convert e.g. atol("0") into 0
-    simplifyMathFunctions();
+    simplifyPass("simplifyMathFunctions", [&] {
+        simplifyMathFunctions();
+    });
 
-    simplifyDoublePlusAndDoubleMinus();
+    simplifyPass("simplifyDoublePlusAndDoubleMinus", [&] {
+        simplifyDoublePlusAndDoubleMinus();
+    });
 
-    simplifyArrayAccessSyntax();
+    simplifyPass("simplifyArrayAccessSyntax", [&] {
+        simplifyArrayAccessSyntax();
+    });
 
     Token::assignProgressValues(list.front());
 
-    removeRedundantSemicolons();
+    simplifyPass("removeRedundantSemicolons", [&] {
+        removeRedundantSemicolons();
+    });
 
-    simplifyParameterVoid();
+    simplifyPass("simplifyParameterVoid", [&] {
+        simplifyParameterVoid();
+    });
 
-    simplifyRedundantConsecutiveBraces();
+    simplifyPass("simplifyRedundantConsecutiveBraces", [&] {
+        simplifyRedundantConsecutiveBraces();
+    });
 
-    simplifyEmptyNamespaces();
+    simplifyPass("simplifyEmptyNamespaces", [&] {
+        simplifyEmptyNamespaces();
+    });
 
-    elseif();
+    simplifyPass("elseif", [&] {
+        elseif();
+    });
 
-    SimplifyNamelessRValueReferences();
+    simplifyPass("SimplifyNamelessRValueReferences", [&] {
+        SimplifyNamelessRValueReferences();
+    });
 
 
-    validate();
+    simplifyPass("validate", [&] {
+        validate();
+    });
     return true;
 }
 
@@ -3991,6 +4153,10 @@ bool Tokenizer::simplifyTokenList2()
     // clear the _functionList so it can't contain dead pointers
     deleteSymbolDatabase();
 
+    // the simplifications below delete tokens, so drop the caches that are
+    // keyed by token addresses
+    clearAstCaches();
+
     // Clear AST,ValueFlow. These will be created again at the end of this function.
     for (Token *tok = list.front(); tok; tok = tok->next()) {
         tok->clearAst();
@@ -4126,6 +4292,11 @@ bool Tokenizer::simplifyTokenList2()
     if (mSettings->terminated())
         return false;
 
+    stampLibraryAnnotations();
+
+    // rebuild the varid occurrence index for the simplified token list
+    list.createVarIdIndex();
+
     printDebugOutput(2);
 
     return true;
@@ -4182,18 +4353,66 @@ void Tokenizer::printDebugOutput(unsigned int simplification) const
     }
 }
 
-void Tokenizer::dump(std::ostream &out) const
+void Tokenizer::dump(std::ostream &out, std::ostream *index) const
 {
     // Create a xml data dump.
     // The idea is not that this will be readable for humans. It's a
     // data dump that 3rd party tools could load and get useful info from.
 
+    // with --dump=<sections> only the selected sections are written. The
+    // attributes referencing a skipped section are omitted as well so the
+    // dump stays self contained.
+    const bool dumpSymbols = mSettings->isDumpSectionEnabled("symbols");
+    const bool dumpValueflow = mSettings->isDumpSectionEnabled("valueflow");
+
+    if (!mSettings->isDumpSectionEnabled("tokens")) {
+        if (dumpSymbols) {
+            const std::ostream::pos_type begin = out.tellp();
+            mSymbolDatabase->printXml(out);
+            if (index)
+                *index << "symbols " << begin << ' ' << out.tellp() << '\n';
+        }
+        if (dumpValueflow && list.front()) {
+            const std::ostream::pos_type begin = out.tellp();
+            list.front()->printValueFlow(true, out);
+            if (index)
+                *index << "valueflow " << begin << ' ' << out.tellp() << '\n';
+        }
+        return;
+    }
+
+    // where does each function's token region begin/end? Needed for the
+    // seek index so a dump reader can load one function without parsing
+    // the rest of the token list.
+    std::map<const Token *, const Scope *> functionBodyStart;
+    std::map<const Token *, const Scope *> functionBodyEnd;
+    std::map<const Scope *, std::ostream::pos_type> functionRegionBegin;
+    if (index && mSymbolDatabase) {
+        for (const Scope *scope : mSymbolDatabase->functionScopes) {
+            if (scope->bodyStart && scope->bodyEnd) {
+                functionBodyStart[scope->bodyStart] = scope;
+                functionBodyEnd[scope->bodyEnd] = scope;
+            }
+        }
+    }
+
     // tokens..
-    out << "  <tokenlist>" << std::endl;
+    const std::ostream::pos_type tokenlistBegin = out.tellp();
+    out << "  <tokenlist>" << '\n';
+    // file name table; the tokens reference the names by index so the
+    // names are not repeated for every token
+    for (std::size_t fileIndex = 0; fileIndex < list.getFiles().size(); ++fileIndex)
+        out << "    <file index=\"" << fileIndex << "\" name=\"" << ErrorLogger::toxml(list.getFiles()[fileIndex]) << "\"/>" << '\n';
     for (const Token *tok = list.front(); tok; tok = tok->next()) {
-        out << "    <token id=\"" << tok << "\" file=\"" << ErrorLogger::toxml(list.file(tok)) << "\" linenr=\"" << tok->linenr() << '\"';
+        if (index) {
+            const std::map<const Token *, const Scope *>::const_iterator it = functionBodyStart.find(tok);
+            if (it != functionBodyStart.end())
+                functionRegionBegin[it->second] = out.tellp();
+        }
+        out << "    <token id=\"" << tok << "\" fileIndex=\"" << tok->fileIndex() << "\" linenr=\"" << tok->linenr() << '\"';
         out << " str=\"" << ErrorLogger::toxml(tok->str()) << '\"';
-        out << " scope=\"" << tok->scope() << '\"';
+        if (dumpSymbols)
+            out << " scope=\"" << tok->scope() << '\"';
         if (tok->isName()) {
             out << " type=\"name\"";
             if (tok->isUnsigned())
@@ -4227,13 +4446,13 @@ void Tokenizer::dump(std::ostream &out) const
             out << " link=\"" << tok->link() << '\"';
         if (tok->varId() > 0U)
             out << " varId=\"" << MathLib::toString(tok->varId()) << '\"';
-        if (tok->variable())
+        if (dumpSymbols && tok->variable())
             out << " variable=\"" << tok->variable() << '\"';
-        if (tok->function())
+        if (dumpSymbols && tok->function())
             out << " function=\"" << tok->function() << '\"';
-        if (!tok->values().empty())
+        if (dumpValueflow && !tok->values().empty())
             out << " values=\"" << &tok->values() << '\"';
-        if (tok->type())
+        if (dumpSymbols && tok->type())
             out << " type-scope=\"" << tok->type()->classScope << '\"';
         if (tok->astParent())
             out << " astParent=\"" << tok->astParent() << '\"';
@@ -4243,18 +4462,33 @@ void Tokenizer::dump(std::ostream &out) const
             out << " astOperand2=\"" << tok->astOperand2() << '\"';
         if (!tok->originalName().empty())
             out << " originalName=\"" << tok->originalName() << '\"';
-        if (tok->valueType()) {
-            const std::string vt = tok->valueType()->dump();
-            if (!vt.empty())
-                out << ' ' << vt;
-        }
-        out << "/>" << std::endl;
-    }
-    out << "  </tokenlist>" << std::endl;
-
-    mSymbolDatabase->printXml(out);
-    if (list.front())
+        if (tok->valueType())
+            tok->valueType()->dump(out, dumpSymbols);
+        // '\n' and not std::endl, a flush per token is measurable on big dumps
+        out << "/>" << '\n';
+        if (index) {
+            const std::map<const Token *, const Scope *>::const_iterator it = functionBodyEnd.find(tok);
+            if (it != functionBodyEnd.end() && functionRegionBegin.find(it->second) != functionRegionBegin.end())
+                *index << "function " << functionRegionBegin[it->second] << ' ' << out.tellp()
+                       << " name=\"" << ErrorLogger::toxml(it->second->className) << "\"\n";
+        }
+    }
+    out << "  </tokenlist>" << '\n';
+    if (index)
+        *index << "tokenlist " << tokenlistBegin << ' ' << out.tellp() << '\n';
+
+    if (dumpSymbols) {
+        const std::ostream::pos_type begin = out.tellp();
+        mSymbolDatabase->printXml(out);
+        if (index)
+            *index << "symbols " << begin << ' ' << out.tellp() << '\n';
+    }
+    if (dumpValueflow && list.front()) {
+        const std::ostream::pos_type begin = out.tellp();
         list.front()->printValueFlow(true, out);
+        if (index)
+            *index << "valueflow " << begin << ' ' << out.tellp() << '\n';
+    }
 }
 
 void Tokenizer::removeMacrosInGlobalScope()
@@ -9645,15 +9879,44 @@ void Tokenizer::simplifyNamespaceStd()
 }
 
 
-void Tokenizer::simplifyMicrosoftMemoryFunctions()
-{
-    // skip if not Windows
-    if (!mSettings->isWindowsPlatform())
-        return;
+namespace {
+    /**
+     * Fused engine for independent local token rewrites. Each rule registers
+     * the token texts that trigger it; a single traversal then dispatches
+     * all rules through a trigger index instead of every pass re-walking the
+     * whole token list. Rules must only inspect and rewrite tokens from the
+     * trigger position forward, so that one fused traversal is equivalent to
+     * running the passes back to back.
+     */
+    class FusedSimplifier {
+    public:
+        void addRule(const std::vector<std::string> &triggers, const std::function<void(Token *)> &rewrite) {
+            mRewrites.push_back(rewrite);
+            for (const std::string &trigger : triggers)
+                mTriggers[trigger].push_back(mRewrites.size() - 1);
+        }
+
+        void run(TokenList &tokenlist) const {
+            for (Token *tok = tokenlist.front(); tok; tok = tok->next()) {
+                const std::unordered_map<std::string, std::vector<std::size_t> >::const_iterator it = mTriggers.find(tok->str());
+                if (it == mTriggers.end())
+                    continue;
+                for (const std::size_t ruleIndex : it->second)
+                    mRewrites[ruleIndex](tok);
+            }
+        }
 
-    for (Token *tok = list.front(); tok; tok = tok->next()) {
+    private:
+        std::vector<std::function<void(Token *)> > mRewrites;
+        std::unordered_map<std::string, std::vector<std::size_t> > mTriggers;
+    };
+}
+
+static void simplifyMicrosoftMemoryFunction(Token *tok)
+{
+    {
         if (tok->strAt(1) != "(")
-            continue;
+            return;
 
         if (Token::Match(tok, "CopyMemory|RtlCopyMemory|RtlCopyBytes")) {
             tok->str("memcpy");
@@ -9740,16 +10003,11 @@ namespace {
     };
 }
 
-void Tokenizer::simplifyMicrosoftStringFunctions()
+static void simplifyMicrosoftStringFunction(Token *tok, bool ansi)
 {
-    // skip if not Windows
-    if (!mSettings->isWindowsPlatform())
-        return;
-
-    const bool ansi = mSettings->platformType == Settings::Win32A;
-    for (Token *tok = list.front(); tok; tok = tok->next()) {
+    {
         if (tok->strAt(1) != "(")
-            continue;
+            return;
 
         const std::map<std::string, triplet>::const_iterator match = apis.find(tok->str());
         if (match!=apis.end()) {
@@ -9772,6 +10030,36 @@ void Tokenizer::simplifyMicrosoftStringFunctions()
     }
 }
 
+void Tokenizer::simplifyMicrosoftFunctions()
+{
+    // skip if not Windows
+    if (!mSettings->isWindowsPlatform())
+        return;
+
+    FusedSimplifier fused;
+
+    fused.addRule({"CopyMemory", "RtlCopyMemory", "RtlCopyBytes",
+                   "MoveMemory", "RtlMoveMemory",
+                   "FillMemory", "RtlFillMemory", "RtlFillBytes",
+                   "ZeroMemory", "RtlZeroMemory", "RtlZeroBytes", "RtlSecureZeroMemory",
+                   "RtlCompareMemory"
+                  },
+                  simplifyMicrosoftMemoryFunction);
+
+    std::vector<std::string> stringFunctionTriggers;
+    for (std::map<std::string, triplet>::const_iterator it = apis.begin(); it != apis.end(); ++it)
+        stringFunctionTriggers.push_back(it->first);
+    stringFunctionTriggers.push_back("_T");
+    stringFunctionTriggers.push_back("_TEXT");
+    stringFunctionTriggers.push_back("TEXT");
+    const bool ansi = mSettings->platformType == Settings::Win32A;
+    fused.addRule(stringFunctionTriggers, [ansi](Token *tok) {
+        simplifyMicrosoftStringFunction(tok, ansi);
+    });
+
+    fused.run(list);
+}
+
 // Remove Borland code
 void Tokenizer::simplifyBorland()
 {
@@ -9890,6 +10178,18 @@ void Tokenizer::deleteSymbolDatabase()
     mSymbolDatabase = nullptr;
 }
 
+void Tokenizer::stampLibraryAnnotations()
+{
+    mLibraryAnnotations.clear();
+    for (const Token *tok = list.front(); tok; tok = tok->next()) {
+        if (!tok->isName())
+            continue;
+        Library::Annotation annotation;
+        if (mSettings->library.annotate(tok, &annotation))
+            mLibraryAnnotations[tok] = annotation;
+    }
+}
+
 static bool operatorEnd(const Token * tok)
 {
     if (tok && tok->str() == ")") {
@@ -10585,7 +10885,7 @@ void Tokenizer::VariableMap::addVariable(const std::string &varname)
         mVariableId[varname] = ++mVarId;
         return;
     }
-    std::map<std::string, unsigned int>::iterator it = mVariableId.find(varname);
+    std::unordered_map<std::string, unsigned int>::iterator it = mVariableId.find(varname);
     if (it == mVariableId.end()) {
         mScopeInfo.top().push_back(std::pair<std::string, unsigned int>(varname, 0));
         mVariableId[varname] = ++mVarId;
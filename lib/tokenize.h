@@ -23,19 +23,23 @@
 
 #include "config.h"
 #include "errorlogger.h"
+#include "library.h"
 #include "tokenlist.h"
 
 #include <ctime>
+#include <functional>
 #include <list>
 #include <map>
 #include <string>
 #include <stack>
+#include <unordered_map>
 
 class Settings;
 class SymbolDatabase;
 class TimerResults;
 class Token;
 class TemplateSimplifier;
+class TemplateExpansionCache;
 
 namespace simplecpp {
     class TokenList;
@@ -58,7 +62,7 @@ class CPPCHECKLIB Tokenizer {
     /** Class used in Tokenizer::setVarIdPass1 */
     class VariableMap {
     private:
-        std::map<std::string, unsigned int> mVariableId;
+        std::unordered_map<std::string, unsigned int> mVariableId;
         std::stack<std::list<std::pair<std::string, unsigned int> > > mScopeInfo;
         mutable unsigned int mVarId;
     public:
@@ -67,13 +71,13 @@ class CPPCHECKLIB Tokenizer {
         bool leaveScope();
         void addVariable(const std::string &varname);
         bool hasVariable(const std::string &varname) const;
-        std::map<std::string, unsigned int>::const_iterator find(const std::string &varname) const {
+        std::unordered_map<std::string, unsigned int>::const_iterator find(const std::string &varname) const {
             return mVariableId.find(varname);
         }
-        std::map<std::string, unsigned int>::const_iterator end() const {
+        std::unordered_map<std::string, unsigned int>::const_iterator end() const {
             return mVariableId.end();
         }
-        const std::map<std::string, unsigned int> &map() const {
+        const std::unordered_map<std::string, unsigned int> &map() const {
             return mVariableId;
         }
         unsigned int *getVarId() const {
@@ -91,6 +95,10 @@ public:
         mTimerResults = tr;
     }
 
+    /** Share template expansion output with the other configurations of
+     * the file, see TemplateExpansionCache. */
+    void setTemplateExpansionCache(TemplateExpansionCache *cache);
+
     /** Is the code C. Used for bailouts */
     bool isC() const {
         return list.isC();
@@ -154,6 +162,13 @@ public:
     */
     bool simplifyTokenList1(const char FileName[]);
 
+    /**
+     * Run a single simplification pass. With --showtime the pass is timed
+     * under "Tokenizer::simplifyTokenList1::<name>" so slow passes can be
+     * identified per file / per run.
+     */
+    void simplifyPass(const char name[], const std::function<void()> &pass);
+
     void SimplifyNamelessRValueReferences();
 
     /**
@@ -681,19 +696,14 @@ private:
     void simplifyNamespaceStd();
 
     /**
-    * Convert Microsoft memory functions
+    * Convert Microsoft memory and string functions in one fused traversal:
     * CopyMemory(dst, src, len) -> memcpy(dst, src, len)
     * FillMemory(dst, len, val) -> memset(dst, val, len)
     * MoveMemory(dst, src, len) -> memmove(dst, src, len)
     * ZeroMemory(dst, len) -> memset(dst, 0, len)
-    */
-    void simplifyMicrosoftMemoryFunctions();
-
-    /**
-    * Convert Microsoft string functions
     * _tcscpy -> strcpy
     */
-    void simplifyMicrosoftStringFunctions();
+    void simplifyMicrosoftFunctions();
 
     /**
       * Remove Borland code
@@ -791,6 +801,20 @@ public:
     void createSymbolDatabase();
     void deleteSymbolDatabase();
 
+    /**
+     * Resolve the library annotations (function entry, alloc/dealloc info,
+     * noreturn) for every function call token in one pass, so checks can
+     * use libraryAnnotation() instead of repeating the name lookup in the
+     * library for every query. Called after each simplification stage.
+     */
+    void stampLibraryAnnotations();
+
+    /** Library annotations for a call token, or nullptr if it has none */
+    const Library::Annotation *libraryAnnotation(const Token *tok) const {
+        const std::unordered_map<const Token *, Library::Annotation>::const_iterator it = mLibraryAnnotations.find(tok);
+        return (it != mLibraryAnnotations.end()) ? &it->second : nullptr;
+    }
+
     /** print --debug output if debug flags match the simplification:
      * 0=unknown/both simplifications
      * 1=1st simplifications
@@ -798,7 +822,11 @@ public:
      */
     void printDebugOutput(unsigned int simplification) const;
 
-    void dump(std::ostream &out) const;
+    /** Create the xml data dump. When @p index is given, one line per
+     * section and per function token region is appended to it with the
+     * byte offsets of the region in @p out, so dump readers can seek
+     * straight to one function instead of parsing the whole document. */
+    void dump(std::ostream &out, std::ostream *index = nullptr) const;
 
     Token *deleteInvalidTypedef(Token *typeDef);
 
@@ -848,13 +876,15 @@ public:
     */
     static const Token * startOfExecutableScope(const Token * tok);
 
-#ifdef MAXTIME
     bool isMaxTime() const {
-        return (std::time(0) > mMaxTime);
-#else
-    static bool isMaxTime() {
-        return false;
-#endif
+        return mMaxTime > 0 && (std::time(0) > mMaxTime);
+    }
+
+    /** @brief Set the deadline after which the remaining passes are
+     * abandoned, 0 = no deadline. Used for --max-time-per-file; the
+     * MAXTIME define sets a default in the constructors. */
+    void setMaxTime(std::time_t maxTime) {
+        mMaxTime = maxTime;
     }
 
 private:
@@ -886,6 +916,9 @@ private:
     /** Symbol database that all checks etc can use */
     SymbolDatabase *mSymbolDatabase;
 
+    /** Library annotations per call token, see stampLibraryAnnotations() */
+    std::unordered_map<const Token *, Library::Annotation> mLibraryAnnotations;
+
     TemplateSimplifier *mTemplateSimplifier;
 
     /** E.g. "A" for code where "#ifdef A" is true. This is used to
@@ -912,10 +945,9 @@ private:
      */
     TimerResults *mTimerResults;
 
-#ifdef MAXTIME
-    /** Tokenizer maxtime */
-    const std::time_t mMaxTime;
-#endif
+    /** The deadline after which the remaining passes are abandoned,
+     * 0 = no deadline. See setMaxTime(). */
+    std::time_t mMaxTime;
 };
 
 /// @}
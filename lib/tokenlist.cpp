@@ -19,6 +19,7 @@
 //---------------------------------------------------------------------------
 #include "tokenlist.h"
 
+#include "astutils.h"
 #include "errorlogger.h"
 #include "mathlib.h"
 #include "path.h"
@@ -28,6 +29,7 @@
 #include <simplecpp.h>
 #include <cctype>
 #include <cstring>
+#include <map>
 #include <set>
 #include <stack>
 
@@ -65,9 +67,15 @@ const std::string& TokenList::getSourceFilePath() const
 // Deallocate lists..
 void TokenList::deallocateTokens()
 {
+    // a deallocated token address can be reused, drop the caches that are
+    // keyed by token addresses
+    clearAstCaches();
     deleteTokens(mTokensFrontBack.front);
     mTokensFrontBack.front = nullptr;
     mTokensFrontBack.back = nullptr;
+    mFlatAst.clear();
+    mVarIdIndex.clear();
+    mValueTokenIndex.clear();
     mFiles.clear();
 }
 
@@ -215,6 +223,43 @@ Token *TokenList::copyTokens(Token *dest, const Token *first, const Token *last,
     return tok2;
 }
 
+//---------------------------------------------------------------------------
+// spliceTokens - Splice a detached token run into this list
+//---------------------------------------------------------------------------
+
+void TokenList::spliceTokens(Token *dest, TokenList &run)
+{
+    Token * const first = run.mTokensFrontBack.front;
+    Token * const last = run.mTokensFrontBack.back;
+    if (!first)
+        return;
+
+    // The tokens change owner; rebind them so that insertions at the ends of
+    // the destination list keep its front/back pointers updated.
+    for (Token *tok = first; tok; tok = tok->next())
+        tok->mTokensFrontBack = &mTokensFrontBack;
+
+    if (dest) {
+        last->next(dest->next());
+        if (dest->next())
+            dest->next()->previous(last);
+        else
+            mTokensFrontBack.back = last;
+        dest->next(first);
+        first->previous(dest);
+    } else {
+        last->next(mTokensFrontBack.front);
+        if (mTokensFrontBack.front)
+            mTokensFrontBack.front->previous(last);
+        else
+            mTokensFrontBack.back = last;
+        mTokensFrontBack.front = first;
+    }
+
+    run.mTokensFrontBack.front = nullptr;
+    run.mTokensFrontBack.back = nullptr;
+}
+
 //---------------------------------------------------------------------------
 // InsertTokens - Copy and insert tokens
 //---------------------------------------------------------------------------
@@ -282,27 +327,34 @@ void TokenList::createTokens(const simplecpp::TokenList *tokenList)
 
     for (const simplecpp::Token *tok = tokenList->cfront(); tok; tok = tok->next) {
 
-        std::string str = tok->str();
+        // In the common case the token text is used as-is and Token interns
+        // it, so don't copy it into an intermediate string first.
+        const std::string *strPtr = &tok->str();
+        std::string modifiedStr;
 
         // Replace hexadecimal value with decimal
         // TODO: Remove this
-        const bool isHex = MathLib::isIntHex(str) ;
-        if (isHex || MathLib::isOct(str) || MathLib::isBin(str)) {
+        const bool isHex = MathLib::isIntHex(*strPtr) ;
+        if (isHex || MathLib::isOct(*strPtr) || MathLib::isBin(*strPtr)) {
             // TODO: It would be better if TokenList didn't simplify hexadecimal numbers
             std::string suffix;
             if (isHex &&
                 mSettings &&
-                str.size() == (2 + mSettings->int_bit / 4) &&
-                (str[2] >= '8') &&  // includes A-F and a-f
-                MathLib::getSuffix(str).empty()
+                strPtr->size() == (2 + mSettings->int_bit / 4) &&
+                ((*strPtr)[2] >= '8') &&  // includes A-F and a-f
+                MathLib::getSuffix(*strPtr).empty()
                )
                 suffix = "U";
-            str = MathLib::value(str).str() + suffix;
+            modifiedStr = MathLib::value(*strPtr).str() + suffix;
+            strPtr = &modifiedStr;
         }
 
         // Float literal
-        if (str.size() > 1 && str[0] == '.' && std::isdigit(str[1]))
-            str = '0' + str;
+        if (strPtr->size() > 1 && (*strPtr)[0] == '.' && std::isdigit((*strPtr)[1])) {
+            modifiedStr = '0' + *strPtr;
+            strPtr = &modifiedStr;
+        }
+        const std::string &str = *strPtr;
 
         if (mTokensFrontBack.back) {
             mTokensFrontBack.back->insertToken(str);
@@ -330,25 +382,34 @@ void TokenList::createTokens(const simplecpp::TokenList *tokenList)
 
 //---------------------------------------------------------------------------
 
+/** 64-bit avalanche mixer (the xxHash/murmur finalizer) */
+static unsigned long long mixChecksum(unsigned long long h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
 unsigned long long TokenList::calculateChecksum() const
 {
+    // The checksum is only compared against checksums of other
+    // configurations of the same file within this run, so the identity of
+    // the interned token text can be hashed instead of re-walking every
+    // character of every token. Each token then contributes a constant
+    // amount of mixing work.
     unsigned long long checksum = 0;
     for (const Token* tok = front(); tok; tok = tok->next()) {
-        const unsigned int subchecksum1 = tok->flags() + tok->varId() + tok->tokType();
-        unsigned int subchecksum2 = 0;
-        for (std::size_t i = 0; i < tok->str().size(); i++)
-            subchecksum2 += (unsigned int)tok->str()[i];
+        unsigned long long subchecksum = tok->flags() + tok->varId() + tok->tokType();
+        subchecksum += (unsigned long long)(std::size_t)&tok->str();
         if (!tok->originalName().empty()) {
             for (std::size_t i = 0; i < tok->originalName().size(); i++)
-                subchecksum2 += (unsigned int) tok->originalName()[i];
+                subchecksum += (unsigned int) tok->originalName()[i];
         }
 
-        checksum ^= ((static_cast<unsigned long long>(subchecksum1) << 32) | subchecksum2);
-
-        const bool bit1 = (checksum & 1) != 0;
-        checksum >>= 1;
-        if (bit1)
-            checksum |= (1ULL << 63);
+        checksum = mixChecksum(checksum ^ subchecksum);
     }
     return checksum;
 }
@@ -1189,10 +1250,95 @@ void TokenList::createAst()
     for (Token *tok = mTokensFrontBack.front; tok; tok = tok ? tok->next() : nullptr) {
         tok = createAstAtToken(tok, isCPP());
     }
+
+    // Build the flattened AST: one contiguous node per token that takes part
+    // in the AST, in token order, with integer indices instead of pointers.
+    mFlatAst.clear();
+    std::map<const Token *, int> astIndex;
+    for (Token *tok = mTokensFrontBack.front; tok; tok = tok->next()) {
+        if (!tok->astParent() && !tok->astOperand1() && !tok->astOperand2())
+            continue;
+        astIndex[tok] = (int)mFlatAst.size();
+        AstNode node;
+        node.tok = tok;
+        node.operand1 = node.operand2 = node.parent = -1;
+        mFlatAst.push_back(node);
+    }
+    for (AstNode &node : mFlatAst) {
+        const Token * const tok = node.tok;
+        if (tok->astOperand1()) {
+            const std::map<const Token *, int>::const_iterator it = astIndex.find(tok->astOperand1());
+            if (it != astIndex.end())
+                node.operand1 = it->second;
+        }
+        if (tok->astOperand2()) {
+            const std::map<const Token *, int>::const_iterator it = astIndex.find(tok->astOperand2());
+            if (it != astIndex.end())
+                node.operand2 = it->second;
+        }
+        if (tok->astParent()) {
+            const std::map<const Token *, int>::const_iterator it = astIndex.find(tok->astParent());
+            if (it != astIndex.end())
+                node.parent = it->second;
+        }
+    }
+}
+
+void TokenList::createVarIdIndex()
+{
+    mVarIdIndex.clear();
+    for (const Token *tok = mTokensFrontBack.front; tok; tok = tok->next()) {
+        const unsigned int varId = tok->varId();
+        if (varId == 0)
+            continue;
+        if (varId >= mVarIdIndex.size())
+            mVarIdIndex.resize(varId + 1U);
+        mVarIdIndex[varId].push_back(tok);
+    }
+}
+
+const std::vector<const Token *> &TokenList::varIdTokens(unsigned int varId) const
+{
+    static const std::vector<const Token *> emptyTokenVector;
+    if (varId == 0 || varId >= mVarIdIndex.size())
+        return emptyTokenVector;
+    return mVarIdIndex[varId];
+}
+
+const Token *TokenList::findVarIdMatch(const char pattern[], unsigned int varId) const
+{
+    if (mVarIdIndex.empty())
+        return Token::findmatch(mTokensFrontBack.front, pattern, varId);
+    if (varId >= mVarIdIndex.size())
+        return nullptr;
+    for (const Token *tok : mVarIdIndex[varId]) {
+        if (Token::Match(tok, pattern, varId))
+            return tok;
+    }
+    return nullptr;
+}
+
+void TokenList::createValueTokenIndex()
+{
+    mValueTokenIndex.clear();
+    for (const Token *tok = mTokensFrontBack.front; tok; tok = tok->next()) {
+        if (!tok->values().empty())
+            mValueTokenIndex.push_back(tok);
+    }
 }
 
 void TokenList::validateAst() const
 {
+    // The endless recursion check below tracks every visited AST token in
+    // a set, which is a visible slice of the tokenizer time on huge files.
+    // Unless a debug mode is active the cheap structural checks still run
+    // for every token but the recursion check is sampled, with a depth
+    // bound instead of the set - a cycle exceeds any depth bound.
+    const bool fullValidation = !mSettings ||
+                                mSettings->debugSimplified || mSettings->debugnormal ||
+                                mSettings->debugwarnings || mSettings->debugtemplate;
+    unsigned int sampleCounter = 0;
+
     // Check for some known issues in AST to avoid crash/hang later on
     std::set < const Token* > safeAstTokens; // list of "safe" AST tokens without endless recursion
     for (const Token *tok = mTokensFrontBack.front; tok; tok = tok->next()) {
@@ -1206,21 +1352,29 @@ void TokenList::validateAst() const
 
         // Check for endless recursion
         const Token* parent = tok->astParent();
-        if (parent) {
-            std::set < const Token* > astTokens; // list of anchestors
-            astTokens.insert(tok);
-            do {
-                if (safeAstTokens.find(parent) != safeAstTokens.end())
-                    break;
-                if (astTokens.find(parent) != astTokens.end())
-                    throw InternalError(tok, "AST broken: endless recursion from '" + tok->str() + "'", InternalError::AST);
-                astTokens.insert(parent);
-            } while ((parent = parent->astParent()) != nullptr);
-            safeAstTokens.insert(astTokens.begin(), astTokens.end());
-        } else if (tok->str() == ";") {
-            safeAstTokens.clear();
-        } else {
-            safeAstTokens.insert(tok);
+        if (fullValidation) {
+            if (parent) {
+                std::set < const Token* > astTokens; // list of anchestors
+                astTokens.insert(tok);
+                do {
+                    if (safeAstTokens.find(parent) != safeAstTokens.end())
+                        break;
+                    if (astTokens.find(parent) != astTokens.end())
+                        throw InternalError(tok, "AST broken: endless recursion from '" + tok->str() + "'", InternalError::AST);
+                    astTokens.insert(parent);
+                } while ((parent = parent->astParent()) != nullptr);
+                safeAstTokens.insert(astTokens.begin(), astTokens.end());
+            } else if (tok->str() == ";") {
+                safeAstTokens.clear();
+            } else {
+                safeAstTokens.insert(tok);
+            }
+        } else if (parent && (++sampleCounter & 0xF) == 0) {
+            unsigned int depth = 0;
+            while (parent && ++depth <= 1000)
+                parent = parent->astParent();
+            if (parent)
+                throw InternalError(tok, "AST broken: endless recursion from '" + tok->str() + "'", InternalError::AST);
         }
 
         // Check binary operators
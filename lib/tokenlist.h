@@ -74,6 +74,17 @@ public:
 
     static void insertTokens(Token *dest, const Token *src, unsigned int n);
 
+    /**
+     * Splice all tokens of the given list into this list in one operation.
+     * The run is inserted after dest, or at the front of the list if dest is
+     * nullptr. Building a detached run and splicing it once is much cheaper
+     * than relinking the big list for every inserted token. The run list is
+     * left empty.
+     * @param dest token after which the run is inserted (must belong to this list)
+     * @param run detached token run; emptied by the call
+     */
+    void spliceTokens(Token *dest, TokenList &run);
+
     /**
      * Copy tokens.
      * @param dest destination token where copied tokens will be inserted after
@@ -155,6 +166,70 @@ public:
      */
     void createAst();
 
+    /**
+     * @brief Flattened AST node, see TokenList::flatAst().
+     *
+     * The per-token AST pointers (astOperand1/astOperand2/astParent) force
+     * consumers to chase pointers all over the heap. The flat AST mirrors the
+     * tree in one contiguous array in token order, with integer indices
+     * instead of pointers, so hot traversals can iterate it cache-linearly.
+     * An index of -1 means "no such node".
+     */
+    struct AstNode {
+        Token *tok;
+        int operand1;
+        int operand2;
+        int parent;
+    };
+
+    /**
+     * Flattened AST for the whole token list. Rebuilt by createAst(); empty
+     * until createAst() has been executed.
+     */
+    const std::vector<AstNode> &flatAst() const {
+        return mFlatAst;
+    }
+
+    /**
+     * Build the varid → occurrence index, see varIdTokens(). Must be called
+     * after variable ids have been assigned; any change to the token list
+     * invalidates the index until the next call.
+     */
+    void createVarIdIndex();
+
+    /**
+     * All tokens with the given variable id, in token order. Empty if the
+     * id does not occur or createVarIdIndex() has not been executed. For
+     * read/write classified per-function queries see DefUseIndex in
+     * astutils.h; this index answers whole-list occurrence questions.
+     */
+    const std::vector<const Token *> &varIdTokens(unsigned int varId) const;
+
+    /**
+     * Fast path for whole-list Token::findmatch() scans whose pattern is
+     * anchored on "%varid%": only the occurrences of the variable id are
+     * visited instead of every token. Falls back to a linear scan when the
+     * index has not been built.
+     */
+    const Token *findVarIdMatch(const char pattern[], unsigned int varId) const;
+
+    /**
+     * Build the index of tokens that carry valueflow values, see
+     * valueTokens(). Called at the end of ValueFlow::setValues(); any
+     * change to the values invalidates the index until the next call.
+     */
+    void createValueTokenIndex();
+
+    /**
+     * All tokens that carry at least one valueflow value, in token order.
+     * Empty if createValueTokenIndex() has not been executed. Only a small
+     * fraction of the tokens carries values, so value-driven checks can
+     * iterate this index instead of the whole list.
+     */
+    const std::vector<const Token *> &valueTokens() const {
+        return mValueTokenIndex;
+    }
+
     /**
      * Check abstract syntax tree.
      * Throws InternalError on failure
@@ -186,6 +261,15 @@ private:
     /** Token list */
     TokensFrontBack mTokensFrontBack;
 
+    /** Flattened AST, rebuilt by createAst() */
+    std::vector<AstNode> mFlatAst;
+
+    /** varid → occurrences, rebuilt by createVarIdIndex() */
+    std::vector<std::vector<const Token *> > mVarIdIndex;
+
+    /** tokens carrying valueflow values, rebuilt by createValueTokenIndex() */
+    std::vector<const Token *> mValueTokenIndex;
+
     /** filenames for the tokenized source code (source + included) */
     std::vector<std::string> mFiles;
 
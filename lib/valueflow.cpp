@@ -91,17 +91,64 @@
 #include "path.h"
 
 #include <algorithm>
+#include <cstring>
 #include <cstddef>
 #include <functional>
 #include <iterator>
 #include <limits>
 #include <map>
 #include <set>
+#include <sstream>
 #include <stack>
 #include <vector>
 
 static const int TIMEOUT = 10; // Do not repeat ValueFlow analysis more than 10 seconds
 
+namespace {
+    /** Effort bookkeeping for Settings::valueFlowMaxEffort. Tracks how many
+     *  token visits the forward analysis has spent per function so that
+     *  pathological (usually generated) functions get a predictable ceiling
+     *  instead of minutes of analysis. */
+    struct ValueFlowEffort {
+        std::map<const Scope *, std::size_t> visits;
+        std::set<const Scope *> exhausted;
+
+        void reset() {
+            visits.clear();
+            exhausted.clear();
+        }
+
+        static const Scope *functionScope(const Token *tok) {
+            const Scope *scope = tok ? tok->scope() : nullptr;
+            while (scope && scope->type != Scope::eFunction && scope->type != Scope::eLambda)
+                scope = scope->nestedIn;
+            return scope;
+        }
+    };
+
+    static thread_local ValueFlowEffort valueFlowEffort;
+
+    /** Statistics collected during setValues() and written as JSON with
+     *  --valueflow-stats. Coarser than a profiler but answers "which pass
+     *  creates the values / which bailout fires" without attaching perf. */
+    struct ValueFlowStats {
+        std::map<std::string, std::size_t> valuesAddedPerPass;
+        std::map<std::string, std::size_t> bailoutsPerFunction;
+
+        void reset() {
+            valuesAddedPerPass.clear();
+            bailoutsPerFunction.clear();
+        }
+
+        void recordPass(const char pass[], std::size_t added) {
+            const char * const par = std::strchr(pass, '(');
+            valuesAddedPerPass[par ? std::string(pass, par - pass) : std::string(pass)] += added;
+        }
+    };
+
+    static thread_local ValueFlowStats valueFlowStats;
+}
+
 namespace {
     struct ProgramMemory {
         std::map<unsigned int, ValueFlow::Value> values;
@@ -155,6 +202,7 @@ static void execute(const Token *expr,
 
 static void bailoutInternal(TokenList *tokenlist, ErrorLogger *errorLogger, const Token *tok, const std::string &what, const std::string &file, int line, const std::string &function)
 {
+    ++valueFlowStats.bailoutsPerFunction[function];
     std::list<ErrorLogger::ErrorMessage::FileLocation> callstack(1, ErrorLogger::ErrorMessage::FileLocation(tok, tokenlist));
     ErrorLogger::ErrorMessage errmsg(callstack, tokenlist->getSourceFilePath(), Severity::debug,
                                      Path::stripDirectoryPart(file) + ":" + MathLib::toString(line) + ":" + function + " bailout: " + what, "valueFlowBailout", false);
@@ -169,9 +217,9 @@ static void bailoutInternal(TokenList *tokenlist, ErrorLogger *errorLogger, cons
 #define bailout(tokenlist, errorLogger, tok, what) bailoutInternal(tokenlist, errorLogger, tok, what, __FILE__, __LINE__, "(valueFlow)")
 #endif
 
-static void changeKnownToPossible(std::list<ValueFlow::Value> &values)
+static void changeKnownToPossible(ValueFlow::ValueList &values)
 {
-    std::list<ValueFlow::Value>::iterator it;
+    ValueFlow::ValueList::iterator it;
     for (it = values.begin(); it != values.end(); ++it)
         it->changeKnownToPossible();
 }
@@ -479,7 +527,7 @@ static void setTokenValue(Token* tok, const ValueFlow::Value &value, const Setti
                 const Token *op = cond ? tok->astOperand1() : tok->astOperand2();
                 if (!op) // #7769 segmentation fault at setTokenValue()
                     return;
-                const std::list<ValueFlow::Value> &values = op->values();
+                const ValueFlow::ValueList &values = op->values();
                 if (std::find(values.begin(), values.end(), value) != values.end())
                     setTokenValue(parent, value, settings);
             }
@@ -713,12 +761,10 @@ static void setTokenValue(Token* tok, const ValueFlow::Value &value, const Setti
             if (settings &&
                 tok->valueType() &&
                 tok->valueType()->sign == ValueType::Sign::UNSIGNED &&
-                tok->valueType()->pointer == 0) {
-                if (tok->valueType()->type == ValueType::Type::INT)
-                    bits = settings->int_bit;
-                else if (tok->valueType()->type == ValueType::Type::LONG)
-                    bits = settings->long_bit;
-            }
+                tok->valueType()->pointer == 0 &&
+                (tok->valueType()->type == ValueType::Type::INT ||
+                 tok->valueType()->type == ValueType::Type::LONG))
+                bits = tok->valueType()->typeBits(*settings);
             if (bits > 0 && bits < MathLib::bigint_bits)
                 v.intvalue &= (((MathLib::biguint)1)<<bits) - 1;
             setTokenValue(parent, v, settings);
@@ -791,16 +837,8 @@ static void setTokenValueCast(Token *parent, const ValueType &valueType, const V
 {
     if (valueType.pointer)
         setTokenValue(parent,value,settings);
-    else if (valueType.type == ValueType::Type::CHAR)
-        setTokenValue(parent, castValue(value, valueType.sign, settings->char_bit), settings);
-    else if (valueType.type == ValueType::Type::SHORT)
-        setTokenValue(parent, castValue(value, valueType.sign, settings->short_bit), settings);
-    else if (valueType.type == ValueType::Type::INT)
-        setTokenValue(parent, castValue(value, valueType.sign, settings->int_bit), settings);
-    else if (valueType.type == ValueType::Type::LONG)
-        setTokenValue(parent, castValue(value, valueType.sign, settings->long_bit), settings);
-    else if (valueType.type == ValueType::Type::LONGLONG)
-        setTokenValue(parent, castValue(value, valueType.sign, settings->long_long_bit), settings);
+    else if (valueType.type >= ValueType::Type::CHAR && valueType.type <= ValueType::Type::LONGLONG)
+        setTokenValue(parent, castValue(value, valueType.sign, valueType.typeBits(*settings)), settings);
     else if (value.isIntValue()) {
         const long long charMax = settings->signedCharMax();
         const long long charMin = settings->signedCharMin();
@@ -1096,7 +1134,7 @@ static void valueFlowArrayBool(TokenList *tokenlist)
             continue;
         const Variable *var = nullptr;
         bool known = false;
-        std::list<ValueFlow::Value>::const_iterator val =
+        ValueFlow::ValueList::const_iterator val =
             std::find_if(tok->values().begin(), tok->values().end(), std::mem_fn(&ValueFlow::Value::isTokValue));
         if (val == tok->values().end()) {
             var = tok->variable();
@@ -1407,17 +1445,8 @@ static void valueFlowRightShift(TokenList *tokenList, const Settings* settings)
             continue;
         if (lhsmax < 0)
             continue;
-        int lhsbits;
-        if ((tok->astOperand1()->valueType()->type == ValueType::Type::CHAR) ||
-            (tok->astOperand1()->valueType()->type == ValueType::Type::SHORT) ||
-            (tok->astOperand1()->valueType()->type == ValueType::Type::BOOL) ||
-            (tok->astOperand1()->valueType()->type == ValueType::Type::INT))
-            lhsbits = settings->int_bit;
-        else if (tok->astOperand1()->valueType()->type == ValueType::Type::LONG)
-            lhsbits = settings->long_bit;
-        else if (tok->astOperand1()->valueType()->type == ValueType::Type::LONGLONG)
-            lhsbits = settings->long_long_bit;
-        else
+        const int lhsbits = tok->astOperand1()->valueType()->promotedTypeBits(*settings);
+        if (lhsbits == 0)
             continue;
         if (rhsvalue >= lhsbits || rhsvalue >= MathLib::bigint_bits || (1ULL << rhsvalue) <= lhsmax)
             continue;
@@ -1822,9 +1851,9 @@ static void valueFlowBeforeCondition(TokenList *tokenlist, SymbolDatabase *symbo
     }
 }
 
-static void removeValues(std::list<ValueFlow::Value> &values, const std::list<ValueFlow::Value> &valuesToRemove)
+static void removeValues(ValueFlow::ValueList &values, const ValueFlow::ValueList &valuesToRemove)
 {
-    for (std::list<ValueFlow::Value>::iterator it = values.begin(); it != values.end();) {
+    for (ValueFlow::ValueList::iterator it = values.begin(); it != values.end();) {
         bool found = false;
         for (const ValueFlow::Value &v2 : valuesToRemove) {
             if (it->intvalue == v2.intvalue) {
@@ -1852,7 +1881,7 @@ static void valueFlowAST(Token *tok, unsigned int varid, const ValueFlow::Value
         if (conditionIsFalse(tok->astOperand1(), pm))
             return;
     } else if (tok->str() == "||" && tok->astOperand1()) {
-        const std::list<ValueFlow::Value> &values = tok->astOperand1()->values();
+        const ValueFlow::ValueList &values = tok->astOperand1()->values();
         bool nonzero = false;
         for (const ValueFlow::Value &v : values) {
             if (v.intvalue != 0) {
@@ -1873,13 +1902,13 @@ static void valueFlowAST(Token *tok, unsigned int varid, const ValueFlow::Value
 /** if known variable is changed in loop body, change it to a possible value */
 static void handleKnownValuesInLoop(const Token                 *startToken,
                                     const Token                 *endToken,
-                                    std::list<ValueFlow::Value> *values,
+                                    ValueFlow::ValueList *values,
                                     unsigned int                varid,
                                     bool                        globalvar,
                                     const Settings              *settings)
 {
     bool isChanged = false;
-    for (std::list<ValueFlow::Value>::iterator it = values->begin(); it != values->end(); ++it) {
+    for (ValueFlow::ValueList::iterator it = values->begin(); it != values->end(); ++it) {
         if (it->isKnown()) {
             if (!isChanged) {
                 if (!isVariableChanged(startToken, endToken, varid, globalvar, settings, true))
@@ -1940,7 +1969,7 @@ static bool valueFlowForward(Token * const               startToken,
                              const Token * const         endToken,
                              const Variable * const      var,
                              const unsigned int          varid,
-                             std::list<ValueFlow::Value> values,
+                             ValueFlow::ValueList values,
                              const bool                  constValue,
                              const bool                  subFunction,
                              TokenList * const           tokenlist,
@@ -1956,7 +1985,29 @@ static bool valueFlowForward(Token * const               startToken,
     if (values.empty())
         return true;
 
+    // effort budget: skip the forward analysis in functions that already
+    // used up their visits (--valueflow-max-effort)
+    std::size_t *effortVisits = nullptr;
+    if (settings->valueFlowMaxEffort > 0) {
+        const Scope * const functionScope = ValueFlowEffort::functionScope(startToken);
+        if (functionScope) {
+            if (valueFlowEffort.exhausted.find(functionScope) != valueFlowEffort.exhausted.end())
+                return false;
+            effortVisits = &valueFlowEffort.visits[functionScope];
+            if (*effortVisits >= settings->valueFlowMaxEffort) {
+                valueFlowEffort.exhausted.insert(functionScope);
+                if (errorLogger && !tokenlist->getFiles().empty())
+                    errorLogger->reportProgress(tokenlist->getFiles()[0], "ValueFlow (effort budget exceeded, reduced precision)", startToken->progressValue());
+                if (settings->debugwarnings)
+                    bailout(tokenlist, errorLogger, startToken, "valueFlowForward, effort budget exceeded in this function");
+                return false;
+            }
+        }
+    }
+
     for (Token *tok2 = startToken; tok2 && tok2 != endToken; tok2 = tok2->next()) {
+        if (effortVisits)
+            ++*effortVisits;
         if (indentlevel >= 0 && tok2->str() == "{")
             ++indentlevel;
         else if (indentlevel >= 0 && tok2->str() == "}") {
@@ -1978,7 +2029,7 @@ static bool valueFlowForward(Token * const               startToken,
 
                 bool bailoutflag = false;
                 const Token * const start1 = iselse ? tok2->link()->linkAt(-2) : nullptr;
-                for (std::list<ValueFlow::Value>::iterator it = values.begin(); it != values.end();) {
+                for (ValueFlow::ValueList::iterator it = values.begin(); it != values.end();) {
                     if (!iselse && conditionIsTrue(condition, getProgramMemory(condition->astParent(), varid, *it))) {
                         bailoutflag = true;
                         break;
@@ -2096,8 +2147,8 @@ static bool valueFlowForward(Token * const               startToken,
             const bool condAlwaysFalse = (condTok && condTok->hasKnownIntValue() && condTok->values().front().intvalue == 0);
 
             // Should scope be skipped because variable value is checked?
-            std::list<ValueFlow::Value> truevalues;
-            std::list<ValueFlow::Value> falsevalues;
+            ValueFlow::ValueList truevalues;
+            ValueFlow::ValueList falsevalues;
             for (const ValueFlow::Value &v : values) {
                 if (condAlwaysTrue) {
                     truevalues.push_back(v);
@@ -2107,16 +2158,18 @@ static bool valueFlowForward(Token * const               startToken,
                     falsevalues.push_back(v);
                     continue;
                 }
+                // the program memory walk and the condition executions are
+                // the expensive part of a branch point; evaluate the
+                // condition once per outcome and reuse the results for
+                // both arms instead of re-executing it per push
                 const ProgramMemory &programMemory = getProgramMemory(tok2, varid, v);
-                if (subFunction && conditionIsTrue(condTok, programMemory))
-                    truevalues.push_back(v);
-                else if (!subFunction && !conditionIsFalse(condTok, programMemory))
+                const bool condIsTrue = conditionIsTrue(condTok, programMemory);
+                const bool condIsFalse = conditionIsFalse(condTok, programMemory);
+                if (subFunction ? condIsTrue : !condIsFalse)
                     truevalues.push_back(v);
-                if (condAlwaysFalse)
+                if (condIsFalse)
                     falsevalues.push_back(v);
-                else if (conditionIsFalse(condTok, programMemory))
-                    falsevalues.push_back(v);
-                else if (!subFunction && !conditionIsTrue(condTok, programMemory))
+                else if (!subFunction && !condIsTrue)
                     falsevalues.push_back(v);
             }
             if (truevalues.size() != values.size() || condAlwaysTrue) {
@@ -2219,7 +2272,7 @@ static bool valueFlowForward(Token * const               startToken,
 
                 // Forward known values in the else branch
                 if (Token::simpleMatch(end, "} else {")) {
-                    std::list<ValueFlow::Value> knownValues;
+                    ValueFlow::ValueList knownValues;
                     std::copy_if(values.begin(), values.end(), std::back_inserter(knownValues), std::mem_fn(&ValueFlow::Value::isKnown));
                     valueFlowForward(end->tokAt(2),
                                      end->linkAt(2),
@@ -2234,7 +2287,7 @@ static bool valueFlowForward(Token * const               startToken,
                 }
 
                 // Remove conditional values
-                std::list<ValueFlow::Value>::iterator it;
+                ValueFlow::ValueList::iterator it;
                 for (it = values.begin(); it != values.end();) {
                     if (it->condition || it->conditional)
                         values.erase(it++);
@@ -2247,7 +2300,7 @@ static bool valueFlowForward(Token * const               startToken,
 
             // stop after conditional return scopes that are executed
             if (isReturnScope(end)) {
-                std::list<ValueFlow::Value>::iterator it;
+                ValueFlow::ValueList::iterator it;
                 for (it = values.begin(); it != values.end();) {
                     if (conditionIsTrue(tok2->next()->astOperand2(), getProgramMemory(tok2, varid, *it)))
                         values.erase(it++);
@@ -2311,7 +2364,7 @@ static bool valueFlowForward(Token * const               startToken,
             const Token * const arg = tok2->next()->astOperand2();
             if (arg != nullptr && arg->str() != ",") {
                 // Should scope be skipped because variable value is checked?
-                for (std::list<ValueFlow::Value>::iterator it = values.begin(); it != values.end();) {
+                for (ValueFlow::ValueList::iterator it = values.begin(); it != values.end();) {
                     if (conditionIsFalse(arg, getProgramMemory(tok2, varid, *it)))
                         values.erase(it++);
                     else
@@ -2324,7 +2377,7 @@ static bool valueFlowForward(Token * const               startToken,
             ++number_of_if;
 
             // Set "conditional" flag for all values
-            std::list<ValueFlow::Value>::iterator it;
+            ValueFlow::ValueList::iterator it;
             for (it = values.begin(); it != values.end(); ++it) {
                 it->conditional = true;
                 it->changeKnownToPossible();
@@ -2431,7 +2484,7 @@ static bool valueFlowForward(Token * const               startToken,
 
                 const ValueFlow::Value &rhsValue = tok2->next()->astOperand2()->values().front();
                 const std::string &assign = tok2->next()->str();
-                std::list<ValueFlow::Value>::iterator it;
+                ValueFlow::ValueList::iterator it;
                 // Erase values that are not int values..
                 for (it = values.begin(); it != values.end();) {
                     if (!evalAssignment(*it, assign, rhsValue)) {
@@ -2523,7 +2576,7 @@ static bool valueFlowForward(Token * const               startToken,
 
             // increment/decrement
             if (Token::Match(tok2->previous(), "++|-- %name%") || Token::Match(tok2, "%name% ++|--")) {
-                std::list<ValueFlow::Value>::iterator it;
+                ValueFlow::ValueList::iterator it;
                 // Erase values that are not int values..
                 for (it = values.begin(); it != values.end();) {
                     if (!it->isIntValue())
@@ -2747,7 +2800,7 @@ static void valueFlowForwardLifetime(Token * tok, TokenList *tokenlist, ErrorLog
             !(var->valueType() && var->valueType()->isIntegral()))
             return;
 
-        std::list<ValueFlow::Value> values = parent->astOperand2()->values();
+        ValueFlow::ValueList values = parent->astOperand2()->values();
 
         // Static variable initialisation?
         if (var->isStatic() && var->nameToken() == parent->astOperand1())
@@ -2778,7 +2831,7 @@ static void valueFlowForwardLifetime(Token * tok, TokenList *tokenlist, ErrorLog
             return;
         const Token *endOfVarScope = var->typeStartToken()->scope()->bodyEnd;
 
-        std::list<ValueFlow::Value> values = tok->values();
+        ValueFlow::ValueList values = tok->values();
         const Token *nextExpression = nextAfterAstRightmostLeaf(parent);
         // Only forward lifetime values
         values.remove_if(&isNotLifetimeValue);
@@ -3260,7 +3313,7 @@ static void valueFlowAfterMove(TokenList *tokenlist, SymbolDatabase* symboldatab
                 value.moveKind = ValueFlow::Value::NonMovedVariable;
                 value.errorPath.emplace_back(tok, "Calling " + tok->next()->expressionString() + " makes " + tok->str() + " 'non-moved'");
                 value.setKnown();
-                std::list<ValueFlow::Value> values;
+                ValueFlow::ValueList values;
                 values.push_back(value);
 
                 const Variable *var = varTok->variable();
@@ -3300,7 +3353,7 @@ static void valueFlowAfterMove(TokenList *tokenlist, SymbolDatabase* symboldatab
             else // if (moveKind == ValueFlow::Value::ForwardedVariable)
                 value.errorPath.emplace_back(tok, "Calling std::forward(" + varTok->str() + ")");
             value.setKnown();
-            std::list<ValueFlow::Value> values;
+            ValueFlow::ValueList values;
             values.push_back(value);
             const Token * openParentesisOfMove = findOpenParentesisOfMove(varTok);
             const Token * endOfFunctionCall = findEndOfFunctionCallForParameter(openParentesisOfMove);
@@ -3341,21 +3394,21 @@ static void valueFlowAfterAssign(TokenList *tokenlist, SymbolDatabase* symboldat
             if (!tok->astOperand2() || tok->astOperand2()->values().empty())
                 continue;
 
-            std::list<ValueFlow::Value> values = tok->astOperand2()->values();
+            ValueFlow::ValueList values = tok->astOperand2()->values();
             if (std::any_of(values.begin(), values.end(), std::mem_fn(&ValueFlow::Value::isLifetimeValue))) {
                 valueFlowForwardLifetime(tok, tokenlist, errorLogger, settings);
                 values.remove_if(std::mem_fn(&ValueFlow::Value::isLifetimeValue));
             }
             if (!var->isPointer())
                 values.remove_if(std::mem_fn(&ValueFlow::Value::isTokValue));
-            for (std::list<ValueFlow::Value>::iterator it = values.begin(); it != values.end(); ++it) {
+            for (ValueFlow::ValueList::iterator it = values.begin(); it != values.end(); ++it) {
                 const std::string info = "Assignment '" + tok->expressionString() + "', assigned value is " + it->infoString();
                 it->errorPath.emplace_back(tok->astOperand2(), info);
             }
             const bool constValue = tok->astOperand2()->isNumber();
 
             if (tokenlist->isCPP() && Token::Match(var->typeStartToken(), "bool|_Bool")) {
-                std::list<ValueFlow::Value>::iterator it;
+                ValueFlow::ValueList::iterator it;
                 for (it = values.begin(); it != values.end(); ++it) {
                     if (it->isIntValue())
                         it->intvalue = (it->intvalue != 0);
@@ -3372,7 +3425,7 @@ static void valueFlowAfterAssign(TokenList *tokenlist, SymbolDatabase* symboldat
             const Token * nextExpression = nextAfterAstRightmostLeaf(tok);
 
             if (std::any_of(values.begin(), values.end(), std::mem_fn(&ValueFlow::Value::isTokValue))) {
-                std::list<ValueFlow::Value> tokvalues;
+                ValueFlow::ValueList tokvalues;
                 std::copy_if(values.begin(),
                              values.end(),
                              std::back_inserter(tokvalues),
@@ -3397,12 +3450,12 @@ static void valueFlowAfterAssign(TokenList *tokenlist, SymbolDatabase* symboldat
 struct ValueFlowConditionHandler {
     struct Condition {
         const Token *vartok;
-        std::list<ValueFlow::Value> true_values;
-        std::list<ValueFlow::Value> false_values;
+        ValueFlow::ValueList true_values;
+        ValueFlow::ValueList false_values;
 
         Condition() : vartok(nullptr), true_values(), false_values() {}
     };
-    std::function<bool(Token *start, const Token *stop, const Variable *var, const std::list<ValueFlow::Value> &values, bool constValue)>
+    std::function<bool(Token *start, const Token *stop, const Variable *var, const ValueFlow::ValueList &values, bool constValue)>
     forward;
     std::function<Condition(Token *tok)> parse;
 
@@ -3516,7 +3569,7 @@ struct ValueFlowConditionHandler {
                         const Token *const startToken = startTokens[i];
                         if (!startToken)
                             continue;
-                        std::list<ValueFlow::Value> &values = (i == 0 ? cond.true_values : cond.false_values);
+                        ValueFlow::ValueList &values = (i == 0 ? cond.true_values : cond.false_values);
                         if (values.size() == 1U && Token::Match(tok, "==|!|(")) {
                             const Token *parent = tok->astParent();
                             while (parent && parent->str() == "&&")
@@ -3564,7 +3617,7 @@ struct ValueFlowConditionHandler {
                             dead_else = isReturnScope(after);
                         }
 
-                        std::list<ValueFlow::Value> *values = nullptr;
+                        ValueFlow::ValueList *values = nullptr;
                         if (!dead_if && check_if)
                             values = &cond.true_values;
                         else if (!dead_else && check_else)
@@ -3632,7 +3685,7 @@ static void valueFlowAfterCondition(TokenList *tokenlist,
     handler.forward = [&](Token *start,
                           const Token *stop,
                           const Variable *var,
-                          const std::list<ValueFlow::Value> &values,
+                          const ValueFlow::ValueList &values,
     bool constValue) {
         valueFlowForward(
             start->next(), stop, var, var->declarationId(), values, constValue, false, tokenlist, errorLogger, settings);
@@ -3913,6 +3966,79 @@ static bool valueFlowForLoop2(const Token *tok,
     ProgramMemory startMemory(programMemory);
     ProgramMemory endMemory;
 
+    // Interval widening: when the third expression is a single constant-step
+    // update of one variable and the condition compares that variable against
+    // a bound that the loop header does not change, the value in the last
+    // iteration and the value after the loop follow directly from
+    // [init, bound] - no need to simulate every iteration.
+    unsigned int widenVarid = 0;
+    MathLib::bigint step = 0;
+    if (Token::Match(thirdExpression, "++|--") && thirdExpression->astOperand1() && !thirdExpression->astOperand2() &&
+        thirdExpression->astOperand1()->varId()) {
+        widenVarid = thirdExpression->astOperand1()->varId();
+        step = (thirdExpression->str() == "++") ? 1 : -1;
+    } else if (Token::Match(thirdExpression, "+=|-=") && thirdExpression->astOperand1() && thirdExpression->astOperand1()->varId() &&
+               thirdExpression->astOperand2() && thirdExpression->astOperand2()->isNumber()) {
+        widenVarid = thirdExpression->astOperand1()->varId();
+        step = MathLib::toLongNumber(thirdExpression->astOperand2()->str());
+        if (thirdExpression->str() == "-=")
+            step = -step;
+    }
+    if (widenVarid != 0 && step != 0 && !error && Token::Match(secondExpression, "<|<=|>|>=") &&
+        secondExpression->astOperand1() && secondExpression->astOperand2()) {
+        const Token *varTok = secondExpression->astOperand1();
+        const Token *boundTok = secondExpression->astOperand2();
+        std::string rel = secondExpression->str();
+        if (varTok->varId() != widenVarid) {
+            std::swap(varTok, boundTok);
+            // bound rel var  =>  var inverted-rel bound
+            if (rel == "<")
+                rel = ">";
+            else if (rel == "<=")
+                rel = ">=";
+            else if (rel == ">")
+                rel = "<";
+            else
+                rel = "<=";
+        }
+        // the bound must not depend on the loop variable and the condition
+        // must not have side effects
+        bool constantBound = (varTok->varId() == widenVarid);
+        visitAstNodes(boundTok, [&](const Token *t) {
+            if (t->varId() == widenVarid || t->isAssignmentOp() || Token::Match(t, "++|--|("))
+                constantBound = false;
+            return constantBound ? ChildrenToVisit::op1_and_op2 : ChildrenToVisit::done;
+        });
+        MathLib::bigint init(0), bound(0);
+        if (constantBound && programMemory.getIntValue(widenVarid, &init)) {
+            ProgramMemory boundMemory(programMemory);
+            bool boundError = false;
+            execute(boundTok, &boundMemory, &bound, &boundError);
+            MathLib::bigint total = 0;
+            if (!boundError) {
+                if (rel == "<" && step > 0)
+                    total = (bound - init + step - 1) / step;
+                else if (rel == "<=" && step > 0)
+                    total = (bound - init) / step + 1;
+                else if (rel == ">" && step < 0)
+                    total = (init - bound - step - 1) / -step;
+                else if (rel == ">=" && step < 0)
+                    total = (init - bound) / -step + 1;
+                // otherwise the variable moves away from the bound: fall back
+                // to the bounded simulation which gives up after maxcount
+            }
+            if (total >= 1) {
+                endMemory = programMemory;
+                endMemory.setIntValue(widenVarid, init + (total - 1) * step);
+                programMemory.setIntValue(widenVarid, init + total * step);
+                memory1->swap(startMemory);
+                memory2->swap(endMemory);
+                memoryAfter->swap(programMemory);
+                return true;
+            }
+        }
+    }
+
     unsigned int maxcount = 10000;
     while (result != 0 && !error && --maxcount) {
         endMemory = programMemory;
@@ -4034,7 +4160,7 @@ static void valueFlowForLoopSimplifyAfter(Token *fortok, unsigned int varid, con
     else
         endToken = fortok->scope()->bodyEnd;
 
-    std::list<ValueFlow::Value> values;
+    ValueFlow::ValueList values;
     values.emplace_back(num);
     values.back().errorPath.emplace_back(fortok,"After for loop, " + var->name() + " has value " + values.back().infoString());
 
@@ -4097,7 +4223,7 @@ static void valueFlowForLoop(TokenList *tokenlist, SymbolDatabase* symboldatabas
     }
 }
 
-static void valueFlowInjectParameter(TokenList* tokenlist, ErrorLogger* errorLogger, const Settings* settings, const Variable* arg, const Scope* functionScope, const std::list<ValueFlow::Value>& argvalues)
+static void valueFlowInjectParameter(TokenList* tokenlist, ErrorLogger* errorLogger, const Settings* settings, const Variable* arg, const Scope* functionScope, const ValueFlow::ValueList& argvalues)
 {
     // Is argument passed by value or const reference, and is it a known non-class type?
     if (arg->isReference() && !arg->isConst() && !arg->isClass())
@@ -4136,7 +4262,7 @@ static void valueFlowSwitchVariable(TokenList *tokenlist, SymbolDatabase* symbol
                 continue;
             }
             if (Token::Match(tok, "case %num% :")) {
-                std::list<ValueFlow::Value> values;
+                ValueFlow::ValueList values;
                 values.emplace_back(MathLib::toLongNumber(tok->next()->str()));
                 values.back().condition = tok;
                 const std::string info("case " + tok->next()->str() + ": " + vartok->str() + " is " + tok->next()->str() + " here.");
@@ -4154,7 +4280,7 @@ static void valueFlowSwitchVariable(TokenList *tokenlist, SymbolDatabase* symbol
                     const std::string info2("case " + tok->next()->str() + ": " + vartok->str() + " is " + tok->next()->str() + " here.");
                     values.back().errorPath.emplace_back(tok, info2);
                 }
-                for (std::list<ValueFlow::Value>::const_iterator val = values.begin(); val != values.end(); ++val) {
+                for (ValueFlow::ValueList::const_iterator val = values.begin(); val != values.end(); ++val) {
                     valueFlowReverse(tokenlist,
                                      const_cast<Token*>(scope.classDef),
                                      vartok,
@@ -4173,7 +4299,7 @@ static void valueFlowSwitchVariable(TokenList *tokenlist, SymbolDatabase* symbol
     }
 }
 
-static void setTokenValues(Token *tok, const std::list<ValueFlow::Value> &values, const Settings *settings)
+static void setTokenValues(Token *tok, const ValueFlow::ValueList &values, const Settings *settings)
 {
     for (const ValueFlow::Value &value : values) {
         if (value.isIntValue())
@@ -4181,7 +4307,7 @@ static void setTokenValues(Token *tok, const std::list<ValueFlow::Value> &values
     }
 }
 
-static bool evaluate(const Token *expr, const std::vector<std::list<ValueFlow::Value>> &values, std::list<ValueFlow::Value> *result)
+static bool evaluate(const Token *expr, const std::vector<ValueFlow::ValueList> &values, ValueFlow::ValueList *result)
 {
     if (!expr)
         return false;
@@ -4209,7 +4335,7 @@ static bool evaluate(const Token *expr, const std::vector<std::list<ValueFlow::V
 
     // unary operands
     if (expr->astOperand1() && !expr->astOperand2()) {
-        std::list<ValueFlow::Value> opvalues;
+        ValueFlow::ValueList opvalues;
         if (!evaluate(expr->astOperand1(), values, &opvalues))
             return false;
         if (expr->str() == "+") {
@@ -4229,7 +4355,7 @@ static bool evaluate(const Token *expr, const std::vector<std::list<ValueFlow::V
     }
     // binary/ternary operands
     if (expr->astOperand1() && expr->astOperand2()) {
-        std::list<ValueFlow::Value> lhsValues, rhsValues;
+        ValueFlow::ValueList lhsValues, rhsValues;
         if (!evaluate(expr->astOperand1(), values, &lhsValues))
             return false;
         if (expr->str() != "?" && !evaluate(expr->astOperand2(), values, &rhsValues))
@@ -4315,9 +4441,9 @@ static bool evaluate(const Token *expr, const std::vector<std::list<ValueFlow::V
     return false;
 }
 
-static std::list<ValueFlow::Value> getFunctionArgumentValues(const Token *argtok)
+static ValueFlow::ValueList getFunctionArgumentValues(const Token *argtok)
 {
-    std::list<ValueFlow::Value> argvalues(argtok->values());
+    ValueFlow::ValueList argvalues(argtok->values());
     if (argvalues.empty() && Token::Match(argtok, "%comp%|%oror%|&&|!")) {
         argvalues.emplace_back(0);
         argvalues.emplace_back(1);
@@ -4327,7 +4453,7 @@ static std::list<ValueFlow::Value> getFunctionArgumentValues(const Token *argtok
 
 static void valueFlowLibraryFunction(Token *tok, const std::string &returnValue, const Settings *settings)
 {
-    std::vector<std::list<ValueFlow::Value>> argValues;
+    std::vector<ValueFlow::ValueList> argValues;
     for (const Token *argtok : getArguments(tok->previous())) {
         argValues.emplace_back(getFunctionArgumentValues(argtok));
         if (argValues.back().empty())
@@ -4364,7 +4490,7 @@ static void valueFlowLibraryFunction(Token *tok, const std::string &returnValue,
 
     // Evaluate expression
     tokenList.createAst();
-    std::list<ValueFlow::Value> results;
+    ValueFlow::ValueList results;
     if (evaluate(tokenList.front()->astOperand1(), argValues, &results))
         setTokenValues(tok, results, settings);
 }
@@ -4398,7 +4524,7 @@ static void valueFlowSubFunction(TokenList *tokenlist, const Settings *settings)
                 break;
 
             // passing value(s) to function
-            std::list<ValueFlow::Value> argvalues(getFunctionArgumentValues(argtok));
+            ValueFlow::ValueList argvalues(getFunctionArgumentValues(argtok));
 
             // Don't forward lifetime values
             argvalues.remove_if(std::mem_fn(&ValueFlow::Value::isLifetimeValue));
@@ -4442,8 +4568,8 @@ static void valueFlowFunctionDefaultParameter(TokenList *tokenlist, SymbolDataba
         for (std::size_t arg = function->minArgCount(); arg < function->argCount(); arg++) {
             const Variable* var = function->getArgumentVar(arg);
             if (var && var->hasDefault() && Token::Match(var->nameToken(), "%var% = %num%|%str% [,)]")) {
-                const std::list<ValueFlow::Value> &values = var->nameToken()->tokAt(2)->values();
-                std::list<ValueFlow::Value> argvalues;
+                const ValueFlow::ValueList &values = var->nameToken()->tokAt(2)->values();
+                ValueFlow::ValueList argvalues;
                 for (const ValueFlow::Value &value : values) {
                     ValueFlow::Value v(value);
                     v.defaultArg = true;
@@ -4463,8 +4589,29 @@ static bool isKnown(const Token * tok)
     return tok && tok->hasKnownIntValue();
 }
 
+namespace {
+    /** Summary of a called function, computed once per token list and
+     * instantiated for every call site. Only the parts that do not depend on
+     * the call arguments are stored; the execution results for each distinct
+     * argument tuple are memoized as the calls are seen, so helpers that are
+     * called many times with the same constants are analyzed only once. */
+    struct FunctionSummary {
+        FunctionSummary() : trivialReturn(false) {}
+
+        /** is the function body "{ return <expr> ; }" ? */
+        bool trivialReturn;
+
+        /** declaration id per parameter, 0 for unhandled parameter types */
+        std::vector<unsigned int> argumentIds;
+
+        /** memoized return values per argument tuple: (value, error) */
+        std::map<std::vector<MathLib::bigint>, std::pair<MathLib::bigint, bool> > returnValues;
+    };
+}
+
 static void valueFlowFunctionReturn(TokenList *tokenlist, ErrorLogger *errorLogger)
 {
+    std::map<const Function *, FunctionSummary> summaries;
     for (Token *tok = tokenlist->back(); tok; tok = tok->previous()) {
         if (tok->str() != "(" || !tok->astOperand1() || !tok->astOperand1()->function())
             continue;
@@ -4490,36 +4637,61 @@ static void valueFlowFunctionReturn(TokenList *tokenlist, ErrorLogger *errorLogg
                 continue;
         }
 
-        // Get scope and args of function
+        // Get summary of called function
         const Function * const function = tok->astOperand1()->function();
         const Scope * const functionScope = function->functionScope;
-        if (!functionScope || !Token::simpleMatch(functionScope->bodyStart, "{ return")) {
+        const std::map<const Function *, FunctionSummary>::iterator summaryIt = summaries.find(function);
+        FunctionSummary *summary;
+        if (summaryIt != summaries.end())
+            summary = &summaryIt->second;
+        else {
+            summary = &summaries[function];
+            summary->trivialReturn = functionScope && Token::simpleMatch(functionScope->bodyStart, "{ return");
+            if (summary->trivialReturn) {
+                for (std::size_t i = 0; i < function->argCount(); ++i) {
+                    const Variable * const arg = function->getArgumentVar(i);
+                    const bool handled = arg && Token::Match(arg->typeStartToken(), "%type% %name% ,|)");
+                    summary->argumentIds.push_back(handled ? arg->declarationId() : 0U);
+                }
+            }
+        }
+
+        if (!summary->trivialReturn) {
             if (functionScope && tokenlist->getSettings()->debugwarnings && Token::findsimplematch(functionScope->bodyStart, "return", functionScope->bodyEnd))
                 bailout(tokenlist, errorLogger, tok, "function return; nontrivial function body");
             continue;
         }
 
-        ProgramMemory programMemory;
+        bool unhandledArgument = false;
         for (std::size_t i = 0; i < parvalues.size(); ++i) {
-            const Variable * const arg = function->getArgumentVar(i);
-            if (!arg || !Token::Match(arg->typeStartToken(), "%type% %name% ,|)")) {
+            if (i >= summary->argumentIds.size() || summary->argumentIds[i] == 0U) {
                 if (tokenlist->getSettings()->debugwarnings)
                     bailout(tokenlist, errorLogger, tok, "function return; unhandled argument type");
-                programMemory.clear();
+                unhandledArgument = true;
                 break;
             }
-            programMemory.setIntValue(arg->declarationId(), parvalues[i]);
         }
-        if (programMemory.empty() && !parvalues.empty())
+        if (unhandledArgument)
             continue;
 
-        // Determine return value of subfunction..
+        // Determine return value of subfunction, reusing the memoized result
+        // when this argument tuple has been executed before..
         MathLib::bigint result = 0;
         bool error = false;
-        execute(functionScope->bodyStart->next()->astOperand1(),
-                &programMemory,
-                &result,
-                &error);
+        const std::map<std::vector<MathLib::bigint>, std::pair<MathLib::bigint, bool> >::const_iterator resultIt = summary->returnValues.find(parvalues);
+        if (resultIt != summary->returnValues.end()) {
+            result = resultIt->second.first;
+            error = resultIt->second.second;
+        } else {
+            ProgramMemory programMemory;
+            for (std::size_t i = 0; i < parvalues.size(); ++i)
+                programMemory.setIntValue(summary->argumentIds[i], parvalues[i]);
+            execute(functionScope->bodyStart->next()->astOperand1(),
+                    &programMemory,
+                    &result,
+                    &error);
+            summary->returnValues[parvalues] = std::make_pair(result, error);
+        }
         if (!error) {
             ValueFlow::Value v(result);
             if (function->isVirtual())
@@ -4562,7 +4734,7 @@ static void valueFlowUninit(TokenList *tokenlist, SymbolDatabase * /*symbolDatab
         ValueFlow::Value uninitValue;
         uninitValue.setKnown();
         uninitValue.valueType = ValueFlow::Value::UNINIT;
-        std::list<ValueFlow::Value> values;
+        ValueFlow::ValueList values;
         values.push_back(uninitValue);
 
         const bool constValue = true;
@@ -4832,7 +5004,7 @@ static void valueFlowContainerAfterCondition(TokenList *tokenlist,
 {
     ValueFlowConditionHandler handler;
     handler.forward =
-    [&](Token *start, const Token *stop, const Variable *var, const std::list<ValueFlow::Value> &values, bool) {
+    [&](Token *start, const Token *stop, const Variable *var, const ValueFlow::ValueList &values, bool) {
         // TODO: Forward multiple values
         if (values.empty())
             return false;
@@ -4974,56 +5146,133 @@ const ValueFlow::Value *ValueFlow::valueFlowConstantFoldAST(const Token *expr, c
     return expr && expr->hasKnownValue() ? &expr->values().front() : nullptr;
 }
 
-static std::size_t getTotalValues(TokenList *tokenlist)
-{
-    std::size_t n = 1;
-    for (Token *tok = tokenlist->front(); tok; tok = tok->next())
-        n += tok->values().size();
-    return n;
-}
+// TODO: run the value flow passes per function scope in parallel. Most of the
+// passes only write values inside one function, but valueFlowSubFunction,
+// valueFlowFunctionReturn and valueFlowFunctionDefaultParameter propagate
+// values across function boundaries, Token::addValue is unsynchronized and
+// the bailout messages go through the shared ErrorLogger. Until tokens and
+// error output are safe to use from several threads, parallelism has to stay
+// at the file level (see threadexecutor.cpp).
+// Record how many values a pass added under the pass name (--valueflow-stats).
+// The count can shrink when values become known, so clamp at zero.
+#define VALUEFLOW_PASS(pass) do { \
+        const std::size_t valueCountBefore_ = Token::valueFlowRevision(); \
+        pass; \
+        const std::size_t valueCountAfter_ = Token::valueFlowRevision(); \
+        valueFlowStats.recordPass(#pass, valueCountAfter_ > valueCountBefore_ ? valueCountAfter_ - valueCountBefore_ : 0); \
+    } while (false)
 
 void ValueFlow::setValues(TokenList *tokenlist, SymbolDatabase* symboldatabase, ErrorLogger *errorLogger, const Settings *settings)
 {
     for (Token *tok = tokenlist->front(); tok; tok = tok->next())
         tok->clearValueFlow();
 
-    valueFlowNumber(tokenlist);
-    valueFlowString(tokenlist);
-    valueFlowArray(tokenlist);
-    valueFlowGlobalStaticVar(tokenlist, settings);
-    valueFlowPointerAlias(tokenlist);
-    valueFlowLifetime(tokenlist, symboldatabase, errorLogger, settings);
-    valueFlowFunctionReturn(tokenlist, errorLogger);
-    valueFlowBitAnd(tokenlist);
-    valueFlowSameExpressions(tokenlist);
-    valueFlowFwdAnalysis(tokenlist, settings);
-
-    // Temporary hack.. run valueflow until there is nothing to update or timeout expires
+    valueFlowEffort.reset();
+    valueFlowStats.reset();
+
+    VALUEFLOW_PASS(valueFlowNumber(tokenlist));
+    VALUEFLOW_PASS(valueFlowString(tokenlist));
+    VALUEFLOW_PASS(valueFlowArray(tokenlist));
+    VALUEFLOW_PASS(valueFlowGlobalStaticVar(tokenlist, settings));
+    VALUEFLOW_PASS(valueFlowPointerAlias(tokenlist));
+    VALUEFLOW_PASS(valueFlowLifetime(tokenlist, symboldatabase, errorLogger, settings));
+    VALUEFLOW_PASS(valueFlowFunctionReturn(tokenlist, errorLogger));
+    VALUEFLOW_PASS(valueFlowBitAnd(tokenlist));
+    VALUEFLOW_PASS(valueFlowSameExpressions(tokenlist));
+    VALUEFLOW_PASS(valueFlowFwdAnalysis(tokenlist, settings));
+
+    // Temporary hack.. run valueflow until there is nothing to update or timeout expires.
+    // Token::addValue() bumps a revision counter whenever a value set actually
+    // changes, so convergence is detected without recounting all values with a
+    // full token-list walk per iteration.
     const std::time_t timeout = std::time(0) + TIMEOUT;
-    std::size_t values = 0;
-    while (std::time(0) < timeout && values < getTotalValues(tokenlist)) {
-        values = getTotalValues(tokenlist);
-        valueFlowArrayBool(tokenlist);
-        valueFlowRightShift(tokenlist, settings);
-        valueFlowOppositeCondition(symboldatabase, settings);
-        valueFlowTerminatingCondition(tokenlist, symboldatabase, settings);
-        valueFlowBeforeCondition(tokenlist, symboldatabase, errorLogger, settings);
-        valueFlowAfterMove(tokenlist, symboldatabase, errorLogger, settings);
-        valueFlowAfterAssign(tokenlist, symboldatabase, errorLogger, settings);
-        valueFlowAfterCondition(tokenlist, symboldatabase, errorLogger, settings);
-        valueFlowSwitchVariable(tokenlist, symboldatabase, errorLogger, settings);
-        valueFlowForLoop(tokenlist, symboldatabase, errorLogger, settings);
-        valueFlowSubFunction(tokenlist, settings);
-        valueFlowFunctionDefaultParameter(tokenlist, symboldatabase, errorLogger, settings);
-        valueFlowUninit(tokenlist, symboldatabase, errorLogger, settings);
+    std::size_t revision;
+    do {
+        revision = Token::valueFlowRevision();
+        VALUEFLOW_PASS(valueFlowArrayBool(tokenlist));
+        VALUEFLOW_PASS(valueFlowRightShift(tokenlist, settings));
+        VALUEFLOW_PASS(valueFlowOppositeCondition(symboldatabase, settings));
+        VALUEFLOW_PASS(valueFlowTerminatingCondition(tokenlist, symboldatabase, settings));
+        VALUEFLOW_PASS(valueFlowBeforeCondition(tokenlist, symboldatabase, errorLogger, settings));
+        VALUEFLOW_PASS(valueFlowAfterMove(tokenlist, symboldatabase, errorLogger, settings));
+        VALUEFLOW_PASS(valueFlowAfterAssign(tokenlist, symboldatabase, errorLogger, settings));
+        VALUEFLOW_PASS(valueFlowAfterCondition(tokenlist, symboldatabase, errorLogger, settings));
+        VALUEFLOW_PASS(valueFlowSwitchVariable(tokenlist, symboldatabase, errorLogger, settings));
+        VALUEFLOW_PASS(valueFlowForLoop(tokenlist, symboldatabase, errorLogger, settings));
+        VALUEFLOW_PASS(valueFlowSubFunction(tokenlist, settings));
+        VALUEFLOW_PASS(valueFlowFunctionDefaultParameter(tokenlist, symboldatabase, errorLogger, settings));
+        VALUEFLOW_PASS(valueFlowUninit(tokenlist, symboldatabase, errorLogger, settings));
         if (tokenlist->isCPP()) {
-            valueFlowContainerSize(tokenlist, symboldatabase, errorLogger, settings);
-            valueFlowContainerAfterCondition(tokenlist, symboldatabase, errorLogger, settings);
-        }
+            VALUEFLOW_PASS(valueFlowContainerSize(tokenlist, symboldatabase, errorLogger, settings));
+            VALUEFLOW_PASS(valueFlowContainerAfterCondition(tokenlist, symboldatabase, errorLogger, settings));
+        }
+    } while (std::time(0) < timeout && revision < Token::valueFlowRevision());
+
+    // only a small fraction of the tokens got values; index them so the
+    // value-driven checks do not have to scan the whole token list
+    tokenlist->createValueTokenIndex();
+
+    if (settings->valueFlowStatistics && errorLogger) {
+        std::ostringstream json;
+        json << "{\"valueflowStatistics\":{\"file\":\"" << tokenlist->getSourceFilePath() << "\",\"valuesAdded\":{";
+        bool first = true;
+        for (const std::pair<const std::string, std::size_t> &p : valueFlowStats.valuesAddedPerPass) {
+            if (!first)
+                json << ',';
+            first = false;
+            json << '\"' << p.first << "\":" << p.second;
+        }
+        json << "},\"bailouts\":{";
+        first = true;
+        for (const std::pair<const std::string, std::size_t> &p : valueFlowStats.bailoutsPerFunction) {
+            if (!first)
+                json << ',';
+            first = false;
+            json << '\"' << p.first << "\":" << p.second;
+        }
+        json << "}}}";
+        errorLogger->reportOut(json.str());
     }
 }
 
 
+std::string ValueFlow::analyzerInfo(const SymbolDatabase *symboldatabase)
+{
+    std::ostringstream ret;
+    for (const Scope *scope : symboldatabase->functionScopes) {
+        const Function *function = scope->function;
+        if (!function || !scope->bodyStart || !scope->bodyEnd)
+            continue;
+
+        // checksum of the function body so a later run can tell whether the
+        // summary is still valid
+        unsigned int checksum = 0;
+        for (const Token *tok = scope->bodyStart; tok && tok != scope->bodyEnd; tok = tok->next()) {
+            for (char c : tok->str())
+                checksum = checksum * 101U + (unsigned char)c;
+        }
+
+        // known return values
+        std::string returnValues;
+        for (const Token *tok = scope->bodyStart; tok && tok != scope->bodyEnd; tok = tok->next()) {
+            if (tok->str() != "return" || !tok->astOperand1())
+                continue;
+            if (!tok->astOperand1()->hasKnownIntValue())
+                continue;
+            if (!returnValues.empty())
+                returnValues += ',';
+            returnValues += MathLib::toString(tok->astOperand1()->values().front().intvalue);
+        }
+
+        ret << "    <function name=\"" << function->name()
+            << "\" checksum=\"" << checksum << '\"';
+        if (!returnValues.empty())
+            ret << " return-values=\"" << returnValues << '\"';
+        ret << "/>\n";
+    }
+    return ret.str();
+}
+
 std::string ValueFlow::eitherTheConditionIsRedundant(const Token *condition)
 {
     if (!condition)
@@ -22,6 +22,7 @@
 //---------------------------------------------------------------------------
 
 #include "config.h"
+#include "timer.h"
 
 #include <list>
 #include <string>
@@ -220,12 +221,79 @@ namespace ValueFlow {
         }
     };
 
+    /**
+     * @brief Allocator that recycles the nodes of the per-token value lists.
+     *
+     * Most value-bearing tokens hold only one or two values, and
+     * ValueFlow::setValues() clears and refills the lists several times per
+     * file, so the node allocations are hot. Freed nodes are kept in a
+     * thread-local free list and handed out again instead of going through
+     * the heap every time.
+     */
+    template <class T>
+    struct ValueListAllocator {
+        typedef T value_type;
+
+        ValueListAllocator() {}
+        template <class U> ValueListAllocator(const ValueListAllocator<U> &) {}
+
+        T *allocate(std::size_t n) {
+            MemUsage::add(MemUsage::POOL_VALUES, n * sizeof(T));
+            if (n == 1) {
+                void *&freeList = freeListHead();
+                if (freeList) {
+                    void * const p = freeList;
+                    freeList = *static_cast<void **>(p);
+                    return static_cast<T *>(p);
+                }
+            }
+            return static_cast<T *>(::operator new(n * sizeof(T)));
+        }
+
+        void deallocate(T *p, std::size_t n) {
+            MemUsage::remove(MemUsage::POOL_VALUES, n * sizeof(T));
+            if (n == 1) {
+                void *&freeList = freeListHead();
+                *reinterpret_cast<void **>(p) = freeList;
+                freeList = p;
+                return;
+            }
+            ::operator delete(p);
+        }
+
+    private:
+        static void *&freeListHead() {
+            static thread_local void *freeList = nullptr;
+            return freeList;
+        }
+    };
+
+    template <class T, class U> bool operator==(const ValueListAllocator<T> &, const ValueListAllocator<U> &)
+    {
+        return true;
+    }
+    template <class T, class U> bool operator!=(const ValueListAllocator<T> &, const ValueListAllocator<U> &)
+    {
+        return false;
+    }
+
+    /** @brief List of values on a token, with recycled nodes */
+    typedef std::list<Value, ValueListAllocator<Value> > ValueList;
+
     /// Constant folding of expression. This can be used before the full ValueFlow has been executed (ValueFlow::setValues).
     const ValueFlow::Value * valueFlowConstantFoldAST(const Token *expr, const Settings *settings);
 
     /// Perform valueflow analysis.
     void setValues(TokenList *tokenlist, SymbolDatabase* symboldatabase, ErrorLogger *errorLogger, const Settings *settings);
 
+    /**
+     * Per-function value flow summaries (body checksum and known return
+     * values) for the analyzer info file. Stored so incremental runs can
+     * eventually reuse value flow results for functions whose tokens are
+     * unchanged.
+     */
+    std::string analyzerInfo(const SymbolDatabase *symboldatabase);
+
     std::string eitherTheConditionIsRedundant(const Token *condition);
 }
 
@@ -16,14 +16,24 @@
 
 #include "options.h"
 
+#include <cstdlib>
 #include <iterator>
 
 options::options(int argc, const char* argv[])
     :_options(argv + 1, argv + argc)
     ,_which_test("")
     ,_quiet(_options.count("-q") != 0)
+    ,_jobs(1)
 {
     _options.erase("-q");
+    for (std::set<std::string>::iterator it = _options.begin(); it != _options.end();) {
+        if (it->compare(0, 2, "-j") == 0 && it->size() > 2) {
+            const int jobs = std::atoi(it->c_str() + 2);
+            _jobs = (jobs >= 1) ? static_cast<unsigned int>(jobs) : 1U;
+            it = _options.erase(it);
+        } else
+            ++it;
+    }
     if (! _options.empty()) {
         _which_test = *_options.rbegin();
     }
@@ -34,6 +44,11 @@ bool options::quiet() const
     return _quiet;
 }
 
+unsigned int options::jobs() const
+{
+    return _jobs;
+}
+
 const std::string& options::which_test() const
 {
     return _which_test;
@@ -31,6 +31,9 @@ public:
     options(int argc, const char* argv[]);
     /** Don't print the name of each method being tested. */
     bool quiet() const;
+    /** Number of worker threads the fixtures are sharded over (-jN).
+     * 1 means the classic sequential run. */
+    unsigned int jobs() const;
     /** Which test should be run. Empty string means 'all tests' */
     const std::string& which_test() const;
 
@@ -43,6 +46,7 @@ private:
     std::set<std::string> _options;
     std::string _which_test;
     const bool _quiet;
+    unsigned int _jobs;
 };
 
 #endif
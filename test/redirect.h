@@ -18,11 +18,12 @@
 #define REDIRECT_H
 
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <string>
 
-extern std::ostringstream errout;
-extern std::ostringstream output;
+extern thread_local std::ostringstream errout;
+extern thread_local std::ostringstream output;
 /**
   * @brief Utility class for capturing cout and cerr to ostringstream buffers
   * for later use. Uses RAII to stop redirection when the object goes out of
@@ -30,8 +31,17 @@ extern std::ostringstream output;
   */
 class RedirectOutputError {
 public:
+    /** cout/cerr are process-wide, so when the fixtures run in parallel
+     * (testrunner -jN) only one redirection may be active at a time and
+     * other threads must not write test names while it is. Recursive
+     * because a test may redirect inside an already redirected quiet run. */
+    static std::recursive_mutex &streamMutex() {
+        static std::recursive_mutex mutex;
+        return mutex;
+    }
+
     /** Set up redirection, flushing anything in the pipes. */
-    RedirectOutputError() {
+    RedirectOutputError() : _lock(streamMutex()) {
         // flush all old output
         std::cout.flush();
         std::cerr.flush();
@@ -75,6 +85,7 @@ public:
     }
 
 private:
+    std::lock_guard<std::recursive_mutex> _lock;
     std::ostringstream _out;
     std::ostringstream _err;
     std::streambuf *_oldCout;
@@ -102,6 +102,14 @@ private:
         TEST_CASE(maxConfigsMissingCount);
         TEST_CASE(maxConfigsInvalid);
         TEST_CASE(maxConfigsTooSmall);
+        TEST_CASE(maxTimePerFile);
+        TEST_CASE(maxTimePerFileInvalid);
+        TEST_CASE(maxTimePerFileTooSmall);
+        TEST_CASE(orderMtime);
+        TEST_CASE(orderInvalid);
+        TEST_CASE(pluginMissing);
+        TEST_CASE(cpuAffinity);
+        TEST_CASE(cpuAffinityInvalid);
         TEST_CASE(reportProgressTest); // "Test" suffix to avoid hiding the parent's reportProgress
         TEST_CASE(stdposix);
         TEST_CASE(stdc99);
@@ -686,6 +694,65 @@ private:
         ASSERT_EQUALS(false, defParser.parseFromArgs(3, argv));
     }
 
+    void maxTimePerFile() {
+        REDIRECT;
+        const char * const argv[] = {"cppcheck", "--max-time-per-file=60", "file.cpp"};
+        settings.maxTimePerFile = 0;
+        ASSERT(defParser.parseFromArgs(3, argv));
+        ASSERT_EQUALS(60, settings.maxTimePerFile);
+    }
+
+    void maxTimePerFileInvalid() {
+        REDIRECT;
+        const char * const argv[] = {"cppcheck", "--max-time-per-file=e", "file.cpp"};
+        // Fails since invalid count given for --max-time-per-file=
+        ASSERT_EQUALS(false, defParser.parseFromArgs(3, argv));
+    }
+
+    void maxTimePerFileTooSmall() {
+        REDIRECT;
+        const char * const argv[] = {"cppcheck", "--max-time-per-file=0", "file.cpp"};
+        // Fails since the deadline must be greater than 0
+        ASSERT_EQUALS(false, defParser.parseFromArgs(3, argv));
+    }
+
+    void orderMtime() {
+        REDIRECT;
+        const char * const argv[] = {"cppcheck", "--order=mtime", "file.cpp"};
+        settings.analysisOrder = "size";
+        ASSERT(defParser.parseFromArgs(3, argv));
+        ASSERT_EQUALS("mtime", settings.analysisOrder);
+    }
+
+    void orderInvalid() {
+        REDIRECT;
+        const char * const argv[] = {"cppcheck", "--order=name", "file.cpp"};
+        // Fails since only 'size' and 'mtime' orders exist
+        ASSERT_EQUALS(false, defParser.parseFromArgs(3, argv));
+    }
+
+    void pluginMissing() {
+        REDIRECT;
+        const char * const argv[] = {"cppcheck", "--plugin=doesnotexist.so", "file.cpp"};
+        // Fails since the shared object cannot be loaded
+        ASSERT_EQUALS(false, defParser.parseFromArgs(3, argv));
+        ASSERT_EQUALS(true, settings.plugins.empty());
+    }
+
+    void cpuAffinity() {
+        REDIRECT;
+        const char * const argv[] = {"cppcheck", "--cpu-affinity=scatter", "file.cpp"};
+        settings.cpuAffinity.clear();
+        ASSERT(defParser.parseFromArgs(3, argv));
+        ASSERT_EQUALS("scatter", settings.cpuAffinity);
+    }
+
+    void cpuAffinityInvalid() {
+        REDIRECT;
+        const char * const argv[] = {"cppcheck", "--cpu-affinity=random", "file.cpp"};
+        ASSERT_EQUALS(false, defParser.parseFromArgs(3, argv));
+    }
+
     void reportProgressTest() {
         REDIRECT;
         const char * const argv[] = {"cppcheck", "--report-progress", "file.cpp"};
@@ -766,7 +833,7 @@ private:
 
     static Suppressions::ErrorMessage errorMessage(const std::string &errorId, const std::string &fileName, int lineNumber) {
         Suppressions::ErrorMessage e;
-        e.errorId = errorId;
+        e.setErrorId(errorId);
         e.setFileName(fileName);
         e.lineNumber = lineNumber;
         return e;
@@ -16,15 +16,26 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "analyzerinfo.h"
 #include "check.h"
 #include "cppcheck.h"
 #include "errorlogger.h"
+#include "settings.h"
 #include "testsuite.h"
+#include "tokenize.h"
 
 #include <algorithm>
+#include <cstdio>
+#include <fstream>
 #include <list>
+#include <set>
 #include <string>
 
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
 
 class TestCppcheck : public TestFixture {
 public:
@@ -41,14 +52,19 @@ private:
         }
 
         void reportErr(const ErrorLogger::ErrorMessage &msg) {
-            id.push_back(msg._id);
+            id.push_back(msg.id());
         }
     };
 
     void run() OVERRIDE {
         TEST_CASE(instancesSorted);
+        TEST_CASE(createInstances);
         TEST_CASE(classInfoFormat);
         TEST_CASE(getErrorMessages);
+        TEST_CASE(analysisContext);
+        TEST_CASE(functionCacheReplay);
+        TEST_CASE(functionCacheBodyEdit);
+        TEST_CASE(functionCacheComponentInvalidation);
     }
 
     void instancesSorted() const {
@@ -61,6 +77,17 @@ private:
         }
     }
 
+    void createInstances() const {
+        Settings settings;
+        Tokenizer tokenizer(&settings, nullptr);
+        for (const Check *check : Check::instances()) {
+            Check * const boundInstance = check->createInstance(&tokenizer, &settings, nullptr);
+            ASSERT(boundInstance != nullptr);
+            ASSERT_EQUALS(check->name(), boundInstance->name());
+            delete boundInstance;
+        }
+    }
+
     void classInfoFormat() const {
         for (std::list<Check *>::const_iterator i = Check::instances().begin(); i != Check::instances().end(); ++i) {
             const std::string info = (*i)->classInfo();
@@ -105,6 +132,136 @@ private:
         ASSERT(foundPurgedConfiguration);
         ASSERT(foundTooManyConfigs);
     }
+
+    class ResultHandler2 : public AnalysisContext::ResultHandler {
+    public:
+        std::list<std::string> id;
+
+        void reportResult(const ErrorLogger::ErrorMessage &msg) OVERRIDE {
+            id.push_back(msg.id());
+        }
+    };
+
+    // Per-function result cache (--cppcheck-build-dir) helpers. The cache
+    // stores the findings of each function under a key that covers the
+    // function body, its call graph component and the environment, see
+    // CppCheck::loadFunctionCache().
+    static const char *functionCacheDir() {
+        return "testfunctioncache";
+    }
+
+    std::list<std::string> checkWithBuildDir(const char code[]) const {
+#ifdef _WIN32
+        _mkdir(functionCacheDir());
+#else
+        mkdir(functionCacheDir(), 0755);
+#endif
+        ErrorLogger2 errorLogger;
+        CppCheck cppcheck(errorLogger, true);
+        cppcheck.settings().buildDir = functionCacheDir();
+        cppcheck.check("functioncache.cpp", code);
+        return errorLogger.id;
+    }
+
+    /** the function keys recorded in the cache file of the last checkWithBuildDir() call */
+    static std::set<std::string> readFunctionKeys() {
+        std::set<std::string> keys;
+        std::ifstream fin((AnalyzerInformation::getAnalyzerInfoFile(functionCacheDir(), "functioncache.cpp", "") + ".functions").c_str());
+        std::string line;
+        while (std::getline(fin, line)) {
+            if (line.compare(0, 9, "function ") == 0)
+                keys.insert(line.substr(9));
+        }
+        return keys;
+    }
+
+    static void removeFunctionCacheDir() {
+        const std::string analyzerFile = AnalyzerInformation::getAnalyzerInfoFile(functionCacheDir(), "functioncache.cpp", "");
+        std::remove((analyzerFile + ".functions").c_str());
+        std::remove(analyzerFile.c_str());
+        std::remove(functionCacheDir());
+    }
+
+    static int count(const std::list<std::string> &ids, const std::string &id) {
+        return (int)std::count(ids.begin(), ids.end(), id);
+    }
+
+    static int intersectionSize(const std::set<std::string> &lhs, const std::set<std::string> &rhs) {
+        int ret = 0;
+        for (std::set<std::string>::const_iterator it = lhs.begin(); it != lhs.end(); ++it) {
+            if (rhs.find(*it) != rhs.end())
+                ++ret;
+        }
+        return ret;
+    }
+
+    void functionCacheReplay() const {
+        removeFunctionCacheDir();
+        // f() has a finding, g() does not
+        std::list<std::string> ids = checkWithBuildDir("int f() {\n  int x;\n  return x;\n}\n"
+                                                       "int g() {\n  return 0;\n}\n");
+        ASSERT_EQUALS(1, count(ids, "uninitvar"));
+        const std::set<std::string> keys1 = readFunctionKeys();
+        ASSERT_EQUALS(2, (int)keys1.size());
+
+        // edit g(): the key of the unchanged f() survives and its finding is
+        // replayed from the cache
+        ids = checkWithBuildDir("int f() {\n  int x;\n  return x;\n}\n"
+                                "int g() {\n  return 1;\n}\n");
+        ASSERT_EQUALS(1, count(ids, "uninitvar"));
+        const std::set<std::string> keys2 = readFunctionKeys();
+        ASSERT_EQUALS(2, (int)keys2.size());
+        ASSERT_EQUALS(1, intersectionSize(keys1, keys2));
+        removeFunctionCacheDir();
+    }
+
+    void functionCacheBodyEdit() const {
+        removeFunctionCacheDir();
+        std::list<std::string> ids = checkWithBuildDir("int f() {\n  int x;\n  return x;\n}\n");
+        ASSERT_EQUALS(1, count(ids, "uninitvar"));
+        const std::set<std::string> keys1 = readFunctionKeys();
+
+        // fix f(): the key changes and the stale finding is not replayed
+        ids = checkWithBuildDir("int f() {\n  int x = 0;\n  return x;\n}\n");
+        ASSERT_EQUALS(0, count(ids, "uninitvar"));
+        ASSERT_EQUALS(0, intersectionSize(keys1, readFunctionKeys()));
+        removeFunctionCacheDir();
+    }
+
+    void functionCacheComponentInvalidation() const {
+        removeFunctionCacheDir();
+        // a,b,c form one call graph component, standalone() is on its own
+        checkWithBuildDir("int c() {\n  return 1;\n}\n"
+                          "int b() {\n  return c();\n}\n"
+                          "int a() {\n  return b();\n}\n"
+                          "int standalone() {\n  return 2;\n}\n");
+        const std::set<std::string> keys1 = readFunctionKeys();
+        ASSERT_EQUALS(4, (int)keys1.size());
+
+        // editing c() invalidates the whole component; values flow through
+        // any number of call hops, so a() may not keep its cached results
+        checkWithBuildDir("int c() {\n  return 3;\n}\n"
+                          "int b() {\n  return c();\n}\n"
+                          "int a() {\n  return b();\n}\n"
+                          "int standalone() {\n  return 2;\n}\n");
+        const std::set<std::string> keys2 = readFunctionKeys();
+        ASSERT_EQUALS(4, (int)keys2.size());
+        ASSERT_EQUALS(1, intersectionSize(keys1, keys2));
+        removeFunctionCacheDir();
+    }
+
+    void analysisContext() const {
+        Settings settings;
+        const AnalysisContext context(settings);
+
+        // the same context checks several files without re-initialization
+        ResultHandler2 handler;
+        context.check("test.cpp", "int f() {\n  return 1/0;\n}", handler);
+        context.check("test2.cpp", "int f() {\n  return 1/0;\n}", handler);
+        ASSERT_EQUALS(2, (int)handler.id.size());
+        ASSERT_EQUALS("zerodiv", handler.id.front());
+        ASSERT_EQUALS("zerodiv", handler.id.back());
+    }
 };
 
 REGISTER_TEST(TestCppcheck)
@@ -0,0 +1,105 @@
+/*
+ * Cppcheck - A tool for static C/C++ code analysis
+ * Copyright (C) 2007-2019 Cppcheck team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cppcheckexecutor.h"
+#include "redirect.h"
+#include "testsuite.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <streambuf>
+#include <string>
+
+class TestCppCheckExecutor : public TestFixture {
+public:
+    TestCppCheckExecutor() : TestFixture("TestCppCheckExecutor") {
+    }
+
+private:
+
+    void run() OVERRIDE {
+        TEST_CASE(daemonHeaderEdit);
+    }
+
+    static void writeFile(const std::string &filename, const std::string &content) {
+        std::ofstream fout(filename.c_str());
+        fout << content;
+    }
+
+    /**
+     * Feeds the daemon loop the same request twice through std::cin. The
+     * daemon reads the second request line only after the first request has
+     * been answered, so the edit made before serving it happens between the
+     * two requests, like a save in an editor.
+     */
+    class DaemonRequests : public std::streambuf {
+    public:
+        DaemonRequests(const std::string &request, const std::string &editFile, const std::string &editContent)
+            : mRequest(request), mEditFile(editFile), mEditContent(editContent), mServed(0) {
+        }
+
+    private:
+        int underflow() OVERRIDE {
+            if (mServed >= 2)
+                return traits_type::eof();
+            if (mServed == 1)
+                writeFile(mEditFile, mEditContent);
+            ++mServed;
+            mBuffer = mRequest;
+            setg(&mBuffer[0], &mBuffer[0], &mBuffer[0] + mBuffer.size());
+            return traits_type::to_int_type(mBuffer[0]);
+        }
+
+        const std::string mRequest;
+        const std::string mEditFile;
+        const std::string mEditContent;
+        std::string mBuffer;
+        int mServed;
+    };
+
+    void daemonHeaderEdit() const {
+        // the bug is in the included header and is fixed between the requests
+        writeFile("daemontest.h", "static inline int getval(void) { int x; return x; }\n");
+        writeFile("daemontest.c", "#include \"daemontest.h\"\nint main(void) { return getval(); }\n");
+
+        DaemonRequests requests("daemontest.c\n", "daemontest.h",
+                                "static inline int getval(void) { int x = 0; return x; }\n");
+        std::streambuf * const oldCin = std::cin.rdbuf(&requests);
+        REDIRECT;
+        CppCheckExecutor executor;
+        const char * const argv[] = {"cppcheck", "--daemon"};
+        executor.check(2, argv);
+        std::cin.rdbuf(oldCin);
+
+        std::remove("daemontest.c");
+        std::remove("daemontest.h");
+
+        // the finding must not outlive the header edit: the first request
+        // reports it (exit code 1), the second request must re-read the
+        // edited header and report nothing (exit code 0)
+        const std::string err = GET_REDIRECT_ERROUT;
+        ASSERT(err.find("Uninitialized variable") != std::string::npos);
+        ASSERT(err.find("Uninitialized variable") == err.rfind("Uninitialized variable"));
+        const std::string out = GET_REDIRECT_OUTPUT;
+        ASSERT(out.find("<daemon-done exitcode=\"1\"/>") != std::string::npos);
+        ASSERT(out.find("<daemon-done exitcode=\"0\"/>") != std::string::npos);
+    }
+};
+
+REGISTER_TEST(TestCppCheckExecutor)
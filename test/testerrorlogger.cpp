@@ -65,7 +65,7 @@ private:
         const std::string plainText = "text";
 
         ErrorLogger::ErrorMessage message;
-        message._id = id;
+        message.setId(id);
 
         std::string serialized = message.toString(true, idPlaceholder + plainText + idPlaceholder);
         ASSERT_EQUALS(id + plainText + id, serialized);
@@ -258,7 +258,7 @@ private:
 
         ErrorMessage msg2;
         msg2.deserialize(msg.serialize());
-        ASSERT_EQUALS("errorId", msg2._id);
+        ASSERT_EQUALS("errorId", msg2.id());
         ASSERT_EQUALS(Severity::error, msg2._severity);
         ASSERT_EQUALS(true, msg2._inconclusive);
         ASSERT_EQUALS("Programming error", msg2.shortMessage());
@@ -283,7 +283,7 @@ private:
 
         ErrorMessage msg2;
         msg2.deserialize(msg.serialize());
-        ASSERT_EQUALS("errorId", msg2._id);
+        ASSERT_EQUALS("errorId", msg2.id());
         ASSERT_EQUALS(Severity::error, msg2._severity);
         ASSERT_EQUALS("Illegal character in \"foo\\001bar\"", msg2.shortMessage());
         ASSERT_EQUALS("Illegal character in \"foo\\001bar\"", msg2.verboseMessage());
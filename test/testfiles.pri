@@ -16,6 +16,7 @@ SOURCES += $${BASEPATH}/test64bit.cpp \
            $${BASEPATH}/testcondition.cpp \
            $${BASEPATH}/testconstructors.cpp \
            $${BASEPATH}/testcppcheck.cpp \
+           $${BASEPATH}/testcppcheckexecutor.cpp \
            $${BASEPATH}/testerrorlogger.cpp \
            $${BASEPATH}/testexceptionsafety.cpp \
            $${BASEPATH}/testfilelister.cpp \
@@ -45,6 +45,10 @@ private:
         TEST_CASE(orInComplexPattern);
         TEST_CASE(extraWhitespace);
         TEST_CASE(checkRedundantTokCheck);
+        TEST_CASE(uncompiledPattern);
+        TEST_CASE(duplicateAlternative);
+        TEST_CASE(tokenListScanInScopeLoop);
+        TEST_CASE(tokenStrCopy);
     }
 
     void check(const char code[]) {
@@ -496,6 +500,91 @@ private:
               "}");
         ASSERT_EQUALS("[test.cpp:3]: (style) Unnecessary check of \"tok->previous()->previous()\", match-function already checks if it is null.\n", errout.str());
     }
+
+    void uncompiledPattern() {
+        check("void f() {\n"
+              "    const Token *tok;\n"
+              "    std::string pattern;\n"
+              "    Token::Match(tok, pattern.c_str());\n"
+              "}");
+        ASSERT_EQUALS("[test.cpp:4]: (performance) Token::Match() pattern is built at runtime and cannot be precompiled by the matchcompiler.\n", errout.str());
+
+        check("void f() {\n"
+              "    const Token *tok;\n"
+              "    Token::findmatch(tok, (\"foobar \" + str).c_str());\n"
+              "}");
+        ASSERT_EQUALS("[test.cpp:3]: (performance) Token::findmatch() pattern is built at runtime and cannot be precompiled by the matchcompiler.\n", errout.str());
+
+        // a string literal is compiled by the matchcompiler
+        check("void f() {\n"
+              "    const Token *tok;\n"
+              "    Token::Match(tok, \"%type% foobar\");\n"
+              "}");
+        ASSERT_EQUALS("", errout.str());
+    }
+
+    void duplicateAlternative() {
+        check("void f() {\n"
+              "    const Token *tok;\n"
+              "    Token::Match(tok, \"if|while|if ( )\");\n"
+              "}");
+        ASSERT_EQUALS("[test.cpp:3]: (performance) Duplicate alternative in Token::Match() multicompare \"if|while|if\", every copy after the first is compared but can never match.\n", errout.str());
+
+        check("void f() {\n"
+              "    const Token *tok;\n"
+              "    Token::Match(tok, \"if|while ( )\");\n"
+              "}");
+        ASSERT_EQUALS("", errout.str());
+
+        // the same alternative in different multicompares is fine
+        check("void f() {\n"
+              "    const Token *tok;\n"
+              "    Token::Match(tok, \"if|while ( if|do\");\n"
+              "}");
+        ASSERT_EQUALS("", errout.str());
+    }
+
+    void tokenListScanInScopeLoop() {
+        check("void f() {\n"
+              "    for (const Scope *scope : symbolDatabase->functionScopes) {\n"
+              "        for (const Token *tok = mTokenizer->tokens(); tok; tok = tok->next()) { }\n"
+              "    }\n"
+              "}");
+        ASSERT_EQUALS("[test.cpp:3]: (performance) Full token list scan inside a loop over the scopes, the whole translation unit is rescanned per scope. Scan the scope body instead.\n", errout.str());
+
+        check("void f() {\n"
+              "    for (const Scope *scope : symbolDatabase->functionScopes) {\n"
+              "        for (const Token *tok = scope->bodyStart; tok != scope->bodyEnd; tok = tok->next()) { }\n"
+              "    }\n"
+              "}");
+        ASSERT_EQUALS("", errout.str());
+
+        // scanning the full list once is fine
+        check("void f() {\n"
+              "    for (const Token *tok = mTokenizer->tokens(); tok; tok = tok->next()) { }\n"
+              "}");
+        ASSERT_EQUALS("", errout.str());
+    }
+
+    void tokenStrCopy() {
+        check("void f() {\n"
+              "    const Token *tok;\n"
+              "    const std::string str = tok->str();\n"
+              "}");
+        ASSERT_EQUALS("[test.cpp:3]: (performance) The token string is copied into 'str'. Use 'const std::string &' to bind it without a copy.\n", errout.str());
+
+        check("void f() {\n"
+              "    const Token *tok;\n"
+              "    const std::string &str = tok->str();\n"
+              "}");
+        ASSERT_EQUALS("", errout.str());
+
+        check("void f() {\n"
+              "    const Token *tok;\n"
+              "    const std::string str = tok->strAt(2) + \";\";\n"
+              "}");
+        ASSERT_EQUALS("", errout.str());
+    }
 };
 
 REGISTER_TEST(TestInternal)
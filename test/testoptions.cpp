@@ -34,6 +34,9 @@ private:
         TEST_CASE(quiet);
         TEST_CASE(multiple_testcases);
         TEST_CASE(invalid_switches);
+        TEST_CASE(default_jobs);
+        TEST_CASE(jobs);
+        TEST_CASE(invalid_jobs);
     }
 
 
@@ -87,6 +90,29 @@ private:
         ASSERT_EQUALS("TestClass::TestMethod", args.which_test());
         ASSERT_EQUALS(true, args.quiet());
     }
+
+
+    void default_jobs() const {
+        const char* argv[] = {"./test_runner", "TestClass"};
+        options args(sizeof argv / sizeof argv[0], argv);
+        ASSERT_EQUALS(1, args.jobs());
+    }
+
+
+    void jobs() const {
+        const char* argv[] = {"./test_runner", "-j4", "TestClass"};
+        options args(sizeof argv / sizeof argv[0], argv);
+        ASSERT_EQUALS(4, args.jobs());
+        ASSERT_EQUALS("TestClass", args.which_test());
+    }
+
+
+    void invalid_jobs() const {
+        const char* argv[] = {"./test_runner", "-j0", "TestClass"};
+        options args(sizeof argv / sizeof argv[0], argv);
+        ASSERT_EQUALS(1, args.jobs());
+        ASSERT_EQUALS("TestClass", args.which_test());
+    }
 };
 
 REGISTER_TEST(TestOptions)
@@ -102,6 +102,10 @@ private:
             setSettings(set);
         }
 
+        // XML output is buffered, write it out so the test can read it
+        void flush() {
+            flushErrorOutput();
+        }
     };
 
     void runConsoleCodePageTranslationOnWindows() const {
@@ -157,6 +161,7 @@ private:
             // possible change of msg for xml option
             // with ErrorLogger::ErrorMessage::fixInvalidChars(), plus additional XML formatting
             execXML.reportInfo(errMessage);
+            execXML.flush();
             // undo the effects of "ErrorLogger::ErrorMessage::fixInvalidChars()"
             // replacing octal constants with characters
             std::string myErr;
@@ -179,6 +179,10 @@ private:
         // Test TemplateSimplifier::instantiateMatch
         TEST_CASE(instantiateMatch);
         TEST_CASE(templateParameterWithoutName); // #8602 Template default parameter without name yields syntax error
+
+        TEST_CASE(expansionCache); // cross-configuration template expansion cache
+
+        TEST_CASE(templateArgConstantExpr); // one-pass constant evaluation of template arguments
     }
 
     std::string tok(const char code[], bool simplify = true, bool debugwarnings = false, Settings::PlatformType type = Settings::Native) {
@@ -3106,6 +3110,82 @@ private:
                                              "    void g();\n"
                                              "};n"));
     }
+
+    std::string tokWithExpansionCache(const char code[], TemplateExpansionCache *cache) {
+        errout.str("");
+
+        settings.debugwarnings = false;
+        Tokenizer tokenizer(&settings, this);
+        tokenizer.setTemplateExpansionCache(cache);
+
+        std::istringstream istr(code);
+        tokenizer.tokenize(istr, "test.cpp");
+
+        return tokenizer.tokens()->stringifyList(0, true);
+    }
+
+    void expansionCache() {
+        // expanding the same code with a shared cache - as happens for the
+        // configurations of one file - must give the same token list as
+        // expanding it from scratch
+        {
+            const char code[] = "template <class T> class Fred { T a; };\n"
+                                "Fred<int> fred;";
+            TemplateExpansionCache cache;
+            const std::string expected = tokWithExpansionCache(code, nullptr);
+            ASSERT_EQUALS(expected, tokWithExpansionCache(code, &cache));
+            ASSERT_EQUALS(1U, cache.entries.size());
+            // second configuration, replayed from the cache
+            ASSERT_EQUALS(expected, tokWithExpansionCache(code, &cache));
+        }
+
+        // nested instantiations found in the expansion must be registered
+        // again when the cached run is replayed
+        {
+            const char code[] = "template <class T> class A { T x; };\n"
+                                "template <class T> class B { A<T> a; };\n"
+                                "B<int> b;";
+            TemplateExpansionCache cache;
+            const std::string expected = tokWithExpansionCache(code, nullptr);
+            ASSERT_EQUALS(expected, tokWithExpansionCache(code, &cache));
+            ASSERT_EQUALS(expected, tokWithExpansionCache(code, &cache));
+        }
+
+        // function templates are not cached; the cache must not change the output
+        {
+            const char code[] = "template <class T> void f(T val) { T a; }\n"
+                                "f<int>(10);";
+            TemplateExpansionCache cache;
+            const std::string expected = tokWithExpansionCache(code, nullptr);
+            ASSERT_EQUALS(expected, tokWithExpansionCache(code, &cache));
+            ASSERT_EQUALS(expected, tokWithExpansionCache(code, &cache));
+            ASSERT_EQUALS(0U, cache.entries.size());
+        }
+    }
+
+    void templateArgConstantExpr() {
+        // arithmetic
+        ASSERT_EQUALS("struct B<8> ; B<8> b ; struct B<8> { int a [ 8 ] ; } ;",
+                      tok("template <int N> struct B { int a[N]; };\n"
+                          "B<2*3+4/2> b;"));
+        // unary operators
+        ASSERT_EQUALS("struct B<-2> ; B<-2> b ; struct B<-2> { int x ; } ;",
+                      tok("template <int N> struct B { int x; };\n"
+                          "B<-(1+1)> b;"));
+        // parenthesized comparison and ternary: the argument is evaluated,
+        // but parenthesized arguments are not recognized as instantiations
+        ASSERT_EQUALS("template < int N > struct B { int x ; } ; B < 10 > b ;",
+                      tok("template <int N> struct B { int x; };\n"
+                          "B<((1<2)?10:20)> b;"));
+        // sizeof of a basic type
+        ASSERT_EQUALS("struct B<4> ; B<4> b ; struct B<4> { int x ; } ;",
+                      tok("template <int N> struct B { int x; };\n"
+                          "B<sizeof(int)> b;"));
+        // non-constant arguments are left alone
+        ASSERT_EQUALS("struct B<x+1> ; B<x+1> b ; struct B<x+1> { int y ; } ;",
+                      tok("template <int N> struct B { int y; };\n"
+                          "B<x+1> b;"));
+    }
 };
 
 REGISTER_TEST(TestSimplifyTemplate)
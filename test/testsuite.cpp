@@ -21,12 +21,26 @@
 #include "options.h"
 #include "redirect.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <iostream>
+#include <mutex>
 #include <string>
-
-std::ostringstream errout;
-std::ostringstream output;
+#include <thread>
+#include <vector>
+
+thread_local std::ostringstream errout;
+thread_local std::ostringstream output;
+
+namespace {
+    // guards the static test results (error messages and counters) that all
+    // worker threads write to
+    std::mutex &resultsMutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+}
 
 /**
  * TestRegistry
@@ -91,12 +105,17 @@ bool TestFixture::prepareTest(const char testname[])
     if (testToRun.empty() || testToRun == testname) {
         // Tests will be executed - prepare them
         mTestname = testname;
-        ++countTests;
+        {
+            std::lock_guard<std::mutex> lock(resultsMutex());
+            ++countTests;
+        }
         if (quiet_tests) {
             std::putchar('.'); // Use putchar to write through redirection of std::cout/cerr
             std::fflush(stdout);
         } else {
-            std::cout << classname << "::" << testname << std::endl;
+            // one string, written while no other thread redirects the stream
+            std::lock_guard<std::recursive_mutex> lock(RedirectOutputError::streamMutex());
+            std::cout << classname + "::" + testname + '\n' << std::flush;
         }
         return true;
     }
@@ -137,6 +156,7 @@ static std::string writestr(const std::string &str, bool gccStyle = false)
 void TestFixture::assert_(const char * const filename, const unsigned int linenr, const bool condition) const
 {
     if (!condition) {
+        std::lock_guard<std::mutex> lock(resultsMutex());
         ++fails_counter;
         errmsg << getLocationStr(filename, linenr) << ": Assertion failed." << std::endl << "_____" << std::endl;
     }
@@ -145,6 +165,7 @@ void TestFixture::assert_(const char * const filename, const unsigned int linenr
 void TestFixture::assertEquals(const char * const filename, const unsigned int linenr, const std::string &expected, const std::string &actual, const std::string &msg) const
 {
     if (expected != actual) {
+        std::lock_guard<std::mutex> lock(resultsMutex());
         ++fails_counter;
         errmsg << getLocationStr(filename, linenr) << ": Assertion failed. " << std::endl
                << "Expected: " <<  std::endl
@@ -227,12 +248,15 @@ void TestFixture::todoAssertEquals(const char * const filename, const unsigned i
                                    const std::string &actual) const
 {
     if (wanted == actual) {
+        std::lock_guard<std::mutex> lock(resultsMutex());
         errmsg << getLocationStr(filename, linenr) << ": Assertion succeeded unexpectedly. "
                << "Result: " << writestr(wanted, true)  << std::endl << "_____" << std::endl;
 
         ++succeeded_todos_counter;
     } else {
+        // assertEquals takes the results mutex itself, so lock afterwards
         assertEquals(filename, linenr, current, actual);
+        std::lock_guard<std::mutex> lock(resultsMutex());
         ++todos_counter;
     }
 }
@@ -248,6 +272,7 @@ void TestFixture::todoAssertEquals(const char * const filename, const unsigned i
 
 void TestFixture::assertThrow(const char * const filename, const unsigned int linenr) const
 {
+    std::lock_guard<std::mutex> lock(resultsMutex());
     ++fails_counter;
     errmsg << getLocationStr(filename, linenr) << ": Assertion succeeded. "
            << "The expected exception was thrown" << std::endl << "_____" << std::endl;
@@ -256,6 +281,7 @@ void TestFixture::assertThrow(const char * const filename, const unsigned int li
 
 void TestFixture::assertThrowFail(const char * const filename, const unsigned int linenr) const
 {
+    std::lock_guard<std::mutex> lock(resultsMutex());
     ++fails_counter;
     errmsg << getLocationStr(filename, linenr) << ": Assertion failed. "
            << "The expected exception was not thrown"  << std::endl << "_____" << std::endl;
@@ -264,6 +290,7 @@ void TestFixture::assertThrowFail(const char * const filename, const unsigned in
 
 void TestFixture::assertNoThrowFail(const char * const filename, const unsigned int linenr) const
 {
+    std::lock_guard<std::mutex> lock(resultsMutex());
     ++fails_counter;
     errmsg << getLocationStr(filename, linenr) << ": Assertion failed. "
            << "Unexpected exception was thrown"  << std::endl << "_____" << std::endl;
@@ -272,6 +299,7 @@ void TestFixture::assertNoThrowFail(const char * const filename, const unsigned
 
 void TestFixture::complainMissingLib(const char * const libname) const
 {
+    std::lock_guard<std::mutex> lock(resultsMutex());
     missingLibs.insert(libname);
 }
 
@@ -305,11 +333,40 @@ std::size_t TestFixture::runTests(const options& args)
 
     const TestSet &tests = TestRegistry::theInstance().tests();
 
+    std::vector<TestFixture *> fixtures;
     for (TestSet::const_iterator it = tests.begin(); it != tests.end(); ++it) {
-        if (classname.empty() || (*it)->classname == classname) {
+        if (classname.empty() || (*it)->classname == classname)
+            fixtures.push_back(*it);
+    }
+
+    if (args.jobs() <= 1U) {
+        for (std::vector<TestFixture *>::const_iterator it = fixtures.begin(); it != fixtures.end(); ++it) {
             (*it)->processOptions(args);
             (*it)->run(testname);
         }
+    } else {
+        // Shard the fixtures over worker threads. Quiet mode is ignored here:
+        // its per-fixture output redirection would serialize the workers again.
+        std::size_t next = 0;
+        std::mutex queueMutex;
+        std::vector<std::thread> workers;
+        const std::size_t jobCount = std::min<std::size_t>(args.jobs(), fixtures.size());
+        for (std::size_t j = 0; j < jobCount; ++j) {
+            workers.push_back(std::thread([&]() {
+                for (;;) {
+                    TestFixture *fixture;
+                    {
+                        std::lock_guard<std::mutex> lock(queueMutex);
+                        if (next >= fixtures.size())
+                            return;
+                        fixture = fixtures[next++];
+                    }
+                    fixture->run(testname);
+                }
+            }));
+        }
+        for (std::size_t j = 0; j < workers.size(); ++j)
+            workers[j].join();
     }
 
     std::cout << "\n\nTesting Complete\nNumber of tests: " << countTests << std::endl;
@@ -93,8 +93,11 @@ public:
     static std::size_t runTests(const options& args);
 };
 
-extern std::ostringstream errout;
-extern std::ostringstream output;
+// Capture streams for the error logger output of the tests. One instance
+// per worker thread so sharded fixtures (testrunner -jN) do not mix their
+// captured messages.
+extern thread_local std::ostringstream errout;
+extern thread_local std::ostringstream output;
 
 #define TEST_CASE( NAME )  if ( prepareTest(#NAME) ) { setVerbose(false); NAME(); }
 #define ASSERT( CONDITION )  assert_(__FILE__, __LINE__, CONDITION)
@@ -82,13 +82,13 @@ private:
 
     Suppressions::ErrorMessage errorMessage(const std::string &errorId) const {
         Suppressions::ErrorMessage ret;
-        ret.errorId = errorId;
+        ret.setErrorId(errorId);
         return ret;
     }
 
     Suppressions::ErrorMessage errorMessage(const std::string &errorId, const std::string &file, int line) const {
         Suppressions::ErrorMessage ret;
-        ret.errorId = errorId;
+        ret.setErrorId(errorId);
         ret.setFileName(file);
         ret.lineNumber = line;
         return ret;
@@ -571,7 +571,7 @@ private:
         s.symbolName = "array*";
 
         Suppressions::ErrorMessage errorMsg;
-        errorMsg.errorId = "foo";
+        errorMsg.setErrorId("foo");
         errorMsg.setFileName("test.cpp");
         errorMsg.lineNumber = 123;
         errorMsg.symbolNames = "";
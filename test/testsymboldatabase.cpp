@@ -28,6 +28,7 @@
 
 #include <climits>
 #include <cstddef>
+#include <limits>
 #include <list>
 #include <map>
 #include <set>
@@ -75,7 +76,7 @@ private:
     }
 
     static const Scope *findFunctionScopeByToken(const SymbolDatabase * db, const Token *tok) {
-        std::list<Scope>::const_iterator scope;
+        std::deque<Scope>::const_iterator scope;
 
         for (scope = db->scopeList.begin(); scope != db->scopeList.end(); ++scope) {
             if (scope->type == Scope::eFunction) {
@@ -363,6 +364,7 @@ private:
         TEST_CASE(executableScopeWithUnknownFunction);
 
         TEST_CASE(valuetype);
+        TEST_CASE(valueTypeRefresh);
 
         TEST_CASE(variadic1); // #7453
         TEST_CASE(variadic2); // #7649
@@ -1431,7 +1433,7 @@ private:
 
         if (db) {
             bool seen_something = false;
-            for (std::list<Scope>::const_iterator scope = db->scopeList.begin(); scope != db->scopeList.end(); ++scope) {
+            for (std::deque<Scope>::const_iterator scope = db->scopeList.begin(); scope != db->scopeList.end(); ++scope) {
                 for (std::list<Function>::const_iterator func = scope->functionList.begin(); func != scope->functionList.end(); ++func) {
                     ASSERT_EQUALS("Sub", func->token->str());
                     ASSERT_EQUALS(true, func->hasBody());
@@ -1705,7 +1707,7 @@ private:
 
         ASSERT(db && db->scopeList.size() == 1);
         if (db && db->scopeList.size() == 1) {
-            std::list<Scope>::const_iterator it = db->scopeList.begin();
+            std::deque<Scope>::const_iterator it = db->scopeList.begin();
             ASSERT(it->varlist.size() == 1);
             if (it->varlist.size() == 1) {
                 std::list<Variable>::const_iterator var = it->varlist.begin();
@@ -1720,7 +1722,7 @@ private:
 
         ASSERT(db && db->scopeList.size() == 1);
         if (db && db->scopeList.size() == 1) {
-            std::list<Scope>::const_iterator it = db->scopeList.begin();
+            std::deque<Scope>::const_iterator it = db->scopeList.begin();
             ASSERT(it->varlist.size() == 1);
             if (it->varlist.size() == 1) {
                 std::list<Variable>::const_iterator var = it->varlist.begin();
@@ -1735,7 +1737,7 @@ private:
 
         ASSERT(db && db->scopeList.size() == 1);
         if (db && db->scopeList.size() == 1) {
-            std::list<Scope>::const_iterator it = db->scopeList.begin();
+            std::deque<Scope>::const_iterator it = db->scopeList.begin();
             ASSERT(it->varlist.size() == 1);
             if (it->varlist.size() == 1) {
                 std::list<Variable>::const_iterator var = it->varlist.begin();
@@ -2082,7 +2084,7 @@ private:
         if (db) {
             ASSERT_EQUALS(3, db->scopeList.size());
             if (db->scopeList.size() == 3) {
-                std::list<Scope>::const_iterator scope = db->scopeList.begin();
+                std::deque<Scope>::const_iterator scope = db->scopeList.begin();
                 ++scope;
                 ASSERT_EQUALS((unsigned int)Scope::eClass, (unsigned int)scope->type);
                 ASSERT_EQUALS(1, scope->functionList.size());
@@ -2106,7 +2108,7 @@ private:
         if (db) {
             ASSERT_EQUALS(3, db->scopeList.size());
             if (db->scopeList.size() == 3) {
-                std::list<Scope>::const_iterator scope = db->scopeList.begin();
+                std::deque<Scope>::const_iterator scope = db->scopeList.begin();
                 ++scope;
                 ASSERT_EQUALS((unsigned int)Scope::eClass, (unsigned int)scope->type);
                 ASSERT_EQUALS(1, scope->functionList.size());
@@ -2203,7 +2205,7 @@ private:
 
         // Locate the scope for the class..
         const Scope *scope = nullptr;
-        for (std::list<Scope>::const_iterator it = db->scopeList.begin(); it != db->scopeList.end(); ++it) {
+        for (std::deque<Scope>::const_iterator it = db->scopeList.begin(); it != db->scopeList.end(); ++it) {
             if (it->isClassOrStruct()) {
                 scope = &(*it);
                 break;
@@ -2237,7 +2239,7 @@ private:
 
         // Locate the scope for the class..
         const Scope *scope = nullptr;
-        for (std::list<Scope>::const_iterator it = db->scopeList.begin(); it != db->scopeList.end(); ++it) {
+        for (std::deque<Scope>::const_iterator it = db->scopeList.begin(); it != db->scopeList.end(); ++it) {
             if (it->isClassOrStruct()) {
                 scope = &(*it);
                 break;
@@ -2526,7 +2528,7 @@ private:
 
         // Find the scope for the Fred struct..
         const Scope *fredScope = nullptr;
-        for (std::list<Scope>::const_iterator scope = db->scopeList.begin(); scope != db->scopeList.end(); ++scope) {
+        for (std::deque<Scope>::const_iterator scope = db->scopeList.begin(); scope != db->scopeList.end(); ++scope) {
             if (scope->isClassOrStruct() && scope->className == "Fred")
                 fredScope = &(*scope);
         }
@@ -2633,7 +2635,7 @@ private:
         ASSERT(db && db->typeList.size() == 5);
         if (!db || db->typeList.size() < 5)
             return;
-        std::list<Type>::const_iterator i = db->typeList.begin();
+        std::deque<Type>::const_iterator i = db->typeList.begin();
         const Type* Foo = &(*i++);
         const Type* Bar = &(*i++);
         const Type* Sub = &(*i++);
@@ -2702,7 +2704,7 @@ private:
         ASSERT(db && db->typeList.size() == 3);
         if (!db || db->typeList.size() != 3)
             return;
-        std::list<Type>::const_iterator i = db->typeList.begin();
+        std::deque<Type>::const_iterator i = db->typeList.begin();
         const Type* Fred = &(*i++);
         const Type* Wilma = &(*i++);
         const Type* Barney = &(*i++);
@@ -2792,7 +2794,7 @@ private:
             ASSERT(db->getVariableFromVarId(i) != nullptr);
 
         ASSERT_EQUALS(4U, db->scopeList.size());
-        std::list<Scope>::const_iterator scope = db->scopeList.begin();
+        std::deque<Scope>::const_iterator scope = db->scopeList.begin();
         ASSERT_EQUALS(Scope::eGlobal, scope->type);
         ++scope;
         ASSERT_EQUALS(Scope::eStruct, scope->type);
@@ -2810,7 +2812,7 @@ private:
 
         ASSERT(db != nullptr);
         ASSERT_EQUALS(4U, db->scopeList.size());
-        std::list<Scope>::const_iterator scope = db->scopeList.begin();
+        std::deque<Scope>::const_iterator scope = db->scopeList.begin();
         ASSERT_EQUALS(Scope::eGlobal, scope->type);
         ++scope;
         ASSERT_EQUALS(Scope::eStruct, scope->type);
@@ -3018,7 +3020,7 @@ private:
         if (db) {
             ASSERT(db->scopeList.size() == 4U);
             if (db->scopeList.size() == 4U) {
-                std::list<Scope>::const_iterator it = db->scopeList.begin();
+                std::deque<Scope>::const_iterator it = db->scopeList.begin();
                 ASSERT(it->type == Scope::eGlobal);
                 ASSERT((++it)->type == Scope::eFunction);
                 ASSERT((++it)->type == Scope::eIf);
@@ -3042,7 +3044,7 @@ private:
         if (db) {
             ASSERT(db->typeList.size() == 3U);
             if (db->typeList.size() == 3U) {
-                std::list<Type>::const_iterator it = db->typeList.begin();
+                std::deque<Type>::const_iterator it = db->typeList.begin();
                 const Type * classB = &(*it);
                 const Type * classC = &(*(++it));
                 const Type * classA = &(*(++it));
@@ -4234,7 +4236,7 @@ private:
         ASSERT_EQUALS(3U, db->scopeList.size());
 
         // Assert that all enum values are known
-        std::list<Scope>::const_iterator scope = db->scopeList.begin();
+        std::deque<Scope>::const_iterator scope = db->scopeList.begin();
 
         // Offsets
         ++scope;
@@ -4323,7 +4325,7 @@ private:
         ASSERT_EQUALS(2U, db->scopeList.size());
 
         // Assert that all enum values are known
-        std::list<Scope>::const_iterator scope = db->scopeList.begin();
+        std::deque<Scope>::const_iterator scope = db->scopeList.begin();
 
         ++scope;
         ASSERT_EQUALS((unsigned int)Scope::eEnum, (unsigned int)scope->type);
@@ -5750,7 +5752,7 @@ private:
 
         ASSERT(db && db->scopeList.size() == 3);
         if (db && db->scopeList.size() == 3) {
-            std::list<Scope>::const_iterator scope = db->scopeList.begin();
+            std::deque<Scope>::const_iterator scope = db->scopeList.begin();
             ASSERT_EQUALS(Scope::eGlobal, scope->type);
             ++scope;
             ASSERT_EQUALS(Scope::eFunction, scope->type);
@@ -5771,7 +5773,7 @@ private:
 
         ASSERT(db && db->scopeList.size() == 3);
         if (db && db->scopeList.size() == 3) {
-            std::list<Scope>::const_iterator scope = db->scopeList.begin();
+            std::deque<Scope>::const_iterator scope = db->scopeList.begin();
             ASSERT_EQUALS(Scope::eGlobal, scope->type);
             ++scope;
             ASSERT_EQUALS(Scope::eFunction, scope->type);
@@ -5803,7 +5805,7 @@ private:
 
         ASSERT(db && db->scopeList.size() == 3);
         if (db && db->scopeList.size() == 3) {
-            std::list<Scope>::const_iterator scope = db->scopeList.begin();
+            std::deque<Scope>::const_iterator scope = db->scopeList.begin();
             ASSERT_EQUALS(Scope::eGlobal, scope->type);
             ++scope;
             ASSERT_EQUALS(Scope::eClass, scope->type);
@@ -6068,6 +6070,29 @@ private:
         ASSERT_EQUALS("", typeOf("; int x[10] = { [3]=1 };", "[ 3 ]"));
     }
 
+    void valueTypeRefresh() {
+        // incremental retype of a dirty statement after a token mutation
+        Tokenizer tokenizer(&settings2, this);
+        std::istringstream istr("1 + 2;");
+        tokenizer.tokenize(istr, "test.cpp");
+        Token * const plus = const_cast<Token *>(Token::findsimplematch(tokenizer.tokens(), "+"));
+        ASSERT(plus && plus->valueType());
+        if (!plus || !plus->valueType())
+            return;
+        ASSERT_EQUALS("signed int", plus->valueType()->str());
+
+        // mutate "1 + 2" into "1L + 2" and refresh only that statement
+        plus->previous()->str("1L");
+        SymbolDatabase * const db = const_cast<SymbolDatabase *>(tokenizer.getSymbolDatabase());
+        db->refreshValueTypes(); // nothing dirty -> no-op
+        ASSERT_EQUALS("signed int", plus->valueType()->str());
+        db->markValueTypesDirty(plus->previous(), plus->tokAt(2));
+        db->refreshValueTypes();
+        ASSERT(plus->valueType());
+        if (plus->valueType())
+            ASSERT_EQUALS("signed long", plus->valueType()->str());
+    }
+
     void variadic1() { // #7453
         {
             GET_SYMBOL_DB("CBase* create(const char *c1, ...);\n"
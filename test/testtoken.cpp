@@ -59,6 +59,7 @@ private:
         TEST_CASE(getStrLength);
         TEST_CASE(getStrSize);
         TEST_CASE(strValue);
+        TEST_CASE(sameStr);
 
         TEST_CASE(deleteLast);
         TEST_CASE(deleteFirst);
@@ -318,6 +319,22 @@ private:
 
     }
 
+    void sameStr() const {
+        Token tok1;
+        Token tok2;
+
+        tok1.str("foo");
+        tok2.str("foo");
+        ASSERT_EQUALS(true, tok1.sameStr(&tok2));
+
+        tok2.str("bar");
+        ASSERT_EQUALS(false, tok1.sameStr(&tok2));
+
+        // same text set again finds the interned string
+        tok2.str("foo");
+        ASSERT_EQUALS(true, tok1.sameStr(&tok2));
+    }
+
 
     void deleteLast() const {
         TokensFrontBack listEnds{ 0 };
@@ -141,7 +141,7 @@ private:
 
         for (const Token *tok = tokenizer.tokens(); tok; tok = tok->next()) {
             if (tok->str() == "x" && tok->linenr() == linenr) {
-                std::list<ValueFlow::Value>::const_iterator it;
+                ValueFlow::ValueList::const_iterator it;
                 for (it = tok->values().begin(); it != tok->values().end(); ++it) {
                     if (it->isIntValue() && it->intvalue == value)
                         return true;
@@ -160,7 +160,7 @@ private:
 
         for (const Token *tok = tokenizer.tokens(); tok; tok = tok->next()) {
             if (tok->str() == "x" && tok->linenr() == linenr) {
-                std::list<ValueFlow::Value>::const_iterator it;
+                ValueFlow::ValueList::const_iterator it;
                 for (it = tok->values().begin(); it != tok->values().end(); ++it) {
                     if (it->isFloatValue() && it->floatValue >= value - diff && it->floatValue <= value + diff)
                         return true;
@@ -182,7 +182,7 @@ private:
                 continue;
 
             std::ostringstream ostr;
-            std::list<ValueFlow::Value>::const_iterator it;
+            ValueFlow::ValueList::const_iterator it;
             for (it = tok->values().begin(); it != tok->values().end(); ++it) {
                 for (ValueFlow::Value::ErrorPath::const_iterator ep = it->errorPath.begin(); ep != it->errorPath.end(); ++ep) {
                     const Token *eptok = ep->first;
@@ -204,7 +204,7 @@ private:
 
         for (const Token *tok = tokenizer.tokens(); tok; tok = tok->next()) {
             if (tok->str() == "x" && tok->linenr() == linenr) {
-                std::list<ValueFlow::Value>::const_iterator it;
+                ValueFlow::ValueList::const_iterator it;
                 for (it = tok->values().begin(); it != tok->values().end(); ++it) {
                     if (it->valueType == type && Token::simpleMatch(it->tokvalue, value))
                         return true;
@@ -223,7 +223,7 @@ private:
 
         for (const Token *tok = tokenizer.tokens(); tok; tok = tok->next()) {
             if (tok->str() == "x" && tok->linenr() == linenr) {
-                std::list<ValueFlow::Value>::const_iterator it;
+                ValueFlow::ValueList::const_iterator it;
                 for (it = tok->values().begin(); it != tok->values().end(); ++it) {
                     if (it->isMovedValue() && it->moveKind == moveKind)
                         return true;
@@ -242,7 +242,7 @@ private:
 
         for (const Token *tok = tokenizer.tokens(); tok; tok = tok->next()) {
             if (tok->str() == "x" && tok->linenr() == linenr) {
-                std::list<ValueFlow::Value>::const_iterator it;
+                ValueFlow::ValueList::const_iterator it;
                 for (it = tok->values().begin(); it != tok->values().end(); ++it) {
                     if (it->isIntValue() && it->intvalue == value && it->condition)
                         return true;
@@ -273,17 +273,17 @@ private:
         settings.debugwarnings = false;
     }
 
-    std::list<ValueFlow::Value> tokenValues(const char code[], const char tokstr[]) {
+    ValueFlow::ValueList tokenValues(const char code[], const char tokstr[]) {
         Tokenizer tokenizer(&settings, this);
         std::istringstream istr(code);
         errout.str("");
         tokenizer.tokenize(istr, "test.cpp");
         const Token *tok = Token::findmatch(tokenizer.tokens(), tokstr);
-        return tok ? tok->values() : std::list<ValueFlow::Value>();
+        return tok ? tok->values() : ValueFlow::ValueList();
     }
 
     ValueFlow::Value valueOfTok(const char code[], const char tokstr[]) {
-        std::list<ValueFlow::Value> values = tokenValues(code, tokstr);
+        ValueFlow::ValueList values = tokenValues(code, tokstr);
         return values.size() == 1U && !values.front().isTokValue() ? values.front() : ValueFlow::Value();
     }
 
@@ -570,7 +570,7 @@ private:
                 "    if (x==2) {}\n"
                 "    if (x==4) {}\n"
                 "}";
-        std::list<ValueFlow::Value> values = tokenValues(code,"*");
+        ValueFlow::ValueList values = tokenValues(code,"*");
         ASSERT_EQUALS(2U, values.size());
         ASSERT_EQUALS(4, values.front().intvalue);
         ASSERT_EQUALS(16, values.back().intvalue);
@@ -740,7 +740,7 @@ private:
 
     void valueFlowSizeof() {
         const char *code;
-        std::list<ValueFlow::Value> values;
+        ValueFlow::ValueList values;
 
 #define CHECK(A, B)                              \
         code = "void f() {\n"                    \
@@ -2434,7 +2434,7 @@ private:
 
     void valueFlowFwdAnalysis() {
         const char *code;
-        std::list<ValueFlow::Value> values;
+        ValueFlow::ValueList values;
 
         code = "void f() {\n"
                "  struct Foo foo;\n"
@@ -2815,8 +2815,8 @@ private:
     }
 
     bool isNotKnownValues(const char code[], const char str[]) {
-        const std::list<ValueFlow::Value> values = tokenValues(code, str);
-        for (std::list<ValueFlow::Value>::const_iterator it = values.begin(); it != values.end(); ++it) {
+        const ValueFlow::ValueList values = tokenValues(code, str);
+        for (ValueFlow::ValueList::const_iterator it = values.begin(); it != values.end(); ++it) {
             if (it->isKnown())
                 return false;
         }
@@ -3210,7 +3210,7 @@ private:
 
     void valueFlowUninit() {
         const char* code;
-        std::list<ValueFlow::Value> values;
+        ValueFlow::ValueList values;
 
         code = "void f() {\n"
                "    int x;\n"
@@ -3426,7 +3426,7 @@ private:
         ASSERT_EQUALS(false, valueOfTok(code, "<").intvalue == 1);
     }
 
-    static std::string isPossibleContainerSizeValue(const std::list<ValueFlow::Value> &values, MathLib::bigint i) {
+    static std::string isPossibleContainerSizeValue(const ValueFlow::ValueList &values, MathLib::bigint i) {
         if (values.size() != 1)
             return "values.size():" + std::to_string(values.size());
         if (!values.front().isContainerSizeValue())
@@ -3438,7 +3438,7 @@ private:
         return "";
     }
 
-    static std::string isKnownContainerSizeValue(const std::list<ValueFlow::Value> &values, MathLib::bigint i) {
+    static std::string isKnownContainerSizeValue(const ValueFlow::ValueList &values, MathLib::bigint i) {
         if (values.size() != 1)
             return "values.size():" + std::to_string(values.size());
         if (!values.front().isContainerSizeValue())
@@ -0,0 +1,181 @@
+# Distributed analysis
+#
+# Shards a cppcheck run across several hosts over ssh, using the
+# --cppcheck-build-dir file protocol (see lib/analyzerinfo.h). Each host
+# analyzes its share of the files into its own build dir, the build dirs
+# are copied back with rsync and merged into the local build dir, and a
+# final local cppcheck run replays the recorded results and runs the
+# whole program analysis.
+#
+# Syntax: distributed-check.py --hosts=host1,host2,... [--cppcheck=path] [--build-dir=path] [--remote-dir=path] <cppcheck options> <paths>
+#  --hosts=...       Comma separated ssh hosts that share the work.
+#  --cppcheck=path   The cppcheck command to run, locally and on the hosts. Default is 'cppcheck'.
+#  --build-dir=path  The local --cppcheck-build-dir. Default is 'cppcheck-build-dir'.
+#  --remote-dir=path Build dir used on the hosts. Default is '/tmp/cppcheck-distributed'.
+#
+# All other arguments are passed to cppcheck; arguments that do not start
+# with '-' are also used as the paths to enumerate the source files.
+#
+# Requirements:
+# - the source tree is reachable under the same absolute path on every host
+#   (shared filesystem or identical checkouts)
+# - all hosts run the same cppcheck version with the same options, so that
+#   the checksums recorded in the analyzer info files match the final run
+# - passwordless ssh and rsync
+#
+# A file whose recorded result cannot be matched up (different checksum,
+# failed host, ...) is simply re-analyzed by the final local run, so the
+# output is the same as for a plain local run - distribution only decides
+# how much work the final run still has to do itself.
+
+import os
+import subprocess
+import sys
+
+SOURCE_EXTENSIONS = ('.cpp', '.cxx', '.cc', '.c++', '.tpp', '.txx', '.c', '.C')
+
+
+def gather_source_files(paths):
+    # absolute paths - the hosts check the files from their ssh home directory
+    sourcefiles = []
+    for path in paths:
+        if os.path.isfile(path):
+            sourcefiles.append(os.path.abspath(path))
+            continue
+        for dirpath, _, filenames in os.walk(path):
+            for filename in filenames:
+                if filename.endswith(SOURCE_EXTENSIONS):
+                    sourcefiles.append(os.path.abspath(os.path.join(dirpath, filename)))
+    return sourcefiles
+
+
+def shard(sourcefiles, nhosts):
+    # biggest files first, each to the least loaded shard
+    shards = [[] for _ in range(nhosts)]
+    loads = [0] * nhosts
+    for f in sorted(sourcefiles, key=lambda f: -os.path.getsize(f)):
+        i = loads.index(min(loads))
+        shards[i].append(f)
+        loads[i] += os.path.getsize(f)
+    return shards
+
+
+def analyzer_info_names(sourcefiles):
+    # Replicate the AnalyzerInformation::writeFilesTxt naming so that the
+    # merged analyzer info files match the files.txt written by the final
+    # local run. cppcheck keeps the files sorted by path.
+    names = {}
+    counts = {}
+    for f in sorted(sourcefiles):
+        basename = os.path.basename(f)
+        dot = basename.rfind('.')
+        afile = basename[:dot] if dot > 0 else basename
+        counts[afile] = counts.get(afile, 0) + 1
+        names[f] = '%s.a%i' % (afile, counts[afile])
+    return names
+
+
+def check_on_host(host, shardfiles, cppcheck, options, remote_dir):
+    cmd = 'rm -rf {0} && mkdir -p {0} && xargs {1} --cppcheck-build-dir={0} {2}'.format(
+        remote_dir, cppcheck, ' '.join(options))
+    p = subprocess.Popen(['ssh', host, cmd],
+                         stdin=subprocess.PIPE,
+                         stdout=subprocess.PIPE,
+                         stderr=subprocess.PIPE)
+    p.stdin.write('\n'.join(shardfiles).encode('utf-8'))
+    p.stdin.close()
+    return p
+
+
+def fetch_build_dir(host, remote_dir, local_dir):
+    if os.path.exists(local_dir):
+        subprocess.call(['rm', '-rf', local_dir])
+    os.makedirs(local_dir)
+    return subprocess.call(['rsync', '-a', host + ':' + remote_dir + '/', local_dir + '/']) == 0
+
+
+def merge_build_dir(host_dir, names, build_dir):
+    # host files.txt line: <analyzer info file>:<config>:<source file>
+    files_txt = os.path.join(host_dir, 'files.txt')
+    if not os.path.isfile(files_txt):
+        return 0
+    merged = 0
+    for line in open(files_txt, 'rt'):
+        pos = line.find(':')
+        if pos <= 0:
+            continue
+        afile = line[:pos]
+        sourcefile = line[line.rfind(':') + 1:].strip()
+        if sourcefile not in names:
+            continue
+        src = os.path.join(host_dir, afile)
+        if not os.path.isfile(src):
+            continue
+        dst = os.path.join(build_dir, names[sourcefile])
+        if subprocess.call(['cp', src, dst]) == 0:
+            merged += 1
+    return merged
+
+
+def main():
+    hosts = []
+    cppcheck = 'cppcheck'
+    build_dir = 'cppcheck-build-dir'
+    remote_dir = '/tmp/cppcheck-distributed'
+    options = []
+    paths = []
+
+    for arg in sys.argv[1:]:
+        if arg.startswith('--hosts='):
+            hosts = [h for h in arg[len('--hosts='):].split(',') if h]
+        elif arg.startswith('--cppcheck='):
+            cppcheck = arg[len('--cppcheck='):]
+        elif arg.startswith('--build-dir='):
+            build_dir = arg[len('--build-dir='):]
+        elif arg.startswith('--remote-dir='):
+            remote_dir = arg[len('--remote-dir='):]
+        else:
+            options.append(arg)
+            if not arg.startswith('-'):
+                paths.append(arg)
+
+    if not hosts or not paths:
+        print('Syntax: distributed-check.py --hosts=host1,host2,... [--cppcheck=path] [--build-dir=path] [--remote-dir=path] <cppcheck options> <paths>')
+        sys.exit(1)
+
+    sourcefiles = gather_source_files(paths)
+    if not sourcefiles:
+        print('no source files found in ' + ' '.join(paths))
+        sys.exit(1)
+    print('distributing %i files to %i hosts' % (len(sourcefiles), len(hosts)))
+
+    if not os.path.exists(build_dir):
+        os.makedirs(build_dir)
+
+    # the shard options must not contain the paths, the files are given on stdin
+    shard_options = [a for a in options if a.startswith('-')]
+    procs = []
+    for host, shardfiles in zip(hosts, shard(sourcefiles, len(hosts))):
+        print('%s: checking %i files' % (host, len(shardfiles)))
+        procs.append((host, check_on_host(host, shardfiles, cppcheck, shard_options, remote_dir)))
+
+    for host, p in procs:
+        p.communicate()
+        if p.returncode != 0:
+            print('%s: cppcheck failed, its files are re-analyzed locally' % host)
+
+    names = analyzer_info_names(sourcefiles)
+    for host, _ in procs:
+        host_dir = os.path.join(build_dir, 'host-' + host)
+        if not fetch_build_dir(host, remote_dir, host_dir):
+            print('%s: rsync failed, its files are re-analyzed locally' % host)
+            continue
+        merged = merge_build_dir(host_dir, names, build_dir)
+        print('%s: merged %i results' % (host, merged))
+
+    # replay the merged results and run the whole program analysis
+    sys.exit(subprocess.call([cppcheck, '--cppcheck-build-dir=' + build_dir] + options))
+
+
+if __name__ == '__main__':
+    main()
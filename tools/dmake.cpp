@@ -206,11 +206,24 @@ int main(int argc, char **argv)
     fout << "ifeq ($(SRCDIR),build)\n"
          << "    ifdef VERIFY\n"
          << "        matchcompiler_S := $(shell python tools/matchcompiler.py --verify)\n"
+         << "    else ifdef MATCH_PROFILE\n"
+         << "        matchcompiler_S := $(shell python tools/matchcompiler.py --profile)\n"
+         << "    else ifdef MATCH_FREQUENCY_FILE\n"
+         << "        matchcompiler_S := $(shell python tools/matchcompiler.py --frequency-file=$(MATCH_FREQUENCY_FILE))\n"
          << "    else\n"
          << "        matchcompiler_S := $(shell python tools/matchcompiler.py)\n"
          << "    endif\n"
          << "endif\n\n";
 
+    // embedded library configurations..
+    fout << "# To embed library configurations into the binary, use 'make EMBED_CFG=\"std.cfg posix.cfg\"'\n"
+         << "ifdef EMBED_CFG\n"
+         << "    embedcfg_S := $(shell python tools/embedcfg.py $(EMBED_CFG))\n"
+         << "    EMBEDCFGOBJ = build/embedcfg.o\n"
+         << "else\n"
+         << "    EMBEDCFGOBJ =\n"
+         << "endif\n\n";
+
     // explicit cfg dir..
     fout << "ifdef CFGDIR\n"
          << "    CFG=-DCFGDIR=\\\"$(CFGDIR)\\\"\n"
@@ -362,12 +375,12 @@ int main(int argc, char **argv)
         fout << " \\\n" << std::string(14, ' ') << objfile(testfiles[i]);
     fout << "\n\n";
 
-    fout << ".PHONY: run-dmake tags\n\n";
+    fout << ".PHONY: run-dmake run-bench tags\n\n";
     fout << "\n###### Targets\n\n";
-    fout << "cppcheck: $(LIBOBJ) $(CLIOBJ) $(EXTOBJ)\n";
+    fout << "cppcheck: $(LIBOBJ) $(CLIOBJ) $(EXTOBJ) $(EMBEDCFGOBJ)\n";
     fout << "\t$(CXX) $(CPPFLAGS) $(CXXFLAGS) -o $@ $^ $(LIBS) $(LDFLAGS) $(RDYNAMIC)\n\n";
     fout << "all:\tcppcheck testrunner\n\n";
-    fout << "testrunner: $(TESTOBJ) $(LIBOBJ) $(EXTOBJ) cli/threadexecutor.o cli/cmdlineparser.o cli/cppcheckexecutor.o cli/filelister.o\n";
+    fout << "testrunner: $(TESTOBJ) $(LIBOBJ) $(EXTOBJ) $(EMBEDCFGOBJ) cli/threadexecutor.o cli/cmdlineparser.o cli/cppcheckexecutor.o cli/filelister.o\n";
     fout << "\t$(CXX) $(CPPFLAGS) $(CXXFLAGS) -o $@ $^ $(LIBS) $(LDFLAGS) $(RDYNAMIC)\n\n";
     fout << "test:\tall\n";
     fout << "\t./testrunner\n\n";
@@ -383,8 +396,22 @@ int main(int argc, char **argv)
     fout << "\tg++ -Iexternals/tinyxml -o generate_cfg_tests tools/generate_cfg_tests.o $(EXTOBJ)\n";
     fout << "reduce:\ttools/reduce.o $(LIBOBJ) $(EXTOBJ)\n";
     fout << "\t$(CXX) $(CPPFLAGS) $(CXXFLAGS) -o $@ $^ $(LIBS) $(LDFLAGS) $(RDYNAMIC)\n\n";
+    fout << "makeheadermodel:\ttools/makeheadermodel.o externals/simplecpp/simplecpp.o\n";
+    fout << "\t$(CXX) $(CXXFLAGS) -o $@ $^ $(LDFLAGS)\n\n";
+    fout << "benchmarks/bench.o: benchmarks/bench.cpp\n";
+    fout << "\t$(CXX) $(CPPFLAGS) $(CXXFLAGS) -c -o benchmarks/bench.o benchmarks/bench.cpp\n\n";
+    fout << "bench:\tbenchmarks/bench.o\n";
+    fout << "\t$(CXX) $(CPPFLAGS) $(CXXFLAGS) -o $@ $^ $(LDFLAGS)\n\n";
+    fout << "run-bench: bench cppcheck\n";
+    fout << "\t./bench\n\n";
+    fout << "benchmarks/microbench.o: benchmarks/microbench.cpp lib/mathlib.h lib/settings.h lib/token.h lib/tokenize.h lib/tokenlist.h externals/simplecpp/simplecpp.h\n";
+    fout << "\t$(CXX) ${INCLUDE_FOR_LIB} $(CPPFLAGS) $(CXXFLAGS) -c -o benchmarks/microbench.o benchmarks/microbench.cpp\n\n";
+    fout << "microbench:\tbenchmarks/microbench.o $(LIBOBJ) $(EXTOBJ)\n";
+    fout << "\t$(CXX) $(CPPFLAGS) $(CXXFLAGS) -o $@ $^ $(LIBS) $(LDFLAGS) $(RDYNAMIC)\n\n";
+    fout << "build/embedcfg.o: build/embedcfg.cpp lib/library.h\n";
+    fout << "\t$(CXX) ${INCLUDE_FOR_LIB} $(CPPFLAGS) $(CFG) $(CXXFLAGS) $(UNDEF_STRICT_ANSI) -c -o build/embedcfg.o build/embedcfg.cpp\n\n";
     fout << "clean:\n";
-    fout << "\trm -f build/*.o lib/*.o cli/*.o test/*.o tools/*.o externals/*/*.o testrunner reduce dmake cppcheck cppcheck.1\n\n";
+    fout << "\trm -f build/*.o lib/*.o cli/*.o test/*.o tools/*.o benchmarks/*.o externals/*/*.o testrunner reduce dmake bench microbench cppcheck cppcheck.1\n\n";
     fout << "man:\tman/cppcheck.1\n\n";
     fout << "man/cppcheck.1:\t$(MAN_SOURCE)\n\n";
     fout << "\t$(XP) $(DB2MAN) $(MAN_SOURCE)\n\n";
@@ -0,0 +1,83 @@
+#!/usr/bin/env python
+#
+# Cppcheck - A tool for static C/C++ code analysis
+# Copyright (C) 2007-2019 Cppcheck team.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+# Generate build/embedcfg.cpp, embedding the given library configurations
+# into the cppcheck binary so they load without any file system access.
+# Used from the Makefile: make EMBED_CFG="std.cfg posix.cfg"
+#
+# The generated file registers the configurations with Library::embed().
+# Note: the data is emitted as (long) string literals, which gcc and clang
+# accept but some other compilers limit in size.
+
+import io
+import os
+import sys
+
+
+def identifier(name):
+    return ''.join(c if c.isalnum() else '_' for c in name)
+
+
+def escape_line(line):
+    return line.replace('\\', '\\\\').replace('"', '\\"')
+
+
+def generate(cfgnames):
+    out = io.StringIO()
+    out.write(u'// This file is generated by tools/embedcfg.py, do not edit.\n\n')
+    out.write(u'#include "library.h"\n\n')
+    out.write(u'namespace {\n')
+    for cfgname in cfgnames:
+        path = os.path.join('cfg', cfgname)
+        out.write(u'    const char ' + identifier(cfgname) + u'[] =\n')
+        with io.open(path, 'r', encoding='utf-8') as f:
+            for line in f.read().split('\n'):
+                out.write(u'        "' + escape_line(line) + u'\\n"\n')
+        out.write(u'    ;\n\n')
+    out.write(u'    struct EmbedCfg {\n')
+    out.write(u'        EmbedCfg() {\n')
+    for cfgname in cfgnames:
+        out.write(u'            Library::embed("' + cfgname + u'", ' +
+                  identifier(cfgname) + u', sizeof(' + identifier(cfgname) + u') - 1);\n')
+    out.write(u'        }\n')
+    out.write(u'    };\n')
+    out.write(u'    const EmbedCfg embedCfg;\n')
+    out.write(u'}\n')
+    return out.getvalue()
+
+
+def main():
+    cfgnames = sys.argv[1:]
+    if not cfgnames:
+        sys.exit('usage: embedcfg.py cfgfile.cfg ...')
+    code = generate(cfgnames)
+    if not os.path.exists('build'):
+        os.makedirs('build')
+    # only touch the file when the content changed so make does not recompile
+    # it on every build
+    destname = os.path.join('build', 'embedcfg.cpp')
+    if os.path.exists(destname):
+        with io.open(destname, 'r', encoding='utf-8') as f:
+            if f.read() == code:
+                return
+    with io.open(destname, 'w', encoding='utf-8') as f:
+        f.write(code)
+
+
+if __name__ == '__main__':
+    main()
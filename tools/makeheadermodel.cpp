@@ -0,0 +1,150 @@
+/*
+ * Cppcheck - A tool for static C/C++ code analysis
+ * Copyright (C) 2007-2019 Cppcheck team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Generate a declaration-only model header from a real header.
+ *
+ * Real standard library headers cost hundreds of milliseconds per
+ * translation unit while the checks only need the shapes of the
+ * declarations. This tool reads a header, drops the comments and replaces
+ * every function body (including constructor initializer lists) with ';',
+ * leaving the declarations intact. The generated model is written to
+ * stdout, meant to be reviewed and placed in a directory given to cppcheck
+ * with --header-models=.
+ *
+ * Usage: makeheadermodel <header-file>
+ *
+ * The body stripping is heuristic; the output is a starting point for a
+ * curated model, not a drop-in replacement for arbitrary headers.
+ */
+
+#include <simplecpp.h>
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/** Skip a balanced (), {} or [] group. Returns the closing token. */
+static const simplecpp::Token *skipBalanced(const simplecpp::Token *open)
+{
+    const char openOp = open->op;
+    const char closeOp = (openOp == '(') ? ')' : (openOp == '{') ? '}' : ']';
+    int depth = 0;
+    for (const simplecpp::Token *tok = open; tok; tok = tok->next) {
+        if (tok->op == openOp)
+            ++depth;
+        else if (tok->op == closeOp) {
+            if (--depth == 0)
+                return tok;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Given the ')' that closes a parameter list, return the '{' of the
+ * function body, or nullptr when the declaration is not a definition.
+ * Walks over cv qualifiers, ref qualifiers, noexcept/throw specifications,
+ * trailing return types and constructor initializer lists.
+ */
+static const simplecpp::Token *findFunctionBody(const simplecpp::Token *closingParen)
+{
+    const simplecpp::Token *tok = closingParen->next;
+    bool inInitList = false;
+    while (tok) {
+        if (tok->op == ':')
+            inInitList = true;
+        if (tok->op == '{') {
+            // either the function body or a member brace initializer in a
+            // constructor initializer list; an initializer is followed by
+            // ',' or by the body itself, the body is not
+            const simplecpp::Token *close = skipBalanced(tok);
+            if (!close)
+                return nullptr;
+            if (close->next && (close->next->op == ',' || close->next->op == '{')) {
+                tok = close->next;
+                continue;
+            }
+            return tok;
+        }
+        if (tok->op == ';' || tok->op == '=' || (tok->op == ',' && !inInitList) || tok->op == ')' || tok->op == '}')
+            return nullptr; // a plain declaration, default argument, ...
+        if (tok->op == '(') {
+            // noexcept(...), throw(...) or a member initializer
+            tok = skipBalanced(tok);
+            if (!tok)
+                return nullptr;
+            tok = tok->next;
+            continue;
+        }
+        tok = tok->next;
+    }
+    return nullptr;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2 || std::strncmp(argv[1], "-", 1) == 0) {
+        std::cout << "Generate a declaration-only model header from a real header.\n"
+                  << "Usage: makeheadermodel <header-file>\n";
+        return 1;
+    }
+
+    std::ifstream f(argv[1]);
+    if (!f.is_open()) {
+        std::cerr << "failed to open '" << argv[1] << "'\n";
+        return 1;
+    }
+
+    std::vector<std::string> filenames;
+    simplecpp::OutputList outputList;
+    simplecpp::TokenList tokens(f, filenames, argv[1], &outputList);
+    tokens.removeComments();
+
+    std::cout << "// Declaration-only model of " << argv[1] << "\n"
+              << "// Generated by makeheadermodel, for use with cppcheck --header-models=\n";
+
+    unsigned int line = 0;
+    for (const simplecpp::Token *tok = tokens.cfront(); tok; tok = tok->next) {
+        if (tok->location.line != line) {
+            if (line > 0)
+                std::cout << '\n';
+            line = tok->location.line;
+        } else if (tok->previous)
+            std::cout << ' ';
+        std::cout << tok->str();
+
+        if (tok->op == ')') {
+            // a function definition? then print ';' instead of the
+            // initializer list and the body
+            const simplecpp::Token *body = findFunctionBody(tok);
+            if (body) {
+                std::cout << " ;";
+                tok = skipBalanced(body);
+                if (!tok)
+                    break;
+                line = tok->location.line;
+            }
+        }
+    }
+    std::cout << std::endl;
+
+    return 0;
+}
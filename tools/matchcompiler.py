@@ -27,9 +27,12 @@ import errno
 
 class MatchCompiler:
 
-    def __init__(self, verify_mode=False, show_skipped=False):
+    def __init__(self, verify_mode=False, show_skipped=False,
+                 profile_mode=False, frequencies=None):
         self._verifyMode = verify_mode
+        self._profileMode = profile_mode
         self._showSkipped = show_skipped
+        self._frequencies = frequencies
         self._reset()
 
     def _reset(self):
@@ -122,8 +125,46 @@ class MatchCompiler:
             '(tok->str()==MatchCompiler::makeConstString("' + tok + '"))'
         )
 
+    @staticmethod
+    def _countAlternatives(pattern):
+        # total number of a|b|c alternatives in the pattern, in pattern
+        # order; the branch index of PatternProfile counts the same way
+        count = 0
+        for tok in pattern.split(' '):
+            if tok == '':
+                continue
+            if (len(tok) > 2) and (tok[0] == '[') and (tok[-1] == ']'):
+                continue
+            if tok.find('|') > 0:
+                count += len([tok2 for tok2 in tok.split('|') if tok2 != ''])
+        return count
+
+    def _reorderAlternatives(self, pattern, tokens2, firstBranchIndex):
+        # reorder the a|b|c alternatives by the branch hit counts of a
+        # profiling run (--frequency-file), most frequent first, so the
+        # || chain short-circuits as early as possible
+        if not self._frequencies:
+            return tokens2
+        hits = self._frequencies.get(pattern)
+        if hits is None:
+            return tokens2
+        indexed = []
+        branchIndex = firstBranchIndex
+        for tok2 in tokens2:
+            if tok2 == '':
+                continue
+            hit = hits[branchIndex] if branchIndex < len(hits) else 0
+            indexed.append((hit, tok2))
+            branchIndex += 1
+        # stable: alternatives with equal counts keep the written order
+        indexed.sort(key=lambda entry: entry[0], reverse=True)
+        reordered = [tok2 for (_, tok2) in indexed]
+        if '' in tokens2:
+            reordered.append('')
+        return reordered
+
     def _compilePattern(self, pattern, nr, varid,
-                        isFindMatch=False, tokenType="const Token"):
+                        isFindMatch=False, tokenType="const Token", profileName=None):
         if isFindMatch:
             ret = '\n    ' + tokenType + ' * tok = start_tok;\n'
             returnStatement = 'continue;\n'
@@ -132,14 +173,24 @@ class MatchCompiler:
             if varid:
                 arg2 = ', const unsigned int varid'
 
+            if self._profileMode:
+                profileName = 'match' + str(nr) + '_profile'
+
             ret = '// pattern: ' + pattern + '\n'
-            ret += 'static bool match' + \
-                str(nr) + '(' + tokenType + '* tok' + arg2 + ') {\n'
+            if self._profileMode:
+                ret += 'static MatchCompiler::PatternProfile ' + profileName + \
+                    '("' + pattern + '", ' + \
+                    str(self._countAlternatives(pattern)) + ');\n'
+            ret += 'static bool match' + str(nr)
+            if self._profileMode:
+                ret += '_inner'
+            ret += '(' + tokenType + '* tok' + arg2 + ') {\n'
             returnStatement = 'return false;\n'
 
         tokens = pattern.split(' ')
         gotoNextToken = ''
         checked_varid = False
+        branchIndex = 0
         for tok in tokens:
             if tok == '':
                 continue
@@ -160,7 +211,8 @@ class MatchCompiler:
 
             # a|b|c
             elif tok.find('|') > 0:
-                tokens2 = tok.split('|')
+                tokens2 = self._reorderAlternatives(
+                    pattern, tok.split('|'), branchIndex)
                 logicalOp = ' || '
                 if "" in tokens2:
                     ret += '    if (tok && ('
@@ -173,7 +225,14 @@ class MatchCompiler:
                     if not first:
                         ret += logicalOp
                     first = False
-                    ret += self._compileCmd(tok2)
+                    cmd = self._compileCmd(tok2)
+                    if profileName:
+                        # the branch counter keeps the short-circuit
+                        # evaluation of the || chain
+                        cmd = profileName + \
+                            '.branch(' + str(branchIndex) + ', ' + cmd + ')'
+                    branchIndex += 1
+                    ret += cmd
 
                 ret += '))\n'
                 if "" in tokens2:
@@ -204,28 +263,59 @@ class MatchCompiler:
         else:
             ret += '    return true;\n'
             ret += '}\n'
+            if self._profileMode:
+                # the wrapper counts the invocations and the successes
+                more_args = ', varid' if varid else ''
+                ret += 'static bool match' + \
+                    str(nr) + '(' + tokenType + '* tok' + arg2 + ') {\n'
+                ret += '    return ' + profileName + '.hit(match' + \
+                    str(nr) + '_inner(tok' + more_args + '));\n'
+                ret += '}\n'
 
         return ret
 
     def _compileFindPattern(self, pattern, findmatchnr, endToken, varId):
         more_args = ''
+        call_args = ''
         endCondition = ''
         if endToken:
             more_args += ', const Token * end'
+            call_args += ', end'
             endCondition = ' && start_tok != end'
         if varId:
             more_args += ', unsigned int varid'
+            call_args += ', varid'
+
+        functionName = 'findmatch' + str(findmatchnr)
+        profileName = None
 
         ret = '// pattern: ' + pattern + '\n'
-        ret += 'template<class T> static T * findmatch' + \
-            str(findmatchnr) + '(T * start_tok' + more_args + ') {\n'
+        if self._profileMode:
+            profileName = functionName + '_profile'
+            ret += 'static MatchCompiler::PatternProfile ' + profileName + \
+                '("' + pattern + '", ' + \
+                str(self._countAlternatives(pattern)) + ');\n'
+        ret += 'template<class T> static T * ' + functionName
+        if self._profileMode:
+            ret += '_inner'
+        ret += '(T * start_tok' + more_args + ') {\n'
         ret += '    for (; start_tok' + endCondition + \
             '; start_tok = start_tok->next()) {\n'
 
-        ret += self._compilePattern(pattern, -1, varId, True, 'T')
+        ret += self._compilePattern(pattern, -1, varId, True, 'T', profileName)
         ret += '    }\n'
         ret += '    return NULL;\n}\n'
 
+        if self._profileMode:
+            # the wrapper counts the invocations and the successes
+            ret += 'template<class T> static T * ' + \
+                functionName + '(T * start_tok' + more_args + ') {\n'
+            ret += '    T * const res_tok = ' + functionName + \
+                '_inner(start_tok' + call_args + ');\n'
+            ret += '    ' + profileName + '.hit(res_tok != NULL);\n'
+            ret += '    return res_tok;\n'
+            ret += '}\n'
+
         return ret
 
     @staticmethod
@@ -640,6 +730,30 @@ class MatchCompiler:
         fout.close()
 
 
+def loadPatternFrequencies(filename):
+    # Parse a matchprofile.txt dump written by a profiling build (see
+    # MatchCompiler::PatternProfile). Dumps of several runs can be
+    # concatenated; the branch hit counts are summed per pattern.
+    frequencies = {}
+    fin = io.open(filename, "rt", encoding="utf-8")
+    for line in fin:
+        fields = line.rstrip('\n').split('\t')
+        if len(fields) != 4:
+            continue
+        hits_field = fields[2]
+        pattern = fields[3]
+        if hits_field == '-':
+            continue
+        hits = [int(hit) for hit in hits_field.split(',')]
+        known = frequencies.setdefault(pattern, [])
+        while len(known) < len(hits):
+            known.append(0)
+        for i, hit in enumerate(hits):
+            known[i] += hit
+    fin.close()
+    return frequencies
+
+
 def main():
     # Main program
 
@@ -648,6 +762,12 @@ def main():
         description='Compile Token::Match() calls into native C++ code')
     parser.add_argument('--verify', action='store_true', default=False,
                         help='verify compiled matches against on-the-fly parser. Slow!')
+    parser.add_argument('--profile', action='store_true', default=False,
+                        help='count the invocations and matches of each compiled pattern, '
+                             'dumped to matchprofile.txt at exit')
+    parser.add_argument('--frequency-file', default=None,
+                        help='matchprofile.txt dump of a profiling run; a|b|c alternatives '
+                             'are reordered by the observed frequencies')
     parser.add_argument('--show-skipped', action='store_true', default=False,
                         help='show skipped (non-static) patterns')
     parser.add_argument('--read-dir', default="lib",
@@ -666,6 +786,16 @@ def main():
     line_directive = args.line
     files = args.file
 
+    # the branch indices of a profiling run refer to the written pattern
+    # order, which reordering would change
+    if args.profile and (args.verify or args.frequency_file):
+        print('--profile cannot be combined with --verify or --frequency-file')
+        sys.exit(-1)
+
+    frequencies = None
+    if args.frequency_file:
+        frequencies = loadPatternFrequencies(args.frequency_file)
+
     # Check if we are invoked from the right place
     if not os.path.exists(lib_dir):
         print('Directory "' + lib_dir + '"not found.')
@@ -686,7 +816,9 @@ def main():
         raise Exception(build_dir + ' is not a directory')
 
     mc = MatchCompiler(verify_mode=args.verify,
-                       show_skipped=args.show_skipped)
+                       show_skipped=args.show_skipped,
+                       profile_mode=args.profile,
+                       frequencies=frequencies)
 
     if not files:
         # select all *.cpp files in lib_dir